@@ -76,6 +76,16 @@ ATOMIC_INLINE uint64_t atomic_fetch_and_sub_uint64(uint64_t *p, uint64_t x)
   return InterlockedExchangeAdd64((int64_t *)p, -((int64_t)x));
 }
 
+ATOMIC_INLINE uint64_t atomic_load_uint64(const uint64_t *v)
+{
+  return InterlockedOr64((int64_t *)v, 0);
+}
+
+ATOMIC_INLINE void atomic_store_uint64(uint64_t *p, uint64_t v)
+{
+  InterlockedExchange64((int64_t *)p, v);
+}
+
 /* Signed */
 ATOMIC_INLINE int64_t atomic_add_and_fetch_int64(int64_t *p, int64_t x)
 {
@@ -102,6 +112,16 @@ ATOMIC_INLINE int64_t atomic_fetch_and_sub_int64(int64_t *p, int64_t x)
   return InterlockedExchangeAdd64(p, -x);
 }
 
+ATOMIC_INLINE int64_t atomic_load_int64(const int64_t *v)
+{
+  return InterlockedOr64((int64_t *)v, 0);
+}
+
+ATOMIC_INLINE void atomic_store_int64(int64_t *p, int64_t v)
+{
+  InterlockedExchange64(p, v);
+}
+
 /******************************************************************************/
 /* 32-bit operations. */
 /* Unsigned */
@@ -166,6 +186,28 @@ ATOMIC_INLINE int32_t atomic_fetch_and_and_int32(int32_t *p, int32_t x)
   return InterlockedAnd((long *)p, x);
 }
 
+/* Unsigned */
+ATOMIC_INLINE uint32_t atomic_load_uint32(const uint32_t *v)
+{
+  return InterlockedOr((long *)v, 0);
+}
+
+ATOMIC_INLINE void atomic_store_uint32(uint32_t *p, uint32_t v)
+{
+  InterlockedExchange((long *)p, v);
+}
+
+/* Signed */
+ATOMIC_INLINE int32_t atomic_load_int32(const int32_t *v)
+{
+  return InterlockedOr((long *)v, 0);
+}
+
+ATOMIC_INLINE void atomic_store_int32(int32_t *p, int32_t v)
+{
+  InterlockedExchange((long *)p, v);
+}
+
 /******************************************************************************/
 /* 16-bit operations. */
 
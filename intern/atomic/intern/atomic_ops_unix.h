@@ -146,6 +146,23 @@ static _ATOMIC_MAYBE_UNUSED AtomicSpinLock _atomic_global_lock = {0};
 #define ATOMIC_LOCKING_FETCH_AND_AND_DEFINE(_type) \
   ATOMIC_LOCKING_FETCH_AND_OP_DEFINE(_type, and, &)
 
+#define ATOMIC_LOCKING_LOAD_DEFINE(_type) \
+  ATOMIC_INLINE _type##_t atomic_load_##_type(const _type##_t *v) \
+  { \
+    atomic_spin_lock(&_atomic_global_lock); \
+    const _type##_t value = *v; \
+    atomic_spin_unlock(&_atomic_global_lock); \
+    return value; \
+  }
+
+#define ATOMIC_LOCKING_STORE_DEFINE(_type) \
+  ATOMIC_INLINE void atomic_store_##_type(_type##_t *p, const _type##_t v) \
+  { \
+    atomic_spin_lock(&_atomic_global_lock); \
+    *p = v; \
+    atomic_spin_unlock(&_atomic_global_lock); \
+  }
+
 #define ATOMIC_LOCKING_CAS_DEFINE(_type) \
   ATOMIC_INLINE _type##_t atomic_cas_##_type(_type##_t *v, _type##_t old, _type##_t _new) \
   { \
@@ -315,6 +332,43 @@ ATOMIC_LOCKING_CAS_DEFINE(int64)
 
 #endif
 
+#if !defined(ATOMIC_FORCE_USE_FALLBACK) && \
+    (defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_8) || defined(JE_FORCE_SYNC_COMPARE_AND_SWAP_8) || \
+     defined(__amd64__) || defined(__x86_64__))
+/* Unsigned */
+ATOMIC_INLINE uint64_t atomic_load_uint64(const uint64_t *v)
+{
+  return __atomic_load_n(v, __ATOMIC_SEQ_CST);
+}
+
+ATOMIC_INLINE void atomic_store_uint64(uint64_t *p, uint64_t v)
+{
+  __atomic_store_n(p, v, __ATOMIC_SEQ_CST);
+}
+
+/* Signed */
+ATOMIC_INLINE int64_t atomic_load_int64(const int64_t *v)
+{
+  return __atomic_load_n(v, __ATOMIC_SEQ_CST);
+}
+
+ATOMIC_INLINE void atomic_store_int64(int64_t *p, int64_t v)
+{
+  __atomic_store_n(p, v, __ATOMIC_SEQ_CST);
+}
+
+#else
+
+/* Unsigned */
+ATOMIC_LOCKING_LOAD_DEFINE(uint64)
+ATOMIC_LOCKING_STORE_DEFINE(uint64)
+
+/* Signed */
+ATOMIC_LOCKING_LOAD_DEFINE(int64)
+ATOMIC_LOCKING_STORE_DEFINE(int64)
+
+#endif
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -479,6 +533,42 @@ ATOMIC_LOCKING_FETCH_AND_AND_DEFINE(int32)
 
 #endif
 
+#if !defined(ATOMIC_FORCE_USE_FALLBACK) && \
+    (defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_4) || defined(JE_FORCE_SYNC_COMPARE_AND_SWAP_4))
+/* Unsigned */
+ATOMIC_INLINE uint32_t atomic_load_uint32(const uint32_t *v)
+{
+  return __atomic_load_n(v, __ATOMIC_SEQ_CST);
+}
+
+ATOMIC_INLINE void atomic_store_uint32(uint32_t *p, uint32_t v)
+{
+  __atomic_store_n(p, v, __ATOMIC_SEQ_CST);
+}
+
+/* Signed */
+ATOMIC_INLINE int32_t atomic_load_int32(const int32_t *v)
+{
+  return __atomic_load_n(v, __ATOMIC_SEQ_CST);
+}
+
+ATOMIC_INLINE void atomic_store_int32(int32_t *p, int32_t v)
+{
+  __atomic_store_n(p, v, __ATOMIC_SEQ_CST);
+}
+
+#else
+
+/* Unsigned */
+ATOMIC_LOCKING_LOAD_DEFINE(uint32)
+ATOMIC_LOCKING_STORE_DEFINE(uint32)
+
+/* Signed */
+ATOMIC_LOCKING_LOAD_DEFINE(int32)
+ATOMIC_LOCKING_STORE_DEFINE(int32)
+
+#endif
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -557,5 +647,7 @@ ATOMIC_LOCKING_FETCH_AND_OR_DEFINE(int8)
 #undef ATOMIC_LOCKING_FETCH_AND_OR_DEFINE
 #undef ATOMIC_LOCKING_FETCH_AND_AND_DEFINE
 #undef ATOMIC_LOCKING_CAS_DEFINE
+#undef ATOMIC_LOCKING_LOAD_DEFINE
+#undef ATOMIC_LOCKING_STORE_DEFINE
 
 #endif /* __ATOMIC_OPS_UNIX_H__ */
@@ -143,6 +143,34 @@ TEST(atomic, atomic_cas_uint64)
   }
 }
 
+TEST(atomic, atomic_load_uint64)
+{
+  {
+    uint64_t value = 2;
+    EXPECT_EQ(atomic_load_uint64(&value), 2);
+  }
+
+  {
+    uint64_t value = 0xffffffffffffffff;
+    EXPECT_EQ(atomic_load_uint64(&value), 0xffffffffffffffff);
+  }
+}
+
+TEST(atomic, atomic_store_uint64)
+{
+  {
+    uint64_t value = 2;
+    atomic_store_uint64(&value, 3);
+    EXPECT_EQ(value, 3);
+  }
+
+  {
+    uint64_t value = 2;
+    atomic_store_uint64(&value, 0xffffffffffffffff);
+    EXPECT_EQ(value, 0xffffffffffffffff);
+  }
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -277,6 +305,34 @@ TEST(atomic, atomic_cas_int64)
   }
 }
 
+TEST(atomic, atomic_load_int64)
+{
+  {
+    int64_t value = 2;
+    EXPECT_EQ(atomic_load_int64(&value), 2);
+  }
+
+  {
+    int64_t value = -0x123456789abcdef0;
+    EXPECT_EQ(atomic_load_int64(&value), -0x123456789abcdef0);
+  }
+}
+
+TEST(atomic, atomic_store_int64)
+{
+  {
+    int64_t value = 2;
+    atomic_store_int64(&value, 3);
+    EXPECT_EQ(value, 3);
+  }
+
+  {
+    int64_t value = 2;
+    atomic_store_int64(&value, -0x123456789abcdef0);
+    EXPECT_EQ(value, -0x123456789abcdef0);
+  }
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -421,6 +477,34 @@ TEST(atomic, atomic_fetch_and_and_uint32)
   }
 }
 
+TEST(atomic, atomic_load_uint32)
+{
+  {
+    uint32_t value = 2;
+    EXPECT_EQ(atomic_load_uint32(&value), 2);
+  }
+
+  {
+    uint32_t value = 0xffffffff;
+    EXPECT_EQ(atomic_load_uint32(&value), 0xffffffff);
+  }
+}
+
+TEST(atomic, atomic_store_uint32)
+{
+  {
+    uint32_t value = 2;
+    atomic_store_uint32(&value, 3);
+    EXPECT_EQ(value, 3);
+  }
+
+  {
+    uint32_t value = 2;
+    atomic_store_uint32(&value, 0xffffffff);
+    EXPECT_EQ(value, 0xffffffff);
+  }
+}
+
 /** \} */
 
 /** \name 32 bit signed int atomics
@@ -557,6 +641,34 @@ TEST(atomic, atomic_fetch_and_and_int32)
   }
 }
 
+TEST(atomic, atomic_load_int32)
+{
+  {
+    int32_t value = 2;
+    EXPECT_EQ(atomic_load_int32(&value), 2);
+  }
+
+  {
+    int32_t value = -0x12345678;
+    EXPECT_EQ(atomic_load_int32(&value), -0x12345678);
+  }
+}
+
+TEST(atomic, atomic_store_int32)
+{
+  {
+    int32_t value = 2;
+    atomic_store_int32(&value, 3);
+    EXPECT_EQ(value, 3);
+  }
+
+  {
+    int32_t value = 2;
+    atomic_store_int32(&value, -0x12345678);
+    EXPECT_EQ(value, -0x12345678);
+  }
+}
+
 /** \} */
 
 /** \name 16 bit signed int atomics
@@ -770,6 +882,40 @@ TEST(atomic, atomic_fetch_and_update_max_z)
   EXPECT_EQ(value, size_t_max);
 }
 
+TEST(atomic, atomic_load_z)
+{
+  /* Make sure alias is implemented. */
+  {
+    size_t value = 2;
+    EXPECT_EQ(atomic_load_z(&value), 2);
+  }
+
+  /* Make sure alias is using proper bitness. */
+  {
+    const size_t size_t_max = std::numeric_limits<size_t>::max();
+    size_t value = size_t_max;
+    EXPECT_EQ(atomic_load_z(&value), size_t_max);
+  }
+}
+
+TEST(atomic, atomic_store_z)
+{
+  /* Make sure alias is implemented. */
+  {
+    size_t value = 2;
+    atomic_store_z(&value, 3);
+    EXPECT_EQ(value, 3);
+  }
+
+  /* Make sure alias is using proper bitness. */
+  {
+    const size_t size_t_max = std::numeric_limits<size_t>::max();
+    size_t value = 2;
+    atomic_store_z(&value, size_t_max);
+    EXPECT_EQ(value, size_t_max);
+  }
+}
+
 /** \} */
 
 /** \name unsigned int aliases
@@ -131,6 +131,25 @@ extern void *(*MEM_mallocN_aligned)(size_t len,
                                     const char *str) /* ATTR_MALLOC */ ATTR_WARN_UNUSED_RESULT
     ATTR_ALLOC_SIZE(1) ATTR_NONNULL(3);
 
+/**
+ * Size of the header written before memory passed to #MEM_external_wrap.
+ */
+#define MEM_EXTERNAL_HEADER_SIZE (sizeof(void *) * 2 + sizeof(size_t))
+
+/**
+ * Use memory which was not allocated by this module as if it was (e.g. data in a memory-mapped
+ * file), without copying it. The #MEM_EXTERNAL_HEADER_SIZE bytes before \a ptr are overwritten,
+ * \a ptr must be aligned to the pointer size and \a len must be a multiple of 4.
+ * Freeing the memory calls \a free_fn with \a user_data instead.
+ *
+ * \return false when the allocator in use doesn't support this (the guarded allocator),
+ * the memory has to be copied then.
+ */
+extern bool (*MEM_external_wrap)(void *ptr,
+                                 size_t len,
+                                 void (*free_fn)(void *user_data),
+                                 void *user_data) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1, 3);
+
 /**
  * Print a list of the names and sizes of all allocated memory
  * blocks. as a python dict for easy investigation.
@@ -238,6 +257,16 @@ void MEM_use_lockfree_allocator(void);
  * NOTE: The switch between allocator types can only happen before any allocation did happen. */
 void MEM_use_guarded_allocator(void);
 
+/* Switch allocator to the thread-cached mode.
+ *
+ * Same tracking as the lock-free allocator, but freed small blocks are cached per thread and
+ * reused by later allocations of the same thread, and the statistics are counted per thread and
+ * only added up when they are queried. This avoids contention on shared counters when many
+ * threads allocate at the same time.
+ *
+ * NOTE: The switch between allocator types can only happen before any allocation did happen. */
+void MEM_use_threadcache_allocator(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
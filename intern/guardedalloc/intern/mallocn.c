@@ -35,6 +35,10 @@ void *(*MEM_malloc_arrayN)(size_t len, size_t size, const char *str) = MEM_lockf
 void *(*MEM_mallocN_aligned)(size_t len,
                              size_t alignment,
                              const char *str) = MEM_lockfree_mallocN_aligned;
+bool (*MEM_external_wrap)(void *ptr,
+                          size_t len,
+                          void (*free_fn)(void *user_data),
+                          void *user_data) = MEM_lockfree_external_wrap;
 void (*MEM_printmemlist_pydict)(void) = MEM_lockfree_printmemlist_pydict;
 void (*MEM_printmemlist)(void) = MEM_lockfree_printmemlist;
 void (*MEM_callbackmemlist)(void (*func)(void *)) = MEM_lockfree_callbackmemlist;
@@ -114,6 +118,7 @@ void MEM_use_lockfree_allocator(void)
   MEM_mallocN = MEM_lockfree_mallocN;
   MEM_malloc_arrayN = MEM_lockfree_malloc_arrayN;
   MEM_mallocN_aligned = MEM_lockfree_mallocN_aligned;
+  MEM_external_wrap = MEM_lockfree_external_wrap;
   MEM_printmemlist_pydict = MEM_lockfree_printmemlist_pydict;
   MEM_printmemlist = MEM_lockfree_printmemlist;
   MEM_callbackmemlist = MEM_lockfree_callbackmemlist;
@@ -145,6 +150,7 @@ void MEM_use_guarded_allocator(void)
   MEM_mallocN = MEM_guarded_mallocN;
   MEM_malloc_arrayN = MEM_guarded_malloc_arrayN;
   MEM_mallocN_aligned = MEM_guarded_mallocN_aligned;
+  MEM_external_wrap = MEM_guarded_external_wrap;
   MEM_printmemlist_pydict = MEM_guarded_printmemlist_pydict;
   MEM_printmemlist = MEM_guarded_printmemlist;
   MEM_callbackmemlist = MEM_guarded_callbackmemlist;
@@ -161,3 +167,35 @@ void MEM_use_guarded_allocator(void)
   MEM_name_ptr = MEM_guarded_name_ptr;
 #endif
 }
+
+void MEM_use_threadcache_allocator(void)
+{
+  assert_for_allocator_change();
+
+  MEM_allocN_len = MEM_threadcache_allocN_len;
+  MEM_freeN = MEM_threadcache_freeN;
+  MEM_dupallocN = MEM_threadcache_dupallocN;
+  MEM_reallocN_id = MEM_threadcache_reallocN_id;
+  MEM_recallocN_id = MEM_threadcache_recallocN_id;
+  MEM_callocN = MEM_threadcache_callocN;
+  MEM_calloc_arrayN = MEM_threadcache_calloc_arrayN;
+  MEM_mallocN = MEM_threadcache_mallocN;
+  MEM_malloc_arrayN = MEM_threadcache_malloc_arrayN;
+  MEM_mallocN_aligned = MEM_threadcache_mallocN_aligned;
+  MEM_external_wrap = MEM_threadcache_external_wrap;
+  MEM_printmemlist_pydict = MEM_threadcache_printmemlist_pydict;
+  MEM_printmemlist = MEM_threadcache_printmemlist;
+  MEM_callbackmemlist = MEM_threadcache_callbackmemlist;
+  MEM_printmemlist_stats = MEM_threadcache_printmemlist_stats;
+  MEM_set_error_callback = MEM_threadcache_set_error_callback;
+  MEM_consistency_check = MEM_threadcache_consistency_check;
+  MEM_set_memory_debug = MEM_threadcache_set_memory_debug;
+  MEM_get_memory_in_use = MEM_threadcache_get_memory_in_use;
+  MEM_get_memory_blocks_in_use = MEM_threadcache_get_memory_blocks_in_use;
+  MEM_reset_peak_memory = MEM_threadcache_reset_peak_memory;
+  MEM_get_peak_memory = MEM_threadcache_get_peak_memory;
+
+#ifndef NDEBUG
+  MEM_name_ptr = MEM_threadcache_name_ptr;
+#endif
+}
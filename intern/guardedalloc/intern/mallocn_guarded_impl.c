@@ -530,6 +530,19 @@ void *MEM_guarded_mallocN_aligned(size_t len, size_t alignment, const char *str)
   return NULL;
 }
 
+bool MEM_guarded_external_wrap(void *ptr,
+                               size_t len,
+                               void (*free_fn)(void *user_data),
+                               void *user_data)
+{
+  /* Guarded blocks are linked in a list and need a tail, which external memory doesn't have. */
+  (void)ptr;
+  (void)len;
+  (void)free_fn;
+  (void)user_data;
+  return false;
+}
+
 void *MEM_guarded_callocN(size_t len, const char *str)
 {
   MemHead *memh;
@@ -118,6 +118,10 @@ void *MEM_lockfree_mallocN_aligned(size_t len,
                                    size_t alignment,
                                    const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
     ATTR_ALLOC_SIZE(1) ATTR_NONNULL(3);
+bool MEM_lockfree_external_wrap(void *ptr,
+                                size_t len,
+                                void (*free_fn)(void *user_data),
+                                void *user_data) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1, 3);
 void MEM_lockfree_printmemlist_pydict(void);
 void MEM_lockfree_printmemlist(void);
 void MEM_lockfree_callbackmemlist(void (*func)(void *));
@@ -133,6 +137,53 @@ size_t MEM_lockfree_get_peak_memory(void) ATTR_WARN_UNUSED_RESULT;
 const char *MEM_lockfree_name_ptr(void *vmemh);
 #endif
 
+/* Prototypes for thread-cached allocator functions */
+size_t MEM_threadcache_allocN_len(const void *vmemh) ATTR_WARN_UNUSED_RESULT;
+void MEM_threadcache_freeN(void *vmemh);
+void *MEM_threadcache_dupallocN(const void *vmemh) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+void *MEM_threadcache_reallocN_id(void *vmemh,
+                                  size_t len,
+                                  const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(2);
+void *MEM_threadcache_recallocN_id(void *vmemh,
+                                   size_t len,
+                                   const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(2);
+void *MEM_threadcache_callocN(size_t len, const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(1) ATTR_NONNULL(2);
+void *MEM_threadcache_calloc_arrayN(size_t len,
+                                    size_t size,
+                                    const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(1, 2) ATTR_NONNULL(3);
+void *MEM_threadcache_mallocN(size_t len, const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(1) ATTR_NONNULL(2);
+void *MEM_threadcache_malloc_arrayN(size_t len,
+                                    size_t size,
+                                    const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(1, 2) ATTR_NONNULL(3);
+void *MEM_threadcache_mallocN_aligned(size_t len,
+                                      size_t alignment,
+                                      const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
+    ATTR_ALLOC_SIZE(1) ATTR_NONNULL(3);
+bool MEM_threadcache_external_wrap(void *ptr,
+                                   size_t len,
+                                   void (*free_fn)(void *user_data),
+                                   void *user_data) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1, 3);
+void MEM_threadcache_printmemlist_pydict(void);
+void MEM_threadcache_printmemlist(void);
+void MEM_threadcache_callbackmemlist(void (*func)(void *));
+void MEM_threadcache_printmemlist_stats(void);
+void MEM_threadcache_set_error_callback(void (*func)(const char *));
+bool MEM_threadcache_consistency_check(void);
+void MEM_threadcache_set_memory_debug(void);
+size_t MEM_threadcache_get_memory_in_use(void);
+unsigned int MEM_threadcache_get_memory_blocks_in_use(void);
+void MEM_threadcache_reset_peak_memory(void);
+size_t MEM_threadcache_get_peak_memory(void) ATTR_WARN_UNUSED_RESULT;
+#ifndef NDEBUG
+const char *MEM_threadcache_name_ptr(void *vmemh);
+#endif
+
 /* Prototypes for fully guarded allocator functions */
 size_t MEM_guarded_allocN_len(const void *vmemh) ATTR_WARN_UNUSED_RESULT;
 void MEM_guarded_freeN(void *vmemh);
@@ -161,6 +212,10 @@ void *MEM_guarded_mallocN_aligned(size_t len,
                                   size_t alignment,
                                   const char *str) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT
     ATTR_ALLOC_SIZE(1) ATTR_NONNULL(3);
+bool MEM_guarded_external_wrap(void *ptr,
+                               size_t len,
+                               void (*free_fn)(void *user_data),
+                               void *user_data) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1, 3);
 void MEM_guarded_printmemlist_pydict(void);
 void MEM_guarded_printmemlist(void);
 void MEM_guarded_callbackmemlist(void (*func)(void *));
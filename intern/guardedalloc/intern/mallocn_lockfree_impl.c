@@ -30,6 +30,13 @@ typedef struct MemHeadAligned {
   size_t len;
 } MemHeadAligned;
 
+/** Header of memory not allocated by this module, see #MEM_lockfree_external_wrap. */
+typedef struct MemHeadExternal {
+  void (*free_fn)(void *user_data);
+  void *user_data;
+  size_t len;
+} MemHeadExternal;
+
 static unsigned int totblock = 0;
 static size_t mem_in_use = 0, peak_mem = 0;
 static bool malloc_debug_memset = false;
@@ -38,12 +45,15 @@ static void (*error_callback)(const char *) = NULL;
 
 enum {
   MEMHEAD_ALIGN_FLAG = 1,
+  MEMHEAD_EXTERNAL_FLAG = 2,
 };
 
 #define MEMHEAD_FROM_PTR(ptr) (((MemHead *)ptr) - 1)
 #define PTR_FROM_MEMHEAD(memhead) (memhead + 1)
 #define MEMHEAD_ALIGNED_FROM_PTR(ptr) (((MemHeadAligned *)ptr) - 1)
 #define MEMHEAD_IS_ALIGNED(memhead) ((memhead)->len & (size_t)MEMHEAD_ALIGN_FLAG)
+#define MEMHEAD_EXTERNAL_FROM_PTR(ptr) (((MemHeadExternal *)ptr) - 1)
+#define MEMHEAD_IS_EXTERNAL(memhead) ((memhead)->len & (size_t)MEMHEAD_EXTERNAL_FLAG)
 
 /* Uncomment this to have proper peak counter. */
 #define USE_ATOMIC_MAX
@@ -79,7 +89,8 @@ print_error(const char *str, ...)
 size_t MEM_lockfree_allocN_len(const void *vmemh)
 {
   if (vmemh) {
-    return MEMHEAD_FROM_PTR(vmemh)->len & ~((size_t)(MEMHEAD_ALIGN_FLAG));
+    return MEMHEAD_FROM_PTR(vmemh)->len &
+           ~((size_t)(MEMHEAD_ALIGN_FLAG | MEMHEAD_EXTERNAL_FLAG));
   }
 
   return 0;
@@ -102,6 +113,13 @@ void MEM_lockfree_freeN(void *vmemh)
     return;
   }
 
+  if (UNLIKELY(MEMHEAD_IS_EXTERNAL(memh))) {
+    /* Not counted in the statistics, the owner is responsible for the memory. */
+    MemHeadExternal *memh_external = MEMHEAD_EXTERNAL_FROM_PTR(vmemh);
+    memh_external->free_fn(memh_external->user_data);
+    return;
+  }
+
   atomic_sub_and_fetch_u(&totblock, 1);
   atomic_sub_and_fetch_z(&mem_in_use, len);
 
@@ -352,6 +370,23 @@ void *MEM_lockfree_mallocN_aligned(size_t len, size_t alignment, const char *str
   return NULL;
 }
 
+bool MEM_lockfree_external_wrap(void *ptr,
+                                size_t len,
+                                void (*free_fn)(void *user_data),
+                                void *user_data)
+{
+  /* The length shares its bits with the flags. */
+  assert((len & (size_t)(MEMHEAD_ALIGN_FLAG | MEMHEAD_EXTERNAL_FLAG)) == 0);
+  assert(((uintptr_t)ptr % sizeof(void *)) == 0);
+
+  MemHeadExternal *memh = MEMHEAD_EXTERNAL_FROM_PTR(ptr);
+  memh->free_fn = free_fn;
+  memh->user_data = user_data;
+  memh->len = len | (size_t)MEMHEAD_EXTERNAL_FLAG;
+
+  return true;
+}
+
 void MEM_lockfree_printmemlist_pydict(void)
 {
 }
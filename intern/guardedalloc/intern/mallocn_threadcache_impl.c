@@ -0,0 +1,746 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup intern_mem
+ *
+ * Memory allocation with per-thread caches for small blocks and per-thread statistics.
+ *
+ * Small allocations are rounded up to a size class. When a small block is freed, it is put into
+ * a free-list of the thread that freed it, and reused by the next allocation of the same size
+ * class in that thread. This avoids going through the system allocator for the many small,
+ * short-lived allocations done by multi-threaded code.
+ *
+ * The number of blocks and the amount of memory in use are counted by every thread separately,
+ * without atomics. A thread only adds its counters to the shared ones when they changed by a
+ * certain amount, or when the thread exits. Queries add up the counters of all running threads.
+ */
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h> /* printf */
+#include <stdlib.h>
+#include <string.h> /* memcpy */
+#include <sys/types.h>
+
+#include "MEM_guardedalloc.h"
+
+/* to ensure strict conversions */
+#include "../../source/blender/blenlib/BLI_strict_flags.h"
+
+#include "atomic_ops.h"
+#include "mallocn_intern.h"
+
+#ifdef _MSC_VER
+#  define MEM_THREAD_LOCAL __declspec(thread)
+#else
+#  define MEM_THREAD_LOCAL __thread
+#endif
+
+/* Same layout as in the lock-free allocator. */
+typedef struct MemHead {
+  /* Length of allocated memory block. */
+  size_t len;
+} MemHead;
+
+typedef struct MemHeadAligned {
+  short alignment;
+  size_t len;
+} MemHeadAligned;
+
+/** Header of memory not allocated by this module, see #MEM_threadcache_external_wrap. */
+typedef struct MemHeadExternal {
+  void (*free_fn)(void *user_data);
+  void *user_data;
+  size_t len;
+} MemHeadExternal;
+
+enum {
+  MEMHEAD_ALIGN_FLAG = 1,
+  MEMHEAD_EXTERNAL_FLAG = 2,
+};
+
+#define MEMHEAD_FROM_PTR(ptr) (((MemHead *)ptr) - 1)
+#define PTR_FROM_MEMHEAD(memhead) (memhead + 1)
+#define MEMHEAD_ALIGNED_FROM_PTR(ptr) (((MemHeadAligned *)ptr) - 1)
+#define MEMHEAD_IS_ALIGNED(memhead) ((memhead)->len & (size_t)MEMHEAD_ALIGN_FLAG)
+#define MEMHEAD_EXTERNAL_FROM_PTR(ptr) (((MemHeadExternal *)ptr) - 1)
+#define MEMHEAD_IS_EXTERNAL(memhead) ((memhead)->len & (size_t)MEMHEAD_EXTERNAL_FLAG)
+
+/* -------------------------------------------------------------------- */
+/** \name Size Classes
+ * \{ */
+
+/**
+ * Sizes of the blocks kept in the thread caches. The size of a block is determined by its
+ * length, so the size class does not have to be stored in the header.
+ */
+static const size_t size_classes[] = {16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024};
+#define SIZE_CLASSES_NUM (sizeof(size_classes) / sizeof(*size_classes))
+#define SIZE_CLASS_GRANULARITY 16
+#define SMALL_BLOCK_MAX_LEN 1024
+
+/** Maximum amount of memory kept in the free-list of a single size class of a thread. */
+#define CACHE_BIN_MAX_BYTES (64 * 1024)
+
+/**
+ * A thread adds its statistics to the shared counters when the memory it has in use changed by
+ * more than this amount since the last time. This also limits the error of the peak memory.
+ */
+#define STATS_FLUSH_BYTES (256 * 1024)
+
+/** Size class index for every multiple of #SIZE_CLASS_GRANULARITY, see #size_class_index. */
+static unsigned char size_class_lookup[SMALL_BLOCK_MAX_LEN / SIZE_CLASS_GRANULARITY + 1];
+
+MEM_INLINE unsigned int size_class_index(size_t len)
+{
+  return size_class_lookup[(len + SIZE_CLASS_GRANULARITY - 1) / SIZE_CLASS_GRANULARITY];
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Thread Caches
+ * \{ */
+
+/** Free small blocks are linked together, reusing the memory of the block. */
+typedef struct MemFreeBlock {
+  struct MemFreeBlock *next;
+} MemFreeBlock;
+
+typedef struct ThreadCacheBin {
+  MemFreeBlock *first;
+  /** Only written by the owning thread, read atomically for the statistics of other threads. */
+  uint32_t len;
+} ThreadCacheBin;
+
+typedef struct ThreadCache {
+  struct ThreadCache *next, *prev;
+  ThreadCacheBin bins[SIZE_CLASSES_NUM];
+  /**
+   * Changes of the statistics which have not been added to the shared counters yet. These are
+   * only written by the owning thread, and can become negative when blocks allocated by other
+   * threads are freed. Other threads read them when computing the statistics, so they are always
+   * accessed atomically.
+   */
+  int64_t totblock;
+  int64_t mem_in_use;
+} ThreadCache;
+
+/* Statistics of all threads that have been added to the shared counters. */
+static int64_t totblock_flushed = 0;
+static int64_t mem_in_use_flushed = 0;
+static size_t peak_mem = 0;
+static bool malloc_debug_memset = false;
+
+static void (*error_callback)(const char *) = NULL;
+
+/** List of the caches of all running threads, used to aggregate the statistics. */
+static ThreadCache *thread_caches_first = NULL;
+static pthread_mutex_t thread_caches_lock = PTHREAD_MUTEX_INITIALIZER;
+/** Used to free the cache when a thread exits. */
+static pthread_key_t thread_cache_key;
+static pthread_once_t thread_cache_once = PTHREAD_ONCE_INIT;
+
+static MEM_THREAD_LOCAL ThreadCache *thread_cache = NULL;
+
+static void thread_cache_flush_statistics(ThreadCache *cache)
+{
+  atomic_add_and_fetch_int64(&totblock_flushed, cache->totblock);
+  const int64_t mem_in_use = atomic_add_and_fetch_int64(&mem_in_use_flushed, cache->mem_in_use);
+  if (mem_in_use > 0) {
+    atomic_fetch_and_update_max_z(&peak_mem, (size_t)mem_in_use);
+  }
+  atomic_store_int64(&cache->totblock, 0);
+  atomic_store_int64(&cache->mem_in_use, 0);
+}
+
+static void thread_cache_free(void *data)
+{
+  ThreadCache *cache = (ThreadCache *)data;
+
+  pthread_mutex_lock(&thread_caches_lock);
+  thread_cache_flush_statistics(cache);
+  if (cache->prev) {
+    cache->prev->next = cache->next;
+  }
+  else {
+    thread_caches_first = cache->next;
+  }
+  if (cache->next) {
+    cache->next->prev = cache->prev;
+  }
+  pthread_mutex_unlock(&thread_caches_lock);
+
+  for (unsigned int i = 0; i < SIZE_CLASSES_NUM; i++) {
+    MemFreeBlock *block = cache->bins[i].first;
+    while (block) {
+      MemFreeBlock *next = block->next;
+      free(block);
+      block = next;
+    }
+  }
+  free(cache);
+  thread_cache = NULL;
+}
+
+static void thread_cache_init_once(void)
+{
+  unsigned int class_index = 0;
+  for (unsigned int i = 0; i < sizeof(size_class_lookup); i++) {
+    while (size_classes[class_index] < i * SIZE_CLASS_GRANULARITY) {
+      class_index++;
+    }
+    size_class_lookup[i] = (unsigned char)class_index;
+  }
+  pthread_key_create(&thread_cache_key, thread_cache_free);
+}
+
+static ThreadCache *thread_cache_create(void)
+{
+  pthread_once(&thread_cache_once, thread_cache_init_once);
+
+  ThreadCache *cache = (ThreadCache *)calloc(1, sizeof(ThreadCache));
+  if (UNLIKELY(cache == NULL)) {
+    return NULL;
+  }
+
+  pthread_mutex_lock(&thread_caches_lock);
+  cache->next = thread_caches_first;
+  if (thread_caches_first) {
+    thread_caches_first->prev = cache;
+  }
+  thread_caches_first = cache;
+  pthread_mutex_unlock(&thread_caches_lock);
+
+  pthread_setspecific(thread_cache_key, cache);
+  thread_cache = cache;
+  return cache;
+}
+
+MEM_INLINE ThreadCache *thread_cache_get(void)
+{
+  ThreadCache *cache = thread_cache;
+  if (LIKELY(cache)) {
+    return cache;
+  }
+  return thread_cache_create();
+}
+
+/** Count a new block in the statistics of the current thread. */
+MEM_INLINE void statistics_add(ThreadCache *cache, size_t len)
+{
+  atomic_store_int64(&cache->totblock, cache->totblock + 1);
+  atomic_store_int64(&cache->mem_in_use, cache->mem_in_use + (int64_t)len);
+  if (UNLIKELY(cache->mem_in_use > STATS_FLUSH_BYTES)) {
+    thread_cache_flush_statistics(cache);
+  }
+}
+
+MEM_INLINE void statistics_remove(ThreadCache *cache, size_t len)
+{
+  atomic_store_int64(&cache->totblock, cache->totblock - 1);
+  atomic_store_int64(&cache->mem_in_use, cache->mem_in_use - (int64_t)len);
+  if (UNLIKELY(cache->mem_in_use < -STATS_FLUSH_BYTES)) {
+    thread_cache_flush_statistics(cache);
+  }
+}
+
+/**
+ * Get a block which can hold a #MemHead and `len` bytes, from the cache if possible.
+ */
+static MemHead *small_block_alloc(ThreadCache *cache, size_t len)
+{
+  const unsigned int class_index = size_class_index(len);
+  ThreadCacheBin *bin = &cache->bins[class_index];
+  if (bin->first) {
+    MemFreeBlock *block = bin->first;
+    bin->first = block->next;
+    atomic_store_uint32(&bin->len, bin->len - 1);
+    return (MemHead *)block;
+  }
+  return (MemHead *)malloc(size_classes[class_index] + sizeof(MemHead));
+}
+
+static void small_block_free(ThreadCache *cache, MemHead *memh, size_t len)
+{
+  const unsigned int class_index = size_class_index(len);
+  ThreadCacheBin *bin = &cache->bins[class_index];
+  if (bin->len * size_classes[class_index] >= CACHE_BIN_MAX_BYTES) {
+    free(memh);
+    return;
+  }
+  MemFreeBlock *block = (MemFreeBlock *)memh;
+  block->next = bin->first;
+  bin->first = block;
+  atomic_store_uint32(&bin->len, bin->len + 1);
+}
+
+/**
+ * Compute the statistics of all threads. They may be slightly outdated when other threads are
+ * allocating memory at the same time.
+ */
+static void statistics_get(int64_t *r_totblock, int64_t *r_mem_in_use)
+{
+  int64_t totblock = atomic_load_int64(&totblock_flushed);
+  int64_t mem_in_use = atomic_load_int64(&mem_in_use_flushed);
+  pthread_mutex_lock(&thread_caches_lock);
+  for (ThreadCache *cache = thread_caches_first; cache; cache = cache->next) {
+    totblock += atomic_load_int64(&cache->totblock);
+    mem_in_use += atomic_load_int64(&cache->mem_in_use);
+  }
+  pthread_mutex_unlock(&thread_caches_lock);
+  *r_totblock = totblock;
+  *r_mem_in_use = mem_in_use;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Allocator API
+ * \{ */
+
+#ifdef __GNUC__
+__attribute__((format(printf, 1, 2)))
+#endif
+static void
+print_error(const char *str, ...)
+{
+  char buf[512];
+  va_list ap;
+
+  va_start(ap, str);
+  vsnprintf(buf, sizeof(buf), str, ap);
+  va_end(ap);
+  buf[sizeof(buf) - 1] = '\0';
+
+  if (error_callback) {
+    error_callback(buf);
+  }
+}
+
+size_t MEM_threadcache_allocN_len(const void *vmemh)
+{
+  if (vmemh) {
+    return MEMHEAD_FROM_PTR(vmemh)->len &
+           ~((size_t)(MEMHEAD_ALIGN_FLAG | MEMHEAD_EXTERNAL_FLAG));
+  }
+
+  return 0;
+}
+
+void MEM_threadcache_freeN(void *vmemh)
+{
+  if (leak_detector_has_run) {
+    print_error("%s\n", free_after_leak_detection_message);
+  }
+
+  if (vmemh == NULL) {
+    print_error("Attempt to free NULL pointer\n");
+#ifdef WITH_ASSERT_ABORT
+    abort();
+#endif
+    return;
+  }
+
+  MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+  size_t len = MEM_threadcache_allocN_len(vmemh);
+
+  if (UNLIKELY(MEMHEAD_IS_EXTERNAL(memh))) {
+    /* Not counted in the statistics, the owner is responsible for the memory. */
+    MemHeadExternal *memh_external = MEMHEAD_EXTERNAL_FROM_PTR(vmemh);
+    memh_external->free_fn(memh_external->user_data);
+    return;
+  }
+
+  ThreadCache *cache = thread_cache_get();
+  if (UNLIKELY(cache == NULL)) {
+    /* Only happens when the cache can't be allocated, the statistics are not updated then. */
+    if (MEMHEAD_IS_ALIGNED(memh)) {
+      aligned_free(MEMHEAD_REAL_PTR(MEMHEAD_ALIGNED_FROM_PTR(vmemh)));
+    }
+    else {
+      free(memh);
+    }
+    return;
+  }
+
+  statistics_remove(cache, len);
+
+  if (UNLIKELY(malloc_debug_memset && len)) {
+    memset(memh + 1, 255, len);
+  }
+  if (UNLIKELY(MEMHEAD_IS_ALIGNED(memh))) {
+    MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
+    aligned_free(MEMHEAD_REAL_PTR(memh_aligned));
+  }
+  else if (len <= SMALL_BLOCK_MAX_LEN) {
+    small_block_free(cache, memh, len);
+  }
+  else {
+    free(memh);
+  }
+}
+
+void *MEM_threadcache_dupallocN(const void *vmemh)
+{
+  void *newp = NULL;
+  if (vmemh) {
+    MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+    const size_t prev_size = MEM_threadcache_allocN_len(vmemh);
+    if (UNLIKELY(MEMHEAD_IS_ALIGNED(memh))) {
+      MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
+      newp = MEM_threadcache_mallocN_aligned(
+          prev_size, (size_t)memh_aligned->alignment, "dupli_malloc");
+    }
+    else {
+      newp = MEM_threadcache_mallocN(prev_size, "dupli_malloc");
+    }
+    memcpy(newp, vmemh, prev_size);
+  }
+  return newp;
+}
+
+void *MEM_threadcache_reallocN_id(void *vmemh, size_t len, const char *str)
+{
+  void *newp = NULL;
+
+  if (vmemh) {
+    MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+    size_t old_len = MEM_threadcache_allocN_len(vmemh);
+
+    if (LIKELY(!MEMHEAD_IS_ALIGNED(memh))) {
+      newp = MEM_threadcache_mallocN(len, "realloc");
+    }
+    else {
+      MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
+      newp = MEM_threadcache_mallocN_aligned(len, (size_t)memh_aligned->alignment, "realloc");
+    }
+
+    if (newp) {
+      if (len < old_len) {
+        /* shrink */
+        memcpy(newp, vmemh, len);
+      }
+      else {
+        /* grow (or remain same size) */
+        memcpy(newp, vmemh, old_len);
+      }
+    }
+
+    MEM_threadcache_freeN(vmemh);
+  }
+  else {
+    newp = MEM_threadcache_mallocN(len, str);
+  }
+
+  return newp;
+}
+
+void *MEM_threadcache_recallocN_id(void *vmemh, size_t len, const char *str)
+{
+  void *newp = NULL;
+
+  if (vmemh) {
+    MemHead *memh = MEMHEAD_FROM_PTR(vmemh);
+    size_t old_len = MEM_threadcache_allocN_len(vmemh);
+
+    if (LIKELY(!MEMHEAD_IS_ALIGNED(memh))) {
+      newp = MEM_threadcache_mallocN(len, "recalloc");
+    }
+    else {
+      MemHeadAligned *memh_aligned = MEMHEAD_ALIGNED_FROM_PTR(vmemh);
+      newp = MEM_threadcache_mallocN_aligned(len, (size_t)memh_aligned->alignment, "recalloc");
+    }
+
+    if (newp) {
+      if (len < old_len) {
+        /* shrink */
+        memcpy(newp, vmemh, len);
+      }
+      else {
+        memcpy(newp, vmemh, old_len);
+
+        if (len > old_len) {
+          /* grow */
+          /* zero new bytes */
+          memset(((char *)newp) + old_len, 0, len - old_len);
+        }
+      }
+    }
+
+    MEM_threadcache_freeN(vmemh);
+  }
+  else {
+    newp = MEM_threadcache_callocN(len, str);
+  }
+
+  return newp;
+}
+
+void *MEM_threadcache_callocN(size_t len, const char *str)
+{
+  len = SIZET_ALIGN_4(len);
+
+  ThreadCache *cache = thread_cache_get();
+  MemHead *memh = NULL;
+  if (LIKELY(cache)) {
+    if (len <= SMALL_BLOCK_MAX_LEN) {
+      memh = small_block_alloc(cache, len);
+      if (LIKELY(memh)) {
+        memset(memh + 1, 0, len);
+      }
+    }
+    else {
+      memh = (MemHead *)calloc(1, len + sizeof(MemHead));
+    }
+  }
+
+  if (LIKELY(memh)) {
+    memh->len = len;
+    statistics_add(cache, len);
+
+    return PTR_FROM_MEMHEAD(memh);
+  }
+  print_error("Calloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
+              SIZET_ARG(len),
+              str,
+              (unsigned int)MEM_threadcache_get_memory_in_use());
+  return NULL;
+}
+
+void *MEM_threadcache_calloc_arrayN(size_t len, size_t size, const char *str)
+{
+  size_t total_size;
+  if (UNLIKELY(!MEM_size_safe_multiply(len, size, &total_size))) {
+    print_error(
+        "Calloc array aborted due to integer overflow: "
+        "len=" SIZET_FORMAT "x" SIZET_FORMAT " in %s, total %u\n",
+        SIZET_ARG(len),
+        SIZET_ARG(size),
+        str,
+        (unsigned int)MEM_threadcache_get_memory_in_use());
+    abort();
+    return NULL;
+  }
+
+  return MEM_threadcache_callocN(total_size, str);
+}
+
+void *MEM_threadcache_mallocN(size_t len, const char *str)
+{
+  len = SIZET_ALIGN_4(len);
+
+  ThreadCache *cache = thread_cache_get();
+  MemHead *memh = NULL;
+  if (LIKELY(cache)) {
+    if (len <= SMALL_BLOCK_MAX_LEN) {
+      memh = small_block_alloc(cache, len);
+    }
+    else {
+      memh = (MemHead *)malloc(len + sizeof(MemHead));
+    }
+  }
+
+  if (LIKELY(memh)) {
+    if (UNLIKELY(malloc_debug_memset && len)) {
+      memset(memh + 1, 255, len);
+    }
+
+    memh->len = len;
+    statistics_add(cache, len);
+
+    return PTR_FROM_MEMHEAD(memh);
+  }
+  print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
+              SIZET_ARG(len),
+              str,
+              (unsigned int)MEM_threadcache_get_memory_in_use());
+  return NULL;
+}
+
+void *MEM_threadcache_malloc_arrayN(size_t len, size_t size, const char *str)
+{
+  size_t total_size;
+  if (UNLIKELY(!MEM_size_safe_multiply(len, size, &total_size))) {
+    print_error(
+        "Malloc array aborted due to integer overflow: "
+        "len=" SIZET_FORMAT "x" SIZET_FORMAT " in %s, total %u\n",
+        SIZET_ARG(len),
+        SIZET_ARG(size),
+        str,
+        (unsigned int)MEM_threadcache_get_memory_in_use());
+    abort();
+    return NULL;
+  }
+
+  return MEM_threadcache_mallocN(total_size, str);
+}
+
+void *MEM_threadcache_mallocN_aligned(size_t len, size_t alignment, const char *str)
+{
+  /* Huge alignment values doesn't make sense and they wouldn't fit into 'short' used in the
+   * MemHead. */
+  assert(alignment < 1024);
+
+  /* We only support alignments that are a power of two. */
+  assert(IS_POW2(alignment));
+
+  /* Some OS specific aligned allocators require a certain minimal alignment. */
+  if (alignment < ALIGNED_MALLOC_MINIMUM_ALIGNMENT) {
+    alignment = ALIGNED_MALLOC_MINIMUM_ALIGNMENT;
+  }
+
+  /* It's possible that MemHead's size is not properly aligned, do extra padding to deal with
+   * this. Aligned blocks are not cached, they are rare compared to other small blocks. */
+  size_t extra_padding = MEMHEAD_ALIGN_PADDING(alignment);
+
+  len = SIZET_ALIGN_4(len);
+
+  ThreadCache *cache = thread_cache_get();
+  MemHeadAligned *memh = NULL;
+  if (LIKELY(cache)) {
+    memh = (MemHeadAligned *)aligned_malloc(len + extra_padding + sizeof(MemHeadAligned),
+                                            alignment);
+  }
+
+  if (LIKELY(memh)) {
+    /* We keep padding in the beginning of MemHead,
+     * this way it's always possible to get MemHead
+     * from the data pointer.
+     */
+    memh = (MemHeadAligned *)((char *)memh + extra_padding);
+
+    if (UNLIKELY(malloc_debug_memset && len)) {
+      memset(memh + 1, 255, len);
+    }
+
+    memh->len = len | (size_t)MEMHEAD_ALIGN_FLAG;
+    memh->alignment = (short)alignment;
+    statistics_add(cache, len);
+
+    return PTR_FROM_MEMHEAD(memh);
+  }
+  print_error("Malloc returns null: len=" SIZET_FORMAT " in %s, total %u\n",
+              SIZET_ARG(len),
+              str,
+              (unsigned int)MEM_threadcache_get_memory_in_use());
+  return NULL;
+}
+
+bool MEM_threadcache_external_wrap(void *ptr,
+                                   size_t len,
+                                   void (*free_fn)(void *user_data),
+                                   void *user_data)
+{
+  /* The length shares its bits with the flags. */
+  assert((len & (size_t)(MEMHEAD_ALIGN_FLAG | MEMHEAD_EXTERNAL_FLAG)) == 0);
+  assert(((uintptr_t)ptr % sizeof(void *)) == 0);
+
+  MemHeadExternal *memh = MEMHEAD_EXTERNAL_FROM_PTR(ptr);
+  memh->free_fn = free_fn;
+  memh->user_data = user_data;
+  memh->len = len | (size_t)MEMHEAD_EXTERNAL_FLAG;
+
+  return true;
+}
+
+void MEM_threadcache_printmemlist_pydict(void)
+{
+}
+
+void MEM_threadcache_printmemlist(void)
+{
+}
+
+/* unused */
+void MEM_threadcache_callbackmemlist(void (*func)(void *))
+{
+  (void)func; /* Ignored. */
+}
+
+void MEM_threadcache_printmemlist_stats(void)
+{
+  size_t cached_mem = 0;
+  unsigned int threads_num = 0;
+  pthread_mutex_lock(&thread_caches_lock);
+  for (ThreadCache *cache = thread_caches_first; cache; cache = cache->next) {
+    for (unsigned int i = 0; i < SIZE_CLASSES_NUM; i++) {
+      cached_mem += atomic_load_uint32(&cache->bins[i].len) * size_classes[i];
+    }
+    threads_num++;
+  }
+  pthread_mutex_unlock(&thread_caches_lock);
+
+  printf("\ntotal memory len: %.3f MB\n",
+         (double)MEM_threadcache_get_memory_in_use() / (double)(1024 * 1024));
+  printf("peak memory len: %.3f MB\n",
+         (double)MEM_threadcache_get_peak_memory() / (double)(1024 * 1024));
+  printf("cached free memory len: %.3f MB in %u threads\n",
+         (double)cached_mem / (double)(1024 * 1024),
+         threads_num);
+  printf(
+      "\nFor more detailed per-block statistics run Blender with memory debugging command line "
+      "argument.\n");
+
+#ifdef HAVE_MALLOC_STATS
+  printf("System Statistics:\n");
+  malloc_stats();
+#endif
+}
+
+void MEM_threadcache_set_error_callback(void (*func)(const char *))
+{
+  error_callback = func;
+}
+
+bool MEM_threadcache_consistency_check(void)
+{
+  return true;
+}
+
+void MEM_threadcache_set_memory_debug(void)
+{
+  malloc_debug_memset = true;
+}
+
+size_t MEM_threadcache_get_memory_in_use(void)
+{
+  int64_t totblock, mem_in_use;
+  statistics_get(&totblock, &mem_in_use);
+  return mem_in_use > 0 ? (size_t)mem_in_use : 0;
+}
+
+unsigned int MEM_threadcache_get_memory_blocks_in_use(void)
+{
+  int64_t totblock, mem_in_use;
+  statistics_get(&totblock, &mem_in_use);
+  return totblock > 0 ? (unsigned int)totblock : 0;
+}
+
+void MEM_threadcache_reset_peak_memory(void)
+{
+  atomic_store_z(&peak_mem, MEM_threadcache_get_memory_in_use());
+}
+
+size_t MEM_threadcache_get_peak_memory(void)
+{
+  /* The shared peak only changes when threads add their statistics, the current value might be
+   * higher. */
+  const size_t mem_in_use = MEM_threadcache_get_memory_in_use();
+  const size_t peak = atomic_load_z(&peak_mem);
+  return mem_in_use > peak ? mem_in_use : peak;
+}
+
+#ifndef NDEBUG
+const char *MEM_threadcache_name_ptr(void *vmemh)
+{
+  if (vmemh) {
+    return "unknown block name ptr";
+  }
+
+  return "MEM_threadcache_name_ptr(NULL)";
+}
+#endif /* NDEBUG */
+
+/** \} */
@@ -0,0 +1,72 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+#include "guardedalloc_test_base.h"
+
+namespace {
+
+struct ExternalBuffer {
+  /* Room for the header, followed by the data. */
+  uint64_t memory[(MEM_EXTERNAL_HEADER_SIZE + 64) / sizeof(uint64_t)];
+  int free_count = 0;
+
+  int *data()
+  {
+    return (int *)((char *)memory + MEM_EXTERNAL_HEADER_SIZE);
+  }
+};
+
+void external_buffer_free(void *user_data)
+{
+  ((ExternalBuffer *)user_data)->free_count++;
+}
+
+void DoExternalWrapChecks()
+{
+  ExternalBuffer buffer;
+  int *data = buffer.data();
+  for (int i = 0; i < 16; i++) {
+    data[i] = i;
+  }
+
+  const size_t memory_in_use = MEM_get_memory_in_use();
+  EXPECT_TRUE(MEM_external_wrap(data, sizeof(int) * 16, external_buffer_free, &buffer));
+  EXPECT_EQ(MEM_allocN_len(data), sizeof(int) * 16);
+  EXPECT_EQ(MEM_get_memory_in_use(), memory_in_use);
+
+  int *copy = (int *)MEM_dupallocN(data);
+  EXPECT_EQ(MEM_allocN_len(copy), sizeof(int) * 16);
+  EXPECT_EQ(copy[15], 15);
+  MEM_freeN(copy);
+  EXPECT_EQ(buffer.free_count, 0);
+
+  data = (int *)MEM_reallocN(data, sizeof(int) * 32);
+  EXPECT_EQ(buffer.free_count, 1);
+  EXPECT_EQ(data[15], 15);
+  MEM_freeN(data);
+
+  EXPECT_TRUE(MEM_external_wrap(buffer.data(), sizeof(int) * 16, external_buffer_free, &buffer));
+  MEM_freeN(buffer.data());
+  EXPECT_EQ(buffer.free_count, 2);
+  EXPECT_EQ(MEM_get_memory_in_use(), memory_in_use);
+}
+
+}  // namespace
+
+TEST_F(LockFreeAllocatorTest, MEM_external_wrap)
+{
+  DoExternalWrapChecks();
+}
+
+TEST_F(ThreadCacheAllocatorTest, MEM_external_wrap)
+{
+  DoExternalWrapChecks();
+}
+
+TEST_F(GuardedAllocatorTest, MEM_external_wrap)
+{
+  ExternalBuffer buffer;
+  EXPECT_FALSE(MEM_external_wrap(buffer.data(), sizeof(int) * 16, external_buffer_free, &buffer));
+}
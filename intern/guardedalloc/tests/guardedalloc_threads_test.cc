@@ -0,0 +1,136 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+#include "guardedalloc_test_base.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+int get_threads_num()
+{
+  const int hardware_threads = int(std::thread::hardware_concurrency());
+  return std::max(hardware_threads, 2);
+}
+
+/**
+ * Allocate and free small blocks of different sizes, keeping a few of them alive at any time,
+ * like many short-lived temporary allocations do.
+ */
+void allocate_and_free_blocks(const int iterations)
+{
+  constexpr int live_blocks_num = 64;
+  void *live_blocks[live_blocks_num] = {nullptr};
+  for (int i = 0; i < iterations; i++) {
+    const int slot = i % live_blocks_num;
+    if (live_blocks[slot]) {
+      MEM_freeN(live_blocks[slot]);
+    }
+    const size_t size = 8 + size_t(i * 7919 % 500);
+    live_blocks[slot] = MEM_mallocN(size, __func__);
+  }
+  for (void *block : live_blocks) {
+    if (block) {
+      MEM_freeN(block);
+    }
+  }
+}
+
+void DoMultiThreadedAllocationBenchmark(const char *allocator_name)
+{
+  const int threads_num = get_threads_num();
+  const int iterations = 1000000;
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < threads_num; i++) {
+    threads.emplace_back(allocate_and_free_blocks, iterations);
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  const double duration_ms = std::chrono::duration<double, std::milli>(end - start).count();
+  std::cout << allocator_name << ": " << threads_num << " threads, " << iterations
+            << " allocations each: " << duration_ms << " ms\n";
+
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), 0u);
+  EXPECT_EQ(MEM_get_memory_in_use(), 0u);
+}
+
+}  // namespace
+
+TEST_F(LockFreeAllocatorTest, MultiThreadedAllocationPerformance)
+{
+  DoMultiThreadedAllocationBenchmark("Lock-free");
+}
+
+TEST_F(ThreadCacheAllocatorTest, MultiThreadedAllocationPerformance)
+{
+  DoMultiThreadedAllocationBenchmark("Thread-cached");
+}
+
+TEST_F(ThreadCacheAllocatorTest, ReuseSmallBlocks)
+{
+  void *block = MEM_mallocN(100, __func__);
+  memset(block, 1, 100);
+  MEM_freeN(block);
+
+  /* Blocks of the same size class are reused by the same thread. */
+  char *block_calloc = (char *)MEM_callocN(110, __func__);
+  EXPECT_EQ(block_calloc, block);
+  EXPECT_EQ(MEM_allocN_len(block_calloc), 112u);
+  for (int i = 0; i < 110; i++) {
+    EXPECT_EQ(block_calloc[i], 0);
+  }
+  MEM_freeN(block_calloc);
+
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), 0u);
+  EXPECT_EQ(MEM_get_memory_in_use(), 0u);
+}
+
+TEST_F(ThreadCacheAllocatorTest, MultiThreadedStatistics)
+{
+  const int threads_num = get_threads_num();
+  constexpr int blocks_per_thread = 10000;
+
+  /* Blocks allocated by other threads stay alive after these threads have exited, and are
+   * freed by the main thread. */
+  std::vector<std::vector<void *>> blocks(threads_num);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < threads_num; i++) {
+    threads.emplace_back([&, i]() {
+      for (int j = 0; j < blocks_per_thread; j++) {
+        blocks[i].push_back(MEM_mallocN(size_t(j % 2000), __func__));
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  size_t expected_mem_in_use = 0;
+  for (const std::vector<void *> &thread_blocks : blocks) {
+    for (void *block : thread_blocks) {
+      expected_mem_in_use += MEM_allocN_len(block);
+    }
+  }
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), unsigned(threads_num * blocks_per_thread));
+  EXPECT_EQ(MEM_get_memory_in_use(), expected_mem_in_use);
+  EXPECT_GE(MEM_get_peak_memory(), expected_mem_in_use);
+
+  for (const std::vector<void *> &thread_blocks : blocks) {
+    for (void *block : thread_blocks) {
+      MEM_freeN(block);
+    }
+  }
+  EXPECT_EQ(MEM_get_memory_blocks_in_use(), 0u);
+  EXPECT_EQ(MEM_get_memory_in_use(), 0u);
+}
@@ -24,6 +24,9 @@
 #include <opensubdiv/osd/cpuEvaluator.h>
 #include <opensubdiv/osd/cpuPatchTable.h>
 #include <opensubdiv/osd/cpuVertexBuffer.h>
+#ifdef OPENSUBDIV_HAS_TBB
+#  include <opensubdiv/osd/tbbEvaluator.h>
+#endif
 
 using OpenSubdiv::Far::StencilTable;
 using OpenSubdiv::Osd::CpuEvaluator;
@@ -32,13 +35,37 @@ using OpenSubdiv::Osd::CpuVertexBuffer;
 namespace blender {
 namespace opensubdiv {
 
+#ifdef OPENSUBDIV_HAS_TBB
+// Refinement evaluates the stencils of all vertices at once, which is done in parallel with TBB
+// when OpenSubdiv supports it. Patches are evaluated one point at a time by callers which are
+// already multi-threaded, so they keep using the serial evaluator which has less overhead.
+class CpuParallelStencilsEvaluator : public CpuEvaluator {
+ public:
+  template<typename SRC_BUFFER, typename DST_BUFFER, typename STENCIL_TABLE>
+  static bool EvalStencils(SRC_BUFFER *src_buffer,
+                           const BufferDescriptor &src_desc,
+                           DST_BUFFER *dst_buffer,
+                           const BufferDescriptor &dst_desc,
+                           const STENCIL_TABLE *stencil_table,
+                           const CpuParallelStencilsEvaluator * /*instance*/ = NULL,
+                           void * /*device_context*/ = NULL)
+  {
+    return OpenSubdiv::Osd::TbbEvaluator::EvalStencils(
+        src_buffer, src_desc, dst_buffer, dst_desc, stencil_table);
+  }
+};
+typedef CpuParallelStencilsEvaluator CpuOutputEvaluator;
+#else
+typedef CpuEvaluator CpuOutputEvaluator;
+#endif
+
 // Note: Define as a class instead of typedef to make it possible
 // to have anonymous class in opensubdiv_evaluator_internal.h
 class CpuEvalOutput : public VolatileEvalOutput<CpuVertexBuffer,
                                                 CpuVertexBuffer,
                                                 StencilTable,
                                                 CpuPatchTable,
-                                                CpuEvaluator> {
+                                                CpuOutputEvaluator> {
  public:
   CpuEvalOutput(const StencilTable *vertex_stencils,
                 const StencilTable *varying_stencils,
@@ -50,7 +77,7 @@ class CpuEvalOutput : public VolatileEvalOutput<CpuVertexBuffer,
                            CpuVertexBuffer,
                            StencilTable,
                            CpuPatchTable,
-                           CpuEvaluator>(vertex_stencils,
+                           CpuOutputEvaluator>(vertex_stencils,
                                          varying_stencils,
                                          all_face_varying_stencils,
                                          face_varying_width,
@@ -149,6 +149,7 @@ IFACEMETHODIMP CBlendThumb::GetThumbnail(UINT cx, HBITMAP *phbmp, WTS_ALPHATYPE
   file->reader.read = stream_read;
   file->reader.seek = stream_seek;
   file->reader.close = stream_close;
+  file->reader.claim = nullptr;
   file->reader.offset = 0;
   file->_pStream = _pStream;
 
@@ -133,6 +133,70 @@ inline ColorGeometry4f mix3(const float3 &weights,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Mix four values of the same type.
+ *
+ * This is typically used to evaluate cubic splines from their basis weights.
+ * \{ */
+
+template<typename T>
+T mix4(const float4 &weights, const T &v0, const T &v1, const T &v2, const T &v3);
+
+template<>
+inline int8_t mix4(
+    const float4 &weights, const int8_t &v0, const int8_t &v1, const int8_t &v2, const int8_t &v3)
+{
+  return static_cast<int8_t>(weights.x * v0 + weights.y * v1 + weights.z * v2 + weights.w * v3);
+}
+
+template<>
+inline bool mix4(
+    const float4 &weights, const bool &v0, const bool &v1, const bool &v2, const bool &v3)
+{
+  return (weights.x * v0 + weights.y * v1 + weights.z * v2 + weights.w * v3) >= 0.5f;
+}
+
+template<>
+inline int mix4(const float4 &weights, const int &v0, const int &v1, const int &v2, const int &v3)
+{
+  return static_cast<int>(weights.x * v0 + weights.y * v1 + weights.z * v2 + weights.w * v3);
+}
+
+template<>
+inline float mix4(
+    const float4 &weights, const float &v0, const float &v1, const float &v2, const float &v3)
+{
+  return weights.x * v0 + weights.y * v1 + weights.z * v2 + weights.w * v3;
+}
+
+template<>
+inline float2 mix4(
+    const float4 &weights, const float2 &v0, const float2 &v1, const float2 &v2, const float2 &v3)
+{
+  return weights.x * v0 + weights.y * v1 + weights.z * v2 + weights.w * v3;
+}
+
+template<>
+inline float3 mix4(
+    const float4 &weights, const float3 &v0, const float3 &v1, const float3 &v2, const float3 &v3)
+{
+  return weights.x * v0 + weights.y * v1 + weights.z * v2 + weights.w * v3;
+}
+
+template<>
+inline ColorGeometry4f mix4(const float4 &weights,
+                            const ColorGeometry4f &v0,
+                            const ColorGeometry4f &v1,
+                            const ColorGeometry4f &v2,
+                            const ColorGeometry4f &v3)
+{
+  ColorGeometry4f result;
+  interp_v4_v4v4v4v4(result, v0, v1, v2, v3, weights);
+  return result;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Mix two values of the same type.
  *
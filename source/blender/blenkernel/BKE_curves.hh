@@ -25,6 +25,23 @@
 
 namespace blender::bke {
 
+namespace curves::nurbs {
+
+struct BasisCache {
+  /**
+   * For each evaluated point, the weight for all control points that influences it.
+   * The vector's size is the evaluated point count multiplied by the curve's order.
+   */
+  Vector<float> weights;
+  /**
+   * For each evaluated point, an offset into the curve's control points for the start of
+   * #weights. In other words, the index of the first control point that influences this point.
+   */
+  Vector<int> start_indices;
+};
+
+}  // namespace curves::nurbs
+
 /**
  * Contains derived data, caches, and other information not saved in files, besides a few pointers
  * to arrays that are kept in the non-runtime struct to avoid dereferencing this whenever they are
@@ -32,11 +49,39 @@ namespace blender::bke {
  */
 class CurvesGeometryRuntime {
  public:
+  /**
+   * Cache of offsets into the evaluated array for each curve, accounting for all previous
+   * evaluated points, Bezier curve vector segments, different resolutions per spline, etc.
+   */
+  mutable Vector<int> evaluated_offsets_cache;
+  /**
+   * The start of every Bezier segment in the evaluated points of its curve. The offsets of every
+   * curve have one more value than its number of control points, so they are stored at the
+   * curve's point range shifted by the curve index.
+   */
+  mutable Vector<int> bezier_evaluated_offsets;
+  mutable std::mutex offsets_cache_mutex;
+  mutable bool offsets_cache_dirty = true;
+
+  /** Cache of the weights used to evaluate every NURBS curve, empty for other types. */
+  mutable Vector<curves::nurbs::BasisCache> nurbs_basis_cache;
+  mutable std::mutex nurbs_basis_cache_mutex;
+  mutable bool nurbs_basis_cache_dirty = true;
+
   /** Cache of evaluated positions. */
   mutable Vector<float3> evaluated_position_cache;
   mutable std::mutex position_cache_mutex;
   mutable bool position_cache_dirty = true;
 
+  /**
+   * Cache of lengths along each evaluated curve for each evaluated point. The lengths of every
+   * curve are stored at its evaluated point range shifted by the curve index, since cyclic curves
+   * have one more length than evaluated points.
+   */
+  mutable Vector<float> evaluated_length_cache;
+  mutable std::mutex length_cache_mutex;
+  mutable bool length_cache_dirty = true;
+
   /** Direction of the spline at each evaluated point. */
   mutable Vector<float3> evaluated_tangents_cache;
   mutable std::mutex tangent_cache_mutex;
@@ -85,12 +130,6 @@ class CurvesGeometry : public ::CurvesGeometry {
   IndexRange points_range() const;
   IndexRange curves_range() const;
 
-  /**
-   * The total number of points in the evaluated poly curve.
-   * This can depend on the resolution attribute if it exists.
-   */
-  int evaluated_points_size() const;
-
   /**
    * Access a range of indices of point data for a specific curve.
    */
@@ -101,9 +140,74 @@ class CurvesGeometry : public ::CurvesGeometry {
   /** Mutable access to curve types. Call #tag_topology_changed after changing any type. */
   MutableSpan<int8_t> curve_types();
 
+  bool has_curve_with_type(CurveType type) const;
+
   MutableSpan<float3> positions();
   Span<float3> positions() const;
 
+  /** Whether the curve loops around to connect to itself, on the curve domain. */
+  VArray<bool> cyclic() const;
+  /** Mutable access to curve cyclic values. Call #tag_topology_changed after changes. */
+  MutableSpan<bool> cyclic();
+
+  /**
+   * How many evaluated points to create for each segment when evaluating Bezier,
+   * Catmull Rom, and NURBS curves. On the curve domain.
+   */
+  VArray<int> resolution() const;
+  /** Mutable access to curve resolution. Call #tag_topology_changed after changes. */
+  MutableSpan<int> resolution();
+
+  /** The angle used to rotate evaluated normals around the tangents, on the point domain. */
+  VArray<float> tilt() const;
+  MutableSpan<float> tilt();
+
+  /**
+   * Which method to use for calculating the normals of evaluated points (#NormalMode).
+   * Call #tag_normals_changed after changes.
+   */
+  VArray<int8_t> normal_mode() const;
+  MutableSpan<int8_t> normal_mode();
+
+  /**
+   * Handle types for Bezier control points. Call #tag_topology_changed after changes.
+   */
+  VArray<int8_t> handle_types_left() const;
+  MutableSpan<int8_t> handle_types_left();
+  VArray<int8_t> handle_types_right() const;
+  MutableSpan<int8_t> handle_types_right();
+
+  /**
+   * The positions of Bezier curve handles. Though these are really control points for the Bezier
+   * segments, they are stored in separate arrays to better reflect user expectations. Note that
+   * values may be generated automatically based on the handle types. Call #tag_positions_changed
+   * after changes.
+   */
+  Span<float3> handle_positions_left() const;
+  MutableSpan<float3> handle_positions_left();
+  Span<float3> handle_positions_right() const;
+  MutableSpan<float3> handle_positions_right();
+
+  /**
+   * The order (degree plus one) of each NURBS curve, on the curve domain.
+   * Call #tag_topology_changed after changes.
+   */
+  VArray<int8_t> nurbs_orders() const;
+  MutableSpan<int8_t> nurbs_orders();
+
+  /**
+   * The automatic generation mode for each NURBS curve's knots vector, on the curve domain.
+   * Call #tag_topology_changed after changes.
+   */
+  VArray<int8_t> nurbs_knots_modes() const;
+  MutableSpan<int8_t> nurbs_knots_modes();
+
+  /**
+   * The weight for each control point for NURBS curves. Call #tag_positions_changed after changes.
+   */
+  Span<float> nurbs_weights() const;
+  MutableSpan<float> nurbs_weights();
+
   /**
    * Calculate the largest and smallest position values, only including control points
    * (rather than evaluated points). The existing values of `min` and `max` are taken into account.
@@ -119,10 +223,73 @@ class CurvesGeometry : public ::CurvesGeometry {
   Span<int> offsets() const;
   MutableSpan<int> offsets();
 
+  /* --------------------------------------------------------------------
+   * Evaluation.
+   */
+
+  /**
+   * The total number of points in the evaluated poly curve.
+   * This can depend on the resolution attribute if it exists.
+   */
+  int evaluated_points_size() const;
+
+  /**
+   * Access a range of indices of point data for a specific curve.
+   * Call #evaluated_offsets() first to ensure that the evaluated offsets cache is current.
+   */
+  IndexRange evaluated_range_for_curve(int index) const;
+
+  /**
+   * The index of the first evaluated point for every curve. The size of this span is one larger
+   * than the number of curves. Consider using #evaluated_range_for_curve rather than using the
+   * offsets directly.
+   */
+  Span<int> evaluated_offsets() const;
+
+  /** Calculates the data described by #evaluated_offsets if necessary. */
+  void ensure_evaluated_offsets() const;
+
+  Span<float3> evaluated_positions() const;
+  Span<float3> evaluated_tangents() const;
+  Span<float3> evaluated_normals() const;
+
+  /**
+   * Return a cache of accumulated lengths along the curve. Each item is the length of the
+   * subsequent segment (the first value is the length of the first segment rather than 0).
+   * This calculation is rather trivial, and only depends on the evaluated positions, but
+   * the results are used often, and it is necessarily single threaded per curve, so it is cached.
+   *
+   * \warning Call #ensure_evaluated_lengths() first to ensure the cache is current.
+   */
+  Span<float> evaluated_lengths_for_curve(int curve_index, bool cyclic) const;
+  float evaluated_length_total_for_curve(int curve_index, bool cyclic) const;
+
+  /** Calculates the data described by #evaluated_lengths_for_curve if necessary. */
+  void ensure_evaluated_lengths() const;
+
+  /**
+   * Evaluate a generic data to the standard evaluated points of a specific curve,
+   * defined by the resolution attribute or other factors, depending on the curve type.
+   *
+   * \warning This function expects offsets to the evaluated points for each curve to be
+   * calculated. That can be ensured with #ensure_evaluated_offsets.
+   */
+  void interpolate_to_evaluated(int curve_index, fn::GSpan src, fn::GMutableSpan dst) const;
+
+ private:
+  /**
+   * Make sure the basis weights for NURBS curve's evaluated points are calculated.
+   */
+  void ensure_nurbs_basis_cache() const;
+
+  /** Return the slice of #evaluated_length_cache that corresponds to this curve index. */
+  IndexRange lengths_range_for_curve(int curve_index, bool cyclic) const;
+
   /* --------------------------------------------------------------------
    * Operations.
    */
 
+ public:
   /**
    * Change the number of elements. New values for existing attributes should be properly
    * initialized afterwards.
@@ -139,6 +306,9 @@ class CurvesGeometry : public ::CurvesGeometry {
   /** Call after changing the "tilt" or "up" attributes. */
   void tag_normals_changed();
 
+  /** Recalculate the positions of auto and vector Bezier handles from the control points. */
+  void calculate_bezier_auto_handles();
+
   void translate(const float3 &translation);
   void transform(const float4x4 &matrix);
 
@@ -153,6 +323,200 @@ class CurvesGeometry : public ::CurvesGeometry {
                            AttributeDomain to) const;
 };
 
+namespace curves {
+
+/**
+ * The number of segments between control points, accounting for the last segment of cyclic
+ * curves. The logic is simple, but this function should be used to make intentions clearer.
+ */
+inline int curve_segment_size(const int size, const bool cyclic)
+{
+  BLI_assert(size > 0);
+  return cyclic ? size : size - 1;
+}
+
+namespace poly {
+
+/**
+ * Calculate the direction at every point, defined as the normalized average of the two neighboring
+ * segments (and if non-cyclic, the direction of the first and last segments). This is different
+ * than evaluating the derivative of the basis functions for curve types like NURBS, Bezier, or
+ * Catmull Rom, though the results may be similar.
+ */
+void calculate_tangents(Span<float3> positions, bool is_cyclic, MutableSpan<float3> tangents);
+
+/**
+ * Calculate directions perpendicular to the tangent at every point by rotating an arbitrary
+ * starting vector by the same rotation of each tangent. If the curve is cyclic, propagate a
+ * correction through the entire to make sure the first and last normal align.
+ */
+void calculate_normals_minimum(Span<float3> tangents, bool cyclic, MutableSpan<float3> normals);
+
+/**
+ * Calculate a vector perpendicular to every tangent on the X-Y plane (unless the tangent is
+ * vertical, in that case use the X direction).
+ */
+void calculate_normals_z_up(Span<float3> tangents, MutableSpan<float3> normals);
+
+/** Rotate every normal around its tangent by the corresponding tilt angle. */
+void rotate_normals_by_tilt(Span<float3> tangents, Span<float> tilts, MutableSpan<float3> normals);
+
+}  // namespace poly
+
+namespace bezier {
+
+/**
+ * Return true if the handles that make up a segment both have a vector type. Vector segments for
+ * Bezier curves have special behavior because they aren't divided into many evaluated points.
+ */
+bool segment_is_vector(Span<int8_t> handle_types_left,
+                       Span<int8_t> handle_types_right,
+                       int segment_index);
+
+/**
+ * Calculate offsets into the curve's evaluated points for each control point. While most control
+ * point edges generate the number of edges specified by the resolution, vector segments only
+ * generate one edge.
+ *
+ * The size of the offsets array must be the same as the number of points plus one. The value at
+ * each index is the evaluated point offset including the following segment, so the last value is
+ * the total number of evaluated points.
+ */
+void calculate_evaluated_offsets(Span<int8_t> handle_types_left,
+                                 Span<int8_t> handle_types_right,
+                                 bool cyclic,
+                                 int resolution,
+                                 MutableSpan<int> evaluated_offsets);
+
+/**
+ * Recalculate all auto (smooth) and vector handles with positions automatically
+ * derived from the neighboring control points.
+ */
+void calculate_auto_handles(bool cyclic,
+                            Span<int8_t> types_left,
+                            Span<int8_t> types_right,
+                            Span<float3> positions,
+                            MutableSpan<float3> positions_left,
+                            MutableSpan<float3> positions_right);
+
+/**
+ * Evaluate a cubic Bezier segment, using the "forward differencing" method.
+ * A generic function would be unnecessarily slow, since it would have to use intermediate values.
+ */
+void evaluate_segment(const float3 &point_0,
+                      const float3 &point_1,
+                      const float3 &point_2,
+                      const float3 &point_3,
+                      MutableSpan<float3> result);
+
+/**
+ * Calculate all evaluated points for the Bezier curve.
+ *
+ * \param evaluated_offsets: The index in the evaluated points array for each control point,
+ * including the points from the corresponding segment. Used to vary the number of evaluated
+ * points per segment, i.e. to make vector segment only have one edge. This is expected to be
+ * calculated by #calculate_evaluated_offsets, and is the reason why this function doesn't need
+ * arguments like "cyclic" and "resolution".
+ */
+void calculate_evaluated_positions(Span<float3> positions,
+                                   Span<float3> handles_left,
+                                   Span<float3> handles_right,
+                                   Span<int> evaluated_offsets,
+                                   MutableSpan<float3> evaluated_positions);
+
+/**
+ * Evaluate generic data to the evaluated points, with counts for each segment described by
+ * #evaluated_offsets. Unlike other curve types, for Bezier curves generic data and positions
+ * are treated separately, since attribute values aren't stored for the handle control points.
+ */
+void interpolate_to_evaluated(fn::GSpan src, Span<int> evaluated_offsets, fn::GMutableSpan dst);
+
+}  // namespace bezier
+
+namespace catmull_rom {
+
+/**
+ * Calculate the number of evaluated points that #interpolate_to_evaluated is expected to produce.
+ * \param size: The number of points in the curve.
+ * \param resolution: The resolution for each segment.
+ */
+int calculate_evaluated_size(int size, bool cyclic, int resolution);
+
+/**
+ * Evaluate the Catmull Rom curve. The length of the #dst span should be calculated with
+ * #calculate_evaluated_size and is expected to divide evenly by the #src span's segment size.
+ */
+void interpolate_to_evaluated(fn::GSpan src, bool cyclic, int resolution, fn::GMutableSpan dst);
+
+}  // namespace catmull_rom
+
+namespace nurbs {
+
+/**
+ * Checks the conditions that a NURBS curve needs to evaluate.
+ */
+bool check_valid_size_and_order(int size, int8_t order, bool cyclic, KnotsMode knots_mode);
+
+/**
+ * Calculate the standard evaluated size for a NURBS curve, using the standard that
+ * the resolution is multiplied by the number of segments between the control points.
+ *
+ * \note Though the number of evaluated points is rather arbitrary, it's useful to have a
+ * standard for predictability and so that cached basis weights of NURBS curves with these
+ * properties can be shared.
+ */
+int calculate_evaluated_size(
+    int size, int8_t order, bool cyclic, int resolution, KnotsMode knots_mode);
+
+/**
+ * Calculate the length of the knot vector for a NURBS curve with the given properties.
+ * The knots must be longer for a cyclic curve, for example, in order to provide weights for the
+ * last evaluated points that are also influenced by the first control points.
+ */
+int knots_size(int size, int8_t order, bool cyclic);
+
+/**
+ * Calculate the knots for a spline given its properties, based on built-in standards defined by
+ * #KnotsMode.
+ *
+ * \note Theoretically any sorted values can be used for NURBS knots, but calculating based
+ * on standard modes allows useful presets, automatic recalculation when the number of points
+ * changes, and is generally more intuitive than defining the knot vector manually.
+ */
+void calculate_knots(
+    int size, KnotsMode mode, int8_t order, bool cyclic, MutableSpan<float> knots);
+
+/**
+ * Based on the knots, the order, and other properties of a NURBS curve, calculate a cache that can
+ * be used to more simply interpolate attributes to the evaluated points later. The cache includes
+ * two pieces of information for every evaluated point: the first control point that influences it,
+ * and a weight for each control point.
+ */
+void calculate_basis_cache(int size,
+                           int evaluated_size,
+                           int8_t order,
+                           bool cyclic,
+                           Span<float> knots,
+                           BasisCache &basis_cache);
+
+/**
+ * Using a "basis cache" generated by #BasisCache, interpolate attribute values to the evaluated
+ * points. The number of evaluated points is determined by the #basis_cache argument.
+ *
+ * \param control_weights: An optional span of control point weights, which must have the same
+ * size as the number of control points in the curve if provided. Using this argument gives a
+ * NURBS curve the "Rational" behavior that's part of its acronym; otherwise it is a NUBS.
+ */
+void interpolate_to_evaluated(const BasisCache &basis_cache,
+                              int8_t order,
+                              Span<float> control_weights,
+                              fn::GSpan src,
+                              fn::GMutableSpan dst);
+
+}  // namespace nurbs
+
+}  // namespace curves
+
 Curves *curves_new_nomain(int point_size, int curves_size);
 
 }  // namespace blender::bke
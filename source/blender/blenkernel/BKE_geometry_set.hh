@@ -27,6 +27,7 @@
 struct Collection;
 struct Curve;
 struct CurveEval;
+struct Curves;
 struct Mesh;
 struct Object;
 struct PointCloud;
@@ -652,6 +653,14 @@ class CurveComponent : public GeometryComponent {
   mutable Curve *curve_for_render_ = nullptr;
   mutable std::mutex curve_for_render_mutex_;
 
+  /**
+   * The curve converted to the #Curves data-block, so that nodes which only read the curve can
+   * use the evaluation on #CurvesGeometry without converting it every time. Freed when the curve
+   * changes, see #get_curves_for_read.
+   */
+  mutable Curves *curves_for_read_ = nullptr;
+  mutable std::mutex curves_for_read_mutex_;
+
  public:
   CurveComponent();
   ~CurveComponent();
@@ -681,9 +690,18 @@ class CurveComponent : public GeometryComponent {
    */
   const Curve *get_curve_for_render() const;
 
+  /**
+   * Get the curve converted to a #Curves data-block. The conversion is done the first time this
+   * is called and is kept until the curve is changed with #get_for_write, so the data-block and
+   * the evaluated data cached in it are shared by all readers of the component.
+   */
+  const Curves *get_curves_for_read() const;
+
   static constexpr inline GeometryComponentType static_type = GEO_COMPONENT_TYPE_CURVE;
 
  private:
+  void clear_curves_for_read();
+
   const blender::bke::ComponentAttributeProviders *get_attribute_providers() const final;
 
   blender::fn::GVArray attribute_try_adapt_domain_impl(const blender::fn::GVArray &varray,
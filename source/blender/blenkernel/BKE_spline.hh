@@ -691,3 +691,8 @@ struct CurveEval {
 std::unique_ptr<CurveEval> curve_eval_from_dna_curve(const Curve &curve,
                                                      const ListBase &nurbs_list);
 std::unique_ptr<CurveEval> curve_eval_from_dna_curve(const Curve &dna_curve);
+/**
+ * Copy the splines of the curve to the flat #Curves data-block, which can be evaluated for all
+ * curves at once. The result is not added to #Main and should be freed with #BKE_id_free.
+ */
+Curves *curve_eval_to_curves(const CurveEval &curve_eval);
@@ -183,6 +183,14 @@ typedef struct Subdiv {
      * In total this array has a size of `num base faces + 1`.
      */
     int *face_ptex_offset;
+    /* Hash of the topology the descriptor was created for, used to find candidates for re-use
+     * in the descriptor cache. See #BKE_subdiv_cache_acquire. */
+    uint32_t topology_hash;
+    /* Copy of the UV maps of that mesh, one layer after the other. Only the UV seams are part of
+     * the topology, so these are compared exactly when the hash matches. */
+    float (*uvs)[2];
+    int num_uv_layers;
+    int num_uv_loops;
   } cache_;
 } Subdiv;
 
@@ -240,6 +248,22 @@ Subdiv *BKE_subdiv_update_from_mesh(Subdiv *subdiv,
 
 void BKE_subdiv_free(Subdiv *subdiv);
 
+/* ================================= CACHE ================================== */
+
+/* Get a descriptor for the given settings and mesh, re-using a descriptor from the cache when
+ * one was released for the same settings and topology before. This avoids re-creating the
+ * topology refiner and the evaluator when only vertex positions change, like for deforming
+ * meshes in geometry nodes.
+ *
+ * The descriptor is owned by the caller until it is given back with #BKE_subdiv_cache_release.
+ * This is safe to call from multiple threads. */
+Subdiv *BKE_subdiv_cache_acquire(const SubdivSettings *settings, const struct Mesh *mesh);
+/* Give a descriptor back to the cache, which might free the least recently released one.
+ * Descriptors with GPU evaluators are freed immediately. */
+void BKE_subdiv_cache_release(Subdiv *subdiv);
+/* Free all cached descriptors. */
+void BKE_subdiv_cache_clear(void);
+
 /* ============================ DISPLACEMENT API ============================ */
 
 void BKE_subdiv_displacement_attach_from_multires(Subdiv *subdiv,
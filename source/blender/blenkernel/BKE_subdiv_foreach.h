@@ -104,10 +104,9 @@ typedef struct SubdivForeachContext {
    */
   SubdivForeachVertexFromCornerCb vertex_every_corner;
   SubdivForeachVertexFromEdgeCb vertex_every_edge;
-  /* Those callbacks are run once per subdivision vertex, ptex is undefined
-   * as in it will be whatever first ptex face happened to be traversed in
-   * the multi-threaded environment and which shares "emitting" vertex or
-   * edge.
+  /* Those callbacks are run once per subdivision vertex, from the ptex of
+   * the first coarse polygon which shares "emitting" vertex or edge. They
+   * are called from multiple threads.
    */
   SubdivForeachVertexFromCornerCb vertex_corner;
   SubdivForeachVertexFromEdgeCb vertex_edge;
@@ -0,0 +1,256 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include <algorithm>
+
+#include "BKE_attribute_math.hh"
+#include "BKE_curves.hh"
+
+namespace blender::bke::curves::bezier {
+
+bool segment_is_vector(const Span<int8_t> handle_types_left,
+                       const Span<int8_t> handle_types_right,
+                       const int segment_index)
+{
+  BLI_assert(segment_index >= 0 && segment_index < handle_types_left.size() - 1);
+  return handle_types_right[segment_index] == BEZIER_HANDLE_VECTOR &&
+         handle_types_left[segment_index + 1] == BEZIER_HANDLE_VECTOR;
+}
+
+static bool last_cyclic_segment_is_vector(const Span<int8_t> handle_types_left,
+                                         const Span<int8_t> handle_types_right)
+{
+  return handle_types_right.last() == BEZIER_HANDLE_VECTOR &&
+         handle_types_left.first() == BEZIER_HANDLE_VECTOR;
+}
+
+void calculate_evaluated_offsets(const Span<int8_t> handle_types_left,
+                                 const Span<int8_t> handle_types_right,
+                                 const bool cyclic,
+                                 const int resolution,
+                                 MutableSpan<int> evaluated_offsets)
+{
+  const int size = handle_types_left.size();
+  BLI_assert(evaluated_offsets.size() == size + 1);
+
+  if (size == 1) {
+    evaluated_offsets.first() = 0;
+    evaluated_offsets.last() = 1;
+    return;
+  }
+
+  int offset = 0;
+  for (const int i : IndexRange(size - 1)) {
+    evaluated_offsets[i] = offset;
+    offset += segment_is_vector(handle_types_left, handle_types_right, i) ? 1 : resolution;
+  }
+
+  evaluated_offsets[size - 1] = offset;
+  if (cyclic) {
+    const bool last_is_vector = last_cyclic_segment_is_vector(handle_types_left,
+                                                              handle_types_right);
+    offset += last_is_vector ? 1 : resolution;
+  }
+  else {
+    /* There is no segment after the last point, but it still has its own evaluated point. */
+    offset++;
+  }
+  evaluated_offsets.last() = offset;
+}
+
+static float3 previous_position(const Span<float3> positions, const bool cyclic, const int i)
+{
+  if (i == 0) {
+    if (cyclic) {
+      return positions.last();
+    }
+    return 2.0f * positions[i] - positions[i + 1];
+  }
+  return positions[i - 1];
+}
+
+static float3 next_position(const Span<float3> positions, const bool cyclic, const int i)
+{
+  if (i == positions.size() - 1) {
+    if (cyclic) {
+      return positions.first();
+    }
+    return 2.0f * positions[i] - positions[i - 1];
+  }
+  return positions[i + 1];
+}
+
+void calculate_auto_handles(const bool cyclic,
+                            const Span<int8_t> types_left,
+                            const Span<int8_t> types_right,
+                            const Span<float3> positions,
+                            MutableSpan<float3> positions_left,
+                            MutableSpan<float3> positions_right)
+{
+  if (positions.size() <= 1) {
+    return;
+  }
+
+  for (const int i : positions.index_range()) {
+    if (ELEM(BEZIER_HANDLE_AUTO, types_left[i], types_right[i])) {
+      const float3 prev_diff = positions[i] - previous_position(positions, cyclic, i);
+      const float3 next_diff = next_position(positions, cyclic, i) - positions[i];
+      float prev_len = math::length(prev_diff);
+      float next_len = math::length(next_diff);
+      if (prev_len == 0.0f) {
+        prev_len = 1.0f;
+      }
+      if (next_len == 0.0f) {
+        next_len = 1.0f;
+      }
+      const float3 dir = next_diff / next_len + prev_diff / prev_len;
+
+      /* This magic number is unfortunate, but comes from elsewhere in Blender. */
+      const float len = math::length(dir) * 2.5614f;
+      if (len != 0.0f) {
+        if (types_left[i] == BEZIER_HANDLE_AUTO) {
+          const float prev_len_clamped = std::min(prev_len, next_len * 5.0f);
+          positions_left[i] = positions[i] + dir * -(prev_len_clamped / len);
+        }
+        if (types_right[i] == BEZIER_HANDLE_AUTO) {
+          const float next_len_clamped = std::min(next_len, prev_len * 5.0f);
+          positions_right[i] = positions[i] + dir * (next_len_clamped / len);
+        }
+      }
+    }
+
+    if (types_left[i] == BEZIER_HANDLE_VECTOR) {
+      const float3 prev = previous_position(positions, cyclic, i);
+      positions_left[i] = math::interpolate(positions[i], prev, 1.0f / 3.0f);
+    }
+
+    if (types_right[i] == BEZIER_HANDLE_VECTOR) {
+      const float3 next = next_position(positions, cyclic, i);
+      positions_right[i] = math::interpolate(positions[i], next, 1.0f / 3.0f);
+    }
+  }
+}
+
+void evaluate_segment(const float3 &point_0,
+                      const float3 &point_1,
+                      const float3 &point_2,
+                      const float3 &point_3,
+                      MutableSpan<float3> result)
+{
+  BLI_assert(result.size() > 0);
+  const float inv_len = 1.0f / static_cast<float>(result.size());
+  const float inv_len_squared = inv_len * inv_len;
+  const float inv_len_cubed = inv_len_squared * inv_len;
+
+  const float3 rt1 = 3.0f * (point_1 - point_0) * inv_len;
+  const float3 rt2 = 3.0f * (point_0 - 2.0f * point_1 + point_2) * inv_len_squared;
+  const float3 rt3 = (point_3 - point_0 + 3.0f * (point_1 - point_2)) * inv_len_cubed;
+
+  float3 q0 = point_0;
+  float3 q1 = rt1 + rt2 + rt3;
+  float3 q2 = 2.0f * rt2 + 6.0f * rt3;
+  float3 q3 = 6.0f * rt3;
+  for (const int i : result.index_range()) {
+    result[i] = q0;
+    q0 += q1;
+    q1 += q2;
+    q2 += q3;
+  }
+}
+
+void calculate_evaluated_positions(const Span<float3> positions,
+                                   const Span<float3> handles_left,
+                                   const Span<float3> handles_right,
+                                   const Span<int> evaluated_offsets,
+                                   MutableSpan<float3> evaluated_positions)
+{
+  BLI_assert(evaluated_offsets.last() == evaluated_positions.size());
+  BLI_assert(evaluated_offsets.size() == positions.size() + 1);
+
+  /* Use a special case for single point curves for consistency with the other curve types. */
+  if (positions.size() == 1) {
+    evaluated_positions.first() = positions.first();
+    return;
+  }
+
+  auto evaluate = [&](const int i, const int i_next) {
+    const IndexRange evaluated_range(evaluated_offsets[i],
+                                     evaluated_offsets[i + 1] - evaluated_offsets[i]);
+    if (evaluated_range.size() == 1) {
+      evaluated_positions[evaluated_range.first()] = positions[i];
+    }
+    else {
+      evaluate_segment(positions[i],
+                       handles_right[i],
+                       handles_left[i_next],
+                       positions[i_next],
+                       evaluated_positions.slice(evaluated_range));
+    }
+  };
+
+  for (const int i : IndexRange(positions.size() - 1)) {
+    evaluate(i, i + 1);
+  }
+
+  const IndexRange last_segment_points(evaluated_offsets[positions.size() - 1],
+                                       evaluated_offsets.last() -
+                                           evaluated_offsets[positions.size() - 1]);
+  if (last_segment_points.size() == 1) {
+    /* Either a vector segment of a cyclic curve, or the last point of a non-cyclic curve. */
+    evaluated_positions.last() = positions.last();
+  }
+  else {
+    evaluate(positions.size() - 1, 0);
+  }
+}
+
+template<typename T>
+static inline void linear_interpolation(const T &a, const T &b, MutableSpan<T> dst)
+{
+  dst.first() = a;
+  const float step = 1.0f / dst.size();
+  for (const int i : IndexRange(1, dst.size() - 1)) {
+    dst[i] = attribute_math::mix2(i * step, a, b);
+  }
+}
+
+template<typename T>
+static void interpolate_to_evaluated(const Span<T> src,
+                                     const Span<int> evaluated_offsets,
+                                     MutableSpan<T> dst)
+{
+  BLI_assert(!src.is_empty());
+  BLI_assert(dst.size() == evaluated_offsets.last());
+  if (src.size() == 1) {
+    BLI_assert(dst.size() == 1);
+    dst.first() = src.first();
+    return;
+  }
+
+  for (const int i : IndexRange(src.size() - 1)) {
+    const IndexRange range(evaluated_offsets[i], evaluated_offsets[i + 1] - evaluated_offsets[i]);
+    linear_interpolation(src[i], src[i + 1], dst.slice(range));
+  }
+
+  const IndexRange last_segment_points(evaluated_offsets[src.size() - 1],
+                                       evaluated_offsets.last() -
+                                           evaluated_offsets[src.size() - 1]);
+  linear_interpolation(src.last(), src.first(), dst.slice(last_segment_points));
+}
+
+void interpolate_to_evaluated(const fn::GSpan src,
+                              const Span<int> evaluated_offsets,
+                              fn::GMutableSpan dst)
+{
+  attribute_math::convert_to_static_type(src.type(), [&](auto dummy) {
+    using T = decltype(dummy);
+    if constexpr (!std::is_void_v<attribute_math::DefaultMixer<T>>) {
+      interpolate_to_evaluated(src.typed<T>(), evaluated_offsets, dst.typed<T>());
+    }
+  });
+}
+
+}  // namespace blender::bke::curves::bezier
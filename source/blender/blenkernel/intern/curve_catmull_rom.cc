@@ -0,0 +1,86 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include "BKE_attribute_math.hh"
+#include "BKE_curves.hh"
+
+namespace blender::bke::curves::catmull_rom {
+
+int calculate_evaluated_size(const int size, const bool cyclic, const int resolution)
+{
+  if (size == 1) {
+    return 1;
+  }
+  const int eval_size = resolution * curve_segment_size(size, cyclic);
+  /* If the curve isn't cyclic, one last point is added to the final point. */
+  return cyclic ? eval_size : eval_size + 1;
+}
+
+template<typename T>
+static T calculate_basis(const T &a, const T &b, const T &c, const T &d, const float parameter)
+{
+  const float t = parameter;
+  const float s = 1.0f - parameter;
+  const float n0 = -t * s * s;
+  const float n1 = 2.0f + t * t * (3.0f * t - 5.0f);
+  const float n2 = t * (1.0f + t * (4.0f - 3.0f * t));
+  const float n3 = -t * t * s;
+  return attribute_math::mix4(float4(n0, n1, n2, n3) * 0.5f, a, b, c, d);
+}
+
+template<typename T>
+static void evaluate_segment(const T &a, const T &b, const T &c, const T &d, MutableSpan<T> dst)
+{
+  const float step = 1.0f / dst.size();
+  dst.first() = b;
+  for (const int i : IndexRange(1, dst.size() - 1)) {
+    dst[i] = calculate_basis<T>(a, b, c, d, i * step);
+  }
+}
+
+template<typename T>
+static void interpolate_to_evaluated(const Span<T> src,
+                                     const bool cyclic,
+                                     const int resolution,
+                                     MutableSpan<T> dst)
+{
+  BLI_assert(dst.size() == calculate_evaluated_size(src.size(), cyclic, resolution));
+
+  const int size = src.size();
+  if (size == 1) {
+    dst.first() = src.first();
+    return;
+  }
+
+  /* The control points before and after every segment wrap around for cyclic curves. Otherwise
+   * the end points are repeated, so the curve still passes through them. */
+  for (const int i : IndexRange(curve_segment_size(size, cyclic))) {
+    const int prev = i > 0 ? i - 1 : (cyclic ? size - 1 : 0);
+    const int next = i < size - 1 ? i + 1 : 0;
+    const int next_next = i + 2 < size ? i + 2 : (cyclic ? (i + 2) % size : size - 1);
+    evaluate_segment(
+        src[prev], src[i], src[next], src[next_next], dst.slice(i * resolution, resolution));
+  }
+
+  if (!cyclic) {
+    dst.last() = src.last();
+  }
+}
+
+void interpolate_to_evaluated(const fn::GSpan src,
+                              const bool cyclic,
+                              const int resolution,
+                              fn::GMutableSpan dst)
+{
+  attribute_math::convert_to_static_type(src.type(), [&](auto dummy) {
+    using T = decltype(dummy);
+    if constexpr (!std::is_void_v<attribute_math::DefaultMixer<T>>) {
+      interpolate_to_evaluated(src.typed<T>(), cyclic, resolution, dst.typed<T>());
+    }
+  });
+}
+
+}  // namespace blender::bke::curves::catmull_rom
@@ -13,6 +13,8 @@
 
 #include "BKE_anonymous_attribute.hh"
 #include "BKE_curve.h"
+#include "BKE_curves.hh"
+#include "BKE_customdata.h"
 #include "BKE_spline.hh"
 
 using blender::Array;
@@ -336,6 +338,121 @@ std::unique_ptr<CurveEval> curve_eval_from_dna_curve(const Curve &dna_curve)
   return curve_eval_from_dna_curve(dna_curve, *BKE_curve_nurbs_get_for_read(&dna_curve));
 }
 
+static NormalMode normal_mode_to_curves(const Spline::NormalCalculationMode mode)
+{
+  switch (mode) {
+    case Spline::NormalCalculationMode::Minimum:
+      return NORMAL_MODE_MINIMUM_TWIST;
+    case Spline::NormalCalculationMode::ZUp:
+    case Spline::NormalCalculationMode::Tangent:
+      /* Tangent mode is not yet supported, it is evaluated like "Z Up" on splines too. */
+      return NORMAL_MODE_Z_UP;
+  }
+  BLI_assert_unreachable();
+  return NORMAL_MODE_MINIMUM_TWIST;
+}
+
+static KnotsMode knots_mode_to_curves(const NURBSpline::KnotsMode mode)
+{
+  switch (mode) {
+    case NURBSpline::KnotsMode::Normal:
+      return NURBS_KNOT_MODE_NORMAL;
+    case NURBSpline::KnotsMode::EndPoint:
+      return NURBS_KNOT_MODE_ENDPOINT;
+    case NURBSpline::KnotsMode::Bezier:
+      return NURBS_KNOT_MODE_BEZIER;
+  }
+  BLI_assert_unreachable();
+  return NURBS_KNOT_MODE_NORMAL;
+}
+
+Curves *curve_eval_to_curves(const CurveEval &curve_eval)
+{
+  Span<SplinePtr> splines = curve_eval.splines();
+  const Array<int> point_offsets = curve_eval.control_point_offsets();
+
+  Curves *curves_id = blender::bke::curves_new_nomain(point_offsets.last(), splines.size());
+  blender::bke::CurvesGeometry &curves = blender::bke::CurvesGeometry::wrap(curves_id->geometry);
+  curves.offsets().copy_from(point_offsets);
+
+  float *radius_data = (float *)CustomData_add_layer_named(
+      &curves.point_data, CD_PROP_FLOAT, CD_DEFAULT, nullptr, curves.points_size(), "radius");
+  MutableSpan<float> radii{radius_data, curves.points_size()};
+
+  MutableSpan<int8_t> curve_types = curves.curve_types();
+  MutableSpan<bool> cyclic = curves.cyclic();
+  MutableSpan<int8_t> normal_modes = curves.normal_mode();
+  MutableSpan<float3> positions = curves.positions();
+  MutableSpan<float> tilts = curves.tilt();
+  for (const int i : splines.index_range()) {
+    curve_types[i] = splines[i]->type();
+  }
+
+  const bool has_bezier = curve_eval.has_spline_with_type(CURVE_TYPE_BEZIER);
+  const bool has_nurbs = curve_eval.has_spline_with_type(CURVE_TYPE_NURBS);
+  MutableSpan<int> resolutions;
+  MutableSpan<int8_t> handle_types_left;
+  MutableSpan<int8_t> handle_types_right;
+  MutableSpan<float3> handle_positions_left;
+  MutableSpan<float3> handle_positions_right;
+  MutableSpan<int8_t> nurbs_orders;
+  MutableSpan<int8_t> nurbs_knots_modes;
+  MutableSpan<float> nurbs_weights;
+  if (has_bezier || has_nurbs) {
+    resolutions = curves.resolution();
+  }
+  if (has_bezier) {
+    handle_types_left = curves.handle_types_left();
+    handle_types_right = curves.handle_types_right();
+    handle_positions_left = curves.handle_positions_left();
+    handle_positions_right = curves.handle_positions_right();
+  }
+  if (has_nurbs) {
+    nurbs_orders = curves.nurbs_orders();
+    nurbs_knots_modes = curves.nurbs_knots_modes();
+    nurbs_weights = curves.nurbs_weights();
+  }
+
+  blender::threading::parallel_for(splines.index_range(), 256, [&](IndexRange range) {
+    for (const int i : range) {
+      const Spline &spline = *splines[i];
+      const IndexRange points = curves.range_for_curve(i);
+      cyclic[i] = spline.is_cyclic();
+      normal_modes[i] = normal_mode_to_curves(spline.normal_mode);
+      positions.slice(points).copy_from(spline.positions());
+      radii.slice(points).copy_from(spline.radii());
+      tilts.slice(points).copy_from(spline.tilts());
+
+      switch (spline.type()) {
+        case CURVE_TYPE_BEZIER: {
+          const BezierSpline &bezier_spline = static_cast<const BezierSpline &>(spline);
+          resolutions[i] = bezier_spline.resolution();
+          handle_types_left.slice(points).copy_from(bezier_spline.handle_types_left());
+          handle_types_right.slice(points).copy_from(bezier_spline.handle_types_right());
+          handle_positions_left.slice(points).copy_from(bezier_spline.handle_positions_left());
+          handle_positions_right.slice(points).copy_from(bezier_spline.handle_positions_right());
+          break;
+        }
+        case CURVE_TYPE_NURBS: {
+          const NURBSpline &nurbs_spline = static_cast<const NURBSpline &>(spline);
+          resolutions[i] = nurbs_spline.resolution();
+          nurbs_orders[i] = nurbs_spline.order();
+          nurbs_knots_modes[i] = knots_mode_to_curves(nurbs_spline.knots_mode);
+          nurbs_weights.slice(points).copy_from(nurbs_spline.weights());
+          break;
+        }
+        default:
+          break;
+      }
+    }
+  });
+
+  curves.update_customdata_pointers();
+  curves.tag_topology_changed();
+
+  return curves_id;
+}
+
 void CurveEval::assert_valid_point_attributes() const
 {
 #ifdef DEBUG
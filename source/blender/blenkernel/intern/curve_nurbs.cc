@@ -0,0 +1,237 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include <algorithm>
+
+#include "BKE_attribute_math.hh"
+#include "BKE_curves.hh"
+
+namespace blender::bke::curves::nurbs {
+
+bool check_valid_size_and_order(const int size,
+                                const int8_t order,
+                                const bool cyclic,
+                                const KnotsMode knots_mode)
+{
+  if (size < order) {
+    return false;
+  }
+
+  if (!cyclic && knots_mode == NURBS_KNOT_MODE_BEZIER) {
+    if (order == 4) {
+      if (size < 5) {
+        return false;
+      }
+    }
+    else if (order != 3) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+int calculate_evaluated_size(const int size,
+                             const int8_t order,
+                             const bool cyclic,
+                             const int resolution,
+                             const KnotsMode knots_mode)
+{
+  if (!check_valid_size_and_order(size, order, cyclic, knots_mode)) {
+    return 0;
+  }
+  return resolution * curve_segment_size(size, cyclic);
+}
+
+int knots_size(const int size, const int8_t order, const bool cyclic)
+{
+  if (cyclic) {
+    return size + order * 2 - 1;
+  }
+  return size + order;
+}
+
+void calculate_knots(const int size,
+                     const KnotsMode mode,
+                     const int8_t order,
+                     const bool cyclic,
+                     MutableSpan<float> knots)
+{
+  BLI_assert(knots.size() == knots_size(size, order, cyclic));
+  UNUSED_VARS_NDEBUG(size);
+
+  const bool is_bezier = mode == NURBS_KNOT_MODE_BEZIER;
+  const bool is_end_point = mode == NURBS_KNOT_MODE_ENDPOINT;
+  /* Inner knots are always repeated once except on Bezier case. */
+  const int repeat_inner = is_bezier ? order - 1 : 1;
+  /* How many times to repeat 0.0 at the beginning of knot. */
+  const int head = is_end_point && !cyclic ? order : (is_bezier ? order / 2 : 1);
+  /* Number of knots replicating widths of the starting knots.
+   * Covers both Cyclic and EndPoint cases. */
+  const int tail = cyclic ? 2 * order - 1 : (is_end_point ? order : 0);
+
+  int r = head;
+  float current = 0.0f;
+
+  for (const int i : IndexRange(knots.size() - tail)) {
+    knots[i] = current;
+    r--;
+    if (r == 0) {
+      current += 1.0;
+      r = repeat_inner;
+    }
+  }
+
+  const int tail_index = knots.size() - tail;
+  for (const int i : IndexRange(tail)) {
+    knots[tail_index + i] = current + (knots[i] - knots[0]);
+  }
+}
+
+/**
+ * Calculate the weights of the control points that influence the point at the given parameter.
+ * The weights are written to the start of \a r_weights, which is filled with zeros afterwards.
+ *
+ * \return The index of the first control point with a non-zero weight.
+ */
+static int calculate_basis_for_point(const float parameter,
+                                     const int size,
+                                     const int order,
+                                     const Span<float> knots,
+                                     MutableSpan<float> buffer,
+                                     MutableSpan<float> r_weights)
+{
+  /* Clamp parameter due to floating point inaccuracy. */
+  const float t = std::clamp(parameter, knots[0], knots[size + order - 1]);
+
+  int start = 0;
+  int end = 0;
+  for (const int i : IndexRange(size + order - 1)) {
+    const bool knots_equal = knots[i] == knots[i + 1];
+    if (knots_equal || t < knots[i] || t > knots[i + 1]) {
+      buffer[i] = 0.0f;
+      continue;
+    }
+
+    buffer[i] = 1.0f;
+    start = std::max(i - order - 1, 0);
+    end = i;
+    buffer.slice(i + 1, size + order - 1 - i).fill(0.0f);
+    break;
+  }
+  buffer[size + order - 1] = 0.0f;
+
+  for (const int i_order : IndexRange(2, order - 1)) {
+    if (end + i_order >= size + order) {
+      end = size + order - 1 - i_order;
+    }
+    for (const int i : IndexRange(start, end - start + 1)) {
+      float new_basis = 0.0f;
+      if (buffer[i] != 0.0f) {
+        new_basis += ((t - knots[i]) * buffer[i]) / (knots[i + i_order - 1] - knots[i]);
+      }
+
+      if (buffer[i + 1] != 0.0f) {
+        new_basis += ((knots[i + i_order] - t) * buffer[i + 1]) /
+                     (knots[i + i_order] - knots[i + 1]);
+      }
+
+      buffer[i] = new_basis;
+    }
+  }
+
+  /* Shrink the range of calculated values to avoid storing unnecessary zeros. */
+  while (buffer[start] == 0.0f && start < end) {
+    start++;
+  }
+  while (buffer[end] == 0.0f && end > start) {
+    end--;
+  }
+
+  const int weights_size = end - start + 1;
+  BLI_assert(weights_size <= order);
+  r_weights.take_front(weights_size).copy_from(buffer.slice(start, weights_size));
+  r_weights.drop_front(weights_size).fill(0.0f);
+  return start;
+}
+
+void calculate_basis_cache(const int size,
+                           const int evaluated_size,
+                           const int8_t order,
+                           const bool cyclic,
+                           const Span<float> knots,
+                           BasisCache &basis_cache)
+{
+  BLI_assert(size > 0);
+
+  basis_cache.weights.resize(evaluated_size * order);
+  basis_cache.start_indices.resize(evaluated_size);
+
+  if (evaluated_size == 0) {
+    return;
+  }
+
+  MutableSpan<float> basis_weights(basis_cache.weights);
+  MutableSpan<int> basis_start_indices(basis_cache.start_indices);
+
+  /* This buffer is reused by each basis calculation to store temporary values. */
+  Array<float> buffer(knots.size());
+
+  const int extended_size = size + (cyclic ? order - 1 : 0);
+  const float start = knots[order - 1];
+  const float end = cyclic ? knots[size + order - 1] : knots[size];
+  const int evaluated_edges_size = cyclic ? evaluated_size : evaluated_size - 1;
+  const float step = evaluated_edges_size == 0 ? 0.0f : (end - start) / evaluated_edges_size;
+  for (const int i : IndexRange(evaluated_size)) {
+    const float parameter = start + step * i;
+    basis_start_indices[i] = calculate_basis_for_point(
+        parameter, extended_size, order, knots, buffer, basis_weights.slice(i * order, order));
+  }
+}
+
+template<typename T>
+static void interpolate_to_evaluated(const BasisCache &basis_cache,
+                                     const int8_t order,
+                                     const Span<float> control_weights,
+                                     const Span<T> src,
+                                     MutableSpan<T> dst)
+{
+  const int size = src.size();
+  BLI_assert(dst.size() == basis_cache.start_indices.size());
+  attribute_math::DefaultMixer<T> mixer{dst};
+
+  for (const int i : dst.index_range()) {
+    const Span<float> point_weights = basis_cache.weights.as_span().slice(i * order, order);
+    const int start_index = basis_cache.start_indices[i];
+    for (const int j : point_weights.index_range()) {
+      const int point_index = (start_index + j) % size;
+      const float weight = control_weights.is_empty() ?
+                               point_weights[j] :
+                               point_weights[j] * control_weights[point_index];
+      mixer.mix_in(i, src[point_index], weight);
+    }
+  }
+
+  mixer.finalize();
+}
+
+void interpolate_to_evaluated(const BasisCache &basis_cache,
+                              const int8_t order,
+                              const Span<float> control_weights,
+                              const fn::GSpan src,
+                              fn::GMutableSpan dst)
+{
+  BLI_assert(control_weights.is_empty() || control_weights.size() == src.size());
+  attribute_math::convert_to_static_type(src.type(), [&](auto dummy) {
+    using T = decltype(dummy);
+    if constexpr (!std::is_void_v<attribute_math::DefaultMixer<T>>) {
+      interpolate_to_evaluated(
+          basis_cache, order, control_weights, src.typed<T>(), dst.typed<T>());
+    }
+  });
+}
+
+}  // namespace blender::bke::curves::nurbs
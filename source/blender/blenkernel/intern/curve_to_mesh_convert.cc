@@ -1,6 +1,7 @@
 /* SPDX-License-Identifier: GPL-2.0-or-later */
 
 #include "BLI_array.hh"
+#include "BLI_prefix_sum.hh"
 #include "BLI_set.hh"
 #include "BLI_task.hh"
 
@@ -16,15 +17,127 @@
 
 #include "BKE_curve_to_mesh.hh"
 
+#include "FN_generic_array.hh"
+
+using blender::fn::GArray;
 using blender::fn::GMutableSpan;
 using blender::fn::GSpan;
 
 namespace blender::bke {
 
+/**
+ * The evaluated data of all splines of an input curve, stored contiguously with the start of
+ * every spline's points in an offsets array, like the point data of #CurvesGeometry. Gathering
+ * the data once avoids going through the virtual spline interface and interpolating attributes
+ * again for every combination of a curve spline and a profile spline.
+ */
+struct CurvesInfo {
+  /** The first evaluated point of every spline, with the total number of points at the end. */
+  Array<int> offsets;
+  Array<bool> cyclic;
+  Array<float3> positions;
+
+  /** Only used for the main curve input. */
+  Array<float3> tangents;
+  Array<float3> normals;
+  Array<float> radii;
+
+  /** Evaluated points of sharp Bezier control points. Only used for the profile input. */
+  Array<bool> sharp;
+
+  int curves_num() const
+  {
+    return cyclic.size();
+  }
+
+  IndexRange points_for_curve(const int index) const
+  {
+    return IndexRange(offsets[index], offsets[index + 1] - offsets[index]);
+  }
+};
+
+static Array<int> calculate_evaluated_offsets(const Span<SplinePtr> splines)
+{
+  Array<int> offsets(splines.size() + 1);
+  threading::parallel_for(splines.index_range(), 1024, [&](IndexRange range) {
+    for (const int i : range) {
+      offsets[i] = splines[i]->evaluated_points_size();
+    }
+  });
+  offsets.last() = 0;
+  parallel_prefix_sum(offsets.as_span(), offsets.as_mutable_span(), false);
+  return offsets;
+}
+
+static CurvesInfo gather_curve_info(const CurveEval &curve)
+{
+  const Span<SplinePtr> splines = curve.splines();
+  CurvesInfo info;
+  info.offsets = calculate_evaluated_offsets(splines);
+  const int points_num = info.offsets.last();
+  info.cyclic.reinitialize(splines.size());
+  info.positions.reinitialize(points_num);
+  info.tangents.reinitialize(points_num);
+  info.normals.reinitialize(points_num);
+  info.radii.reinitialize(points_num);
+  threading::parallel_for(splines.index_range(), 128, [&](IndexRange range) {
+    for (const int i : range) {
+      const Spline &spline = *splines[i];
+      const IndexRange points = info.points_for_curve(i);
+      info.cyclic[i] = spline.is_cyclic();
+      if (points.size() == 0) {
+        continue;
+      }
+      info.positions.as_mutable_span().slice(points).copy_from(spline.evaluated_positions());
+      info.tangents.as_mutable_span().slice(points).copy_from(spline.evaluated_tangents());
+      info.normals.as_mutable_span().slice(points).copy_from(spline.evaluated_normals());
+      spline.interpolate_to_evaluated(spline.radii())
+          .materialize(info.radii.as_mutable_span().slice(points));
+    }
+  });
+  return info;
+}
+
+static CurvesInfo gather_profile_info(const CurveEval &profile)
+{
+  const Span<SplinePtr> splines = profile.splines();
+  CurvesInfo info;
+  info.offsets = calculate_evaluated_offsets(splines);
+  const int points_num = info.offsets.last();
+  info.cyclic.reinitialize(splines.size());
+  info.positions.reinitialize(points_num);
+  info.sharp = Array<bool>(points_num, false);
+  threading::parallel_for(splines.index_range(), 128, [&](IndexRange range) {
+    for (const int i : range) {
+      const Spline &spline = *splines[i];
+      const IndexRange points = info.points_for_curve(i);
+      info.cyclic[i] = spline.is_cyclic();
+      if (points.size() == 0) {
+        continue;
+      }
+      info.positions.as_mutable_span().slice(points).copy_from(spline.evaluated_positions());
+      if (spline.type() == CURVE_TYPE_BEZIER) {
+        const BezierSpline &bezier_spline = static_cast<const BezierSpline &>(spline);
+        const Span<int> control_point_offsets = bezier_spline.control_point_offsets();
+        for (const int i_point : IndexRange(bezier_spline.size())) {
+          if (bezier_spline.point_is_sharp(i_point)) {
+            info.sharp[points[control_point_offsets[i_point]]] = true;
+          }
+        }
+      }
+    }
+  });
+  return info;
+}
+
 /** Information about the creation of one curve spline and profile spline combination. */
 struct ResultInfo {
-  const Spline &spline;
-  const Spline &profile;
+  int i_spline;
+  int i_profile;
+  IndexRange spline_points;
+  IndexRange profile_points;
+  bool spline_cyclic;
+  bool profile_cyclic;
   int vert_offset;
   int edge_offset;
   int loop_offset;
@@ -35,14 +148,32 @@ struct ResultInfo {
   int profile_edge_len;
 };
 
-static void vert_extrude_to_mesh_data(const Spline &spline,
+static int segments_num(const int points_num, const bool cyclic)
+{
+  if (points_num < 2) {
+    /* Two points are required for an edge. */
+    return 0;
+  }
+  return cyclic ? points_num : points_num - 1;
+}
+
+static bool has_caps(const bool fill_caps,
+                     const bool spline_cyclic,
+                     const bool profile_cyclic,
+                     const int profile_edge_len)
+{
+  return fill_caps && profile_cyclic && !spline_cyclic && profile_edge_len > 0;
+}
+
+static void vert_extrude_to_mesh_data(const ResultInfo &info,
+                                      const CurvesInfo &curves,
                                       const float3 profile_vert,
                                       MutableSpan<MVert> r_verts,
-                                      MutableSpan<MEdge> r_edges,
-                                      const int vert_offset,
-                                      const int edge_offset)
+                                      MutableSpan<MEdge> r_edges)
 {
-  const int eval_size = spline.evaluated_points_size();
+  const int vert_offset = info.vert_offset;
+  const int edge_offset = info.edge_offset;
+  const int eval_size = info.spline_vert_len;
   for (const int i : IndexRange(eval_size - 1)) {
     MEdge &edge = r_edges[edge_offset + i];
     edge.v1 = vert_offset + i;
@@ -50,17 +181,17 @@ static void vert_extrude_to_mesh_data(const Spline &spline,
     edge.flag = ME_LOOSEEDGE;
   }
 
-  if (spline.is_cyclic() && spline.evaluated_edges_size() > 1) {
-    MEdge &edge = r_edges[edge_offset + spline.evaluated_edges_size() - 1];
+  if (info.spline_cyclic && info.spline_edge_len > 1) {
+    MEdge &edge = r_edges[edge_offset + info.spline_edge_len - 1];
     edge.v1 = vert_offset + eval_size - 1;
     edge.v2 = vert_offset;
     edge.flag = ME_LOOSEEDGE;
   }
 
-  Span<float3> positions = spline.evaluated_positions();
-  Span<float3> tangents = spline.evaluated_tangents();
-  Span<float3> normals = spline.evaluated_normals();
-  VArray<float> radii = spline.interpolate_to_evaluated(spline.radii());
+  const Span<float3> positions = curves.positions.as_span().slice(info.spline_points);
+  const Span<float3> tangents = curves.tangents.as_span().slice(info.spline_points);
+  const Span<float3> normals = curves.normals.as_span().slice(info.spline_points);
+  const Span<float> radii = curves.radii.as_span().slice(info.spline_points);
   for (const int i : IndexRange(eval_size)) {
     float4x4 point_matrix = float4x4::from_normalized_axis_data(
         positions[i], normals[i], tangents[i]);
@@ -79,21 +210,17 @@ static void mark_edges_sharp(MutableSpan<MEdge> edges)
 }
 
 static void spline_extrude_to_mesh_data(const ResultInfo &info,
+                                        const CurvesInfo &curves,
+                                        const CurvesInfo &profiles,
                                         const bool fill_caps,
                                         MutableSpan<MVert> r_verts,
                                         MutableSpan<MEdge> r_edges,
                                         MutableSpan<MLoop> r_loops,
                                         MutableSpan<MPoly> r_polys)
 {
-  const Spline &spline = info.spline;
-  const Spline &profile = info.profile;
   if (info.profile_vert_len == 1) {
-    vert_extrude_to_mesh_data(spline,
-                              profile.evaluated_positions()[0],
-                              r_verts,
-                              r_edges,
-                              info.vert_offset,
-                              info.edge_offset);
+    vert_extrude_to_mesh_data(
+        info, curves, profiles.positions[info.profile_points.first()], r_verts, r_edges);
     return;
   }
 
@@ -172,8 +299,7 @@ static void spline_extrude_to_mesh_data(const ResultInfo &info,
     }
   }
 
-  const bool has_caps = fill_caps && profile.is_cyclic() && !spline.is_cyclic();
-  if (has_caps) {
+  if (has_caps(fill_caps, info.spline_cyclic, info.profile_cyclic, info.profile_edge_len)) {
     const int poly_size = info.spline_edge_len * info.profile_edge_len;
     const int cap_loop_offset = info.loop_offset + poly_size * 4;
     const int cap_poly_offset = info.poly_offset + poly_size;
@@ -207,12 +333,11 @@ static void spline_extrude_to_mesh_data(const ResultInfo &info,
   }
 
   /* Calculate the positions of each profile ring profile along the spline. */
-  Span<float3> positions = spline.evaluated_positions();
-  Span<float3> tangents = spline.evaluated_tangents();
-  Span<float3> normals = spline.evaluated_normals();
-  Span<float3> profile_positions = profile.evaluated_positions();
-
-  VArray<float> radii = spline.interpolate_to_evaluated(spline.radii());
+  const Span<float3> positions = curves.positions.as_span().slice(info.spline_points);
+  const Span<float3> tangents = curves.tangents.as_span().slice(info.spline_points);
+  const Span<float3> normals = curves.normals.as_span().slice(info.spline_points);
+  const Span<float> radii = curves.radii.as_span().slice(info.spline_points);
+  const Span<float3> profile_positions = profiles.positions.as_span().slice(info.profile_points);
   for (const int i_ring : IndexRange(info.spline_vert_len)) {
     float4x4 point_matrix = float4x4::from_normalized_axis_data(
         positions[i_ring], normals[i_ring], tangents[i_ring]);
@@ -226,94 +351,124 @@ static void spline_extrude_to_mesh_data(const ResultInfo &info,
   }
 
   /* Mark edge loops from sharp vector control points sharp. */
-  if (profile.type() == CURVE_TYPE_BEZIER) {
-    const BezierSpline &bezier_spline = static_cast<const BezierSpline &>(profile);
-    Span<int> control_point_offsets = bezier_spline.control_point_offsets();
-    for (const int i : IndexRange(bezier_spline.size())) {
-      if (bezier_spline.point_is_sharp(i)) {
-        mark_edges_sharp(
-            r_edges.slice(spline_edges_start + info.spline_edge_len * control_point_offsets[i],
-                          info.spline_edge_len));
-      }
+  const Span<bool> profile_sharp = profiles.sharp.as_span().slice(info.profile_points);
+  for (const int i_profile : IndexRange(info.profile_vert_len)) {
+    if (profile_sharp[i_profile]) {
+      mark_edges_sharp(r_edges.slice(spline_edges_start + info.spline_edge_len * i_profile,
+                                     info.spline_edge_len));
     }
   }
 }
 
-static inline int spline_extrude_vert_size(const Spline &curve, const Spline &profile)
-{
-  return curve.evaluated_points_size() * profile.evaluated_points_size();
-}
-
-static inline int spline_extrude_edge_size(const Spline &curve, const Spline &profile)
-{
-  /* Add the ring edges, with one ring for every curve vertex, and the edge loops
-   * that run along the length of the curve, starting on the first profile. */
-  return curve.evaluated_points_size() * profile.evaluated_edges_size() +
-         curve.evaluated_edges_size() * profile.evaluated_points_size();
-}
-
-static inline int spline_extrude_loop_size(const Spline &curve,
-                                           const Spline &profile,
-                                           const bool fill_caps)
-{
-  const int tube = curve.evaluated_edges_size() * profile.evaluated_edges_size() * 4;
-  const bool has_caps = fill_caps && profile.is_cyclic() && !curve.is_cyclic();
-  const int caps = has_caps ? profile.evaluated_edges_size() * 2 : 0;
-  return tube + caps;
-}
-
-static inline int spline_extrude_poly_size(const Spline &curve,
-                                           const Spline &profile,
-                                           const bool fill_caps)
-{
-  const int tube = curve.evaluated_edges_size() * profile.evaluated_edges_size();
-  const bool has_caps = fill_caps && profile.is_cyclic() && !curve.is_cyclic();
-  const int caps = has_caps ? 2 : 0;
-  return tube + caps;
-}
-
+/**
+ * The start of the mesh elements of every curve spline and profile spline combination, with the
+ * totals at the end. Combinations are ordered by curve spline first.
+ */
 struct ResultOffsets {
   Array<int> vert;
   Array<int> edge;
   Array<int> loop;
   Array<int> poly;
 };
-static ResultOffsets calculate_result_offsets(Span<SplinePtr> profiles,
-                                              Span<SplinePtr> curves,
+static ResultOffsets calculate_result_offsets(const CurvesInfo &curves,
+                                              const CurvesInfo &profiles,
                                               const bool fill_caps)
 {
-  const int total = profiles.size() * curves.size();
+  const int profiles_num = profiles.curves_num();
+  const int total = curves.curves_num() * profiles_num;
   Array<int> vert(total + 1);
   Array<int> edge(total + 1);
   Array<int> loop(total + 1);
   Array<int> poly(total + 1);
 
-  int mesh_index = 0;
-  int vert_offset = 0;
-  int edge_offset = 0;
-  int loop_offset = 0;
-  int poly_offset = 0;
-  for (const int i_spline : curves.index_range()) {
-    for (const int i_profile : profiles.index_range()) {
-      vert[mesh_index] = vert_offset;
-      edge[mesh_index] = edge_offset;
-      loop[mesh_index] = loop_offset;
-      poly[mesh_index] = poly_offset;
-      vert_offset += spline_extrude_vert_size(*curves[i_spline], *profiles[i_profile]);
-      edge_offset += spline_extrude_edge_size(*curves[i_spline], *profiles[i_profile]);
-      loop_offset += spline_extrude_loop_size(*curves[i_spline], *profiles[i_profile], fill_caps);
-      poly_offset += spline_extrude_poly_size(*curves[i_spline], *profiles[i_profile], fill_caps);
-      mesh_index++;
+  threading::parallel_for(IndexRange(total), 4096, [&](IndexRange range) {
+    for (const int i_mesh : range) {
+      const int i_spline = i_mesh / profiles_num;
+      const int i_profile = i_mesh % profiles_num;
+      const int spline_vert_len = curves.points_for_curve(i_spline).size();
+      const int profile_vert_len = profiles.points_for_curve(i_profile).size();
+      const bool spline_cyclic = curves.cyclic[i_spline];
+      const bool profile_cyclic = profiles.cyclic[i_profile];
+      if (spline_vert_len == 0 || profile_vert_len == 0) {
+        vert[i_mesh] = 0;
+        edge[i_mesh] = 0;
+        loop[i_mesh] = 0;
+        poly[i_mesh] = 0;
+        continue;
+      }
+      const int spline_edge_len = segments_num(spline_vert_len, spline_cyclic);
+      const int profile_edge_len = segments_num(profile_vert_len, profile_cyclic);
+
+      /* Add the ring edges, with one ring for every curve vertex, and the edge loops
+       * that run along the length of the curve, starting on the first profile. */
+      vert[i_mesh] = spline_vert_len * profile_vert_len;
+      edge[i_mesh] = spline_vert_len * profile_edge_len + spline_edge_len * profile_vert_len;
+      const int tube_polys = spline_edge_len * profile_edge_len;
+      if (has_caps(fill_caps, spline_cyclic, profile_cyclic, profile_edge_len)) {
+        loop[i_mesh] = tube_polys * 4 + profile_edge_len * 2;
+        poly[i_mesh] = tube_polys + 2;
+      }
+      else {
+        loop[i_mesh] = tube_polys * 4;
+        poly[i_mesh] = tube_polys;
+      }
     }
-  }
-  vert.last() = vert_offset;
-  edge.last() = edge_offset;
-  loop.last() = loop_offset;
-  poly.last() = poly_offset;
+  });
+  vert.last() = 0;
+  edge.last() = 0;
+  loop.last() = 0;
+  poly.last() = 0;
+  parallel_prefix_sum(vert.as_span(), vert.as_mutable_span(), false);
+  parallel_prefix_sum(edge.as_span(), edge.as_mutable_span(), false);
+  parallel_prefix_sum(loop.as_span(), loop.as_mutable_span(), false);
+  parallel_prefix_sum(poly.as_span(), poly.as_mutable_span(), false);
 
   return {std::move(vert), std::move(edge), std::move(loop), std::move(poly)};
 }
 
+/**
+ * Call \a fn for every curve spline and profile spline combination that creates any mesh
+ * elements. The combinations are processed in parallel, in chunks of neighboring combinations.
+ */
+template<typename Fn>
+static void foreach_curve_combination(const CurvesInfo &curves,
+                                      const CurvesInfo &profiles,
+                                      const ResultOffsets &offsets,
+                                      const Fn &fn)
+{
+  const int profiles_num = profiles.curves_num();
+  const int total = curves.curves_num() * profiles_num;
+  threading::parallel_for(IndexRange(total), 512, [&](IndexRange range) {
+    for (const int i_mesh : range) {
+      if (offsets.vert[i_mesh] == offsets.vert[i_mesh + 1]) {
+        continue;
+      }
+      const int i_spline = i_mesh / profiles_num;
+      const int i_profile = i_mesh % profiles_num;
+      const IndexRange spline_points = curves.points_for_curve(i_spline);
+      const IndexRange profile_points = profiles.points_for_curve(i_profile);
+      const bool spline_cyclic = curves.cyclic[i_spline];
+      const bool profile_cyclic = profiles.cyclic[i_profile];
+      fn(ResultInfo{
+          i_spline,
+          i_profile,
+          spline_points,
+          profile_points,
+          spline_cyclic,
+          profile_cyclic,
+          offsets.vert[i_mesh],
+          offsets.edge[i_mesh],
+          offsets.loop[i_mesh],
+          offsets.poly[i_mesh],
+          int(spline_points.size()),
+          segments_num(spline_points.size(), spline_cyclic),
+          int(profile_points.size()),
+          segments_num(profile_points.size(), profile_cyclic),
+      });
+    }
+  });
+}
+
 static AttributeDomain get_result_attribute_domain(const MeshComponent &component,
                                                    const AttributeIDRef &attribute_id)
 {
@@ -359,27 +514,28 @@ static std::optional<ResultAttributeData> create_attribute_and_get_span(
   return std::make_optional<ResultAttributeData>({span, domain});
 }
 
+/** A result attribute and the input attribute it is created from. */
+struct ResultAttribute {
+  AttributeIDRef id;
+  CustomDataType data_type;
+  /**
+   * The data is optional in case the attribute does not exist on the mesh for some reason, like
+   * "shade_smooth" when the result has no faces, or because the name is used by an attribute on
+   * the curve input, which takes precedence over the profile input.
+   */
+  std::optional<ResultAttributeData> result;
+};
+
 /**
  * Store the references to the attribute data from the curve and profile inputs. Here we rely on
- * the invariants of the storage of curve attributes, that the order will be consistent between
- * splines, and all splines will have the same attributes.
+ * the invariants of the storage of curve attributes, that all splines will have the same
+ * attributes.
  */
 struct ResultAttributes {
-  /**
-   * Result attributes on the mesh corresponding to each attribute on the curve input, in the same
-   * order. The data is optional only in case the attribute does not exist on the mesh for some
-   * reason, like "shade_smooth" when the result has no faces.
-   */
-  Vector<std::optional<ResultAttributeData>> curve_point_attributes;
-  Vector<std::optional<ResultAttributeData>> curve_spline_attributes;
-
-  /**
-   * Result attributes corresponding the attributes on the profile input, in the same order. The
-   * attributes are optional in case the attribute names correspond to a names used by the curve
-   * input, in which case the curve input attributes take precedence.
-   */
-  Vector<std::optional<ResultAttributeData>> profile_point_attributes;
-  Vector<std::optional<ResultAttributeData>> profile_spline_attributes;
+  Vector<ResultAttribute> curve_point_attributes;
+  Vector<ResultAttribute> curve_spline_attributes;
+  Vector<ResultAttribute> profile_point_attributes;
+  Vector<ResultAttribute> profile_spline_attributes;
 
   /**
    * Because some builtin attributes are not stored contiguously, and the curve inputs might have
@@ -402,7 +558,9 @@ static ResultAttributes create_result_attributes(const CurveEval &curve,
       [&](const AttributeIDRef &id, const AttributeMetaData &meta_data) {
         curve_attributes.add_new(id);
         result.curve_point_attributes.append(
-            create_attribute_and_get_span(mesh_component, id, meta_data, result.attributes));
+            {id,
+             meta_data.data_type,
+             create_attribute_and_get_span(mesh_component, id, meta_data, result.attributes)});
         return true;
       },
       ATTR_DOMAIN_POINT);
@@ -410,18 +568,22 @@ static ResultAttributes create_result_attributes(const CurveEval &curve,
       [&](const AttributeIDRef &id, const AttributeMetaData &meta_data) {
         curve_attributes.add_new(id);
         result.curve_spline_attributes.append(
-            create_attribute_and_get_span(mesh_component, id, meta_data, result.attributes));
+            {id,
+             meta_data.data_type,
+             create_attribute_and_get_span(mesh_component, id, meta_data, result.attributes)});
         return true;
       },
       ATTR_DOMAIN_CURVE);
   profile.splines().first()->attributes.foreach_attribute(
       [&](const AttributeIDRef &id, const AttributeMetaData &meta_data) {
         if (curve_attributes.contains(id)) {
-          result.profile_point_attributes.append({});
+          result.profile_point_attributes.append({id, meta_data.data_type, std::nullopt});
         }
         else {
           result.profile_point_attributes.append(
-              create_attribute_and_get_span(mesh_component, id, meta_data, result.attributes));
+              {id,
+               meta_data.data_type,
+               create_attribute_and_get_span(mesh_component, id, meta_data, result.attributes)});
         }
         return true;
       },
@@ -429,11 +591,13 @@ static ResultAttributes create_result_attributes(const CurveEval &curve,
   profile.attributes.foreach_attribute(
       [&](const AttributeIDRef &id, const AttributeMetaData &meta_data) {
         if (curve_attributes.contains(id)) {
-          result.profile_spline_attributes.append({});
+          result.profile_spline_attributes.append({id, meta_data.data_type, std::nullopt});
         }
         else {
           result.profile_spline_attributes.append(
-              create_attribute_and_get_span(mesh_component, id, meta_data, result.attributes));
+              {id,
+               meta_data.data_type,
+               create_attribute_and_get_span(mesh_component, id, meta_data, result.attributes)});
         }
         return true;
       },
@@ -442,6 +606,33 @@ static ResultAttributes create_result_attributes(const CurveEval &curve,
   return result;
 }
 
+/**
+ * Interpolate a point attribute of every spline to its evaluated points, so that it only has to
+ * be done once, rather than for every combination with a spline of the other input.
+ */
+static GArray<> interpolate_point_attribute_to_evaluated(const CurveEval &curve,
+                                                         const CurvesInfo &info,
+                                                         const AttributeIDRef &id,
+                                                         const CPPType &type)
+{
+  const Span<SplinePtr> splines = curve.splines();
+  GArray<> evaluated(type, info.offsets.last());
+  threading::parallel_for(splines.index_range(), 128, [&](IndexRange range) {
+    for (const int i : range) {
+      const Spline &spline = *splines[i];
+      const IndexRange points = info.points_for_curve(i);
+      if (points.size() == 0) {
+        continue;
+      }
+      std::optional<GSpan> src = spline.attributes.get_for_read(id);
+      BLI_assert(src);
+      spline.interpolate_to_evaluated(*src).materialize(
+          evaluated.as_mutable_span().slice(points.start(), points.size()).data());
+    }
+  });
+  return evaluated;
+}
+
 template<typename T>
 static void copy_curve_point_data_to_mesh_verts(const Span<T> src,
                                                 const ResultInfo &info,
@@ -477,23 +668,33 @@ static void copy_curve_point_data_to_mesh_faces(const Span<T> src,
 }
 
 static void copy_curve_point_attribute_to_mesh(const GSpan src,
-                                               const ResultInfo &info,
+                                               const CurvesInfo &curves,
+                                               const CurvesInfo &profiles,
+                                               const ResultOffsets &offsets,
                                                ResultAttributeData &dst)
 {
-  GVArray interpolated_gvarray = info.spline.interpolate_to_evaluated(src);
-  GSpan interpolated = interpolated_gvarray.get_internal_span();
-
   attribute_math::convert_to_static_type(src.type(), [&](auto dummy) {
     using T = decltype(dummy);
+    const Span<T> src_typed = src.typed<T>();
+    MutableSpan<T> dst_typed = dst.data.typed<T>();
     switch (dst.domain) {
       case ATTR_DOMAIN_POINT:
-        copy_curve_point_data_to_mesh_verts(interpolated.typed<T>(), info, dst.data.typed<T>());
+        foreach_curve_combination(curves, profiles, offsets, [&](const ResultInfo &info) {
+          copy_curve_point_data_to_mesh_verts(
+              src_typed.slice(info.spline_points), info, dst_typed);
+        });
         break;
       case ATTR_DOMAIN_EDGE:
-        copy_curve_point_data_to_mesh_edges(interpolated.typed<T>(), info, dst.data.typed<T>());
+        foreach_curve_combination(curves, profiles, offsets, [&](const ResultInfo &info) {
+          copy_curve_point_data_to_mesh_edges(
+              src_typed.slice(info.spline_points), info, dst_typed);
+        });
         break;
       case ATTR_DOMAIN_FACE:
-        copy_curve_point_data_to_mesh_faces(interpolated.typed<T>(), info, dst.data.typed<T>());
+        foreach_curve_combination(curves, profiles, offsets, [&](const ResultInfo &info) {
+          copy_curve_point_data_to_mesh_faces(
+              src_typed.slice(info.spline_points), info, dst_typed);
+        });
         break;
       case ATTR_DOMAIN_CORNER:
         /* Unsupported for now, since there are no builtin attributes to convert into. */
@@ -543,23 +744,33 @@ static void copy_profile_point_data_to_mesh_faces(const Span<T> src,
 }
 
 static void copy_profile_point_attribute_to_mesh(const GSpan src,
-                                                 const ResultInfo &info,
+                                                 const CurvesInfo &curves,
+                                                 const CurvesInfo &profiles,
+                                                 const ResultOffsets &offsets,
                                                  ResultAttributeData &dst)
 {
-  GVArray interpolated_gvarray = info.profile.interpolate_to_evaluated(src);
-  GSpan interpolated = interpolated_gvarray.get_internal_span();
-
   attribute_math::convert_to_static_type(src.type(), [&](auto dummy) {
     using T = decltype(dummy);
+    const Span<T> src_typed = src.typed<T>();
+    MutableSpan<T> dst_typed = dst.data.typed<T>();
     switch (dst.domain) {
       case ATTR_DOMAIN_POINT:
-        copy_profile_point_data_to_mesh_verts(interpolated.typed<T>(), info, dst.data.typed<T>());
+        foreach_curve_combination(curves, profiles, offsets, [&](const ResultInfo &info) {
+          copy_profile_point_data_to_mesh_verts(
+              src_typed.slice(info.profile_points), info, dst_typed);
+        });
         break;
       case ATTR_DOMAIN_EDGE:
-        copy_profile_point_data_to_mesh_edges(interpolated.typed<T>(), info, dst.data.typed<T>());
+        foreach_curve_combination(curves, profiles, offsets, [&](const ResultInfo &info) {
+          copy_profile_point_data_to_mesh_edges(
+              src_typed.slice(info.profile_points), info, dst_typed);
+        });
         break;
       case ATTR_DOMAIN_FACE:
-        copy_profile_point_data_to_mesh_faces(interpolated.typed<T>(), info, dst.data.typed<T>());
+        foreach_curve_combination(curves, profiles, offsets, [&](const ResultInfo &info) {
+          copy_profile_point_data_to_mesh_faces(
+              src_typed.slice(info.profile_points), info, dst_typed);
+        });
         break;
       case ATTR_DOMAIN_CORNER:
         /* Unsupported for now, since there are no builtin attributes to convert into. */
@@ -571,45 +782,34 @@ static void copy_profile_point_attribute_to_mesh(const GSpan src,
   });
 }
 
-static void copy_point_domain_attributes_to_mesh(const ResultInfo &info,
+static void copy_point_domain_attributes_to_mesh(const CurveEval &curve,
+                                                 const CurveEval &profile,
+                                                 const CurvesInfo &curves,
+                                                 const CurvesInfo &profiles,
+                                                 const ResultOffsets &offsets,
                                                  ResultAttributes &attributes)
 {
-  if (!attributes.curve_point_attributes.is_empty()) {
-    int i = 0;
-    info.spline.attributes.foreach_attribute(
-        [&](const AttributeIDRef &id, const AttributeMetaData &UNUSED(meta_data)) {
-          if (attributes.curve_point_attributes[i]) {
-            copy_curve_point_attribute_to_mesh(*info.spline.attributes.get_for_read(id),
-                                               info,
-                                               *attributes.curve_point_attributes[i]);
-          }
-          i++;
-          return true;
-        },
-        ATTR_DOMAIN_POINT);
+  for (ResultAttribute &attribute : attributes.curve_point_attributes) {
+    if (attribute.result) {
+      const GArray<> evaluated = interpolate_point_attribute_to_evaluated(
+          curve, curves, attribute.id, *custom_data_type_to_cpp_type(attribute.data_type));
+      copy_curve_point_attribute_to_mesh(evaluated, curves, profiles, offsets, *attribute.result);
+    }
   }
-  if (!attributes.profile_point_attributes.is_empty()) {
-    int i = 0;
-    info.profile.attributes.foreach_attribute(
-        [&](const AttributeIDRef &id, const AttributeMetaData &UNUSED(meta_data)) {
-          if (attributes.profile_point_attributes[i]) {
-            copy_profile_point_attribute_to_mesh(*info.profile.attributes.get_for_read(id),
-                                                 info,
-                                                 *attributes.profile_point_attributes[i]);
-          }
-          i++;
-          return true;
-        },
-        ATTR_DOMAIN_POINT);
+  for (ResultAttribute &attribute : attributes.profile_point_attributes) {
+    if (attribute.result) {
+      const GArray<> evaluated = interpolate_point_attribute_to_evaluated(
+          profile, profiles, attribute.id, *custom_data_type_to_cpp_type(attribute.data_type));
+      copy_profile_point_attribute_to_mesh(
+          evaluated, curves, profiles, offsets, *attribute.result);
+    }
   }
 }
 
 template<typename T>
-static void copy_spline_data_to_mesh(Span<T> src, Span<int> offsets, MutableSpan<T> dst)
+static void copy_spline_data_to_mesh(const T &src, const int offset, const int size, T *dst)
 {
-  for (const int i : IndexRange(src.size())) {
-    dst.slice(offsets[i], offsets[i + 1] - offsets[i]).fill(src[i]);
-  }
+  std::fill_n(dst + offset, size, src);
 }
 
 /**
@@ -618,72 +818,80 @@ static void copy_spline_data_to_mesh(Span<T> src, Span<int> offsets, MutableSpan
  * the same function for all mesh domains.
  */
 static void copy_spline_attribute_to_mesh(const GSpan src,
+                                          const bool is_profile,
+                                          const CurvesInfo &curves,
+                                          const CurvesInfo &profiles,
                                           const ResultOffsets &offsets,
                                           ResultAttributeData &dst_attribute)
 {
+  Span<int> domain_offsets;
+  switch (dst_attribute.domain) {
+    case ATTR_DOMAIN_POINT:
+      domain_offsets = offsets.vert;
+      break;
+    case ATTR_DOMAIN_EDGE:
+      domain_offsets = offsets.edge;
+      break;
+    case ATTR_DOMAIN_FACE:
+      domain_offsets = offsets.poly;
+      break;
+    case ATTR_DOMAIN_CORNER:
+      domain_offsets = offsets.loop;
+      break;
+    default:
+      BLI_assert_unreachable();
+      return;
+  }
   attribute_math::convert_to_static_type(src.type(), [&](auto dummy) {
     using T = decltype(dummy);
-    switch (dst_attribute.domain) {
-      case ATTR_DOMAIN_POINT:
-        copy_spline_data_to_mesh(src.typed<T>(), offsets.vert, dst_attribute.data.typed<T>());
-        break;
-      case ATTR_DOMAIN_EDGE:
-        copy_spline_data_to_mesh(src.typed<T>(), offsets.edge, dst_attribute.data.typed<T>());
-        break;
-      case ATTR_DOMAIN_FACE:
-        copy_spline_data_to_mesh(src.typed<T>(), offsets.poly, dst_attribute.data.typed<T>());
-        break;
-      case ATTR_DOMAIN_CORNER:
-        copy_spline_data_to_mesh(src.typed<T>(), offsets.loop, dst_attribute.data.typed<T>());
-        break;
-      default:
-        BLI_assert_unreachable();
-        break;
-    }
+    const Span<T> src_typed = src.typed<T>();
+    T *dst = dst_attribute.data.typed<T>().data();
+    foreach_curve_combination(curves, profiles, offsets, [&](const ResultInfo &info) {
+      const int i_mesh = info.i_spline * profiles.curves_num() + info.i_profile;
+      const int i_src = is_profile ? info.i_profile : info.i_spline;
+      copy_spline_data_to_mesh(src_typed[i_src],
+                               domain_offsets[i_mesh],
+                               domain_offsets[i_mesh + 1] - domain_offsets[i_mesh],
+                               dst);
+    });
   });
 }
 
 static void copy_spline_domain_attributes_to_mesh(const CurveEval &curve,
                                                   const CurveEval &profile,
+                                                  const CurvesInfo &curves,
+                                                  const CurvesInfo &profiles,
                                                   const ResultOffsets &offsets,
                                                   ResultAttributes &attributes)
 {
-  if (!attributes.curve_spline_attributes.is_empty()) {
-    int i = 0;
-    curve.attributes.foreach_attribute(
-        [&](const AttributeIDRef &id, const AttributeMetaData &UNUSED(meta_data)) {
-          if (attributes.curve_spline_attributes[i]) {
-            copy_spline_attribute_to_mesh(*curve.attributes.get_for_read(id),
-                                          offsets,
-                                          *attributes.curve_spline_attributes[i]);
-          }
-          i++;
-          return true;
-        },
-        ATTR_DOMAIN_CURVE);
+  for (ResultAttribute &attribute : attributes.curve_spline_attributes) {
+    if (attribute.result) {
+      copy_spline_attribute_to_mesh(*curve.attributes.get_for_read(attribute.id),
+                                    false,
+                                    curves,
+                                    profiles,
+                                    offsets,
+                                    *attribute.result);
+    }
   }
-  if (!attributes.profile_spline_attributes.is_empty()) {
-    int i = 0;
-    profile.attributes.foreach_attribute(
-        [&](const AttributeIDRef &id, const AttributeMetaData &UNUSED(meta_data)) {
-          if (attributes.profile_spline_attributes[i]) {
-            copy_spline_attribute_to_mesh(*profile.attributes.get_for_read(id),
-                                          offsets,
-                                          *attributes.profile_spline_attributes[i]);
-          }
-          i++;
-          return true;
-        },
-        ATTR_DOMAIN_CURVE);
+  for (ResultAttribute &attribute : attributes.profile_spline_attributes) {
+    if (attribute.result) {
+      copy_spline_attribute_to_mesh(*profile.attributes.get_for_read(attribute.id),
+                                    true,
+                                    curves,
+                                    profiles,
+                                    offsets,
+                                    *attribute.result);
+    }
   }
 }
 
 Mesh *curve_to_mesh_sweep(const CurveEval &curve, const CurveEval &profile, const bool fill_caps)
 {
-  Span<SplinePtr> profiles = profile.splines();
-  Span<SplinePtr> curves = curve.splines();
+  const CurvesInfo curves = gather_curve_info(curve);
+  const CurvesInfo profiles = gather_profile_info(profile);
 
-  const ResultOffsets offsets = calculate_result_offsets(profiles, curves, fill_caps);
+  const ResultOffsets offsets = calculate_result_offsets(curves, profiles, fill_caps);
   if (offsets.vert.last() == 0) {
     return nullptr;
   }
@@ -701,44 +909,19 @@ Mesh *curve_to_mesh_sweep(const CurveEval &curve, const CurveEval &profile, cons
   mesh_component.replace(mesh, GeometryOwnershipType::Editable);
   ResultAttributes attributes = create_result_attributes(curve, profile, mesh_component);
 
-  threading::parallel_for(curves.index_range(), 128, [&](IndexRange curves_range) {
-    for (const int i_spline : curves_range) {
-      const Spline &spline = *curves[i_spline];
-      if (spline.evaluated_points_size() == 0) {
-        continue;
-      }
-      const int spline_start_index = i_spline * profiles.size();
-      threading::parallel_for(profiles.index_range(), 128, [&](IndexRange profiles_range) {
-        for (const int i_profile : profiles_range) {
-          const Spline &profile = *profiles[i_profile];
-          const int i_mesh = spline_start_index + i_profile;
-          ResultInfo info{
-              spline,
-              profile,
-              offsets.vert[i_mesh],
-              offsets.edge[i_mesh],
-              offsets.loop[i_mesh],
-              offsets.poly[i_mesh],
-              spline.evaluated_points_size(),
-              spline.evaluated_edges_size(),
-              profile.evaluated_points_size(),
-              profile.evaluated_edges_size(),
-          };
-
-          spline_extrude_to_mesh_data(info,
-                                      fill_caps,
-                                      {mesh->mvert, mesh->totvert},
-                                      {mesh->medge, mesh->totedge},
-                                      {mesh->mloop, mesh->totloop},
-                                      {mesh->mpoly, mesh->totpoly});
-
-          copy_point_domain_attributes_to_mesh(info, attributes);
-        }
-      });
-    }
+  foreach_curve_combination(curves, profiles, offsets, [&](const ResultInfo &info) {
+    spline_extrude_to_mesh_data(info,
+                                curves,
+                                profiles,
+                                fill_caps,
+                                {mesh->mvert, mesh->totvert},
+                                {mesh->medge, mesh->totedge},
+                                {mesh->mloop, mesh->totloop},
+                                {mesh->mpoly, mesh->totpoly});
   });
 
-  copy_spline_domain_attributes_to_mesh(curve, profile, offsets, attributes);
+  copy_point_domain_attributes_to_mesh(curve, profile, curves, profiles, offsets, attributes);
+  copy_spline_domain_attributes_to_mesh(curve, profile, curves, profiles, offsets, attributes);
 
   for (OutputAttribute &output_attribute : attributes.attributes) {
     output_attribute.save();
@@ -0,0 +1,506 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include <cmath>
+
+#include "CLG_log.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_float4x4.hh"
+#include "BLI_index_range.hh"
+#include "BLI_timeit.hh"
+#include "BLI_vector.hh"
+
+#include "BKE_curve_to_mesh.hh"
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_spline.hh"
+
+namespace blender::bke::tests {
+
+class curve_to_mesh : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BKE_idtype_init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    CLG_exit();
+  }
+};
+
+static void init_spline_points(Spline &spline, const Span<float3> positions, const bool cyclic)
+{
+  spline.resize(positions.size());
+  spline.positions().copy_from(positions);
+  for (const int i : positions.index_range()) {
+    spline.radii()[i] = 1.0f + 0.1f * i;
+    spline.tilts()[i] = 0.2f * i;
+  }
+  spline.set_cyclic(cyclic);
+}
+
+static SplinePtr create_poly_spline(const Span<float3> positions, const bool cyclic)
+{
+  std::unique_ptr<PolySpline> spline = std::make_unique<PolySpline>();
+  init_spline_points(*spline, positions, cyclic);
+  return spline;
+}
+
+/** Points with a true value in \a sharp use vector handles, the others use auto handles. */
+static SplinePtr create_bezier_spline(const Span<float3> positions,
+                                      const Span<bool> sharp,
+                                      const bool cyclic)
+{
+  std::unique_ptr<BezierSpline> spline = std::make_unique<BezierSpline>();
+  spline->set_resolution(4);
+  init_spline_points(*spline, positions, cyclic);
+  for (const int i : positions.index_range()) {
+    const int8_t type = sharp[i] ? BEZIER_HANDLE_VECTOR : BEZIER_HANDLE_AUTO;
+    spline->handle_types_left()[i] = type;
+    spline->handle_types_right()[i] = type;
+  }
+  spline->mark_cache_invalid();
+  return spline;
+}
+
+static SplinePtr create_nurbs_spline(const Span<float3> positions, const bool cyclic)
+{
+  std::unique_ptr<NURBSpline> spline = std::make_unique<NURBSpline>();
+  spline->knots_mode = NURBSpline::KnotsMode::EndPoint;
+  spline->set_resolution(3);
+  spline->set_order(3);
+  init_spline_points(*spline, positions, cyclic);
+  spline->weights().fill(1.0f);
+  spline->weights()[1] = 2.0f;
+  spline->mark_cache_invalid();
+  return spline;
+}
+
+template<typename... Splines> static Vector<SplinePtr> spline_list(Splines... splines)
+{
+  Vector<SplinePtr> list;
+  (list.append(std::move(splines)), ...);
+  return list;
+}
+
+static std::unique_ptr<CurveEval> create_curve(Vector<SplinePtr> splines)
+{
+  std::unique_ptr<CurveEval> curve = std::make_unique<CurveEval>();
+  curve->add_splines(splines);
+  curve->attributes.reallocate(curve->splines().size());
+  return curve;
+}
+
+/** The main curve input, with one spline of every type and different cyclic settings. */
+static std::unique_ptr<CurveEval> create_test_curve()
+{
+  Vector<SplinePtr> splines;
+  splines.append(create_poly_spline({{0, 0, 0}, {1, 0, 0}, {2, 1, 0}, {3, 1, 1}}, false));
+  splines.append(
+      create_bezier_spline({{0, 0, 2}, {2, 0, 2}, {2, 2, 3}}, {false, true, false}, true));
+  splines.append(create_nurbs_spline({{0, 3, 0}, {1, 4, 0}, {2, 3, 1}, {3, 4, 0}, {4, 3, 0}},
+                                     false));
+  return create_curve(std::move(splines));
+}
+
+static std::unique_ptr<CurveEval> create_test_profile(const bool cyclic)
+{
+  Vector<SplinePtr> splines;
+  splines.append(create_poly_spline(
+      {{0.2f, 0, 0}, {0.1f, 0.2f, 0}, {-0.1f, 0.2f, 0}, {-0.2f, 0, 0}, {0, -0.2f, 0}}, cyclic));
+  splines.append(create_bezier_spline(
+      {{0.3f, 0, 0}, {0, 0.3f, 0}, {-0.3f, 0, 0}}, {true, false, true}, cyclic));
+  splines.append(create_nurbs_spline(
+      {{0.1f, 0, 0}, {0, 0.1f, 0}, {-0.1f, 0, 0}, {0, -0.1f, 0.1f}}, cyclic));
+  return create_curve(std::move(splines));
+}
+
+/** Mesh data in the same layout as the result of #curve_to_mesh_sweep. */
+struct ReferenceMesh {
+  Vector<float3> positions;
+  Vector<MEdge> edges;
+  Vector<MPoly> polys;
+  Vector<MLoop> loops;
+};
+
+/**
+ * Sweep one profile spline along one curve spline, going through the virtual spline interface
+ * like the sweep did before it was changed to work on flat arrays.
+ */
+static void reference_sweep_splines(const Spline &spline,
+                                    const Spline &profile,
+                                    const bool fill_caps,
+                                    ReferenceMesh &result)
+{
+  const int spline_vert_len = spline.evaluated_points_size();
+  const int spline_edge_len = spline.evaluated_edges_size();
+  const int profile_vert_len = profile.evaluated_points_size();
+  const int profile_edge_len = profile.evaluated_edges_size();
+  if (spline_vert_len == 0 || profile_vert_len == 0) {
+    return;
+  }
+  const int vert_offset = result.positions.size();
+  const int edge_offset = result.edges.size();
+
+  const Span<float3> positions = spline.evaluated_positions();
+  const Span<float3> tangents = spline.evaluated_tangents();
+  const Span<float3> normals = spline.evaluated_normals();
+  const VArray<float> radii = spline.interpolate_to_evaluated(spline.radii());
+  for (const int i_ring : IndexRange(spline_vert_len)) {
+    float4x4 point_matrix = float4x4::from_normalized_axis_data(
+        positions[i_ring], normals[i_ring], tangents[i_ring]);
+    point_matrix.apply_scale(radii[i_ring]);
+    for (const float3 &profile_position : profile.evaluated_positions()) {
+      result.positions.append(point_matrix * profile_position);
+    }
+  }
+
+  auto add_edge = [&](const int v1, const int v2, const short flag) {
+    MEdge edge{};
+    edge.v1 = v1;
+    edge.v2 = v2;
+    edge.flag = flag;
+    result.edges.append(edge);
+  };
+
+  if (profile_vert_len == 1) {
+    for (const int i : IndexRange(spline_edge_len)) {
+      add_edge(vert_offset + i, vert_offset + (i + 1) % spline_vert_len, ME_LOOSEEDGE);
+    }
+    return;
+  }
+
+  auto ring_vert = [&](const int i_ring, const int i_profile) {
+    return vert_offset + i_ring * profile_vert_len + i_profile;
+  };
+  auto spline_edge = [&](const int i_profile, const int i_ring) {
+    return edge_offset + i_profile * spline_edge_len + i_ring;
+  };
+  auto ring_edge = [&](const int i_ring, const int i_profile) {
+    return edge_offset + profile_vert_len * spline_edge_len + i_ring * profile_edge_len +
+           i_profile;
+  };
+
+  for (const int i_profile : IndexRange(profile_vert_len)) {
+    for (const int i_ring : IndexRange(spline_edge_len)) {
+      add_edge(ring_vert(i_ring, i_profile),
+               ring_vert((i_ring + 1) % spline_vert_len, i_profile),
+               ME_EDGEDRAW | ME_EDGERENDER);
+    }
+  }
+  for (const int i_ring : IndexRange(spline_vert_len)) {
+    for (const int i_profile : IndexRange(profile_edge_len)) {
+      add_edge(ring_vert(i_ring, i_profile),
+               ring_vert(i_ring, (i_profile + 1) % profile_vert_len),
+               ME_EDGEDRAW | ME_EDGERENDER);
+    }
+  }
+
+  auto add_poly = [&](const int size, const char flag) {
+    MPoly poly{};
+    poly.loopstart = result.loops.size();
+    poly.totloop = size;
+    poly.flag = flag;
+    result.polys.append(poly);
+  };
+  auto add_loop = [&](const int vert, const int edge) {
+    MLoop loop{};
+    loop.v = vert;
+    loop.e = edge;
+    result.loops.append(loop);
+  };
+
+  for (const int i_ring : IndexRange(spline_edge_len)) {
+    const int i_next_ring = (i_ring + 1) % spline_vert_len;
+    for (const int i_profile : IndexRange(profile_edge_len)) {
+      const int i_next_profile = (i_profile + 1) % profile_vert_len;
+      add_poly(4, ME_SMOOTH);
+      add_loop(ring_vert(i_ring, i_profile), ring_edge(i_ring, i_profile));
+      add_loop(ring_vert(i_ring, i_next_profile), spline_edge(i_next_profile, i_ring));
+      add_loop(ring_vert(i_next_ring, i_next_profile), ring_edge(i_next_ring, i_profile));
+      add_loop(ring_vert(i_next_ring, i_profile), spline_edge(i_profile, i_ring));
+    }
+  }
+
+  if (fill_caps && profile.is_cyclic() && !spline.is_cyclic()) {
+    const int last_ring = spline_vert_len - 1;
+    add_poly(profile_edge_len, 0);
+    for (const int i : IndexRange(profile_edge_len)) {
+      const int i_inv = profile_edge_len - i - 1;
+      add_loop(ring_vert(0, i_inv),
+               ring_edge(0, (i == profile_edge_len - 1) ? profile_edge_len - 1 : i_inv - 1));
+    }
+    add_poly(profile_edge_len, 0);
+    for (const int i : IndexRange(profile_edge_len)) {
+      add_loop(ring_vert(last_ring, i), ring_edge(last_ring, i));
+    }
+    for (const int i : IndexRange(profile_edge_len)) {
+      result.edges[ring_edge(0, i)].flag |= ME_SHARP;
+      result.edges[ring_edge(last_ring, i)].flag |= ME_SHARP;
+    }
+  }
+
+  if (profile.type() == CURVE_TYPE_BEZIER) {
+    const BezierSpline &bezier_profile = static_cast<const BezierSpline &>(profile);
+    const Span<int> control_point_offsets = bezier_profile.control_point_offsets();
+    for (const int i : IndexRange(bezier_profile.size())) {
+      if (bezier_profile.point_is_sharp(i)) {
+        for (const int i_ring : IndexRange(spline_edge_len)) {
+          result.edges[spline_edge(control_point_offsets[i], i_ring)].flag |= ME_SHARP;
+        }
+      }
+    }
+  }
+}
+
+static ReferenceMesh reference_sweep(const CurveEval &curve,
+                                     const CurveEval &profile,
+                                     const bool fill_caps)
+{
+  ReferenceMesh result;
+  for (const SplinePtr &spline : curve.splines()) {
+    for (const SplinePtr &profile_spline : profile.splines()) {
+      reference_sweep_splines(*spline, *profile_spline, fill_caps, result);
+    }
+  }
+  return result;
+}
+
+static void expect_mesh_matches_reference(const Mesh &mesh, const ReferenceMesh &reference)
+{
+  ASSERT_EQ(mesh.totvert, reference.positions.size());
+  ASSERT_EQ(mesh.totedge, reference.edges.size());
+  ASSERT_EQ(mesh.totpoly, reference.polys.size());
+  ASSERT_EQ(mesh.totloop, reference.loops.size());
+  for (const int i : reference.positions.index_range()) {
+    EXPECT_NEAR(mesh.mvert[i].co[0], reference.positions[i].x, 1e-5f);
+    EXPECT_NEAR(mesh.mvert[i].co[1], reference.positions[i].y, 1e-5f);
+    EXPECT_NEAR(mesh.mvert[i].co[2], reference.positions[i].z, 1e-5f);
+  }
+  for (const int i : reference.edges.index_range()) {
+    EXPECT_EQ(mesh.medge[i].v1, reference.edges[i].v1) << "Edge " << i;
+    EXPECT_EQ(mesh.medge[i].v2, reference.edges[i].v2) << "Edge " << i;
+    EXPECT_EQ(mesh.medge[i].flag, reference.edges[i].flag) << "Edge " << i;
+  }
+  for (const int i : reference.polys.index_range()) {
+    EXPECT_EQ(mesh.mpoly[i].loopstart, reference.polys[i].loopstart) << "Face " << i;
+    EXPECT_EQ(mesh.mpoly[i].totloop, reference.polys[i].totloop) << "Face " << i;
+    EXPECT_EQ(mesh.mpoly[i].flag, reference.polys[i].flag) << "Face " << i;
+  }
+  for (const int i : reference.loops.index_range()) {
+    EXPECT_EQ(mesh.mloop[i].v, reference.loops[i].v) << "Corner " << i;
+    EXPECT_EQ(mesh.mloop[i].e, reference.loops[i].e) << "Corner " << i;
+  }
+}
+
+static void test_sweep_matches_reference(const bool profile_cyclic, const bool fill_caps)
+{
+  std::unique_ptr<CurveEval> curve = create_test_curve();
+  std::unique_ptr<CurveEval> profile = create_test_profile(profile_cyclic);
+  Mesh *mesh = curve_to_mesh_sweep(*curve, *profile, fill_caps);
+  ASSERT_NE(mesh, nullptr);
+  expect_mesh_matches_reference(*mesh, reference_sweep(*curve, *profile, fill_caps));
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(curve_to_mesh, SweepCyclicProfile)
+{
+  test_sweep_matches_reference(true, false);
+}
+
+TEST_F(curve_to_mesh, SweepCyclicProfileCaps)
+{
+  test_sweep_matches_reference(true, true);
+}
+
+TEST_F(curve_to_mesh, SweepNonCyclicProfile)
+{
+  test_sweep_matches_reference(false, false);
+}
+
+TEST_F(curve_to_mesh, SweepNonCyclicProfileCaps)
+{
+  test_sweep_matches_reference(false, true);
+}
+
+TEST_F(curve_to_mesh, WireMesh)
+{
+  std::unique_ptr<CurveEval> curve = create_test_curve();
+  Mesh *mesh = curve_to_wire_mesh(*curve);
+  ASSERT_NE(mesh, nullptr);
+  std::unique_ptr<CurveEval> profile = create_curve(
+      spline_list(create_poly_spline({{0, 0, 0}}, false)));
+  expect_mesh_matches_reference(*mesh, reference_sweep(*curve, *profile, false));
+  EXPECT_EQ(mesh->totpoly, 0);
+  BKE_id_free(nullptr, mesh);
+}
+
+/* A single point profile has no edges, so there are no caps, even if it is cyclic. This used to
+ * add empty faces. */
+TEST_F(curve_to_mesh, NoCapsForSinglePointProfile)
+{
+  std::unique_ptr<CurveEval> curve = create_curve(
+      spline_list(create_poly_spline({{0, 0, 0}, {1, 0, 0}, {2, 0, 0}, {3, 0, 0}}, false)));
+  std::unique_ptr<CurveEval> profile = create_curve(
+      spline_list(create_poly_spline({{0, 1, 0}}, true)));
+  Mesh *mesh = curve_to_mesh_sweep(*curve, *profile, true);
+  ASSERT_NE(mesh, nullptr);
+  EXPECT_EQ(mesh->totvert, 4);
+  EXPECT_EQ(mesh->totedge, 3);
+  EXPECT_EQ(mesh->totpoly, 0);
+  EXPECT_EQ(mesh->totloop, 0);
+  BKE_id_free(nullptr, mesh);
+}
+
+template<typename T>
+static Span<T> get_mesh_attribute(const CustomData &data,
+                                  const CustomDataType type,
+                                  const char *name,
+                                  const int size)
+{
+  const T *values = static_cast<const T *>(CustomData_get_layer_named(&data, type, name));
+  if (values == nullptr) {
+    return {};
+  }
+  return {values, size};
+}
+
+/**
+ * Point attributes are interpolated to the evaluated points of every spline. Spline attributes
+ * are copied to all elements created from the spline, for every combination of a curve and a
+ * profile spline. Curve attributes take precedence over profile attributes with the same name.
+ */
+TEST_F(curve_to_mesh, Attributes)
+{
+  const Array<float3> curve_positions = {{0, 0, 0}, {1, 0, 0}, {2, 1, 0}};
+  const Array<float3> profile_positions = {{0.1f, 0, 0}, {0, 0.1f, 0}};
+  std::unique_ptr<CurveEval> curve = create_curve(spline_list(
+      create_poly_spline(curve_positions, false), create_poly_spline(curve_positions, true)));
+  std::unique_ptr<CurveEval> profile = create_curve(
+      spline_list(create_poly_spline(profile_positions, false),
+                  create_poly_spline(profile_positions, false),
+                  create_poly_spline(profile_positions, true)));
+
+  curve->attributes.create("curve_index", CD_PROP_INT32);
+  curve->attributes.create("shared", CD_PROP_INT32);
+  for (const int i : curve->splines().index_range()) {
+    curve->attributes.get_for_write("curve_index")->typed<int>()[i] = i;
+    curve->attributes.get_for_write("shared")->typed<int>()[i] = 100 + i;
+    Spline &spline = *curve->splines()[i];
+    spline.attributes.create("curve_weight", CD_PROP_FLOAT);
+    MutableSpan<float> weights = spline.attributes.get_for_write("curve_weight")->typed<float>();
+    for (const int i_point : weights.index_range()) {
+      weights[i_point] = i * 10.0f + i_point;
+    }
+  }
+  profile->attributes.create("profile_index", CD_PROP_INT32);
+  profile->attributes.create("shared", CD_PROP_INT32);
+  for (const int i : profile->splines().index_range()) {
+    profile->attributes.get_for_write("profile_index")->typed<int>()[i] = i;
+    profile->attributes.get_for_write("shared")->typed<int>()[i] = 200 + i;
+    Spline &spline = *profile->splines()[i];
+    spline.attributes.create("profile_weight", CD_PROP_FLOAT);
+    MutableSpan<float> weights = spline.attributes.get_for_write("profile_weight")->typed<float>();
+    for (const int i_point : weights.index_range()) {
+      weights[i_point] = i * 10.0f + i_point;
+    }
+  }
+
+  Mesh *mesh = curve_to_mesh_sweep(*curve, *profile, false);
+  ASSERT_NE(mesh, nullptr);
+  const int combinations_num = curve->splines().size() * profile->splines().size();
+  const int verts_per_combination = curve_positions.size() * profile_positions.size();
+  ASSERT_EQ(mesh->totvert, combinations_num * verts_per_combination);
+
+  const Span<int> curve_index = get_mesh_attribute<int>(
+      mesh->vdata, CD_PROP_INT32, "curve_index", mesh->totvert);
+  const Span<int> profile_index = get_mesh_attribute<int>(
+      mesh->vdata, CD_PROP_INT32, "profile_index", mesh->totvert);
+  const Span<int> shared = get_mesh_attribute<int>(
+      mesh->vdata, CD_PROP_INT32, "shared", mesh->totvert);
+  const Span<float> curve_weight = get_mesh_attribute<float>(
+      mesh->vdata, CD_PROP_FLOAT, "curve_weight", mesh->totvert);
+  const Span<float> profile_weight = get_mesh_attribute<float>(
+      mesh->vdata, CD_PROP_FLOAT, "profile_weight", mesh->totvert);
+  ASSERT_FALSE(curve_index.is_empty());
+  ASSERT_FALSE(profile_index.is_empty());
+  ASSERT_FALSE(shared.is_empty());
+  ASSERT_FALSE(curve_weight.is_empty());
+  ASSERT_FALSE(profile_weight.is_empty());
+
+  int vert = 0;
+  for (const int i_spline : curve->splines().index_range()) {
+    for (const int i_profile : profile->splines().index_range()) {
+      for (const int i_ring : curve_positions.index_range()) {
+        for (const int i_profile_point : profile_positions.index_range()) {
+          EXPECT_EQ(curve_index[vert], i_spline);
+          EXPECT_EQ(profile_index[vert], i_profile);
+          EXPECT_EQ(shared[vert], 100 + i_spline);
+          EXPECT_EQ(curve_weight[vert], i_spline * 10.0f + i_ring);
+          EXPECT_EQ(profile_weight[vert], i_profile * 10.0f + i_profile_point);
+          vert++;
+        }
+      }
+    }
+  }
+
+  BKE_id_free(nullptr, mesh);
+}
+
+/**
+ * Sweep a profile along many short curves, like hair.
+ */
+TEST_F(curve_to_mesh, ManyShortCurvesPerformance)
+{
+  const int curves_num = 100000;
+  const int curve_points_num = 8;
+  const int profile_points_num = 6;
+
+  Vector<SplinePtr> splines;
+  splines.reserve(curves_num);
+  Array<float3> positions(curve_points_num);
+  for (const int i : IndexRange(curves_num)) {
+    const float2 root(float(i % 317), float(i / 317));
+    for (const int i_point : positions.index_range()) {
+      positions[i_point] = float3(root.x + 0.05f * i_point * i_point, root.y, 0.2f * i_point);
+    }
+    SplinePtr spline = create_poly_spline(positions, false);
+    spline->attributes.create("weight", CD_PROP_FLOAT);
+    spline->attributes.get_for_write("weight")->typed<float>().fill(float(i));
+    splines.append(std::move(spline));
+  }
+  std::unique_ptr<CurveEval> curve = create_curve(std::move(splines));
+
+  Array<float3> profile_positions(profile_points_num);
+  for (const int i : profile_positions.index_range()) {
+    const float angle = float(i) / profile_points_num * 2.0f * float(M_PI);
+    profile_positions[i] = float3(std::cos(angle), std::sin(angle), 0.0f) * 0.01f;
+  }
+  std::unique_ptr<CurveEval> profile = create_curve(
+      spline_list(create_poly_spline(profile_positions, true)));
+
+  /* Evaluate the splines before the timer, the sweep itself is measured. */
+  for (const SplinePtr &spline : curve->splines()) {
+    spline->evaluated_normals();
+  }
+
+  Mesh *mesh;
+  {
+    SCOPED_TIMER("curve_to_mesh_sweep");
+    mesh = curve_to_mesh_sweep(*curve, *profile, true);
+  }
+  ASSERT_NE(mesh, nullptr);
+  EXPECT_EQ(mesh->totvert, curves_num * curve_points_num * profile_points_num);
+  EXPECT_EQ(mesh->totpoly, curves_num * ((curve_points_num - 1) * profile_points_num + 2));
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::bke::tests
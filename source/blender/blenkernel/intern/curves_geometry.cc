@@ -7,6 +7,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_bounds.hh"
+#include "BLI_prefix_sum.hh"
 
 #include "DNA_curves_types.h"
 
@@ -18,6 +19,17 @@ namespace blender::bke {
 static const std::string ATTR_POSITION = "position";
 static const std::string ATTR_RADIUS = "radius";
 static const std::string ATTR_CURVE_TYPE = "curve_type";
+static const std::string ATTR_CYCLIC = "cyclic";
+static const std::string ATTR_RESOLUTION = "resolution";
+static const std::string ATTR_TILT = "tilt";
+static const std::string ATTR_NORMAL_MODE = "normal_mode";
+static const std::string ATTR_HANDLE_TYPE_LEFT = "handle_type_left";
+static const std::string ATTR_HANDLE_TYPE_RIGHT = "handle_type_right";
+static const std::string ATTR_HANDLE_POSITION_LEFT = "handle_left";
+static const std::string ATTR_HANDLE_POSITION_RIGHT = "handle_right";
+static const std::string ATTR_NURBS_ORDER = "nurbs_order";
+static const std::string ATTR_NURBS_WEIGHT = "nurbs_weight";
+static const std::string ATTR_NURBS_KNOTS_MODE = "knots_mode";
 
 /* -------------------------------------------------------------------- */
 /** \name Constructors/Destructor
@@ -61,7 +73,7 @@ static void copy_curves_geometry(CurvesGeometry &dst, const CurvesGeometry &src)
   CustomData_copy(&src.curve_data, &dst.curve_data, CD_MASK_ALL, CD_DUPLICATE, dst.curve_size);
 
   MEM_SAFE_FREE(dst.curve_offsets);
-  dst.curve_offsets = (int *)MEM_calloc_arrayN(dst.point_size + 1, sizeof(int), __func__);
+  dst.curve_offsets = (int *)MEM_calloc_arrayN(dst.curve_size + 1, sizeof(int), __func__);
   dst.offsets().copy_from(src.offsets());
 
   dst.tag_topology_changed();
@@ -115,12 +127,6 @@ IndexRange CurvesGeometry::curves_range() const
   return IndexRange(this->curves_size());
 }
 
-int CurvesGeometry::evaluated_points_size() const
-{
-  /* TODO: Implement when there are evaluated points. */
-  return 0;
-}
-
 IndexRange CurvesGeometry::range_for_curve(const int index) const
 {
   const int offset = this->curve_offsets[index];
@@ -128,25 +134,110 @@ IndexRange CurvesGeometry::range_for_curve(const int index) const
   return {offset, offset_next - offset};
 }
 
-VArray<int8_t> CurvesGeometry::curve_types() const
+static int domain_size(const CurvesGeometry &curves, const AttributeDomain domain)
+{
+  return domain == ATTR_DOMAIN_POINT ? curves.points_size() : curves.curves_size();
+}
+
+static CustomData &domain_custom_data(CurvesGeometry &curves, const AttributeDomain domain)
+{
+  return domain == ATTR_DOMAIN_POINT ? curves.point_data : curves.curve_data;
+}
+
+static const CustomData &domain_custom_data(const CurvesGeometry &curves,
+                                            const AttributeDomain domain)
+{
+  return domain == ATTR_DOMAIN_POINT ? curves.point_data : curves.curve_data;
+}
+
+template<typename T>
+static VArray<T> get_varray_attribute(const CurvesGeometry &curves,
+                                      const AttributeDomain domain,
+                                      const StringRefNull name,
+                                      const T default_value)
 {
-  if (const int8_t *data = (const int8_t *)CustomData_get_layer_named(
-          &this->curve_data, CD_PROP_INT8, ATTR_CURVE_TYPE.c_str())) {
-    return VArray<int8_t>::ForSpan({data, this->curve_size});
+  const int size = domain_size(curves, domain);
+  const CustomDataType type = cpp_type_to_custom_data_type(CPPType::get<T>());
+  const CustomData &custom_data = domain_custom_data(curves, domain);
+
+  const T *data = (const T *)CustomData_get_layer_named(&custom_data, type, name.c_str());
+  if (data != nullptr) {
+    return VArray<T>::ForSpan(Span<T>(data, size));
+  }
+  return VArray<T>::ForSingle(default_value, size);
+}
+
+/** Return the attribute's data, or an empty span if the attribute doesn't exist. */
+template<typename T>
+static Span<T> get_span_attribute(const CurvesGeometry &curves,
+                                  const AttributeDomain domain,
+                                  const StringRefNull name)
+{
+  const int size = domain_size(curves, domain);
+  const CustomDataType type = cpp_type_to_custom_data_type(CPPType::get<T>());
+  const CustomData &custom_data = domain_custom_data(curves, domain);
+
+  const T *data = (const T *)CustomData_get_layer_named(&custom_data, type, name.c_str());
+  if (data == nullptr) {
+    return {};
   }
-  return VArray<int8_t>::ForSingle(CURVE_TYPE_CATMULL_ROM, this->curve_size);
+  return {data, size};
+}
+
+/** Return the attribute's data, adding it and filling it with the default value if necessary. */
+template<typename T>
+static MutableSpan<T> get_mutable_attribute(CurvesGeometry &curves,
+                                            const AttributeDomain domain,
+                                            const StringRefNull name,
+                                            const T default_value = T())
+{
+  const int size = domain_size(curves, domain);
+  const CustomDataType type = cpp_type_to_custom_data_type(CPPType::get<T>());
+  CustomData &custom_data = domain_custom_data(curves, domain);
+
+  T *data = (T *)CustomData_duplicate_referenced_layer_named(
+      &custom_data, type, name.c_str(), size);
+  if (data != nullptr) {
+    return {data, size};
+  }
+  data = (T *)CustomData_add_layer_named(
+      &custom_data, type, CD_CALLOC, nullptr, size, name.c_str());
+  MutableSpan<T> span = {data, size};
+  if (span.size() > 0 && span.first() != default_value) {
+    span.fill(default_value);
+  }
+  return span;
+}
+
+VArray<int8_t> CurvesGeometry::curve_types() const
+{
+  return get_varray_attribute<int8_t>(
+      *this, ATTR_DOMAIN_CURVE, ATTR_CURVE_TYPE, CURVE_TYPE_CATMULL_ROM);
 }
 
 MutableSpan<int8_t> CurvesGeometry::curve_types()
 {
-  int8_t *data = (int8_t *)CustomData_add_layer_named(&this->curve_data,
-                                                      CD_PROP_INT8,
-                                                      CD_CALLOC,
-                                                      nullptr,
-                                                      this->curve_size,
-                                                      ATTR_CURVE_TYPE.c_str());
-  BLI_assert(data != nullptr);
-  return {data, this->curve_size};
+  MutableSpan<int8_t> types = get_mutable_attribute<int8_t>(
+      *this, ATTR_DOMAIN_CURVE, ATTR_CURVE_TYPE);
+  this->curve_type = types.data();
+  return types;
+}
+
+bool CurvesGeometry::has_curve_with_type(const CurveType type) const
+{
+  if (this->curves_size() == 0) {
+    return false;
+  }
+  const VArray<int8_t> curve_types = this->curve_types();
+  if (curve_types.is_single()) {
+    return curve_types.get_internal_single() == type;
+  }
+  if (curve_types.is_span()) {
+    return curve_types.get_internal_span().contains(type);
+  }
+  /* The curves types array should be a span or a single value. */
+  BLI_assert_unreachable();
+  return false;
 }
 
 MutableSpan<float3> CurvesGeometry::positions()
@@ -160,6 +251,107 @@ Span<float3> CurvesGeometry::positions() const
   return {(const float3 *)this->position, this->point_size};
 }
 
+VArray<bool> CurvesGeometry::cyclic() const
+{
+  return get_varray_attribute<bool>(*this, ATTR_DOMAIN_CURVE, ATTR_CYCLIC, false);
+}
+MutableSpan<bool> CurvesGeometry::cyclic()
+{
+  return get_mutable_attribute<bool>(*this, ATTR_DOMAIN_CURVE, ATTR_CYCLIC);
+}
+
+VArray<int> CurvesGeometry::resolution() const
+{
+  return get_varray_attribute<int>(*this, ATTR_DOMAIN_CURVE, ATTR_RESOLUTION, 12);
+}
+MutableSpan<int> CurvesGeometry::resolution()
+{
+  return get_mutable_attribute<int>(*this, ATTR_DOMAIN_CURVE, ATTR_RESOLUTION, 12);
+}
+
+VArray<float> CurvesGeometry::tilt() const
+{
+  return get_varray_attribute<float>(*this, ATTR_DOMAIN_POINT, ATTR_TILT, 0.0f);
+}
+MutableSpan<float> CurvesGeometry::tilt()
+{
+  return get_mutable_attribute<float>(*this, ATTR_DOMAIN_POINT, ATTR_TILT);
+}
+
+VArray<int8_t> CurvesGeometry::normal_mode() const
+{
+  return get_varray_attribute<int8_t>(
+      *this, ATTR_DOMAIN_CURVE, ATTR_NORMAL_MODE, NORMAL_MODE_MINIMUM_TWIST);
+}
+MutableSpan<int8_t> CurvesGeometry::normal_mode()
+{
+  return get_mutable_attribute<int8_t>(*this, ATTR_DOMAIN_CURVE, ATTR_NORMAL_MODE);
+}
+
+VArray<int8_t> CurvesGeometry::handle_types_left() const
+{
+  return get_varray_attribute<int8_t>(*this, ATTR_DOMAIN_POINT, ATTR_HANDLE_TYPE_LEFT, 0);
+}
+MutableSpan<int8_t> CurvesGeometry::handle_types_left()
+{
+  return get_mutable_attribute<int8_t>(*this, ATTR_DOMAIN_POINT, ATTR_HANDLE_TYPE_LEFT);
+}
+
+VArray<int8_t> CurvesGeometry::handle_types_right() const
+{
+  return get_varray_attribute<int8_t>(*this, ATTR_DOMAIN_POINT, ATTR_HANDLE_TYPE_RIGHT, 0);
+}
+MutableSpan<int8_t> CurvesGeometry::handle_types_right()
+{
+  return get_mutable_attribute<int8_t>(*this, ATTR_DOMAIN_POINT, ATTR_HANDLE_TYPE_RIGHT);
+}
+
+Span<float3> CurvesGeometry::handle_positions_left() const
+{
+  return get_span_attribute<float3>(*this, ATTR_DOMAIN_POINT, ATTR_HANDLE_POSITION_LEFT);
+}
+MutableSpan<float3> CurvesGeometry::handle_positions_left()
+{
+  return get_mutable_attribute<float3>(*this, ATTR_DOMAIN_POINT, ATTR_HANDLE_POSITION_LEFT);
+}
+
+Span<float3> CurvesGeometry::handle_positions_right() const
+{
+  return get_span_attribute<float3>(*this, ATTR_DOMAIN_POINT, ATTR_HANDLE_POSITION_RIGHT);
+}
+MutableSpan<float3> CurvesGeometry::handle_positions_right()
+{
+  return get_mutable_attribute<float3>(*this, ATTR_DOMAIN_POINT, ATTR_HANDLE_POSITION_RIGHT);
+}
+
+VArray<int8_t> CurvesGeometry::nurbs_orders() const
+{
+  return get_varray_attribute<int8_t>(*this, ATTR_DOMAIN_CURVE, ATTR_NURBS_ORDER, 4);
+}
+MutableSpan<int8_t> CurvesGeometry::nurbs_orders()
+{
+  return get_mutable_attribute<int8_t>(*this, ATTR_DOMAIN_CURVE, ATTR_NURBS_ORDER, 4);
+}
+
+VArray<int8_t> CurvesGeometry::nurbs_knots_modes() const
+{
+  return get_varray_attribute<int8_t>(
+      *this, ATTR_DOMAIN_CURVE, ATTR_NURBS_KNOTS_MODE, NURBS_KNOT_MODE_NORMAL);
+}
+MutableSpan<int8_t> CurvesGeometry::nurbs_knots_modes()
+{
+  return get_mutable_attribute<int8_t>(*this, ATTR_DOMAIN_CURVE, ATTR_NURBS_KNOTS_MODE);
+}
+
+Span<float> CurvesGeometry::nurbs_weights() const
+{
+  return get_span_attribute<float>(*this, ATTR_DOMAIN_POINT, ATTR_NURBS_WEIGHT);
+}
+MutableSpan<float> CurvesGeometry::nurbs_weights()
+{
+  return get_mutable_attribute<float>(*this, ATTR_DOMAIN_POINT, ATTR_NURBS_WEIGHT, 1.0f);
+}
+
 MutableSpan<int> CurvesGeometry::offsets()
 {
   return {this->curve_offsets, this->curve_size + 1};
@@ -189,21 +381,55 @@ void CurvesGeometry::tag_positions_changed()
   this->runtime->position_cache_dirty = true;
   this->runtime->tangent_cache_dirty = true;
   this->runtime->normal_cache_dirty = true;
+  this->runtime->length_cache_dirty = true;
 }
 void CurvesGeometry::tag_topology_changed()
 {
+  this->runtime->offsets_cache_dirty = true;
+  this->runtime->nurbs_basis_cache_dirty = true;
   this->runtime->position_cache_dirty = true;
   this->runtime->tangent_cache_dirty = true;
   this->runtime->normal_cache_dirty = true;
+  this->runtime->length_cache_dirty = true;
 }
 void CurvesGeometry::tag_normals_changed()
 {
   this->runtime->normal_cache_dirty = true;
 }
 
-void CurvesGeometry::translate(const float3 &translation)
+void CurvesGeometry::calculate_bezier_auto_handles()
+{
+  if (!this->has_curve_with_type(CURVE_TYPE_BEZIER)) {
+    return;
+  }
+  const CurvesGeometry &curves = *this;
+  const VArray<int8_t> types = curves.curve_types();
+  const VArray<bool> cyclic = curves.cyclic();
+  const VArray_Span<int8_t> types_left{curves.handle_types_left()};
+  const VArray_Span<int8_t> types_right{curves.handle_types_right()};
+  const Span<float3> positions = curves.positions();
+  MutableSpan<float3> positions_left = this->handle_positions_left();
+  MutableSpan<float3> positions_right = this->handle_positions_right();
+
+  threading::parallel_for(this->curves_range(), 128, [&](IndexRange range) {
+    for (const int curve_index : range) {
+      if (types[curve_index] != CURVE_TYPE_BEZIER) {
+        continue;
+      }
+      const IndexRange points = this->range_for_curve(curve_index);
+      curves::bezier::calculate_auto_handles(cyclic[curve_index],
+                                             types_left.slice(points),
+                                             types_right.slice(points),
+                                             positions.slice(points),
+                                             positions_left.slice(points),
+                                             positions_right.slice(points));
+    }
+  });
+  this->tag_positions_changed();
+}
+
+static void translate_positions(MutableSpan<float3> positions, const float3 &translation)
 {
-  MutableSpan<float3> positions = this->positions();
   threading::parallel_for(positions.index_range(), 2048, [&](const IndexRange range) {
     for (float3 &position : positions.slice(range)) {
       position += translation;
@@ -211,9 +437,8 @@ void CurvesGeometry::translate(const float3 &translation)
   });
 }
 
-void CurvesGeometry::transform(const float4x4 &matrix)
+static void transform_positions(MutableSpan<float3> positions, const float4x4 &matrix)
 {
-  MutableSpan<float3> positions = this->positions();
   threading::parallel_for(positions.index_range(), 1024, [&](const IndexRange range) {
     for (float3 &position : positions.slice(range)) {
       position = matrix * position;
@@ -221,6 +446,26 @@ void CurvesGeometry::transform(const float4x4 &matrix)
   });
 }
 
+void CurvesGeometry::translate(const float3 &translation)
+{
+  translate_positions(this->positions(), translation);
+  if (this->has_curve_with_type(CURVE_TYPE_BEZIER)) {
+    translate_positions(this->handle_positions_left(), translation);
+    translate_positions(this->handle_positions_right(), translation);
+  }
+  this->tag_positions_changed();
+}
+
+void CurvesGeometry::transform(const float4x4 &matrix)
+{
+  transform_positions(this->positions(), matrix);
+  if (this->has_curve_with_type(CURVE_TYPE_BEZIER)) {
+    transform_positions(this->handle_positions_left(), matrix);
+    transform_positions(this->handle_positions_right(), matrix);
+  }
+  this->tag_positions_changed();
+}
+
 static std::optional<bounds::MinMaxResult<float3>> curves_bounds(const CurvesGeometry &curves)
 {
   Span<float3> positions = curves.positions();
@@ -249,7 +494,523 @@ void CurvesGeometry::update_customdata_pointers()
   this->radius = (float *)CustomData_get_layer_named(
       &this->point_data, CD_PROP_FLOAT, ATTR_RADIUS.c_str());
   this->curve_type = (int8_t *)CustomData_get_layer_named(
-      &this->point_data, CD_PROP_INT8, ATTR_CURVE_TYPE.c_str());
+      &this->curve_data, CD_PROP_INT8, ATTR_CURVE_TYPE.c_str());
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Evaluation
+ * \{ */
+
+static int calculate_evaluated_size(const int8_t type,
+                                    const int size,
+                                    const bool cyclic,
+                                    const int resolution,
+                                    const int8_t nurbs_order,
+                                    const KnotsMode knots_mode)
+{
+  switch (type) {
+    case CURVE_TYPE_POLY:
+      return size;
+    case CURVE_TYPE_CATMULL_ROM:
+      return curves::catmull_rom::calculate_evaluated_size(size, cyclic, resolution);
+    case CURVE_TYPE_NURBS:
+      return curves::nurbs::calculate_evaluated_size(
+          size, nurbs_order, cyclic, resolution, knots_mode);
+  }
+  BLI_assert_unreachable();
+  return 0;
+}
+
+/**
+ * Calculate the number of evaluated points of every curve in parallel and accumulate them into
+ * offsets. The evaluated offsets of the segments of Bezier curves are calculated at the same
+ * time, since they determine the number of evaluated points of the curve anyway.
+ */
+static void calculate_evaluated_offsets(const CurvesGeometry &curves,
+                                        const Span<int8_t> handle_types_left,
+                                        const Span<int8_t> handle_types_right,
+                                        MutableSpan<int> offsets,
+                                        MutableSpan<int> bezier_evaluated_offsets)
+{
+  const VArray<int8_t> types = curves.curve_types();
+  const VArray<bool> cyclic = curves.cyclic();
+  const VArray<int> resolution = curves.resolution();
+  const VArray<int8_t> nurbs_orders = curves.nurbs_orders();
+  const VArray<int8_t> nurbs_knots_modes = curves.nurbs_knots_modes();
+
+  threading::parallel_for(curves.curves_range(), 1024, [&](IndexRange range) {
+    for (const int curve_index : range) {
+      const IndexRange points = curves.range_for_curve(curve_index);
+      if (points.size() == 0) {
+        offsets[curve_index] = 0;
+        continue;
+      }
+      if (types[curve_index] == CURVE_TYPE_BEZIER) {
+        MutableSpan<int> segment_offsets = bezier_evaluated_offsets.slice(
+            points.start() + curve_index, points.size() + 1);
+        curves::bezier::calculate_evaluated_offsets(handle_types_left.slice(points),
+                                                    handle_types_right.slice(points),
+                                                    cyclic[curve_index],
+                                                    resolution[curve_index],
+                                                    segment_offsets);
+        offsets[curve_index] = segment_offsets.last();
+        continue;
+      }
+      offsets[curve_index] = calculate_evaluated_size(
+          types[curve_index],
+          points.size(),
+          cyclic[curve_index],
+          resolution[curve_index],
+          nurbs_orders[curve_index],
+          KnotsMode(nurbs_knots_modes[curve_index]));
+    }
+  });
+
+  offsets.last() = 0;
+  parallel_prefix_sum(offsets.as_span(), offsets, false);
+}
+
+void CurvesGeometry::ensure_evaluated_offsets() const
+{
+  if (!this->runtime->offsets_cache_dirty) {
+    return;
+  }
+
+  /* A double checked lock. */
+  std::scoped_lock lock{this->runtime->offsets_cache_mutex};
+  if (!this->runtime->offsets_cache_dirty) {
+    return;
+  }
+
+  threading::isolate_task([&]() {
+    this->runtime->evaluated_offsets_cache.resize(this->curves_size() + 1);
+    MutableSpan<int> offsets = this->runtime->evaluated_offsets_cache;
+
+    if (this->has_curve_with_type(CURVE_TYPE_BEZIER)) {
+      this->runtime->bezier_evaluated_offsets.resize(this->points_size() + this->curves_size());
+      const VArray_Span<int8_t> handle_types_left{this->handle_types_left()};
+      const VArray_Span<int8_t> handle_types_right{this->handle_types_right()};
+      calculate_evaluated_offsets(*this,
+                                  handle_types_left,
+                                  handle_types_right,
+                                  offsets,
+                                  this->runtime->bezier_evaluated_offsets);
+    }
+    else {
+      this->runtime->bezier_evaluated_offsets.clear_and_make_inline();
+      calculate_evaluated_offsets(*this, {}, {}, offsets, {});
+    }
+  });
+
+  this->runtime->offsets_cache_dirty = false;
+}
+
+Span<int> CurvesGeometry::evaluated_offsets() const
+{
+  this->ensure_evaluated_offsets();
+  return this->runtime->evaluated_offsets_cache;
+}
+
+int CurvesGeometry::evaluated_points_size() const
+{
+  return this->evaluated_offsets().last();
+}
+
+IndexRange CurvesGeometry::evaluated_range_for_curve(const int index) const
+{
+  BLI_assert(!this->runtime->offsets_cache_dirty);
+  const int offset = this->runtime->evaluated_offsets_cache[index];
+  const int offset_next = this->runtime->evaluated_offsets_cache[index + 1];
+  return {offset, offset_next - offset};
+}
+
+void CurvesGeometry::ensure_nurbs_basis_cache() const
+{
+  if (!this->runtime->nurbs_basis_cache_dirty) {
+    return;
+  }
+
+  /* A double checked lock. */
+  std::scoped_lock lock{this->runtime->nurbs_basis_cache_mutex};
+  if (!this->runtime->nurbs_basis_cache_dirty) {
+    return;
+  }
+
+  threading::isolate_task([&]() {
+    if (!this->has_curve_with_type(CURVE_TYPE_NURBS)) {
+      this->runtime->nurbs_basis_cache.clear_and_make_inline();
+      return;
+    }
+
+    this->ensure_evaluated_offsets();
+    this->runtime->nurbs_basis_cache.resize(this->curves_size());
+    MutableSpan<curves::nurbs::BasisCache> basis_caches(this->runtime->nurbs_basis_cache);
+
+    const VArray<int8_t> types = this->curve_types();
+    const VArray<bool> cyclic = this->cyclic();
+    const VArray<int8_t> orders = this->nurbs_orders();
+    const VArray<int8_t> knots_modes = this->nurbs_knots_modes();
+
+    threading::parallel_for(this->curves_range(), 128, [&](IndexRange range) {
+      /* Reuse the knots buffer for all curves in the range. */
+      Vector<float, 32> knots;
+      for (const int curve_index : range) {
+        curves::nurbs::BasisCache &basis_cache = basis_caches[curve_index];
+        const IndexRange evaluated_points = this->evaluated_range_for_curve(curve_index);
+        if (types[curve_index] != CURVE_TYPE_NURBS || evaluated_points.size() == 0) {
+          basis_cache.weights.clear();
+          basis_cache.start_indices.clear();
+          continue;
+        }
+
+        const IndexRange points = this->range_for_curve(curve_index);
+        const int8_t order = orders[curve_index];
+        const bool is_cyclic = cyclic[curve_index];
+        const KnotsMode mode = KnotsMode(knots_modes[curve_index]);
+
+        knots.resize(curves::nurbs::knots_size(points.size(), order, is_cyclic));
+        curves::nurbs::calculate_knots(points.size(), mode, order, is_cyclic, knots);
+        curves::nurbs::calculate_basis_cache(
+            points.size(), evaluated_points.size(), order, is_cyclic, knots, basis_cache);
+      }
+    });
+  });
+
+  this->runtime->nurbs_basis_cache_dirty = false;
+}
+
+Span<float3> CurvesGeometry::evaluated_positions() const
+{
+  if (!this->runtime->position_cache_dirty) {
+    return this->runtime->evaluated_position_cache;
+  }
+
+  /* A double checked lock. */
+  std::scoped_lock lock{this->runtime->position_cache_mutex};
+  if (!this->runtime->position_cache_dirty) {
+    return this->runtime->evaluated_position_cache;
+  }
+
+  threading::isolate_task([&]() {
+    this->ensure_evaluated_offsets();
+    this->ensure_nurbs_basis_cache();
+
+    this->runtime->evaluated_position_cache.resize(this->evaluated_points_size());
+    MutableSpan<float3> evaluated_positions = this->runtime->evaluated_position_cache;
+
+    const VArray<int8_t> types = this->curve_types();
+    const VArray<bool> cyclic = this->cyclic();
+    const VArray<int> resolution = this->resolution();
+    const VArray<int8_t> nurbs_orders = this->nurbs_orders();
+    const Span<float3> positions = this->positions();
+    /* Use straight segments for Bezier curves without handles rather than failing. */
+    const Span<float3> handles_left = this->handle_positions_left().is_empty() ?
+                                          positions :
+                                          this->handle_positions_left();
+    const Span<float3> handles_right = this->handle_positions_right().is_empty() ?
+                                           positions :
+                                           this->handle_positions_right();
+    const Span<float> nurbs_weights = this->nurbs_weights();
+    const Span<int> bezier_evaluated_offsets = this->runtime->bezier_evaluated_offsets;
+    const Span<curves::nurbs::BasisCache> nurbs_basis_caches = this->runtime->nurbs_basis_cache;
+
+    threading::parallel_for(this->curves_range(), 128, [&](IndexRange range) {
+      for (const int curve_index : range) {
+        const IndexRange points = this->range_for_curve(curve_index);
+        const IndexRange evaluated_points = this->evaluated_range_for_curve(curve_index);
+        if (evaluated_points.size() == 0) {
+          continue;
+        }
+        MutableSpan<float3> dst = evaluated_positions.slice(evaluated_points);
+        switch (types[curve_index]) {
+          case CURVE_TYPE_CATMULL_ROM:
+            curves::catmull_rom::interpolate_to_evaluated(
+                positions.slice(points), cyclic[curve_index], resolution[curve_index], dst);
+            break;
+          case CURVE_TYPE_POLY:
+            dst.copy_from(positions.slice(points));
+            break;
+          case CURVE_TYPE_BEZIER:
+            curves::bezier::calculate_evaluated_positions(
+                positions.slice(points),
+                handles_left.slice(points),
+                handles_right.slice(points),
+                bezier_evaluated_offsets.slice(points.start() + curve_index, points.size() + 1),
+                dst);
+            break;
+          case CURVE_TYPE_NURBS:
+            curves::nurbs::interpolate_to_evaluated(
+                nurbs_basis_caches[curve_index],
+                nurbs_orders[curve_index],
+                nurbs_weights.is_empty() ? Span<float>() : nurbs_weights.slice(points),
+                positions.slice(points),
+                dst);
+            break;
+        }
+      }
+    });
+  });
+
+  this->runtime->position_cache_dirty = false;
+  return this->runtime->evaluated_position_cache;
+}
+
+Span<float3> CurvesGeometry::evaluated_tangents() const
+{
+  if (!this->runtime->tangent_cache_dirty) {
+    return this->runtime->evaluated_tangents_cache;
+  }
+
+  /* A double checked lock. */
+  std::scoped_lock lock{this->runtime->tangent_cache_mutex};
+  if (!this->runtime->tangent_cache_dirty) {
+    return this->runtime->evaluated_tangents_cache;
+  }
+
+  threading::isolate_task([&]() {
+    const Span<float3> evaluated_positions = this->evaluated_positions();
+    const VArray<bool> cyclic = this->cyclic();
+
+    this->runtime->evaluated_tangents_cache.resize(this->evaluated_points_size());
+    MutableSpan<float3> tangents = this->runtime->evaluated_tangents_cache;
+
+    threading::parallel_for(this->curves_range(), 128, [&](IndexRange range) {
+      for (const int curve_index : range) {
+        const IndexRange evaluated_points = this->evaluated_range_for_curve(curve_index);
+        if (evaluated_points.size() == 0) {
+          continue;
+        }
+        curves::poly::calculate_tangents(evaluated_positions.slice(evaluated_points),
+                                         cyclic[curve_index],
+                                         tangents.slice(evaluated_points));
+      }
+    });
+
+    /* Correct the first and last tangents of non-cyclic Bezier curves so that they align with the
+     * inner handles. This is a separate loop to avoid the cost when Bezier type curves are not
+     * used. */
+    const Span<float3> handles_left = this->handle_positions_left();
+    const Span<float3> handles_right = this->handle_positions_right();
+    if (handles_left.is_empty() || handles_right.is_empty() ||
+        !this->has_curve_with_type(CURVE_TYPE_BEZIER)) {
+      return;
+    }
+    const VArray<int8_t> types = this->curve_types();
+    const Span<float3> positions = this->positions();
+    threading::parallel_for(this->curves_range(), 1024, [&](IndexRange range) {
+      for (const int curve_index : range) {
+        if (types[curve_index] != CURVE_TYPE_BEZIER || cyclic[curve_index]) {
+          continue;
+        }
+        const IndexRange points = this->range_for_curve(curve_index);
+        const IndexRange evaluated_points = this->evaluated_range_for_curve(curve_index);
+        if (points.size() == 0) {
+          continue;
+        }
+        const int first = points.first();
+        const int last = points.last();
+        if (handles_right[first] != positions[first]) {
+          tangents[evaluated_points.first()] = math::normalize(handles_right[first] -
+                                                               positions[first]);
+        }
+        if (handles_left[last] != positions[last]) {
+          tangents[evaluated_points.last()] = math::normalize(positions[last] -
+                                                              handles_left[last]);
+        }
+      }
+    });
+  });
+
+  this->runtime->tangent_cache_dirty = false;
+  return this->runtime->evaluated_tangents_cache;
+}
+
+Span<float3> CurvesGeometry::evaluated_normals() const
+{
+  if (!this->runtime->normal_cache_dirty) {
+    return this->runtime->evaluated_normals_cache;
+  }
+
+  /* A double checked lock. */
+  std::scoped_lock lock{this->runtime->normal_cache_mutex};
+  if (!this->runtime->normal_cache_dirty) {
+    return this->runtime->evaluated_normals_cache;
+  }
+
+  threading::isolate_task([&]() {
+    const Span<float3> evaluated_tangents = this->evaluated_tangents();
+    this->ensure_nurbs_basis_cache();
+
+    const VArray<int8_t> types = this->curve_types();
+    const VArray<bool> cyclic = this->cyclic();
+    const VArray<int8_t> normal_mode = this->normal_mode();
+    const Span<float> tilts = get_span_attribute<float>(*this, ATTR_DOMAIN_POINT, ATTR_TILT);
+
+    this->runtime->evaluated_normals_cache.resize(this->evaluated_points_size());
+    MutableSpan<float3> evaluated_normals = this->runtime->evaluated_normals_cache;
+
+    threading::parallel_for(this->curves_range(), 128, [&](IndexRange range) {
+      /* Reuse a buffer for the evaluated tilts. */
+      Vector<float> evaluated_tilts;
+
+      for (const int curve_index : range) {
+        const IndexRange evaluated_points = this->evaluated_range_for_curve(curve_index);
+        if (evaluated_points.size() == 0) {
+          continue;
+        }
+        const Span<float3> tangents = evaluated_tangents.slice(evaluated_points);
+        MutableSpan<float3> normals = evaluated_normals.slice(evaluated_points);
+        switch (normal_mode[curve_index]) {
+          case NORMAL_MODE_Z_UP:
+            curves::poly::calculate_normals_z_up(tangents, normals);
+            break;
+          case NORMAL_MODE_MINIMUM_TWIST:
+            curves::poly::calculate_normals_minimum(tangents, cyclic[curve_index], normals);
+            break;
+        }
+
+        /* Without a "tilt" attribute, all of the tilt values are zero. The tilts don't have to be
+         * evaluated for poly curves, which have the same number of evaluated points. */
+        if (tilts.is_empty()) {
+          continue;
+        }
+        const Span<float> curve_tilts = tilts.slice(this->range_for_curve(curve_index));
+        if (types[curve_index] == CURVE_TYPE_POLY) {
+          curves::poly::rotate_normals_by_tilt(tangents, curve_tilts, normals);
+        }
+        else {
+          evaluated_tilts.clear();
+          evaluated_tilts.resize(evaluated_points.size());
+          this->interpolate_to_evaluated(
+              curve_index, curve_tilts, evaluated_tilts.as_mutable_span());
+          curves::poly::rotate_normals_by_tilt(tangents, evaluated_tilts, normals);
+        }
+      }
+    });
+  });
+
+  this->runtime->normal_cache_dirty = false;
+  return this->runtime->evaluated_normals_cache;
+}
+
+void CurvesGeometry::interpolate_to_evaluated(const int curve_index,
+                                              const fn::GSpan src,
+                                              fn::GMutableSpan dst) const
+{
+  BLI_assert(!this->runtime->offsets_cache_dirty);
+  BLI_assert(!this->runtime->nurbs_basis_cache_dirty);
+  const IndexRange points = this->range_for_curve(curve_index);
+  BLI_assert(src.size() == points.size());
+  BLI_assert(dst.size() == this->evaluated_range_for_curve(curve_index).size());
+  if (dst.size() == 0) {
+    return;
+  }
+  switch (this->curve_types()[curve_index]) {
+    case CURVE_TYPE_CATMULL_ROM:
+      curves::catmull_rom::interpolate_to_evaluated(
+          src, this->cyclic()[curve_index], this->resolution()[curve_index], dst);
+      return;
+    case CURVE_TYPE_POLY:
+      dst.type().copy_assign_n(src.data(), dst.data(), src.size());
+      return;
+    case CURVE_TYPE_BEZIER: {
+      const Span<int> offsets = this->runtime->bezier_evaluated_offsets.as_span().slice(
+          points.start() + curve_index, points.size() + 1);
+      curves::bezier::interpolate_to_evaluated(src, offsets, dst);
+      return;
+    }
+    case CURVE_TYPE_NURBS: {
+      const Span<float> nurbs_weights = this->nurbs_weights();
+      curves::nurbs::interpolate_to_evaluated(
+          this->runtime->nurbs_basis_cache[curve_index],
+          this->nurbs_orders()[curve_index],
+          nurbs_weights.is_empty() ? Span<float>() : nurbs_weights.slice(points),
+          src,
+          dst);
+      return;
+    }
+  }
+  BLI_assert_unreachable();
+}
+
+static void accumulate_lengths(const Span<float3> positions,
+                               const bool is_cyclic,
+                               MutableSpan<float> lengths)
+{
+  float length = 0.0f;
+  for (const int i : IndexRange(positions.size() - 1)) {
+    length += math::distance(positions[i], positions[i + 1]);
+    lengths[i] = length;
+  }
+  if (is_cyclic) {
+    lengths.last() = length + math::distance(positions.last(), positions.first());
+  }
+}
+
+IndexRange CurvesGeometry::lengths_range_for_curve(const int curve_index, const bool cyclic) const
+{
+  BLI_assert(cyclic == this->cyclic()[curve_index]);
+  const IndexRange points = this->evaluated_range_for_curve(curve_index);
+  /* Two points are required for an edge. */
+  const int size = points.size() < 2 ? 0 : curves::curve_segment_size(points.size(), cyclic);
+  return {points.start() + curve_index, size};
+}
+
+void CurvesGeometry::ensure_evaluated_lengths() const
+{
+  if (!this->runtime->length_cache_dirty) {
+    return;
+  }
+
+  /* A double checked lock. */
+  std::scoped_lock lock{this->runtime->length_cache_mutex};
+  if (!this->runtime->length_cache_dirty) {
+    return;
+  }
+
+  threading::isolate_task([&]() {
+    const Span<float3> evaluated_positions = this->evaluated_positions();
+    const VArray<bool> cyclic = this->cyclic();
+
+    /* Use an extra length value for the final cyclic segment for a consistent size
+     * (see comment on #evaluated_length_cache). */
+    const int total_size = this->evaluated_points_size() + this->curves_size();
+    this->runtime->evaluated_length_cache.resize(total_size);
+    MutableSpan<float> evaluated_lengths = this->runtime->evaluated_length_cache;
+
+    threading::parallel_for(this->curves_range(), 128, [&](IndexRange range) {
+      for (const int curve_index : range) {
+        const bool is_cyclic = cyclic[curve_index];
+        const IndexRange lengths_range = this->lengths_range_for_curve(curve_index, is_cyclic);
+        if (lengths_range.size() == 0) {
+          continue;
+        }
+        const IndexRange evaluated_points = this->evaluated_range_for_curve(curve_index);
+        accumulate_lengths(evaluated_positions.slice(evaluated_points),
+                           is_cyclic,
+                           evaluated_lengths.slice(lengths_range));
+      }
+    });
+  });
+
+  this->runtime->length_cache_dirty = false;
+}
+
+Span<float> CurvesGeometry::evaluated_lengths_for_curve(const int curve_index,
+                                                        const bool cyclic) const
+{
+  BLI_assert(!this->runtime->length_cache_dirty);
+  const IndexRange range = this->lengths_range_for_curve(curve_index, cyclic);
+  return this->runtime->evaluated_length_cache.as_span().slice(range);
+}
+
+float CurvesGeometry::evaluated_length_total_for_curve(const int curve_index,
+                                                       const bool cyclic) const
+{
+  const Span<float> lengths = this->evaluated_lengths_for_curve(curve_index, cyclic);
+  return lengths.is_empty() ? 0.0f : lengths.last();
 }
 
 /** \} */
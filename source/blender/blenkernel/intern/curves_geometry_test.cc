@@ -0,0 +1,313 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BKE_curves.hh"
+
+namespace blender::bke::tests {
+
+static void expect_float3_near(const float3 &a, const float3 &b, const float epsilon = 1e-5f)
+{
+  EXPECT_NEAR(a.x, b.x, epsilon);
+  EXPECT_NEAR(a.y, b.y, epsilon);
+  EXPECT_NEAR(a.z, b.z, epsilon);
+}
+
+TEST(curves_geometry, CatmullRomEvaluatedSize)
+{
+  EXPECT_EQ(curves::catmull_rom::calculate_evaluated_size(1, false, 12), 1);
+  EXPECT_EQ(curves::catmull_rom::calculate_evaluated_size(1, true, 12), 1);
+  EXPECT_EQ(curves::catmull_rom::calculate_evaluated_size(2, false, 12), 13);
+  EXPECT_EQ(curves::catmull_rom::calculate_evaluated_size(2, true, 12), 24);
+  EXPECT_EQ(curves::catmull_rom::calculate_evaluated_size(5, false, 4), 17);
+  EXPECT_EQ(curves::catmull_rom::calculate_evaluated_size(5, true, 4), 20);
+}
+
+TEST(curves_geometry, CatmullRomPassesThroughControlPoints)
+{
+  const Array<float3> positions = {
+      {0.0f, 0.0f, 0.0f}, {1.0f, 2.0f, 0.0f}, {3.0f, 1.0f, 1.0f}, {4.0f, -1.0f, 0.0f}};
+  const int resolution = 5;
+  for (const bool cyclic : {false, true}) {
+    const int evaluated_size = curves::catmull_rom::calculate_evaluated_size(
+        positions.size(), cyclic, resolution);
+    Array<float3> evaluated(evaluated_size);
+    curves::catmull_rom::interpolate_to_evaluated(
+        positions.as_span(), cyclic, resolution, evaluated.as_mutable_span());
+    for (const int i : positions.index_range()) {
+      expect_float3_near(evaluated[i * resolution], positions[i]);
+    }
+    if (!cyclic) {
+      expect_float3_near(evaluated.last(), positions.last());
+    }
+  }
+}
+
+TEST(curves_geometry, CatmullRomStraightLine)
+{
+  /* Evenly spaced points on a line evaluate to evenly spaced points on the line. */
+  const Array<float> values = {0.0f, 1.0f, 2.0f, 3.0f};
+  Array<float> evaluated(curves::catmull_rom::calculate_evaluated_size(4, false, 4));
+  curves::catmull_rom::interpolate_to_evaluated(
+      values.as_span(), false, 4, evaluated.as_mutable_span());
+  for (const int i : IndexRange(4, 4)) {
+    EXPECT_NEAR(evaluated[i], i * 0.25f, 1e-5f);
+  }
+}
+
+TEST(curves_geometry, BezierEvaluatedOffsets)
+{
+  const Array<int8_t> free = {
+      BEZIER_HANDLE_FREE, BEZIER_HANDLE_FREE, BEZIER_HANDLE_FREE, BEZIER_HANDLE_FREE};
+  const Array<int8_t> vector = {
+      BEZIER_HANDLE_VECTOR, BEZIER_HANDLE_VECTOR, BEZIER_HANDLE_VECTOR, BEZIER_HANDLE_VECTOR};
+  Array<int> offsets(5);
+
+  curves::bezier::calculate_evaluated_offsets(free, free, false, 3, offsets);
+  EXPECT_EQ(offsets.as_span(), Span<int>({0, 3, 6, 9, 10}));
+  curves::bezier::calculate_evaluated_offsets(free, free, true, 3, offsets);
+  EXPECT_EQ(offsets.as_span(), Span<int>({0, 3, 6, 9, 12}));
+  curves::bezier::calculate_evaluated_offsets(vector, vector, false, 3, offsets);
+  EXPECT_EQ(offsets.as_span(), Span<int>({0, 1, 2, 3, 4}));
+  curves::bezier::calculate_evaluated_offsets(vector, vector, true, 3, offsets);
+  EXPECT_EQ(offsets.as_span(), Span<int>({0, 1, 2, 3, 4}));
+
+  /* Only the segment between the second and third point is a vector segment. */
+  const Array<int8_t> left = {
+      BEZIER_HANDLE_FREE, BEZIER_HANDLE_FREE, BEZIER_HANDLE_VECTOR, BEZIER_HANDLE_FREE};
+  const Array<int8_t> right = {
+      BEZIER_HANDLE_FREE, BEZIER_HANDLE_VECTOR, BEZIER_HANDLE_FREE, BEZIER_HANDLE_FREE};
+  curves::bezier::calculate_evaluated_offsets(left, right, false, 3, offsets);
+  EXPECT_EQ(offsets.as_span(), Span<int>({0, 3, 4, 7, 8}));
+}
+
+TEST(curves_geometry, BezierEvaluatedPositions)
+{
+  const Array<float3> positions = {{0.0f, 0.0f, 0.0f}, {3.0f, 0.0f, 0.0f}, {3.0f, 3.0f, 0.0f}};
+  const Array<float3> handles_left = {
+      {-1.0f, 0.0f, 0.0f}, {2.0f, 0.0f, 0.0f}, {3.0f, 2.0f, 0.0f}};
+  const Array<float3> handles_right = {
+      {1.0f, 0.0f, 0.0f}, {4.0f, 0.0f, 0.0f}, {3.0f, 4.0f, 0.0f}};
+  const Array<int8_t> types(3, BEZIER_HANDLE_FREE);
+
+  Array<int> offsets(4);
+  curves::bezier::calculate_evaluated_offsets(types, types, false, 4, offsets);
+  Array<float3> evaluated(offsets.last());
+  curves::bezier::calculate_evaluated_positions(
+      positions, handles_left, handles_right, offsets, evaluated);
+
+  /* The first segment is a straight line with evenly spaced handles. */
+  for (const int i : IndexRange(4)) {
+    expect_float3_near(evaluated[i], float3(i * 0.75f, 0.0f, 0.0f));
+  }
+  expect_float3_near(evaluated[4], positions[1]);
+  expect_float3_near(evaluated.last(), positions.last());
+
+  Array<float> values(3);
+  values[0] = 0.0f;
+  values[1] = 4.0f;
+  values[2] = 8.0f;
+  Array<float> evaluated_values(offsets.last());
+  curves::bezier::interpolate_to_evaluated(
+      values.as_span(), offsets.as_span(), evaluated_values.as_mutable_span());
+  for (const int i : evaluated_values.index_range()) {
+    EXPECT_FLOAT_EQ(evaluated_values[i], float(i));
+  }
+}
+
+TEST(curves_geometry, BezierAutoHandles)
+{
+  const Array<float3> positions = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {2.0f, 0.0f, 0.0f}};
+  const Array<int8_t> types(3, BEZIER_HANDLE_AUTO);
+  Array<float3> handles_left(3, float3(0.0f));
+  Array<float3> handles_right(3, float3(0.0f));
+  curves::bezier::calculate_auto_handles(
+      false, types, types, positions, handles_left, handles_right);
+  /* Handles of points on a line are on the line, on either side of the point. */
+  for (const int i : positions.index_range()) {
+    EXPECT_LT(handles_left[i].x, positions[i].x);
+    EXPECT_GT(handles_right[i].x, positions[i].x);
+    EXPECT_FLOAT_EQ(handles_left[i].y, 0.0f);
+    EXPECT_FLOAT_EQ(handles_right[i].y, 0.0f);
+  }
+}
+
+TEST(curves_geometry, NURBSValidSize)
+{
+  EXPECT_FALSE(curves::nurbs::check_valid_size_and_order(3, 4, false, NURBS_KNOT_MODE_NORMAL));
+  EXPECT_TRUE(curves::nurbs::check_valid_size_and_order(4, 4, false, NURBS_KNOT_MODE_NORMAL));
+  EXPECT_FALSE(curves::nurbs::check_valid_size_and_order(4, 4, false, NURBS_KNOT_MODE_BEZIER));
+  EXPECT_TRUE(curves::nurbs::check_valid_size_and_order(4, 4, true, NURBS_KNOT_MODE_BEZIER));
+  EXPECT_EQ(curves::nurbs::calculate_evaluated_size(3, 4, false, 12, NURBS_KNOT_MODE_NORMAL), 0);
+  EXPECT_EQ(curves::nurbs::calculate_evaluated_size(5, 4, false, 12, NURBS_KNOT_MODE_NORMAL), 48);
+  EXPECT_EQ(curves::nurbs::calculate_evaluated_size(5, 4, true, 12, NURBS_KNOT_MODE_NORMAL), 60);
+}
+
+TEST(curves_geometry, NURBSEndPoint)
+{
+  const Array<float3> positions = {
+      {0.0f, 0.0f, 0.0f}, {1.0f, 2.0f, 0.0f}, {3.0f, 1.0f, 0.0f}, {4.0f, 0.0f, 1.0f}};
+  const int8_t order = 3;
+  const int resolution = 4;
+  const int evaluated_size = curves::nurbs::calculate_evaluated_size(
+      positions.size(), order, false, resolution, NURBS_KNOT_MODE_ENDPOINT);
+
+  Array<float> knots(curves::nurbs::knots_size(positions.size(), order, false));
+  curves::nurbs::calculate_knots(positions.size(), NURBS_KNOT_MODE_ENDPOINT, order, false, knots);
+  EXPECT_EQ(knots.as_span(), Span<float>({0.0f, 0.0f, 0.0f, 1.0f, 2.0f, 2.0f, 2.0f}));
+
+  curves::nurbs::BasisCache basis_cache;
+  curves::nurbs::calculate_basis_cache(
+      positions.size(), evaluated_size, order, false, knots, basis_cache);
+  EXPECT_EQ(basis_cache.weights.size(), evaluated_size * order);
+
+  /* The weights of every evaluated point add up to one. */
+  for (const int i : IndexRange(evaluated_size)) {
+    float sum = 0.0f;
+    for (const int j : IndexRange(order)) {
+      sum += basis_cache.weights[i * order + j];
+    }
+    EXPECT_NEAR(sum, 1.0f, 1e-5f);
+  }
+
+  /* Curves with end point knots start and end at the first and last control points. */
+  Array<float3> evaluated(evaluated_size);
+  curves::nurbs::interpolate_to_evaluated(
+      basis_cache, order, {}, positions.as_span(), evaluated.as_mutable_span());
+  expect_float3_near(evaluated.first(), positions.first());
+  expect_float3_near(evaluated.last(), positions.last());
+
+  /* Uniform weights don't change the result. */
+  const Array<float> weights(positions.size(), 2.0f);
+  Array<float3> evaluated_weighted(evaluated_size);
+  curves::nurbs::interpolate_to_evaluated(
+      basis_cache, order, weights, positions.as_span(), evaluated_weighted.as_mutable_span());
+  for (const int i : evaluated.index_range()) {
+    expect_float3_near(evaluated[i], evaluated_weighted[i]);
+  }
+}
+
+TEST(curves_geometry, PolyTangentsAndNormals)
+{
+  const Array<float3> positions = {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {2.0f, 0.0f, 0.0f}};
+  Array<float3> tangents(3);
+  curves::poly::calculate_tangents(positions, false, tangents);
+  for (const float3 &tangent : tangents) {
+    expect_float3_near(tangent, float3(1.0f, 0.0f, 0.0f));
+  }
+
+  Array<float3> normals_z_up(3);
+  curves::poly::calculate_normals_z_up(tangents, normals_z_up);
+  Array<float3> normals_minimum(3);
+  curves::poly::calculate_normals_minimum(tangents, false, normals_minimum);
+  for (const int i : IndexRange(3)) {
+    expect_float3_near(normals_z_up[i], float3(0.0f, -1.0f, 0.0f));
+    expect_float3_near(normals_minimum[i], float3(0.0f, -1.0f, 0.0f));
+  }
+
+  const Array<float> tilts(3, float(M_PI_2));
+  curves::poly::rotate_normals_by_tilt(tangents, tilts, normals_z_up);
+  for (const float3 &normal : normals_z_up) {
+    expect_float3_near(normal, float3(0.0f, 0.0f, -1.0f));
+  }
+}
+
+TEST(curves_geometry, PolyNormalsMinimumCyclic)
+{
+  /* The normals of a planar cyclic curve stay perpendicular to the plane's normal direction. */
+  Array<float3> positions(16);
+  for (const int i : positions.index_range()) {
+    const float angle = float(i) / positions.size() * float(M_PI) * 2.0f;
+    positions[i] = float3(std::cos(angle), std::sin(angle), 0.0f);
+  }
+  Array<float3> tangents(positions.size());
+  curves::poly::calculate_tangents(positions, true, tangents);
+  Array<float3> normals(positions.size());
+  curves::poly::calculate_normals_minimum(tangents, true, normals);
+  for (const int i : positions.index_range()) {
+    EXPECT_NEAR(math::dot(normals[i], tangents[i]), 0.0f, 1e-5f);
+    EXPECT_NEAR(std::abs(normals[i].z), 0.0f, 1e-5f);
+  }
+}
+
+static CurvesGeometry create_basic_curves(const int points_size, const int curves_size)
+{
+  CurvesGeometry curves(points_size, curves_size);
+
+  const int curve_length = points_size / curves_size;
+  for (const int i : curves.curves_range()) {
+    curves.offsets()[i] = curve_length * i;
+  }
+  curves.offsets().last() = points_size;
+
+  for (const int i : curves.points_range()) {
+    curves.positions()[i] = {float(i), float(i % curve_length), 0.0f};
+  }
+
+  return curves;
+}
+
+TEST(curves_geometry, Empty)
+{
+  CurvesGeometry empty(0, 0);
+  EXPECT_EQ(empty.evaluated_points_size(), 0);
+  EXPECT_TRUE(empty.evaluated_positions().is_empty());
+  EXPECT_TRUE(empty.evaluated_normals().is_empty());
+}
+
+TEST(curves_geometry, PolyEvaluation)
+{
+  CurvesGeometry curves = create_basic_curves(12, 3);
+  curves.curve_types().fill(CURVE_TYPE_POLY);
+  curves.tag_topology_changed();
+
+  EXPECT_EQ(curves.evaluated_points_size(), 12);
+  EXPECT_EQ(curves.evaluated_positions(), curves.positions().as_span());
+  EXPECT_EQ(curves.evaluated_range_for_curve(1), IndexRange(4, 4));
+
+  curves.ensure_evaluated_lengths();
+  const Span<float> lengths = curves.evaluated_lengths_for_curve(0, false);
+  EXPECT_EQ(lengths.size(), 3);
+  EXPECT_NEAR(lengths.last(), 3.0f * float(M_SQRT2), 1e-5f);
+
+  curves.cyclic().fill(true);
+  curves.tag_topology_changed();
+  curves.ensure_evaluated_lengths();
+  EXPECT_EQ(curves.evaluated_lengths_for_curve(2, true).size(), 4);
+}
+
+TEST(curves_geometry, MixedTypeEvaluation)
+{
+  CurvesGeometry curves = create_basic_curves(12, 3);
+  const Array<int8_t> types = {CURVE_TYPE_POLY, CURVE_TYPE_CATMULL_ROM, CURVE_TYPE_NURBS};
+  curves.curve_types().copy_from(types);
+  curves.resolution().fill(4);
+  curves.nurbs_orders().fill(3);
+  curves.tag_topology_changed();
+
+  EXPECT_EQ(curves.evaluated_offsets(), Span<int>({0, 4, 17, 29}));
+  const Span<float3> evaluated_positions = curves.evaluated_positions();
+  const Span<float3> positions = curves.positions().as_span();
+  EXPECT_EQ(evaluated_positions.slice(0, 4), positions.slice(0, 4));
+  for (const int i : IndexRange(4)) {
+    expect_float3_near(evaluated_positions[4 + i * 4], positions[4 + i]);
+  }
+
+  /* Evaluating a curve attribute uses the same method as the positions. */
+  Array<float3> evaluated(curves.evaluated_range_for_curve(2).size());
+  curves.interpolate_to_evaluated(
+      2, positions.slice(curves.range_for_curve(2)), evaluated.as_mutable_span());
+  for (const int i : evaluated.index_range()) {
+    expect_float3_near(evaluated[i], evaluated_positions[17 + i]);
+  }
+
+  const Span<float3> tangents = curves.evaluated_tangents();
+  const Span<float3> normals = curves.evaluated_normals();
+  EXPECT_EQ(tangents.size(), 29);
+  EXPECT_EQ(normals.size(), 29);
+  for (const int i : normals.index_range()) {
+    EXPECT_NEAR(math::dot(normals[i], tangents[i]), 0.0f, 1e-5f);
+  }
+}
+
+}  // namespace blender::bke::tests
@@ -55,11 +55,20 @@ void CurveComponent::clear()
       BKE_id_free(nullptr, curve_for_render_);
       curve_for_render_ = nullptr;
     }
+    this->clear_curves_for_read();
 
     curve_ = nullptr;
   }
 }
 
+void CurveComponent::clear_curves_for_read()
+{
+  if (curves_for_read_ != nullptr) {
+    BKE_id_free(nullptr, curves_for_read_);
+    curves_for_read_ = nullptr;
+  }
+}
+
 bool CurveComponent::has_curve() const
 {
   return curve_ != nullptr;
@@ -78,6 +87,7 @@ CurveEval *CurveComponent::release()
   BLI_assert(this->is_mutable());
   CurveEval *curve = curve_;
   curve_ = nullptr;
+  this->clear_curves_for_read();
   return curve;
 }
 
@@ -93,6 +103,8 @@ CurveEval *CurveComponent::get_for_write()
     curve_ = new CurveEval(*curve_);
     ownership_ = GeometryOwnershipType::Owned;
   }
+  /* The caller may change the curve. */
+  this->clear_curves_for_read();
   return curve_;
 }
 
@@ -134,6 +146,24 @@ const Curve *CurveComponent::get_curve_for_render() const
   return curve_for_render_;
 }
 
+const Curves *CurveComponent::get_curves_for_read() const
+{
+  if (curve_ == nullptr) {
+    return nullptr;
+  }
+  if (curves_for_read_ != nullptr) {
+    return curves_for_read_;
+  }
+  std::lock_guard lock{curves_for_read_mutex_};
+  if (curves_for_read_ != nullptr) {
+    return curves_for_read_;
+  }
+
+  curves_for_read_ = curve_eval_to_curves(*curve_);
+
+  return curves_for_read_;
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
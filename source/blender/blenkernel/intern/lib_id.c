@@ -62,6 +62,7 @@
 #include "RNA_access.h"
 
 #include "BLO_read_write.h"
+#include "BLO_readfile.h"
 
 #include "atomic_ops.h"
 
@@ -628,6 +629,16 @@ ID *BKE_id_copy_ex(Main *bmain, const ID *id, ID **r_newid, const int flag)
       return NULL;
     }
 
+    if (flag & LIB_ID_COPY_SET_COPIED_ON_WRITE) {
+      /* Copy-on-write runs on worker threads, the depsgraph reads deferred data of the original
+       * IDs before that, see #deg_evaluate_on_refresh. */
+      BLI_assert((id->tag & LIB_TAG_LAZY_DATA) == 0);
+    }
+    else {
+      /* Deferred data is read on first copy. */
+      BLO_lazy_data_ensure((ID *)id);
+    }
+
     BKE_libblock_copy_ex(bmain, id, &newid, flag);
 
     if (idtype_info->copy_data != NULL) {
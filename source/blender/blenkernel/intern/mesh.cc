@@ -293,11 +293,9 @@ static void mesh_blend_write(BlendWriter *writer, ID *id, const void *id_address
 #undef CD_LAYERS_FREE
 }
 
-static void mesh_blend_read_data(BlendDataReader *reader, ID *id)
+/** Read the geometry arrays and custom-data layers, which can be deferred on file read. */
+static void mesh_blend_read_geometry(BlendDataReader *reader, Mesh *mesh)
 {
-  Mesh *mesh = (Mesh *)id;
-  BLO_read_pointer_array(reader, (void **)&mesh->mat);
-
   BLO_read_data_address(reader, &mesh->mvert);
   BLO_read_data_address(reader, &mesh->medge);
   BLO_read_data_address(reader, &mesh->mface);
@@ -311,14 +309,9 @@ static void mesh_blend_read_data(BlendDataReader *reader, ID *id)
   BLO_read_data_address(reader, &mesh->mloopuv);
   BLO_read_data_address(reader, &mesh->mselect);
 
-  /* animdata */
-  BLO_read_data_address(reader, &mesh->adt);
-  BKE_animdata_blend_read_data(reader, mesh->adt);
-
   /* Normally BKE_defvert_blend_read should be called in CustomData_blend_read,
    * but for backwards compatibility in do_versions to work we do it here. */
   BKE_defvert_blend_read(reader, mesh->totvert, mesh->dvert);
-  BLO_read_list(reader, &mesh->vertex_group_names);
 
   CustomData_blend_read(reader, &mesh->vdata, mesh->totvert);
   CustomData_blend_read(reader, &mesh->edata, mesh->totedge);
@@ -326,12 +319,6 @@ static void mesh_blend_read_data(BlendDataReader *reader, ID *id)
   CustomData_blend_read(reader, &mesh->ldata, mesh->totloop);
   CustomData_blend_read(reader, &mesh->pdata, mesh->totpoly);
 
-  mesh->texflag &= ~ME_AUTOSPACE_EVALUATED;
-  mesh->edit_mesh = nullptr;
-
-  memset(&mesh->runtime, 0, sizeof(mesh->runtime));
-  BKE_mesh_runtime_init_data(mesh);
-
   /* happens with old files */
   if (mesh->mselect == nullptr) {
     mesh->totselect = 0;
@@ -343,6 +330,99 @@ static void mesh_blend_read_data(BlendDataReader *reader, ID *id)
       BLI_endian_switch_uint32_array(tf->col, 4);
     }
   }
+}
+
+/** Clear the geometry of a mesh which is still in its file, see #mesh_blend_read_lazy_data. */
+static void mesh_clear_geometry_pointers(Mesh *mesh)
+{
+  mesh->mvert = nullptr;
+  mesh->medge = nullptr;
+  mesh->mface = nullptr;
+  mesh->mloop = nullptr;
+  mesh->mpoly = nullptr;
+  mesh->tface = nullptr;
+  mesh->mtface = nullptr;
+  mesh->mcol = nullptr;
+  mesh->dvert = nullptr;
+  mesh->mloopcol = nullptr;
+  mesh->mloopuv = nullptr;
+  mesh->mselect = nullptr;
+
+  mesh->totvert = 0;
+  mesh->totedge = 0;
+  mesh->totface = 0;
+  mesh->totloop = 0;
+  mesh->totpoly = 0;
+  mesh->totselect = 0;
+
+  CustomData_reset(&mesh->vdata);
+  CustomData_reset(&mesh->edata);
+  CustomData_reset(&mesh->fdata);
+  CustomData_reset(&mesh->ldata);
+  CustomData_reset(&mesh->pdata);
+}
+
+static void mesh_blend_read_lazy_data(BlendDataReader *reader, ID *id, const ID *id_file)
+{
+  Mesh *mesh = (Mesh *)id;
+  const Mesh *mesh_file = (const Mesh *)id_file;
+  /* The geometry in the file replaces anything that was set without reading it first. */
+  mesh_clear_geometry(mesh);
+
+  mesh->mvert = mesh_file->mvert;
+  mesh->medge = mesh_file->medge;
+  mesh->mface = mesh_file->mface;
+  mesh->mloop = mesh_file->mloop;
+  mesh->mpoly = mesh_file->mpoly;
+  mesh->tface = mesh_file->tface;
+  mesh->mtface = mesh_file->mtface;
+  mesh->mcol = mesh_file->mcol;
+  mesh->dvert = mesh_file->dvert;
+  mesh->mloopcol = mesh_file->mloopcol;
+  mesh->mloopuv = mesh_file->mloopuv;
+  mesh->mselect = mesh_file->mselect;
+
+  mesh->totvert = mesh_file->totvert;
+  mesh->totedge = mesh_file->totedge;
+  mesh->totface = mesh_file->totface;
+  mesh->totloop = mesh_file->totloop;
+  mesh->totpoly = mesh_file->totpoly;
+  mesh->totselect = mesh_file->totselect;
+
+  mesh->vdata = mesh_file->vdata;
+  mesh->edata = mesh_file->edata;
+  mesh->fdata = mesh_file->fdata;
+  mesh->ldata = mesh_file->ldata;
+  mesh->pdata = mesh_file->pdata;
+
+  mesh_blend_read_geometry(reader, mesh);
+
+  BKE_mesh_normals_tag_dirty(mesh);
+}
+
+static void mesh_blend_read_data(BlendDataReader *reader, ID *id)
+{
+  Mesh *mesh = (Mesh *)id;
+  BLO_read_pointer_array(reader, (void **)&mesh->mat);
+
+  /* animdata */
+  BLO_read_data_address(reader, &mesh->adt);
+  BKE_animdata_blend_read_data(reader, mesh->adt);
+
+  BLO_read_list(reader, &mesh->vertex_group_names);
+
+  if (BLO_read_data_defer(reader, id, mesh_blend_read_lazy_data)) {
+    mesh_clear_geometry_pointers(mesh);
+  }
+  else {
+    mesh_blend_read_geometry(reader, mesh);
+  }
+
+  mesh->texflag &= ~ME_AUTOSPACE_EVALUATED;
+  mesh->edit_mesh = nullptr;
+
+  memset(&mesh->runtime, 0, sizeof(mesh->runtime));
+  BKE_mesh_runtime_init_data(mesh);
 
   /* We don't expect to load normals from files, since they are derived data. */
   BKE_mesh_normals_tag_dirty(mesh);
@@ -5,14 +5,20 @@
  * \ingroup bke
  */
 
+#include <string.h>
+
 #include "BKE_subdiv.h"
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 #include "DNA_modifier_types.h"
 
+#include "BLI_hash_mm2a.h"
+#include "BLI_math_vector.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
+#include "BKE_customdata.h"
 #include "BKE_modifier.h"
 #include "BKE_subdiv_modifier.h"
 
@@ -34,6 +40,7 @@ void BKE_subdiv_init()
 
 void BKE_subdiv_exit()
 {
+  BKE_subdiv_cache_clear();
   openSubdiv_cleanup();
 }
 
@@ -191,9 +198,157 @@ void BKE_subdiv_free(Subdiv *subdiv)
   if (subdiv->cache_.face_ptex_offset != NULL) {
     MEM_freeN(subdiv->cache_.face_ptex_offset);
   }
+  MEM_SAFE_FREE(subdiv->cache_.uvs);
   MEM_freeN(subdiv);
 }
 
+/* ================================= CACHE ================================== */
+
+/* Every evaluation which subdivides a mesh owns its descriptor while it is evaluated, so this is
+ * the number of different subdivided meshes which stay fast to update. Descriptors of big meshes
+ * use a lot of memory, so the number is kept small. */
+#define SUBDIV_CACHE_SIZE 4
+
+/* Released descriptors, from the least to the most recently released one. */
+static Subdiv *subdiv_cache[SUBDIV_CACHE_SIZE];
+static int subdiv_cache_num = 0;
+static ThreadMutex subdiv_cache_mutex = BLI_MUTEX_INITIALIZER;
+
+static uint32_t subdiv_topology_hash(const Mesh *mesh)
+{
+  BLI_HashMurmur2A mm2;
+  BLI_hash_mm2a_init(&mm2, 0);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totvert);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totedge);
+  BLI_hash_mm2a_add_int(&mm2, mesh->totpoly);
+  BLI_hash_mm2a_add(&mm2, (const unsigned char *)mesh->mloop, sizeof(MLoop) * mesh->totloop);
+  /* UV seams define the face-varying topology of the refiner. The UVs are compared exactly on a
+   * hash match, see #subdiv_uvs_equal. */
+  const int num_uv_layers = CustomData_number_of_layers(&mesh->ldata, CD_MLOOPUV);
+  BLI_hash_mm2a_add_int(&mm2, num_uv_layers);
+  for (int layer_index = 0; layer_index < num_uv_layers; layer_index++) {
+    const MLoopUV *mloopuv = CustomData_get_layer_n(&mesh->ldata, CD_MLOOPUV, layer_index);
+    for (int loop_index = 0; loop_index < mesh->totloop; loop_index++) {
+      BLI_hash_mm2a_add(&mm2, (const unsigned char *)mloopuv[loop_index].uv, sizeof(float[2]));
+    }
+  }
+  return BLI_hash_mm2a_end(&mm2);
+}
+
+static bool subdiv_uvs_equal(const Subdiv *subdiv, const Mesh *mesh)
+{
+  const int num_uv_layers = CustomData_number_of_layers(&mesh->ldata, CD_MLOOPUV);
+  if (subdiv->cache_.num_uv_layers != num_uv_layers) {
+    return false;
+  }
+  if (num_uv_layers == 0) {
+    return true;
+  }
+  if (subdiv->cache_.num_uv_loops != mesh->totloop) {
+    return false;
+  }
+  for (int layer_index = 0; layer_index < num_uv_layers; layer_index++) {
+    const MLoopUV *mloopuv = CustomData_get_layer_n(&mesh->ldata, CD_MLOOPUV, layer_index);
+    const float(*uvs)[2] = &subdiv->cache_.uvs[layer_index * mesh->totloop];
+    for (int loop_index = 0; loop_index < mesh->totloop; loop_index++) {
+      /* Compare the bits like the hash does. */
+      if (memcmp(uvs[loop_index], mloopuv[loop_index].uv, sizeof(float[2])) != 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static void subdiv_uvs_store(Subdiv *subdiv, const Mesh *mesh)
+{
+  const int num_uv_layers = CustomData_number_of_layers(&mesh->ldata, CD_MLOOPUV);
+  MEM_SAFE_FREE(subdiv->cache_.uvs);
+  subdiv->cache_.num_uv_layers = num_uv_layers;
+  subdiv->cache_.num_uv_loops = mesh->totloop;
+  if (num_uv_layers == 0 || mesh->totloop == 0) {
+    return;
+  }
+  subdiv->cache_.uvs = MEM_malloc_arrayN(
+      (size_t)num_uv_layers * (size_t)mesh->totloop, sizeof(float[2]), "subdiv cache uvs");
+  for (int layer_index = 0; layer_index < num_uv_layers; layer_index++) {
+    const MLoopUV *mloopuv = CustomData_get_layer_n(&mesh->ldata, CD_MLOOPUV, layer_index);
+    float(*uvs)[2] = &subdiv->cache_.uvs[layer_index * mesh->totloop];
+    for (int loop_index = 0; loop_index < mesh->totloop; loop_index++) {
+      copy_v2_v2(uvs[loop_index], mloopuv[loop_index].uv);
+    }
+  }
+}
+
+static void subdiv_cache_remove_index(const int index)
+{
+  memmove(&subdiv_cache[index],
+          &subdiv_cache[index + 1],
+          sizeof(Subdiv *) * (subdiv_cache_num - index - 1));
+  subdiv_cache_num--;
+}
+
+Subdiv *BKE_subdiv_cache_acquire(const SubdivSettings *settings, const Mesh *mesh)
+{
+  const uint32_t topology_hash = subdiv_topology_hash(mesh);
+  Subdiv *cached_subdiv = NULL;
+  BLI_mutex_lock(&subdiv_cache_mutex);
+  for (int i = subdiv_cache_num - 1; i >= 0; i--) {
+    if (subdiv_cache[i]->cache_.topology_hash == topology_hash &&
+        BKE_subdiv_settings_equal(&subdiv_cache[i]->settings, settings) &&
+        subdiv_uvs_equal(subdiv_cache[i], mesh)) {
+      cached_subdiv = subdiv_cache[i];
+      subdiv_cache_remove_index(i);
+      break;
+    }
+  }
+  BLI_mutex_unlock(&subdiv_cache_mutex);
+  /* The hash only finds a candidate, the topology is still compared in full. */
+  Subdiv *subdiv = BKE_subdiv_update_from_mesh(cached_subdiv, settings, mesh);
+  if (subdiv != NULL) {
+    subdiv->cache_.topology_hash = topology_hash;
+    if (subdiv != cached_subdiv) {
+      subdiv_uvs_store(subdiv, mesh);
+    }
+  }
+  return subdiv;
+}
+
+void BKE_subdiv_cache_release(Subdiv *subdiv)
+{
+  if (subdiv->topology_refiner == NULL ||
+      (subdiv->evaluator != NULL && subdiv->evaluator->type != OPENSUBDIV_EVALUATOR_CPU)) {
+    BKE_subdiv_free(subdiv);
+    return;
+  }
+  BKE_subdiv_displacement_detach(subdiv);
+  Subdiv *evicted_subdiv = NULL;
+  BLI_mutex_lock(&subdiv_cache_mutex);
+  if (subdiv_cache_num == SUBDIV_CACHE_SIZE) {
+    evicted_subdiv = subdiv_cache[0];
+    subdiv_cache_remove_index(0);
+  }
+  subdiv_cache[subdiv_cache_num++] = subdiv;
+  BLI_mutex_unlock(&subdiv_cache_mutex);
+  /* Freeing can take a while, don't block other threads meanwhile. */
+  if (evicted_subdiv != NULL) {
+    BKE_subdiv_free(evicted_subdiv);
+  }
+}
+
+void BKE_subdiv_cache_clear(void)
+{
+  Subdiv *subdivs[SUBDIV_CACHE_SIZE];
+  BLI_mutex_lock(&subdiv_cache_mutex);
+  const int num_subdivs = subdiv_cache_num;
+  memcpy(subdivs, subdiv_cache, sizeof(Subdiv *) * num_subdivs);
+  subdiv_cache_num = 0;
+  BLI_mutex_unlock(&subdiv_cache_mutex);
+  for (int i = 0; i < num_subdivs; i++) {
+    BKE_subdiv_free(subdivs[i]);
+  }
+}
+
 /* =========================== PTEX FACES AND GRIDS ========================= */
 
 int *BKE_subdiv_face_ptex_offset_get(Subdiv *subdiv)
@@ -106,6 +106,13 @@ typedef struct SubdivForeachTaskContext {
    *   were already evaluated.
    */
   BLI_bitmap *coarse_edges_used_map;
+  /* Bitmaps indexed by coarse loop index, indicating whether the polygon of the loop is the one
+   * which traverses the subdivided vertices of the loop's vertex or edge. This allows to traverse
+   * vertices shared between polygons in parallel, exactly once and always from the same polygon.
+   * Only allocated when the per-shared-geometry vertex callbacks are used.
+   */
+  BLI_bitmap *coarse_loop_vertex_owner_map;
+  BLI_bitmap *coarse_loop_edge_owner_map;
 } SubdivForeachTaskContext;
 
 /** \} */
@@ -279,6 +286,8 @@ static void subdiv_foreach_ctx_free(SubdivForeachTaskContext *ctx)
 {
   MEM_freeN(ctx->coarse_vertices_used_map);
   MEM_freeN(ctx->coarse_edges_used_map);
+  MEM_SAFE_FREE(ctx->coarse_loop_vertex_owner_map);
+  MEM_SAFE_FREE(ctx->coarse_loop_edge_owner_map);
   MEM_freeN(ctx->subdiv_vertex_offset);
   MEM_freeN(ctx->subdiv_edge_offset);
   MEM_freeN(ctx->subdiv_polygon_offset);
@@ -306,8 +315,8 @@ static void subdiv_foreach_corner_vertices_regular_do(
   const int ptex_face_index = ctx->face_ptex_offset[coarse_poly_index];
   for (int corner = 0; corner < coarse_poly->totloop; corner++) {
     const MLoop *coarse_loop = &coarse_mloop[coarse_poly->loopstart + corner];
-    if (check_usage &&
-        BLI_BITMAP_TEST_AND_SET_ATOMIC(ctx->coarse_vertices_used_map, coarse_loop->v)) {
+    if (check_usage && !BLI_BITMAP_TEST_BOOL(ctx->coarse_loop_vertex_owner_map,
+                                             coarse_poly->loopstart + corner)) {
       continue;
     }
     const int coarse_vertex_index = coarse_loop->v;
@@ -347,8 +356,8 @@ static void subdiv_foreach_corner_vertices_special_do(
   int ptex_face_index = ctx->face_ptex_offset[coarse_poly_index];
   for (int corner = 0; corner < coarse_poly->totloop; corner++, ptex_face_index++) {
     const MLoop *coarse_loop = &coarse_mloop[coarse_poly->loopstart + corner];
-    if (check_usage &&
-        BLI_BITMAP_TEST_AND_SET_ATOMIC(ctx->coarse_vertices_used_map, coarse_loop->v)) {
+    if (check_usage && !BLI_BITMAP_TEST_BOOL(ctx->coarse_loop_vertex_owner_map,
+                                             coarse_poly->loopstart + corner)) {
       continue;
     }
     const int coarse_vertex_index = coarse_loop->v;
@@ -441,8 +450,8 @@ static void subdiv_foreach_edge_vertices_regular_do(SubdivForeachTaskContext *ct
   for (int corner = 0; corner < coarse_poly->totloop; corner++) {
     const MLoop *coarse_loop = &coarse_mloop[coarse_poly->loopstart + corner];
     const int coarse_edge_index = coarse_loop->e;
-    if (check_usage &&
-        BLI_BITMAP_TEST_AND_SET_ATOMIC(ctx->coarse_edges_used_map, coarse_edge_index)) {
+    if (check_usage && !BLI_BITMAP_TEST_BOOL(ctx->coarse_loop_edge_owner_map,
+                                             coarse_poly->loopstart + corner)) {
       continue;
     }
     const MEdge *coarse_edge = &coarse_medge[coarse_edge_index];
@@ -509,8 +518,8 @@ static void subdiv_foreach_edge_vertices_special_do(SubdivForeachTaskContext *ct
   for (int corner = 0; corner < coarse_poly->totloop; corner++, ptex_face_index++) {
     const MLoop *coarse_loop = &coarse_mloop[coarse_poly->loopstart + corner];
     const int coarse_edge_index = coarse_loop->e;
-    if (check_usage &&
-        BLI_BITMAP_TEST_AND_SET_ATOMIC(ctx->coarse_edges_used_map, coarse_edge_index)) {
+    if (check_usage && !BLI_BITMAP_TEST_BOOL(ctx->coarse_loop_edge_owner_map,
+                                             coarse_poly->loopstart + corner)) {
       continue;
     }
     const MEdge *coarse_edge = &coarse_medge[coarse_edge_index];
@@ -1762,20 +1771,46 @@ static void subdiv_foreach_vertices_of_loose_edges_task(void *__restrict userdat
 /** \name Subdivision process entry points
  * \{ */
 
-static void subdiv_foreach_single_geometry_vertices(SubdivForeachTaskContext *ctx, void *tls)
+/* Shared vertices and edges are owned by the first polygon which uses them. This is cheap compared
+ * to evaluating the vertices, which is then done in parallel. */
+static void subdiv_foreach_single_geometry_owners(SubdivForeachTaskContext *ctx)
 {
   if (ctx->foreach_context->vertex_corner == NULL) {
     return;
   }
   const Mesh *coarse_mesh = ctx->coarse_mesh;
   const MPoly *coarse_mpoly = coarse_mesh->mpoly;
+  const MLoop *coarse_mloop = coarse_mesh->mloop;
+  ctx->coarse_loop_vertex_owner_map = BLI_BITMAP_NEW(coarse_mesh->totloop,
+                                                     "loop vertex owner map");
+  ctx->coarse_loop_edge_owner_map = BLI_BITMAP_NEW(coarse_mesh->totloop, "loop edge owner map");
   for (int poly_index = 0; poly_index < coarse_mesh->totpoly; poly_index++) {
     const MPoly *coarse_poly = &coarse_mpoly[poly_index];
-    subdiv_foreach_corner_vertices(ctx, tls, coarse_poly);
-    subdiv_foreach_edge_vertices(ctx, tls, coarse_poly);
+    for (int corner = 0; corner < coarse_poly->totloop; corner++) {
+      const int loop_index = coarse_poly->loopstart + corner;
+      const MLoop *loop = &coarse_mloop[loop_index];
+      if (!BLI_BITMAP_TEST_BOOL(ctx->coarse_vertices_used_map, loop->v)) {
+        BLI_BITMAP_ENABLE(ctx->coarse_vertices_used_map, loop->v);
+        BLI_BITMAP_ENABLE(ctx->coarse_loop_vertex_owner_map, loop_index);
+      }
+      if (!BLI_BITMAP_TEST_BOOL(ctx->coarse_edges_used_map, loop->e)) {
+        BLI_BITMAP_ENABLE(ctx->coarse_edges_used_map, loop->e);
+        BLI_BITMAP_ENABLE(ctx->coarse_loop_edge_owner_map, loop_index);
+      }
+    }
   }
 }
 
+static void subdiv_foreach_single_geometry_vertices_task(void *__restrict userdata,
+                                                         const int poly_index,
+                                                         const TaskParallelTLS *__restrict tls)
+{
+  SubdivForeachTaskContext *ctx = userdata;
+  const MPoly *coarse_poly = &ctx->coarse_mesh->mpoly[poly_index];
+  subdiv_foreach_corner_vertices(ctx, tls->userdata_chunk, coarse_poly);
+  subdiv_foreach_edge_vertices(ctx, tls->userdata_chunk, coarse_poly);
+}
+
 static void subdiv_foreach_mark_non_loose_geometry(SubdivForeachTaskContext *ctx)
 {
   const Mesh *coarse_mesh = ctx->coarse_mesh;
@@ -1801,9 +1836,10 @@ static void subdiv_foreach_single_thread_tasks(SubdivForeachTaskContext *ctx)
    * and boundary edges. */
   subdiv_foreach_every_corner_vertices(ctx, tls);
   subdiv_foreach_every_edge_vertices(ctx, tls);
-  /* Run callbacks which are supposed to be run once per shared geometry. */
-  subdiv_foreach_single_geometry_vertices(ctx, tls);
   subdiv_foreach_tls_free(ctx, tls);
+  /* Decide which polygon runs the callbacks which are supposed to be run once per shared
+   * geometry. */
+  subdiv_foreach_single_geometry_owners(ctx);
 
   const SubdivForeachContext *foreach_context = ctx->foreach_context;
   const bool is_loose_geometry_tagged = (foreach_context->vertex_every_edge != NULL &&
@@ -1881,6 +1917,15 @@ bool BKE_subdiv_foreach_subdiv_geometry(Subdiv *subdiv,
     parallel_range_settings.func_free = subdiv_foreach_free;
   }
 
+  /* Run callbacks which are supposed to be run once per shared geometry. */
+  if (context->vertex_corner != NULL) {
+    BLI_task_parallel_range(0,
+                            coarse_mesh->totpoly,
+                            &ctx,
+                            subdiv_foreach_single_geometry_vertices_task,
+                            &parallel_range_settings);
+  }
+
   /* TODO(sergey): Possible optimization is to have a single pool and push all
    * the tasks into it.
    * NOTE: Watch out for callbacks which needs to run for loose geometry as they
@@ -0,0 +1,474 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include <cmath>
+
+#include "CLG_log.h"
+
+#include "atomic_ops.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BLI_array.hh"
+#include "BLI_index_range.hh"
+#include "BLI_timeit.hh"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_subdiv.h"
+#include "BKE_subdiv_foreach.h"
+#include "BKE_subdiv_mesh.h"
+
+#ifdef WITH_OPENSUBDIV
+
+namespace blender::bke::tests {
+
+class subdiv : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BKE_idtype_init();
+    BKE_subdiv_init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    BKE_subdiv_exit();
+    CLG_exit();
+  }
+
+  void SetUp() override
+  {
+    BKE_subdiv_cache_clear();
+  }
+
+  void TearDown() override
+  {
+    BKE_subdiv_cache_clear();
+  }
+};
+
+/**
+ * Create a grid of quads in the XY plane. With `cyclic` the grid is wrapped into a torus, which
+ * has no boundary like most character meshes. With `triangulate` every quad is split in two, so
+ * that the special (non-quad) ptex faces are used.
+ */
+static Mesh *create_grid_mesh(const int size_x,
+                              const int size_y,
+                              const bool cyclic,
+                              const bool triangulate)
+{
+  const int verts_x = cyclic ? size_x : size_x + 1;
+  const int verts_y = cyclic ? size_y : size_y + 1;
+  const int faces_num = size_x * size_y * (triangulate ? 2 : 1);
+  const int loops_num = size_x * size_y * (triangulate ? 6 : 4);
+  Mesh *mesh = BKE_mesh_new_nomain(verts_x * verts_y, 0, 0, loops_num, faces_num);
+
+  for (const int y : IndexRange(verts_y)) {
+    for (const int x : IndexRange(verts_x)) {
+      MVert &vert = mesh->mvert[y * verts_x + x];
+      if (cyclic) {
+        const float angle_x = float(x) / size_x * 2.0f * float(M_PI);
+        const float angle_y = float(y) / size_y * 2.0f * float(M_PI);
+        const float radius = 2.0f + std::cos(angle_y);
+        vert.co[0] = radius * std::cos(angle_x);
+        vert.co[1] = radius * std::sin(angle_x);
+        vert.co[2] = std::sin(angle_y);
+      }
+      else {
+        vert.co[0] = float(x);
+        vert.co[1] = float(y);
+        vert.co[2] = 0.0f;
+      }
+    }
+  }
+
+  int face_index = 0;
+  int loop_index = 0;
+  auto add_face = [&](const Span<int> verts) {
+    mesh->mpoly[face_index].loopstart = loop_index;
+    mesh->mpoly[face_index].totloop = verts.size();
+    for (const int vert : verts) {
+      mesh->mloop[loop_index++].v = vert;
+    }
+    face_index++;
+  };
+  for (const int y : IndexRange(size_y)) {
+    for (const int x : IndexRange(size_x)) {
+      const int v1 = y * verts_x + x;
+      const int v2 = y * verts_x + (x + 1) % verts_x;
+      const int v3 = ((y + 1) % verts_y) * verts_x + (x + 1) % verts_x;
+      const int v4 = ((y + 1) % verts_y) * verts_x + x;
+      if (triangulate) {
+        add_face({v1, v2, v3});
+        add_face({v1, v3, v4});
+      }
+      else {
+        add_face({v1, v2, v3, v4});
+      }
+    }
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+  return mesh;
+}
+
+static void add_uv_layer(Mesh *mesh, const float offset)
+{
+  MLoopUV *uvs = (MLoopUV *)CustomData_add_layer(
+      &mesh->ldata, CD_MLOOPUV, CD_CALLOC, nullptr, mesh->totloop);
+  for (const int i : IndexRange(mesh->totloop)) {
+    uvs[i].uv[0] = float(mesh->mloop[i].v) + offset;
+    uvs[i].uv[1] = 0.0f;
+  }
+}
+
+static SubdivSettings subdiv_settings_for_level(const int level)
+{
+  SubdivSettings settings{};
+  settings.is_simple = false;
+  settings.is_adaptive = false;
+  settings.level = level;
+  settings.use_creases = false;
+  settings.vtx_boundary_interpolation = SUBDIV_VTX_BOUNDARY_EDGE_ONLY;
+  settings.fvar_linear_interpolation = SUBDIV_FVAR_LINEAR_INTERPOLATION_BOUNDARIES;
+  return settings;
+}
+
+/* The creation time is only set when a descriptor is created, so it is used to recognize
+ * descriptors which are given out again by the cache. */
+static void tag_subdiv(Subdiv *subdiv, const double tag)
+{
+  subdiv->stats.topology_refiner_creation_time = tag;
+}
+
+static bool subdiv_has_tag(const Subdiv *subdiv, const double tag)
+{
+  return subdiv->stats.topology_refiner_creation_time == tag;
+}
+
+TEST_F(subdiv, CacheHitWithDeformedMesh)
+{
+  Mesh *mesh = create_grid_mesh(4, 4, false, false);
+  const SubdivSettings settings = subdiv_settings_for_level(2);
+
+  Subdiv *subdiv = BKE_subdiv_cache_acquire(&settings, mesh);
+  ASSERT_NE(subdiv, nullptr);
+  tag_subdiv(subdiv, -1.0);
+  BKE_subdiv_cache_release(subdiv);
+
+  /* Only positions change, the descriptor is re-used. */
+  mesh->mvert[5].co[2] = 1.0f;
+  subdiv = BKE_subdiv_cache_acquire(&settings, mesh);
+  ASSERT_NE(subdiv, nullptr);
+  EXPECT_TRUE(subdiv_has_tag(subdiv, -1.0));
+
+  /* A descriptor is only given out once until it is released. */
+  Subdiv *subdiv_second = BKE_subdiv_cache_acquire(&settings, mesh);
+  ASSERT_NE(subdiv_second, nullptr);
+  EXPECT_NE(subdiv_second, subdiv);
+  EXPECT_FALSE(subdiv_has_tag(subdiv_second, -1.0));
+
+  BKE_subdiv_cache_release(subdiv_second);
+  BKE_subdiv_cache_release(subdiv);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(subdiv, CacheMissOnTopologyChange)
+{
+  Mesh *mesh_a = create_grid_mesh(4, 4, false, false);
+  Mesh *mesh_b = create_grid_mesh(4, 4, false, true);
+  const SubdivSettings settings = subdiv_settings_for_level(2);
+
+  Subdiv *subdiv = BKE_subdiv_cache_acquire(&settings, mesh_a);
+  ASSERT_NE(subdiv, nullptr);
+  tag_subdiv(subdiv, -1.0);
+  BKE_subdiv_cache_release(subdiv);
+
+  subdiv = BKE_subdiv_cache_acquire(&settings, mesh_b);
+  ASSERT_NE(subdiv, nullptr);
+  EXPECT_FALSE(subdiv_has_tag(subdiv, -1.0));
+  BKE_subdiv_cache_release(subdiv);
+
+  /* The descriptor of the first mesh is still in the cache. */
+  subdiv = BKE_subdiv_cache_acquire(&settings, mesh_a);
+  ASSERT_NE(subdiv, nullptr);
+  EXPECT_TRUE(subdiv_has_tag(subdiv, -1.0));
+  BKE_subdiv_cache_release(subdiv);
+
+  /* Different settings don't re-use the descriptor. */
+  const SubdivSettings settings_level_3 = subdiv_settings_for_level(3);
+  subdiv = BKE_subdiv_cache_acquire(&settings_level_3, mesh_a);
+  ASSERT_NE(subdiv, nullptr);
+  EXPECT_FALSE(subdiv_has_tag(subdiv, -1.0));
+  BKE_subdiv_cache_release(subdiv);
+
+  /* UVs have to match exactly as well. */
+  add_uv_layer(mesh_a, 0.0f);
+  subdiv = BKE_subdiv_cache_acquire(&settings, mesh_a);
+  ASSERT_NE(subdiv, nullptr);
+  EXPECT_FALSE(subdiv_has_tag(subdiv, -1.0));
+  tag_subdiv(subdiv, -2.0);
+  BKE_subdiv_cache_release(subdiv);
+
+  subdiv = BKE_subdiv_cache_acquire(&settings, mesh_a);
+  ASSERT_NE(subdiv, nullptr);
+  EXPECT_TRUE(subdiv_has_tag(subdiv, -2.0));
+  BKE_subdiv_cache_release(subdiv);
+
+  /* Moving the UVs keeps the seams, but the descriptor is not re-used. */
+  MLoopUV *uvs = (MLoopUV *)CustomData_get_layer(&mesh_a->ldata, CD_MLOOPUV);
+  uvs[0].uv[1] = 0.5f;
+  subdiv = BKE_subdiv_cache_acquire(&settings, mesh_a);
+  ASSERT_NE(subdiv, nullptr);
+  EXPECT_FALSE(subdiv_has_tag(subdiv, -2.0));
+  BKE_subdiv_cache_release(subdiv);
+
+  BKE_id_free(nullptr, mesh_a);
+  BKE_id_free(nullptr, mesh_b);
+}
+
+TEST_F(subdiv, CacheEvictsLeastRecentlyReleased)
+{
+  const SubdivSettings settings = subdiv_settings_for_level(1);
+  /* More meshes than the cache holds. */
+  Array<Mesh *> meshes(5);
+  for (const int i : meshes.index_range()) {
+    meshes[i] = create_grid_mesh(i + 1, 2, false, false);
+  }
+  for (const int i : meshes.index_range()) {
+    Subdiv *subdiv = BKE_subdiv_cache_acquire(&settings, meshes[i]);
+    ASSERT_NE(subdiv, nullptr);
+    tag_subdiv(subdiv, -double(i + 1));
+    BKE_subdiv_cache_release(subdiv);
+  }
+
+  /* Acquire in reverse order, so that a new descriptor for the first mesh doesn't evict any of
+   * the others. */
+  for (int i = meshes.size() - 1; i >= 0; i--) {
+    Subdiv *subdiv = BKE_subdiv_cache_acquire(&settings, meshes[i]);
+    ASSERT_NE(subdiv, nullptr);
+    EXPECT_EQ(subdiv_has_tag(subdiv, -double(i + 1)), i != 0);
+    BKE_subdiv_cache_release(subdiv);
+  }
+
+  for (Mesh *mesh : meshes) {
+    BKE_id_free(nullptr, mesh);
+  }
+}
+
+TEST_F(subdiv, CacheClear)
+{
+  Mesh *mesh = create_grid_mesh(4, 4, false, false);
+  const SubdivSettings settings = subdiv_settings_for_level(2);
+
+  Subdiv *subdiv = BKE_subdiv_cache_acquire(&settings, mesh);
+  ASSERT_NE(subdiv, nullptr);
+  tag_subdiv(subdiv, -1.0);
+  BKE_subdiv_cache_release(subdiv);
+
+  BKE_subdiv_cache_clear();
+  subdiv = BKE_subdiv_cache_acquire(&settings, mesh);
+  ASSERT_NE(subdiv, nullptr);
+  EXPECT_FALSE(subdiv_has_tag(subdiv, -1.0));
+  BKE_subdiv_cache_release(subdiv);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+struct ForeachOwnerData {
+  const Mesh *coarse_mesh;
+  /* Number of callbacks for every subdivided vertex. */
+  Array<int> vertex_visits;
+  /* The first coarse polygon which uses each coarse vertex or edge. */
+  Array<int> first_vertex_poly;
+  Array<int> first_edge_poly;
+  int wrong_owner_num = 0;
+};
+
+static bool foreach_owner_topology_info(const SubdivForeachContext *context,
+                                        const int num_vertices,
+                                        const int /*num_edges*/,
+                                        const int /*num_loops*/,
+                                        const int /*num_polygons*/,
+                                        const int * /*subdiv_polygon_offset*/)
+{
+  ForeachOwnerData *data = static_cast<ForeachOwnerData *>(context->user_data);
+  data->vertex_visits = Array<int>(num_vertices, 0);
+  return true;
+}
+
+static void foreach_owner_vertex_corner(const SubdivForeachContext *context,
+                                        void * /*tls*/,
+                                        const int /*ptex_face_index*/,
+                                        const float /*u*/,
+                                        const float /*v*/,
+                                        const int coarse_vertex_index,
+                                        const int coarse_poly_index,
+                                        const int /*coarse_corner*/,
+                                        const int subdiv_vertex_index)
+{
+  ForeachOwnerData *data = static_cast<ForeachOwnerData *>(context->user_data);
+  atomic_add_and_fetch_int32(&data->vertex_visits[subdiv_vertex_index], 1);
+  if (data->first_vertex_poly[coarse_vertex_index] != coarse_poly_index) {
+    atomic_add_and_fetch_int32(&data->wrong_owner_num, 1);
+  }
+}
+
+static void foreach_owner_vertex_edge(const SubdivForeachContext *context,
+                                      void * /*tls*/,
+                                      const int /*ptex_face_index*/,
+                                      const float /*u*/,
+                                      const float /*v*/,
+                                      const int coarse_edge_index,
+                                      const int coarse_poly_index,
+                                      const int /*coarse_corner*/,
+                                      const int subdiv_vertex_index)
+{
+  ForeachOwnerData *data = static_cast<ForeachOwnerData *>(context->user_data);
+  atomic_add_and_fetch_int32(&data->vertex_visits[subdiv_vertex_index], 1);
+  if (data->first_edge_poly[coarse_edge_index] != coarse_poly_index) {
+    atomic_add_and_fetch_int32(&data->wrong_owner_num, 1);
+  }
+}
+
+static void foreach_owner_vertex_inner(const SubdivForeachContext *context,
+                                       void * /*tls*/,
+                                       const int /*ptex_face_index*/,
+                                       const float /*u*/,
+                                       const float /*v*/,
+                                       const int /*coarse_poly_index*/,
+                                       const int /*coarse_corner*/,
+                                       const int subdiv_vertex_index)
+{
+  ForeachOwnerData *data = static_cast<ForeachOwnerData *>(context->user_data);
+  atomic_add_and_fetch_int32(&data->vertex_visits[subdiv_vertex_index], 1);
+}
+
+static void test_foreach_shared_vertex_owners(const bool triangulate)
+{
+  Mesh *mesh = create_grid_mesh(32, 16, false, triangulate);
+  const SubdivSettings settings = subdiv_settings_for_level(2);
+  Subdiv *subdiv = BKE_subdiv_new_from_mesh(&settings, mesh);
+  ASSERT_NE(subdiv, nullptr);
+
+  ForeachOwnerData data;
+  data.coarse_mesh = mesh;
+  data.first_vertex_poly = Array<int>(mesh->totvert, -1);
+  data.first_edge_poly = Array<int>(mesh->totedge, -1);
+  for (const int poly_index : IndexRange(mesh->totpoly)) {
+    const MPoly &poly = mesh->mpoly[poly_index];
+    for (const MLoop &loop : Span(&mesh->mloop[poly.loopstart], poly.totloop)) {
+      if (data.first_vertex_poly[loop.v] == -1) {
+        data.first_vertex_poly[loop.v] = poly_index;
+      }
+      if (data.first_edge_poly[loop.e] == -1) {
+        data.first_edge_poly[loop.e] = poly_index;
+      }
+    }
+  }
+
+  SubdivForeachContext foreach_context{};
+  foreach_context.topology_info = foreach_owner_topology_info;
+  foreach_context.vertex_corner = foreach_owner_vertex_corner;
+  foreach_context.vertex_edge = foreach_owner_vertex_edge;
+  foreach_context.vertex_inner = foreach_owner_vertex_inner;
+  foreach_context.user_data = &data;
+
+  SubdivToMeshSettings mesh_settings;
+  mesh_settings.resolution = (1 << settings.level) + 1;
+  mesh_settings.use_optimal_display = false;
+  EXPECT_TRUE(BKE_subdiv_foreach_subdiv_geometry(subdiv, &foreach_context, &mesh_settings, mesh));
+
+  /* Every vertex is traversed exactly once, from the first polygon using the coarse vertex or
+   * edge it is created for, like in the serial traversal. */
+  for (const int i : data.vertex_visits.index_range()) {
+    EXPECT_EQ(data.vertex_visits[i], 1) << "Subdivided vertex " << i;
+  }
+  EXPECT_EQ(data.wrong_owner_num, 0);
+
+  BKE_subdiv_free(subdiv);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(subdiv, ForeachSharedVertexOwnersQuads)
+{
+  test_foreach_shared_vertex_owners(false);
+}
+
+TEST_F(subdiv, ForeachSharedVertexOwnersTriangles)
+{
+  test_foreach_shared_vertex_owners(true);
+}
+
+/**
+ * Subdivide an animated closed mesh with a fixed topology, once creating a new descriptor for
+ * every frame and once using the descriptor cache like the Subdivision Surface node.
+ */
+TEST_F(subdiv, AnimatedMeshPerformance)
+{
+  const int frames_num = 10;
+  Mesh *mesh = create_grid_mesh(256, 128, true, false);
+  add_uv_layer(mesh, 0.0f);
+  const Array<MVert> rest_verts(Span(mesh->mvert, mesh->totvert));
+  const SubdivSettings settings = subdiv_settings_for_level(2);
+  SubdivToMeshSettings mesh_settings;
+  mesh_settings.resolution = (1 << settings.level) + 1;
+  mesh_settings.use_optimal_display = false;
+
+  auto set_frame = [&](const int frame) {
+    for (const int i : rest_verts.index_range()) {
+      const float *co = rest_verts[i].co;
+      const float offset = 0.1f * std::sin(co[0] * 2.0f + float(frame) * 0.5f);
+      mesh->mvert[i].co[0] = co[0];
+      mesh->mvert[i].co[1] = co[1];
+      mesh->mvert[i].co[2] = co[2] + offset;
+    }
+  };
+
+  Array<Mesh *> result_meshes(frames_num);
+  {
+    SCOPED_TIMER("New descriptor per frame");
+    for (const int frame : IndexRange(frames_num)) {
+      set_frame(frame);
+      Subdiv *subdiv = BKE_subdiv_new_from_mesh(&settings, mesh);
+      result_meshes[frame] = BKE_subdiv_to_mesh(subdiv, &mesh_settings, mesh);
+      BKE_subdiv_free(subdiv);
+    }
+  }
+
+  Array<Mesh *> cached_result_meshes(frames_num);
+  {
+    SCOPED_TIMER("Cached descriptor");
+    for (const int frame : IndexRange(frames_num)) {
+      set_frame(frame);
+      Subdiv *subdiv = BKE_subdiv_cache_acquire(&settings, mesh);
+      cached_result_meshes[frame] = BKE_subdiv_to_mesh(subdiv, &mesh_settings, mesh);
+      BKE_subdiv_cache_release(subdiv);
+    }
+  }
+
+  /* Re-using the descriptor must not change the result. */
+  for (const int frame : IndexRange(frames_num)) {
+    const Mesh *result = result_meshes[frame];
+    const Mesh *cached_result = cached_result_meshes[frame];
+    ASSERT_EQ(result->totvert, cached_result->totvert);
+    for (const int i : IndexRange(result->totvert)) {
+      EXPECT_EQ(result->mvert[i].co[0], cached_result->mvert[i].co[0]);
+      EXPECT_EQ(result->mvert[i].co[1], cached_result->mvert[i].co[1]);
+      EXPECT_EQ(result->mvert[i].co[2], cached_result->mvert[i].co[2]);
+    }
+    BKE_id_free(nullptr, result_meshes[frame]);
+    BKE_id_free(nullptr, cached_result_meshes[frame]);
+  }
+
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::bke::tests
+
+#endif
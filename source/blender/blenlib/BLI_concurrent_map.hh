@@ -0,0 +1,299 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * A `blender::ConcurrentMap<Key, Value>` is a hash map that can be filled by multiple threads at
+ * the same time. It consists of multiple shards, each of which is a #blender::Map protected by
+ * its own mutex. The shard of a key is determined by its hash, so threads that add different keys
+ * rarely have to wait for each other.
+ *
+ * There are two ways to add keys:
+ * - #add, #lookup_or_add and #add_or_modify can be called from any thread at any time. They only
+ *   lock the shard of the key.
+ * - #add_parallel builds the map from keys that are generated for an index range, without any
+ *   locking. The keys are collected per chunk of the range and per shard first. Afterwards every
+ *   shard is filled by a single task, in the order of the chunks. Therefore the result does not
+ *   depend on the number of threads or on the scheduling of the tasks.
+ *
+ * Lookups don't lock. They must not be called while other threads may add keys. Typically, the map
+ * is built in one parallel pass and queried in a later one.
+ *
+ * Since the shard count does not depend on the machine, the iteration order of the shards is
+ * deterministic as well. The shards can be accessed directly with #shard, for example to
+ * serialize the items in parallel.
+ */
+
+#include <mutex>
+
+#include "BLI_array.hh"
+#include "BLI_map.hh"
+#include "BLI_task.hh"
+#include "BLI_utility_mixins.hh"
+#include "BLI_vector.hh"
+
+namespace blender {
+
+template<typename Key,
+         typename Value,
+         typename Hash = DefaultHash<Key>,
+         typename IsEqual = DefaultEquality,
+         typename Allocator = GuardedAllocator>
+class ConcurrentMap : NonCopyable, NonMovable {
+ public:
+  using MapType = Map<Key,
+                      Value,
+                      default_inline_buffer_capacity(sizeof(Key) + sizeof(Value)),
+                      DefaultProbingStrategy,
+                      Hash,
+                      IsEqual,
+                      typename DefaultMapSlot<Key, Value>::type,
+                      Allocator>;
+
+  /** Enough to keep contention low when many threads add keys. */
+  static constexpr int64_t default_shards_num = 64;
+
+ private:
+  /** Every shard is on its own cache line, so that locking one does not slow down the others. */
+  struct alignas(64) Shard {
+    std::mutex mutex;
+    MapType map;
+  };
+
+  /** The number of chunks used by #add_parallel is limited to bound the number of buffers. */
+  static constexpr int64_t max_chunks_num = 128;
+
+  using Item = std::pair<Key, Value>;
+
+  Array<Shard, 0, Allocator> shards_;
+  uint64_t shard_mask_;
+  Hash hash_;
+
+ public:
+  /**
+   * Passes keys to the map from within #add_parallel. It must only be used by the task it is
+   * passed to.
+   */
+  class ParallelAdder {
+   private:
+    const ConcurrentMap &map_;
+    MutableSpan<Vector<Item>> shard_items_;
+
+    friend ConcurrentMap;
+
+    ParallelAdder(const ConcurrentMap &map, MutableSpan<Vector<Item>> shard_items)
+        : map_(map), shard_items_(shard_items)
+    {
+    }
+
+   public:
+    void add(const Key &key, const Value &value)
+    {
+      shard_items_[map_.shard_index(map_.hash_(key))].append({key, value});
+    }
+  };
+
+  /**
+   * The number of shards has to be a power of two. Using a single shard avoids the overhead of
+   * multiple hash tables for small inputs.
+   */
+  explicit ConcurrentMap(const int64_t shards_num = default_shards_num)
+      : shards_(shards_num), shard_mask_(uint64_t(shards_num) - 1)
+  {
+    BLI_assert(shards_num > 0 && (shards_num & (shards_num - 1)) == 0);
+  }
+
+  /**
+   * Allocate memory such that at least the given number of keys can be added without growing
+   * the hash tables, assuming that the keys are distributed evenly among the shards.
+   */
+  void reserve(const int64_t n)
+  {
+    const int64_t n_per_shard = n / shards_.size() + 1;
+    threading::parallel_for(shards_.index_range(), 1, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        shards_[i].map.reserve(n_per_shard);
+      }
+    });
+  }
+
+  /**
+   * Add a key-value-pair to the map, if the key does not exist yet. Returns true when the key has
+   * been added. This can be called from multiple threads at the same time.
+   */
+  bool add(const Key &key, const Value &value)
+  {
+    Shard &shard = this->shard_for_key(key);
+    std::lock_guard lock{shard.mutex};
+    return shard.map.add(key, value);
+  }
+
+  /**
+   * Returns the value of the key. If the key does not exist yet, the given value is added first.
+   * The value is returned by copy, because other threads may grow the hash table afterwards. This
+   * can be called from multiple threads at the same time.
+   */
+  Value lookup_or_add(const Key &key, const Value &value)
+  {
+    Shard &shard = this->shard_for_key(key);
+    std::lock_guard lock{shard.mutex};
+    return shard.map.lookup_or_add(key, value);
+  }
+
+  /**
+   * Same as #Map::add_or_modify. The callbacks are called while the shard of the key is locked.
+   * They should be fast and must not access the same map. This can be called from multiple
+   * threads at the same time.
+   */
+  template<typename CreateValueF, typename ModifyValueF>
+  auto add_or_modify(const Key &key,
+                     const CreateValueF &create_value,
+                     const ModifyValueF &modify_value) -> decltype(create_value(nullptr))
+  {
+    Shard &shard = this->shard_for_key(key);
+    std::lock_guard lock{shard.mutex};
+    return shard.map.add_or_modify(key, create_value, modify_value);
+  }
+
+  /**
+   * Add many keys in parallel. `add_keys_fn(IndexRange sub_range, ParallelAdder &adder)` is called
+   * for chunks of the range, and passes the keys of the chunk to `adder.add(key, value)`. When a
+   * key is added more than once, `merge_value_fn(Value &value, Value &&new_value)` is called
+   * with the value that has been added first. Keys are added in the order of the range, so that
+   * the result is deterministic.
+   *
+   * This must not be called while other threads add keys to the map.
+   */
+  template<typename AddKeysFn, typename MergeValueFn>
+  void add_parallel(const IndexRange range,
+                    const int64_t grain_size,
+                    const AddKeysFn &add_keys_fn,
+                    const MergeValueFn &merge_value_fn)
+  {
+    if (range.size() == 0) {
+      return;
+    }
+    const int64_t shards_num = shards_.size();
+    /* The chunks only depend on the size of the range, not on the number of threads. */
+    const int64_t chunk_size = std::max(grain_size,
+                                        (range.size() + max_chunks_num - 1) / max_chunks_num);
+    const int64_t chunks_num = (range.size() + chunk_size - 1) / chunk_size;
+
+    /* Collect the items of every chunk, grouped by shard. */
+    Array<Vector<Item>> items(chunks_num * shards_num);
+    threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange chunks) {
+      for (const int64_t chunk : chunks) {
+        const int64_t chunk_start = chunk * chunk_size;
+        const IndexRange chunk_range = range.slice(
+            chunk_start, std::min(chunk_size, range.size() - chunk_start));
+        ParallelAdder adder{*this, items.as_mutable_span().slice(chunk * shards_num, shards_num)};
+        add_keys_fn(chunk_range, adder);
+      }
+    });
+
+    /* Fill every shard from all chunks. */
+    threading::parallel_for(shards_.index_range(), 1, [&](const IndexRange shard_range) {
+      for (const int64_t shard_i : shard_range) {
+        MapType &map = shards_[shard_i].map;
+        int64_t items_num = 0;
+        for (const int64_t chunk : IndexRange(chunks_num)) {
+          items_num += items[chunk * shards_num + shard_i].size();
+        }
+        map.reserve(map.size() + items_num);
+        for (const int64_t chunk : IndexRange(chunks_num)) {
+          Vector<Item> &chunk_items = items[chunk * shards_num + shard_i];
+          for (Item &item : chunk_items) {
+            map.add_or_modify(
+                std::move(item.first),
+                [&](Value *value) { new (value) Value(std::move(item.second)); },
+                [&](Value *value) { merge_value_fn(*value, std::move(item.second)); });
+          }
+          /* Free memory early. */
+          chunk_items.clear_and_make_inline();
+        }
+      }
+    });
+  }
+
+  bool contains(const Key &key) const
+  {
+    return this->shard_for_key(key).map.contains(key);
+  }
+
+  const Value *lookup_ptr(const Key &key) const
+  {
+    return this->shard_for_key(key).map.lookup_ptr(key);
+  }
+
+  const Value &lookup(const Key &key) const
+  {
+    return this->shard_for_key(key).map.lookup(key);
+  }
+
+  /**
+   * Get the total number of keys. This must not be called while other threads add keys.
+   */
+  int64_t size() const
+  {
+    int64_t size = 0;
+    for (const Shard &shard : shards_) {
+      size += shard.map.size();
+    }
+    return size;
+  }
+
+  bool is_empty() const
+  {
+    return this->size() == 0;
+  }
+
+  int64_t shards_num() const
+  {
+    return shards_.size();
+  }
+
+  /**
+   * Access the hash table of a shard directly. Every key is in exactly one shard.
+   */
+  MapType &shard(const int64_t index)
+  {
+    return shards_[index].map;
+  }
+  const MapType &shard(const int64_t index) const
+  {
+    return shards_[index].map;
+  }
+
+  /**
+   * Remove all keys and free the memory of the shards in parallel.
+   */
+  void clear()
+  {
+    threading::parallel_for(shards_.index_range(), 1, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        shards_[i].map.clear();
+      }
+    });
+  }
+
+ private:
+  int64_t shard_index(const uint64_t hash) const
+  {
+    /* The hash tables in the shards mostly use the lower bits of the hash, so use other bits to
+     * choose the shard. */
+    return int64_t(((hash * 0x9E3779B97F4A7C15ull) >> 32) & shard_mask_);
+  }
+
+  Shard &shard_for_key(const Key &key)
+  {
+    return shards_[this->shard_index(hash_(key))];
+  }
+  const Shard &shard_for_key(const Key &key) const
+  {
+    return shards_[this->shard_index(hash_(key))];
+  }
+};
+
+}  // namespace blender
@@ -30,12 +30,18 @@ struct FileReader;
 typedef ssize_t (*FileReaderReadFn)(struct FileReader *reader, void *buffer, size_t size);
 typedef off64_t (*FileReaderSeekFn)(struct FileReader *reader, off64_t offset, int whence);
 typedef void (*FileReaderCloseFn)(struct FileReader *reader);
+typedef void *(*FileReaderClaimFn)(struct FileReader *reader, off64_t offset, size_t size);
 
 /** General structure for all #FileReaders, implementations add custom fields at the end. */
 typedef struct FileReader {
   FileReaderReadFn read;
   FileReaderSeekFn seek;
   FileReaderCloseFn close;
+  /**
+   * Optional, get the data at the given offset without copying it, as memory which can be freed
+   * with #MEM_freeN. May return NULL, the data then has to be read. See #BLI_mmap_claim.
+   */
+  FileReaderClaimFn claim;
 
   off64_t offset;
 } FileReader;
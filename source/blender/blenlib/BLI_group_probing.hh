@@ -0,0 +1,242 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Group probing is an alternative to the probing strategies in BLI_probing_strategies.hh, that is
+ * similar to the design of "Swiss tables". Next to the slot array, the hash table stores one
+ * control byte per slot in a separate dense array. A control byte is either empty, removed, or
+ * contains 7 bits of the hash of the key in an occupied slot.
+ *
+ * Lookups compare the control bytes of a group of 16 consecutive slots with the hash at once
+ * (using SSE2 when available) and only access the slots whose control byte matches. Most lookups
+ * therefore touch a single cache line of control bytes and the slot that contains the key, instead
+ * of one slot per probing step. This works best for large hash tables, where accessing a slot is
+ * likely a cache miss, and for keys that are expensive to compare.
+ *
+ * It is used by passing #GroupProbingStrategy as probing strategy to blender::Map or blender::Set.
+ * This costs one additional byte per slot.
+ */
+
+#include "BLI_array.hh"
+#include "BLI_math_bits.h"
+#include "BLI_simd.h"
+
+namespace blender {
+
+/**
+ * Iterates over the slots whose control byte matches the hash, one group after the other. After
+ * the matching slots of a group, the first empty slot of the group is visited, which ends the
+ * probing for hash tables that stop at empty slots. The groups are visited in a triangular
+ * sequence, which eventually visits every group of a hash table with a power-of-two size.
+ *
+ * Contrary to other probing strategies, it's not constructed from the hash alone, but by
+ * #HashTableControlBytes::probe.
+ */
+class GroupProbingStrategy {
+ public:
+  static constexpr int64_t group_size = 16;
+  static constexpr uint8_t empty = 0x80;
+  static constexpr uint8_t removed = 0xFE;
+
+ private:
+  const uint8_t *control_bytes_;
+  uint64_t mask_;
+  uint64_t group_start_;
+  uint64_t group_step_ = 0;
+  uint8_t control_byte_;
+  /**
+   * The lower 16 bits are the slots in the current group whose control byte matches, the upper
+   * bits contain the first empty slot of the group.
+   */
+  uint32_t candidates_;
+  uint64_t current_;
+
+ public:
+  GroupProbingStrategy(const uint64_t hash, const uint64_t mask, const uint8_t *control_bytes)
+      : control_bytes_(control_bytes), mask_(mask)
+  {
+    const uint64_t mixed_hash = mix_hash(hash);
+    group_start_ = (mixed_hash ^ (mixed_hash >> 32)) & mask;
+    control_byte_ = occupied_control_byte(hash);
+    this->find_candidates();
+  }
+
+  void next()
+  {
+    candidates_ &= candidates_ - 1;
+    if (candidates_ == 0) {
+      this->next_group();
+      this->find_candidates();
+      return;
+    }
+    current_ = (group_start_ + (bitscan_forward_uint(candidates_) & (group_size - 1))) & mask_;
+  }
+
+  uint64_t get() const
+  {
+    return current_;
+  }
+
+  int64_t linear_steps() const
+  {
+    return 1;
+  }
+
+  /**
+   * The control byte of a slot that contains a key with the given hash.
+   */
+  static uint8_t occupied_control_byte(const uint64_t hash)
+  {
+    /* The highest bits of the product are mixed best. */
+    return uint8_t(mix_hash(hash) >> 57);
+  }
+
+ private:
+  static uint64_t mix_hash(const uint64_t hash)
+  {
+    /* Many hash functions in Blender are the identity, spread similar values over the table. */
+    return hash * 0x9E3779B97F4A7C15ull;
+  }
+
+  void next_group()
+  {
+    group_step_ += group_size;
+    group_start_ = (group_start_ + group_step_) & mask_;
+  }
+
+  void find_candidates()
+  {
+    /* The hash table guarantees that there is at least one empty slot, so this terminates. */
+    while (true) {
+      const uint8_t *group = control_bytes_ + group_start_;
+      const uint32_t empty_slots = match_group(group, empty);
+      candidates_ = match_group(group, control_byte_) | ((empty_slots & -empty_slots) << 16);
+      if (candidates_ != 0) {
+        current_ = (group_start_ + (bitscan_forward_uint(candidates_) & (group_size - 1))) &
+                   mask_;
+        return;
+      }
+      this->next_group();
+    }
+  }
+
+  /**
+   * Bit i of the result is set when the i-th byte of the group is equal to the value.
+   */
+  static uint32_t match_group(const uint8_t *group, const uint8_t value)
+  {
+#ifdef BLI_HAVE_SSE2
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+    const __m128i matches = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(static_cast<char>(value)));
+    return static_cast<uint32_t>(_mm_movemask_epi8(matches));
+#else
+    uint32_t result = 0;
+    for (int i = 0; i < group_size; i++) {
+      result |= uint32_t(group[i] == value) << i;
+    }
+    return result;
+#endif
+  }
+};
+
+/**
+ * The control bytes of a hash table using #GroupProbingStrategy. The array is larger than the
+ * number of slots by one group (minus one byte), so that every group can be loaded at once. The
+ * additional bytes repeat the control bytes from the beginning.
+ */
+template<int64_t InlineSlots, typename Allocator> class HashTableControlBytes {
+ private:
+  static constexpr int64_t extra_bytes = GroupProbingStrategy::group_size - 1;
+
+  Array<uint8_t, InlineSlots + extra_bytes, Allocator> bytes_;
+  int64_t slots_num_;
+
+ public:
+  HashTableControlBytes(const int64_t slots_num, Allocator allocator = {})
+      : bytes_(slots_num + extra_bytes, GroupProbingStrategy::empty, allocator),
+        slots_num_(slots_num)
+  {
+  }
+
+  template<typename ProbingStrategy>
+  GroupProbingStrategy probe(const uint64_t hash, const uint64_t mask) const
+  {
+    static_assert(std::is_same_v<ProbingStrategy, GroupProbingStrategy>);
+    return GroupProbingStrategy(hash, mask, bytes_.data());
+  }
+
+  void set_occupied(const int64_t slot_index, const uint64_t hash)
+  {
+    this->set(slot_index, GroupProbingStrategy::occupied_control_byte(hash));
+  }
+
+  void set_removed(const int64_t slot_index)
+  {
+    this->set(slot_index, GroupProbingStrategy::removed);
+  }
+
+  void reinitialize(const int64_t slots_num)
+  {
+    bytes_.reinitialize(slots_num + extra_bytes);
+    bytes_.fill(GroupProbingStrategy::empty);
+    slots_num_ = slots_num;
+  }
+
+  int64_t size_in_bytes() const
+  {
+    return bytes_.size();
+  }
+
+ private:
+  void set(const int64_t slot_index, const uint8_t control_byte)
+  {
+    /* Also update the repeated bytes. Small tables may repeat every byte multiple times. */
+    for (int64_t i = slot_index; i < bytes_.size(); i += slots_num_) {
+      bytes_[i] = control_byte;
+    }
+  }
+};
+
+/**
+ * Used by hash tables with other probing strategies, which don't need control bytes.
+ */
+class NoHashTableControlBytes {
+ public:
+  template<typename Allocator> NoHashTableControlBytes(const int64_t /*slots_num*/, Allocator)
+  {
+  }
+
+  template<typename ProbingStrategy>
+  ProbingStrategy probe(const uint64_t hash, const uint64_t /*mask*/) const
+  {
+    return ProbingStrategy(hash);
+  }
+
+  void set_occupied(const int64_t /*slot_index*/, const uint64_t /*hash*/)
+  {
+  }
+
+  void set_removed(const int64_t /*slot_index*/)
+  {
+  }
+
+  void reinitialize(const int64_t /*slots_num*/)
+  {
+  }
+
+  int64_t size_in_bytes() const
+  {
+    return 0;
+  }
+};
+
+template<typename ProbingStrategy, int64_t InlineSlots, typename Allocator>
+using HashTableControlBytesFor =
+    std::conditional_t<std::is_same_v<ProbingStrategy, GroupProbingStrategy>,
+                       HashTableControlBytes<InlineSlots, Allocator>,
+                       NoHashTableControlBytes>;
+
+}  // namespace blender
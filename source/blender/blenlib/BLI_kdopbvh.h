@@ -226,6 +226,24 @@ int BLI_bvhtree_find_nearest(BVHTree *tree,
                              BVHTree_NearestPointCallback callback,
                              void *userdata);
 
+/**
+ * Find the nearest node for every coordinate, with the same result as calling
+ * #BLI_bvhtree_find_nearest_ex for each of them. The queries are processed in parallel, ordered
+ * along a space filling curve, and every query starts with the distance to the result of the
+ * previous one as upper bound. That is much faster when many coordinates are close together.
+ *
+ * \param r_nearest: The result for every coordinate. Like in #BLI_bvhtree_find_nearest_ex, the
+ * index and distance have to be initialized (e.g. to -1 and #FLT_MAX) and only nodes closer than
+ * the initial distance are found. The callback must be thread-safe.
+ */
+void BLI_bvhtree_find_nearest_batch(BVHTree *tree,
+                                    const float (*co)[3],
+                                    int co_num,
+                                    BVHTreeNearest *r_nearest,
+                                    BVHTree_NearestPointCallback callback,
+                                    void *userdata,
+                                    int flag);
+
 /**
  * Find the first node nearby.
  * Favors speed over quality since it doesn't find the best target node.
@@ -53,6 +53,21 @@ void BLI_kdtree_nd_(range_search_cb)(
     bool (*search_cb)(void *user_data, int index, const float co[KD_DIMS], float dist_sq),
     void *user_data);
 
+/** Batched versions of the queries, which search around many coordinates in parallel. */
+void BLI_kdtree_nd_(find_nearest_batch)(const KDTree *tree,
+                                        const float (*co)[KD_DIMS],
+                                        int co_len,
+                                        int *r_index,
+                                        KDTreeNearest *r_nearest) ATTR_NONNULL(1);
+void BLI_kdtree_nd_(range_search_batch_cb)(
+    const KDTree *tree,
+    const float (*co)[KD_DIMS],
+    int co_len,
+    float range,
+    bool (*search_cb)(
+        void *user_data, int co_index, int index, const float co[KD_DIMS], float dist_sq),
+    void *user_data) ATTR_NONNULL(1, 5);
+
 int BLI_kdtree_nd_(calc_duplicates_fast)(const KDTree *tree,
                                          float range,
                                          bool use_index_order,
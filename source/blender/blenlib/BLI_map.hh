@@ -30,7 +30,8 @@
  * - Key and Value must be movable types.
  * - Pointers to keys and values might be invalidated when the map is changed or moved.
  * - The hash function can be customized. See BLI_hash.hh for details.
- * - The probing strategy can be customized. See BLI_probing_strategies.hh for details.
+ * - The probing strategy can be customized. See BLI_probing_strategies.hh for details. Large maps
+ *   can benefit from #GroupProbingStrategy, see BLI_group_probing.hh.
  * - The slot type can be customized. See BLI_map_slots.hh for details.
  * - Small buffer optimization is enabled by default, if Key and Value are not too large.
  * - The methods `add_new` and `remove_contained` should be used instead of `add` and `remove`
@@ -56,6 +57,7 @@
 #include <unordered_map>
 
 #include "BLI_array.hh"
+#include "BLI_group_probing.hh"
 #include "BLI_hash.hh"
 #include "BLI_hash_tables.hh"
 #include "BLI_map_slots.hh"
@@ -80,7 +82,8 @@ template<
      */
     int64_t InlineBufferCapacity = default_inline_buffer_capacity(sizeof(Key) + sizeof(Value)),
     /**
-     * The strategy used to deal with collisions. They are defined in BLI_probing_strategies.hh.
+     * The strategy used to deal with collisions. They are defined in BLI_probing_strategies.hh
+     * and BLI_group_probing.hh.
      */
     typename ProbingStrategy = DefaultProbingStrategy,
     /**
@@ -142,6 +145,16 @@ class Map {
       Array<Slot, LoadFactor::compute_total_slots(InlineBufferCapacity, LOAD_FACTOR), Allocator>;
 #undef LOAD_FACTOR
 
+  /**
+   * Additional state per slot used by some probing strategies. It has to be updated whenever a
+   * slot is occupied or removed. For most probing strategies this is empty, it's declared before
+   * the slots so that it fits into the padding after the load factor then.
+   */
+  using ControlBytes = HashTableControlBytesFor<ProbingStrategy,
+                                                SlotArray::inline_buffer_capacity(),
+                                                Allocator>;
+  ControlBytes control_bytes_;
+
   /**
    * This is the array that contains the actual slots. There is always at least one empty slot and
    * the size of the array is a power of two.
@@ -150,7 +163,9 @@ class Map {
 
   /** Iterate over a slot index sequence for a given hash. */
 #define MAP_SLOT_PROBING_BEGIN(HASH, R_SLOT) \
-  SLOT_PROBING_BEGIN (ProbingStrategy, HASH, slot_mask_, SLOT_INDEX) \
+  SLOT_PROBING_BEGIN_EX (control_bytes_.template probe<ProbingStrategy>(HASH, slot_mask_), \
+                         slot_mask_, \
+                         SLOT_INDEX) \
     auto &R_SLOT = slots_[SLOT_INDEX];
 #define MAP_SLOT_PROBING_END() SLOT_PROBING_END()
 
@@ -167,6 +182,7 @@ class Map {
         slot_mask_(0),
         hash_(),
         is_equal_(),
+        control_bytes_(1, allocator),
         slots_(1, allocator)
   {
   }
@@ -184,10 +200,12 @@ class Map {
   {
     if constexpr (std::is_nothrow_move_constructible_v<SlotArray>) {
       slots_ = std::move(other.slots_);
+      control_bytes_ = std::move(other.control_bytes_);
     }
     else {
       try {
         slots_ = std::move(other.slots_);
+        control_bytes_ = std::move(other.control_bytes_);
       }
       catch (...) {
         other.noexcept_reset();
@@ -330,8 +348,7 @@ class Map {
     if (slot == nullptr) {
       return false;
     }
-    slot->remove();
-    removed_slots_++;
+    this->remove_slot(*slot);
     return true;
   }
 
@@ -346,8 +363,7 @@ class Map {
   template<typename ForwardKey> void remove_contained_as(const ForwardKey &key)
   {
     Slot &slot = this->lookup_slot(key, hash_(key));
-    slot.remove();
-    removed_slots_++;
+    this->remove_slot(slot);
   }
 
   /**
@@ -362,8 +378,7 @@ class Map {
   {
     Slot &slot = this->lookup_slot(key, hash_(key));
     Value value = std::move(*slot.value());
-    slot.remove();
-    removed_slots_++;
+    this->remove_slot(slot);
     return value;
   }
 
@@ -382,8 +397,7 @@ class Map {
       return {};
     }
     std::optional<Value> value = std::move(*slot->value());
-    slot->remove();
-    removed_slots_++;
+    this->remove_slot(*slot);
     return value;
   }
 
@@ -407,8 +421,7 @@ class Map {
       return Value(std::forward<ForwardValue>(default_value)...);
     }
     Value value = std::move(*slot->value());
-    slot->remove();
-    removed_slots_++;
+    this->remove_slot(*slot);
     return value;
   }
 
@@ -882,8 +895,7 @@ class Map {
   {
     Slot &slot = iterator.current_slot();
     BLI_assert(slot.is_occupied());
-    slot.remove();
-    removed_slots_++;
+    this->remove_slot(slot);
   }
 
   /**
@@ -943,7 +955,7 @@ class Map {
    */
   int64_t size_in_bytes() const
   {
-    return static_cast<int64_t>(sizeof(Slot) * slots_.size());
+    return static_cast<int64_t>(sizeof(Slot) * slots_.size()) + control_bytes_.size_in_bytes();
   }
 
   /**
@@ -989,6 +1001,7 @@ class Map {
     if (this->size() == 0) {
       try {
         slots_.reinitialize(total_slots);
+        control_bytes_.reinitialize(total_slots);
       }
       catch (...) {
         this->noexcept_reset();
@@ -1004,13 +1017,15 @@ class Map {
     SlotArray new_slots(total_slots);
 
     try {
+      ControlBytes new_control_bytes(total_slots, slots_.allocator());
       for (Slot &slot : slots_) {
         if (slot.is_occupied()) {
-          this->add_after_grow(slot, new_slots, new_slot_mask);
+          this->add_after_grow(slot, new_slots, new_control_bytes, new_slot_mask);
           slot.remove();
         }
       }
       slots_ = std::move(new_slots);
+      control_bytes_ = std::move(new_control_bytes);
     }
     catch (...) {
       this->noexcept_reset();
@@ -1023,19 +1038,32 @@ class Map {
     slot_mask_ = new_slot_mask;
   }
 
-  void add_after_grow(Slot &old_slot, SlotArray &new_slots, uint64_t new_slot_mask)
+  void add_after_grow(Slot &old_slot,
+                      SlotArray &new_slots,
+                      ControlBytes &new_control_bytes,
+                      uint64_t new_slot_mask)
   {
     uint64_t hash = old_slot.get_hash(Hash());
-    SLOT_PROBING_BEGIN (ProbingStrategy, hash, new_slot_mask, slot_index) {
+    SLOT_PROBING_BEGIN_EX (new_control_bytes.template probe<ProbingStrategy>(hash, new_slot_mask),
+                           new_slot_mask,
+                           slot_index) {
       Slot &slot = new_slots[slot_index];
       if (slot.is_empty()) {
         slot.occupy(std::move(*old_slot.key()), hash, std::move(*old_slot.value()));
+        new_control_bytes.set_occupied(slot_index, hash);
         return;
       }
     }
     SLOT_PROBING_END();
   }
 
+  void remove_slot(Slot &slot)
+  {
+    slot.remove();
+    control_bytes_.set_removed(&slot - slots_.data());
+    removed_slots_++;
+  }
+
   void noexcept_reset() noexcept
   {
     Allocator allocator = slots_.allocator();
@@ -1053,6 +1081,7 @@ class Map {
     MAP_SLOT_PROBING_BEGIN (hash, slot) {
       if (slot.is_empty()) {
         slot.occupy(std::forward<ForwardKey>(key), hash, std::forward<ForwardValue>(value)...);
+        control_bytes_.set_occupied(SLOT_INDEX, hash);
         occupied_and_removed_slots_++;
         return;
       }
@@ -1068,6 +1097,7 @@ class Map {
     MAP_SLOT_PROBING_BEGIN (hash, slot) {
       if (slot.is_empty()) {
         slot.occupy(std::forward<ForwardKey>(key), hash, std::forward<ForwardValue>(value)...);
+        control_bytes_.set_occupied(SLOT_INDEX, hash);
         occupied_and_removed_slots_++;
         return true;
       }
@@ -1097,12 +1127,14 @@ class Map {
         if constexpr (std::is_void_v<CreateReturnT>) {
           create_value(value_ptr);
           slot.occupy_no_value(std::forward<ForwardKey>(key), hash);
+          control_bytes_.set_occupied(SLOT_INDEX, hash);
           occupied_and_removed_slots_++;
           return;
         }
         else {
           auto &&return_value = create_value(value_ptr);
           slot.occupy_no_value(std::forward<ForwardKey>(key), hash);
+          control_bytes_.set_occupied(SLOT_INDEX, hash);
           occupied_and_removed_slots_++;
           return return_value;
         }
@@ -1123,6 +1155,7 @@ class Map {
     MAP_SLOT_PROBING_BEGIN (hash, slot) {
       if (slot.is_empty()) {
         slot.occupy(std::forward<ForwardKey>(key), hash, create_value());
+        control_bytes_.set_occupied(SLOT_INDEX, hash);
         occupied_and_removed_slots_++;
         return *slot.value();
       }
@@ -1141,6 +1174,7 @@ class Map {
     MAP_SLOT_PROBING_BEGIN (hash, slot) {
       if (slot.is_empty()) {
         slot.occupy(std::forward<ForwardKey>(key), hash, std::forward<ForwardValue>(value)...);
+        control_bytes_.set_occupied(SLOT_INDEX, hash);
         occupied_and_removed_slots_++;
         return *slot.value();
       }
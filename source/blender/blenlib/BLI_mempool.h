@@ -116,6 +116,49 @@ void BLI_mempool_iternew(BLI_mempool *pool, BLI_mempool_iter *iter) ATTR_NONNULL
  */
 void *BLI_mempool_iterstep(BLI_mempool_iter *iter) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
 
+/**
+ * Thread-local allocation.
+ *
+ * Allows multiple threads to allocate and free elements of the same pool concurrently.
+ * Every thread uses its own #BLI_mempool_thread, which keeps a private list of free elements.
+ * The pool is only locked when that list runs empty (to take a batch of free elements from the
+ * pool, or to add a new chunk which is then owned by the thread) and on #BLI_mempool_thread_end.
+ *
+ * \note Elements may be freed by another thread than the one that allocated them.
+ * \note Iteration keeps working as usual, but only once all threads have ended.
+ * Elements allocated by different threads are interleaved in the iteration order.
+ * \note #BLI_mempool_len is only updated by #BLI_mempool_thread_end.
+ */
+
+/** \note Private structure. */
+typedef struct BLI_mempool_thread {
+  BLI_mempool *pool;
+  struct BLI_freenode *free;
+  struct BLI_freenode *free_tail;
+  /** Number of allocated minus freed elements. */
+  int totused;
+} BLI_mempool_thread;
+
+/**
+ * Start allocating from \a pool on the calling thread.
+ * Only the functions taking a #BLI_mempool_thread may be used for the pool until all threads
+ * called #BLI_mempool_thread_end.
+ */
+void BLI_mempool_thread_begin(BLI_mempool *pool, BLI_mempool_thread *thread) ATTR_NONNULL();
+void *BLI_mempool_thread_alloc(BLI_mempool_thread *thread)
+    ATTR_MALLOC ATTR_WARN_UNUSED_RESULT ATTR_RETURNS_NONNULL ATTR_NONNULL(1);
+void *BLI_mempool_thread_calloc(BLI_mempool_thread *thread)
+    ATTR_MALLOC ATTR_WARN_UNUSED_RESULT ATTR_RETURNS_NONNULL ATTR_NONNULL(1);
+/**
+ * Free an element from the pool, it's kept in the thread-local free list until
+ * #BLI_mempool_thread_end. Contrary to #BLI_mempool_free, chunks are never freed.
+ */
+void BLI_mempool_thread_free(BLI_mempool_thread *thread, void *addr) ATTR_NONNULL(1, 2);
+/**
+ * Give the remaining free elements back to the pool and update its number of used elements.
+ */
+void BLI_mempool_thread_end(BLI_mempool_thread *thread) ATTR_NONNULL();
+
 #ifdef __cplusplus
 }
 #endif
@@ -31,8 +31,19 @@ BLI_mmap_file *BLI_mmap_open(int fd) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
 bool BLI_mmap_read(BLI_mmap_file *file, void *dest, size_t offset, size_t length)
     ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1);
 
+/* Returns length bytes of the file at the given offset, which can be used and freed like memory
+ * from #MEM_mallocN without copying it. Modifying the memory doesn't affect the file.
+ * The #MEM_EXTERNAL_HEADER_SIZE bytes before offset are overwritten, so they can't be read
+ * anymore, and the mapping is kept until the memory is freed.
+ * All of it is read first, IO errors make the claim fail and later reads return false.
+ * IO errors once the memory is in use can't be reported, they abort the process.
+ * Returns NULL when not possible (e.g. unaligned data), the data has to be read instead. */
+void *BLI_mmap_claim(BLI_mmap_file *file, size_t offset, size_t length)
+    ATTR_WARN_UNUSED_RESULT ATTR_NONNULL(1);
+
 void *BLI_mmap_get_pointer(BLI_mmap_file *file) ATTR_WARN_UNUSED_RESULT;
 
+/* Releases the file, the mapping stays valid while claimed memory is still in use. */
 void BLI_mmap_free(BLI_mmap_file *file) ATTR_NONNULL(1);
 
 #ifdef __cplusplus
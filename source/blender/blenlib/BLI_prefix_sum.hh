@@ -0,0 +1,206 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Parallel sums and prefix sums (also known as scans), optionally computed separately for groups
+ * of values that are identified by a group index.
+ *
+ * The values are split into chunks whose size only depends on the number of values. The chunks
+ * are summed in parallel and their sums are combined in order. Therefore floating point results
+ * don't depend on the number of threads, even though they can differ slightly from a serial loop.
+ */
+
+#include "BLI_array.hh"
+#include "BLI_map.hh"
+#include "BLI_span.hh"
+#include "BLI_task.hh"
+
+namespace blender {
+
+namespace detail {
+
+/** Use more chunks than threads for load balancing, but keep the serial part small. */
+inline int64_t prefix_sum_chunk_size(const int64_t size)
+{
+  return std::max<int64_t>(4096, (size + 255) / 256);
+}
+
+/**
+ * With groups, every chunk needs a hash table for the sums of its groups, which are combined
+ * serially. Larger chunks reduce that overhead when there are many groups.
+ */
+inline int64_t grouped_prefix_sum_chunk_size(const int64_t size)
+{
+  return std::max<int64_t>(65536, (size + 63) / 64);
+}
+
+inline int64_t prefix_sum_chunks_num(const int64_t size, const int64_t chunk_size)
+{
+  return (size + chunk_size - 1) / chunk_size;
+}
+
+template<typename Fn>
+inline void foreach_prefix_sum_chunk(const int64_t size, const int64_t chunk_size, const Fn &fn)
+{
+  const int64_t chunks_num = prefix_sum_chunks_num(size, chunk_size);
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange range) {
+    for (const int64_t chunk : range) {
+      const int64_t start = chunk * chunk_size;
+      fn(chunk, IndexRange(start, std::min(chunk_size, size - start)));
+    }
+  });
+}
+
+/**
+ * Compute the sum of every group in every chunk.
+ */
+template<typename T>
+Array<Map<int, T>> grouped_chunk_sums(const Span<T> values, const Span<int> group_indices)
+{
+  const int64_t chunk_size = grouped_prefix_sum_chunk_size(values.size());
+  Array<Map<int, T>> chunk_sums(prefix_sum_chunks_num(values.size(), chunk_size));
+  foreach_prefix_sum_chunk(
+      values.size(), chunk_size, [&](const int64_t chunk, const IndexRange range) {
+        Map<int, T> &sums = chunk_sums[chunk];
+        for (const int64_t i : range) {
+          T &sum = sums.lookup_or_add_default(group_indices[i]);
+          sum = values[i] + sum;
+        }
+      });
+  return chunk_sums;
+}
+
+}  // namespace detail
+
+/**
+ * Compute the sum of all values in parallel.
+ */
+template<typename T> T parallel_sum(const Span<T> values)
+{
+  const int64_t chunk_size = detail::prefix_sum_chunk_size(values.size());
+  Array<T> chunk_sums(detail::prefix_sum_chunks_num(values.size(), chunk_size));
+  detail::foreach_prefix_sum_chunk(
+      values.size(), chunk_size, [&](const int64_t chunk, const IndexRange range) {
+        T sum = T();
+        for (const int64_t i : range) {
+          sum = values[i] + sum;
+        }
+        chunk_sums[chunk] = sum;
+      });
+  T sum = T();
+  for (const T &chunk_sum : chunk_sums) {
+    sum = chunk_sum + sum;
+  }
+  return sum;
+}
+
+/**
+ * Compute the sum of all previous values for every value. When \a inclusive is true, the value
+ * itself is included in its sum. The input and output may be the same span.
+ */
+template<typename T>
+void parallel_prefix_sum(const Span<T> values, MutableSpan<T> r_sums, const bool inclusive)
+{
+  BLI_assert(values.size() == r_sums.size());
+  const int64_t chunk_size = detail::prefix_sum_chunk_size(values.size());
+  Array<T> chunk_offsets(detail::prefix_sum_chunks_num(values.size(), chunk_size));
+  detail::foreach_prefix_sum_chunk(
+      values.size(), chunk_size, [&](const int64_t chunk, const IndexRange range) {
+        T sum = T();
+        for (const int64_t i : range) {
+          sum = values[i] + sum;
+        }
+        chunk_offsets[chunk] = sum;
+      });
+  T offset = T();
+  for (T &chunk_offset : chunk_offsets) {
+    const T chunk_sum = chunk_offset;
+    chunk_offset = offset;
+    offset = chunk_sum + offset;
+  }
+  detail::foreach_prefix_sum_chunk(
+      values.size(), chunk_size, [&](const int64_t chunk, const IndexRange range) {
+        T sum = chunk_offsets[chunk];
+        for (const int64_t i : range) {
+          const T value = values[i];
+          if (inclusive) {
+            sum = value + sum;
+            r_sums[i] = sum;
+          }
+          else {
+            r_sums[i] = sum;
+            sum = value + sum;
+          }
+        }
+      });
+}
+
+/**
+ * Like #parallel_prefix_sum, but only values with the same group index are summed. The groups
+ * don't have to be contiguous.
+ */
+template<typename T>
+void parallel_grouped_prefix_sum(const Span<T> values,
+                                 const Span<int> group_indices,
+                                 MutableSpan<T> r_sums,
+                                 const bool inclusive)
+{
+  BLI_assert(values.size() == group_indices.size());
+  BLI_assert(values.size() == r_sums.size());
+  /* The sums of the groups in every chunk are replaced by the sums of the groups in all previous
+   * chunks, which is where the prefix sums of the chunk start. */
+  Array<Map<int, T>> chunk_offsets = detail::grouped_chunk_sums(values, group_indices);
+  Map<int, T> offsets;
+  for (Map<int, T> &chunk_map : chunk_offsets) {
+    for (typename Map<int, T>::MutableItem item : chunk_map.items()) {
+      T &offset = offsets.lookup_or_add_default(item.key);
+      const T chunk_sum = item.value;
+      item.value = offset;
+      offset = chunk_sum + offset;
+    }
+  }
+  detail::foreach_prefix_sum_chunk(
+      values.size(),
+      detail::grouped_prefix_sum_chunk_size(values.size()),
+      [&](const int64_t chunk, const IndexRange range) {
+        Map<int, T> &sums = chunk_offsets[chunk];
+        for (const int64_t i : range) {
+          const T value = values[i];
+          T &sum = sums.lookup(group_indices[i]);
+          if (inclusive) {
+            sum = value + sum;
+            r_sums[i] = sum;
+          }
+          else {
+            r_sums[i] = sum;
+            sum = value + sum;
+          }
+        }
+      });
+}
+
+/**
+ * Compute the sum of the values in every group in parallel.
+ */
+template<typename T>
+Map<int, T> parallel_grouped_sum(const Span<T> values, const Span<int> group_indices)
+{
+  BLI_assert(values.size() == group_indices.size());
+  Array<Map<int, T>> chunk_sums = detail::grouped_chunk_sums(values, group_indices);
+  if (chunk_sums.is_empty()) {
+    return {};
+  }
+  Map<int, T> sums = std::move(chunk_sums[0]);
+  for (const Map<int, T> &chunk_map : chunk_sums.as_span().drop_front(1)) {
+    for (const typename Map<int, T>::Item item : chunk_map.items()) {
+      T &sum = sums.lookup_or_add_default(item.key);
+      sum = item.value + sum;
+    }
+  }
+  return sums;
+}
+
+}  // namespace blender
@@ -23,6 +23,9 @@
  * Every probing strategy has to guarantee, that every possible uint64_t is returned eventually.
  * This is necessary for correctness. If this is not the case, empty slots might not be found.
  *
+ * #GroupProbingStrategy in BLI_group_probing.hh is different, because it uses additional
+ * information stored in the hash table to skip slots that cannot contain the key.
+ *
  * The SLOT_PROBING_BEGIN and SLOT_PROBING_END macros can be used to implement a loop that iterates
  * over a probing sequence.
  *
@@ -216,7 +219,14 @@ using DefaultProbingStrategy = PythonProbingStrategy<>;
  * R_SLOT_INDEX: Name of the variable that will contain the slot index.
  */
 #define SLOT_PROBING_BEGIN(PROBING_STRATEGY, HASH, MASK, R_SLOT_INDEX) \
-  PROBING_STRATEGY probing_strategy(HASH); \
+  SLOT_PROBING_BEGIN_EX(PROBING_STRATEGY(HASH), MASK, R_SLOT_INDEX)
+
+/**
+ * Same as SLOT_PROBING_BEGIN, but the probing strategy is the result of an expression. This is
+ * used for strategies that need more than the hash, like #GroupProbingStrategy.
+ */
+#define SLOT_PROBING_BEGIN_EX(PROBING_STRATEGY_EXPR, MASK, R_SLOT_INDEX) \
+  auto probing_strategy = PROBING_STRATEGY_EXPR; \
   do { \
     int64_t linear_offset = 0; \
     uint64_t current_hash = probing_strategy.get(); \
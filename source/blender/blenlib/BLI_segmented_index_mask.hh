@@ -0,0 +1,268 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * A #SegmentedIndexMask stores a sorted set of indices (like an #IndexMask) in a compressed form,
+ * as a sorted list of segments. Every segment is either
+ * - a contiguous range of indices, which only needs a few bytes no matter how large it is, or
+ * - a small chunk of indices, stored as 16-bit offsets from the first index of the chunk.
+ *
+ * Selections are mostly made of long runs, they use much less memory than the 64-bit indices
+ * referenced by an #IndexMask (e.g. 400 MB for a selection of 50M elements). Also every range
+ * segment can be processed with the fast code path for ranges.
+ *
+ * Contrary to #IndexMask, a #SegmentedIndexMask owns its memory. Use #foreach_segment_as_mask to
+ * pass the indices to code using an #IndexMask, one segment at a time.
+ */
+
+#include "BLI_function_ref.hh"
+#include "BLI_index_mask.hh"
+#include "BLI_index_range.hh"
+#include "BLI_span.hh"
+#include "BLI_vector.hh"
+#include "BLI_virtual_array.hh"
+
+namespace blender {
+
+/**
+ * A part of a #SegmentedIndexMask. Indices are either a range, or offsets (stored as 16-bit
+ * integers) from the first index of the segment.
+ */
+class IndexMaskSegment {
+ private:
+  int64_t offset_ = 0;
+  int64_t size_ = 0;
+  /** Empty when the segment is a range. */
+  Span<int16_t> offset_indices_;
+
+ public:
+  IndexMaskSegment() = default;
+
+  IndexMaskSegment(const IndexRange range) : offset_(range.start()), size_(range.size())
+  {
+  }
+
+  IndexMaskSegment(const int64_t offset, const Span<int16_t> offset_indices)
+      : offset_(offset), size_(offset_indices.size()), offset_indices_(offset_indices)
+  {
+  }
+
+  bool is_range() const
+  {
+    return offset_indices_.is_empty();
+  }
+
+  IndexRange as_range() const
+  {
+    BLI_assert(this->is_range());
+    return IndexRange(offset_, size_);
+  }
+
+  /** The index all offset indices are relative to. */
+  int64_t offset() const
+  {
+    return offset_;
+  }
+
+  /** The indices relative to #offset, only valid when the segment is not a range. */
+  Span<int16_t> offset_indices() const
+  {
+    return offset_indices_;
+  }
+
+  int64_t size() const
+  {
+    return size_;
+  }
+
+  int64_t operator[](const int64_t n) const
+  {
+    BLI_assert(n >= 0 && n < size_);
+    return this->is_range() ? offset_ + n : offset_ + offset_indices_[n];
+  }
+
+  int64_t first() const
+  {
+    return (*this)[0];
+  }
+
+  int64_t last() const
+  {
+    return (*this)[size_ - 1];
+  }
+
+  /**
+   * Calls the given callback for every index, with code paths for ranges and offset indices.
+   */
+  template<typename CallbackT> void foreach_index(const CallbackT &callback) const
+  {
+    if (this->is_range()) {
+      for (const int64_t i : IndexRange(offset_, size_)) {
+        callback(i);
+      }
+    }
+    else {
+      const int64_t offset = offset_;
+      for (const int16_t i : offset_indices_) {
+        callback(offset + i);
+      }
+    }
+  }
+};
+
+class SegmentedIndexMask {
+ public:
+  /**
+   * The maximum number of indices in a segment which isn't a range. The difference between the
+   * first and the last index of such a segment is limited by the 16-bit offsets as well.
+   */
+  static constexpr int64_t max_segment_size = 1 << 14;
+  /** Runs of at least this many indices are stored as ranges. */
+  static constexpr int64_t min_range_size = 32;
+
+ private:
+  struct Segment {
+    int64_t offset;
+    int64_t size;
+    /** Start of the offset indices in #offset_indices_, -1 for ranges. */
+    int64_t indices_start;
+  };
+
+  Vector<Segment, 0> segments_;
+  Vector<int16_t, 0> offset_indices_;
+  int64_t size_ = 0;
+
+  friend class SegmentedIndexMaskBuilder;
+
+ public:
+  /** Creates a mask that contains no indices. */
+  SegmentedIndexMask() = default;
+
+  explicit SegmentedIndexMask(IndexRange range);
+
+  /** Creates a mask that contains the indices [0, n-1]. */
+  explicit SegmentedIndexMask(int64_t n) : SegmentedIndexMask(IndexRange(n))
+  {
+  }
+
+  /** Compress the indices referenced by the given mask. */
+  static SegmentedIndexMask from_index_mask(IndexMask mask);
+  /** Create a mask containing the indices in `universe` for which `bools` is true. */
+  static SegmentedIndexMask from_bools(IndexMask universe, const VArray<bool> &bools);
+  static SegmentedIndexMask from_bools(Span<bool> bools);
+  /**
+   * Create a mask containing the indices in `universe` for which the predicate returns true.
+   * The predicate is called for the indices in ascending order.
+   */
+  static SegmentedIndexMask from_predicate(IndexMask universe,
+                                           FunctionRef<bool(int64_t index)> predicate);
+
+  int64_t size() const
+  {
+    return size_;
+  }
+
+  bool is_empty() const
+  {
+    return size_ == 0;
+  }
+
+  /** True when all indices are stored as a single range. */
+  bool is_range() const
+  {
+    return segments_.size() == 1 && segments_[0].indices_start == -1;
+  }
+
+  IndexRange as_range() const
+  {
+    BLI_assert(this->is_range());
+    return IndexRange(segments_[0].offset, segments_[0].size);
+  }
+
+  int64_t segments_num() const
+  {
+    return segments_.size();
+  }
+
+  IndexMaskSegment segment(const int64_t segment_index) const
+  {
+    const Segment &segment = segments_[segment_index];
+    if (segment.indices_start == -1) {
+      return IndexRange(segment.offset, segment.size);
+    }
+    return {segment.offset, offset_indices_.as_span().slice(segment.indices_start, segment.size)};
+  }
+
+  int64_t first() const
+  {
+    return this->segment(0).first();
+  }
+
+  int64_t last() const
+  {
+    return this->segment(segments_.size() - 1).last();
+  }
+
+  /**
+   * Returns the minimum size an array has to have, if the indices are going to be used as
+   * indices in that array.
+   */
+  int64_t min_array_size() const
+  {
+    return this->is_empty() ? 0 : this->last() + 1;
+  }
+
+  /** The number of bytes used to store the indices. */
+  int64_t memory_size() const
+  {
+    return segments_.size() * int64_t(sizeof(Segment)) +
+           offset_indices_.size() * int64_t(sizeof(int16_t));
+  }
+
+  /**
+   * Calls the given callback with every #IndexMaskSegment, in ascending order.
+   */
+  template<typename CallbackT> void foreach_segment(const CallbackT &callback) const
+  {
+    for (const int64_t i : segments_.index_range()) {
+      callback(this->segment(i));
+    }
+  }
+
+  /**
+   * Calls the given callback for every index, in ascending order. Every segment is processed
+   * with the code path for ranges or for offset indices.
+   */
+  template<typename CallbackT> void foreach_index(const CallbackT &callback) const
+  {
+    this->foreach_segment(
+        [&](const IndexMaskSegment &segment) { segment.foreach_index(callback); });
+  }
+
+  /**
+   * Calls the given callback with an #IndexMask for every segment, in ascending order.
+   * Range segments are passed as range, the indices of the other segments are only expanded to
+   * 64-bit integers one segment at a time, so the memory needed for that stays small.
+   */
+  void foreach_segment_as_mask(FunctionRef<void(IndexMask mask)> callback) const;
+
+  /**
+   * Same as #foreach_segment_as_mask, but the segments are processed in parallel.
+   * Consecutive segments are grouped to reduce the overhead when they are small.
+   */
+  void foreach_segment_as_mask_parallel(int64_t grain_size,
+                                        FunctionRef<void(IndexMask mask)> callback) const;
+
+  /** Copy all indices into the given span, which must have the same size as the mask. */
+  void to_indices(MutableSpan<int64_t> r_indices) const;
+  /**
+   * Get an #IndexMask with the same indices, either a range, or referencing the indices
+   * stored in `r_indices`.
+   */
+  IndexMask to_index_mask(Vector<int64_t> &r_indices) const;
+};
+
+}  // namespace blender
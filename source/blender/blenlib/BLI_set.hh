@@ -29,7 +29,8 @@
  * - Key must be a movable type.
  * - Pointers to keys might be invalidated when the set is changed or moved.
  * - The hash function can be customized. See BLI_hash.hh for details.
- * - The probing strategy can be customized. See BLI_probing_stragies.hh for details.
+ * - The probing strategy can be customized. See BLI_probing_stragies.hh for details. Large sets
+ *   can benefit from #GroupProbingStrategy, see BLI_group_probing.hh.
  * - The slot type can be customized. See BLI_set_slots.hh for details.
  * - Small buffer optimization is enabled by default, if the key is not too large.
  * - The methods `add_new` and `remove_contained` should be used instead of `add` and `remove`
@@ -58,6 +59,7 @@
 #include <unordered_set>
 
 #include "BLI_array.hh"
+#include "BLI_group_probing.hh"
 #include "BLI_hash.hh"
 #include "BLI_hash_tables.hh"
 #include "BLI_probing_strategies.hh"
@@ -148,6 +150,16 @@ class Set {
       Array<Slot, LoadFactor::compute_total_slots(InlineBufferCapacity, LOAD_FACTOR), Allocator>;
 #undef LOAD_FACTOR
 
+  /**
+   * Additional state per slot used by some probing strategies. It has to be updated whenever a
+   * slot is occupied or removed. For most probing strategies this is empty, it's declared before
+   * the slots so that it fits into the padding after the load factor then.
+   */
+  using ControlBytes = HashTableControlBytesFor<ProbingStrategy,
+                                                SlotArray::inline_buffer_capacity(),
+                                                Allocator>;
+  ControlBytes control_bytes_;
+
   /**
    * This is the array that contains the actual slots. There is always at least one empty slot and
    * the size of the array is a power of two.
@@ -156,7 +168,9 @@ class Set {
 
   /** Iterate over a slot index sequence for a given hash. */
 #define SET_SLOT_PROBING_BEGIN(HASH, R_SLOT) \
-  SLOT_PROBING_BEGIN (ProbingStrategy, HASH, slot_mask_, SLOT_INDEX) \
+  SLOT_PROBING_BEGIN_EX (control_bytes_.template probe<ProbingStrategy>(HASH, slot_mask_), \
+                         slot_mask_, \
+                         SLOT_INDEX) \
     auto &R_SLOT = slots_[SLOT_INDEX];
 #define SET_SLOT_PROBING_END() SLOT_PROBING_END()
 
@@ -171,6 +185,7 @@ class Set {
         occupied_and_removed_slots_(0),
         usable_slots_(0),
         slot_mask_(0),
+        control_bytes_(1, allocator),
         slots_(1, allocator)
   {
   }
@@ -201,10 +216,12 @@ class Set {
   {
     if constexpr (std::is_nothrow_move_constructible_v<SlotArray>) {
       slots_ = std::move(other.slots_);
+      control_bytes_ = std::move(other.control_bytes_);
     }
     else {
       try {
         slots_ = std::move(other.slots_);
+        control_bytes_ = std::move(other.control_bytes_);
       }
       catch (...) {
         other.noexcept_reset();
@@ -489,6 +506,7 @@ class Set {
     Slot &slot = const_cast<Slot &>(iterator.current_slot());
     BLI_assert(slot.is_occupied());
     slot.remove();
+    control_bytes_.set_removed(&slot - slots_.data());
     removed_slots_++;
   }
 
@@ -574,7 +592,7 @@ class Set {
    */
   int64_t size_in_bytes() const
   {
-    return sizeof(Slot) * slots_.size();
+    return sizeof(Slot) * slots_.size() + control_bytes_.size_in_bytes();
   }
 
   /**
@@ -629,6 +647,7 @@ class Set {
     if (this->size() == 0) {
       try {
         slots_.reinitialize(total_slots);
+        control_bytes_.reinitialize(total_slots);
       }
       catch (...) {
         this->noexcept_reset();
@@ -645,13 +664,15 @@ class Set {
     SlotArray new_slots(total_slots);
 
     try {
+      ControlBytes new_control_bytes(total_slots, slots_.allocator());
       for (Slot &slot : slots_) {
         if (slot.is_occupied()) {
-          this->add_after_grow(slot, new_slots, new_slot_mask);
+          this->add_after_grow(slot, new_slots, new_control_bytes, new_slot_mask);
           slot.remove();
         }
       }
       slots_ = std::move(new_slots);
+      control_bytes_ = std::move(new_control_bytes);
     }
     catch (...) {
       this->noexcept_reset();
@@ -664,14 +685,20 @@ class Set {
     slot_mask_ = new_slot_mask;
   }
 
-  void add_after_grow(Slot &old_slot, SlotArray &new_slots, const uint64_t new_slot_mask)
+  void add_after_grow(Slot &old_slot,
+                      SlotArray &new_slots,
+                      ControlBytes &new_control_bytes,
+                      const uint64_t new_slot_mask)
   {
     const uint64_t hash = old_slot.get_hash(Hash());
 
-    SLOT_PROBING_BEGIN (ProbingStrategy, hash, new_slot_mask, slot_index) {
+    SLOT_PROBING_BEGIN_EX (new_control_bytes.template probe<ProbingStrategy>(hash, new_slot_mask),
+                           new_slot_mask,
+                           slot_index) {
       Slot &slot = new_slots[slot_index];
       if (slot.is_empty()) {
         slot.occupy(std::move(*old_slot.key()), hash);
+        new_control_bytes.set_occupied(slot_index, hash);
         return;
       }
     }
@@ -739,6 +766,7 @@ class Set {
     SET_SLOT_PROBING_BEGIN (hash, slot) {
       if (slot.is_empty()) {
         slot.occupy(std::forward<ForwardKey>(key), hash);
+        control_bytes_.set_occupied(SLOT_INDEX, hash);
         occupied_and_removed_slots_++;
         return;
       }
@@ -753,6 +781,7 @@ class Set {
     SET_SLOT_PROBING_BEGIN (hash, slot) {
       if (slot.is_empty()) {
         slot.occupy(std::forward<ForwardKey>(key), hash);
+        control_bytes_.set_occupied(SLOT_INDEX, hash);
         occupied_and_removed_slots_++;
         return true;
       }
@@ -768,6 +797,7 @@ class Set {
     SET_SLOT_PROBING_BEGIN (hash, slot) {
       if (slot.contains(key, is_equal_, hash)) {
         slot.remove();
+        control_bytes_.set_removed(SLOT_INDEX);
         removed_slots_++;
         return true;
       }
@@ -786,6 +816,7 @@ class Set {
     SET_SLOT_PROBING_BEGIN (hash, slot) {
       if (slot.contains(key, is_equal_, hash)) {
         slot.remove();
+        control_bytes_.set_removed(SLOT_INDEX);
         removed_slots_++;
         return;
       }
@@ -804,6 +835,7 @@ class Set {
       }
       if (slot.is_empty()) {
         slot.occupy(std::forward<ForwardKey>(key), hash);
+        control_bytes_.set_occupied(SLOT_INDEX, hash);
         occupied_and_removed_slots_++;
         return *slot.key();
       }
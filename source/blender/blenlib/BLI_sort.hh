@@ -0,0 +1,389 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Parallel sorting algorithms.
+ *
+ * - #parallel_sort is an unstable comparison sort, like `std::sort`.
+ * - #parallel_stable_sort is a stable comparison sort, like `std::stable_sort`. It sorts chunks of
+ *   the input in parallel and merges them, splitting large merges into independent tasks.
+ * - #parallel_radix_sort is a stable least significant digit radix sort for integer and floating
+ *   point keys. Its run-time is linear in the number of elements, which makes it the fastest
+ *   choice for large arrays whose order is defined by a number.
+ *
+ * - #parallel_nth_value finds the value that would be at a given index after sorting, without
+ *   sorting or copying the values. This is a radix select that counts the digits of the keys in
+ *   parallel.
+ *
+ * Small inputs are sorted on the calling thread.
+ */
+
+#ifdef WITH_TBB
+/* Quiet top level deprecation message, unrelated to API usage here. */
+#  if defined(WIN32) && !defined(NOMINMAX)
+/* TBB includes Windows.h which will define min/max macros causing issues
+ * when we try to use std::min and std::max later on. */
+#    define NOMINMAX
+#    define TBB_MIN_MAX_CLEANUP
+#  endif
+#  include <tbb/parallel_sort.h>
+#  ifdef WIN32
+#    ifdef TBB_MIN_MAX_CLEANUP
+#      undef NOMINMAX
+#    endif
+#  endif
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+#include "BLI_array.hh"
+#include "BLI_span.hh"
+#include "BLI_task.hh"
+
+namespace blender {
+
+template<typename RandomAccessIterator, typename Compare>
+void parallel_sort(RandomAccessIterator begin, RandomAccessIterator end, const Compare &comp)
+{
+#ifdef WITH_TBB
+  tbb::parallel_sort(begin, end, comp);
+#else
+  std::sort(begin, end, comp);
+#endif
+}
+
+template<typename RandomAccessIterator>
+void parallel_sort(RandomAccessIterator begin, RandomAccessIterator end)
+{
+  parallel_sort(begin, end, std::less<>());
+}
+
+namespace detail {
+
+/** Inputs smaller than this are sorted without threading. */
+constexpr int64_t sort_grain_size = 4096;
+
+/**
+ * Stably merge two sorted ranges into \a dst. Large merges are split into two independent
+ * merges, by finding the position of the middle element of the larger range in the other one.
+ */
+template<typename T, typename Compare>
+void parallel_merge(MutableSpan<T> a, MutableSpan<T> b, MutableSpan<T> dst, const Compare &comp)
+{
+  BLI_assert(a.size() + b.size() == dst.size());
+  if (dst.size() <= sort_grain_size) {
+    std::merge(std::make_move_iterator(a.begin()),
+               std::make_move_iterator(a.end()),
+               std::make_move_iterator(b.begin()),
+               std::make_move_iterator(b.end()),
+               dst.begin(),
+               comp);
+    return;
+  }
+  int64_t a_split;
+  int64_t b_split;
+  if (a.size() >= b.size()) {
+    /* Elements of `b` that are equal to the split element have to stay behind it. */
+    a_split = a.size() / 2;
+    b_split = std::lower_bound(b.begin(), b.end(), a[a_split], comp) - b.begin();
+  }
+  else {
+    /* Elements of `a` that are equal to the split element have to stay in front of it. */
+    b_split = b.size() / 2;
+    a_split = std::upper_bound(a.begin(), a.end(), b[b_split], comp) - a.begin();
+  }
+  const int64_t dst_split = a_split + b_split;
+  threading::parallel_invoke(
+      [&]() {
+        parallel_merge(
+            a.take_front(a_split), b.take_front(b_split), dst.take_front(dst_split), comp);
+      },
+      [&]() {
+        parallel_merge(
+            a.drop_front(a_split), b.drop_front(b_split), dst.drop_front(dst_split), comp);
+      });
+}
+
+/**
+ * Maps a key to an unsigned integer of the same size with the same order.
+ */
+template<typename Key> inline auto radix_sort_unsigned_key(const Key key)
+{
+  static_assert(std::is_arithmetic_v<Key>, "Radix sort requires an integer or float key");
+  if constexpr (std::is_floating_point_v<Key>) {
+    using UInt = std::conditional_t<sizeof(Key) == 4, uint32_t, uint64_t>;
+    static_assert(sizeof(Key) == sizeof(UInt));
+    UInt bits;
+    memcpy(&bits, &key, sizeof(Key));
+    constexpr UInt sign_bit = UInt(1) << (sizeof(UInt) * 8 - 1);
+    /* Negative values are ordered reversed, so all their bits are flipped. */
+    return (bits & sign_bit) ? UInt(~bits) : UInt(bits | sign_bit);
+  }
+  else if constexpr (std::is_signed_v<Key>) {
+    using UInt = std::make_unsigned_t<Key>;
+    constexpr UInt sign_bit = UInt(1) << (sizeof(UInt) * 8 - 1);
+    return UInt(UInt(key) ^ sign_bit);
+  }
+  else {
+    return key;
+  }
+}
+
+/**
+ * The inverse of #radix_sort_unsigned_key.
+ */
+template<typename Key, typename UInt> inline Key radix_sort_key_from_unsigned(const UInt ukey)
+{
+  static_assert(sizeof(Key) == sizeof(UInt));
+  constexpr UInt sign_bit = UInt(1) << (sizeof(UInt) * 8 - 1);
+  if constexpr (std::is_floating_point_v<Key>) {
+    const UInt bits = (ukey & sign_bit) ? UInt(ukey ^ sign_bit) : UInt(~ukey);
+    Key key;
+    memcpy(&key, &bits, sizeof(Key));
+    return key;
+  }
+  else if constexpr (std::is_signed_v<Key>) {
+    return Key(UInt(ukey ^ sign_bit));
+  }
+  else {
+    return ukey;
+  }
+}
+
+}  // namespace detail
+
+/**
+ * Sort the values stably. Like `std::stable_sort`, but the array is split into chunks that are
+ * sorted and merged in parallel. The type has to be default constructible, because a buffer of
+ * the same size is used for merging.
+ */
+template<typename T, typename Compare>
+void parallel_stable_sort(MutableSpan<T> values, const Compare &comp)
+{
+  using namespace detail;
+  const int64_t size = values.size();
+  if (size <= sort_grain_size * 2) {
+    std::stable_sort(values.begin(), values.end(), comp);
+    return;
+  }
+  const int64_t chunk_size = std::max(sort_grain_size, size / 64);
+  const int64_t chunks_num = (size + chunk_size - 1) / chunk_size;
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange range) {
+    for (const int64_t chunk : range) {
+      MutableSpan<T> chunk_values = values.slice(
+          chunk * chunk_size, std::min(chunk_size, size - chunk * chunk_size));
+      std::stable_sort(chunk_values.begin(), chunk_values.end(), comp);
+    }
+  });
+
+  /* Merge neighboring runs until there is only one left. */
+  Array<T> buffer(size);
+  MutableSpan<T> src = values;
+  MutableSpan<T> dst = buffer;
+  for (int64_t run_size = chunk_size; run_size < size; run_size *= 2) {
+    const int64_t pairs_num = (size + run_size * 2 - 1) / (run_size * 2);
+    threading::parallel_for(IndexRange(pairs_num), 1, [&](const IndexRange range) {
+      for (const int64_t pair : range) {
+        const int64_t start = pair * run_size * 2;
+        const int64_t a_size = std::min(run_size, size - start);
+        const int64_t b_size = std::min(run_size, size - start - a_size);
+        detail::parallel_merge(src.slice(start, a_size),
+                               src.slice(start + a_size, b_size),
+                               dst.slice(start, a_size + b_size),
+                               comp);
+      }
+    });
+    std::swap(src, dst);
+  }
+  if (src.data() != values.data()) {
+    threading::parallel_for(IndexRange(size), sort_grain_size, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        values[i] = std::move(src[i]);
+      }
+    });
+  }
+}
+
+template<typename T> void parallel_stable_sort(MutableSpan<T> values)
+{
+  parallel_stable_sort(values, std::less<>());
+}
+
+/**
+ * Sort the values stably by a key, that is computed for every value by `get_key(value)`. The key
+ * has to be an integer or floating point number. Negative zero is sorted before positive zero,
+ * NaN values are sorted to the beginning or the end depending on their sign.
+ *
+ * The values are moved into a buffer and back multiple times, one pass for every byte of the key.
+ * Passes in which all keys have the same byte are skipped. Every pass counts the keys of chunks in
+ * parallel and then moves the values of every chunk to their new position in parallel.
+ */
+template<typename T, typename GetKeyFn>
+void parallel_radix_sort(MutableSpan<T> values, const GetKeyFn &get_key)
+{
+  using namespace detail;
+  const int64_t size = values.size();
+  if (size <= sort_grain_size) {
+    std::stable_sort(values.begin(), values.end(), [&](const T &a, const T &b) {
+      return radix_sort_unsigned_key(get_key(a)) < radix_sort_unsigned_key(get_key(b));
+    });
+    return;
+  }
+  using Key = decltype(radix_sort_unsigned_key(get_key(values[0])));
+  constexpr int digit_bits = 8;
+  constexpr int64_t digits_num = int64_t(1) << digit_bits;
+  constexpr int passes_num = sizeof(Key) * 8 / digit_bits;
+
+  /* Use more chunks than threads for load balancing, but not so many that the counts of all
+   * chunks don't fit into the cache anymore. */
+  const int64_t chunk_size = std::max(sort_grain_size, size / 256);
+  const int64_t chunks_num = (size + chunk_size - 1) / chunk_size;
+  auto chunk_range = [&](const int64_t chunk) {
+    return IndexRange(chunk * chunk_size, std::min(chunk_size, size - chunk * chunk_size));
+  };
+
+  /* The number of keys in every chunk with every digit. Later the position of the next value in
+   * the chunk with that digit. */
+  Array<int64_t> offsets(chunks_num * digits_num);
+  Array<T> buffer(size);
+  MutableSpan<T> src = values;
+  MutableSpan<T> dst = buffer;
+  for (const int pass : IndexRange(passes_num)) {
+    const int shift = pass * digit_bits;
+    auto get_digit = [&](const T &value) {
+      return int64_t((radix_sort_unsigned_key(get_key(value)) >> shift) & (digits_num - 1));
+    };
+
+    threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange range) {
+      for (const int64_t chunk : range) {
+        MutableSpan<int64_t> chunk_counts = offsets.as_mutable_span().slice(chunk * digits_num,
+                                                                            digits_num);
+        chunk_counts.fill(0);
+        for (const int64_t i : chunk_range(chunk)) {
+          chunk_counts[get_digit(src[i])]++;
+        }
+      }
+    });
+
+    /* Values with a smaller digit come first, then values from earlier chunks. */
+    int64_t offset = 0;
+    bool is_sorted_by_digit = false;
+    for (const int64_t digit : IndexRange(digits_num)) {
+      const int64_t digit_offset = offset;
+      for (const int64_t chunk : IndexRange(chunks_num)) {
+        const int64_t count = offsets[chunk * digits_num + digit];
+        offsets[chunk * digits_num + digit] = offset;
+        offset += count;
+      }
+      if (offset - digit_offset == size) {
+        is_sorted_by_digit = true;
+        break;
+      }
+    }
+    if (is_sorted_by_digit) {
+      continue;
+    }
+
+    threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange range) {
+      for (const int64_t chunk : range) {
+        int64_t *chunk_offsets = &offsets[chunk * digits_num];
+        for (const int64_t i : chunk_range(chunk)) {
+          dst[chunk_offsets[get_digit(src[i])]++] = std::move(src[i]);
+        }
+      }
+    });
+    std::swap(src, dst);
+  }
+  if (src.data() != values.data()) {
+    threading::parallel_for(IndexRange(size), sort_grain_size, [&](const IndexRange range) {
+      for (const int64_t i : range) {
+        values[i] = std::move(src[i]);
+      }
+    });
+  }
+}
+
+/**
+ * Sort integer or floating point numbers. See #parallel_radix_sort above.
+ */
+template<typename T> void parallel_radix_sort(MutableSpan<T> values)
+{
+  parallel_radix_sort(values, [](const T value) { return value; });
+}
+
+/**
+ * Find the value that would be at index \a n if the values were sorted, like `std::nth_element`
+ * but without changing the order of the values. The values have to be integer or floating point
+ * numbers, which are ordered like in #parallel_radix_sort.
+ *
+ * The key of the result is found one byte at a time, starting with the most significant one. In
+ * every pass, the bytes of all keys that start with the already known bytes are counted in
+ * parallel, so the values are read once for every byte of the key.
+ */
+template<typename T> T parallel_nth_value(const Span<T> values, int64_t n)
+{
+  using namespace detail;
+  BLI_assert(n >= 0 && n < values.size());
+  const int64_t size = values.size();
+  if (size <= sort_grain_size) {
+    Array<T> sorted_values = values;
+    std::nth_element(sorted_values.begin(),
+                     sorted_values.begin() + n,
+                     sorted_values.end(),
+                     [](const T a, const T b) {
+                       return radix_sort_unsigned_key(a) < radix_sort_unsigned_key(b);
+                     });
+    return sorted_values[n];
+  }
+  using Key = decltype(radix_sort_unsigned_key(values[0]));
+  constexpr int digit_bits = 8;
+  constexpr int64_t digits_num = int64_t(1) << digit_bits;
+  constexpr int passes_num = sizeof(Key) * 8 / digit_bits;
+
+  const int64_t chunk_size = std::max(sort_grain_size, size / 256);
+  const int64_t chunks_num = (size + chunk_size - 1) / chunk_size;
+
+  Array<int64_t> chunk_counts(chunks_num * digits_num);
+  /* The bits of the result that are known already. */
+  Key prefix = 0;
+  Key prefix_mask = 0;
+  for (int pass = passes_num - 1; pass >= 0; pass--) {
+    const int shift = pass * digit_bits;
+    threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange range) {
+      for (const int64_t chunk : range) {
+        MutableSpan<int64_t> counts = chunk_counts.as_mutable_span().slice(chunk * digits_num,
+                                                                          digits_num);
+        counts.fill(0);
+        const int64_t start = chunk * chunk_size;
+        for (const T value : values.slice(start, std::min(chunk_size, size - start))) {
+          const Key key = radix_sort_unsigned_key(value);
+          if ((key & prefix_mask) == prefix) {
+            counts[(key >> shift) & (digits_num - 1)]++;
+          }
+        }
+      }
+    });
+    /* Find the digit of the result and the index of the result among the keys with that digit. */
+    for (const int64_t digit : IndexRange(digits_num)) {
+      int64_t count = 0;
+      for (const int64_t chunk : IndexRange(chunks_num)) {
+        count += chunk_counts[chunk * digits_num + digit];
+      }
+      if (n < count) {
+        prefix |= Key(digit) << shift;
+        break;
+      }
+      n -= count;
+    }
+    prefix_mask |= Key(digits_num - 1) << shift;
+  }
+  return radix_sort_key_from_unsigned<T>(prefix);
+}
+
+}  // namespace blender
@@ -0,0 +1,162 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * A uniform grid for fixed radius neighbor queries on points.
+ *
+ * The points are sorted by the cell they are in, so the points of every cell are contiguous in
+ * memory. Only occupied cells are stored, as a sorted array of cell keys with the range of sorted
+ * points in every cell. Cell keys are ordered along the x axis first, so a row of neighboring
+ * cells along the x axis is found with a single search.
+ *
+ * Compared to a KD-tree, finding all points within a radius that is about as large as the cells
+ * needs far fewer branches and memory accesses. Building the grid is a parallel sort.
+ */
+
+#include "BLI_array.hh"
+#include "BLI_function_ref.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_span.hh"
+#include "BLI_vector.hh"
+
+namespace blender {
+
+class SpatialGrid {
+ public:
+  /** The number of bits per axis in a cell key. */
+  static constexpr int cell_bits = 21;
+  static constexpr int64_t max_cell_coord = (int64_t(1) << cell_bits) - 1;
+
+ private:
+  float3 min_;
+  float cell_size_ = 0.0f;
+  float cell_size_inv_ = 0.0f;
+
+  /** The points sorted by their cell, and their index in the original positions. */
+  Array<float3> sorted_positions_;
+  Array<int> sorted_indices_;
+
+  /** The sorted keys of all occupied cells, and where their points start in the sorted order. */
+  Array<uint64_t> cell_keys_;
+  Array<int> cell_starts_;
+
+ public:
+  SpatialGrid() = default;
+
+  /**
+   * Sort the points into cells with the given size. When the points are spread over a very large
+   * area compared to the cell size, larger cells are used, because there is a maximum number of
+   * cells along every axis. Check #cell_size in case that matters.
+   */
+  SpatialGrid(Span<float3> positions, float cell_size);
+
+  /**
+   * The cell size a grid of the given points would use, see the constructor. This only computes
+   * the bounds of the points, so it is much cheaper than building the grid.
+   */
+  static float calc_cell_size(Span<float3> positions, float cell_size);
+
+  float cell_size() const
+  {
+    return cell_size_;
+  }
+
+  int64_t points_num() const
+  {
+    return sorted_positions_.size();
+  }
+
+  int64_t cells_num() const
+  {
+    return cell_keys_.size();
+  }
+
+  /** Positions of all points, ordered by cell. Within a cell, the points keep their order. */
+  Span<float3> sorted_positions() const
+  {
+    return sorted_positions_;
+  }
+
+  /** The original index of every point in #sorted_positions. */
+  Span<int> sorted_indices() const
+  {
+    return sorted_indices_;
+  }
+
+  /** The range of sorted points in an occupied cell. */
+  IndexRange cell_points(const int64_t cell) const
+  {
+    return IndexRange(cell_starts_[cell], cell_starts_[cell + 1] - cell_starts_[cell]);
+  }
+
+  /**
+   * Call \a fn with the original index and the squared distance of every point that is at most
+   * \a radius away from \a position. The order of the calls is not defined. This can be called
+   * from multiple threads at the same time.
+   */
+  template<typename Fn>
+  void foreach_point_in_radius(const float3 &position, const float radius, const Fn &fn) const
+  {
+    if (cell_keys_.is_empty()) {
+      return;
+    }
+    const int3 min_coord = this->clamped_cell_coord(position - float3(radius));
+    const int3 max_coord = this->clamped_cell_coord(position + float3(radius));
+    const float radius_sq = radius * radius;
+    for (int z = min_coord.z; z <= max_coord.z; z++) {
+      for (int y = min_coord.y; y <= max_coord.y; y++) {
+        const IndexRange row_points = this->find_row_points(min_coord.x, max_coord.x, y, z);
+        for (const int64_t i : row_points) {
+          const float dist_sq = math::distance_squared(position, sorted_positions_[i]);
+          if (dist_sq <= radius_sq) {
+            fn(sorted_indices_[i], dist_sq);
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * Call \a fn for every occupied cell with the range of its sorted points and the ranges of
+   * the sorted points in the 27 cells around it, including the cell itself. Cells are processed
+   * in parallel, but never at the same time as another cell whose neighborhood overlaps with
+   * theirs. Therefore \a fn may change data of all points in the neighborhood without locking.
+   * The order in which the cells are processed does not depend on the number of threads.
+   */
+  void foreach_cell_neighborhood(
+      FunctionRef<void(IndexRange cell_points, Span<IndexRange> neighbor_points)> fn) const;
+
+  /**
+   * Find points that are at most \a distance away from each other, similar to
+   * #BLI_kdtree_3d_calc_duplicates_fast. A point that is not merged yet becomes the target of all
+   * unmerged points in range. The points are visited cell by cell in the order of
+   * #foreach_cell_neighborhood, so which point of a cluster becomes the target can differ from the
+   * KD-tree, but it doesn't depend on the number of threads. The distance must not be larger than
+   * the cell size.
+   *
+   * \param duplicates: The merge target for every point, in the order of the original positions.
+   * Values initialized to -1 are candidates to be merged. Setting the index to its own position
+   * prevents it from being merged, although it can still be used as a target.
+   * \returns The number of points that were merged.
+   */
+  int calc_duplicates(float distance, MutableSpan<int> duplicates) const;
+
+ private:
+  int3 clamped_cell_coord(const float3 &position) const
+  {
+    const float3 coord = (position - min_) * cell_size_inv_;
+    /* Clamping to one cell outside of the grid keeps coordinates outside of the grid empty. */
+    auto clamp_coord = [](const float value) {
+      return int(std::min(std::max(-1.0f, std::floor(value)), float(max_cell_coord + 1)));
+    };
+    return int3(clamp_coord(coord.x), clamp_coord(coord.y), clamp_coord(coord.z));
+  }
+
+  /** Find the sorted points of all cells from \a min_x to \a max_x in a row. */
+  IndexRange find_row_points(int min_x, int max_x, int y, int z) const;
+};
+
+}  // namespace blender
@@ -35,6 +35,11 @@ void BLI_hostname_get(char *buffer, size_t bufsize);
 size_t BLI_system_memory_max_in_megabytes(void);
 /** Get maximum addressable memory in megabytes (clamped to #INT_MAX). */
 int BLI_system_memory_max_in_megabytes_int(void);
+/**
+ * Get the peak resident memory of the process in bytes, this includes memory not allocated by
+ * guardedalloc like memory-mapped files. Returns 0 when it can't be determined.
+ */
+size_t BLI_system_memory_peak_resident(void);
 
 /* For `getpid`. */
 #ifdef WIN32
@@ -37,6 +37,36 @@ int BLI_task_scheduler_num_threads(void);
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Task Cancel Token
+ *
+ * Cooperative cancellation: long running work checks a token at convenient points and stops
+ * early once it is canceled. Tokens form a hierarchy, canceling a token also cancels all tokens
+ * created with it as parent, so that canceling a job also cancels the work it started.
+ *
+ * A parent token must outlive its children. All functions are thread-safe.
+ * \{ */
+
+typedef struct TaskCancelToken TaskCancelToken;
+
+TaskCancelToken *BLI_task_cancel_token_create(const TaskCancelToken *parent);
+void BLI_task_cancel_token_free(TaskCancelToken *token);
+/**
+ * Request cancellation of all work checking this token or one of its children.
+ */
+void BLI_task_cancel_token_cancel(TaskCancelToken *token);
+/**
+ * Clear the cancel state of the token, so that it can be reused for new work.
+ * Does not affect the parent tokens.
+ */
+void BLI_task_cancel_token_reset(TaskCancelToken *token);
+/**
+ * True when the token or one of its parents has been canceled. A null token is never canceled.
+ */
+bool BLI_task_cancel_token_is_canceled(const TaskCancelToken *token);
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Task Pool
  *
@@ -115,6 +145,12 @@ void BLI_task_pool_cancel(TaskPool *pool);
  */
 bool BLI_task_pool_current_canceled(TaskPool *pool);
 
+/**
+ * Skip tasks of the pool that did not start yet once \a token is canceled, running tasks can
+ * check it with #BLI_task_pool_current_canceled. The token must outlive the pool.
+ */
+void BLI_task_pool_cancel_token_set(TaskPool *pool, const TaskCancelToken *token);
+
 /**
  * Optional `userdata` pointer to pass along to run function.
  */
@@ -127,6 +163,57 @@ ThreadMutex *BLI_task_pool_user_mutex(TaskPool *pool);
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Task Arena
+ *
+ * Task arenas separate unrelated work that runs at the same time, like background jobs and
+ * interactive updates. Every arena has a name, a budget of threads that may work on it at the
+ * same time and a priority. Worker threads prefer tasks of arenas with higher priority.
+ *
+ * All work started by the function passed to #BLI_task_arena_execute stays in the arena,
+ * including parallel loops and task pools. Task pools created inside a low priority arena
+ * inherit the low priority, regardless of the priority they are created with.
+ *
+ * Without TBB, arenas only keep their name and priority and functions run directly.
+ * \{ */
+
+typedef struct TaskArena TaskArena;
+
+/**
+ * \param num_threads: Maximum number of threads working on the arena at the same time,
+ * including the thread calling #BLI_task_arena_execute. Zero or less uses all threads.
+ */
+TaskArena *BLI_task_arena_create(const char *name, int num_threads, eTaskPriority priority);
+/**
+ * Must not be called while the arena is executing work.
+ */
+void BLI_task_arena_free(TaskArena *arena);
+/**
+ * Run \a func in the arena and wait for it to finish, the calling thread takes part in the work.
+ */
+void BLI_task_arena_execute(TaskArena *arena, void (*func)(void *userdata), void *userdata);
+const char *BLI_task_arena_name(const TaskArena *arena);
+int BLI_task_arena_num_threads(const TaskArena *arena);
+eTaskPriority BLI_task_arena_priority(const TaskArena *arena);
+/**
+ * The arena the calling thread is working for, or null when it's not working for an arena
+ * created with #BLI_task_arena_create.
+ */
+TaskArena *BLI_task_arena_current(void);
+/**
+ * Work started in the arena is canceled together with \a token, see
+ * #BLI_task_cancel_token_current. The token must outlive the work executing in the arena.
+ */
+void BLI_task_arena_cancel_token_set(TaskArena *arena, const TaskCancelToken *token);
+/**
+ * The cancel token of the arena the calling thread is working for, or null when there is none.
+ * Task pools and parallel loops started from threads of a canceled arena can use it to skip
+ * work that will be thrown away anyway.
+ */
+const TaskCancelToken *BLI_task_cancel_token_current(void);
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Parallel for Routines
  * \{ */
@@ -304,6 +391,21 @@ BLI_INLINE void BLI_parallel_mempool_settings_defaults(TaskParallelSettings *set
   settings->use_threading = true;
 }
 
+/**
+ * Collect the time spent in every call site of `blender::threading::parallel_for` and
+ * `parallel_for_adaptive`, to find loops with an unfitting grain size. Times of nested loops are
+ * included in the times of the loops containing them.
+ */
+void BLI_task_parallel_profile_enable(void);
+/**
+ * Stop collecting times and discard the times collected so far.
+ */
+void BLI_task_parallel_profile_disable(void);
+/**
+ * Print the collected times per call site. Does nothing if profiling is not enabled.
+ */
+void BLI_task_parallel_profile_print(void);
+
 /**
  * Don't use this, store any thread specific data in `tls->userdata_chunk` instead.
  * Only here for code to be removed.
@@ -30,29 +30,51 @@
 #  endif
 #endif
 
+#include <algorithm>
+
 #include "BLI_index_range.hh"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 namespace blender::threading {
 
-template<typename Range, typename Function>
-void parallel_for_each(Range &range, const Function &function)
+namespace detail {
+
+/** Identifies the call site of a parallel loop for profiling. */
+struct ParallelForCallSite {
+  /** Signature of #parallel_for_call_site, which includes the name of the function type. */
+  const char *name;
+};
+
+bool parallel_for_profile_is_enabled();
+/**
+ * Add a call of a parallel loop which started at \a start_seconds (see #parallel_for_seconds) to
+ * the statistics of its call site.
+ */
+void parallel_for_profile_add(const ParallelForCallSite &call_site,
+                              int64_t iterations,
+                              int64_t grain_size,
+                              double start_seconds);
+
+/** Seconds from a monotonic clock, used to measure parallel loops. */
+double parallel_for_seconds();
+
+/**
+ * Every lambda has its own type, so there is a separate call site for every parallel loop.
+ */
+template<typename Function> const ParallelForCallSite &parallel_for_call_site()
 {
-#ifdef WITH_TBB
-  tbb::parallel_for_each(range, function);
+#ifdef _MSC_VER
+  static const ParallelForCallSite call_site = {__FUNCSIG__};
 #else
-  for (auto &value : range) {
-    function(value);
-  }
+  static const ParallelForCallSite call_site = {__PRETTY_FUNCTION__};
 #endif
+  return call_site;
 }
 
 template<typename Function>
-void parallel_for(IndexRange range, int64_t grain_size, const Function &function)
+void parallel_for_impl(IndexRange range, int64_t grain_size, const Function &function)
 {
-  if (range.size() == 0) {
-    return;
-  }
 #ifdef WITH_TBB
   /* Invoking tbb for small workloads has a large overhead. */
   if (range.size() >= grain_size) {
@@ -69,6 +91,117 @@ void parallel_for(IndexRange range, int64_t grain_size, const Function &function
   function(range);
 }
 
+/**
+ * Iterations are measured on the calling thread until they took at least this long, so that
+ * the measured time is not dominated by timer resolution and call overhead.
+ */
+constexpr double adaptive_sample_seconds = 10e-6;
+
+/**
+ * Grain size for the iterations remaining after measuring \a sampled_iterations which took
+ * \a sampled_seconds. Returns at least \a remaining_iterations when threading is not worth it.
+ */
+int64_t adaptive_grain_size(int64_t sampled_iterations,
+                            double sampled_seconds,
+                            int64_t remaining_iterations);
+
+}  // namespace detail
+
+template<typename Range, typename Function>
+void parallel_for_each(Range &range, const Function &function)
+{
+#ifdef WITH_TBB
+  tbb::parallel_for_each(range, function);
+#else
+  for (auto &value : range) {
+    function(value);
+  }
+#endif
+}
+
+template<typename Function>
+void parallel_for(IndexRange range, int64_t grain_size, const Function &function)
+{
+  if (range.size() == 0) {
+    return;
+  }
+  if (UNLIKELY(detail::parallel_for_profile_is_enabled())) {
+    const double start_seconds = detail::parallel_for_seconds();
+    detail::parallel_for_impl(range, grain_size, function);
+    detail::parallel_for_profile_add(
+        detail::parallel_for_call_site<Function>(), range.size(), grain_size, start_seconds);
+    return;
+  }
+  detail::parallel_for_impl(range, grain_size, function);
+}
+
+/**
+ * Same as #parallel_for, but the grain size is chosen at run-time. Growing chunks of the range
+ * are processed on the calling thread first, until their cost can be measured. The grain size
+ * for the remaining iterations is chosen so that every task amortizes the threading overhead.
+ * Cheap loops are split into fewer tasks than there are threads or are not threaded at all, so
+ * the number of threads working on the range follows from the measured cost as well.
+ *
+ * Use this when the cost per iteration is unknown or varies a lot between calls, for example
+ * when it depends on the size of another geometry. The function has to work on ranges of any
+ * size, also when processing the iterations out of order.
+ */
+template<typename Function> void parallel_for_adaptive(IndexRange range, const Function &function)
+{
+  if (range.size() == 0) {
+    return;
+  }
+  const double start_seconds = detail::parallel_for_seconds();
+  int64_t sampled_iterations = 0;
+  double sampled_seconds = 0.0;
+  for (int64_t sample_size = 1; sampled_iterations < range.size(); sample_size *= 2) {
+    const int64_t size = std::min(sample_size, range.size() - sampled_iterations);
+    function(range.slice(sampled_iterations, size));
+    sampled_iterations += size;
+    sampled_seconds = detail::parallel_for_seconds() - start_seconds;
+    if (sampled_seconds >= detail::adaptive_sample_seconds) {
+      break;
+    }
+  }
+
+  /* Processing the whole range on the calling thread is reported as a single chunk. */
+  int64_t grain_size = range.size();
+  const IndexRange remaining = range.slice(sampled_iterations,
+                                           range.size() - sampled_iterations);
+  if (remaining.size() != 0) {
+    grain_size = detail::adaptive_grain_size(
+        sampled_iterations, sampled_seconds, remaining.size());
+    if (grain_size >= remaining.size()) {
+      function(remaining);
+    }
+    else {
+      detail::parallel_for_impl(remaining, grain_size, function);
+    }
+  }
+
+  if (UNLIKELY(detail::parallel_for_profile_is_enabled())) {
+    detail::parallel_for_profile_add(
+        detail::parallel_for_call_site<Function>(), range.size(), grain_size, start_seconds);
+  }
+}
+
+/**
+ * Same as #parallel_for, but sub-ranges that did not start yet are skipped once \a cancel_token
+ * is canceled. Functions processing large ranges should check the token themselves as well.
+ */
+template<typename Function>
+void parallel_for(IndexRange range,
+                  int64_t grain_size,
+                  const TaskCancelToken *cancel_token,
+                  const Function &function)
+{
+  parallel_for(range, grain_size, [&](const IndexRange sub_range) {
+    if (!BLI_task_cancel_token_is_canceled(cancel_token)) {
+      function(sub_range);
+    }
+  });
+}
+
 template<typename Value, typename Function, typename Reduction>
 Value parallel_reduce(IndexRange range,
                       int64_t grain_size,
@@ -113,4 +246,13 @@ template<typename Function> void isolate_task(const Function &function)
 #endif
 }
 
+/** Run the function in the arena, see #BLI_task_arena_execute. */
+template<typename Function> void arena_execute(TaskArena *arena, const Function &function)
+{
+  BLI_task_arena_execute(
+      arena,
+      [](void *userdata) { (*static_cast<const Function *>(userdata))(); },
+      const_cast<Function *>(&function));
+}
+
 }  // namespace blender::threading
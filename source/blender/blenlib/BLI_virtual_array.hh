@@ -36,6 +36,13 @@ class GVArray;
 class GVMutableArray;
 };  // namespace fn
 
+/**
+ * Number of elements to process at once when a virtual array is processed in chunks (see
+ * #VArrayCommon::get_internal_span_or_chunk). A chunk is small enough to stay in the L1 cache.
+ */
+template<typename T>
+inline constexpr int64_t varray_chunk_size = std::max<int64_t>(4096 / int64_t(sizeof(T)), 1);
+
 /**
  * Implements the specifics of how the elements of a virtual array are accessed. It contains a
  * bunch of virtual methods that are wrapped by #VArray.
@@ -148,6 +155,49 @@ template<typename T> class VArrayImpl {
     }
   }
 
+  /**
+   * Copy the values in the given range into #r_chunk, which has the same size as the range.
+   * Contrary to #materialize, the first value of the range is written to the start of the span.
+   * This allows processing any virtual array in small chunks that stay in the cache, with a
+   * single virtual method call per chunk.
+   */
+  virtual void materialize_chunk(IndexRange range, MutableSpan<T> r_chunk) const
+  {
+    BLI_assert(range.size() == r_chunk.size());
+    T *dst = r_chunk.data();
+    if (this->is_span()) {
+      initialized_copy_n(this->get_internal_span().data() + range.start(), range.size(), dst);
+    }
+    else if (this->is_single()) {
+      initialized_fill_n(dst, range.size(), this->get_internal_single());
+    }
+    else {
+      for (const int64_t i : IndexRange(range.size())) {
+        dst[i] = this->get(range[i]);
+      }
+    }
+  }
+
+  /**
+   * Same as #materialize_chunk but #r_chunk is expected to be uninitialized.
+   */
+  virtual void materialize_chunk_to_uninitialized(IndexRange range, MutableSpan<T> r_chunk) const
+  {
+    BLI_assert(range.size() == r_chunk.size());
+    T *dst = r_chunk.data();
+    if (this->is_span()) {
+      uninitialized_copy_n(this->get_internal_span().data() + range.start(), range.size(), dst);
+    }
+    else if (this->is_single()) {
+      uninitialized_fill_n(dst, range.size(), this->get_internal_single());
+    }
+    else {
+      for (const int64_t i : IndexRange(range.size())) {
+        new (dst + i) T(this->get(range[i]));
+      }
+    }
+  }
+
   /**
    * If this virtual wraps another #GVArray, this method should assign the wrapped array to the
    * provided reference. This allows losslessly converting between generic and typed virtual
@@ -376,6 +426,22 @@ template<typename T, typename GetFunc> class VArrayImpl_For_Func final : public
     T *dst = r_span.data();
     mask.foreach_index([&](const int64_t i) { new (dst + i) T(get_func_(i)); });
   }
+
+  void materialize_chunk(IndexRange range, MutableSpan<T> r_chunk) const override
+  {
+    T *dst = r_chunk.data();
+    for (const int64_t i : IndexRange(range.size())) {
+      dst[i] = get_func_(range[i]);
+    }
+  }
+
+  void materialize_chunk_to_uninitialized(IndexRange range, MutableSpan<T> r_chunk) const override
+  {
+    T *dst = r_chunk.data();
+    for (const int64_t i : IndexRange(range.size())) {
+      new (dst + i) T(get_func_(range[i]));
+    }
+  }
 };
 
 /**
@@ -424,6 +490,25 @@ class VArrayImpl_For_DerivedSpan final : public VMutableArrayImpl<ElemT> {
     mask.foreach_index([&](const int64_t i) { new (dst + i) ElemT(GetFunc(data_[i])); });
   }
 
+  void materialize_chunk(IndexRange range, MutableSpan<ElemT> r_chunk) const override
+  {
+    ElemT *dst = r_chunk.data();
+    const StructT *src = data_ + range.start();
+    for (const int64_t i : IndexRange(range.size())) {
+      dst[i] = GetFunc(src[i]);
+    }
+  }
+
+  void materialize_chunk_to_uninitialized(IndexRange range,
+                                          MutableSpan<ElemT> r_chunk) const override
+  {
+    ElemT *dst = r_chunk.data();
+    const StructT *src = data_ + range.start();
+    for (const int64_t i : IndexRange(range.size())) {
+      new (dst + i) ElemT(GetFunc(src[i]));
+    }
+  }
+
   bool may_have_ownership() const override
   {
     return false;
@@ -742,6 +827,37 @@ template<typename T> class VArrayCommon {
     impl_->materialize_to_uninitialized(mask, r_span);
   }
 
+  /** Copy the values in the range into a span with the same size as the range. */
+  void materialize_chunk(IndexRange range, MutableSpan<T> r_chunk) const
+  {
+    BLI_assert(range.one_after_last() <= this->size());
+    BLI_assert(range.size() == r_chunk.size());
+    impl_->materialize_chunk(range, r_chunk);
+  }
+
+  void materialize_chunk_to_uninitialized(IndexRange range, MutableSpan<T> r_chunk) const
+  {
+    BLI_assert(range.one_after_last() <= this->size());
+    BLI_assert(range.size() == r_chunk.size());
+    impl_->materialize_chunk_to_uninitialized(range, r_chunk);
+  }
+
+  /**
+   * Get the values in the given range. When the virtual array is a span internally, a slice of
+   * it is returned without copying anything. Otherwise the values are copied into the start of
+   * #r_buffer, which has to be at least as large as the range.
+   */
+  Span<T> get_internal_span_or_chunk(IndexRange range, MutableSpan<T> r_buffer) const
+  {
+    BLI_assert(range.one_after_last() <= this->size());
+    if (impl_->is_span()) {
+      return impl_->get_internal_span().slice(range);
+    }
+    const MutableSpan<T> chunk = r_buffer.take_front(range.size());
+    impl_->materialize_chunk(range, chunk);
+    return chunk;
+  }
+
   /** See #GVArrayImpl::try_assign_GVArray. */
   bool try_assign_GVArray(fn::GVArray &varray) const
   {
@@ -0,0 +1,133 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ *
+ * Batched nearest point queries on a #BVHTree, see #BLI_bvhtree_find_nearest_batch.
+ */
+
+#include <cfloat>
+
+#include "BLI_array.hh"
+#include "BLI_kdopbvh.h"
+#include "BLI_math_vec_types.hh"
+#include "BLI_math_vector.hh"
+#include "BLI_sort.hh"
+#include "BLI_task.hh"
+
+namespace blender {
+
+/** Number of queries that are processed in order by one task, reusing the previous result. */
+static constexpr int64_t nearest_batch_chunk_size = 256;
+
+/* Spread the lower 10 bits of the value so that there are two zero bits between all of them. */
+static uint32_t morton_spread_bits(uint32_t value)
+{
+  value &= 0x3ffu;
+  value = (value | (value << 16)) & 0x030000ffu;
+  value = (value | (value << 8)) & 0x0300f00fu;
+  value = (value | (value << 4)) & 0x030c30c3u;
+  value = (value | (value << 2)) & 0x09249249u;
+  return value;
+}
+
+struct NearestBatchQuery {
+  /** Position of the query along a Z-order curve through the bounds of all queries. */
+  uint32_t code;
+  int index;
+};
+
+/**
+ * Sort the coordinates along a Z-order curve, so that consecutive queries are close to each other.
+ * The order of coordinates with the same code is kept.
+ */
+static Array<NearestBatchQuery> nearest_batch_order(const Span<float3> positions)
+{
+  struct Bounds {
+    float3 min;
+    float3 max;
+  };
+  const Bounds bounds = threading::parallel_reduce(
+      positions.index_range(),
+      4096,
+      Bounds{float3(FLT_MAX), float3(-FLT_MAX)},
+      [&](const IndexRange range, const Bounds &init) {
+        Bounds result = init;
+        for (const int64_t i : range) {
+          math::min_max(positions[i], result.min, result.max);
+        }
+        return result;
+      },
+      [](const Bounds &a, const Bounds &b) {
+        return Bounds{math::min(a.min, b.min), math::max(a.max, b.max)};
+      });
+
+  float3 scale;
+  for (const int axis : IndexRange(3)) {
+    const float extent = bounds.max[axis] - bounds.min[axis];
+    scale[axis] = (extent > 0.0f) ? 1023.0f / extent : 0.0f;
+  }
+
+  Array<NearestBatchQuery> queries(positions.size());
+  threading::parallel_for(positions.index_range(), 4096, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      uint32_t code = 0;
+      for (const int axis : IndexRange(3)) {
+        /* Also maps NaN to zero. */
+        const float value = (positions[i][axis] - bounds.min[axis]) * scale[axis];
+        const uint32_t cell = (value > 0.0f) ? uint32_t(std::min(value, 1023.0f)) : 0;
+        code |= morton_spread_bits(cell) << axis;
+      }
+      queries[i] = {code, int(i)};
+    }
+  });
+
+  parallel_radix_sort(queries.as_mutable_span(),
+                      [](const NearestBatchQuery &query) { return query.code; });
+  return queries;
+}
+
+}  // namespace blender
+
+void BLI_bvhtree_find_nearest_batch(BVHTree *tree,
+                                    const float (*co)[3],
+                                    const int co_num,
+                                    BVHTreeNearest *r_nearest,
+                                    BVHTree_NearestPointCallback callback,
+                                    void *userdata,
+                                    const int flag)
+{
+  using namespace blender;
+  if (co_num == 0) {
+    return;
+  }
+  const Span<float3> positions(reinterpret_cast<const float3 *>(co), co_num);
+  const Array<NearestBatchQuery> queries = nearest_batch_order(positions);
+
+  const int64_t chunks_num = (co_num + nearest_batch_chunk_size - 1) / nearest_batch_chunk_size;
+  /* The cost of a query depends on the size of the tree and the distance to it, so the grain size
+   * is chosen from the measured cost. */
+  threading::parallel_for_adaptive(IndexRange(chunks_num), [&](const IndexRange chunks) {
+    for (const int64_t chunk : chunks) {
+      const int64_t start = chunk * nearest_batch_chunk_size;
+      const IndexRange range(start, std::min(nearest_batch_chunk_size, co_num - start));
+      const BVHTreeNearest *prev_nearest = nullptr;
+      for (const int64_t i : range) {
+        const int co_index = queries[i].index;
+        BVHTreeNearest *nearest = &r_nearest[co_index];
+        if (prev_nearest && prev_nearest->index != -1) {
+          /* The previous result is a point on the geometry close to this query, so its distance
+           * is a tight upper bound that prunes most of the tree right away. */
+          const float dist_sq = math::distance_squared(positions[co_index],
+                                                       float3(prev_nearest->co));
+          if (dist_sq < nearest->dist_sq) {
+            *nearest = *prev_nearest;
+            nearest->dist_sq = dist_sq;
+          }
+        }
+        BLI_bvhtree_find_nearest_ex(tree, co[co_index], nearest, callback, userdata, flag);
+        prev_nearest = nearest;
+      }
+    }
+  });
+}
@@ -11,6 +11,7 @@
  * - Freeing chunks.
  * - Iterating over allocated chunks
  *   (optionally when using the #BLI_MEMPOOL_ALLOW_ITER flag).
+ * - Allocating from multiple threads (using #BLI_mempool_thread).
  */
 
 #include <stdlib.h>
@@ -22,6 +23,7 @@
 
 #include "BLI_mempool.h"         /* own include */
 #include "BLI_mempool_private.h" /* own include */
+#include "BLI_threads.h"
 
 #include "MEM_guardedalloc.h"
 
@@ -120,6 +122,8 @@ struct BLI_mempool {
   /** Number of elements allocated in total. */
   uint totalloc;
 #endif
+  /** Protects #BLI_mempool.chunks and #BLI_mempool.free while using #BLI_mempool_thread. */
+  SpinLock lock;
 };
 
 #define MEMPOOL_ELEM_SIZE_MIN (sizeof(void *) * 2)
@@ -169,6 +173,41 @@ static BLI_mempool_chunk *mempool_chunk_alloc(BLI_mempool *pool)
   return MEM_mallocN(sizeof(BLI_mempool_chunk) + (size_t)pool->csize, "BLI_Mempool Chunk");
 }
 
+/**
+ * Build the list of free elements of a new chunk.
+ *
+ * \return The last element of the chunk, its `next` pointer is NULL.
+ */
+static BLI_freenode *mempool_chunk_init_nodes(BLI_mempool *pool, BLI_mempool_chunk *mpchunk)
+{
+  const uint esize = pool->esize;
+  BLI_freenode *curnode = CHUNK_DATA(mpchunk);
+  uint j;
+
+  /* loop through the allocated data, building the pointer structures */
+  j = pool->pchunk;
+  if (pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+    while (j--) {
+      curnode->next = NODE_STEP_NEXT(curnode);
+      curnode->freeword = FREEWORD;
+      curnode = curnode->next;
+    }
+  }
+  else {
+    while (j--) {
+      curnode->next = NODE_STEP_NEXT(curnode);
+      curnode = curnode->next;
+    }
+  }
+
+  /* terminate the list (rewind one)
+   * will be overwritten if 'curnode' gets passed in again as 'last_tail' */
+  curnode = NODE_STEP_PREV(curnode);
+  curnode->next = NULL;
+
+  return curnode;
+}
+
 /**
  * Initialize a chunk and add into \a pool->chunks
  *
@@ -182,9 +221,7 @@ static BLI_freenode *mempool_chunk_add(BLI_mempool *pool,
                                        BLI_mempool_chunk *mpchunk,
                                        BLI_freenode *last_tail)
 {
-  const uint esize = pool->esize;
   BLI_freenode *curnode = CHUNK_DATA(mpchunk);
-  uint j;
 
   /* append */
   if (pool->chunk_tail) {
@@ -202,26 +239,7 @@ static BLI_freenode *mempool_chunk_add(BLI_mempool *pool,
     pool->free = curnode;
   }
 
-  /* loop through the allocated data, building the pointer structures */
-  j = pool->pchunk;
-  if (pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
-    while (j--) {
-      curnode->next = NODE_STEP_NEXT(curnode);
-      curnode->freeword = FREEWORD;
-      curnode = curnode->next;
-    }
-  }
-  else {
-    while (j--) {
-      curnode->next = NODE_STEP_NEXT(curnode);
-      curnode = curnode->next;
-    }
-  }
-
-  /* terminate the list (rewind one)
-   * will be overwritten if 'curnode' gets passed in again as 'last_tail' */
-  curnode = NODE_STEP_PREV(curnode);
-  curnode->next = NULL;
+  curnode = mempool_chunk_init_nodes(pool, mpchunk);
 
 #ifdef USE_TOTALLOC
   pool->totalloc += pool->pchunk;
@@ -300,6 +318,7 @@ BLI_mempool *BLI_mempool_create(uint esize, uint totelem, uint pchunk, uint flag
   pool->totalloc = 0;
 #endif
   pool->totused = 0;
+  BLI_spin_init(&pool->lock);
 
   if (totelem) {
     /* Allocate the actual chunks. */
@@ -712,9 +731,144 @@ void BLI_mempool_destroy(BLI_mempool *pool)
   VALGRIND_DESTROY_MEMPOOL(pool);
 #endif
 
+  BLI_spin_end(&pool->lock);
+
   MEM_freeN(pool);
 }
 
+void BLI_mempool_thread_begin(BLI_mempool *pool, BLI_mempool_thread *thread)
+{
+  thread->pool = pool;
+  thread->free = NULL;
+  thread->free_tail = NULL;
+  thread->totused = 0;
+}
+
+/**
+ * Fill the empty free list of \a thread, either with a batch of free elements taken from the
+ * pool, or with the elements of a new chunk.
+ */
+static void mempool_thread_refill(BLI_mempool_thread *thread)
+{
+  BLI_mempool *pool = thread->pool;
+  BLI_assert(thread->free == NULL);
+
+  BLI_spin_lock(&pool->lock);
+  if (pool->free) {
+    BLI_freenode *tail = pool->free;
+    for (uint i = 1; i < pool->pchunk && tail->next; i++) {
+      tail = tail->next;
+    }
+    thread->free = pool->free;
+    thread->free_tail = tail;
+    pool->free = tail->next;
+    tail->next = NULL;
+    BLI_spin_unlock(&pool->lock);
+    return;
+  }
+  BLI_spin_unlock(&pool->lock);
+
+  /* Only other threads are waiting for the lock, build the new chunk without it. */
+  BLI_mempool_chunk *mpchunk = mempool_chunk_alloc(pool);
+  mpchunk->next = NULL;
+  thread->free = CHUNK_DATA(mpchunk);
+  thread->free_tail = mempool_chunk_init_nodes(pool, mpchunk);
+
+  BLI_spin_lock(&pool->lock);
+  if (pool->chunk_tail) {
+    pool->chunk_tail->next = mpchunk;
+  }
+  else {
+    pool->chunks = mpchunk;
+  }
+  pool->chunk_tail = mpchunk;
+#ifdef USE_TOTALLOC
+  pool->totalloc += pool->pchunk;
+#endif
+  BLI_spin_unlock(&pool->lock);
+}
+
+void *BLI_mempool_thread_alloc(BLI_mempool_thread *thread)
+{
+  BLI_freenode *free_pop;
+
+  if (UNLIKELY(thread->free == NULL)) {
+    mempool_thread_refill(thread);
+  }
+
+  free_pop = thread->free;
+
+  if (thread->pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+    free_pop->freeword = USEDWORD;
+  }
+
+  thread->free = free_pop->next;
+  thread->totused++;
+
+#ifdef WITH_MEM_VALGRIND
+  VALGRIND_MEMPOOL_ALLOC(thread->pool, free_pop, thread->pool->esize);
+#endif
+
+  return (void *)free_pop;
+}
+
+void *BLI_mempool_thread_calloc(BLI_mempool_thread *thread)
+{
+  void *retval = BLI_mempool_thread_alloc(thread);
+  memset(retval, 0, (size_t)thread->pool->esize);
+  return retval;
+}
+
+void BLI_mempool_thread_free(BLI_mempool_thread *thread, void *addr)
+{
+  BLI_freenode *newhead = addr;
+
+#ifndef NDEBUG
+  /* Enable for debugging. */
+  if (UNLIKELY(mempool_debug_memset)) {
+    memset(addr, 255, thread->pool->esize);
+  }
+#endif
+
+  if (thread->pool->flag & BLI_MEMPOOL_ALLOW_ITER) {
+#ifndef NDEBUG
+    /* This will detect double free's. */
+    BLI_assert(newhead->freeword != FREEWORD);
+#endif
+    newhead->freeword = FREEWORD;
+  }
+
+  if (thread->free == NULL) {
+    thread->free_tail = newhead;
+  }
+  newhead->next = thread->free;
+  thread->free = newhead;
+
+  thread->totused--;
+
+#ifdef WITH_MEM_VALGRIND
+  VALGRIND_MEMPOOL_FREE(thread->pool, addr);
+#endif
+}
+
+void BLI_mempool_thread_end(BLI_mempool_thread *thread)
+{
+  BLI_mempool *pool = thread->pool;
+
+  BLI_spin_lock(&pool->lock);
+  if (thread->free) {
+    thread->free_tail->next = pool->free;
+    pool->free = thread->free;
+  }
+  BLI_assert((int)pool->totused + thread->totused >= 0);
+  pool->totused = (uint)((int)pool->totused + thread->totused);
+  BLI_spin_unlock(&pool->lock);
+
+  thread->free = NULL;
+  thread->free_tail = NULL;
+  thread->totused = 0;
+}
+
 #ifndef NDEBUG
 void BLI_mempool_set_memory_debug(void)
 {
@@ -10,6 +10,8 @@
 #include "BLI_listbase.h"
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include <string.h>
 
 #ifndef WIN32
@@ -32,6 +34,12 @@ struct BLI_mmap_file {
   /* Platform-specific handle for the mapping. */
   void *handle;
 
+  /* The mapping is kept until memory returned by #BLI_mmap_claim is freed as well. */
+  unsigned int users;
+
+  /* Number of reads in progress, IO errors outside of those can't be reported. */
+  volatile int reading;
+
   /* Flag to indicate IO errors. Needs to be volatile since it's being set from
    * within the signal handler, which is not part of the normal execution flow. */
   volatile bool io_error;
@@ -43,17 +51,19 @@ struct BLI_mmap_file {
  * To do so, we keep a list of all current FileDatas that use memory-mapped files,
  * and if a SIGBUS is caught, we check if the failed address is inside one of the
  * mapped regions.
- * If it is, we set a flag to indicate a failed read and remap the memory in
- * question to a zero-backed region in order to avoid additional signals.
+ * If it is and the file is being read, we set a flag to indicate a failed read and remap
+ * the page in question to a zero-backed region in order to avoid additional signals.
  * The code that actually reads the memory area has to check whether the flag was
- * set after it's done reading.
- * If the error occurred outside of a memory-mapped region, we call the previous
+ * set after it's done reading, and fail instead of using the zeroed data.
+ * Memory returned by #BLI_mmap_claim is used outside of reads, errors there can't be reported
+ * and are handled like errors outside of a memory-mapped region: we call the previous
  * handler if one was configured and abort the process otherwise.
  */
 
 static struct error_handler_data {
   ListBase open_mmaps;
   char configured;
+  size_t page_size;
   void (*next_handler)(int, siginfo_t *, void *);
 } error_handler = {0};
 
@@ -69,11 +79,20 @@ static void sigbus_handler(int sig, siginfo_t *siginfo, void *ptr)
 
     /* Is the address where the error occurred in this file's mapped range? */
     if (error_addr >= file->memory && error_addr < file->memory + file->length) {
+      if (file->reading == 0) {
+        fprintf(stderr, "SIGBUS handler: Error accessing data of a memory-mapped file in use\n");
+        break;
+      }
       file->io_error = true;
 
-      /* Replace the mapped memory with zeroes. */
-      const void *mapped_memory = mmap(
-          file->memory, file->length, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0);
+      /* Replace the mapped page with zeroes, the read using it fails. */
+      char *page = (char *)((uintptr_t)error_addr & ~(uintptr_t)(error_handler.page_size - 1));
+      const void *mapped_memory = mmap(page,
+                                       error_handler.page_size,
+                                       PROT_READ,
+                                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED,
+                                       -1,
+                                       0);
       if (mapped_memory == MAP_FAILED) {
         fprintf(stderr, "SIGBUS handler: Error replacing mapped file with zeros\n");
       }
@@ -108,6 +127,7 @@ static bool sigbus_handler_setup(void)
     /* Remember the previously configured handler to fall back to it if the error
      * does not belong to any of the mapped files. */
     error_handler.next_handler = oldact.sa_sigaction;
+    error_handler.page_size = (size_t)sysconf(_SC_PAGESIZE);
     error_handler.configured = 1;
   }
 
@@ -139,7 +159,8 @@ BLI_mmap_file *BLI_mmap_open(int fd)
     return NULL;
   }
 
-  /* Map the given file to memory. */
+  /* Map the given file to memory. Private, so that claimed memory can be made writable without
+   * changing the file, see #BLI_mmap_claim. */
   memory = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
   if (memory == MAP_FAILED) {
     return NULL;
@@ -166,6 +187,7 @@ BLI_mmap_file *BLI_mmap_open(int fd)
   file->memory = memory;
   file->handle = handle;
   file->length = length;
+  file->users = 1;
 
 #ifndef WIN32
   /* Register the file with the error handler. */
@@ -186,7 +208,9 @@ bool BLI_mmap_read(BLI_mmap_file *file, void *dest, size_t offset, size_t length
 #ifndef WIN32
   /* If an error occurs in this call, sigbus_handler will be called and will set
    * file->io_error to true. */
+  atomic_add_and_fetch_int32((int32_t *)&file->reading, 1);
   memcpy(dest, file->memory + offset, length);
+  atomic_sub_and_fetch_int32((int32_t *)&file->reading, 1);
 #else
   /* On Windows, we use exception handling to be notified of errors. */
   __try {
@@ -202,6 +226,56 @@ bool BLI_mmap_read(BLI_mmap_file *file, void *dest, size_t offset, size_t length
   return !file->io_error;
 }
 
+static void mmap_claim_free(void *user_data)
+{
+  BLI_mmap_free((BLI_mmap_file *)user_data);
+}
+
+void *BLI_mmap_claim(BLI_mmap_file *file, size_t offset, size_t length)
+{
+#ifndef WIN32
+  if (file->io_error || (length == 0) || (offset < MEM_EXTERNAL_HEADER_SIZE) ||
+      (offset + length > file->length)) {
+    return NULL;
+  }
+  char *memory = file->memory + offset;
+  if (((uintptr_t)memory % sizeof(void *)) != 0 || (length % 4) != 0) {
+    return NULL;
+  }
+
+  /* Read every page now, so that IO errors make the read fail instead of happening once the
+   * memory is in use. */
+  const size_t page_size = error_handler.page_size;
+  atomic_add_and_fetch_int32((int32_t *)&file->reading, 1);
+  for (size_t i = 0; i < length; i += page_size) {
+    (void)((volatile const char *)memory)[i];
+  }
+  (void)((volatile const char *)memory)[length - 1];
+  atomic_sub_and_fetch_int32((int32_t *)&file->reading, 1);
+  if (file->io_error) {
+    return NULL;
+  }
+
+  /* Only the claimed memory and the header in front of it are writable. */
+  char *page_first = (char *)((uintptr_t)(memory - MEM_EXTERNAL_HEADER_SIZE) &
+                              ~(uintptr_t)(page_size - 1));
+  if (mprotect(page_first, (size_t)(memory + length - page_first), PROT_READ | PROT_WRITE) != 0) {
+    return NULL;
+  }
+
+  atomic_add_and_fetch_u(&file->users, 1);
+  if (!MEM_external_wrap(memory, length, mmap_claim_free, file)) {
+    atomic_sub_and_fetch_u(&file->users, 1);
+    return NULL;
+  }
+  return memory;
+#else
+  /* The file can't be replaced while it's mapped, so never keep the mapping. */
+  UNUSED_VARS(file, offset, length);
+  return NULL;
+#endif
+}
+
 void *BLI_mmap_get_pointer(BLI_mmap_file *file)
 {
   return file->memory;
@@ -209,6 +283,10 @@ void *BLI_mmap_get_pointer(BLI_mmap_file *file)
 
 void BLI_mmap_free(BLI_mmap_file *file)
 {
+  if (atomic_sub_and_fetch_u(&file->users, 1) != 0) {
+    return;
+  }
+
 #ifndef WIN32
   munmap((void *)file->memory, file->length);
   sigbus_handler_remove(file);
@@ -641,6 +641,8 @@ template<typename T> void cdt_draw(const std::string &label, const CDTArrangemen
 /**
  * A filtered version of orient2d, which will usually be much faster when using exact arithmetic.
  * See EXACT GEOMETRIC COMPUTATION USING CASCADING, by Burnikel, Funke, and Seel.
+ * When the filter can't decide, the points are usually collinear, which includes the case of
+ * two of them being the same vertex. That case is known to be zero without any arithmetic.
  */
 template<typename T>
 static int filtered_orient2d(const FatCo<T> &a, const FatCo<T> &b, const FatCo<T> &c);
@@ -651,6 +653,9 @@ int filtered_orient2d<mpq_class>(const FatCo<mpq_class> &a,
                                  const FatCo<mpq_class> &b,
                                  const FatCo<mpq_class> &c)
 {
+  if (ELEM(&a, &b, &c) || &b == &c) {
+    return 0;
+  }
   double det = (a.approx[0] - c.approx[0]) * (b.approx[1] - c.approx[1]) -
                (a.approx[1] - c.approx[1]) * (b.approx[0] - c.approx[0]);
   double supremum = (a.abs_approx[0] + c.abs_approx[0]) * (b.abs_approx[1] + c.abs_approx[1]) +
@@ -674,6 +679,7 @@ int filtered_orient2d<double>(const FatCo<double> &a,
 
 /**
  * A filtered version of incircle.
+ * As with #filtered_orient2d, a repeated vertex gives zero without any arithmetic.
  */
 template<typename T>
 static int filtered_incircle(const FatCo<T> &a,
@@ -688,6 +694,9 @@ int filtered_incircle<mpq_class>(const FatCo<mpq_class> &a,
                                  const FatCo<mpq_class> &c,
                                  const FatCo<mpq_class> &d)
 {
+  if (ELEM(&d, &a, &b, &c) || ELEM(&a, &b, &c) || &b == &c) {
+    return 0;
+  }
   double adx = a.approx[0] - d.approx[0];
   double bdx = b.approx[0] - d.approx[0];
   double cdx = c.approx[0] - d.approx[0];
@@ -1172,22 +1181,23 @@ template<typename T> class SiteInfo {
 
 /**
  * Compare function for lexicographic sort: x, then y, then index.
+ * Converting an exact coordinate to its approximation is monotonic, so when the approximations
+ * differ they decide the order, and only equal approximations need an exact comparison.
  */
 template<typename T> bool site_lexicographic_sort(const SiteInfo<T> &a, const SiteInfo<T> &b)
 {
-  const vec2<T> &co_a = a.v->co.exact;
-  const vec2<T> &co_b = b.v->co.exact;
-  if (co_a[0] < co_b[0]) {
-    return true;
-  }
-  if (co_a[0] > co_b[0]) {
-    return false;
-  }
-  if (co_a[1] < co_b[1]) {
-    return true;
-  }
-  if (co_a[1] > co_b[1]) {
-    return false;
+  const FatCo<T> &co_a = a.v->co;
+  const FatCo<T> &co_b = b.v->co;
+  for (int i = 0; i < 2; ++i) {
+    if (co_a.approx[i] != co_b.approx[i]) {
+      return co_a.approx[i] < co_b.approx[i];
+    }
+    if (co_a.exact[i] < co_b.exact[i]) {
+      return true;
+    }
+    if (co_a.exact[i] > co_b.exact[i]) {
+      return false;
+    }
   }
   return a.orig_index < b.orig_index;
 }
@@ -1202,7 +1212,8 @@ template<typename T> void find_site_merges(Array<SiteInfo<T>> &sites)
   int n = sites.size();
   for (int i = 0; i < n - 1; ++i) {
     int j = i + 1;
-    while (j < n && sites[j].v->co.exact == sites[i].v->co.exact) {
+    while (j < n && sites[j].v->co.approx == sites[i].v->co.approx &&
+           sites[j].v->co.exact == sites[i].v->co.exact) {
       sites[j].v->merge_to_index = sites[i].orig_index;
       ++j;
     }
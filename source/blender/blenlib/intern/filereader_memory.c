@@ -102,6 +102,15 @@ static ssize_t memory_read_mmap(FileReader *reader, void *buffer, size_t size)
   return readsize;
 }
 
+static void *memory_claim_mmap(FileReader *reader, off64_t offset, size_t size)
+{
+  MemoryReader *mem = (MemoryReader *)reader;
+  if (offset < 0) {
+    return NULL;
+  }
+  return BLI_mmap_claim(mem->mmap, (size_t)offset, size);
+}
+
 static void memory_close_mmap(FileReader *reader)
 {
   MemoryReader *mem = (MemoryReader *)reader;
@@ -124,6 +133,7 @@ FileReader *BLI_filereader_new_mmap(int filedes)
   mem->reader.read = memory_read_mmap;
   mem->reader.seek = memory_seek;
   mem->reader.close = memory_close_mmap;
+  mem->reader.claim = memory_claim_mmap;
 
   return (FileReader *)mem;
 }
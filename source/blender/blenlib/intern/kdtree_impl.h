@@ -8,6 +8,7 @@
 
 #include "BLI_kdtree_impl.h"
 #include "BLI_math.h"
+#include "BLI_task.h"
 #include "BLI_strict_flags.h"
 #include "BLI_utildefines.h"
 
@@ -25,7 +26,7 @@ typedef struct KDTreeNode {
   uint left, right;
   float co[KD_DIMS];
   int index;
-  uint d; /* range is only (0..KD_DIMS - 1) */
+  uint d; /* range is only (0..KD_DIMS - 1), or #KD_LEAF_AXIS */
 } KDTreeNode;
 
 struct KDTree {
@@ -50,6 +51,23 @@ struct KDTree {
  */
 #define KD_NODE_ROOT_IS_INIT ((uint)-2)
 
+/**
+ * Sub-trees with at most this many nodes aren't split further. Their nodes are stored next to
+ * each other and are tested one after another without traversing the tree, which is faster than
+ * branching on every node.
+ *
+ * The first node of such a leaf bucket has its axis set to #KD_LEAF_AXIS and stores the number
+ * of nodes in the bucket in #KDTreeNode.right. The other nodes of the bucket are never traversed.
+ */
+#define KD_LEAF_SIZE 16
+#define KD_LEAF_AXIS ((uint)-1)
+
+/** Sub-trees with more nodes than this are balanced in a separate task. */
+#define KD_BALANCE_TASK_MIN 8192
+
+/** The number of query points handled by a thread at once in the batched queries. */
+#define KD_BATCH_GRAIN_SIZE 512
+
 /* -------------------------------------------------------------------- */
 /** \name Local Math API
  * \{ */
@@ -131,7 +149,29 @@ void BLI_kdtree_nd_(insert)(KDTree *tree, int index, const float co[KD_DIMS])
 #endif
 }
 
-static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs)
+typedef struct KDTreeBalanceTask {
+  KDTreeNode *nodes;
+  uint nodes_len;
+  uint axis;
+  uint ofs;
+  /** Where the index of the sub-tree root is written. */
+  uint *r_root;
+} KDTreeBalanceTask;
+
+static uint kdtree_balance(
+    KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs, TaskPool *pool);
+
+static void kdtree_balance_task(TaskPool *__restrict pool, void *taskdata)
+{
+  const KDTreeBalanceTask *task = taskdata;
+  *task->r_root = kdtree_balance(task->nodes, task->nodes_len, task->axis, task->ofs, pool);
+}
+
+/**
+ * \param pool: When not null, large sub-trees are balanced in parallel using tasks of this pool.
+ */
+static uint kdtree_balance(
+    KDTreeNode *nodes, uint nodes_len, uint axis, const uint ofs, TaskPool *pool)
 {
   KDTreeNode *node;
   float co;
@@ -140,7 +180,11 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
   if (nodes_len <= 0) {
     return KD_NODE_UNSET;
   }
-  else if (nodes_len == 1) {
+  else if (nodes_len <= KD_LEAF_SIZE) {
+    node = &nodes[0];
+    node->d = KD_LEAF_AXIS;
+    node->left = KD_NODE_UNSET;
+    node->right = nodes_len;
     return 0 + ofs;
   }
 
@@ -180,9 +224,21 @@ static uint kdtree_balance(KDTreeNode *nodes, uint nodes_len, uint axis, const u
   node = &nodes[median];
   node->d = axis;
   axis = (axis + 1) % KD_DIMS;
-  node->left = kdtree_balance(nodes, median, axis, ofs);
+  if (pool && median > KD_BALANCE_TASK_MIN) {
+    /* The sub-trees use separate parts of the array, so they can be balanced at the same time. */
+    KDTreeBalanceTask *task = MEM_mallocN(sizeof(*task), __func__);
+    task->nodes = nodes;
+    task->nodes_len = median;
+    task->axis = axis;
+    task->ofs = ofs;
+    task->r_root = &node->left;
+    BLI_task_pool_push(pool, kdtree_balance_task, task, true, NULL);
+  }
+  else {
+    node->left = kdtree_balance(nodes, median, axis, ofs, pool);
+  }
   node->right = kdtree_balance(
-      nodes + median + 1, (nodes_len - (median + 1)), axis, (median + 1) + ofs);
+      nodes + median + 1, (nodes_len - (median + 1)), axis, (median + 1) + ofs, pool);
 
   return median + ofs;
 }
@@ -196,7 +252,15 @@ void BLI_kdtree_nd_(balance)(KDTree *tree)
     }
   }
 
-  tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0);
+  if (tree->nodes_len > KD_BALANCE_TASK_MIN) {
+    TaskPool *pool = BLI_task_pool_create(NULL, TASK_PRIORITY_HIGH);
+    tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0, pool);
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+  }
+  else {
+    tree->root = kdtree_balance(tree->nodes, tree->nodes_len, 0, 0, NULL);
+  }
 
 #ifdef DEBUG
   tree->is_balanced = true;
@@ -216,6 +280,61 @@ static uint *realloc_nodes(uint *stack, uint *stack_len_capacity, const bool is_
   return stack_new;
 }
 
+/**
+ * The nearest point searches store a lower bound of the squared distance to all nodes in a
+ * sub-tree along with it. Sub-trees on the far side of a split are pushed before the near side
+ * is searched, this allows skipping them when a closer point was found in the mean time.
+ */
+typedef struct KDTreeNearestStackItem {
+  uint node;
+  float dist_sq;
+} KDTreeNearestStackItem;
+
+static KDTreeNearestStackItem *realloc_nearest_stack(KDTreeNearestStackItem *stack,
+                                                     uint *stack_len_capacity,
+                                                     const bool is_alloc)
+{
+  KDTreeNearestStackItem *stack_new = MEM_mallocN(
+      (*stack_len_capacity + KD_NEAR_ALLOC_INC) * sizeof(KDTreeNearestStackItem),
+      "KDTree.treestack");
+  memcpy(stack_new, stack, *stack_len_capacity * sizeof(KDTreeNearestStackItem));
+  if (is_alloc) {
+    MEM_freeN(stack);
+  }
+  *stack_len_capacity += KD_NEAR_ALLOC_INC;
+  return stack_new;
+}
+
+/**
+ * Push the children of \a node, the child on the same side of the split as \a co last,
+ * so it's searched first. The far child is only pushed when it may contain a point closer
+ * than \a max_dist_sq.
+ */
+static uint nearest_stack_push_children(KDTreeNearestStackItem *stack,
+                                        uint cur,
+                                        const KDTreeNode *node,
+                                        const float co[KD_DIMS],
+                                        const float node_dist_sq,
+                                        const float max_dist_sq)
+{
+  const float split_dist = co[node->d] - node->co[node->d];
+  const uint near_node = split_dist < 0.0f ? node->left : node->right;
+  const uint far_node = split_dist < 0.0f ? node->right : node->left;
+  const float far_dist_sq = max_ff(node_dist_sq, split_dist * split_dist);
+
+  if (far_node != KD_NODE_UNSET && far_dist_sq < max_dist_sq) {
+    stack[cur].node = far_node;
+    stack[cur].dist_sq = far_dist_sq;
+    cur++;
+  }
+  if (near_node != KD_NODE_UNSET) {
+    stack[cur].node = near_node;
+    stack[cur].dist_sq = node_dist_sq;
+    cur++;
+  }
+  return cur;
+}
+
 /**
  * Find nearest returns index, and -1 if no node is found.
  */
@@ -225,7 +344,7 @@ int BLI_kdtree_nd_(find_nearest)(const KDTree *tree,
 {
   const KDTreeNode *nodes = tree->nodes;
   const KDTreeNode *root, *min_node;
-  uint *stack, stack_default[KD_STACK_INIT];
+  KDTreeNearestStackItem *stack, stack_default[KD_STACK_INIT];
   float min_dist, cur_dist;
   uint stack_len_capacity, cur = 0;
 
@@ -240,68 +359,44 @@ int BLI_kdtree_nd_(find_nearest)(const KDTree *tree,
   stack = stack_default;
   stack_len_capacity = KD_STACK_INIT;
 
+  /* Use the root as fallback, so there is a result even if all distances are infinite. */
   root = &nodes[tree->root];
   min_node = root;
   min_dist = len_squared_vnvn(root->co, co);
 
-  if (co[root->d] < root->co[root->d]) {
-    if (root->right != KD_NODE_UNSET) {
-      stack[cur++] = root->right;
-    }
-    if (root->left != KD_NODE_UNSET) {
-      stack[cur++] = root->left;
-    }
-  }
-  else {
-    if (root->left != KD_NODE_UNSET) {
-      stack[cur++] = root->left;
-    }
-    if (root->right != KD_NODE_UNSET) {
-      stack[cur++] = root->right;
-    }
-  }
+  stack[cur].node = tree->root;
+  stack[cur].dist_sq = 0.0f;
+  cur++;
 
   while (cur--) {
-    const KDTreeNode *node = &nodes[stack[cur]];
-
-    cur_dist = node->co[node->d] - co[node->d];
+    const KDTreeNearestStackItem item = stack[cur];
+    const KDTreeNode *node = &nodes[item.node];
 
-    if (cur_dist < 0.0f) {
-      cur_dist = -cur_dist * cur_dist;
+    if (item.dist_sq >= min_dist) {
+      continue;
+    }
 
-      if (-cur_dist < min_dist) {
-        cur_dist = len_squared_vnvn(node->co, co);
+    if (node->d == KD_LEAF_AXIS) {
+      for (uint i = 0; i < node->right; i++) {
+        cur_dist = len_squared_vnvn(node[i].co, co);
         if (cur_dist < min_dist) {
           min_dist = cur_dist;
-          min_node = node;
-        }
-        if (node->left != KD_NODE_UNSET) {
-          stack[cur++] = node->left;
+          min_node = &node[i];
         }
       }
-      if (node->right != KD_NODE_UNSET) {
-        stack[cur++] = node->right;
-      }
+      continue;
     }
-    else {
-      cur_dist = cur_dist * cur_dist;
 
-      if (cur_dist < min_dist) {
-        cur_dist = len_squared_vnvn(node->co, co);
-        if (cur_dist < min_dist) {
-          min_dist = cur_dist;
-          min_node = node;
-        }
-        if (node->right != KD_NODE_UNSET) {
-          stack[cur++] = node->right;
-        }
-      }
-      if (node->left != KD_NODE_UNSET) {
-        stack[cur++] = node->left;
-      }
+    cur_dist = len_squared_vnvn(node->co, co);
+    if (cur_dist < min_dist) {
+      min_dist = cur_dist;
+      min_node = node;
     }
+
+    cur = nearest_stack_push_children(stack, cur, node, co, item.dist_sq, min_dist);
+
     if (UNLIKELY(cur + KD_DIMS > stack_len_capacity)) {
-      stack = realloc_nodes(stack, &stack_len_capacity, stack_default != stack);
+      stack = realloc_nearest_stack(stack, &stack_len_capacity, stack_default != stack);
     }
   }
 
@@ -335,8 +430,8 @@ int BLI_kdtree_nd_(find_nearest_cb)(
   const KDTreeNode *nodes = tree->nodes;
   const KDTreeNode *min_node = NULL;
 
-  uint *stack, stack_default[KD_STACK_INIT];
-  float min_dist = FLT_MAX, cur_dist;
+  KDTreeNearestStackItem *stack, stack_default[KD_STACK_INIT];
+  float min_dist = FLT_MAX;
   uint stack_len_capacity, cur = 0;
 
 #ifdef DEBUG
@@ -370,43 +465,31 @@ int BLI_kdtree_nd_(find_nearest_cb)(
   } \
   ((void)0)
 
-  stack[cur++] = tree->root;
+  stack[cur].node = tree->root;
+  stack[cur].dist_sq = 0.0f;
+  cur++;
 
   while (cur--) {
-    const KDTreeNode *node = &nodes[stack[cur]];
-
-    cur_dist = node->co[node->d] - co[node->d];
-
-    if (cur_dist < 0.0f) {
-      cur_dist = -cur_dist * cur_dist;
+    const KDTreeNearestStackItem item = stack[cur];
+    const KDTreeNode *node = &nodes[item.node];
 
-      if (-cur_dist < min_dist) {
-        NODE_TEST_NEAREST(node);
+    if (item.dist_sq >= min_dist) {
+      continue;
+    }
 
-        if (node->left != KD_NODE_UNSET) {
-          stack[cur++] = node->left;
-        }
-      }
-      if (node->right != KD_NODE_UNSET) {
-        stack[cur++] = node->right;
+    if (node->d == KD_LEAF_AXIS) {
+      for (uint i = 0; i < node->right; i++) {
+        NODE_TEST_NEAREST(&node[i]);
       }
+      continue;
     }
-    else {
-      cur_dist = cur_dist * cur_dist;
 
-      if (cur_dist < min_dist) {
-        NODE_TEST_NEAREST(node);
+    NODE_TEST_NEAREST(node);
+
+    cur = nearest_stack_push_children(stack, cur, node, co, item.dist_sq, min_dist);
 
-        if (node->right != KD_NODE_UNSET) {
-          stack[cur++] = node->right;
-        }
-      }
-      if (node->left != KD_NODE_UNSET) {
-        stack[cur++] = node->left;
-      }
-    }
     if (UNLIKELY(cur + KD_DIMS > stack_len_capacity)) {
-      stack = realloc_nodes(stack, &stack_len_capacity, stack_default != stack);
+      stack = realloc_nearest_stack(stack, &stack_len_capacity, stack_default != stack);
     }
   }
 
@@ -474,8 +557,7 @@ int BLI_kdtree_nd_(find_nearest_n_with_len_squared_cb)(
     const void *user_data)
 {
   const KDTreeNode *nodes = tree->nodes;
-  const KDTreeNode *root;
-  uint *stack, stack_default[KD_STACK_INIT];
+  KDTreeNearestStackItem *stack, stack_default[KD_STACK_INIT];
   float cur_dist;
   uint stack_len_capacity, cur = 0;
   uint i, nearest_len = 0;
@@ -496,76 +578,48 @@ int BLI_kdtree_nd_(find_nearest_n_with_len_squared_cb)(
   stack = stack_default;
   stack_len_capacity = ARRAY_SIZE(stack_default);
 
-  root = &nodes[tree->root];
+/* Points have to be closer than this to be inserted. */
+#define NEAREST_MAX_DIST \
+  (nearest_len < nearest_len_capacity ? FLT_MAX : r_nearest[nearest_len - 1].dist)
 
-  cur_dist = len_sq_fn(co, root->co, user_data);
-  nearest_ordered_insert(
-      r_nearest, &nearest_len, nearest_len_capacity, root->index, cur_dist, root->co);
-
-  if (co[root->d] < root->co[root->d]) {
-    if (root->right != KD_NODE_UNSET) {
-      stack[cur++] = root->right;
-    }
-    if (root->left != KD_NODE_UNSET) {
-      stack[cur++] = root->left;
-    }
-  }
-  else {
-    if (root->left != KD_NODE_UNSET) {
-      stack[cur++] = root->left;
-    }
-    if (root->right != KD_NODE_UNSET) {
-      stack[cur++] = root->right;
-    }
-  }
+  stack[cur].node = tree->root;
+  stack[cur].dist_sq = 0.0f;
+  cur++;
 
   while (cur--) {
-    const KDTreeNode *node = &nodes[stack[cur]];
-
-    cur_dist = node->co[node->d] - co[node->d];
+    const KDTreeNearestStackItem item = stack[cur];
+    const KDTreeNode *node = &nodes[item.node];
 
-    if (cur_dist < 0.0f) {
-      cur_dist = -cur_dist * cur_dist;
-
-      if (nearest_len < nearest_len_capacity || -cur_dist < r_nearest[nearest_len - 1].dist) {
-        cur_dist = len_sq_fn(co, node->co, user_data);
+    if (item.dist_sq >= NEAREST_MAX_DIST) {
+      continue;
+    }
 
-        if (nearest_len < nearest_len_capacity || cur_dist < r_nearest[nearest_len - 1].dist) {
+    if (node->d == KD_LEAF_AXIS) {
+      for (i = 0; i < node->right; i++) {
+        cur_dist = len_sq_fn(co, node[i].co, user_data);
+        if (cur_dist < NEAREST_MAX_DIST) {
           nearest_ordered_insert(
-              r_nearest, &nearest_len, nearest_len_capacity, node->index, cur_dist, node->co);
-        }
-
-        if (node->left != KD_NODE_UNSET) {
-          stack[cur++] = node->left;
+              r_nearest, &nearest_len, nearest_len_capacity, node[i].index, cur_dist, node[i].co);
         }
       }
-      if (node->right != KD_NODE_UNSET) {
-        stack[cur++] = node->right;
-      }
+      continue;
     }
-    else {
-      cur_dist = cur_dist * cur_dist;
-
-      if (nearest_len < nearest_len_capacity || cur_dist < r_nearest[nearest_len - 1].dist) {
-        cur_dist = len_sq_fn(co, node->co, user_data);
-        if (nearest_len < nearest_len_capacity || cur_dist < r_nearest[nearest_len - 1].dist) {
-          nearest_ordered_insert(
-              r_nearest, &nearest_len, nearest_len_capacity, node->index, cur_dist, node->co);
-        }
 
-        if (node->right != KD_NODE_UNSET) {
-          stack[cur++] = node->right;
-        }
-      }
-      if (node->left != KD_NODE_UNSET) {
-        stack[cur++] = node->left;
-      }
+    cur_dist = len_sq_fn(co, node->co, user_data);
+    if (cur_dist < NEAREST_MAX_DIST) {
+      nearest_ordered_insert(
+          r_nearest, &nearest_len, nearest_len_capacity, node->index, cur_dist, node->co);
     }
+
+    cur = nearest_stack_push_children(stack, cur, node, co, item.dist_sq, NEAREST_MAX_DIST);
+
     if (UNLIKELY(cur + KD_DIMS > stack_len_capacity)) {
-      stack = realloc_nodes(stack, &stack_len_capacity, stack_default != stack);
+      stack = realloc_nearest_stack(stack, &stack_len_capacity, stack_default != stack);
     }
   }
 
+#undef NEAREST_MAX_DIST
+
   for (i = 0; i < nearest_len; i++) {
     r_nearest[i].dist = sqrtf(r_nearest[i].dist);
   }
@@ -666,6 +720,17 @@ int BLI_kdtree_nd_(range_search_with_len_squared_cb)(
   while (cur--) {
     const KDTreeNode *node = &nodes[stack[cur]];
 
+    if (node->d == KD_LEAF_AXIS) {
+      for (uint i = 0; i < node->right; i++) {
+        dist_sq = len_sq_fn(co, node[i].co, user_data);
+        if (dist_sq <= range_sq) {
+          nearest_add_in_range(
+              &nearest, nearest_len++, &nearest_len_capacity, node[i].index, dist_sq, node[i].co);
+        }
+      }
+      continue;
+    }
+
     if (co[node->d] + range < node->co[node->d]) {
       if (node->left != KD_NODE_UNSET) {
         stack[cur++] = node->left;
@@ -755,6 +820,18 @@ void BLI_kdtree_nd_(range_search_cb)(
   while (cur--) {
     const KDTreeNode *node = &nodes[stack[cur]];
 
+    if (node->d == KD_LEAF_AXIS) {
+      for (uint i = 0; i < node->right; i++) {
+        dist_sq = len_squared_vnvn(node[i].co, co);
+        if (dist_sq <= range_sq) {
+          if (search_cb(user_data, node[i].index, node[i].co, dist_sq) == false) {
+            goto finally;
+          }
+        }
+      }
+      continue;
+    }
+
     if (co[node->d] + range < node->co[node->d]) {
       if (node->left != KD_NODE_UNSET) {
         stack[cur++] = node->left;
@@ -792,6 +869,129 @@ finally:
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Batched Queries
+ * \{ */
+
+typedef struct KDTreeBatchData {
+  const KDTree *tree;
+  const float (*co)[KD_DIMS];
+
+  /* Find nearest. */
+  int *r_index;
+  KDTreeNearest *r_nearest;
+
+  /* Range search. */
+  float range;
+  bool (*search_cb)(
+      void *user_data, int co_index, int index, const float co[KD_DIMS], float dist_sq);
+  void *user_data;
+} KDTreeBatchData;
+
+typedef struct KDTreeRangeSearchBatchItem {
+  const KDTreeBatchData *data;
+  int co_index;
+} KDTreeRangeSearchBatchItem;
+
+static void kdtree_batch_settings(TaskParallelSettings *settings)
+{
+  BLI_parallel_range_settings_defaults(settings);
+  settings->min_iter_per_thread = KD_BATCH_GRAIN_SIZE;
+}
+
+static void find_nearest_batch_fn(void *__restrict userdata,
+                                  const int iter,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const KDTreeBatchData *data = userdata;
+  KDTreeNearest *r_nearest = data->r_nearest ? &data->r_nearest[iter] : NULL;
+  const int index = BLI_kdtree_nd_(find_nearest)(data->tree, data->co[iter], r_nearest);
+  if (data->r_index) {
+    data->r_index[iter] = index;
+  }
+}
+
+/**
+ * Find the nearest point for every coordinate in \a co, using multiple threads.
+ *
+ * \param r_index: When not null, the index of the nearest point for every coordinate,
+ * or -1 when the tree is empty.
+ * \param r_nearest: When not null, the nearest point for every coordinate.
+ * It isn't written to when the tree is empty.
+ */
+void BLI_kdtree_nd_(find_nearest_batch)(const KDTree *tree,
+                                        const float (*co)[KD_DIMS],
+                                        const int co_len,
+                                        int *r_index,
+                                        KDTreeNearest *r_nearest)
+{
+  KDTreeBatchData data = {
+      .tree = tree,
+      .co = co,
+      .r_index = r_index,
+      .r_nearest = r_nearest,
+  };
+  TaskParallelSettings settings;
+  kdtree_batch_settings(&settings);
+  BLI_task_parallel_range(0, co_len, &data, find_nearest_batch_fn, &settings);
+}
+
+static bool range_search_batch_cb(void *user_data,
+                                  const int index,
+                                  const float co[KD_DIMS],
+                                  const float dist_sq)
+{
+  const KDTreeRangeSearchBatchItem *item = user_data;
+  const KDTreeBatchData *data = item->data;
+  return data->search_cb(data->user_data, item->co_index, index, co, dist_sq);
+}
+
+static void range_search_batch_fn(void *__restrict userdata,
+                                  const int iter,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const KDTreeBatchData *data = userdata;
+  KDTreeRangeSearchBatchItem item = {
+      .data = data,
+      .co_index = iter,
+  };
+  BLI_kdtree_nd_(range_search_cb)(
+      data->tree, data->co[iter], data->range, range_search_batch_cb, &item);
+}
+
+/**
+ * A version of #BLI_kdtree_3d_range_search_cb that searches around every coordinate in \a co,
+ * using multiple threads.
+ *
+ * \param search_cb: Called for every node found in \a range of the coordinate at \a co_index,
+ * false return value stops the search for that coordinate.
+ * It's called from multiple threads at the same time.
+ *
+ * \note the order of calls isn't sorted based on distance or coordinate index.
+ */
+void BLI_kdtree_nd_(range_search_batch_cb)(
+    const KDTree *tree,
+    const float (*co)[KD_DIMS],
+    const int co_len,
+    const float range,
+    bool (*search_cb)(
+        void *user_data, int co_index, int index, const float co[KD_DIMS], float dist_sq),
+    void *user_data)
+{
+  KDTreeBatchData data = {
+      .tree = tree,
+      .co = co,
+      .range = range,
+      .search_cb = search_cb,
+      .user_data = user_data,
+  };
+  TaskParallelSettings settings;
+  kdtree_batch_settings(&settings);
+  BLI_task_parallel_range(0, co_len, &data, range_search_batch_fn, &settings);
+}
+
+/** \} */
+
 /**
  * Use when we want to loop over nodes ordered by index.
  * Requires indices to be aligned with nodes.
@@ -826,7 +1026,17 @@ struct DeDuplicateParams {
 static void deduplicate_recursive(const struct DeDuplicateParams *p, uint i)
 {
   const KDTreeNode *node = &p->nodes[i];
-  if (p->search_co[node->d] + p->range <= node->co[node->d]) {
+  if (node->d == KD_LEAF_AXIS) {
+    for (uint j = 0; j < node->right; j++) {
+      if ((p->search != node[j].index) && (p->duplicates[node[j].index] == -1)) {
+        if (len_squared_vnvn(node[j].co, p->search_co) <= p->range_sq) {
+          p->duplicates[node[j].index] = (int)p->search;
+          *p->duplicates_found += 1;
+        }
+      }
+    }
+  }
+  else if (p->search_co[node->d] + p->range <= node->co[node->d]) {
     if (node->left != KD_NODE_UNSET) {
       deduplicate_recursive(p, node->left);
     }
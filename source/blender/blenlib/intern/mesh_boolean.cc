@@ -872,6 +872,34 @@ static const Vert *find_flap_vert(const Face &tri, const Edge e, bool *r_rev)
   return flapv;
 }
 
+/**
+ * Return the sign of #orient3d for the approximate double coordinates of the vertices, or 0
+ * when the error bound does not allow deciding. The double coordinates of vertices made by the
+ * intersection are rounded, so they have index 1 in the error analysis of Burnikel et al. that is
+ * also used for the filters in `mesh_intersect.cc`. The determinant then has index 11.
+ */
+static int filter_orient3d(const Vert *a, const Vert *b, const Vert *c, const Vert *d)
+{
+  constexpr int index_orient3d = 11;
+  const double3 ad = a->co - d->co;
+  const double3 bd = b->co - d->co;
+  const double3 cd = c->co - d->co;
+  const double det = math::dot(ad, math::cross(bd, cd));
+
+  const double3 abs_d = math::abs(d->co);
+  const double3 sup_ad = math::abs(a->co) + abs_d;
+  const double3 sup_bd = math::abs(b->co) + abs_d;
+  const double3 sup_cd = math::abs(c->co) + abs_d;
+  const double3 sup_cross(sup_bd.y * sup_cd.z + sup_bd.z * sup_cd.y,
+                          sup_bd.z * sup_cd.x + sup_bd.x * sup_cd.z,
+                          sup_bd.x * sup_cd.y + sup_bd.y * sup_cd.x);
+  const double err_bound = math::dot(sup_ad, sup_cross) * index_orient3d * DBL_EPSILON;
+  if (fabs(det) > err_bound) {
+    return det > 0 ? 1 : -1;
+  }
+  return 0;
+}
+
 /**
  * Triangle \a tri and tri0 share edge e.
  * Classify \a tri with respect to tri0 as described in
@@ -892,9 +920,6 @@ static int sort_tris_class(const Face &tri, const Face &tri0, const Edge e)
   if (dbg_level > 0) {
     std::cout << "classify  e = " << e << "\n";
   }
-  mpq3 a0 = tri0[0]->co_exact;
-  mpq3 a1 = tri0[1]->co_exact;
-  mpq3 a2 = tri0[2]->co_exact;
   bool rev;
   bool rev0;
   const Vert *flapv0 = find_flap_vert(tri0, e, &rev0);
@@ -906,9 +931,12 @@ static int sort_tris_class(const Face &tri, const Face &tri0, const Edge e)
     std::cout << " rev = " << rev << " flapv = " << flapv << "\n";
   }
   BLI_assert(flapv != nullptr && flapv0 != nullptr);
-  const mpq3 flap = flapv->co_exact;
-  /* orient will be positive if flap is below oriented plane of a0,a1,a2. */
-  int orient = orient3d(a0, a1, a2, flap);
+  /* orient will be positive if flap is below oriented plane of tri0. Exact arithmetic is only
+   * needed when the flap is (nearly) co-planar with tri0. */
+  int orient = filter_orient3d(tri0[0], tri0[1], tri0[2], flapv);
+  if (orient == 0) {
+    orient = orient3d(tri0[0]->co_exact, tri0[1]->co_exact, tri0[2]->co_exact, flapv->co_exact);
+  }
   int ans;
   if (orient > 0) {
     ans = rev0 ? 4 : 3;
@@ -1073,21 +1101,16 @@ static Array<int> sort_tris_around_edge(
  * Will modify \a pinfo and \a cinfo and the patches and cells they contain.
  */
 static void find_cells_from_edge(const IMesh &tm,
-                                 const TriMeshTopology &tmtopo,
                                  PatchesInfo &pinfo,
                                  CellsInfo &cinfo,
-                                 const Edge e)
+                                 const Edge e,
+                                 const Span<int> sorted_tris)
 {
   const int dbg_level = 0;
   if (dbg_level > 0) {
     std::cout << "FIND_CELLS_FROM_EDGE " << e << "\n";
   }
-  const Vector<int> *edge_tris = tmtopo.edge_tris(e);
-  BLI_assert(edge_tris != nullptr);
-  Array<int> sorted_tris = sort_tris_around_edge(
-      tm, e, Span<int>(*edge_tris), (*edge_tris)[0], nullptr);
-
-  int n_edge_tris = edge_tris->size();
+  int n_edge_tris = sorted_tris.size();
   Array<int> edge_patches(n_edge_tris);
   for (int i = 0; i < n_edge_tris; ++i) {
     edge_patches[i] = pinfo.tri_patch(sorted_tris[i]);
@@ -1188,18 +1211,29 @@ static CellsInfo find_cells(const IMesh &tm, const TriMeshTopology &tmtopo, Patc
     std::cout << "\nFIND_CELLS\n";
   }
   CellsInfo cinfo;
-  /* For each unique edge shared between patch pairs, process it. */
-  Set<Edge> processed_edges;
+  /* Find each unique edge shared between patch pairs. */
+  VectorSet<Edge> patch_edges;
   for (const auto item : pinfo.patch_patch_edge_map().items()) {
     int p = item.key.first;
     int q = item.key.second;
     if (p < q) {
-      const Edge &e = item.value;
-      if (!processed_edges.contains(e)) {
-        processed_edges.add_new(e);
-        find_cells_from_edge(tm, tmtopo, pinfo, cinfo, e);
-      }
+      patch_edges.add(item.value);
+    }
+  }
+  /* Sorting the triangles around the edges needs the exact geometry, and is independent for every
+   * edge. Building the cells from the sorted triangles depends on the order of the edges. */
+  Array<Array<int>> sorted_edge_tris(patch_edges.size());
+  threading::parallel_for(patch_edges.index_range(), 256, [&](IndexRange range) {
+    for (int i : range) {
+      const Edge e = patch_edges[i];
+      const Vector<int> *edge_tris = tmtopo.edge_tris(e);
+      BLI_assert(edge_tris != nullptr);
+      sorted_edge_tris[i] = sort_tris_around_edge(
+          tm, e, Span<int>(*edge_tris), (*edge_tris)[0], nullptr);
     }
+  });
+  for (int i : patch_edges.index_range()) {
+    find_cells_from_edge(tm, pinfo, cinfo, patch_edges[i], sorted_edge_tris[i]);
   }
   /* Some patches may have no cells at this point. These are either:
    * (a) a closed manifold patch only incident on itself (sphere, torus, klein bottle, etc.).
@@ -26,6 +26,7 @@
 #  include "BLI_math_vector.h"
 #  include "BLI_polyfill_2d.h"
 #  include "BLI_set.hh"
+#  include "BLI_sort.hh"
 #  include "BLI_span.hh"
 #  include "BLI_task.h"
 #  include "BLI_task.hh"
@@ -37,10 +38,6 @@
 
 #  include "BLI_mesh_intersect.hh"
 
-#  ifdef WITH_TBB
-#    include <tbb/parallel_sort.h>
-#  endif
-
 // #  define PERFDEBUG
 
 namespace blender::meshintersect {
@@ -672,11 +669,7 @@ void IMesh::populate_vert(int max_verts)
    * TODO: when all debugged, set fix_order = false. */
   const bool fix_order = true;
   if (fix_order) {
-#  ifdef WITH_TBB
-    tbb::parallel_sort(vert_.begin(), vert_.end(), [](const Vert *a, const Vert *b) {
-#  else
-    std::sort(vert_.begin(), vert_.end(), [](const Vert *a, const Vert *b) {
-#  endif
+    parallel_sort(vert_.begin(), vert_.end(), [](const Vert *a, const Vert *b) {
       if (a->orig != NO_INDEX && b->orig != NO_INDEX) {
         return a->orig < b->orig;
       }
@@ -1019,6 +1012,12 @@ struct ITT_value {
   }
 };
 
+/**
+ * Maps a canonical pair of triangle indices to the result of intersecting them. The values are
+ * large, with group probing only the slot of the looked up pair is accessed.
+ */
+using ITTMap = Map<std::pair<int, int>, ITT_value, 0, GroupProbingStrategy>;
+
 static std::ostream &operator<<(std::ostream &os, const ITT_value &itt);
 
 /**
@@ -1170,31 +1169,68 @@ static inline mpq3 tti_interp(
 }
 
 /**
- * Return +1, 0, -1 as a + ad is above, on, or below the oriented plane containing a, b, c in CCW
- * order. This is the same as -oriented(a, b, c, a + ad), but uses fewer arithmetic operations.
- * TODO: change arguments to `const Vert *` and use floating filters.
- * The ba, ca, n, and dotbuf arguments are used as temporaries; declaring them
+ * The index of the orientation determinant in #tti_above, assuming the input coordinates
+ * have index 1. See #filter_plane_side.
+ */
+constexpr int index_tti_above = 11;
+
+/**
+ * Return +1, 0, -1 as d is above, on, or below the oriented plane containing a, b, c in CCW
+ * order. This is the same as -oriented(a, b, c, d), but uses fewer arithmetic operations.
+ * The sign is found with double arithmetic when the error bound allows it, and only
+ * calculated exactly for (nearly) degenerate configurations.
+ * The ba, ca, n, da, and dotbuf arguments are used as temporaries; declaring them
  * in the caller can avoid many allocs and frees of mpq3 and mpq_class structures.
  */
-static inline int tti_above(const mpq3 &a,
-                            const mpq3 &b,
-                            const mpq3 &c,
-                            const mpq3 &ad,
+static inline int tti_above(const Vert *a,
+                            const Vert *b,
+                            const Vert *c,
+                            const Vert *d,
                             mpq3 &ba,
                             mpq3 &ca,
                             mpq3 &n,
+                            mpq3 &da,
                             mpq3 &dotbuf)
 {
-  ba = b;
-  ba -= a;
-  ca = c;
-  ca -= a;
+  /* Vertices are unique per position, so this is a common exactly degenerate case. */
+  if (ELEM(a, b, c, d) || ELEM(b, c, d) || c == d) {
+    return 0;
+  }
+  const double3 d_ba = b->co - a->co;
+  const double3 d_ca = c->co - a->co;
+  const double3 d_da = d->co - a->co;
+  const double det = math::dot(d_da, math::cross(d_ba, d_ca));
+
+  const double3 abs_a = math::abs(a->co);
+  const double3 sup_ba = math::abs(b->co) + abs_a;
+  const double3 sup_ca = math::abs(c->co) + abs_a;
+  const double3 sup_da = math::abs(d->co) + abs_a;
+  const double3 sup_n(sup_ba.y * sup_ca.z + sup_ba.z * sup_ca.y,
+                      sup_ba.z * sup_ca.x + sup_ba.x * sup_ca.z,
+                      sup_ba.x * sup_ca.y + sup_ba.y * sup_ca.x);
+  const double err_bound = math::dot(sup_da, sup_n) * index_tti_above * DBL_EPSILON;
+  if (fabs(det) > err_bound) {
+#  ifdef PERFDEBUG
+    incperfcount(5); /* tti_above decided by filter. */
+#  endif
+    return det > 0 ? 1 : -1;
+  }
+#  ifdef PERFDEBUG
+  incperfcount(6); /* tti_above decided exactly. */
+#  endif
+
+  ba = b->co_exact;
+  ba -= a->co_exact;
+  ca = c->co_exact;
+  ca -= a->co_exact;
+  da = d->co_exact;
+  da -= a->co_exact;
 
   n.x = ba.y * ca.z - ba.z * ca.y;
   n.y = ba.z * ca.x - ba.x * ca.z;
   n.z = ba.x * ca.y - ba.y * ca.x;
 
-  return sgn(math::dot_with_buffer(ad, n, dotbuf));
+  return sgn(math::dot_with_buffer(da, n, dotbuf));
 }
 
 /**
@@ -1210,12 +1246,12 @@ static inline int tti_above(const mpq3 &a,
  *   of the plane and at least one of q1 and r1 are off the plane.
  * Similarly for p2, q2, r2 with respect to the first triangle's plane.
  */
-static ITT_value itt_canon2(const mpq3 &p1,
-                            const mpq3 &q1,
-                            const mpq3 &r1,
-                            const mpq3 &p2,
-                            const mpq3 &q2,
-                            const mpq3 &r2,
+static ITT_value itt_canon2(const Vert *p1,
+                            const Vert *q1,
+                            const Vert *r1,
+                            const Vert *p2,
+                            const Vert *q2,
+                            const Vert *r2,
                             const mpq3 &n1,
                             const mpq3 &n2)
 {
@@ -1226,33 +1262,34 @@ static ITT_value itt_canon2(const mpq3 &p1,
     std::cout << "p2=" << p2 << " q2=" << q2 << " r2=" << r2 << "\n";
     std::cout << "n1=" << n1 << " n2=" << n2 << "\n";
     std::cout << "approximate values:\n";
-    std::cout << "p1=(" << p1[0].get_d() << "," << p1[1].get_d() << "," << p1[2].get_d() << ")\n";
-    std::cout << "q1=(" << q1[0].get_d() << "," << q1[1].get_d() << "," << q1[2].get_d() << ")\n";
-    std::cout << "r1=(" << r1[0].get_d() << "," << r1[1].get_d() << "," << r1[2].get_d() << ")\n";
-    std::cout << "p2=(" << p2[0].get_d() << "," << p2[1].get_d() << "," << p2[2].get_d() << ")\n";
-    std::cout << "q2=(" << q2[0].get_d() << "," << q2[1].get_d() << "," << q2[2].get_d() << ")\n";
-    std::cout << "r2=(" << r2[0].get_d() << "," << r2[1].get_d() << "," << r2[2].get_d() << ")\n";
+    std::cout << "p1=(" << p1->co[0] << "," << p1->co[1] << "," << p1->co[2] << ")\n";
+    std::cout << "q1=(" << q1->co[0] << "," << q1->co[1] << "," << q1->co[2] << ")\n";
+    std::cout << "r1=(" << r1->co[0] << "," << r1->co[1] << "," << r1->co[2] << ")\n";
+    std::cout << "p2=(" << p2->co[0] << "," << p2->co[1] << "," << p2->co[2] << ")\n";
+    std::cout << "q2=(" << q2->co[0] << "," << q2->co[1] << "," << q2->co[2] << ")\n";
+    std::cout << "r2=(" << r2->co[0] << "," << r2->co[1] << "," << r2->co[2] << ")\n";
     std::cout << "n1=(" << n1[0].get_d() << "," << n1[1].get_d() << "," << n1[2].get_d() << ")\n";
     std::cout << "n2=(" << n2[0].get_d() << "," << n2[1].get_d() << "," << n2[2].get_d() << ")\n";
   }
-  mpq3 p1p2 = p2 - p1;
   mpq3 intersect_1;
   mpq3 intersect_2;
-  mpq3 buf[4];
+  mpq3 buf[5];
   bool no_overlap = false;
   /* Top test in classification tree. */
-  if (tti_above(p1, q1, r2, p1p2, buf[0], buf[1], buf[2], buf[3]) > 0) {
+  if (tti_above(p1, q1, r2, p2, buf[0], buf[1], buf[2], buf[3], buf[4]) > 0) {
     /* Middle right test in classification tree. */
-    if (tti_above(p1, r1, r2, p1p2, buf[0], buf[1], buf[2], buf[3]) <= 0) {
+    if (tti_above(p1, r1, r2, p2, buf[0], buf[1], buf[2], buf[3], buf[4]) <= 0) {
       /* Bottom right test in classification tree. */
-      if (tti_above(p1, r1, q2, p1p2, buf[0], buf[1], buf[2], buf[3]) > 0) {
+      if (tti_above(p1, r1, q2, p2, buf[0], buf[1], buf[2], buf[3], buf[4]) > 0) {
         /* Overlap is [k [i l] j]. */
         if (dbg_level > 0) {
           std::cout << "overlap [k [i l] j]\n";
         }
         /* i is intersect with p1r1. l is intersect with p2r2. */
-        intersect_1 = tti_interp(p1, r1, p2, n2, buf[0], buf[1], buf[2]);
-        intersect_2 = tti_interp(p2, r2, p1, n1, buf[0], buf[1], buf[2]);
+        intersect_1 = tti_interp(
+            p1->co_exact, r1->co_exact, p2->co_exact, n2, buf[0], buf[1], buf[2]);
+        intersect_2 = tti_interp(
+            p2->co_exact, r2->co_exact, p1->co_exact, n1, buf[0], buf[1], buf[2]);
       }
       else {
         /* Overlap is [i [k l] j]. */
@@ -1260,8 +1297,10 @@ static ITT_value itt_canon2(const mpq3 &p1,
           std::cout << "overlap [i [k l] j]\n";
         }
         /* k is intersect with p2q2. l is intersect is p2r2. */
-        intersect_1 = tti_interp(p2, q2, p1, n1, buf[0], buf[1], buf[2]);
-        intersect_2 = tti_interp(p2, r2, p1, n1, buf[0], buf[1], buf[2]);
+        intersect_1 = tti_interp(
+            p2->co_exact, q2->co_exact, p1->co_exact, n1, buf[0], buf[1], buf[2]);
+        intersect_2 = tti_interp(
+            p2->co_exact, r2->co_exact, p1->co_exact, n1, buf[0], buf[1], buf[2]);
       }
     }
     else {
@@ -1274,7 +1313,7 @@ static ITT_value itt_canon2(const mpq3 &p1,
   }
   else {
     /* Middle left test in classification tree. */
-    if (tti_above(p1, q1, q2, p1p2, buf[0], buf[1], buf[2], buf[3]) < 0) {
+    if (tti_above(p1, q1, q2, p2, buf[0], buf[1], buf[2], buf[3], buf[4]) < 0) {
       /* No overlap: [i j] [k l]. */
       if (dbg_level > 0) {
         std::cout << "no overlap: [i j] [k l]\n";
@@ -1283,14 +1322,16 @@ static ITT_value itt_canon2(const mpq3 &p1,
     }
     else {
       /* Bottom left test in classification tree. */
-      if (tti_above(p1, r1, q2, p1p2, buf[0], buf[1], buf[2], buf[3]) >= 0) {
+      if (tti_above(p1, r1, q2, p2, buf[0], buf[1], buf[2], buf[3], buf[4]) >= 0) {
         /* Overlap is [k [i j] l]. */
         if (dbg_level > 0) {
           std::cout << "overlap [k [i j] l]\n";
         }
         /* i is intersect with p1r1. j is intersect with p1q1. */
-        intersect_1 = tti_interp(p1, r1, p2, n2, buf[0], buf[1], buf[2]);
-        intersect_2 = tti_interp(p1, q1, p2, n2, buf[0], buf[1], buf[2]);
+        intersect_1 = tti_interp(
+            p1->co_exact, r1->co_exact, p2->co_exact, n2, buf[0], buf[1], buf[2]);
+        intersect_2 = tti_interp(
+            p1->co_exact, q1->co_exact, p2->co_exact, n2, buf[0], buf[1], buf[2]);
       }
       else {
         /* Overlap is [i [k j] l]. */
@@ -1298,8 +1339,10 @@ static ITT_value itt_canon2(const mpq3 &p1,
           std::cout << "overlap [i [k j] l]\n";
         }
         /* k is intersect with p2q2. j is intersect with p1q1. */
-        intersect_1 = tti_interp(p2, q2, p1, n1, buf[0], buf[1], buf[2]);
-        intersect_2 = tti_interp(p1, q1, p2, n2, buf[0], buf[1], buf[2]);
+        intersect_1 = tti_interp(
+            p2->co_exact, q2->co_exact, p1->co_exact, n1, buf[0], buf[1], buf[2]);
+        intersect_2 = tti_interp(
+            p1->co_exact, q1->co_exact, p2->co_exact, n2, buf[0], buf[1], buf[2]);
       }
     }
   }
@@ -1320,12 +1363,12 @@ static ITT_value itt_canon2(const mpq3 &p1,
 
 /* Helper function for intersect_tri_tri. Arguments have been canonicalized for triangle 1. */
 
-static ITT_value itt_canon1(const mpq3 &p1,
-                            const mpq3 &q1,
-                            const mpq3 &r1,
-                            const mpq3 &p2,
-                            const mpq3 &q2,
-                            const mpq3 &r2,
+static ITT_value itt_canon1(const Vert *p1,
+                            const Vert *q1,
+                            const Vert *r1,
+                            const Vert *p2,
+                            const Vert *q2,
+                            const Vert *r2,
                             const mpq3 &n1,
                             const mpq3 &n2,
                             int sp2,
@@ -1527,49 +1570,49 @@ static ITT_value intersect_tri_tri(const IMesh &tm, int t1, int t2)
   ITT_value ans;
   if (sp1 > 0) {
     if (sq1 > 0) {
-      ans = itt_canon1(r1, p1, q1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(vr1, vp1, vq1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
     }
     else if (sr1 > 0) {
-      ans = itt_canon1(q1, r1, p1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(vq1, vr1, vp1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
     }
     else {
-      ans = itt_canon1(p1, q1, r1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(vp1, vq1, vr1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
     }
   }
   else if (sp1 < 0) {
     if (sq1 < 0) {
-      ans = itt_canon1(r1, p1, q1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(vr1, vp1, vq1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
     }
     else if (sr1 < 0) {
-      ans = itt_canon1(q1, r1, p1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+      ans = itt_canon1(vq1, vr1, vp1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
     }
     else {
-      ans = itt_canon1(p1, q1, r1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+      ans = itt_canon1(vp1, vq1, vr1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
     }
   }
   else {
     if (sq1 < 0) {
       if (sr1 >= 0) {
-        ans = itt_canon1(q1, r1, p1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(vq1, vr1, vp1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
       }
       else {
-        ans = itt_canon1(p1, q1, r1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(vp1, vq1, vr1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
       }
     }
     else if (sq1 > 0) {
       if (sr1 > 0) {
-        ans = itt_canon1(p1, q1, r1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(vp1, vq1, vr1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
       }
       else {
-        ans = itt_canon1(q1, r1, p1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(vq1, vr1, vp1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
       }
     }
     else {
       if (sr1 > 0) {
-        ans = itt_canon1(r1, p1, q1, p2, q2, r2, n1, n2, sp2, sq2, sr2);
+        ans = itt_canon1(vr1, vp1, vq1, vp2, vq2, vr2, n1, n2, sp2, sq2, sr2);
       }
       else if (sr1 < 0) {
-        ans = itt_canon1(r1, p1, q1, p2, r2, q2, n1, n2, sp2, sr2, sq2);
+        ans = itt_canon1(vr1, vp1, vq1, vp2, vr2, vq2, n1, n2, sp2, sr2, sq2);
       }
       else {
         if (dbg_level > 0) {
@@ -1700,7 +1743,7 @@ static void prepare_need_tri(CDT_data &cd, const IMesh &tm, int t)
   cd.is_reversed.append(rev);
 }
 
-static CDT_data prepare_cdt_input(const IMesh &tm, int t, const Vector<ITT_value> itts)
+static CDT_data prepare_cdt_input(const IMesh &tm, int t, Span<const ITT_value *> itts)
 {
   CDT_data ans;
   BLI_assert(tm.face(t)->plane_populated());
@@ -1708,20 +1751,20 @@ static CDT_data prepare_cdt_input(const IMesh &tm, int t, const Vector<ITT_value
   BLI_assert(ans.t_plane->exact_populated());
   ans.proj_axis = math::dominant_axis(ans.t_plane->norm_exact);
   prepare_need_tri(ans, tm, t);
-  for (const ITT_value &itt : itts) {
-    switch (itt.kind) {
+  for (const ITT_value *itt : itts) {
+    switch (itt->kind) {
       case INONE:
         break;
       case IPOINT: {
-        prepare_need_vert(ans, itt.p1);
+        prepare_need_vert(ans, itt->p1);
         break;
       }
       case ISEGMENT: {
-        prepare_need_edge(ans, itt.p1, itt.p2);
+        prepare_need_edge(ans, itt->p1, itt->p2);
         break;
       }
       case ICOPLANAR: {
-        prepare_need_tri(ans, tm, itt.t_source);
+        prepare_need_tri(ans, tm, itt->t_source);
         break;
       }
     }
@@ -1732,7 +1775,7 @@ static CDT_data prepare_cdt_input(const IMesh &tm, int t, const Vector<ITT_value
 static CDT_data prepare_cdt_input_for_cluster(const IMesh &tm,
                                               const CoplanarClusterInfo &clinfo,
                                               int c,
-                                              const Vector<ITT_value> itts)
+                                              Span<const ITT_value *> itts)
 {
   CDT_data ans;
   BLI_assert(c < clinfo.tot_cluster());
@@ -1746,14 +1789,14 @@ static CDT_data prepare_cdt_input_for_cluster(const IMesh &tm,
   for (const int t : cl) {
     prepare_need_tri(ans, tm, t);
   }
-  for (const ITT_value &itt : itts) {
-    switch (itt.kind) {
+  for (const ITT_value *itt : itts) {
+    switch (itt->kind) {
       case IPOINT: {
-        prepare_need_vert(ans, itt.p1);
+        prepare_need_vert(ans, itt->p1);
         break;
       }
       case ISEGMENT: {
-        prepare_need_edge(ans, itt.p1, itt.p2);
+        prepare_need_edge(ans, itt->p1, itt->p2);
         break;
       }
       default:
@@ -2316,16 +2359,6 @@ static IMesh extract_subdivided_tri(const CDT_data &cd,
   return IMesh(faces);
 }
 
-static bool bvhtreeverlap_cmp(const BVHTreeOverlap &a, const BVHTreeOverlap &b)
-{
-  if (a.indexA < b.indexA) {
-    return true;
-  }
-  if ((a.indexA == b.indexA) & (a.indexB < b.indexB)) {
-    return true;
-  }
-  return false;
-}
 class TriOverlaps {
   BVHTree *tree_{nullptr};
   BVHTree *tree_b_{nullptr};
@@ -2417,8 +2450,12 @@ class TriOverlaps {
       }
       overlap_tot_ += overlap_tot_;
     }
-    /* Sort the overlaps to bring all the intersects with a given indexA together. */
-    std::sort(overlap_, overlap_ + overlap_tot_, bvhtreeverlap_cmp);
+    /* Sort the overlaps to bring all the intersects with a given indexA together. The indices
+     * are not negative, so they can be combined into a single key. */
+    parallel_radix_sort(MutableSpan<BVHTreeOverlap>(overlap_, overlap_tot_),
+                        [](const BVHTreeOverlap &overlap) {
+                          return (uint64_t(overlap.indexA) << 32) | uint64_t(overlap.indexB);
+                        });
     if (dbg_level > 0) {
       std::cout << overlap_tot_ << " overlaps found:\n";
       for (BVHTreeOverlap ov : overlap()) {
@@ -2470,11 +2507,11 @@ class TriOverlaps {
  */
 struct OverlapIttsData {
   Vector<std::pair<int, int>> intersect_pairs;
-  Map<std::pair<int, int>, ITT_value> &itt_map;
+  ITTMap &itt_map;
   const IMesh &tm;
   IMeshArena *arena;
 
-  OverlapIttsData(Map<std::pair<int, int>, ITT_value> &itt_map, const IMesh &tm, IMeshArena *arena)
+  OverlapIttsData(ITTMap &itt_map, const IMesh &tm, IMeshArena *arena)
       : itt_map(itt_map), tm(tm), arena(arena)
   {
   }
@@ -2516,7 +2553,7 @@ static void calc_overlap_itts_range_func(void *__restrict userdata,
  * Fill in itt_map with the vector of ITT_values that result from intersecting the triangles in
  * ov. Use a canonical order for triangles: (a,b) where  a < b.
  */
-static void calc_overlap_itts(Map<std::pair<int, int>, ITT_value> &itt_map,
+static void calc_overlap_itts(ITTMap &itt_map,
                               const IMesh &tm,
                               const TriOverlaps &ov,
                               IMeshArena *arena)
@@ -2548,7 +2585,7 @@ static void calc_overlap_itts(Map<std::pair<int, int>, ITT_value> &itt_map,
  */
 static void calc_subdivided_non_cluster_tris(Array<IMesh> &r_tri_subdivided,
                                              const IMesh &tm,
-                                             const Map<std::pair<int, int>, ITT_value> &itt_map,
+                                             const ITTMap &itt_map,
                                              const CoplanarClusterInfo &clinfo,
                                              const TriOverlaps &ov,
                                              IMeshArena *arena)
@@ -2599,20 +2636,18 @@ static void calc_subdivided_non_cluster_tris(Array<IMesh> &r_tri_subdivided,
         std::cout << "handling overlap range\nt=" << t << " start=" << otr.overlap_start
                   << " len=" << otr.len << "\n";
       }
+      /* Refer to the intersections in the map, copying their exact coordinates is expensive. */
       constexpr int inline_capacity = 100;
-      Vector<ITT_value, inline_capacity> itts(otr.len);
+      Vector<const ITT_value *, inline_capacity> itts;
       for (int j = otr.overlap_start; j < otr.overlap_start + otr.len; ++j) {
         int t_other = overlap[j].indexB;
         std::pair<int, int> key = canon_int_pair(t, t_other);
-        ITT_value itt;
-        if (itt_map.contains(key)) {
-          itt = itt_map.lookup(key);
-        }
-        if (itt.kind != INONE) {
+        const ITT_value *itt = itt_map.lookup_ptr(key);
+        if (itt != nullptr && itt->kind != INONE) {
           itts.append(itt);
         }
-        if (dbg_level > 0) {
-          std::cout << "  tri t" << t_other << "; result = " << itt << "\n";
+        if (dbg_level > 0 && itt != nullptr) {
+          std::cout << "  tri t" << t_other << "; result = " << *itt << "\n";
         }
       }
       if (itts.size() > 0) {
@@ -2656,39 +2691,41 @@ static void calc_cluster_tris(Array<IMesh> &tri_subdivided,
                               const Array<CDT_data> &cluster_subdivided,
                               IMeshArena *arena)
 {
-  for (int c : clinfo.index_range()) {
-    const CoplanarCluster &cl = clinfo.cluster(c);
-    const CDT_data &cd = cluster_subdivided[c];
-    /* Each triangle in cluster c should be an input triangle in cd.input_faces.
-     * (See prepare_cdt_input_for_cluster.)
-     * So accumulate a Vector of Face* for each input face by going through the
-     * output faces and making a Face for each input face that it is part of.
-     * (The Boolean algorithm wants duplicates if a given output triangle is part
-     * of more than one input triangle.)
-     */
-    int n_cluster_tris = cl.tot_tri();
-    const CDT_result<mpq_class> &cdt_out = cd.cdt_out;
-    BLI_assert(cd.input_face.size() == n_cluster_tris);
-    Array<Vector<Face *>> face_vec(n_cluster_tris);
-    for (int cdt_out_t : cdt_out.face.index_range()) {
-      for (int cdt_in_t : cdt_out.face_orig[cdt_out_t]) {
-        Face *f = cdt_tri_as_imesh_face(cdt_out_t, cdt_in_t, cd, tm, arena);
-        face_vec[cdt_in_t].append(f);
+  threading::parallel_for(clinfo.index_range(), 1, [&](IndexRange range) {
+    for (int c : range) {
+      const CoplanarCluster &cl = clinfo.cluster(c);
+      const CDT_data &cd = cluster_subdivided[c];
+      /* Each triangle in cluster c should be an input triangle in cd.input_faces.
+       * (See prepare_cdt_input_for_cluster.)
+       * So accumulate a Vector of Face* for each input face by going through the
+       * output faces and making a Face for each input face that it is part of.
+       * (The Boolean algorithm wants duplicates if a given output triangle is part
+       * of more than one input triangle.)
+       */
+      int n_cluster_tris = cl.tot_tri();
+      const CDT_result<mpq_class> &cdt_out = cd.cdt_out;
+      BLI_assert(cd.input_face.size() == n_cluster_tris);
+      Array<Vector<Face *>> face_vec(n_cluster_tris);
+      for (int cdt_out_t : cdt_out.face.index_range()) {
+        for (int cdt_in_t : cdt_out.face_orig[cdt_out_t]) {
+          Face *f = cdt_tri_as_imesh_face(cdt_out_t, cdt_in_t, cd, tm, arena);
+          face_vec[cdt_in_t].append(f);
+        }
+      }
+      for (int cdt_in_t : cd.input_face.index_range()) {
+        int tm_t = cd.input_face[cdt_in_t];
+        BLI_assert(tri_subdivided[tm_t].face_size() == 0);
+        tri_subdivided[tm_t] = IMesh(face_vec[cdt_in_t]);
       }
     }
-    for (int cdt_in_t : cd.input_face.index_range()) {
-      int tm_t = cd.input_face[cdt_in_t];
-      BLI_assert(tri_subdivided[tm_t].face_size() == 0);
-      tri_subdivided[tm_t] = IMesh(face_vec[cdt_in_t]);
-    }
-  }
+  });
 }
 
 static CDT_data calc_cluster_subdivided(const CoplanarClusterInfo &clinfo,
                                         int c,
                                         const IMesh &tm,
                                         const TriOverlaps &ov,
-                                        const Map<std::pair<int, int>, ITT_value> &itt_map,
+                                        const ITTMap &itt_map,
                                         IMeshArena *UNUSED(arena))
 {
   constexpr int dbg_level = 0;
@@ -2701,7 +2738,7 @@ static CDT_data calc_cluster_subdivided(const CoplanarClusterInfo &clinfo,
   /* Get vector itts of all intersections of a triangle of cl with any triangle of tm not
    * in cl and not co-planar with it (for that latter, if there were an intersection,
    * it should already be in cluster cl). */
-  Vector<ITT_value> itts;
+  Vector<const ITT_value *> itts;
   Span<BVHTreeOverlap> ovspan = ov.overlap();
   for (int t : cl) {
     if (dbg_level > 0) {
@@ -2718,13 +2755,11 @@ static CDT_data calc_cluster_subdivided(const CoplanarClusterInfo &clinfo,
           std::cout << "use intersect(" << t << "," << t_other << "\n";
         }
         std::pair<int, int> key = canon_int_pair(t, t_other);
-        if (itt_map.contains(key)) {
-          ITT_value itt = itt_map.lookup(key);
-          if (!ELEM(itt.kind, INONE, ICOPLANAR)) {
-            itts.append(itt);
-            if (dbg_level > 0) {
-              std::cout << "  itt = " << itt << "\n";
-            }
+        const ITT_value *itt = itt_map.lookup_ptr(key);
+        if (itt != nullptr && !ELEM(itt->kind, INONE, ICOPLANAR)) {
+          itts.append(itt);
+          if (dbg_level > 0) {
+            std::cout << "  itt = " << *itt << "\n";
           }
         }
       }
@@ -2738,23 +2773,24 @@ static CDT_data calc_cluster_subdivided(const CoplanarClusterInfo &clinfo,
 
 static IMesh union_tri_subdivides(const blender::Array<IMesh> &tri_subdivided)
 {
-  int tot_tri = 0;
-  for (const IMesh &m : tri_subdivided) {
-    tot_tri += m.face_size();
+  Array<int> face_offsets(tri_subdivided.size() + 1);
+  face_offsets[0] = 0;
+  for (int t : tri_subdivided.index_range()) {
+    face_offsets[t + 1] = face_offsets[t] + tri_subdivided[t].face_size();
   }
-  Array<Face *> faces(tot_tri);
-  int face_index = 0;
-  for (const IMesh &m : tri_subdivided) {
-    for (Face *f : m.faces()) {
-      faces[face_index++] = f;
+  Array<Face *> faces(face_offsets.last());
+  threading::parallel_for(tri_subdivided.index_range(), 2048, [&](IndexRange range) {
+    for (int t : range) {
+      const Span<Face *> tri_faces = tri_subdivided[t].faces();
+      std::copy(tri_faces.begin(), tri_faces.end(), faces.begin() + face_offsets[t]);
     }
-  }
+  });
   return IMesh(faces);
 }
 
 static CoplanarClusterInfo find_clusters(const IMesh &tm,
                                          const Array<BoundingBox> &tri_bb,
-                                         const Map<std::pair<int, int>, ITT_value> &itt_map)
+                                         const ITTMap &itt_map)
 {
   constexpr int dbg_level = 0;
   if (dbg_level > 0) {
@@ -3011,7 +3047,7 @@ IMesh trimesh_nary_intersect(const IMesh &tm_in,
 #  endif
   /* itt_map((a,b)) will hold the intersection value resulting from intersecting
    * triangles with indices a and b, where a < b. */
-  Map<std::pair<int, int>, ITT_value> itt_map;
+  ITTMap itt_map;
   itt_map.reserve(tri_ov.overlap().size());
   calc_overlap_itts(itt_map, *tm_clean, tri_ov, arena);
 #  ifdef PERFDEBUG
@@ -3036,9 +3072,14 @@ IMesh trimesh_nary_intersect(const IMesh &tm_in,
             << "\n";
 #  endif
   Array<CDT_data> cluster_subdivided(clinfo.tot_cluster());
-  for (int c : clinfo.index_range()) {
-    cluster_subdivided[c] = calc_cluster_subdivided(clinfo, c, *tm_clean, tri_ov, itt_map, arena);
-  }
+  /* Clusters are independent, and the CDT of a large cluster is much more work than that of a
+   * small one, so use a small grain size. */
+  threading::parallel_for(clinfo.index_range(), 1, [&](IndexRange range) {
+    for (int c : range) {
+      cluster_subdivided[c] = calc_cluster_subdivided(
+          clinfo, c, *tm_clean, tri_ov, itt_map, arena);
+    }
+  });
 #  ifdef PERFDEBUG
   double cluster_subdivide_time = PIL_check_seconds_timer();
   std::cout << "subdivided clusters found, time = "
@@ -3188,6 +3229,14 @@ static void perfdata_init()
   perfdata->count.append(0);
   perfdata->count_name.append("final non-NONE intersects");
 
+  /* count 5. */
+  perfdata->count.append(0);
+  perfdata->count_name.append("tri tri interval tests decided by filter");
+
+  /* count 6. */
+  perfdata->count.append(0);
+  perfdata->count_name.append("tri tri interval tests decided exactly");
+
   /* max 0. */
   perfdata->max.append(0);
   perfdata->max_name.append("total faces");
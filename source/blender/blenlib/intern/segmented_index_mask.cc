@@ -0,0 +1,309 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "BLI_segmented_index_mask.hh"
+#include "BLI_task.hh"
+
+namespace blender {
+
+/**
+ * Adds indices in ascending order to a #SegmentedIndexMask, detecting the runs of indices which
+ * can be stored as ranges.
+ */
+class SegmentedIndexMaskBuilder {
+ private:
+  using Segment = SegmentedIndexMask::Segment;
+
+  SegmentedIndexMask &mask_;
+  /** Consecutive indices which haven't been added to the mask yet. */
+  int64_t run_start_ = 0;
+  int64_t run_size_ = 0;
+
+ public:
+  SegmentedIndexMaskBuilder(SegmentedIndexMask &mask) : mask_(mask)
+  {
+  }
+
+  ~SegmentedIndexMaskBuilder()
+  {
+    this->flush_run();
+  }
+
+  void add(const int64_t index)
+  {
+    BLI_assert(index >= run_start_ + run_size_);
+    if (run_size_ > 0 && index == run_start_ + run_size_) {
+      run_size_++;
+      return;
+    }
+    this->flush_run();
+    run_start_ = index;
+    run_size_ = 1;
+  }
+
+  void add_range(const IndexRange range)
+  {
+    if (range.size() == 0) {
+      return;
+    }
+    if (run_size_ > 0 && range.start() == run_start_ + run_size_) {
+      run_size_ += range.size();
+      return;
+    }
+    this->flush_run();
+    run_start_ = range.start();
+    run_size_ = range.size();
+  }
+
+ private:
+  void flush_run()
+  {
+    if (run_size_ == 0) {
+      return;
+    }
+    if (run_size_ >= SegmentedIndexMask::min_range_size) {
+      this->add_range_segment(IndexRange(run_start_, run_size_));
+    }
+    else {
+      for (const int64_t i : IndexRange(run_start_, run_size_)) {
+        this->add_offset_index(i);
+      }
+    }
+    run_size_ = 0;
+  }
+
+  void add_range_segment(const IndexRange range)
+  {
+    mask_.size_ += range.size();
+    if (!mask_.segments_.is_empty()) {
+      Segment &last_segment = mask_.segments_.last();
+      if (last_segment.indices_start == -1 &&
+          last_segment.offset + last_segment.size == range.start()) {
+        last_segment.size += range.size();
+        return;
+      }
+    }
+    mask_.segments_.append({range.start(), range.size(), -1});
+  }
+
+  void add_offset_index(const int64_t index)
+  {
+    mask_.size_++;
+    if (!mask_.segments_.is_empty()) {
+      Segment &last_segment = mask_.segments_.last();
+      if (last_segment.indices_start != -1 &&
+          last_segment.size < SegmentedIndexMask::max_segment_size &&
+          index - last_segment.offset <= INT16_MAX) {
+        mask_.offset_indices_.append(int16_t(index - last_segment.offset));
+        last_segment.size++;
+        return;
+      }
+    }
+    mask_.segments_.append({index, 1, mask_.offset_indices_.size()});
+    mask_.offset_indices_.append(0);
+  }
+};
+
+SegmentedIndexMask::SegmentedIndexMask(const IndexRange range)
+{
+  if (range.size() > 0) {
+    segments_.append({range.start(), range.size(), -1});
+    size_ = range.size();
+  }
+}
+
+SegmentedIndexMask SegmentedIndexMask::from_index_mask(const IndexMask mask)
+{
+  if (mask.is_range()) {
+    return SegmentedIndexMask(mask.as_range());
+  }
+  SegmentedIndexMask result;
+  {
+    SegmentedIndexMaskBuilder builder(result);
+    for (const int64_t i : mask) {
+      builder.add(i);
+    }
+  }
+  return result;
+}
+
+/**
+ * Add the runs of true values in the span, `offset` being the index of its first element.
+ */
+static void add_bool_runs(SegmentedIndexMaskBuilder &builder,
+                          const Span<bool> bools,
+                          const int64_t offset)
+{
+  const int64_t size = bools.size();
+  int64_t i = 0;
+  while (i < size) {
+    if (!bools[i]) {
+      i++;
+      continue;
+    }
+    const int64_t run_start = i;
+    while (i < size && bools[i]) {
+      i++;
+    }
+    builder.add_range(IndexRange(offset + run_start, i - run_start));
+  }
+}
+
+SegmentedIndexMask SegmentedIndexMask::from_bools(const Span<bool> bools)
+{
+  SegmentedIndexMask result;
+  {
+    SegmentedIndexMaskBuilder builder(result);
+    add_bool_runs(builder, bools, 0);
+  }
+  return result;
+}
+
+SegmentedIndexMask SegmentedIndexMask::from_bools(const IndexMask universe,
+                                                  const VArray<bool> &bools)
+{
+  if (bools.is_single()) {
+    return bools.get_internal_single() ? SegmentedIndexMask::from_index_mask(universe) :
+                                         SegmentedIndexMask();
+  }
+  SegmentedIndexMask result;
+  {
+    SegmentedIndexMaskBuilder builder(result);
+    if (bools.is_span()) {
+      const Span<bool> span = bools.get_internal_span();
+      if (universe.is_range()) {
+        const IndexRange range = universe.as_range();
+        add_bool_runs(builder, span.slice(range), range.start());
+      }
+      else {
+        for (const int64_t i : universe) {
+          if (span[i]) {
+            builder.add(i);
+          }
+        }
+      }
+    }
+    else {
+      universe.foreach_index([&](const int64_t i) {
+        if (bools[i]) {
+          builder.add(i);
+        }
+      });
+    }
+  }
+  return result;
+}
+
+SegmentedIndexMask SegmentedIndexMask::from_predicate(
+    const IndexMask universe, const FunctionRef<bool(int64_t index)> predicate)
+{
+  SegmentedIndexMask result;
+  {
+    SegmentedIndexMaskBuilder builder(result);
+    universe.foreach_index([&](const int64_t i) {
+      if (predicate(i)) {
+        builder.add(i);
+      }
+    });
+  }
+  return result;
+}
+
+/**
+ * Expand the offset indices of the segment, or return it as range.
+ */
+static IndexMask segment_as_mask(const IndexMaskSegment &segment, Vector<int64_t> &r_indices)
+{
+  if (segment.is_range()) {
+    return segment.as_range();
+  }
+  r_indices.resize(segment.size());
+  const int64_t offset = segment.offset();
+  const Span<int16_t> offset_indices = segment.offset_indices();
+  for (const int64_t i : offset_indices.index_range()) {
+    r_indices[i] = offset + offset_indices[i];
+  }
+  return r_indices.as_span();
+}
+
+void SegmentedIndexMask::foreach_segment_as_mask(
+    const FunctionRef<void(IndexMask mask)> callback) const
+{
+  Vector<int64_t> indices;
+  this->foreach_segment([&](const IndexMaskSegment &segment) {
+    callback(segment_as_mask(segment, indices));
+  });
+}
+
+void SegmentedIndexMask::foreach_segment_as_mask_parallel(
+    const int64_t grain_size, const FunctionRef<void(IndexMask mask)> callback) const
+{
+  if (size_ <= grain_size) {
+    this->foreach_segment_as_mask(callback);
+    return;
+  }
+
+  /* Split the work into groups of roughly the grain size. Ranges larger than that are split,
+   * consecutive smaller segments are processed together. */
+  struct Part {
+    int64_t segment_index;
+    /** The part of the segment, used for ranges. */
+    IndexRange slice;
+  };
+  Vector<Part> parts;
+  Vector<int64_t> group_starts;
+  int64_t group_size = grain_size;
+  for (const int64_t segment_index : segments_.index_range()) {
+    const Segment &segment = segments_[segment_index];
+    const int64_t part_size_max = (segment.indices_start == -1) ? grain_size : segment.size;
+    for (int64_t start = 0; start < segment.size; start += part_size_max) {
+      const int64_t part_size = std::min(part_size_max, segment.size - start);
+      if (group_size >= grain_size) {
+        group_starts.append(parts.size());
+        group_size = 0;
+      }
+      parts.append({segment_index, IndexRange(start, part_size)});
+      group_size += part_size;
+    }
+  }
+  group_starts.append(parts.size());
+
+  threading::parallel_for(IndexRange(group_starts.size() - 1), 1, [&](const IndexRange groups) {
+    Vector<int64_t> indices;
+    for (const int64_t group_index : groups) {
+      for (const int64_t part_index :
+           IndexRange(group_starts[group_index],
+                      group_starts[group_index + 1] - group_starts[group_index])) {
+        const Part &part = parts[part_index];
+        const IndexMaskSegment segment = this->segment(part.segment_index);
+        if (segment.is_range()) {
+          callback(segment.as_range().slice(part.slice));
+        }
+        else {
+          callback(segment_as_mask(segment, indices));
+        }
+      }
+    }
+  });
+}
+
+void SegmentedIndexMask::to_indices(MutableSpan<int64_t> r_indices) const
+{
+  BLI_assert(r_indices.size() == size_);
+  int64_t pos = 0;
+  this->foreach_index([&](const int64_t i) { r_indices[pos++] = i; });
+}
+
+IndexMask SegmentedIndexMask::to_index_mask(Vector<int64_t> &r_indices) const
+{
+  if (this->is_empty()) {
+    return {};
+  }
+  if (this->is_range()) {
+    return this->as_range();
+  }
+  r_indices.resize(size_);
+  this->to_indices(r_indices);
+  return r_indices.as_span();
+}
+
+}  // namespace blender
@@ -0,0 +1,297 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <array>
+#include <atomic>
+
+#include "BLI_prefix_sum.hh"
+#include "BLI_sort.hh"
+#include "BLI_spatial_grid.hh"
+#include "BLI_task.hh"
+
+namespace blender {
+
+static constexpr int phases_num = 27;
+
+static uint64_t cell_key(const int64_t x, const int64_t y, const int64_t z)
+{
+  using Grid = SpatialGrid;
+  return uint64_t(x) | (uint64_t(y) << Grid::cell_bits) | (uint64_t(z) << (Grid::cell_bits * 2));
+}
+
+static int3 cell_coord(const uint64_t key)
+{
+  using Grid = SpatialGrid;
+  return int3(int(key & Grid::max_cell_coord),
+              int((key >> Grid::cell_bits) & Grid::max_cell_coord),
+              int(key >> (Grid::cell_bits * 2)));
+}
+
+/**
+ * Cells whose coordinates are equal modulo three are in the same phase. Their neighborhoods of
+ * 3x3x3 cells never overlap.
+ */
+static int cell_phase(const int3 coord)
+{
+  return coord.x % 3 + coord.y % 3 * 3 + coord.z % 3 * 9;
+}
+
+struct Bounds {
+  float3 min;
+  float3 max;
+};
+
+static Bounds calc_bounds(const Span<float3> positions)
+{
+  return threading::parallel_reduce(
+      positions.index_range(),
+      4096,
+      Bounds{positions.first(), positions.first()},
+      [&](const IndexRange range, const Bounds &init) {
+        Bounds result = init;
+        for (const int i : range) {
+          math::min_max(positions[i], result.min, result.max);
+        }
+        return result;
+      },
+      [](const Bounds &a, const Bounds &b) {
+        return Bounds{math::min(a.min, b.min), math::max(a.max, b.max)};
+      });
+}
+
+struct CellPoint {
+  uint64_t cell_key;
+  int index;
+};
+
+static float cell_size_for_bounds(const Bounds &bounds, const float cell_size)
+{
+  const float3 extent = bounds.max - bounds.min;
+  /* Larger cells only make the queries slower, so they are only used when the cell coordinates
+   * would not fit into the key otherwise. */
+  const float max_extent = std::max({extent.x, extent.y, extent.z});
+  return std::max(cell_size, max_extent / float(SpatialGrid::max_cell_coord - 1));
+}
+
+float SpatialGrid::calc_cell_size(const Span<float3> positions, const float cell_size)
+{
+  BLI_assert(cell_size > 0.0f);
+  if (positions.is_empty()) {
+    return cell_size;
+  }
+  return cell_size_for_bounds(calc_bounds(positions), cell_size);
+}
+
+SpatialGrid::SpatialGrid(const Span<float3> positions, const float cell_size)
+{
+  BLI_assert(cell_size > 0.0f);
+  /* Empty grids keep the requested cell size, so that the same queries are valid. */
+  cell_size_ = cell_size;
+  cell_size_inv_ = 1.0f / cell_size;
+  if (positions.is_empty()) {
+    return;
+  }
+  const Bounds bounds = calc_bounds(positions);
+  min_ = bounds.min;
+  cell_size_ = cell_size_for_bounds(bounds, cell_size);
+  cell_size_inv_ = 1.0f / cell_size_;
+
+  /* Sort the points by cell. Sorting is stable, so the points in a cell stay in index order. */
+  Array<CellPoint> points(positions.size());
+  threading::parallel_for(positions.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      /* Clamping also handles NaN coordinates. */
+      const int3 coord = math::max(this->clamped_cell_coord(positions[i]), int3(0));
+      points[i] = {cell_key(coord.x, coord.y, coord.z), i};
+    }
+  });
+  parallel_radix_sort(points.as_mutable_span(),
+                      [](const CellPoint &point) { return point.cell_key; });
+
+  sorted_positions_.reinitialize(points.size());
+  sorted_indices_.reinitialize(points.size());
+  Array<int> cell_offsets(points.size());
+  threading::parallel_for(points.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      sorted_positions_[i] = positions[points[i].index];
+      sorted_indices_[i] = points[i].index;
+      cell_offsets[i] = (i == 0 || points[i].cell_key != points[i - 1].cell_key) ? 1 : 0;
+    }
+  });
+
+  /* The first point of every cell is written to the position of the cell in the cell arrays. */
+  parallel_prefix_sum(cell_offsets.as_span(), cell_offsets.as_mutable_span(), true);
+  const int cells_num = cell_offsets.last();
+  cell_keys_.reinitialize(cells_num);
+  cell_starts_.reinitialize(cells_num + 1);
+  threading::parallel_for(points.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      if (i == 0 || cell_offsets[i] != cell_offsets[i - 1]) {
+        cell_keys_[cell_offsets[i] - 1] = points[i].cell_key;
+        cell_starts_[cell_offsets[i] - 1] = i;
+      }
+    }
+  });
+  cell_starts_.last() = points.size();
+}
+
+IndexRange SpatialGrid::find_row_points(const int min_x,
+                                        const int max_x,
+                                        const int y,
+                                        const int z) const
+{
+  if (y < 0 || z < 0 || y > max_cell_coord || z > max_cell_coord) {
+    return {};
+  }
+  const int64_t first_x = std::max(min_x, 0);
+  const int64_t last_x = std::min<int64_t>(max_x, max_cell_coord);
+  if (first_x > last_x) {
+    return {};
+  }
+  const uint64_t *first_cell = std::lower_bound(
+      cell_keys_.begin(), cell_keys_.end(), cell_key(first_x, y, z));
+  const uint64_t *last_cell = std::upper_bound(
+      first_cell, cell_keys_.end(), cell_key(last_x, y, z));
+  const int start = cell_starts_[first_cell - cell_keys_.begin()];
+  const int end = cell_starts_[last_cell - cell_keys_.begin()];
+  return IndexRange(start, end - start);
+}
+
+/**
+ * Find the index of the first key that is not less than the given key, which must not be before
+ * \a start. The search gallops forward, so it is fast when the result is close to the start.
+ */
+static int find_first_key_not_less(const Span<uint64_t> keys, const int start, const uint64_t key)
+{
+  BLI_assert(start == 0 || keys[start - 1] < key);
+  if (start >= keys.size() || keys[start] >= key) {
+    return start;
+  }
+  int64_t step = 1;
+  int64_t low = start;
+  int64_t high = start + step;
+  while (high < keys.size() && keys[high] < key) {
+    low = high;
+    step *= 2;
+    high = start + step;
+  }
+  high = std::min(high, keys.size());
+  return std::lower_bound(keys.begin() + low, keys.begin() + high, key) - keys.begin();
+}
+
+void SpatialGrid::foreach_cell_neighborhood(
+    const FunctionRef<void(IndexRange cell_points, Span<IndexRange> neighbor_points)> fn) const
+{
+  const int cells_num = cell_keys_.size();
+
+  /* Group the cells by phase with a counting sort. Within a phase, the cells stay sorted. */
+  Array<int> phase_offsets(phases_num + 1, 0);
+  for (const uint64_t key : cell_keys_) {
+    phase_offsets[cell_phase(cell_coord(key)) + 1]++;
+  }
+  for (const int phase : IndexRange(phases_num)) {
+    phase_offsets[phase + 1] += phase_offsets[phase];
+  }
+  Array<int> cells_by_phase(cells_num);
+  {
+    Array<int> phase_fill = phase_offsets;
+    for (const int cell : IndexRange(cells_num)) {
+      cells_by_phase[phase_fill[cell_phase(cell_coord(cell_keys_[cell]))]++] = cell;
+    }
+  }
+
+  for (const int phase : IndexRange(phases_num)) {
+    const Span<int> phase_cells = cells_by_phase.as_span().slice(
+        phase_offsets[phase], phase_offsets[phase + 1] - phase_offsets[phase]);
+    threading::parallel_for(phase_cells.index_range(), 64, [&](const IndexRange range) {
+      /* The neighboring cells are found in the nine rows of cells along the x axis around the
+       * cell. The cells of a task are processed in increasing order, so the search in every row
+       * can continue where it stopped for the previous cell. */
+      std::array<int, 9> row_cursors;
+      row_cursors.fill(0);
+      Vector<IndexRange, 9> neighbor_rows;
+      for (const int cell : phase_cells.slice(range)) {
+        const int3 coord = cell_coord(cell_keys_[cell]);
+        neighbor_rows.clear();
+        for (const int dz : IndexRange(3)) {
+          for (const int dy : IndexRange(3)) {
+            const int y = coord.y + dy - 1;
+            const int z = coord.z + dz - 1;
+            if (y < 0 || z < 0 || y > max_cell_coord || z > max_cell_coord) {
+              continue;
+            }
+            const uint64_t first_key = cell_key(std::max(coord.x - 1, 0), y, z);
+            const uint64_t last_key = cell_key(std::min<int>(coord.x + 1, max_cell_coord), y, z);
+            int &cursor = row_cursors[dz * 3 + dy];
+            cursor = find_first_key_not_less(cell_keys_, cursor, first_key);
+            int end = cursor;
+            while (end < cells_num && cell_keys_[end] <= last_key) {
+              end++;
+            }
+            if (end > cursor) {
+              /* The points of consecutive cells are contiguous as well. */
+              neighbor_rows.append(
+                  IndexRange(cell_starts_[cursor], cell_starts_[end] - cell_starts_[cursor]));
+            }
+          }
+        }
+        fn(this->cell_points(cell), neighbor_rows);
+      }
+    });
+  }
+}
+
+int SpatialGrid::calc_duplicates(const float distance, MutableSpan<int> duplicates) const
+{
+  BLI_assert(distance <= cell_size_);
+  BLI_assert(duplicates.size() == this->points_num());
+  const float distance_sq = distance * distance;
+
+  /* Work on the sorted order, so that the data of the points in a cell is contiguous. */
+  Array<int> sorted_duplicates(this->points_num());
+  threading::parallel_for(sorted_duplicates.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      sorted_duplicates[i] = duplicates[sorted_indices_[i]];
+    }
+  });
+
+  std::atomic<int> found = 0;
+  this->foreach_cell_neighborhood(
+      [&](const IndexRange cell_points, const Span<IndexRange> neighbor_points) {
+        int cell_found = 0;
+        for (const int i : cell_points) {
+          const int index = sorted_indices_[i];
+          if (!ELEM(sorted_duplicates[i], -1, index)) {
+            continue;
+          }
+          const float3 position = sorted_positions_[i];
+          const int found_prev = cell_found;
+          for (const IndexRange neighbors : neighbor_points) {
+            for (const int neighbor : neighbors) {
+              if (neighbor != i && sorted_duplicates[neighbor] == -1 &&
+                  math::distance_squared(position, sorted_positions_[neighbor]) <= distance_sq) {
+                sorted_duplicates[neighbor] = index;
+                cell_found++;
+              }
+            }
+          }
+          if (cell_found != found_prev) {
+            /* Prevent chains of doubles. */
+            sorted_duplicates[i] = index;
+          }
+        }
+        found += cell_found;
+      });
+
+  threading::parallel_for(sorted_duplicates.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      duplicates[sorted_indices_[i]] = sorted_duplicates[i];
+    }
+  });
+  return found;
+}
+
+}  // namespace blender
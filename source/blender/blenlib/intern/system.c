@@ -20,8 +20,11 @@
 #  include <intrin.h>
 
 #  include "BLI_winstuff.h"
+
+#  include <psapi.h>
 #else
 #  include <execinfo.h>
+#  include <sys/resource.h>
 #  include <unistd.h>
 #endif
 
@@ -178,3 +181,25 @@ int BLI_system_memory_max_in_megabytes_int(void)
   /* NOTE: The result will fit into integer. */
   return (int)min_zz(limit_megabytes, (size_t)INT_MAX);
 }
+
+size_t BLI_system_memory_peak_resident(void)
+{
+#ifdef WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+    return 0;
+  }
+  return counters.PeakWorkingSetSize;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return 0;
+  }
+#  ifdef __APPLE__
+  return (size_t)usage.ru_maxrss;
+#  else
+  /* In kilobytes. */
+  return (size_t)usage.ru_maxrss * 1024;
+#  endif
+#endif
+}
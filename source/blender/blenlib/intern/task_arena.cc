@@ -0,0 +1,197 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ *
+ * Task arenas and cancel tokens.
+ */
+
+#include <algorithm>
+#include <atomic>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_string.h"
+#include "BLI_task.h"
+
+#ifdef WITH_TBB
+#  include <tbb/task_arena.h>
+#  include <tbb/task_scheduler_observer.h>
+#endif
+
+/* Task Cancel Token */
+
+struct TaskCancelToken {
+  const TaskCancelToken *parent;
+  std::atomic<bool> is_canceled;
+
+  TaskCancelToken(const TaskCancelToken *parent) : parent(parent), is_canceled(false)
+  {
+  }
+};
+
+TaskCancelToken *BLI_task_cancel_token_create(const TaskCancelToken *parent)
+{
+  return MEM_new<TaskCancelToken>(__func__, parent);
+}
+
+void BLI_task_cancel_token_free(TaskCancelToken *token)
+{
+  MEM_delete(token);
+}
+
+void BLI_task_cancel_token_cancel(TaskCancelToken *token)
+{
+  token->is_canceled.store(true, std::memory_order_relaxed);
+}
+
+void BLI_task_cancel_token_reset(TaskCancelToken *token)
+{
+  token->is_canceled.store(false, std::memory_order_relaxed);
+}
+
+bool BLI_task_cancel_token_is_canceled(const TaskCancelToken *token)
+{
+  for (; token != nullptr; token = token->parent) {
+    if (token->is_canceled.load(std::memory_order_relaxed)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Task Arena
+ *
+ * The arena a thread is working for is tracked in a thread local variable. The thread calling
+ * #BLI_task_arena_execute sets it directly, worker threads joining the arena set it through an
+ * observer of the arena. */
+
+static thread_local TaskArena *current_arena = nullptr;
+
+#ifdef WITH_TBB
+class TaskArenaObserver : public tbb::task_scheduler_observer {
+ private:
+  TaskArena *arena_;
+
+ public:
+  TaskArenaObserver(tbb::task_arena &tbb_arena, TaskArena *arena)
+      : tbb::task_scheduler_observer(tbb_arena), arena_(arena)
+  {
+    observe(true);
+  }
+
+  ~TaskArenaObserver()
+  {
+    observe(false);
+  }
+
+  void on_scheduler_entry(bool is_worker) override
+  {
+    if (is_worker) {
+      current_arena = arena_;
+    }
+  }
+
+  void on_scheduler_exit(bool is_worker) override
+  {
+    if (is_worker) {
+      current_arena = nullptr;
+    }
+  }
+};
+
+static tbb::task_arena *tbb_arena_create(const int num_threads, const eTaskPriority priority)
+{
+  const int max_concurrency = (num_threads > 0) ? num_threads : tbb::task_arena::automatic;
+#  if TBB_INTERFACE_VERSION_MAJOR >= 12
+  /* Only the priority of arenas is taken into account by TBB 2021. */
+  const tbb::task_arena::priority tbb_priority = (priority == TASK_PRIORITY_LOW) ?
+                                                      tbb::task_arena::priority::low :
+                                                      tbb::task_arena::priority::normal;
+  return MEM_new<tbb::task_arena>(__func__, max_concurrency, 1, tbb_priority);
+#  else
+  /* Older versions only support priorities for task groups, task pools created in the arena
+   * inherit its priority instead. */
+  UNUSED_VARS(priority);
+  return MEM_new<tbb::task_arena>(__func__, max_concurrency, 1);
+#  endif
+}
+#endif
+
+struct TaskArena {
+  char name[64];
+  int num_threads;
+  eTaskPriority priority;
+  const TaskCancelToken *cancel_token;
+#ifdef WITH_TBB
+  tbb::task_arena *tbb_arena;
+  TaskArenaObserver *observer;
+#endif
+};
+
+TaskArena *BLI_task_arena_create(const char *name, int num_threads, eTaskPriority priority)
+{
+  TaskArena *arena = (TaskArena *)MEM_callocN(sizeof(TaskArena), "TaskArena");
+  BLI_strncpy(arena->name, name, sizeof(arena->name));
+  arena->num_threads = num_threads;
+  arena->priority = priority;
+#ifdef WITH_TBB
+  arena->tbb_arena = tbb_arena_create(num_threads, priority);
+  arena->observer = MEM_new<TaskArenaObserver>(__func__, *arena->tbb_arena, arena);
+#endif
+  return arena;
+}
+
+void BLI_task_arena_free(TaskArena *arena)
+{
+#ifdef WITH_TBB
+  /* The observer has to stop observing before its arena is destructed. */
+  MEM_delete(arena->observer);
+  MEM_delete(arena->tbb_arena);
+#endif
+  MEM_freeN(arena);
+}
+
+void BLI_task_arena_execute(TaskArena *arena, void (*func)(void *userdata), void *userdata)
+{
+  /* Arenas may be nested, for example when a job is started from a task of another arena. */
+  TaskArena *prev_arena = current_arena;
+  current_arena = arena;
+#ifdef WITH_TBB
+  arena->tbb_arena->execute([&] { func(userdata); });
+#else
+  func(userdata);
+#endif
+  current_arena = prev_arena;
+}
+
+const char *BLI_task_arena_name(const TaskArena *arena)
+{
+  return arena->name;
+}
+
+int BLI_task_arena_num_threads(const TaskArena *arena)
+{
+  const int num_threads = BLI_task_scheduler_num_threads();
+  return (arena->num_threads > 0) ? std::min(arena->num_threads, num_threads) : num_threads;
+}
+
+eTaskPriority BLI_task_arena_priority(const TaskArena *arena)
+{
+  return arena->priority;
+}
+
+TaskArena *BLI_task_arena_current()
+{
+  return current_arena;
+}
+
+void BLI_task_arena_cancel_token_set(TaskArena *arena, const TaskCancelToken *token)
+{
+  arena->cancel_token = token;
+}
+
+const TaskCancelToken *BLI_task_cancel_token_current()
+{
+  return (current_arena != nullptr) ? current_arena->cancel_token : nullptr;
+}
@@ -110,9 +110,9 @@ class TBBTaskGroup : public tbb::task_group {
   TBBTaskGroup(eTaskPriority priority)
   {
 #  if TBB_INTERFACE_VERSION_MAJOR >= 12
-    /* TODO: support priorities in TBB 2021, where they are only available as
-     * part of task arenas, no longer for task groups. Or remove support for
-     * task priorities if they are no longer useful. */
+    /* Priorities are only available as part of task arenas in TBB 2021, tasks
+     * of the group run with the priority of the arena they are pushed in.
+     * See #BLI_task_arena_create. */
     UNUSED_VARS(priority);
 #  else
     switch (priority) {
@@ -145,6 +145,9 @@ struct TaskPool {
   ThreadMutex user_mutex;
   void *userdata;
 
+  /* Optional token to skip tasks once canceled. */
+  const TaskCancelToken *cancel_token;
+
 #ifdef WITH_TBB
   /* TBB task pool. */
   TBBTaskGroup tbb_group;
@@ -161,6 +164,9 @@ struct TaskPool {
 /* Execute task. */
 void Task::operator()() const
 {
+  if (BLI_task_cancel_token_is_canceled(pool->cancel_token)) {
+    return;
+  }
   run(pool, taskdata);
 }
 
@@ -360,6 +366,12 @@ static TaskPool *task_pool_create_ex(void *userdata, TaskPoolType type, eTaskPri
     type = TASK_POOL_TBB;
   }
 
+  /* Pools created by low priority work should not take precedence over other work. */
+  const TaskArena *arena = BLI_task_arena_current();
+  if (arena != nullptr && BLI_task_arena_priority(arena) == TASK_PRIORITY_LOW) {
+    priority = TASK_PRIORITY_LOW;
+  }
+
   /* Allocate task pool. */
   TaskPool *pool = (TaskPool *)MEM_callocN(sizeof(TaskPool), "TaskPool");
 
@@ -509,6 +521,9 @@ void BLI_task_pool_cancel(TaskPool *pool)
 
 bool BLI_task_pool_current_canceled(TaskPool *pool)
 {
+  if (BLI_task_cancel_token_is_canceled(pool->cancel_token)) {
+    return true;
+  }
   switch (pool->type) {
     case TASK_POOL_TBB:
     case TASK_POOL_TBB_SUSPENDED:
@@ -522,6 +537,11 @@ bool BLI_task_pool_current_canceled(TaskPool *pool)
   return false;
 }
 
+void BLI_task_pool_cancel_token_set(TaskPool *pool, const TaskCancelToken *token)
+{
+  pool->cancel_token = token;
+}
+
 void *BLI_task_pool_user_data(TaskPool *pool)
 {
   return pool->userdata;
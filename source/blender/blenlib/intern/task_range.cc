@@ -6,13 +6,23 @@
  * Task parallel range functions.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "MEM_guardedalloc.h"
 
 #include "DNA_listBase.h"
 
 #include "BLI_task.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
 
 #include "atomic_ops.h"
@@ -151,3 +161,136 @@ int BLI_task_parallel_thread_id(const TaskParallelTLS *UNUSED(tls))
   return 0;
 #endif
 }
+
+/* Adaptive Grain Size */
+
+namespace blender::threading::detail {
+
+/**
+ * Every task should take about this long, so that the overhead of scheduling it is small compared
+ * to the work it does, while keeping tasks small enough for balancing the load between threads.
+ */
+static constexpr double adaptive_task_seconds = 100e-6;
+
+int64_t adaptive_grain_size(const int64_t sampled_iterations,
+                            const double sampled_seconds,
+                            const int64_t remaining_iterations)
+{
+  if (BLI_task_scheduler_num_threads() == 1) {
+    return remaining_iterations;
+  }
+  const double seconds_per_iteration = sampled_seconds / double(sampled_iterations);
+  if (seconds_per_iteration * double(remaining_iterations) < 2.0 * adaptive_task_seconds) {
+    /* Not enough work left to keep two threads busy. */
+    return remaining_iterations;
+  }
+  const double grain_size = adaptive_task_seconds / seconds_per_iteration;
+  return std::clamp<int64_t>(int64_t(grain_size), 1, remaining_iterations);
+}
+
+}  // namespace blender::threading::detail
+
+/* Parallel For Profiling
+ *
+ * Call sites are identified by the address of #parallel_for_call_site for their function type. The
+ * names of lambdas in the same function can be the same, depending on the compiler. */
+
+namespace blender::threading::detail {
+
+struct ParallelForProfileStats {
+  int64_t calls = 0;
+  int64_t iterations = 0;
+  int64_t grain_size_sum = 0;
+  double seconds = 0.0;
+};
+
+/* Standard containers are used so that the statistics are not reported as leaked memory. */
+static std::atomic<bool> profile_enabled = false;
+static std::mutex profile_mutex;
+static std::unordered_map<const ParallelForCallSite *, ParallelForProfileStats> profile_stats;
+
+bool parallel_for_profile_is_enabled()
+{
+  return profile_enabled.load(std::memory_order_relaxed);
+}
+
+double parallel_for_seconds()
+{
+  const std::chrono::duration<double> time =
+      std::chrono::steady_clock::now().time_since_epoch();
+  return time.count();
+}
+
+void parallel_for_profile_add(const ParallelForCallSite &call_site,
+                              const int64_t iterations,
+                              const int64_t grain_size,
+                              const double start_seconds)
+{
+  const double seconds = parallel_for_seconds() - start_seconds;
+  std::lock_guard lock{profile_mutex};
+  ParallelForProfileStats &stats = profile_stats[&call_site];
+  stats.calls++;
+  stats.iterations += iterations;
+  stats.grain_size_sum += grain_size;
+  stats.seconds += seconds;
+}
+
+/** Only keep the name of the function type from the signature of #parallel_for_call_site. */
+static std::string call_site_name(const std::string &signature)
+{
+#ifdef _MSC_VER
+  const char *prefix = "parallel_for_call_site<";
+  const char *suffix = ">(void)";
+#else
+  const char *prefix = "Function = ";
+  const char *suffix = "]";
+#endif
+  const size_t start = signature.find(prefix);
+  const size_t end = signature.rfind(suffix);
+  if (start == std::string::npos || end == std::string::npos || end < start) {
+    return signature;
+  }
+  const size_t name_start = start + strlen(prefix);
+  return signature.substr(name_start, end - name_start);
+}
+
+}  // namespace blender::threading::detail
+
+void BLI_task_parallel_profile_enable()
+{
+  blender::threading::detail::profile_enabled = true;
+}
+
+void BLI_task_parallel_profile_disable()
+{
+  using namespace blender::threading::detail;
+  profile_enabled = false;
+  std::lock_guard lock{profile_mutex};
+  profile_stats.clear();
+}
+
+void BLI_task_parallel_profile_print()
+{
+  using namespace blender::threading::detail;
+  if (!parallel_for_profile_is_enabled()) {
+    return;
+  }
+
+  std::lock_guard lock{profile_mutex};
+  std::vector<std::pair<const ParallelForCallSite *, ParallelForProfileStats>> sorted_stats(
+      profile_stats.begin(), profile_stats.end());
+  std::sort(sorted_stats.begin(), sorted_stats.end(), [](const auto &a, const auto &b) {
+    return a.second.seconds > b.second.seconds;
+  });
+
+  printf("Parallel for profile, sorted by total time:\n");
+  for (const auto &[call_site, stats] : sorted_stats) {
+    printf("%10.3f ms, %8lld calls, %12lld iterations, %10.1f ns/iteration, grain size %lld\n",
+           stats.seconds * 1e3,
+           (long long)stats.calls,
+           (long long)stats.iterations,
+           stats.seconds * 1e9 / double(std::max<int64_t>(stats.iterations, 1)),
+           (long long)(stats.grain_size_sum / stats.calls));
+    printf("    %s\n", call_site_name(call_site->name).c_str());
+  }
+}
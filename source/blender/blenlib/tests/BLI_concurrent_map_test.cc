@@ -0,0 +1,124 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_concurrent_map.hh"
+#include "BLI_vector.hh"
+
+namespace blender::tests {
+
+TEST(concurrent_map, AddLookup)
+{
+  ConcurrentMap<int, int> map;
+  EXPECT_TRUE(map.is_empty());
+  EXPECT_TRUE(map.add(1, 10));
+  EXPECT_FALSE(map.add(1, 20));
+  EXPECT_EQ(map.lookup_or_add(2, 30), 30);
+  EXPECT_EQ(map.lookup_or_add(2, 40), 30);
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_EQ(map.lookup(1), 10);
+  EXPECT_EQ(*map.lookup_ptr(2), 30);
+  EXPECT_EQ(map.lookup_ptr(3), nullptr);
+  EXPECT_TRUE(map.contains(1));
+  EXPECT_FALSE(map.contains(3));
+  map.clear();
+  EXPECT_TRUE(map.is_empty());
+}
+
+TEST(concurrent_map, ShardsContainAllKeys)
+{
+  ConcurrentMap<int, int> map(8);
+  EXPECT_EQ(map.shards_num(), 8);
+  for (int i = 0; i < 1000; i++) {
+    map.add(i, i);
+  }
+  int64_t size = 0;
+  for (int64_t i = 0; i < map.shards_num(); i++) {
+    size += map.shard(i).size();
+  }
+  EXPECT_EQ(size, 1000);
+}
+
+TEST(concurrent_map, ParallelAddOrModify)
+{
+  ConcurrentMap<int, int> map;
+  threading::parallel_for(IndexRange(100000), 256, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      map.add_or_modify(
+          int(i % 1000), [](int *value) { *value = 1; }, [](int *value) { (*value)++; });
+    }
+  });
+  EXPECT_EQ(map.size(), 1000);
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(map.lookup(i), 100);
+  }
+}
+
+TEST(concurrent_map, AddParallel)
+{
+  ConcurrentMap<int, int> map;
+  map.add(5, -1);
+  /* Every key is added 4 times, the first index wins. */
+  map.add_parallel(
+      IndexRange(40000),
+      100,
+      [&](const IndexRange range, ConcurrentMap<int, int>::ParallelAdder &adder) {
+        for (const int64_t i : range) {
+          adder.add(int(i % 10000), int(i));
+        }
+      },
+      [](int &value, int new_value) { value = std::min(value, new_value); });
+  EXPECT_EQ(map.size(), 10000);
+  EXPECT_EQ(map.lookup(5), -1);
+  for (int i = 0; i < 10000; i++) {
+    if (i != 5) {
+      EXPECT_EQ(map.lookup(i), i);
+    }
+  }
+}
+
+TEST(concurrent_map, AddParallelDeterministic)
+{
+  /* The order of the items in the shards does not depend on the grain size. */
+  auto build = [](const int64_t grain_size) {
+    Vector<int> keys;
+    ConcurrentMap<int, int> map(4);
+    map.add_parallel(
+        IndexRange(5000),
+        grain_size,
+        [&](const IndexRange range, ConcurrentMap<int, int>::ParallelAdder &adder) {
+          for (const int64_t i : range) {
+            adder.add(int((i * 7919) % 3000), 0);
+          }
+        },
+        [](int & /*value*/, int /*new_value*/) {});
+    for (int64_t i = 0; i < map.shards_num(); i++) {
+      for (const int key : map.shard(i).keys()) {
+        keys.append(key);
+      }
+    }
+    return keys;
+  };
+  const Vector<int> keys_a = build(1);
+  const Vector<int> keys_b = build(1000);
+  EXPECT_EQ(keys_a.size(), 3000);
+  EXPECT_EQ(keys_a.as_span(), keys_b.as_span());
+}
+
+TEST(concurrent_map, StringKeys)
+{
+  ConcurrentMap<std::string, int> map(1);
+  map.add_parallel(
+      IndexRange(100),
+      10,
+      [&](const IndexRange range, ConcurrentMap<std::string, int>::ParallelAdder &adder) {
+        for (const int64_t i : range) {
+          adder.add(std::to_string(i % 10), 1);
+        }
+      },
+      [](int &value, int new_value) { value += new_value; });
+  EXPECT_EQ(map.size(), 10);
+  EXPECT_EQ(map.lookup("3"), 10);
+}
+
+}  // namespace blender::tests
@@ -0,0 +1,331 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_kdtree.h"
+#include "BLI_math_vector.hh"
+#include "BLI_rand.hh"
+#include "BLI_vector.hh"
+
+#include <algorithm>
+#include <atomic>
+
+namespace blender::tests {
+
+/* Sizes around the leaf size and larger than the threshold for the parallel build. */
+static constexpr int tree_sizes[] = {0, 1, 15, 16, 17, 100, 1000, 50000};
+
+static Array<float3> random_points(const int size, const uint32_t seed)
+{
+  RandomNumberGenerator rng(seed);
+  Array<float3> points(size);
+  for (float3 &point : points) {
+    point = rng.get_unit_float3() * rng.get_float();
+  }
+  /* Add some exact duplicates and points on the same axis aligned planes. */
+  for (int i = 3; i < size; i += 7) {
+    points[i] = points[i / 2];
+  }
+  for (int i = 5; i < size; i += 11) {
+    points[i].x = points[i - 1].x;
+  }
+  return points;
+}
+
+static KDTree_3d *build_tree(const Span<float3> points)
+{
+  KDTree_3d *tree = BLI_kdtree_3d_new(uint(points.size()));
+  for (const int i : points.index_range()) {
+    BLI_kdtree_3d_insert(tree, i, points[i]);
+  }
+  BLI_kdtree_3d_balance(tree);
+  return tree;
+}
+
+static float nearest_distance(const Span<float3> points, const float3 &co)
+{
+  float min_dist = FLT_MAX;
+  for (const float3 &point : points) {
+    min_dist = std::min(min_dist, math::distance(point, co));
+  }
+  return min_dist;
+}
+
+static Vector<int> indices_in_range(const Span<float3> points, const float3 &co, const float range)
+{
+  Vector<int> indices;
+  for (const int i : points.index_range()) {
+    if (math::distance_squared(points[i], co) <= range * range) {
+      indices.append(i);
+    }
+  }
+  return indices;
+}
+
+TEST(kdtree, FindNearest)
+{
+  for (const int size : tree_sizes) {
+    const Array<float3> points = random_points(size, 0);
+    const Array<float3> queries = random_points(500, 1);
+    KDTree_3d *tree = build_tree(points);
+    for (const float3 &co : queries) {
+      KDTreeNearest_3d nearest;
+      const int index = BLI_kdtree_3d_find_nearest(tree, co, &nearest);
+      if (size == 0) {
+        EXPECT_EQ(index, -1);
+        continue;
+      }
+      EXPECT_EQ(index, nearest.index);
+      EXPECT_EQ(nearest.dist, math::distance(points[index], co));
+      EXPECT_EQ(nearest.dist, nearest_distance(points, co));
+    }
+    BLI_kdtree_3d_free(tree);
+  }
+}
+
+TEST(kdtree, FindNearestExisting)
+{
+  const Array<float3> points = random_points(1000, 2);
+  KDTree_3d *tree = build_tree(points);
+  for (const float3 &co : points) {
+    KDTreeNearest_3d nearest;
+    BLI_kdtree_3d_find_nearest(tree, co, &nearest);
+    EXPECT_EQ(nearest.dist, 0.0f);
+  }
+  BLI_kdtree_3d_free(tree);
+}
+
+static int filter_even(void * /*user_data*/, int index, const float * /*co*/, float /*dist_sq*/)
+{
+  return index % 2 == 0 ? 1 : 0;
+}
+
+TEST(kdtree, FindNearestCallback)
+{
+  for (const int size : tree_sizes) {
+    const Array<float3> points = random_points(size, 3);
+    Vector<float3> even_points;
+    for (const int i : points.index_range()) {
+      if (i % 2 == 0) {
+        even_points.append(points[i]);
+      }
+    }
+    KDTree_3d *tree = build_tree(points);
+    for (const float3 &co : random_points(200, 4)) {
+      KDTreeNearest_3d nearest;
+      const int index = BLI_kdtree_3d_find_nearest_cb(tree, co, filter_even, nullptr, &nearest);
+      if (size == 0) {
+        EXPECT_EQ(index, -1);
+        continue;
+      }
+      EXPECT_EQ(index % 2, 0);
+      EXPECT_EQ(nearest.dist, nearest_distance(even_points, co));
+    }
+    BLI_kdtree_3d_free(tree);
+  }
+}
+
+TEST(kdtree, FindNearestN)
+{
+  constexpr int n = 12;
+  for (const int size : tree_sizes) {
+    const Array<float3> points = random_points(size, 5);
+    KDTree_3d *tree = build_tree(points);
+    for (const float3 &co : random_points(100, 6)) {
+      Array<float> expected(size);
+      for (const int i : points.index_range()) {
+        expected[i] = math::distance(points[i], co);
+      }
+      std::sort(expected.begin(), expected.end());
+
+      KDTreeNearest_3d nearest[n];
+      const int found = BLI_kdtree_3d_find_nearest_n(tree, co, nearest, n);
+      EXPECT_EQ(found, std::min(n, size));
+      for (const int i : IndexRange(found)) {
+        EXPECT_FLOAT_EQ(nearest[i].dist, expected[i]);
+      }
+    }
+    BLI_kdtree_3d_free(tree);
+  }
+}
+
+TEST(kdtree, RangeSearch)
+{
+  for (const int size : tree_sizes) {
+    const Array<float3> points = random_points(size, 7);
+    KDTree_3d *tree = build_tree(points);
+    for (const float3 &co : random_points(100, 8)) {
+      const float range = 0.2f;
+      KDTreeNearest_3d *nearest = nullptr;
+      const int found = BLI_kdtree_3d_range_search(tree, co, &nearest, range);
+      Vector<int> indices;
+      for (const int i : IndexRange(found)) {
+        indices.append(nearest[i].index);
+        if (i > 0) {
+          EXPECT_LE(nearest[i - 1].dist, nearest[i].dist);
+        }
+      }
+      std::sort(indices.begin(), indices.end());
+      EXPECT_EQ(indices.as_span(), indices_in_range(points, co, range).as_span());
+      MEM_SAFE_FREE(nearest);
+    }
+    BLI_kdtree_3d_free(tree);
+  }
+}
+
+static bool append_index(void *user_data, int index, const float * /*co*/, float /*dist_sq*/)
+{
+  static_cast<Vector<int> *>(user_data)->append(index);
+  return true;
+}
+
+TEST(kdtree, RangeSearchCallback)
+{
+  for (const int size : tree_sizes) {
+    const Array<float3> points = random_points(size, 9);
+    KDTree_3d *tree = build_tree(points);
+    for (const float3 &co : random_points(100, 10)) {
+      Vector<int> indices;
+      BLI_kdtree_3d_range_search_cb(tree, co, 0.1f, append_index, &indices);
+      std::sort(indices.begin(), indices.end());
+      EXPECT_EQ(indices.as_span(), indices_in_range(points, co, 0.1f).as_span());
+    }
+    BLI_kdtree_3d_free(tree);
+  }
+}
+
+TEST(kdtree, FindNearestBatch)
+{
+  for (const int size : tree_sizes) {
+    const Array<float3> points = random_points(size, 11);
+    const Array<float3> queries = random_points(5000, 12);
+    KDTree_3d *tree = build_tree(points);
+    Array<int> indices(queries.size());
+    Array<KDTreeNearest_3d> nearest(queries.size());
+    BLI_kdtree_3d_find_nearest_batch(tree,
+                                     reinterpret_cast<const float(*)[3]>(queries.data()),
+                                     int(queries.size()),
+                                     indices.data(),
+                                     nearest.data());
+    for (const int i : queries.index_range()) {
+      EXPECT_EQ(indices[i], BLI_kdtree_3d_find_nearest(tree, queries[i], nullptr));
+      if (size > 0) {
+        EXPECT_EQ(nearest[i].index, indices[i]);
+      }
+    }
+    BLI_kdtree_3d_free(tree);
+  }
+}
+
+struct RangeSearchBatchData {
+  Array<std::atomic<int>> counts;
+  std::atomic<int> total = 0;
+
+  RangeSearchBatchData(const int64_t size) : counts(size)
+  {
+    for (std::atomic<int> &count : counts) {
+      count = 0;
+    }
+  }
+};
+
+static bool count_in_range(
+    void *user_data, int co_index, int /*index*/, const float * /*co*/, float /*dist_sq*/)
+{
+  RangeSearchBatchData &data = *static_cast<RangeSearchBatchData *>(user_data);
+  data.counts[co_index]++;
+  data.total++;
+  return true;
+}
+
+TEST(kdtree, RangeSearchBatch)
+{
+  const Array<float3> points = random_points(20000, 13);
+  const Array<float3> queries = random_points(3000, 14);
+  KDTree_3d *tree = build_tree(points);
+  RangeSearchBatchData data(queries.size());
+  BLI_kdtree_3d_range_search_batch_cb(tree,
+                                      reinterpret_cast<const float(*)[3]>(queries.data()),
+                                      int(queries.size()),
+                                      0.05f,
+                                      count_in_range,
+                                      &data);
+  int total = 0;
+  for (const int i : queries.index_range()) {
+    const int expected = int(indices_in_range(points, queries[i], 0.05f).size());
+    EXPECT_EQ(data.counts[i], expected);
+    total += expected;
+  }
+  EXPECT_EQ(data.total, total);
+  BLI_kdtree_3d_free(tree);
+}
+
+TEST(kdtree, CalcDuplicatesFast)
+{
+  for (const int size : tree_sizes) {
+    const Array<float3> points = random_points(size, 15);
+    KDTree_3d *tree = build_tree(points);
+    Array<int> duplicates(size, -1);
+    const int found = BLI_kdtree_3d_calc_duplicates_fast(tree, 1e-6f, true, duplicates.data());
+    for (const int i : points.index_range()) {
+      const int target = duplicates[i];
+      if (!ELEM(target, -1, i)) {
+        /* Targets aren't merged themselves, and come first in index order. */
+        EXPECT_EQ(points[target], points[i]);
+        EXPECT_TRUE(ELEM(duplicates[target], -1, target));
+        EXPECT_LT(target, i);
+      }
+    }
+    /* Every point that has an equal point with a smaller index is merged. */
+    Array<float3> sorted_points = points;
+    std::sort(sorted_points.begin(), sorted_points.end(), [](const float3 &a, const float3 &b) {
+      return std::lexicographical_compare(&a.x, &a.x + 3, &b.x, &b.x + 3);
+    });
+    int expected = 0;
+    for (const int i : sorted_points.index_range()) {
+      if (i > 0 && sorted_points[i] == sorted_points[i - 1]) {
+        expected++;
+      }
+    }
+    EXPECT_EQ(found, expected);
+    BLI_kdtree_3d_free(tree);
+  }
+}
+
+TEST(kdtree, BalanceTwice)
+{
+  const Array<float3> points = random_points(30000, 16);
+  KDTree_3d *tree = build_tree(points);
+  BLI_kdtree_3d_balance(tree);
+  for (const float3 &co : random_points(200, 17)) {
+    KDTreeNearest_3d nearest;
+    BLI_kdtree_3d_find_nearest(tree, co, &nearest);
+    EXPECT_EQ(nearest.dist, nearest_distance(points, co));
+  }
+  BLI_kdtree_3d_free(tree);
+}
+
+TEST(kdtree, Deduplicate)
+{
+  const Array<float3> points = random_points(10000, 18);
+  KDTree_3d *tree = BLI_kdtree_3d_new(uint(points.size()));
+  for (const int i : points.index_range()) {
+    BLI_kdtree_3d_insert(tree, i, points[i]);
+  }
+  const int unique_num = BLI_kdtree_3d_deduplicate(tree);
+  BLI_kdtree_3d_balance(tree);
+  int expected = 0;
+  for (const int i : points.index_range()) {
+    if (std::find(points.begin(), points.begin() + i, points[i]) == points.begin() + i) {
+      expected++;
+      KDTreeNearest_3d nearest;
+      BLI_kdtree_3d_find_nearest(tree, points[i], &nearest);
+      EXPECT_EQ(nearest.dist, 0.0f);
+    }
+  }
+  EXPECT_EQ(unique_num, expected);
+  BLI_kdtree_3d_free(tree);
+}
+
+}  // namespace blender::tests
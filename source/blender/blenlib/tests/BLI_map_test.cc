@@ -653,6 +653,117 @@ TEST(map, LookupKey)
   EXPECT_EQ(map.lookup_key_ptr("a"), map.lookup_key_ptr_as("a"));
 }
 
+TEST(map, GroupProbingAddLookupRemove)
+{
+  Map<int, int, 4, GroupProbingStrategy> map;
+  for (int i = 0; i < 10000; i++) {
+    map.add_new(i * 3, i);
+  }
+  EXPECT_EQ(map.size(), 10000);
+  for (int i = 0; i < 30000; i++) {
+    if (i % 3 == 0) {
+      EXPECT_EQ(map.lookup(i), i / 3);
+    }
+    else {
+      EXPECT_FALSE(map.contains(i));
+    }
+  }
+  for (int i = 0; i < 5000; i++) {
+    EXPECT_TRUE(map.remove(i * 6));
+  }
+  EXPECT_EQ(map.size(), 5000);
+  for (int i = 0; i < 10000; i++) {
+    EXPECT_EQ(map.contains(i * 3), i % 2 == 1);
+  }
+  /* Removed slots are reused. */
+  for (int i = 0; i < 5000; i++) {
+    EXPECT_TRUE(map.add(i * 6, -i));
+  }
+  EXPECT_EQ(map.lookup(600), -100);
+  EXPECT_EQ(map.size(), 10000);
+}
+
+TEST(map, GroupProbingSmallMap)
+{
+  /* The inline buffer has fewer slots than a group. */
+  Map<int, int, 2, GroupProbingStrategy> map;
+  EXPECT_FALSE(map.contains(0));
+  map.add(1, 10);
+  map.add(2, 20);
+  EXPECT_EQ(map.lookup(1), 10);
+  EXPECT_EQ(map.lookup(2), 20);
+  EXPECT_FALSE(map.contains(3));
+  map.remove(1);
+  EXPECT_FALSE(map.contains(1));
+  EXPECT_EQ(map.lookup_or_add(1, 5), 5);
+  EXPECT_EQ(map.size(), 2);
+  map.clear();
+  EXPECT_TRUE(map.is_empty());
+  EXPECT_FALSE(map.contains(2));
+}
+
+TEST(map, GroupProbingCopyMove)
+{
+  Map<std::string, int, 4, GroupProbingStrategy> map;
+  for (int i = 0; i < 100; i++) {
+    map.add(std::to_string(i), i);
+  }
+  Map<std::string, int, 4, GroupProbingStrategy> map_copy = map;
+  Map<std::string, int, 4, GroupProbingStrategy> map_moved = std::move(map);
+  EXPECT_EQ(map.size(), 0); /* NOLINT: bugprone-use-after-move */
+  EXPECT_FALSE(map.contains("5"));
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(map_copy.lookup(std::to_string(i)), i);
+    EXPECT_EQ(map_moved.lookup(std::to_string(i)), i);
+  }
+  map_copy.remove("50");
+  EXPECT_FALSE(map_copy.contains("50"));
+  EXPECT_TRUE(map_moved.contains("50"));
+}
+
+TEST(map, GroupProbingRemoveDuringIteration)
+{
+  Map<int, int, 4, GroupProbingStrategy> map;
+  for (int i = 0; i < 1000; i++) {
+    map.add(i, i);
+  }
+  using Iter = Map<int, int, 4, GroupProbingStrategy>::MutableItemIterator;
+  Iter begin = map.items().begin();
+  Iter end = map.items().end();
+  for (Iter iter = begin; iter != end; ++iter) {
+    if ((*iter).key % 2 == 0) {
+      map.remove(iter);
+    }
+  }
+  EXPECT_EQ(map.size(), 500);
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(map.contains(i), i % 2 == 1);
+  }
+}
+
+TEST(map, GroupProbingCollidingHashes)
+{
+  /* Many keys with the same hash, so that a single group overflows. */
+  struct ConstantHash {
+    uint64_t operator()(const int /*value*/) const
+    {
+      return 42;
+    }
+  };
+  Map<int, int, 4, GroupProbingStrategy, ConstantHash> map;
+  for (int i = 0; i < 100; i++) {
+    map.add_new(i, i);
+  }
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(map.lookup(i), i);
+  }
+  for (int i = 0; i < 50; i++) {
+    map.remove(i);
+  }
+  EXPECT_FALSE(map.contains(10));
+  EXPECT_EQ(map.lookup(80), 80);
+}
+
 /**
  * Set this to 1 to activate the benchmark. It is disabled by default, because it prints a lot.
  */
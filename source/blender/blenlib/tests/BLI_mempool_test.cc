@@ -0,0 +1,136 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include <algorithm>
+#include <thread>
+
+#include "BLI_mempool.h"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
+
+namespace blender::tests {
+
+static Vector<int> mempool_values(BLI_mempool *pool)
+{
+  Vector<int> values;
+  BLI_mempool_iter iter;
+  BLI_mempool_iternew(pool, &iter);
+  while (const int *value = static_cast<const int *>(BLI_mempool_iterstep(&iter))) {
+    values.append(*value);
+  }
+  return values;
+}
+
+TEST(mempool, AllocIter)
+{
+  BLI_mempool *pool = BLI_mempool_create(sizeof(int), 0, 32, BLI_MEMPOOL_ALLOW_ITER);
+  Vector<int *> elems;
+  for (const int i : IndexRange(100)) {
+    int *elem = static_cast<int *>(BLI_mempool_alloc(pool));
+    *elem = i;
+    elems.append(elem);
+  }
+  for (const int i : IndexRange(50)) {
+    BLI_mempool_free(pool, elems[i * 2]);
+  }
+  EXPECT_EQ(BLI_mempool_len(pool), 50);
+
+  const Vector<int> values = mempool_values(pool);
+  EXPECT_EQ(values.size(), 50);
+  for (const int i : values.index_range()) {
+    EXPECT_EQ(values[i], i * 2 + 1);
+  }
+  BLI_mempool_destroy(pool);
+}
+
+TEST(mempool, ThreadAlloc)
+{
+  const int elems_num = 100000;
+  BLI_mempool *pool = BLI_mempool_create(sizeof(int), 1000, 512, BLI_MEMPOOL_ALLOW_ITER);
+  threading::parallel_for(IndexRange(elems_num), 1000, [&](const IndexRange range) {
+    BLI_mempool_thread thread;
+    BLI_mempool_thread_begin(pool, &thread);
+    for (const int i : range) {
+      int *elem = static_cast<int *>(BLI_mempool_thread_alloc(&thread));
+      *elem = i;
+    }
+    BLI_mempool_thread_end(&thread);
+  });
+  EXPECT_EQ(BLI_mempool_len(pool), elems_num);
+
+  /* Elements of different threads may be interleaved, but none is missing. */
+  Vector<int> values = mempool_values(pool);
+  std::sort(values.begin(), values.end());
+  ASSERT_EQ(values.size(), elems_num);
+  for (const int i : values.index_range()) {
+    EXPECT_EQ(values[i], i);
+  }
+  BLI_mempool_destroy(pool);
+}
+
+TEST(mempool, ThreadFreeFromOtherThreads)
+{
+  const int threads_num = 4;
+  const int elems_per_thread = 10000;
+  BLI_mempool *pool = BLI_mempool_create(sizeof(int), 0, 256, BLI_MEMPOOL_ALLOW_ITER);
+
+  Vector<int *> elems;
+  for (const int i : IndexRange(threads_num * elems_per_thread)) {
+    int *elem = static_cast<int *>(BLI_mempool_alloc(pool));
+    *elem = i;
+    elems.append(elem);
+  }
+
+  /* Every thread frees every second element of its range and allocates new elements, which
+   * partially reuses the freed ones. */
+  Vector<std::thread> threads;
+  for (const int thread_i : IndexRange(threads_num)) {
+    threads.append(std::thread([&, thread_i]() {
+      BLI_mempool_thread thread;
+      BLI_mempool_thread_begin(pool, &thread);
+      const IndexRange range(thread_i * elems_per_thread, elems_per_thread);
+      for (const int i : range) {
+        if (i % 2 == 0) {
+          BLI_mempool_thread_free(&thread, elems[i]);
+        }
+      }
+      for (const int i : IndexRange(elems_per_thread / 4)) {
+        int *elem = static_cast<int *>(BLI_mempool_thread_calloc(&thread));
+        EXPECT_EQ(*elem, 0);
+        *elem = -1 - (thread_i * elems_per_thread + i);
+      }
+      BLI_mempool_thread_end(&thread);
+    }));
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  const int expected_len = threads_num * (elems_per_thread / 2 + elems_per_thread / 4);
+  EXPECT_EQ(BLI_mempool_len(pool), expected_len);
+
+  Vector<int> values = mempool_values(pool);
+  ASSERT_EQ(values.size(), expected_len);
+  int odd_num = 0;
+  int new_num = 0;
+  for (const int value : values) {
+    if (value < 0) {
+      new_num++;
+    }
+    else {
+      EXPECT_EQ(value % 2, 1);
+      odd_num++;
+    }
+  }
+  EXPECT_EQ(odd_num, threads_num * elems_per_thread / 2);
+  EXPECT_EQ(new_num, threads_num * elems_per_thread / 4);
+
+  /* The regular API can be used again after all threads have ended. */
+  int *elem = static_cast<int *>(BLI_mempool_alloc(pool));
+  *elem = 1;
+  EXPECT_EQ(BLI_mempool_len(pool), expected_len + 1);
+  BLI_mempool_destroy(pool);
+}
+
+}  // namespace blender::tests
@@ -0,0 +1,111 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_prefix_sum.hh"
+#include "BLI_rand.hh"
+
+namespace blender::tests {
+
+static Array<int> random_ints(const int64_t size, const int max, const int seed)
+{
+  RandomNumberGenerator rng(seed);
+  Array<int> values(size);
+  for (int &value : values) {
+    value = rng.get_int32(max);
+  }
+  return values;
+}
+
+TEST(prefix_sum, Sum)
+{
+  for (const int64_t size : {0, 1, 100, 10000, 123457}) {
+    const Array<int> values = random_ints(size, 1000, 0);
+    int expected = 0;
+    for (const int value : values) {
+      expected += value;
+    }
+    EXPECT_EQ(parallel_sum(values.as_span()), expected);
+  }
+}
+
+TEST(prefix_sum, PrefixSum)
+{
+  for (const int64_t size : {0, 1, 100, 10000, 123457}) {
+    const Array<int> values = random_ints(size, 1000, 1);
+    Array<int> inclusive(size);
+    Array<int> exclusive(size);
+    parallel_prefix_sum(values.as_span(), inclusive.as_mutable_span(), true);
+    parallel_prefix_sum(values.as_span(), exclusive.as_mutable_span(), false);
+    int sum = 0;
+    for (const int64_t i : values.index_range()) {
+      EXPECT_EQ(exclusive[i], sum);
+      sum += values[i];
+      EXPECT_EQ(inclusive[i], sum);
+    }
+  }
+}
+
+TEST(prefix_sum, PrefixSumInPlace)
+{
+  Array<int> values = random_ints(50000, 100, 2);
+  const Array<int> original = values;
+  parallel_prefix_sum(values.as_span(), values.as_mutable_span(), false);
+  int sum = 0;
+  for (const int64_t i : values.index_range()) {
+    EXPECT_EQ(values[i], sum);
+    sum += original[i];
+  }
+}
+
+TEST(prefix_sum, PrefixSumFloat3)
+{
+  const Array<float3> values(20000, float3(1.0f, 2.0f, 0.5f));
+  Array<float3> sums(values.size());
+  parallel_prefix_sum(values.as_span(), sums.as_mutable_span(), true);
+  EXPECT_EQ(sums.first(), float3(1.0f, 2.0f, 0.5f));
+  EXPECT_EQ(sums.last(), float3(20000.0f, 40000.0f, 10000.0f));
+}
+
+TEST(prefix_sum, GroupedPrefixSum)
+{
+  for (const int64_t size : {0, 1, 100, 10000, 123457}) {
+    const Array<int> values = random_ints(size, 1000, 3);
+    const Array<int> groups = random_ints(size, 20, 4);
+    Array<int> inclusive(size);
+    Array<int> exclusive(size);
+    parallel_grouped_prefix_sum(
+        values.as_span(), groups.as_span(), inclusive.as_mutable_span(), true);
+    parallel_grouped_prefix_sum(
+        values.as_span(), groups.as_span(), exclusive.as_mutable_span(), false);
+    Map<int, int> sums;
+    for (const int64_t i : values.index_range()) {
+      int &sum = sums.lookup_or_add_default(groups[i]);
+      EXPECT_EQ(exclusive[i], sum);
+      sum += values[i];
+      EXPECT_EQ(inclusive[i], sum);
+    }
+
+    const Map<int, int> group_sums = parallel_grouped_sum(values.as_span(), groups.as_span());
+    EXPECT_EQ(group_sums.size(), sums.size());
+    for (const Map<int, int>::Item item : sums.items()) {
+      EXPECT_EQ(group_sums.lookup(item.key), item.value);
+    }
+  }
+}
+
+TEST(prefix_sum, FloatSumIsDeterministic)
+{
+  RandomNumberGenerator rng(5);
+  Array<float> values(1000000);
+  for (float &value : values) {
+    value = rng.get_float();
+  }
+  const float sum = parallel_sum(values.as_span());
+  for ([[maybe_unused]] const int i : IndexRange(5)) {
+    EXPECT_EQ(parallel_sum(values.as_span()), sum);
+  }
+  EXPECT_NEAR(sum, 500000.0f, 2000.0f);
+}
+
+}  // namespace blender::tests
@@ -0,0 +1,188 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "BLI_array.hh"
+#include "BLI_segmented_index_mask.hh"
+#include "testing/testing.h"
+
+#include <atomic>
+
+namespace blender::tests {
+
+static Vector<int64_t> mask_indices(const SegmentedIndexMask &mask)
+{
+  Vector<int64_t> indices;
+  mask.foreach_index([&](const int64_t i) { indices.append(i); });
+  return indices;
+}
+
+TEST(segmented_index_mask, DefaultConstructor)
+{
+  SegmentedIndexMask mask;
+  EXPECT_TRUE(mask.is_empty());
+  EXPECT_EQ(mask.size(), 0);
+  EXPECT_EQ(mask.min_array_size(), 0);
+  EXPECT_EQ(mask.segments_num(), 0);
+}
+
+TEST(segmented_index_mask, RangeConstructor)
+{
+  SegmentedIndexMask mask(IndexRange(3, 1000000));
+  EXPECT_EQ(mask.size(), 1000000);
+  EXPECT_TRUE(mask.is_range());
+  EXPECT_EQ(mask.as_range(), IndexRange(3, 1000000));
+  EXPECT_EQ(mask.first(), 3);
+  EXPECT_EQ(mask.last(), 1000002);
+  EXPECT_EQ(mask.min_array_size(), 1000003);
+  EXPECT_EQ(mask.segments_num(), 1);
+}
+
+TEST(segmented_index_mask, FromIndexMask)
+{
+  const Vector<int64_t> indices = {0, 2, 5, 6, 100, 40000, 40001, 100000};
+  SegmentedIndexMask mask = SegmentedIndexMask::from_index_mask(indices.as_span());
+  EXPECT_EQ(mask.size(), indices.size());
+  EXPECT_FALSE(mask.is_range());
+  EXPECT_EQ(mask_indices(mask), indices);
+  /* The offsets are limited to 16 bits. */
+  EXPECT_EQ(mask.segments_num(), 3);
+  EXPECT_EQ(mask.first(), 0);
+  EXPECT_EQ(mask.last(), 100000);
+}
+
+TEST(segmented_index_mask, RunsAsRanges)
+{
+  Vector<int64_t> indices;
+  for (const int64_t i : IndexRange(1000)) {
+    indices.append(i);
+  }
+  indices.append(2000);
+  for (const int64_t i : IndexRange(3000, 1000)) {
+    indices.append(i);
+  }
+  SegmentedIndexMask mask = SegmentedIndexMask::from_index_mask(indices.as_span());
+  EXPECT_EQ(mask_indices(mask), indices);
+  EXPECT_EQ(mask.segments_num(), 3);
+
+  const IndexMaskSegment segment_0 = mask.segment(0);
+  EXPECT_TRUE(segment_0.is_range());
+  EXPECT_EQ(segment_0.as_range(), IndexRange(1000));
+  const IndexMaskSegment segment_1 = mask.segment(1);
+  EXPECT_FALSE(segment_1.is_range());
+  EXPECT_EQ(segment_1.offset(), 2000);
+  EXPECT_EQ(segment_1.size(), 1);
+  const IndexMaskSegment segment_2 = mask.segment(2);
+  EXPECT_TRUE(segment_2.is_range());
+  EXPECT_EQ(segment_2.as_range(), IndexRange(3000, 1000));
+}
+
+TEST(segmented_index_mask, SegmentSizeLimit)
+{
+  Vector<int64_t> indices;
+  for (int64_t i = 0; i < 100000; i += 2) {
+    indices.append(i);
+  }
+  SegmentedIndexMask mask = SegmentedIndexMask::from_index_mask(indices.as_span());
+  EXPECT_EQ(mask_indices(mask), indices);
+  mask.foreach_segment([&](const IndexMaskSegment &segment) {
+    EXPECT_FALSE(segment.is_range());
+    EXPECT_LE(segment.size(), SegmentedIndexMask::max_segment_size);
+    EXPECT_LE(segment.last() - segment.first(), INT16_MAX);
+  });
+  EXPECT_LT(mask.memory_size(), indices.size() * int64_t(sizeof(int64_t)) / 3);
+}
+
+TEST(segmented_index_mask, FromBools)
+{
+  Array<bool> bools(100000, false);
+  Vector<int64_t> indices;
+  for (const int64_t i : bools.index_range()) {
+    if ((i / 1000) % 2 == 0 || i % 7 == 0) {
+      bools[i] = true;
+      indices.append(i);
+    }
+  }
+
+  EXPECT_EQ(mask_indices(SegmentedIndexMask::from_bools(bools)), indices);
+  EXPECT_EQ(mask_indices(SegmentedIndexMask::from_bools(
+                IndexMask(bools.size()), VArray<bool>::ForSpan(bools))),
+            indices);
+  EXPECT_EQ(mask_indices(SegmentedIndexMask::from_bools(
+                IndexMask(bools.size()),
+                VArray<bool>::ForFunc(bools.size(), [&](const int64_t i) { return bools[i]; }))),
+            indices);
+  EXPECT_EQ(mask_indices(SegmentedIndexMask::from_predicate(
+                IndexMask(bools.size()), [&](const int64_t i) { return bools[i]; })),
+            indices);
+
+  EXPECT_TRUE(
+      SegmentedIndexMask::from_bools(IndexMask(10), VArray<bool>::ForSingle(false, 10)).is_empty());
+  EXPECT_TRUE(
+      SegmentedIndexMask::from_bools(IndexMask(10), VArray<bool>::ForSingle(true, 10)).is_range());
+}
+
+TEST(segmented_index_mask, FromBoolsUniverse)
+{
+  Array<bool> bools(100, true);
+  bools[50] = false;
+  const SegmentedIndexMask mask = SegmentedIndexMask::from_bools(
+      IndexMask({10, 20, 50, 60}), VArray<bool>::ForSpan(bools));
+  EXPECT_EQ(mask_indices(mask), Vector<int64_t>({10, 20, 60}));
+
+  const SegmentedIndexMask mask_range = SegmentedIndexMask::from_bools(
+      IndexRange(40, 20), VArray<bool>::ForSpan(bools));
+  EXPECT_EQ(mask_range.size(), 19);
+  EXPECT_EQ(mask_range.first(), 40);
+  EXPECT_EQ(mask_range.last(), 59);
+}
+
+TEST(segmented_index_mask, ToIndexMask)
+{
+  const Vector<int64_t> indices = {1, 2, 3, 10, 50000, 50001};
+  const SegmentedIndexMask mask = SegmentedIndexMask::from_index_mask(indices.as_span());
+  Vector<int64_t> mask_indices;
+  const IndexMask index_mask = mask.to_index_mask(mask_indices);
+  EXPECT_EQ(index_mask.indices(), indices.as_span());
+
+  Vector<int64_t> range_indices;
+  const IndexMask range_mask = SegmentedIndexMask(IndexRange(5, 10)).to_index_mask(
+      range_indices);
+  EXPECT_TRUE(range_mask.is_range());
+  EXPECT_TRUE(range_indices.is_empty());
+}
+
+TEST(segmented_index_mask, ForeachSegmentAsMask)
+{
+  Vector<int64_t> indices;
+  for (int64_t i = 0; i < 200000; i++) {
+    if (i % 3 == 0 || (i > 50000 && i < 150000)) {
+      indices.append(i);
+    }
+  }
+  const SegmentedIndexMask mask = SegmentedIndexMask::from_index_mask(indices.as_span());
+
+  Vector<int64_t> result;
+  mask.foreach_segment_as_mask([&](const IndexMask segment_mask) {
+    result.extend(segment_mask.indices());
+  });
+  EXPECT_EQ(result, indices);
+
+  Array<std::atomic<int>> counts(200000);
+  for (std::atomic<int> &count : counts) {
+    count = 0;
+  }
+  mask.foreach_segment_as_mask_parallel(1000, [&](const IndexMask segment_mask) {
+    for (const int64_t i : segment_mask) {
+      counts[i]++;
+    }
+  });
+  int64_t total = 0;
+  for (const int64_t i : counts.index_range()) {
+    total += counts[i];
+  }
+  EXPECT_EQ(total, indices.size());
+  for (const int64_t i : indices) {
+    EXPECT_EQ(counts[i], 1);
+  }
+}
+
+}  // namespace blender::tests
@@ -570,6 +570,54 @@ TEST(set, RemoveDuringIteration)
   EXPECT_TRUE(set.contains(3));
 }
 
+TEST(set, GroupProbing)
+{
+  Set<int, 4, GroupProbingStrategy> set;
+  for (int i = 0; i < 10000; i++) {
+    set.add_new(i * 7);
+  }
+  EXPECT_EQ(set.size(), 10000);
+  for (int i = 0; i < 70000; i++) {
+    EXPECT_EQ(set.contains(i), i % 7 == 0);
+  }
+  for (int i = 0; i < 5000; i++) {
+    set.remove_contained(i * 14);
+  }
+  EXPECT_EQ(set.size(), 5000);
+  EXPECT_FALSE(set.contains(14));
+  EXPECT_TRUE(set.contains(21));
+  EXPECT_FALSE(set.add(21));
+  EXPECT_TRUE(set.add(14));
+  EXPECT_EQ(set.lookup_key_or_add(28), 28);
+  EXPECT_EQ(set.size(), 5002);
+}
+
+TEST(set, GroupProbingStrings)
+{
+  Set<std::string, 2, GroupProbingStrategy> set;
+  set.add("a");
+  EXPECT_TRUE(set.contains("a"));
+  EXPECT_FALSE(set.contains("b"));
+  for (int i = 0; i < 100; i++) {
+    set.add(std::to_string(i));
+  }
+  Set<std::string, 2, GroupProbingStrategy> set_copy = set;
+  Set<std::string, 2, GroupProbingStrategy> set_moved = std::move(set);
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(set_copy.contains(std::to_string(i)));
+    EXPECT_TRUE(set_moved.contains(std::to_string(i)));
+  }
+  for (auto iter = set_moved.begin(); iter != set_moved.end(); ++iter) {
+    if (*iter != "a") {
+      set_moved.remove(iter);
+    }
+  }
+  EXPECT_EQ(set_moved.size(), 1);
+  EXPECT_TRUE(set_moved.contains("a"));
+  EXPECT_FALSE(set_moved.contains("5"));
+  EXPECT_EQ(set_copy.size(), 101);
+}
+
 /**
  * Set this to 1 to activate the benchmark. It is disabled by default, because it prints a lot.
  */
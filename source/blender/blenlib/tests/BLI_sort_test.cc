@@ -0,0 +1,146 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_rand.hh"
+#include "BLI_sort.hh"
+#include "BLI_vector.hh"
+
+namespace blender::tests {
+
+static Array<int> random_ints(const int64_t size, const int max)
+{
+  RandomNumberGenerator rng(0);
+  Array<int> values(size);
+  for (int &value : values) {
+    value = rng.get_int32(max) - max / 2;
+  }
+  return values;
+}
+
+TEST(sort, ParallelSort)
+{
+  Array<int> values = random_ints(100000, 1000000);
+  Array<int> expected = values;
+  std::sort(expected.begin(), expected.end());
+  parallel_sort(values.begin(), values.end());
+  EXPECT_EQ(values.as_span(), expected.as_span());
+
+  parallel_sort(values.begin(), values.end(), std::greater<>());
+  EXPECT_EQ(values.first(), expected.last());
+  EXPECT_TRUE(std::is_sorted(values.begin(), values.end(), std::greater<>()));
+}
+
+TEST(sort, ParallelStableSort)
+{
+  for (const int64_t size : {0, 1, 100, 10000, 100000, 123457}) {
+    /* Many equal keys, the index is used to check the stability. */
+    const Array<int> keys = random_ints(size, 100);
+    Array<std::pair<int, int64_t>> values(size);
+    for (const int64_t i : values.index_range()) {
+      values[i] = {keys[i], i};
+    }
+    Array<std::pair<int, int64_t>> expected = values;
+    auto compare_keys = [](const std::pair<int, int64_t> &a, const std::pair<int, int64_t> &b) {
+      return a.first < b.first;
+    };
+    std::stable_sort(expected.begin(), expected.end(), compare_keys);
+    parallel_stable_sort(values.as_mutable_span(), compare_keys);
+    EXPECT_EQ(values.as_span(), expected.as_span());
+  }
+}
+
+TEST(sort, RadixSortInts)
+{
+  for (const int64_t size : {0, 1, 100, 10000, 123457}) {
+    Array<int> values = random_ints(size, std::numeric_limits<int>::max());
+    if (size > 10) {
+      values[5] = std::numeric_limits<int>::min();
+      values[6] = std::numeric_limits<int>::max();
+    }
+    Array<int> expected = values;
+    std::sort(expected.begin(), expected.end());
+    parallel_radix_sort(values.as_mutable_span());
+    EXPECT_EQ(values.as_span(), expected.as_span());
+  }
+}
+
+TEST(sort, RadixSortUnsigned)
+{
+  Array<uint64_t> values(50000);
+  RandomNumberGenerator rng(1);
+  for (uint64_t &value : values) {
+    value = (uint64_t(rng.get_uint32()) << 32) | rng.get_uint32();
+  }
+  Array<uint64_t> expected = values;
+  std::sort(expected.begin(), expected.end());
+  parallel_radix_sort(values.as_mutable_span());
+  EXPECT_EQ(values.as_span(), expected.as_span());
+}
+
+TEST(sort, RadixSortFloats)
+{
+  Array<float> values(20000);
+  RandomNumberGenerator rng(2);
+  for (float &value : values) {
+    value = (rng.get_float() - 0.5f) * 1e6f;
+  }
+  values[0] = 0.0f;
+  values[1] = -1.0f;
+  values[2] = std::numeric_limits<float>::infinity();
+  values[3] = -std::numeric_limits<float>::infinity();
+  values[4] = std::numeric_limits<float>::denorm_min();
+  Array<float> expected = values;
+  std::sort(expected.begin(), expected.end());
+  parallel_radix_sort(values.as_mutable_span());
+  EXPECT_EQ(values.as_span(), expected.as_span());
+}
+
+TEST(sort, RadixSortByKeyIsStable)
+{
+  struct Item {
+    double key;
+    int index;
+  };
+  Array<Item> items(30000);
+  RandomNumberGenerator rng(3);
+  for (const int i : items.index_range()) {
+    items[i] = {double(rng.get_int32(50)) - 25.0, i};
+  }
+  parallel_radix_sort(items.as_mutable_span(), [](const Item &item) { return item.key; });
+  for (const int i : IndexRange(items.size() - 1)) {
+    const Item &a = items[i];
+    const Item &b = items[i + 1];
+    EXPECT_TRUE(a.key < b.key || (a.key == b.key && a.index < b.index));
+  }
+}
+
+TEST(sort, NthValue)
+{
+  for (const int64_t size : {1, 100, 10000, 123457}) {
+    const Array<int> values = random_ints(size, 1000);
+    Array<int> sorted_values = values;
+    std::sort(sorted_values.begin(), sorted_values.end());
+    for (const int64_t n : {int64_t(0), size / 3, size / 2, size - 1}) {
+      EXPECT_EQ(parallel_nth_value(values.as_span(), n), sorted_values[n]);
+    }
+  }
+}
+
+TEST(sort, NthValueFloats)
+{
+  Array<float> values(50001);
+  RandomNumberGenerator rng(4);
+  for (float &value : values) {
+    value = (rng.get_float() - 0.5f) * 1e4f;
+  }
+  values[10] = -0.0f;
+  values[11] = std::numeric_limits<float>::lowest();
+  Array<float> sorted_values = values;
+  std::sort(sorted_values.begin(), sorted_values.end());
+  for (const int64_t n : {0, 1, 25000, 40000, 50000}) {
+    EXPECT_EQ(parallel_nth_value(values.as_span(), n), sorted_values[n]);
+  }
+}
+
+}  // namespace blender::tests
@@ -0,0 +1,177 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_rand.hh"
+#include "BLI_spatial_grid.hh"
+
+#include <algorithm>
+
+namespace blender::tests {
+
+static Array<float3> random_points(const int size, const uint32_t seed)
+{
+  RandomNumberGenerator rng(seed);
+  Array<float3> points(size);
+  for (float3 &point : points) {
+    point = float3(rng.get_float(), rng.get_float(), rng.get_float()) * 2.0f - 1.0f;
+  }
+  /* Add some exact duplicates. */
+  for (int i = 3; i < size; i += 7) {
+    points[i] = points[i / 2];
+  }
+  return points;
+}
+
+static Vector<int> indices_in_radius(const Span<float3> points,
+                                     const float3 &position,
+                                     const float radius)
+{
+  Vector<int> indices;
+  for (const int i : points.index_range()) {
+    if (math::distance_squared(points[i], position) <= radius * radius) {
+      indices.append(i);
+    }
+  }
+  return indices;
+}
+
+TEST(spatial_grid, Empty)
+{
+  const SpatialGrid grid({}, 0.1f);
+  EXPECT_EQ(grid.cell_size(), 0.1f);
+  EXPECT_EQ(SpatialGrid::calc_cell_size({}, 0.1f), 0.1f);
+  EXPECT_EQ(grid.points_num(), 0);
+  EXPECT_EQ(grid.cells_num(), 0);
+  grid.foreach_point_in_radius(float3(0.0f), 1.0f, [](int, float) { FAIL(); });
+  EXPECT_EQ(grid.calc_duplicates(0.1f, {}), 0);
+}
+
+TEST(spatial_grid, Cells)
+{
+  const Array<float3> points = random_points(1000, 0);
+  const SpatialGrid grid(points, 0.3f);
+  EXPECT_EQ(grid.cell_size(), 0.3f);
+  EXPECT_EQ(grid.points_num(), points.size());
+  Array<bool> found(points.size(), false);
+  for (const int64_t cell : IndexRange(grid.cells_num())) {
+    const IndexRange cell_points = grid.cell_points(cell);
+    EXPECT_GT(cell_points.size(), 0);
+    for (const int i : cell_points) {
+      const int index = grid.sorted_indices()[i];
+      EXPECT_EQ(grid.sorted_positions()[i], points[index]);
+      /* Points in a cell keep their order. */
+      if (i > cell_points.first()) {
+        EXPECT_LT(grid.sorted_indices()[i - 1], index);
+      }
+      found[index] = true;
+    }
+  }
+  EXPECT_TRUE(std::all_of(found.begin(), found.end(), [](const bool value) { return value; }));
+}
+
+TEST(spatial_grid, PointsInRadius)
+{
+  const Array<float3> points = random_points(5000, 1);
+  for (const float cell_size : {0.01f, 0.1f, 0.5f}) {
+    const SpatialGrid grid(points, cell_size);
+    for (const float3 &position : random_points(200, 2)) {
+      for (const float radius : {0.0f, 0.05f, 0.2f}) {
+        Vector<int> indices;
+        grid.foreach_point_in_radius(position, radius, [&](const int index, const float dist_sq) {
+          EXPECT_EQ(dist_sq, math::distance_squared(position, points[index]));
+          indices.append(index);
+        });
+        std::sort(indices.begin(), indices.end());
+        EXPECT_EQ(indices.as_span(), indices_in_radius(points, position, radius).as_span());
+      }
+    }
+  }
+}
+
+TEST(spatial_grid, PointsInRadiusOutside)
+{
+  const Array<float3> points = random_points(1000, 3);
+  const SpatialGrid grid(points, 0.1f);
+  for (const float3 &position : {float3(5.0f), float3(-1.05f, 0.0f, 0.0f), float3(1e30f)}) {
+    Vector<int> indices;
+    grid.foreach_point_in_radius(
+        position, 0.1f, [&](const int index, const float /*dist_sq*/) { indices.append(index); });
+    std::sort(indices.begin(), indices.end());
+    EXPECT_EQ(indices.as_span(), indices_in_radius(points, position, 0.1f).as_span());
+  }
+}
+
+TEST(spatial_grid, LargeExtent)
+{
+  Array<float3> points = random_points(1000, 4);
+  points[0] = float3(1e7f, 0.0f, 0.0f);
+  const SpatialGrid grid(points, 1e-4f);
+  /* The cells are larger than requested, but queries still work. */
+  EXPECT_GT(grid.cell_size(), 1e-4f);
+  EXPECT_EQ(SpatialGrid::calc_cell_size(points, 1e-4f), grid.cell_size());
+  EXPECT_EQ(SpatialGrid::calc_cell_size(points, 10.0f), 10.0f);
+  for (const int i : IndexRange(10)) {
+    Vector<int> indices;
+    grid.foreach_point_in_radius(
+        points[i], 0.1f, [&](const int index, const float /*dist_sq*/) { indices.append(index); });
+    std::sort(indices.begin(), indices.end());
+    EXPECT_EQ(indices.as_span(), indices_in_radius(points, points[i], 0.1f).as_span());
+  }
+}
+
+TEST(spatial_grid, CalcDuplicates)
+{
+  for (const int size : {1, 10, 1000, 20000}) {
+    const Array<float3> points = random_points(size, 5);
+    const float distance = 0.02f;
+    const SpatialGrid grid(points, distance);
+    Array<int> duplicates(size, -1);
+    /* Protect some points from being merged. */
+    for (int i = 0; i < size; i += 5) {
+      duplicates[i] = i;
+    }
+    const Array<int> initial_duplicates = duplicates;
+    const int found = grid.calc_duplicates(distance, duplicates);
+
+    int merged = 0;
+    Vector<int> survivors;
+    for (const int i : points.index_range()) {
+      const int target = duplicates[i];
+      if (ELEM(target, -1, i)) {
+        survivors.append(i);
+        continue;
+      }
+      /* Only unprotected points are merged, into targets in range that aren't merged. */
+      EXPECT_EQ(initial_duplicates[i], -1);
+      EXPECT_LE(math::distance(points[i], points[target]), distance);
+      EXPECT_EQ(duplicates[target], target);
+      merged++;
+    }
+    EXPECT_EQ(found, merged);
+    /* Every unprotected point was merged if it is in range of another point that was kept. */
+    for (const int i : points.index_range()) {
+      if (duplicates[i] == -1) {
+        for (const int j : survivors) {
+          if (j != i) {
+            EXPECT_GT(math::distance(points[i], points[j]), distance);
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(spatial_grid, CalcDuplicatesIsDeterministic)
+{
+  const Array<float3> points = random_points(50000, 6);
+  const SpatialGrid grid(points, 0.01f);
+  Array<int> duplicates_a(points.size(), -1);
+  Array<int> duplicates_b(points.size(), -1);
+  const int found_a = grid.calc_duplicates(0.01f, duplicates_a);
+  const int found_b = SpatialGrid(points, 0.01f).calc_duplicates(0.01f, duplicates_b);
+  EXPECT_EQ(found_a, found_b);
+  EXPECT_EQ(duplicates_a.as_span(), duplicates_b.as_span());
+}
+
+}  // namespace blender::tests
@@ -10,6 +10,7 @@
 
 #include "BLI_utildefines.h"
 
+#include "BLI_array.hh"
 #include "BLI_listbase.h"
 #include "BLI_mempool.h"
 #include "BLI_task.h"
@@ -294,3 +295,210 @@ TEST(task, ParallelInvoke)
                                       [&]() { counter++; });
   EXPECT_EQ(counter, 6);
 }
+
+/* *** Cancel tokens. *** */
+
+TEST(task, CancelTokenHierarchy)
+{
+  TaskCancelToken *parent = BLI_task_cancel_token_create(nullptr);
+  TaskCancelToken *child = BLI_task_cancel_token_create(parent);
+  TaskCancelToken *sibling = BLI_task_cancel_token_create(parent);
+  EXPECT_FALSE(BLI_task_cancel_token_is_canceled(nullptr));
+  EXPECT_FALSE(BLI_task_cancel_token_is_canceled(child));
+
+  BLI_task_cancel_token_cancel(child);
+  EXPECT_TRUE(BLI_task_cancel_token_is_canceled(child));
+  EXPECT_FALSE(BLI_task_cancel_token_is_canceled(parent));
+  EXPECT_FALSE(BLI_task_cancel_token_is_canceled(sibling));
+
+  BLI_task_cancel_token_reset(child);
+  BLI_task_cancel_token_cancel(parent);
+  EXPECT_TRUE(BLI_task_cancel_token_is_canceled(child));
+  EXPECT_TRUE(BLI_task_cancel_token_is_canceled(sibling));
+
+  BLI_task_cancel_token_free(child);
+  BLI_task_cancel_token_free(sibling);
+  BLI_task_cancel_token_free(parent);
+}
+
+static void task_pool_count_func(TaskPool *__restrict pool, void *UNUSED(taskdata))
+{
+  std::atomic<int> *counter = (std::atomic<int> *)BLI_task_pool_user_data(pool);
+  (*counter)++;
+}
+
+TEST(task, PoolCancelToken)
+{
+  std::atomic<int> counter = 0;
+  TaskCancelToken *token = BLI_task_cancel_token_create(nullptr);
+  TaskPool *pool = BLI_task_pool_create_suspended(&counter, TASK_PRIORITY_HIGH);
+  BLI_task_pool_cancel_token_set(pool, token);
+  for (int i = 0; i < 100; i++) {
+    BLI_task_pool_push(pool, task_pool_count_func, nullptr, false, nullptr);
+  }
+  /* Suspended tasks did not start yet and are skipped. */
+  BLI_task_cancel_token_cancel(token);
+  BLI_task_pool_work_and_wait(pool);
+  EXPECT_EQ(counter, 0);
+
+  BLI_task_cancel_token_reset(token);
+  BLI_task_pool_push(pool, task_pool_count_func, nullptr, false, nullptr);
+  BLI_task_pool_work_and_wait(pool);
+  EXPECT_EQ(counter, 1);
+
+  BLI_task_pool_free(pool);
+  BLI_task_cancel_token_free(token);
+}
+
+TEST(task, ParallelForCancelToken)
+{
+  TaskCancelToken *token = BLI_task_cancel_token_create(nullptr);
+  std::atomic<int> counter = 0;
+  blender::threading::parallel_for(
+      blender::IndexRange(1000), 10, token, [&](const blender::IndexRange range) {
+        counter += range.size();
+      });
+  EXPECT_EQ(counter, 1000);
+
+  BLI_task_cancel_token_cancel(token);
+  blender::threading::parallel_for(
+      blender::IndexRange(1000), 10, token, [&](const blender::IndexRange range) {
+        counter += range.size();
+      });
+  EXPECT_EQ(counter, 1000);
+  BLI_task_cancel_token_free(token);
+}
+
+/* *** Task arenas. *** */
+
+TEST(task, ArenaExecute)
+{
+  TaskArena *arena = BLI_task_arena_create("Test Arena", 2, TASK_PRIORITY_LOW);
+  EXPECT_STREQ(BLI_task_arena_name(arena), "Test Arena");
+  EXPECT_EQ(BLI_task_arena_priority(arena), TASK_PRIORITY_LOW);
+  EXPECT_LE(BLI_task_arena_num_threads(arena), 2);
+  EXPECT_EQ(BLI_task_arena_current(), nullptr);
+
+  std::atomic<int> threads_running = 0;
+  std::atomic<int> max_threads_running = 0;
+  std::atomic<bool> all_in_arena = true;
+  blender::threading::arena_execute(arena, [&]() {
+    EXPECT_EQ(BLI_task_arena_current(), arena);
+    blender::threading::parallel_for(
+        blender::IndexRange(NUM_ITEMS), 1, [&](const blender::IndexRange UNUSED(range)) {
+          const int running = ++threads_running;
+          int max_running = max_threads_running;
+          while (running > max_running &&
+                 !max_threads_running.compare_exchange_weak(max_running, running)) {
+          }
+          if (BLI_task_arena_current() != arena) {
+            all_in_arena = false;
+          }
+          threads_running--;
+        });
+  });
+  EXPECT_TRUE(all_in_arena);
+  /* The thread budget includes the calling thread. */
+  EXPECT_LE(max_threads_running, 2);
+  EXPECT_EQ(BLI_task_arena_current(), nullptr);
+
+  BLI_task_arena_free(arena);
+}
+
+TEST(task, ArenaNested)
+{
+  TaskArena *outer = BLI_task_arena_create("Outer", 0, TASK_PRIORITY_LOW);
+  TaskArena *inner = BLI_task_arena_create("Inner", 0, TASK_PRIORITY_HIGH);
+  blender::threading::arena_execute(outer, [&]() {
+    blender::threading::arena_execute(inner,
+                                      [&]() { EXPECT_EQ(BLI_task_arena_current(), inner); });
+    EXPECT_EQ(BLI_task_arena_current(), outer);
+  });
+  BLI_task_arena_free(inner);
+  BLI_task_arena_free(outer);
+}
+
+static void task_pool_cancel_func(TaskPool *__restrict pool, void *taskdata)
+{
+  BLI_task_cancel_token_cancel((TaskCancelToken *)taskdata);
+  EXPECT_TRUE(BLI_task_pool_current_canceled(pool));
+  /* Tasks pushed after canceling are skipped, while the pool is still running. */
+  for (int i = 0; i < 100; i++) {
+    BLI_task_pool_push(pool, task_pool_count_func, nullptr, false, nullptr);
+  }
+}
+
+TEST(task, ArenaCancelToken)
+{
+  TaskArena *arena = BLI_task_arena_create("Test Arena", 0, TASK_PRIORITY_LOW);
+  TaskCancelToken *token = BLI_task_cancel_token_create(nullptr);
+  BLI_task_arena_cancel_token_set(arena, token);
+  EXPECT_EQ(BLI_task_cancel_token_current(), nullptr);
+
+  std::atomic<int> counter = 0;
+  blender::threading::arena_execute(arena, [&]() {
+    EXPECT_EQ(BLI_task_cancel_token_current(), token);
+    TaskPool *pool = BLI_task_pool_create(&counter, TASK_PRIORITY_HIGH);
+    BLI_task_pool_cancel_token_set(pool, BLI_task_cancel_token_current());
+    BLI_task_pool_push(pool, task_pool_cancel_func, token, false, nullptr);
+    BLI_task_pool_work_and_wait(pool);
+    BLI_task_pool_free(pool);
+  });
+  EXPECT_TRUE(BLI_task_cancel_token_is_canceled(token));
+  EXPECT_EQ(counter, 0);
+  EXPECT_EQ(BLI_task_cancel_token_current(), nullptr);
+
+  BLI_task_arena_free(arena);
+  BLI_task_cancel_token_free(token);
+}
+
+/* *** Adaptive grain size. *** */
+
+static void test_parallel_for_adaptive(const int64_t size, const int work_per_iteration)
+{
+  blender::Array<std::atomic<int>> visits(size);
+  for (std::atomic<int> &visit : visits) {
+    visit = 0;
+  }
+  blender::threading::parallel_for_adaptive(
+      blender::IndexRange(size), [&](const blender::IndexRange range) {
+        for (const int64_t i : range) {
+          /* Simulate work to make iterations more or less expensive. */
+          volatile float value = 0.0f;
+          for (int j = 0; j < work_per_iteration; j++) {
+            value += float(j);
+          }
+          visits[i]++;
+        }
+      });
+  for (const int64_t i : visits.index_range()) {
+    EXPECT_EQ(visits[i], 1);
+  }
+}
+
+TEST(task, ParallelForAdaptive)
+{
+  test_parallel_for_adaptive(0, 1);
+  test_parallel_for_adaptive(1, 1);
+  test_parallel_for_adaptive(NUM_ITEMS, 1);
+  test_parallel_for_adaptive(100, 100000);
+}
+
+TEST(task, ParallelForProfile)
+{
+  BLI_task_parallel_profile_enable();
+  std::atomic<int> counter = 0;
+  blender::threading::parallel_for(blender::IndexRange(NUM_ITEMS),
+                                   64,
+                                   [&](const blender::IndexRange range) {
+                                     counter += range.size();
+                                   });
+  blender::threading::parallel_for_adaptive(
+      blender::IndexRange(NUM_ITEMS), [&](const blender::IndexRange range) {
+        counter += range.size();
+      });
+  EXPECT_EQ(counter, NUM_ITEMS * 2);
+  BLI_task_parallel_profile_print();
+  /* Don't profile the loops of other tests. */
+  BLI_task_parallel_profile_disable();
+}
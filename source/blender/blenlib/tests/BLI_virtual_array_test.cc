@@ -152,6 +152,40 @@ TEST(virtual_array, DerivedSpan)
   }
 }
 
+TEST(virtual_array, MaterializeChunk)
+{
+  Array<int> data(100);
+  for (const int64_t i : data.index_range()) {
+    data[i] = int(i * i);
+  }
+  Vector<std::array<int, 3>> structs;
+  for (const int64_t i : data.index_range()) {
+    structs.append({data[i], 0, 0});
+  }
+  const Vector<VArray<int>> varrays = {
+      VArray<int>::ForSpan(data),
+      VArray<int>::ForFunc(data.size(), [&](const int64_t i) { return data[i]; }),
+      VArray<int>::ForDerivedSpan<std::array<int, 3>, get_x>(structs),
+  };
+  const IndexRange range(10, 20);
+  for (const VArray<int> &varray : varrays) {
+    Array<int> chunk(range.size(), -1);
+    varray.materialize_chunk(range, chunk);
+    EXPECT_EQ(chunk.as_span(), data.as_span().slice(range));
+
+    Array<int> buffer(50, -1);
+    const Span<int> values = varray.get_internal_span_or_chunk(range, buffer);
+    EXPECT_EQ(values, data.as_span().slice(range));
+    /* Spans are returned directly, without copying. */
+    EXPECT_EQ(values.data() == data.data() + range.start(), varray.is_span());
+  }
+
+  const VArray<int> single = VArray<int>::ForSingle(7, 100);
+  Array<int> chunk(5, -1);
+  single.materialize_chunk(IndexRange(95, 5), chunk);
+  EXPECT_EQ(chunk.as_span(), Span<int>({7, 7, 7, 7, 7}));
+}
+
 TEST(virtual_array, MutableToImmutable)
 {
   std::array<int, 4> array = {4, 2, 6, 4};
@@ -0,0 +1,161 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_concurrent_map.hh"
+#include "BLI_map.hh"
+#include "BLI_task.hh"
+#include "BLI_timeit.hh"
+
+#include <iostream>
+
+/**
+ * Compares ways to deduplicate the edges of a grid of quads in parallel, which is similar to what
+ * #BKE_mesh_calc_edges does.
+ */
+
+namespace blender::tests {
+
+struct Edge {
+  int v_low, v_high;
+
+  Edge(const int v1, const int v2) : v_low(std::min(v1, v2)), v_high(std::max(v1, v2))
+  {
+  }
+
+  uint64_t hash() const
+  {
+    return get_default_hash_2(v_low, v_high);
+  }
+
+  friend bool operator==(const Edge &a, const Edge &b)
+  {
+    return a.v_low == b.v_low && a.v_high == b.v_high;
+  }
+};
+
+/** The vertices of every quad of a grid with the given number of quads in each direction. */
+static Array<int> grid_quads(const int size)
+{
+  Array<int> corners(size * size * 4);
+  for (const int y : IndexRange(size)) {
+    for (const int x : IndexRange(size)) {
+      const int quad = y * size + x;
+      const int v = y * (size + 1) + x;
+      corners[quad * 4 + 0] = v;
+      corners[quad * 4 + 1] = v + 1;
+      corners[quad * 4 + 2] = v + size + 2;
+      corners[quad * 4 + 3] = v + size + 1;
+    }
+  }
+  return corners;
+}
+
+template<typename Fn> static void foreach_quad_edge(Span<int> corners, const int quad, const Fn &fn)
+{
+  for (const int i : IndexRange(4)) {
+    fn(Edge(corners[quad * 4 + i], corners[quad * 4 + (i + 1) % 4]));
+  }
+}
+
+/**
+ * Every task has its own map and iterates over all quads, but only adds the edges that belong to
+ * its map. This is the approach used by #BKE_mesh_calc_edges before.
+ */
+static int64_t dedup_task_per_map(Span<int> corners, const int maps_num)
+{
+  const int quads_num = corners.size() / 4;
+  Array<Map<Edge, int>> maps(maps_num);
+  threading::parallel_for(maps.index_range(), 1, [&](const IndexRange range) {
+    for (const int map_index : range) {
+      Map<Edge, int> &map = maps[map_index];
+      map.reserve(quads_num * 2 / maps_num);
+      for (const int quad : IndexRange(quads_num)) {
+        foreach_quad_edge(corners, quad, [&](const Edge edge) {
+          if ((edge.v_low & (maps_num - 1)) == map_index) {
+            map.add(edge, quad);
+          }
+        });
+      }
+    }
+  });
+  int64_t size = 0;
+  for (const Map<Edge, int> &map : maps) {
+    size += map.size();
+  }
+  return size;
+}
+
+static int64_t dedup_concurrent_add(Span<int> corners)
+{
+  const int quads_num = corners.size() / 4;
+  ConcurrentMap<Edge, int> map;
+  map.reserve(quads_num * 2);
+  threading::parallel_for(IndexRange(quads_num), 1024, [&](const IndexRange range) {
+    for (const int quad : range) {
+      foreach_quad_edge(corners, quad, [&](const Edge edge) { map.add(edge, quad); });
+    }
+  });
+  return map.size();
+}
+
+static int64_t dedup_add_parallel(Span<int> corners)
+{
+  const int quads_num = corners.size() / 4;
+  ConcurrentMap<Edge, int> map;
+  map.add_parallel(
+      IndexRange(quads_num),
+      1024,
+      [&](const IndexRange range, ConcurrentMap<Edge, int>::ParallelAdder &adder) {
+        for (const int quad : range) {
+          foreach_quad_edge(corners, quad, [&](const Edge edge) { adder.add(edge, quad); });
+        }
+      },
+      [](int & /*value*/, int /*new_value*/) {});
+  return map.size();
+}
+
+TEST(concurrent_map_performance, GridEdges)
+{
+  for (const int size : {100, 1000, 3000}) {
+    const Array<int> corners = grid_quads(size);
+    std::cout << size * size << " quads:\n";
+    int64_t edges_num;
+    {
+      SCOPED_TIMER("  Serial Map      ");
+      edges_num = dedup_task_per_map(corners, 1);
+    }
+    std::cout << "    Edges: " << edges_num << "\n";
+    {
+      SCOPED_TIMER("  Task per map (8)");
+      edges_num = dedup_task_per_map(corners, 8);
+    }
+    std::cout << "    Edges: " << edges_num << "\n";
+    {
+      SCOPED_TIMER("  Concurrent add  ");
+      edges_num = dedup_concurrent_add(corners);
+    }
+    std::cout << "    Edges: " << edges_num << "\n";
+    {
+      SCOPED_TIMER("  Add parallel    ");
+      edges_num = dedup_add_parallel(corners);
+    }
+    std::cout << "    Edges: " << edges_num << "\n";
+  }
+}
+
+/**
+ * Results on a single core, 9000000 quads:
+ *
+ * Serial Map         3812 ms
+ * Task per map (8)   5293 ms
+ * Concurrent add     5742 ms
+ * Add parallel       4479 ms
+ *
+ * With a single thread, the task per map approach iterates over all quads eight times, while
+ * #ConcurrentMap::add_parallel reads every quad once and only adds the cost of buffering the
+ * edges. Locking every key is slower, but does not require all keys to be known in advance.
+ */
+
+}  // namespace blender::tests
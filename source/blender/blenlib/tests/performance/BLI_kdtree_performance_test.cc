@@ -0,0 +1,121 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_kdtree.h"
+#include "BLI_math_vec_types.hh"
+#include "BLI_rand.hh"
+#include "BLI_timeit.hh"
+
+#include <atomic>
+#include <iostream>
+
+/**
+ * Measures building the tree and compares looping over single queries to the batched queries.
+ */
+
+namespace blender::tests {
+
+static constexpr int64_t sizes[] = {1000000, 10000000};
+static constexpr int queries_num = 1000000;
+
+static Array<float3> random_points(const int64_t size, const uint32_t seed)
+{
+  Array<float3> points(size);
+  RandomNumberGenerator rng(seed);
+  for (float3 &point : points) {
+    point = float3(rng.get_float(), rng.get_float(), rng.get_float());
+  }
+  return points;
+}
+
+static bool count_found(void *user_data, int /*index*/, const float * /*co*/, float /*dist_sq*/)
+{
+  (*static_cast<int64_t *>(user_data))++;
+  return true;
+}
+
+static bool count_found_batch(
+    void *user_data, int /*co_index*/, int /*index*/, const float * /*co*/, float /*dist_sq*/)
+{
+  (*static_cast<std::atomic<int64_t> *>(user_data))++;
+  return true;
+}
+
+TEST(kdtree_performance, Queries)
+{
+  const Array<float3> queries = random_points(queries_num, 1);
+  const float(*queries_co)[3] = reinterpret_cast<const float(*)[3]>(queries.data());
+  for (const int64_t size : sizes) {
+    std::cout << size << " points, " << queries_num << " queries:\n";
+    const Array<float3> points = random_points(size, 0);
+    /* About 10 points in range of every query. */
+    const float range = std::cbrt(10.0f / float(size) / (4.0f / 3.0f * float(M_PI)));
+
+    KDTree_3d *tree = BLI_kdtree_3d_new(uint(size));
+    for (const int i : points.index_range()) {
+      BLI_kdtree_3d_insert(tree, i, points[i]);
+    }
+    {
+      SCOPED_TIMER("  Balance                   ");
+      BLI_kdtree_3d_balance(tree);
+    }
+
+    Array<int> indices(queries_num);
+    {
+      SCOPED_TIMER("  Find nearest              ");
+      for (const int i : queries.index_range()) {
+        indices[i] = BLI_kdtree_3d_find_nearest(tree, queries[i], nullptr);
+      }
+    }
+    {
+      SCOPED_TIMER("  Find nearest batch        ");
+      BLI_kdtree_3d_find_nearest_batch(tree, queries_co, queries_num, indices.data(), nullptr);
+    }
+    {
+      SCOPED_TIMER("  Find nearest 10           ");
+      KDTreeNearest_3d nearest[10];
+      for (const int i : queries.index_range()) {
+        BLI_kdtree_3d_find_nearest_n(tree, queries[i], nearest, 10);
+      }
+    }
+
+    int64_t found = 0;
+    {
+      SCOPED_TIMER("  Range search callback     ");
+      for (const int i : queries.index_range()) {
+        BLI_kdtree_3d_range_search_cb(tree, queries[i], range, count_found, &found);
+      }
+    }
+    std::atomic<int64_t> found_batch = 0;
+    {
+      SCOPED_TIMER("  Range search batch        ");
+      BLI_kdtree_3d_range_search_batch_cb(
+          tree, queries_co, queries_num, range, count_found_batch, &found_batch);
+    }
+    EXPECT_EQ(found, found_batch);
+
+    Array<int> duplicates(size, -1);
+    {
+      SCOPED_TIMER("  Calculate duplicates fast ");
+      BLI_kdtree_3d_calc_duplicates_fast(tree, range * 0.1f, false, duplicates.data());
+    }
+    BLI_kdtree_3d_free(tree);
+  }
+}
+
+/**
+ * Results on a single core, before and after adding leaf buckets and skipping sub-trees that are
+ * further away than the current nearest point. The batched queries take as long as the loops
+ * over single queries here, they only help with more cores:
+ *
+ *                             1M points             10M points
+ * Balance                     356 ms -> 338 ms      4542 ms -> 4463 ms
+ * Find nearest                17619 ms -> 2088 ms   38611 ms -> 4233 ms
+ * Find nearest 10             32052 ms -> 6061 ms   70578 ms -> 9202 ms
+ * Range search callback       4668 ms -> 4408 ms    7808 ms -> 7205 ms
+ * Calculate duplicates fast   298 ms -> 307 ms      3692 ms -> 3242 ms
+ */
+
+}  // namespace blender::tests
@@ -0,0 +1,223 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_map.hh"
+#include "BLI_rand.hh"
+#include "BLI_set.hh"
+#include "BLI_timeit.hh"
+#include "BLI_vector.hh"
+
+#include <iostream>
+
+/**
+ * Compares the default probing strategy of #Map and #Set with #GroupProbingStrategy.
+ */
+
+namespace blender::tests {
+
+using GroupProbingMap = Map<int, int, 4, GroupProbingStrategy>;
+using GroupProbingSet = Set<int, 4, GroupProbingStrategy>;
+using GroupProbingStringMap = Map<std::string, int, 4, GroupProbingStrategy>;
+
+static Vector<int> random_ints(const int amount, const int factor)
+{
+  RandomNumberGenerator rng(0);
+  Vector<int> values;
+  for ([[maybe_unused]] const int i : IndexRange(amount)) {
+    values.append(rng.get_int32() * factor);
+  }
+  return values;
+}
+
+/**
+ * Mostly adds new keys, like when building a map of the edges of a mesh.
+ */
+template<typename MapT>
+static void benchmark_insert_heavy(const char *name, const Span<int> values)
+{
+  int64_t count = 0;
+  {
+    SCOPED_TIMER(std::string(name) + " Insert");
+    MapT map;
+    for (const int value : values) {
+      map.add(value, value);
+    }
+    /* Most keys are looked up once again. */
+    for (const int value : values.take_front(values.size() / 4)) {
+      count += map.lookup(value) == value;
+    }
+  }
+  /* Print the value for simple error checking and to avoid some compiler optimizations. */
+  std::cout << "  Count: " << count << "\n";
+}
+
+/**
+ * Lookups in a map that does not change anymore, half of the looked up keys don't exist.
+ */
+template<typename MapT>
+static void benchmark_lookup_heavy(const char *name, const Span<int> values)
+{
+  MapT map;
+  for (const int value : values.take_front(values.size() / 2)) {
+    map.add(value, value);
+  }
+  int64_t count = 0;
+  {
+    SCOPED_TIMER(std::string(name) + " Lookup");
+    for ([[maybe_unused]] const int i : IndexRange(4)) {
+      for (const int value : values) {
+        count += map.contains(value);
+      }
+    }
+  }
+  std::cout << "  Count: " << count << "\n";
+}
+
+template<typename SetT> static void benchmark_set(const char *name, const Span<int> values)
+{
+  int64_t count = 0;
+  {
+    SCOPED_TIMER(std::string(name) + " Add, Contains, Remove");
+    SetT set;
+    for (const int value : values) {
+      set.add(value);
+    }
+    for (const int value : values) {
+      count += set.contains(value + 1);
+    }
+    for (const int value : values) {
+      count += set.remove(value);
+    }
+  }
+  std::cout << "  Count: " << count << "\n";
+}
+
+template<typename MapT>
+static void benchmark_strings(const char *name, const Span<std::string> values)
+{
+  int64_t count = 0;
+  {
+    SCOPED_TIMER(std::string(name) + " Strings");
+    MapT map;
+    for (const int i : values.index_range()) {
+      map.add(values[i], i);
+    }
+    for ([[maybe_unused]] const int i : IndexRange(4)) {
+      for (const std::string &value : values) {
+        count += map.lookup(value);
+      }
+    }
+  }
+  std::cout << "  Count: " << count << "\n";
+}
+
+TEST(map_performance, InsertHeavy)
+{
+  for (const int amount : {1000, 1000000, 10000000}) {
+    std::cout << amount << " random ints:\n";
+    const Vector<int> values = random_ints(amount, 1);
+    benchmark_insert_heavy<Map<int, int>>("  Map             ", values);
+    benchmark_insert_heavy<GroupProbingMap>("  GroupProbingMap ", values);
+  }
+  std::cout << "Clustered ints:\n";
+  const Vector<int> values = random_ints(1000000, 1 << 10);
+  benchmark_insert_heavy<Map<int, int>>("  Map             ", values);
+  benchmark_insert_heavy<GroupProbingMap>("  GroupProbingMap ", values);
+}
+
+TEST(map_performance, LookupHeavy)
+{
+  for (const int amount : {1000, 1000000, 10000000}) {
+    std::cout << amount << " random ints:\n";
+    const Vector<int> values = random_ints(amount, 1);
+    benchmark_lookup_heavy<Map<int, int>>("  Map             ", values);
+    benchmark_lookup_heavy<GroupProbingMap>("  GroupProbingMap ", values);
+  }
+}
+
+TEST(map_performance, Set)
+{
+  const Vector<int> values = random_ints(1000000, 1);
+  benchmark_set<Set<int>>("Set             ", values);
+  benchmark_set<GroupProbingSet>("GroupProbingSet ", values);
+}
+
+TEST(map_performance, Strings)
+{
+  Vector<std::string> values;
+  for (const int i : IndexRange(1000000)) {
+    values.append("attribute_" + std::to_string(i));
+  }
+  benchmark_strings<Map<std::string, int>>("Map             ", values);
+  benchmark_strings<GroupProbingStringMap>("GroupProbingMap ", values);
+}
+
+/**
+ * Large values, like the intersection results of pairs of triangles in the mesh intersection code
+ * (#ITT_value). Every overlapping pair is checked with #Map::contains before it is added, and the
+ * result of all pairs is looked up later.
+ */
+struct LargeValue {
+  double data[25];
+};
+
+template<typename MapT>
+static void benchmark_large_values(const char *name, const Span<std::pair<int, int>> pairs)
+{
+  int64_t count = 0;
+  {
+    SCOPED_TIMER(std::string(name) + " Large values");
+    MapT map;
+    map.reserve(pairs.size());
+    for (const std::pair<int, int> &pair : pairs) {
+      if (!map.contains(pair)) {
+        map.add_new(pair, {{double(pair.first)}});
+      }
+    }
+    for (const std::pair<int, int> &pair : pairs) {
+      count += map.lookup(pair).data[0] == double(pair.first);
+    }
+  }
+  std::cout << "  Count: " << count << "\n";
+}
+
+TEST(map_performance, LargeValues)
+{
+  for (const int amount : {1000, 100000, 1000000}) {
+    std::cout << amount << " pairs:\n";
+    RandomNumberGenerator rng(0);
+    Vector<std::pair<int, int>> pairs;
+    for ([[maybe_unused]] const int i : IndexRange(amount)) {
+      const int a = rng.get_int32(amount);
+      pairs.append({a, a + rng.get_int32(100)});
+    }
+    benchmark_large_values<Map<std::pair<int, int>, LargeValue>>("  Map             ", pairs);
+    benchmark_large_values<Map<std::pair<int, int>, LargeValue, 0, GroupProbingStrategy>>(
+        "  GroupProbingMap ", pairs);
+  }
+}
+
+/**
+ * Results on a single core of an x86-64 machine:
+ *
+ * 1000 random ints:        Insert     Map 76 us,     GroupProbingMap 43 us
+ * 1000000 random ints:     Insert     Map 102 ms,    GroupProbingMap 107 ms
+ * 10000000 random ints:    Insert     Map 1935 ms,   GroupProbingMap 2035 ms
+ * Clustered ints:          Insert     Map 117 ms,    GroupProbingMap 82 ms
+ * 1000 random ints:        Lookup     Map 33 us,     GroupProbingMap 29 us
+ * 1000000 random ints:     Lookup     Map 107 ms,    GroupProbingMap 78 ms
+ * 10000000 random ints:    Lookup     Map 1486 ms,   GroupProbingMap 2427 ms
+ * Set Add, Contains, Remove:          Set 140 ms,    GroupProbingSet 129 ms
+ * Strings:                            Map 1035 ms,   GroupProbingMap 1274 ms
+ * 1000 pairs:              Large      Map 311 us,    GroupProbingMap 241 us
+ * 100000 pairs:            Large      Map 59 ms,     GroupProbingMap 59 ms
+ * 1000000 pairs:           Large      Map 591 ms,    GroupProbingMap 561 ms
+ *
+ * Group probing helps for keys with clustered hashes and for tables that fit into the caches.
+ * For very large tables, accessing the control bytes is an additional cache miss. That is not the
+ * case for large slots, which is why the map of triangle intersections in mesh_intersect.cc uses
+ * it.
+ */
+
+}  // namespace blender::tests
@@ -0,0 +1,111 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_map.hh"
+#include "BLI_prefix_sum.hh"
+#include "BLI_rand.hh"
+#include "BLI_timeit.hh"
+
+#include <iostream>
+
+/**
+ * Compares the parallel sums to the serial loops used by the Accumulate Field node before.
+ */
+
+namespace blender::tests {
+
+static constexpr int64_t sizes[] = {1000000, 10000000, 50000000};
+
+static Array<float> random_floats(const int64_t size)
+{
+  Array<float> values(size);
+  RandomNumberGenerator rng(0);
+  for (float &value : values) {
+    value = rng.get_float();
+  }
+  return values;
+}
+
+TEST(prefix_sum_performance, PrefixSum)
+{
+  for (const int64_t size : sizes) {
+    std::cout << size << " floats:\n";
+    const Array<float> values = random_floats(size);
+    Array<float> sums(size);
+    {
+      SCOPED_TIMER("  Serial sum         ");
+      float sum = 0.0f;
+      for (const float value : values) {
+        sum = value + sum;
+      }
+      EXPECT_GT(sum, 0.0f);
+    }
+    {
+      SCOPED_TIMER("  parallel_sum       ");
+      EXPECT_GT(parallel_sum(values.as_span()), 0.0f);
+    }
+    {
+      SCOPED_TIMER("  Serial prefix sum  ");
+      float sum = 0.0f;
+      for (const int64_t i : values.index_range()) {
+        sum = values[i] + sum;
+        sums[i] = sum;
+      }
+    }
+    {
+      SCOPED_TIMER("  parallel_prefix_sum");
+      parallel_prefix_sum(values.as_span(), sums.as_mutable_span(), true);
+    }
+  }
+}
+
+TEST(prefix_sum_performance, GroupedPrefixSum)
+{
+  for (const int64_t size : sizes) {
+    for (const int groups_num : {10, 10000}) {
+      std::cout << size << " floats in " << groups_num << " groups:\n";
+      const Array<float> values = random_floats(size);
+      Array<int> groups(size);
+      RandomNumberGenerator rng(1);
+      for (int &group : groups) {
+        group = rng.get_int32(groups_num);
+      }
+      Array<float> sums(size);
+      {
+        SCOPED_TIMER("  Serial with map            ");
+        Map<int, float> group_sums;
+        for (const int64_t i : values.index_range()) {
+          float &sum = group_sums.lookup_or_add_default(groups[i]);
+          sum += values[i];
+          sums[i] = sum;
+        }
+      }
+      {
+        SCOPED_TIMER("  parallel_grouped_prefix_sum");
+        parallel_grouped_prefix_sum(
+            values.as_span(), groups.as_span(), sums.as_mutable_span(), true);
+      }
+    }
+  }
+}
+
+/**
+ * Results on a single core, so they only show the sequential overhead of the parallel versions:
+ *
+ *                             1M floats   10M floats   50M floats
+ * Serial sum                  1.1 ms      9.9 ms       50 ms
+ * parallel_sum                1.7 ms      9.5 ms       49 ms
+ * Serial prefix sum           2.9 ms      29 ms        152 ms
+ * parallel_prefix_sum         1.9 ms      22 ms        114 ms
+ * Serial with map (10)        6.8 ms      94 ms        347 ms
+ * parallel_grouped (10)       6.6 ms      69 ms        367 ms
+ * Serial with map (10000)     7.1 ms      75 ms        317 ms
+ * parallel_grouped (10000)    17 ms       127 ms       333 ms
+ *
+ * The grouped prefix sum reads the values twice, and with many groups the hash tables of the
+ * chunks have to be combined serially, so it only pays off with multiple threads.
+ */
+
+}  // namespace blender::tests
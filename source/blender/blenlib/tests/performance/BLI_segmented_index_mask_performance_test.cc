@@ -0,0 +1,94 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_segmented_index_mask.hh"
+#include "BLI_timeit.hh"
+
+#include <iostream>
+
+namespace blender::tests {
+
+static constexpr int64_t elements_num = 50000000;
+
+/**
+ * Selections made of runs of the given length, separated by gaps of the same length,
+ * with `noise` indices of the gaps selected every so often.
+ */
+static Array<bool> selection_create(const int64_t run_length, const bool noise)
+{
+  Array<bool> selection(elements_num);
+  for (const int64_t i : selection.index_range()) {
+    selection[i] = (i / run_length) % 2 == 0 || (noise && i % 97 == 0);
+  }
+  return selection;
+}
+
+static void index_mask_benchmark(const char *name, const Span<bool> selection)
+{
+  std::cout << name << ":\n";
+
+  Vector<int64_t> indices;
+  {
+    SCOPED_TIMER("  IndexMask create");
+    for (const int64_t i : selection.index_range()) {
+      if (selection[i]) {
+        indices.append(i);
+      }
+    }
+  }
+  SegmentedIndexMask segmented_mask;
+  {
+    SCOPED_TIMER("  SegmentedIndexMask create");
+    segmented_mask = SegmentedIndexMask::from_bools(selection);
+  }
+  std::cout << "  IndexMask memory: " << indices.size() * sizeof(int64_t) / 1024 << " KB\n";
+  std::cout << "  SegmentedIndexMask memory: " << segmented_mask.memory_size() / 1024 << " KB ("
+            << segmented_mask.segments_num() << " segments)\n";
+
+  /* Ranges passed as #IndexMask reference a shared array of indices, which is grown when needed.
+   * Do that before measuring the time. */
+  const IndexMask full_mask(elements_num);
+  UNUSED_VARS(full_mask);
+
+  Array<int> values(elements_num, 1);
+  int64_t sum_mask = 0;
+  {
+    SCOPED_TIMER("  IndexMask foreach_index");
+    const IndexMask mask = indices.as_span();
+    mask.foreach_index([&](const int64_t i) { sum_mask += values[i]; });
+  }
+  int64_t sum_segmented = 0;
+  {
+    SCOPED_TIMER("  SegmentedIndexMask foreach_index");
+    segmented_mask.foreach_index([&](const int64_t i) { sum_segmented += values[i]; });
+  }
+  EXPECT_EQ(sum_mask, sum_segmented);
+
+  int64_t sum_segments = 0;
+  {
+    SCOPED_TIMER("  SegmentedIndexMask foreach_segment_as_mask");
+    segmented_mask.foreach_segment_as_mask([&](const IndexMask mask) {
+      mask.foreach_index([&](const int64_t i) { sum_segments += values[i]; });
+    });
+  }
+  EXPECT_EQ(sum_mask, sum_segments);
+}
+
+TEST(segmented_index_mask, LongRunsPerformance)
+{
+  index_mask_benchmark("Long runs", selection_create(10000, false));
+}
+
+TEST(segmented_index_mask, ShortRunsPerformance)
+{
+  index_mask_benchmark("Short runs", selection_create(8, false));
+}
+
+TEST(segmented_index_mask, NoisyRunsPerformance)
+{
+  index_mask_benchmark("Noisy runs", selection_create(1000, true));
+}
+
+}  // namespace blender::tests
@@ -0,0 +1,121 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_rand.hh"
+#include "BLI_sort.hh"
+#include "BLI_timeit.hh"
+
+#include <iostream>
+
+namespace blender::tests {
+
+static constexpr int64_t sizes[] = {1000000, 10000000, 100000000};
+
+template<typename T, typename Fn> static void benchmark_sort(const char *name, Span<T> input, Fn fn)
+{
+  Array<T> values = input;
+  {
+    SCOPED_TIMER(name);
+    fn(values.as_mutable_span());
+  }
+  BLI_assert(std::is_sorted(values.begin(), values.end()));
+}
+
+TEST(sort_performance, Ints)
+{
+  for (const int64_t size : sizes) {
+    std::cout << size << " ints:\n";
+    Array<int> input(size);
+    RandomNumberGenerator rng(0);
+    for (int &value : input) {
+      value = int(rng.get_uint32());
+    }
+    benchmark_sort<int>("  std::sort           ", input, [](MutableSpan<int> values) {
+      std::sort(values.begin(), values.end());
+    });
+    benchmark_sort<int>("  std::stable_sort    ", input, [](MutableSpan<int> values) {
+      std::stable_sort(values.begin(), values.end());
+    });
+    benchmark_sort<int>("  parallel_sort       ", input, [](MutableSpan<int> values) {
+      parallel_sort(values.begin(), values.end());
+    });
+    benchmark_sort<int>("  parallel_stable_sort", input, [](MutableSpan<int> values) {
+      parallel_stable_sort(values);
+    });
+    benchmark_sort<int>("  parallel_radix_sort ", input, [](MutableSpan<int> values) {
+      parallel_radix_sort(values);
+    });
+  }
+}
+
+TEST(sort_performance, Floats)
+{
+  for (const int64_t size : sizes) {
+    std::cout << size << " floats:\n";
+    Array<float> input(size);
+    RandomNumberGenerator rng(0);
+    for (float &value : input) {
+      value = rng.get_float() * 2.0f - 1.0f;
+    }
+    benchmark_sort<float>("  std::sort           ", input, [](MutableSpan<float> values) {
+      std::sort(values.begin(), values.end());
+    });
+    benchmark_sort<float>("  parallel_sort       ", input, [](MutableSpan<float> values) {
+      parallel_sort(values.begin(), values.end());
+    });
+    benchmark_sort<float>("  parallel_radix_sort ", input, [](MutableSpan<float> values) {
+      parallel_radix_sort(values);
+    });
+  }
+}
+
+TEST(sort_performance, Median)
+{
+  for (const int64_t size : sizes) {
+    std::cout << size << " floats, median:\n";
+    Array<float> input(size);
+    RandomNumberGenerator rng(0);
+    for (float &value : input) {
+      value = rng.get_float() * 2.0f - 1.0f;
+    }
+    float median;
+    {
+      Array<float> values = input;
+      SCOPED_TIMER("  std::sort          ");
+      std::sort(values.begin(), values.end());
+      median = values[size / 2];
+    }
+    {
+      Array<float> values = input;
+      SCOPED_TIMER("  std::nth_element   ");
+      std::nth_element(values.begin(), values.begin() + size / 2, values.end());
+      EXPECT_EQ(values[size / 2], median);
+    }
+    {
+      SCOPED_TIMER("  parallel_nth_value ");
+      EXPECT_EQ(parallel_nth_value(input.as_span(), size / 2), median);
+    }
+  }
+}
+
+/**
+ * Results on a single core, so they only show the sequential overhead of the parallel versions:
+ *
+ *                        1M ints   10M ints   100M ints   100M floats
+ * std::sort              89 ms     1117 ms    12954 ms    14267 ms
+ * std::stable_sort       114 ms    1464 ms    18283 ms
+ * parallel_sort          97 ms     1185 ms    14653 ms    15519 ms
+ * parallel_stable_sort   113 ms    1531 ms    16952 ms
+ * parallel_radix_sort    15 ms     326 ms     3373 ms     2902 ms
+ *
+ * Finding the median:
+ *
+ *                        1M floats   10M floats   100M floats
+ * std::sort              128 ms      1264 ms      13047 ms
+ * std::nth_element       24 ms       134 ms       1504 ms
+ * parallel_nth_value     10 ms       73 ms        874 ms
+ */
+
+}  // namespace blender::tests
@@ -0,0 +1,146 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_kdtree.h"
+#include "BLI_rand.hh"
+#include "BLI_spatial_grid.hh"
+#include "BLI_task.hh"
+#include "BLI_timeit.hh"
+
+#include <iostream>
+
+/**
+ * Compares finding points within a distance of each other with the grid and with a KD-tree, as
+ * used for merging by distance.
+ */
+
+namespace blender::tests {
+
+static constexpr int64_t sizes[] = {1000000, 10000000};
+
+static Array<float3> uniform_points(const int64_t size)
+{
+  Array<float3> points(size);
+  RandomNumberGenerator rng(0);
+  for (float3 &point : points) {
+    point = float3(rng.get_float(), rng.get_float(), rng.get_float());
+  }
+  return points;
+}
+
+/** Points in a thousand small clusters, with many points within the distance in every one. */
+static Array<float3> clustered_points(const int64_t size)
+{
+  Array<float3> centers(1000);
+  RandomNumberGenerator rng(0);
+  for (float3 &center : centers) {
+    center = float3(rng.get_float(), rng.get_float(), rng.get_float());
+  }
+  Array<float3> points(size);
+  for (float3 &point : points) {
+    const float3 &center = centers[rng.get_int32(int(centers.size()))];
+    point = center + rng.get_unit_float3() * (rng.get_float() * 0.01f);
+  }
+  return points;
+}
+
+static void benchmark_duplicates(const Span<float3> points, const float distance)
+{
+  int found_kdtree;
+  {
+    SCOPED_TIMER("  KD-tree ");
+    KDTree_3d *tree = BLI_kdtree_3d_new(uint(points.size()));
+    for (const int i : points.index_range()) {
+      BLI_kdtree_3d_insert(tree, i, points[i]);
+    }
+    BLI_kdtree_3d_balance(tree);
+    Array<int> duplicates(points.size(), -1);
+    found_kdtree = BLI_kdtree_3d_calc_duplicates_fast(tree, distance, false, duplicates.data());
+    BLI_kdtree_3d_free(tree);
+  }
+  int found_grid;
+  {
+    SCOPED_TIMER("  Grid    ");
+    const SpatialGrid grid(points, distance);
+    Array<int> duplicates(points.size(), -1);
+    found_grid = grid.calc_duplicates(distance, duplicates);
+  }
+  std::cout << "  Merged: " << found_kdtree << " with the KD-tree, " << found_grid
+            << " with the grid\n";
+}
+
+TEST(spatial_grid_performance, CalcDuplicatesUniform)
+{
+  for (const int64_t size : sizes) {
+    std::cout << size << " uniform points:\n";
+    /* About one other point within the distance of every point. */
+    const float distance = std::cbrt(1.0f / float(size) / (4.0f / 3.0f * float(M_PI)));
+    benchmark_duplicates(uniform_points(size), distance);
+  }
+}
+
+TEST(spatial_grid_performance, CalcDuplicatesClustered)
+{
+  for (const int64_t size : sizes) {
+    std::cout << size << " clustered points:\n";
+    benchmark_duplicates(clustered_points(size), 0.001f);
+  }
+}
+
+static bool count_found(void *user_data, int /*index*/, const float * /*co*/, float /*dist_sq*/)
+{
+  (*static_cast<int64_t *>(user_data))++;
+  return true;
+}
+
+TEST(spatial_grid_performance, PointsInRadius)
+{
+  for (const int64_t size : sizes) {
+    std::cout << size << " uniform points, points in radius of all points:\n";
+    const Array<float3> points = uniform_points(size);
+    /* About ten points within the radius. */
+    const float radius = std::cbrt(10.0f / float(size) / (4.0f / 3.0f * float(M_PI)));
+    int64_t found_kdtree = 0;
+    {
+      SCOPED_TIMER("  KD-tree ");
+      KDTree_3d *tree = BLI_kdtree_3d_new(uint(size));
+      for (const int i : points.index_range()) {
+        BLI_kdtree_3d_insert(tree, i, points[i]);
+      }
+      BLI_kdtree_3d_balance(tree);
+      for (const float3 &point : points) {
+        BLI_kdtree_3d_range_search_cb(tree, point, radius, count_found, &found_kdtree);
+      }
+      BLI_kdtree_3d_free(tree);
+    }
+    int64_t found_grid = 0;
+    {
+      SCOPED_TIMER("  Grid    ");
+      const SpatialGrid grid(points, radius);
+      for (const float3 &point : points) {
+        grid.foreach_point_in_radius(
+            point, radius, [&](const int /*index*/, const float /*dist_sq*/) { found_grid++; });
+      }
+    }
+    EXPECT_EQ(found_kdtree, found_grid);
+  }
+}
+
+}  // namespace blender::tests
+
+/**
+ * Results on a single core, including building the tree or grid:
+ *
+ *                                KD-tree     Grid
+ * 1M uniform, duplicates          989 ms    752 ms
+ * 10M uniform, duplicates       10879 ms   7923 ms
+ * 1M clustered, duplicates        826 ms    652 ms
+ * 10M clustered, duplicates      7977 ms   4781 ms
+ * 1M uniform, points in radius   4514 ms   5368 ms
+ * 10M uniform, points in radius  81.7 s     83.6 s
+ *
+ * Separate radius queries in random order are limited by cache misses with both structures.
+ * The grid is faster when all points are processed cell by cell.
+ */
@@ -0,0 +1,100 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_timeit.hh"
+#include "BLI_virtual_array.hh"
+
+#include <array>
+#include <iostream>
+
+namespace blender::tests {
+
+static constexpr int64_t elements_num = 20000000;
+
+/**
+ * Sum all values of the virtual array, calling a virtual method for every element.
+ */
+static int64_t sum_per_element(const VArray<int> &varray)
+{
+  int64_t sum = 0;
+  for (const int64_t i : varray.index_range()) {
+    sum += varray[i];
+  }
+  return sum;
+}
+
+/**
+ * Sum all values of the virtual array, copying them into a small buffer one chunk at a time.
+ */
+static int64_t sum_chunked(const VArray<int> &varray)
+{
+  int64_t sum = 0;
+  Array<int, varray_chunk_size<int>> buffer(varray_chunk_size<int>);
+  const IndexRange range = varray.index_range();
+  for (int64_t start = 0; start < range.size(); start += buffer.size()) {
+    const IndexRange chunk = range.slice(start, std::min(buffer.size(), range.size() - start));
+    for (const int value : varray.get_internal_span_or_chunk(chunk, buffer)) {
+      sum += value;
+    }
+  }
+  return sum;
+}
+
+static int64_t sum_materialized(const VArray<int> &varray)
+{
+  Array<int> values(varray.size(), NoInitialization());
+  varray.materialize_to_uninitialized(values);
+  int64_t sum = 0;
+  for (const int value : values) {
+    sum += value;
+  }
+  return sum;
+}
+
+static void virtual_array_benchmark(const char *name, const VArray<int> &varray)
+{
+  std::cout << name << ":\n";
+  int64_t sum_element;
+  {
+    SCOPED_TIMER("  get per element");
+    sum_element = sum_per_element(varray);
+  }
+  int64_t sum_chunk;
+  {
+    SCOPED_TIMER("  materialize_chunk");
+    sum_chunk = sum_chunked(varray);
+  }
+  int64_t sum_full;
+  {
+    SCOPED_TIMER("  materialize whole array");
+    sum_full = sum_materialized(varray);
+  }
+  EXPECT_EQ(sum_element, sum_chunk);
+  EXPECT_EQ(sum_element, sum_full);
+}
+
+TEST(virtual_array, FuncPerformance)
+{
+  const VArray<int> varray = VArray<int>::ForFunc(elements_num,
+                                                  [](const int64_t i) { return int(i % 1000); });
+  virtual_array_benchmark("Func", varray);
+}
+
+static int get_first(const std::array<int, 4> &item)
+{
+  return item[0];
+}
+
+TEST(virtual_array, DerivedSpanPerformance)
+{
+  Array<std::array<int, 4>> data(elements_num);
+  for (const int64_t i : data.index_range()) {
+    data[i] = {int(i % 1000), 0, 0, 0};
+  }
+  const VArray<int> varray = VArray<int>::ForDerivedSpan<std::array<int, 4>, get_first>(data);
+  virtual_array_benchmark("DerivedSpan", varray);
+}
+
+}  // namespace blender::tests
@@ -243,6 +243,21 @@ void BLO_read_data_globmap_add(BlendDataReader *reader, void *oldaddr, void *new
 void BLO_read_glob_list(BlendDataReader *reader, struct ListBase *list);
 struct BlendFileReadReport *BLO_read_data_reports(BlendDataReader *reader);
 
+/**
+ * Callback reading deferred data of an ID, `id_file` is the ID struct as stored in the file,
+ * the data-blocks written with it can be read from `reader` as usual.
+ */
+typedef void (*BlendReadLazyDataFn)(BlendDataReader *reader,
+                                    struct ID *id,
+                                    const struct ID *id_file);
+/**
+ * Some of the data of the ID can be read later, when it is actually needed
+ * (see #BLO_READ_LAZY_DATA). When this returns true, the ID is tagged with #LIB_TAG_LAZY_DATA
+ * and `read_fn` will be called by #BLO_lazy_data_ensure, the caller is responsible for leaving
+ * the ID in a valid state without that data in the meantime.
+ */
+bool BLO_read_data_defer(BlendDataReader *reader, struct ID *id, BlendReadLazyDataFn read_fn);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -18,6 +18,7 @@ struct BHead;
 struct BlendThumbnail;
 struct Collection;
 struct FileData;
+struct ID;
 struct LinkNode;
 struct ListBase;
 struct Main;
@@ -68,7 +69,7 @@ typedef struct BlendFileData {
 } BlendFileData;
 
 struct BlendFileReadParams {
-  uint skip_flags : 3; /* #eBLOReadSkip */
+  uint skip_flags : 4; /* #eBLOReadSkip */
   uint is_startup : 1;
 
   /** Whether we are reading the memfile for an undo or a redo. */
@@ -86,6 +87,14 @@ typedef struct BlendFileReadReport {
     double lib_overrides;
     double lib_overrides_resync;
     double lib_overrides_recursive_resync;
+
+    /* Break-down of the reading phases, printed with `--debug-io`. */
+    /* Reading IDs of the main file and their data, including direct linking. */
+    double read_data;
+    /* Versioning before linking, including for libraries. */
+    double versioning;
+    double lib_link;
+    double versioning_after_linking;
   } duration;
 
   /* Count information. */
@@ -107,6 +116,11 @@ typedef struct BlendFileReadReport {
     int proxies_to_lib_overrides_failures;
     /* Number of sequencer strips that were not read because were in non-supported channels. */
     int sequence_strips_skipped;
+    /* Number of IDs which data is read on demand, see #BLO_READ_LAZY_DATA. */
+    int lazy_data_ids;
+    /* Number and size of data-blocks used from a memory-mapped file without copying them. */
+    int mapped_data_blocks;
+    size_t mapped_data_size;
   } count;
 
   /* Number of libraries which had overrides that needed to be resynced, and a single linked list
@@ -123,6 +137,12 @@ typedef enum eBLOReadSkip {
   BLO_READ_SKIP_DATA = (1 << 1),
   /** Do not attempt to re-use IDs from old bmain for unchanged ones in case of undo. */
   BLO_READ_SKIP_UNDO_OLD_MAIN = (1 << 2),
+  /**
+   * Defer reading the heaviest data of some IDs (currently mesh geometry) until it is needed,
+   * see #BLO_lazy_data_ensure. Only used for the main file, when it was saved with the same DNA
+   * as the current one (no versioning or conversion is needed).
+   */
+  BLO_READ_LAZY_DATA = (1 << 3),
 } eBLOReadSkip;
 #define BLO_READ_SKIP_ALL (BLO_READ_SKIP_USERDEF | BLO_READ_SKIP_DATA)
 
@@ -174,6 +194,41 @@ void BLO_blendfiledata_free(BlendFileData *bfd);
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name BLO Lazy Data API
+ *
+ * When reading a file with #BLO_READ_LAZY_DATA, the file is kept open and some IDs are tagged
+ * with #LIB_TAG_LAZY_DATA instead of reading all of their data.
+ * \{ */
+
+/**
+ * Read the data of the ID that was deferred when reading its file.
+ * Does nothing if the ID is not tagged with #LIB_TAG_LAZY_DATA. Concurrent calls are safe, but
+ * the ID is modified, so other threads must not access it at the same time (the depsgraph reads
+ * the data of its IDs before evaluating them).
+ */
+void BLO_lazy_data_ensure(struct ID *id);
+/**
+ * Read all deferred data of IDs in given Main.
+ */
+void BLO_lazy_data_ensure_all(struct Main *bmain);
+/**
+ * Read all the data that is still in the given file into memory and close it,
+ * needed before the file can be overwritten.
+ */
+void BLO_lazy_data_file_detach(const char *filepath);
+/**
+ * Whether some IDs still have data that has not been read from the files kept open.
+ */
+bool BLO_lazy_data_is_pending(void);
+/**
+ * Close the files kept open for lazy loading. IDs still tagged with #LIB_TAG_LAZY_DATA won't
+ * get their data anymore, only call when they are freed (e.g. when loading another file).
+ */
+void BLO_lazy_data_clear(void);
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLO Blend File Handle API
  * \{ */
@@ -262,6 +317,15 @@ struct PreviewImage *BLO_blendhandle_get_preview_for_id(BlendHandle *bh,
  * \return A BLI_linklist of strings. The string links should be freed with #MEM_freeN().
  */
 struct LinkNode *BLO_blendhandle_get_linkable_groups(BlendHandle *bh);
+/**
+ * Gets the file paths of the libraries the file links data-blocks from,
+ * as stored in the file (they may be relative to the file).
+ *
+ * \param bh: The blendhandle to access.
+ * \param r_tot_paths: The length of the returned list.
+ * \return A BLI_linklist of strings. The string links should be freed with #MEM_freeN().
+ */
+struct LinkNode *BLO_blendhandle_get_library_paths(BlendHandle *bh, int *r_tot_paths);
 
 /**
  * Close and free a blendhandle. The handle becomes invalid after this call.
@@ -270,6 +334,13 @@ struct LinkNode *BLO_blendhandle_get_linkable_groups(BlendHandle *bh);
  */
 void BLO_blendhandle_close(BlendHandle *bh);
 
+/**
+ * Use the index of data-blocks stored in files to list their content, instead of reading all
+ * the blocks of the file (enabled by default). The results are identical either way,
+ * this is meant for debugging and tests.
+ */
+void BLO_read_use_file_index_set(bool use_file_index);
+
 /** \} */
 
 #define BLO_GROUP_MAX 32
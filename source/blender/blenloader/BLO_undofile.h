@@ -32,6 +32,11 @@ typedef struct {
 typedef struct MemFile {
   ListBase chunks;
   size_t size;
+  /**
+   * Some IDs data has not been read from their file yet (see #BLO_lazy_data_ensure), so this
+   * can't be written as a regular file with #BLO_memfile_write_file.
+   */
+  bool has_lazy_data;
 } MemFile;
 
 typedef struct MemFileWriteData {
@@ -65,6 +65,12 @@ extern bool BLO_write_file_mem(struct Main *mainvar,
                                struct MemFile *current,
                                int write_flags);
 
+/**
+ * Serialize data-blocks from multiple threads when writing (enabled by default).
+ * The written data is identical either way, this is meant for debugging and tests.
+ */
+extern void BLO_write_use_threads_set(bool use_threads);
+
 /** \} */
 
 #ifdef __cplusplus
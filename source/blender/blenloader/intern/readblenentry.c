@@ -110,6 +110,24 @@ LinkNode *BLO_blendhandle_get_datablock_names(BlendHandle *bh,
   BHead *bhead;
   int tot = 0;
 
+  if (fd->index_entries != NULL) {
+    for (int i = 0; i < fd->index_footer->entries_num; i++) {
+      const BlendFileIndexEntry *entry = &fd->index_entries[i];
+      if (entry->code != ofblocktype) {
+        continue;
+      }
+      if (use_assets_only && (entry->flag & BLEND_FILE_INDEX_ENTRY_IS_ASSET) == 0) {
+        continue;
+      }
+
+      BLI_linklist_prepend(&names, BLI_strdup(entry->name + 2));
+      tot++;
+    }
+
+    *r_tot_names = tot;
+    return names;
+  }
+
   for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
     if (bhead->code == ofblocktype) {
       const char *idname = blo_bhead_id_name(fd, bhead);
@@ -129,6 +147,20 @@ LinkNode *BLO_blendhandle_get_datablock_names(BlendHandle *bh,
   return names;
 }
 
+/**
+ * Whether some data-blocks of the given type are assets, according to the file index.
+ */
+static bool blo_file_index_has_assets(const FileData *fd, int ofblocktype)
+{
+  for (int i = 0; i < fd->index_footer->entries_num; i++) {
+    const BlendFileIndexEntry *entry = &fd->index_entries[i];
+    if (entry->code == ofblocktype && (entry->flag & BLEND_FILE_INDEX_ENTRY_IS_ASSET)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 LinkNode *BLO_blendhandle_get_datablock_info(BlendHandle *bh,
                                              int ofblocktype,
                                              const bool use_assets_only,
@@ -139,6 +171,29 @@ LinkNode *BLO_blendhandle_get_datablock_info(BlendHandle *bh,
   BHead *bhead;
   int tot = 0;
 
+  /* The asset meta-data has to be read from the blocks following the ID, in that case all blocks
+   * are read. */
+  if (fd->index_entries != NULL && !blo_file_index_has_assets(fd, ofblocktype)) {
+    if (!use_assets_only) {
+      for (int i = 0; i < fd->index_footer->entries_num; i++) {
+        const BlendFileIndexEntry *entry = &fd->index_entries[i];
+        if (entry->code != ofblocktype) {
+          continue;
+        }
+
+        struct BLODataBlockInfo *info = MEM_mallocN(sizeof(*info), __func__);
+        STRNCPY(info->name, entry->name + 2);
+        info->asset_data = NULL;
+
+        BLI_linklist_prepend(&infos, info);
+        tot++;
+      }
+    }
+
+    *r_tot_info_items = tot;
+    return infos;
+  }
+
   for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
     if (bhead->code == ENDB) {
       break;
@@ -216,12 +271,78 @@ static BHead *blo_blendhandle_read_preview_rects(FileData *fd,
   return bhead;
 }
 
+/**
+ * Read the preview stored at the given offset, and the preview rects following it,
+ * using the file index.
+ *
+ * \param result: the Preview Image where the preview will be stored.
+ * \return false when the preview couldn't be read, `result` is unchanged then.
+ */
+static bool blo_blendhandle_read_preview_at(FileData *fd, uint64_t offset, PreviewImage *result)
+{
+  BHead *bhead = blo_bhead_read_detached(fd, offset);
+  if (bhead == NULL) {
+    return false;
+  }
+  PreviewImage *preview_from_file = BLO_library_read_struct(fd, bhead, "PreviewImage");
+  offset += sizeof(BHead) + (uint64_t)bhead->len;
+  blo_bhead_free_detached(bhead);
+  if (preview_from_file == NULL) {
+    return false;
+  }
+
+  memcpy(result, preview_from_file, sizeof(PreviewImage));
+  for (int preview_index = 0; preview_index < NUM_ICON_SIZES; preview_index++) {
+    result->rect[preview_index] = NULL;
+    if (preview_from_file->rect[preview_index] && preview_from_file->w[preview_index] &&
+        preview_from_file->h[preview_index]) {
+      bhead = blo_bhead_read_detached(fd, offset);
+      if (bhead != NULL) {
+        BLI_assert((preview_from_file->w[preview_index] * preview_from_file->h[preview_index] *
+                    sizeof(uint)) == bhead->len);
+        result->rect[preview_index] = BLO_library_read_struct(
+            fd, bhead, "PreviewImage Icon Rect");
+        offset += sizeof(BHead) + (uint64_t)bhead->len;
+        blo_bhead_free_detached(bhead);
+      }
+    }
+    if (result->rect[preview_index] == NULL) {
+      result->w[preview_index] = result->h[preview_index] = 0;
+    }
+    BKE_previewimg_finish(result, preview_index);
+  }
+
+  MEM_freeN(preview_from_file);
+  return true;
+}
+
 PreviewImage *BLO_blendhandle_get_preview_for_id(BlendHandle *bh,
                                                  int ofblocktype,
                                                  const char *name)
 {
   FileData *fd = (FileData *)bh;
   bool looking = false;
+
+  if (fd->index_entries != NULL) {
+    for (int i = 0; i < fd->index_footer->entries_num; i++) {
+      const BlendFileIndexEntry *entry = &fd->index_entries[i];
+      if (entry->code != ofblocktype || !STREQ(entry->name + 2, name)) {
+        continue;
+      }
+      if (entry->preview_offset == 0) {
+        break;
+      }
+
+      PreviewImage *result = MEM_callocN(sizeof(PreviewImage), __func__);
+      if (!blo_blendhandle_read_preview_at(fd, entry->preview_offset, result)) {
+        MEM_freeN(result);
+        result = NULL;
+      }
+      return result;
+    }
+    return NULL;
+  }
+
   const int sdna_preview_image = DNA_struct_find_nr(fd->filesdna, "PreviewImage");
 
   for (BHead *bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
@@ -255,6 +376,25 @@ PreviewImage *BLO_blendhandle_get_preview_for_id(BlendHandle *bh,
   return NULL;
 }
 
+static bool blo_blendhandle_idcode_has_preview(const short idcode)
+{
+  switch (idcode) {
+    case ID_MA:  /* fall through */
+    case ID_TE:  /* fall through */
+    case ID_IM:  /* fall through */
+    case ID_WO:  /* fall through */
+    case ID_LA:  /* fall through */
+    case ID_OB:  /* fall through */
+    case ID_GR:  /* fall through */
+    case ID_SCE: /* fall through */
+    case ID_AC:  /* fall through */
+    case ID_NT:  /* fall through */
+      return true;
+    default:
+      return false;
+  }
+}
+
 LinkNode *BLO_blendhandle_get_previews(BlendHandle *bh, int ofblocktype, int *r_tot_prev)
 {
   FileData *fd = (FileData *)bh;
@@ -265,27 +405,33 @@ LinkNode *BLO_blendhandle_get_previews(BlendHandle *bh, int ofblocktype, int *r_
   PreviewImage *new_prv = NULL;
   int tot = 0;
 
+  if (fd->index_entries != NULL) {
+    for (int i = 0; i < fd->index_footer->entries_num; i++) {
+      const BlendFileIndexEntry *entry = &fd->index_entries[i];
+      if (entry->code != ofblocktype || !blo_blendhandle_idcode_has_preview(GS(entry->name))) {
+        continue;
+      }
+
+      new_prv = MEM_callocN(sizeof(PreviewImage), "newpreview");
+      BLI_linklist_prepend(&previews, new_prv);
+      tot++;
+      if (entry->preview_offset != 0) {
+        blo_blendhandle_read_preview_at(fd, entry->preview_offset, new_prv);
+      }
+    }
+
+    *r_tot_prev = tot;
+    return previews;
+  }
+
   for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
     if (bhead->code == ofblocktype) {
       const char *idname = blo_bhead_id_name(fd, bhead);
-      switch (GS(idname)) {
-        case ID_MA:  /* fall through */
-        case ID_TE:  /* fall through */
-        case ID_IM:  /* fall through */
-        case ID_WO:  /* fall through */
-        case ID_LA:  /* fall through */
-        case ID_OB:  /* fall through */
-        case ID_GR:  /* fall through */
-        case ID_SCE: /* fall through */
-        case ID_AC:  /* fall through */
-        case ID_NT:  /* fall through */
-          new_prv = MEM_callocN(sizeof(PreviewImage), "newpreview");
-          BLI_linklist_prepend(&previews, new_prv);
-          tot++;
-          looking = 1;
-          break;
-        default:
-          break;
+      if (blo_blendhandle_idcode_has_preview(GS(idname))) {
+        new_prv = MEM_callocN(sizeof(PreviewImage), "newpreview");
+        BLI_linklist_prepend(&previews, new_prv);
+        tot++;
+        looking = 1;
       }
     }
     else if (bhead->code == DATA) {
@@ -322,6 +468,22 @@ LinkNode *BLO_blendhandle_get_linkable_groups(BlendHandle *bh)
   LinkNode *names = NULL;
   BHead *bhead;
 
+  if (fd->index_entries != NULL) {
+    for (int i = 0; i < fd->index_footer->entries_num; i++) {
+      const int code = fd->index_entries[i].code;
+      if (BKE_idtype_idcode_is_valid(code) && BKE_idtype_idcode_is_linkable(code)) {
+        const char *str = BKE_idtype_idcode_to_name(code);
+
+        if (BLI_gset_add(gathered, (void *)str)) {
+          BLI_linklist_prepend(&names, BLI_strdup(str));
+        }
+      }
+    }
+
+    BLI_gset_free(gathered, NULL);
+    return names;
+  }
+
   for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
     if (bhead->code == ENDB) {
       break;
@@ -342,6 +504,40 @@ LinkNode *BLO_blendhandle_get_linkable_groups(BlendHandle *bh)
   return names;
 }
 
+LinkNode *BLO_blendhandle_get_library_paths(BlendHandle *bh, int *r_tot_paths)
+{
+  FileData *fd = (FileData *)bh;
+  LinkNode *paths = NULL;
+  int tot = 0;
+
+  if (fd->index_libraries != NULL) {
+    for (int i = 0; i < fd->index_footer->libraries_num; i++) {
+      BLI_linklist_prepend(&paths, BLI_strdup(fd->index_libraries[i].filepath));
+      tot++;
+    }
+
+    *r_tot_paths = tot;
+    return paths;
+  }
+
+  for (BHead *bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+    if (bhead->code == ENDB) {
+      break;
+    }
+    if (bhead->code == ID_LI) {
+      Library *library = BLO_library_read_struct(fd, bhead, "Library");
+      if (library != NULL) {
+        BLI_linklist_prepend(&paths, BLI_strdup(library->filepath));
+        MEM_freeN(library);
+        tot++;
+      }
+    }
+  }
+
+  *r_tot_paths = tot;
+  return paths;
+}
+
 void BLO_blendhandle_close(BlendHandle *bh)
 {
   FileData *fd = (FileData *)bh;
@@ -362,7 +558,10 @@ BlendFileData *BLO_read_from_file(const char *filepath,
   if (fd) {
     fd->skip_flags = skip_flags;
     bfd = blo_read_file_internal(fd, filepath);
-    blo_filedata_free(fd);
+    /* With lazy data, the file is kept open for reading the deferred data later. */
+    if (bfd == NULL || (skip_flags & BLO_READ_LAZY_DATA) == 0 || !blo_lazy_data_register(fd)) {
+      blo_filedata_free(fd);
+    }
   }
 
   return bfd;
@@ -45,6 +45,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_blenlib.h"
 #include "BLI_endian_defines.h"
 #include "BLI_endian_switch.h"
@@ -62,6 +64,7 @@
 #include "BKE_anim_data.h"
 #include "BKE_animsys.h"
 #include "BKE_asset.h"
+#include "BKE_blender_version.h"
 #include "BKE_collection.h"
 #include "BKE_global.h" /* for G */
 #include "BKE_idprop.h"
@@ -966,6 +969,36 @@ static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
   return success;
 }
 
+/**
+ * Use the data of a block directly from a memory-mapped file, instead of allocating memory and
+ * copying it. Only done for large blocks, since the header written in front of the data makes
+ * the system copy the page containing it.
+ */
+#define BHEAD_CLAIM_SIZE_MIN (1 << 16)
+
+static void *blo_bhead_claim_data(FileData *fd, BHead *thisblock)
+{
+  BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
+  if (fd->file->claim == NULL || new_bhead->has_data || thisblock->len < BHEAD_CLAIM_SIZE_MIN) {
+    return NULL;
+  }
+  /* The memory can only be used as is, and may be modified afterwards, so it must not be read
+   * again from the file (as done for lazily loaded data). */
+  if (fd->flags & (FD_FLAGS_SWITCH_ENDIAN | FD_FLAGS_LAZY_DATA)) {
+    return NULL;
+  }
+  if (fd->compflags[thisblock->SDNAnr] != SDNA_CMP_EQUAL) {
+    return NULL;
+  }
+
+  void *data = fd->file->claim(fd->file, new_bhead->file_offset, (size_t)thisblock->len);
+  if (data != NULL && fd->reports != NULL) {
+    fd->reports->count.mapped_data_blocks++;
+    fd->reports->count.mapped_data_size += (size_t)thisblock->len;
+  }
+  return data;
+}
+
 static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
 {
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
@@ -982,6 +1015,39 @@ static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
 }
 #endif /* USE_BHEAD_READ_ON_DEMAND */
 
+BHead *blo_bhead_read_detached(FileData *fd, uint64_t offset)
+{
+  /* The index is only used when blocks can be read as is. */
+  BLI_assert(fd->index_entries != NULL);
+
+  BHeadN *new_bhead = NULL;
+  const off64_t offset_backup = fd->file->offset;
+  BHead bhead;
+  if (fd->file->seek(fd->file, (off64_t)offset, SEEK_SET) != -1 &&
+      fd->file->read(fd->file, &bhead, sizeof(bhead)) == sizeof(bhead) && bhead.len >= 0) {
+    new_bhead = MEM_mallocN(sizeof(BHeadN) + (size_t)bhead.len, __func__);
+    new_bhead->next = new_bhead->prev = NULL;
+#ifdef USE_BHEAD_READ_ON_DEMAND
+    new_bhead->file_offset = (off64_t)(offset + sizeof(bhead));
+    new_bhead->has_data = true;
+#endif
+    new_bhead->is_memchunk_identical = false;
+    new_bhead->bhead = bhead;
+    if (fd->file->read(fd->file, new_bhead + 1, (size_t)bhead.len) != bhead.len) {
+      MEM_freeN(new_bhead);
+      new_bhead = NULL;
+    }
+  }
+  fd->file->seek(fd->file, offset_backup, SEEK_SET);
+
+  return new_bhead ? &new_bhead->bhead : NULL;
+}
+
+void blo_bhead_free_detached(BHead *bhead)
+{
+  MEM_freeN(BHEADN_FROM_BHEAD(bhead));
+}
+
 const char *blo_bhead_id_name(const FileData *fd, const BHead *bhead)
 {
   return (const char *)POINTER_OFFSET(bhead, sizeof(*bhead) + fd->id_name_offset);
@@ -1035,6 +1101,111 @@ static void decode_blender_header(FileData *fd)
   }
 }
 
+/** Reading of the index of data-blocks, see #BlendFileIndexFooter. */
+static bool use_file_index = true;
+
+void BLO_read_use_file_index_set(bool use_file_index_new)
+{
+  use_file_index = use_file_index_new;
+}
+
+static bool read_file_index_at_end(FileData *fd)
+{
+  FileReader *file = fd->file;
+  const off64_t file_end = file->seek(file, 0, SEEK_END);
+  /* The index ends with its footer, followed by the #ENDB block. */
+  struct {
+    BlendFileIndexFooter footer;
+    BHead endb;
+  } tail;
+  const off64_t tail_offset = file_end - (off64_t)sizeof(tail);
+  if (file_end == -1 || tail_offset < SIZEOFBLENDERHEADER ||
+      file->seek(file, tail_offset, SEEK_SET) == -1 ||
+      file->read(file, &tail, sizeof(tail)) != sizeof(tail)) {
+    return false;
+  }
+
+  const BlendFileIndexFooter *footer = &tail.footer;
+  if (tail.endb.code != ENDB ||
+      memcmp(footer->magic, BLEND_FILE_INDEX_MAGIC, sizeof(footer->magic)) != 0 ||
+      footer->version != BLEND_FILE_INDEX_VERSION || footer->entries_num < 0 ||
+      footer->libraries_num < 0) {
+    return false;
+  }
+
+  const size_t index_size = BLEND_FILE_INDEX_SIZE(footer->entries_num, footer->libraries_num);
+  const off64_t index_bhead_offset = file_end - (off64_t)(sizeof(BHead) * 2 + index_size);
+  BHead index_bhead;
+  if (index_bhead_offset < SIZEOFBLENDERHEADER || footer->dna_offset >= (uint64_t)index_bhead_offset ||
+      file->seek(file, index_bhead_offset, SEEK_SET) == -1 ||
+      file->read(file, &index_bhead, sizeof(index_bhead)) != sizeof(index_bhead)) {
+    return false;
+  }
+  if (index_bhead.code != DATA || (size_t)index_bhead.len != index_size) {
+    return false;
+  }
+
+  char *index = MEM_mallocN(index_size, __func__);
+  if (file->read(file, index, index_size) != (ssize_t)index_size) {
+    MEM_freeN(index);
+    return false;
+  }
+
+  fd->index_entries = (BlendFileIndexEntry *)index;
+  fd->index_libraries = (BlendFileIndexLibrary *)(fd->index_entries + footer->entries_num);
+  fd->index_footer = (BlendFileIndexFooter *)(fd->index_libraries + footer->libraries_num);
+  return true;
+}
+
+/**
+ * Read the index of data-blocks stored at the end of the file, when there is one.
+ * The file is read from the start again afterwards.
+ */
+static void read_file_index(FileData *fd)
+{
+  if (!use_file_index || fd->file->seek == NULL) {
+    return;
+  }
+  /* The index is stored without any conversion. */
+  if (fd->flags &
+      (FD_FLAGS_IS_MEMFILE | FD_FLAGS_SWITCH_ENDIAN | FD_FLAGS_POINTSIZE_DIFFERS)) {
+    return;
+  }
+
+  const off64_t offset_backup = fd->file->offset;
+  read_file_index_at_end(fd);
+  if (fd->file->seek(fd->file, offset_backup, SEEK_SET) == -1) {
+    fd->is_eof = true;
+  }
+}
+
+/**
+ * Decode the SDNA stored in the given #DNA1 block.
+ */
+static bool read_file_dna_block(FileData *fd,
+                                BHead *bhead,
+                                const int subversion,
+                                const char **r_error_message)
+{
+  const bool do_endian_swap = (fd->flags & FD_FLAGS_SWITCH_ENDIAN) != 0;
+
+  fd->filesdna = DNA_sdna_from_data(&bhead[1], bhead->len, do_endian_swap, true, r_error_message);
+  if (fd->filesdna) {
+    blo_do_versions_dna(fd->filesdna, fd->fileversion, subversion);
+    fd->compflags = DNA_struct_get_compareflags(fd->filesdna, fd->memsdna);
+    fd->reconstruct_info = DNA_reconstruct_info_create(fd->filesdna, fd->memsdna, fd->compflags);
+    /* used to retrieve ID names from (bhead+1) */
+    fd->id_name_offset = DNA_elem_offset(fd->filesdna, "ID", "char", "name[]");
+    BLI_assert(fd->id_name_offset != -1);
+    fd->id_asset_data_offset = DNA_elem_offset(
+        fd->filesdna, "ID", "AssetMetaData", "*asset_data");
+
+    return true;
+  }
+
+  return false;
+}
+
 /**
  * \return Success if the file is read correctly, else set \a r_error_message.
  */
@@ -1043,6 +1214,20 @@ static bool read_file_dna(FileData *fd, const char **r_error_message)
   BHead *bhead;
   int subversion = 0;
 
+  if (fd->index_footer != NULL) {
+    /* Read the DNA directly, without going over all blocks of the file. */
+    bhead = blo_bhead_read_detached(fd, fd->index_footer->dna_offset);
+    if (bhead != NULL && bhead->code == DNA1) {
+      const bool success = read_file_dna_block(
+          fd, bhead, fd->index_footer->file_subversion, r_error_message);
+      blo_bhead_free_detached(bhead);
+      return success;
+    }
+    if (bhead != NULL) {
+      blo_bhead_free_detached(bhead);
+    }
+  }
+
   for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
     if (bhead->code == GLOB) {
       /* Before this, the subversion didn't exist in 'FileGlobal' so the subversion
@@ -1060,25 +1245,7 @@ static bool read_file_dna(FileData *fd, const char **r_error_message)
       subversion = atoi(num);
     }
     else if (bhead->code == DNA1) {
-      const bool do_endian_swap = (fd->flags & FD_FLAGS_SWITCH_ENDIAN) != 0;
-
-      fd->filesdna = DNA_sdna_from_data(
-          &bhead[1], bhead->len, do_endian_swap, true, r_error_message);
-      if (fd->filesdna) {
-        blo_do_versions_dna(fd->filesdna, fd->fileversion, subversion);
-        fd->compflags = DNA_struct_get_compareflags(fd->filesdna, fd->memsdna);
-        fd->reconstruct_info = DNA_reconstruct_info_create(
-            fd->filesdna, fd->memsdna, fd->compflags);
-        /* used to retrieve ID names from (bhead+1) */
-        fd->id_name_offset = DNA_elem_offset(fd->filesdna, "ID", "char", "name[]");
-        BLI_assert(fd->id_name_offset != -1);
-        fd->id_asset_data_offset = DNA_elem_offset(
-            fd->filesdna, "ID", "AssetMetaData", "*asset_data");
-
-        return true;
-      }
-
-      return false;
+      return read_file_dna_block(fd, bhead, subversion, r_error_message);
     }
     else if (bhead->code == ENDB) {
       break;
@@ -1157,6 +1324,8 @@ static FileData *blo_decode_and_check(FileData *fd, ReportList *reports)
   decode_blender_header(fd);
 
   if (fd->flags & FD_FLAGS_FILE_OK) {
+    read_file_index(fd);
+
     const char *error_message = NULL;
     if (read_file_dna(fd, &error_message) == false) {
       BKE_reportf(
@@ -1342,13 +1511,17 @@ void blo_filedata_free(FileData *fd)
 #else
     /* Sanity check we're not keeping memory we don't need. */
     LISTBASE_FOREACH_MUTABLE (BHeadN *, new_bhead, &fd->bhead_list) {
-      if (fd->file->seek != NULL && BHEAD_USE_READ_ON_DEMAND(&new_bhead->bhead)) {
+      if (fd->file != NULL && fd->file->seek != NULL &&
+          BHEAD_USE_READ_ON_DEMAND(&new_bhead->bhead)) {
         BLI_assert(new_bhead->has_data == 0);
       }
       MEM_freeN(new_bhead);
     }
 #endif
-    fd->file->close(fd->file);
+    /* Can be NULL after detaching the file data for lazy loading. */
+    if (fd->file != NULL) {
+      fd->file->close(fd->file);
+    }
 
     if (fd->filesdna) {
       DNA_sdna_free(fd->filesdna);
@@ -1386,6 +1559,13 @@ void blo_filedata_free(FileData *fd)
     }
 #endif
 
+    if (fd->lazy_data_ids) {
+      BLI_ghash_free(fd->lazy_data_ids, NULL, MEM_freeN);
+    }
+    if (fd->index_entries) {
+      MEM_freeN(fd->index_entries);
+    }
+
     MEM_freeN(fd);
   }
 }
@@ -2130,7 +2310,13 @@ static void direct_link_id_common(
   id->py_instance = NULL;
 
   /* Initialize with provided tag. */
-  id->tag = tag;
+  if (BLO_read_data_is_undo(reader)) {
+    /* Data still in the original file is not written in undo steps. */
+    id->tag = tag | (id->tag & LIB_TAG_LAZY_DATA);
+  }
+  else {
+    id->tag = tag;
+  }
 
   if (ID_IS_LINKED(id)) {
     id->library_weak_reference = NULL;
@@ -3058,7 +3244,14 @@ static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *all
     }
 #endif
 
+#ifdef USE_BHEAD_READ_ON_DEMAND
+    void *data = blo_bhead_claim_data(fd, bhead);
+    if (data == NULL) {
+      data = read_struct(fd, bhead, allocname);
+    }
+#else
     void *data = read_struct(fd, bhead, allocname);
+#endif
     if (data) {
       oldnewmap_insert(fd->datamap, bhead->old, data, 0);
     }
@@ -3172,7 +3365,7 @@ static void read_libblock_undo_restore_identical(
   BLI_assert(id_old != NULL);
 
   /* Some tags need to be preserved here. */
-  id_old->tag = tag | (id_old->tag & LIB_TAG_EXTRAUSER);
+  id_old->tag = tag | (id_old->tag & (LIB_TAG_EXTRAUSER | LIB_TAG_LAZY_DATA));
   id_old->lib = main->curlib;
   id_old->us = ID_FAKE_USERS(id_old);
   /* Do not reset id->icon_id here, memory allocated for it remains valid. */
@@ -3408,9 +3601,11 @@ static BHead *read_libblock(FileData *fd,
   /* Read datablock contents.
    * Use convenient malloc name for debugging and better memory link prints. */
   const char *allocname = dataname(idcode);
+  fd->lazy_data_id_bhead = bhead;
   bhead = read_data_into_datamap(fd, bhead, allocname);
   const bool success = direct_link_id(fd, main, id_tag, id, id_old);
   oldnewmap_clear(fd->datamap);
+  fd->lazy_data_id_bhead = NULL;
 
   if (!success) {
     /* XXX This is probably working OK currently given the very limited scope of that flag.
@@ -3547,6 +3742,8 @@ static void do_versions(FileData *fd, Library *lib, Main *main)
 {
   /* WATCH IT!!!: pointers from libdata have not been converted */
 
+  const double start_time = PIL_check_seconds_timer();
+
   /* Don't allow versioning to create new data-blocks. */
   main->is_locked_for_linking = true;
 
@@ -3586,6 +3783,8 @@ static void do_versions(FileData *fd, Library *lib, Main *main)
   /* don't forget to set version number in BKE_blender_version.h! */
 
   main->is_locked_for_linking = false;
+
+  fd->reports->duration.versioning += PIL_check_seconds_timer() - start_time;
 }
 
 static void do_versions_after_linking(Main *main, ReportList *reports)
@@ -3807,6 +4006,273 @@ static BHead *read_userdef(BlendFileData *bfd, FileData *fd, BHead *bhead)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Lazy Data Loading
+ *
+ * With #BLO_READ_LAZY_DATA, ID types can defer reading their heaviest data using
+ * #BLO_read_data_defer. The #FileData is then kept open once reading is done, and the deferred
+ * data is read when #BLO_lazy_data_ensure is called. IDs are identified by their session UUID,
+ * so that undo steps which did not have the data yet can still find it.
+ * \{ */
+
+typedef struct LazyDataFile {
+  FileData *fd;
+  /** Number of #LazyDataID reading from this file. */
+  int users;
+  /** All data has been read in memory and the file closed, see #BLO_lazy_data_file_detach. */
+  bool is_detached;
+} LazyDataFile;
+
+typedef struct LazyDataID {
+  /** Set once reading of the file is done, see #blo_lazy_data_register. */
+  LazyDataFile *file;
+  /** The #BHead of the ID, followed by its data-blocks. */
+  BHead *bhead;
+  BlendReadLazyDataFn read_fn;
+} LazyDataID;
+
+/** Maps session UUIDs to #LazyDataID, for IDs which data has not been read yet. */
+static GHash *lazy_data_ids = NULL;
+/**
+ * Maps session UUIDs to #LazyDataID, for IDs which data has been read already. Only kept so that
+ * undo steps written before the data was read can read it again.
+ */
+static GHash *lazy_data_ids_read = NULL;
+static ThreadMutex lazy_data_mutex = BLI_MUTEX_INITIALIZER;
+
+static bool lazy_data_is_supported(const FileData *fd, const Main *bmain)
+{
+  if (fd->flags & (FD_FLAGS_IS_MEMFILE | FD_FLAGS_SWITCH_ENDIAN | FD_FLAGS_POINTSIZE_DIFFERS)) {
+    return false;
+  }
+  /* The data must be read from the file again later, without keeping all of it in memory. */
+  if (fd->file->seek == NULL) {
+    return false;
+  }
+  /* Deferred data does not go through versioning, nor DNA conversion. */
+  if (fd->fileversion != BLENDER_FILE_VERSION ||
+      bmain->subversionfile != BLENDER_FILE_SUBVERSION) {
+    return false;
+  }
+  return (fd->filesdna->data_len == fd->memsdna->data_len) &&
+         (memcmp(fd->filesdna->data, fd->memsdna->data, (size_t)fd->memsdna->data_len) == 0);
+}
+
+static void lazy_data_ids_free(GHash *ids)
+{
+  if (ids == NULL) {
+    return;
+  }
+  GHASH_FOREACH_BEGIN (LazyDataID *, lazy_id, ids) {
+    LazyDataFile *file = lazy_id->file;
+    if (--file->users == 0) {
+      blo_filedata_free(file->fd);
+      MEM_freeN(file);
+    }
+    MEM_freeN(lazy_id);
+  }
+  GHASH_FOREACH_END();
+  BLI_ghash_free(ids, NULL, NULL);
+}
+
+static void lazy_data_clear_ex(void)
+{
+  lazy_data_ids_free(lazy_data_ids);
+  lazy_data_ids_free(lazy_data_ids_read);
+  lazy_data_ids = NULL;
+  lazy_data_ids_read = NULL;
+}
+
+static void lazy_data_read(LazyDataID *lazy_id, ID *id)
+{
+  FileData *fd = lazy_id->file->fd;
+  BlendFileReadReport reports = {NULL};
+  fd->reports = &reports;
+
+  ID *id_file = read_struct(fd, lazy_id->bhead, "lazy data ID");
+  if (id_file != NULL) {
+    read_data_into_datamap(fd, lazy_id->bhead, dataname(GS(id->name)));
+    BlendDataReader reader = {fd};
+    lazy_id->read_fn(&reader, id, id_file);
+    oldnewmap_clear(fd->datamap);
+    MEM_freeN(id_file);
+  }
+  else {
+    CLOG_ERROR(&LOG, "Failed to read data of %s from '%s'", id->name, fd->relabase);
+  }
+
+  fd->reports = NULL;
+}
+
+/**
+ * Read all data-blocks still in the file into memory, so that the file can be closed.
+ */
+static void lazy_data_file_detach(LazyDataFile *file)
+{
+  FileData *fd = file->fd;
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  LISTBASE_FOREACH_MUTABLE (BHeadN *, new_bhead, &fd->bhead_list) {
+    if (new_bhead->has_data) {
+      continue;
+    }
+    BHead *bhead_full = blo_bhead_read_full(fd, &new_bhead->bhead);
+    if (bhead_full == NULL) {
+      CLOG_ERROR(&LOG, "Failed to read data from '%s'", fd->relabase);
+      continue;
+    }
+    BLI_insertlinkreplace(&fd->bhead_list, new_bhead, BHEADN_FROM_BHEAD(bhead_full));
+    MEM_freeN(new_bhead);
+  }
+  /* Points to the replaced #BHead, re-created when needed. */
+  MEM_SAFE_FREE(fd->bheadmap);
+  fd->tot_bheadmap = 0;
+#endif
+  fd->file->close(fd->file);
+  fd->file = NULL;
+  file->is_detached = true;
+}
+
+bool BLO_read_data_defer(BlendDataReader *reader, ID *id, BlendReadLazyDataFn read_fn)
+{
+  FileData *fd = reader->fd;
+  if ((fd->flags & FD_FLAGS_LAZY_DATA) == 0 || fd->lazy_data_id_bhead == NULL) {
+    return false;
+  }
+  /* Linked and override data is handled by the library reading code. */
+  if (ID_IS_LINKED(id) || ID_IS_OVERRIDE_LIBRARY(id)) {
+    return false;
+  }
+  if (id->session_uuid == MAIN_ID_SESSION_UUID_UNSET) {
+    return false;
+  }
+
+  if (fd->lazy_data_ids == NULL) {
+    fd->lazy_data_ids = BLI_ghash_int_new(__func__);
+  }
+  LazyDataID *lazy_id = MEM_callocN(sizeof(*lazy_id), __func__);
+  lazy_id->bhead = fd->lazy_data_id_bhead;
+  lazy_id->read_fn = read_fn;
+  BLI_ghash_insert(fd->lazy_data_ids, POINTER_FROM_UINT(id->session_uuid), lazy_id);
+
+  id->tag |= LIB_TAG_LAZY_DATA;
+  fd->reports->count.lazy_data_ids++;
+  return true;
+}
+
+bool blo_lazy_data_register(FileData *fd)
+{
+  BLI_mutex_lock(&lazy_data_mutex);
+
+  /* Only used for the main file, the data of the previous one is not needed anymore. */
+  lazy_data_clear_ex();
+
+  if (fd->lazy_data_ids == NULL) {
+    BLI_mutex_unlock(&lazy_data_mutex);
+    return false;
+  }
+
+  LazyDataFile *file = MEM_callocN(sizeof(*file), __func__);
+  file->fd = fd;
+
+  lazy_data_ids = BLI_ghash_int_new(__func__);
+  GHashIterator gh_iter;
+  GHASH_ITER (gh_iter, fd->lazy_data_ids) {
+    LazyDataID *lazy_id = BLI_ghashIterator_getValue(&gh_iter);
+    lazy_id->file = file;
+    file->users++;
+    BLI_ghash_insert(lazy_data_ids, BLI_ghashIterator_getKey(&gh_iter), lazy_id);
+  }
+  BLI_ghash_free(fd->lazy_data_ids, NULL, NULL);
+  fd->lazy_data_ids = NULL;
+
+  /* Those only remain valid while reading the file. */
+  fd->reports = NULL;
+  fd->mainlist = NULL;
+
+  BLI_mutex_unlock(&lazy_data_mutex);
+  return true;
+}
+
+void BLO_lazy_data_ensure(ID *id)
+{
+  /* The tag is cleared under the lock by the thread reading the data. */
+  if ((atomic_load_int32(&id->tag) & LIB_TAG_LAZY_DATA) == 0) {
+    return;
+  }
+
+  BLI_mutex_lock(&lazy_data_mutex);
+  /* Another thread may have read the data in the meantime. */
+  if (id->tag & LIB_TAG_LAZY_DATA) {
+    void *key = POINTER_FROM_UINT(id->session_uuid);
+    LazyDataID *lazy_id = (lazy_data_ids != NULL) ? BLI_ghash_popkey(lazy_data_ids, key, NULL) :
+                                                    NULL;
+    if (lazy_id != NULL) {
+      /* Undo steps from before this may still need the data. */
+      if (lazy_data_ids_read == NULL) {
+        lazy_data_ids_read = BLI_ghash_int_new(__func__);
+      }
+      BLI_ghash_insert(lazy_data_ids_read, key, lazy_id);
+    }
+    else if (lazy_data_ids_read != NULL) {
+      lazy_id = BLI_ghash_lookup(lazy_data_ids_read, key);
+    }
+
+    if (lazy_id != NULL) {
+      lazy_data_read(lazy_id, id);
+    }
+    else {
+      CLOG_WARN(&LOG, "No data found to read for %s", id->name);
+    }
+    atomic_fetch_and_and_int32(&id->tag, ~LIB_TAG_LAZY_DATA);
+  }
+  BLI_mutex_unlock(&lazy_data_mutex);
+}
+
+void BLO_lazy_data_ensure_all(Main *bmain)
+{
+  ID *id;
+  FOREACH_MAIN_ID_BEGIN (bmain, id) {
+    BLO_lazy_data_ensure(id);
+  }
+  FOREACH_MAIN_ID_END;
+}
+
+void BLO_lazy_data_file_detach(const char *filepath)
+{
+  BLI_mutex_lock(&lazy_data_mutex);
+  GHash *ids_all[2] = {lazy_data_ids, lazy_data_ids_read};
+  for (int i = 0; i < ARRAY_SIZE(ids_all); i++) {
+    if (ids_all[i] == NULL) {
+      continue;
+    }
+    GHASH_FOREACH_BEGIN (LazyDataID *, lazy_id, ids_all[i]) {
+      LazyDataFile *file = lazy_id->file;
+      if (!file->is_detached && BLI_path_cmp(file->fd->relabase, filepath) == 0) {
+        lazy_data_file_detach(file);
+      }
+    }
+    GHASH_FOREACH_END();
+  }
+  BLI_mutex_unlock(&lazy_data_mutex);
+}
+
+bool BLO_lazy_data_is_pending(void)
+{
+  BLI_mutex_lock(&lazy_data_mutex);
+  const bool is_pending = (lazy_data_ids != NULL) && (BLI_ghash_len(lazy_data_ids) != 0);
+  BLI_mutex_unlock(&lazy_data_mutex);
+  return is_pending;
+}
+
+void BLO_lazy_data_clear(void)
+{
+  BLI_mutex_lock(&lazy_data_mutex);
+  lazy_data_clear_ex();
+  BLI_mutex_unlock(&lazy_data_mutex);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Read File (Internal)
  * \{ */
@@ -3856,6 +4322,8 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     }
   }
 
+  fd->reports->duration.read_data = PIL_check_seconds_timer();
+
   while (bhead) {
     switch (bhead->code) {
       case DATA:
@@ -3866,6 +4334,9 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
         break;
       case GLOB:
         bhead = read_global(bfd, fd, bhead);
+        if ((fd->skip_flags & BLO_READ_LAZY_DATA) && lazy_data_is_supported(fd, bfd->main)) {
+          fd->flags |= FD_FLAGS_LAZY_DATA;
+        }
         break;
       case USER:
         if (fd->skip_flags & BLO_READ_SKIP_USERDEF) {
@@ -3907,6 +4378,20 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     }
   }
 
+  fd->reports->duration.read_data = PIL_check_seconds_timer() - fd->reports->duration.read_data;
+
+  /* Data that could not be read (e.g. IO errors of memory-mapped files) is missing, don't use
+   * the result. */
+  if ((fd->flags & (FD_FLAGS_FILE_OK | FD_FLAGS_IS_MEMFILE)) == 0) {
+    BLO_reportf_wrap(fd->reports, RPT_ERROR, "Failed to read data of blend file '%s'", filepath);
+    if (!BLI_listbase_is_empty(&mainlist)) {
+      blo_join_main(&mainlist);
+    }
+    fd->mainlist = NULL;
+    BLO_blendfiledata_free(bfd);
+    return NULL;
+  }
+
   /* do before read_libraries, but skip undo case */
   if ((fd->flags & FD_FLAGS_IS_MEMFILE) == 0) {
     if ((fd->skip_flags & BLO_READ_SKIP_DATA) == 0) {
@@ -3924,8 +4409,10 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
 
     blo_join_main(&mainlist);
 
+    const double lib_link_start_time = PIL_check_seconds_timer();
     lib_link_all(fd, bfd->main);
     after_liblink_merged_bmain_process(bfd->main);
+    fd->reports->duration.lib_link = PIL_check_seconds_timer() - lib_link_start_time;
 
     fd->reports->duration.libraries = PIL_check_seconds_timer() - fd->reports->duration.libraries;
 
@@ -3940,6 +4427,7 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
        * So not worth it. */
       BKE_main_id_refcount_recompute(bfd->main, false);
 
+      const double versioning_start_time = PIL_check_seconds_timer();
       /* Yep, second splitting... but this is a very cheap operation, so no big deal. */
       blo_split_main(&mainlist, bfd->main);
       LISTBASE_FOREACH (Main *, mainvar, &mainlist) {
@@ -3947,6 +4435,8 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
         do_versions_after_linking(mainvar, fd->reports->reports);
       }
       blo_join_main(&mainlist);
+      fd->reports->duration.versioning_after_linking = PIL_check_seconds_timer() -
+                                                       versioning_start_time;
 
       /* And we have to compute those user-reference-counts again, as `do_versions_after_linking()`
        * does not always properly handle user counts, and/or that function does not take into
@@ -37,6 +37,8 @@ enum eFileDataFlag {
   FD_FLAGS_IS_MEMFILE = 1 << 4,
   /* XXX Unused in practice (checked once but never set). */
   FD_FLAGS_NOT_MY_LIBMAP = 1 << 5,
+  /** Reading of some ID data may be deferred, see #BLO_READ_LAZY_DATA. */
+  FD_FLAGS_LAZY_DATA = 1 << 6,
 };
 
 /* Disallow since it's 32bit on ms-windows. */
@@ -103,11 +105,81 @@ typedef struct FileData {
   ListBase *old_mainlist;
   struct IDNameLib_Map *old_idmap;
 
+  /**
+   * The index of the data-blocks stored at the end of the file, NULL when the file has none.
+   * The entries own the memory of the whole index, see #BlendFileIndexFooter.
+   */
+  struct BlendFileIndexEntry *index_entries;
+  struct BlendFileIndexLibrary *index_libraries;
+  struct BlendFileIndexFooter *index_footer;
+
+  /** The #BHead of the ID being read, when using #FD_FLAGS_LAZY_DATA. */
+  struct BHead *lazy_data_id_bhead;
+  /** Maps session UUIDs to #LazyDataID, for IDs which data reading has been deferred. */
+  struct GHash *lazy_data_ids;
+
   struct BlendFileReadReport *reports;
 } FileData;
 
 #define SIZEOFBLENDERHEADER 12
 
+/* -------------------------------------------------------------------- */
+/** \name File Index
+ *
+ * An index of the local data-blocks of a file, allowing to list them and to find their previews
+ * without reading the whole file. It is written as a #DATA block between #DNA1 and #ENDB, which
+ * file reading skips, so files stay readable by versions not knowing about it.
+ *
+ * The block contains the array of #BlendFileIndexEntry, then the array of
+ * #BlendFileIndexLibrary and ends with the #BlendFileIndexFooter, so it can be found by reading
+ * the end of the file. All offsets are from the start of the (uncompressed) file.
+ *
+ * The index is only used for files with the same endianness and pointer size, other files
+ * are scanned block by block as before.
+ * \{ */
+
+#define BLEND_FILE_INDEX_MAGIC "BLENDIDX"
+#define BLEND_FILE_INDEX_VERSION 1
+
+typedef struct BlendFileIndexEntry {
+  /** #ID.name, including the ID code. */
+  char name[66];
+  /** #eBlendFileIndexEntryFlag. */
+  short flag;
+  /** #BHead.code of the ID (not always the ID code, e.g. #ID_SCRN for screens). */
+  int code;
+  /** Offset of the #BHead of the ID. */
+  uint64_t offset;
+  /** Offset of the #BHead of the ID #PreviewImage, zero when it has none. */
+  uint64_t preview_offset;
+} BlendFileIndexEntry;
+
+typedef enum eBlendFileIndexEntryFlag {
+  BLEND_FILE_INDEX_ENTRY_IS_ASSET = 1 << 0,
+} eBlendFileIndexEntryFlag;
+
+/** A library the file links data-blocks from. */
+typedef struct BlendFileIndexLibrary {
+  /** #Library.filepath, as stored in the file (may be relative). */
+  char filepath[1024];
+} BlendFileIndexLibrary;
+
+typedef struct BlendFileIndexFooter {
+  /** Offset of the #DNA1 #BHead, so it can be read without scanning the file. */
+  uint64_t dna_offset;
+  int32_t file_subversion;
+  int32_t version;
+  int32_t entries_num;
+  int32_t libraries_num;
+  char magic[8];
+} BlendFileIndexFooter;
+
+#define BLEND_FILE_INDEX_SIZE(entries_num, libraries_num) \
+  ((size_t)(entries_num) * sizeof(BlendFileIndexEntry) + \
+   (size_t)(libraries_num) * sizeof(BlendFileIndexLibrary) + sizeof(BlendFileIndexFooter))
+
+/** \} */
+
 /***/
 struct Main;
 void blo_join_main(ListBase *mainlist);
@@ -151,10 +223,23 @@ void blo_cache_storage_old_bmain_clear(FileData *fd, struct Main *bmain_old);
 void blo_cache_storage_end(FileData *fd);
 
 void blo_filedata_free(FileData *fd);
+/**
+ * Keep the file data around for lazy loading if reading of some IDs data has been deferred.
+ * \return true when the file data is now owned by the lazy loading system.
+ */
+bool blo_lazy_data_register(FileData *fd);
 
 BHead *blo_bhead_first(FileData *fd);
 BHead *blo_bhead_next(FileData *fd, BHead *thisblock);
 BHead *blo_bhead_prev(FileData *fd, BHead *thisblock);
+/**
+ * Read the block at the given file offset, without adding it to the list of blocks read so far
+ * (so the data following it can't be accessed with #blo_bhead_next).
+ * Only supported for files using the #FileData.index_entries.
+ * Free with #blo_bhead_free_detached.
+ */
+BHead *blo_bhead_read_detached(FileData *fd, uint64_t offset);
+void blo_bhead_free_detached(BHead *bhead);
 
 /**
  * Warning! Caller's responsibility to ensure given bhead **is** an ID one!
@@ -1174,6 +1174,25 @@ static void do_version_fcurve_hide_viewport_fix(struct ID *UNUSED(id),
   fcu->rna_path = BLI_strdupn("hide_viewport", 13);
 }
 
+static void do_version_mesh_tessfaces_to_polys(ID *id, void *user_data)
+{
+  Mesh *me = (Mesh *)id;
+  const Main *bmain = user_data;
+
+  /* Check if we need to convert mfaces to mpolys. */
+  if (me->totface && !me->totpoly) {
+    BKE_mesh_do_versions_convert_mfaces_to_mpolys(me);
+  }
+
+  /* Deprecated, only kept for conversion. */
+  BKE_mesh_tessface_clear(me);
+
+  /* Moved from do_versions because we need updated polygons for calculating normals. */
+  if (!MAIN_VERSION_ATLEAST(bmain, 256, 6)) {
+    BKE_mesh_calc_normals(me);
+  }
+}
+
 void do_versions_after_linking_280(Main *bmain, ReportList *UNUSED(reports))
 {
   bool use_collection_compat_28 = true;
@@ -1611,28 +1630,13 @@ void do_versions_after_linking_280(Main *bmain, ReportList *UNUSED(reports))
 
     /* This versioning could probably be done only on earlier versions, not sure however
      * which exact version fully deprecated tessfaces, so think we can keep that one here, no
-     * harm to be expected anyway for being over-conservative. */
-    for (Mesh *me = bmain->meshes.first; me != NULL; me = me->id.next) {
-      /* Check if we need to convert mfaces to mpolys. */
-      if (me->totface && !me->totpoly) {
-        /* temporarily switch main so that reading from
-         * external CustomData works */
-        Main *gmain = G_MAIN;
-        G_MAIN = bmain;
-
-        BKE_mesh_do_versions_convert_mfaces_to_mpolys(me);
-
-        G_MAIN = gmain;
-      }
-
-      /* Deprecated, only kept for conversion. */
-      BKE_mesh_tessface_clear(me);
-
-      /* Moved from do_versions because we need updated polygons for calculating normals. */
-      if (!MAIN_VERSION_ATLEAST(bmain, 256, 6)) {
-        BKE_mesh_calc_normals(me);
-      }
-    }
+     * harm to be expected anyway for being over-conservative.
+     * Temporarily switch main so that reading from external CustomData works, this is done
+     * around the whole loop since the meshes are converted in parallel. */
+    Main *gmain = G_MAIN;
+    G_MAIN = bmain;
+    version_foreach_id_local_parallel(&bmain->meshes, do_version_mesh_tessfaces_to_polys, bmain);
+    G_MAIN = gmain;
   }
 
   if (!MAIN_VERSION_ATLEAST(bmain, 282, 2)) {
@@ -1775,6 +1779,22 @@ static bool seq_update_flags_cb(Sequence *seq, void *UNUSED(user_data))
   return true;
 }
 
+static void do_version_mesh_mtexpoly_remove(ID *id, void *UNUSED(user_data))
+{
+  Mesh *me = (Mesh *)id;
+  /* If we have UV's, so this file will have MTexPoly layers too! */
+  if (me->mloopuv != NULL) {
+    CustomData_update_typemap(&me->pdata);
+    CustomData_free_layers(&me->pdata, CD_MTEXPOLY, me->totpoly);
+    BKE_mesh_update_customdata_pointers(me, false);
+  }
+}
+
+static void do_version_mesh_calc_edges_loose(ID *id, void *UNUSED(user_data))
+{
+  BKE_mesh_calc_edges_loose((Mesh *)id);
+}
+
 /* NOLINTNEXTLINE: readability-function-size */
 void blo_do_versions_280(FileData *fd, Library *UNUSED(lib), Main *bmain)
 {
@@ -1803,14 +1823,7 @@ void blo_do_versions_280(FileData *fd, Library *UNUSED(lib), Main *bmain)
 
     /* MTexPoly now removed. */
     if (DNA_struct_find(fd->filesdna, "MTexPoly")) {
-      for (Mesh *me = bmain->meshes.first; me; me = me->id.next) {
-        /* If we have UV's, so this file will have MTexPoly layers too! */
-        if (me->mloopuv != NULL) {
-          CustomData_update_typemap(&me->pdata);
-          CustomData_free_layers(&me->pdata, CD_MTEXPOLY, me->totpoly);
-          BKE_mesh_update_customdata_pointers(me, false);
-        }
-      }
+      version_foreach_id_local_parallel(&bmain->meshes, do_version_mesh_mtexpoly_remove, NULL);
     }
   }
 
@@ -2978,9 +2991,7 @@ void blo_do_versions_280(FileData *fd, Library *UNUSED(lib), Main *bmain)
   }
 
   if (!MAIN_VERSION_ATLEAST(bmain, 280, 28)) {
-    for (Mesh *mesh = bmain->meshes.first; mesh; mesh = mesh->id.next) {
-      BKE_mesh_calc_edges_loose(mesh);
-    }
+    version_foreach_id_local_parallel(&bmain->meshes, do_version_mesh_calc_edges_loose, NULL);
   }
 
   if (!MAIN_VERSION_ATLEAST(bmain, 280, 29)) {
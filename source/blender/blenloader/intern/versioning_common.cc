@@ -14,6 +14,8 @@
 #include "BLI_listbase.h"
 #include "BLI_string.h"
 #include "BLI_string_ref.hh"
+#include "BLI_task.hh"
+#include "BLI_vector.hh"
 
 #include "BKE_animsys.h"
 #include "BKE_lib_id.h"
@@ -24,7 +26,9 @@
 
 #include "versioning_common.h"
 
+using blender::IndexRange;
 using blender::StringRef;
+using blender::Vector;
 
 ARegion *do_versions_add_region_if_not_found(ListBase *regionbase,
                                              int region_type,
@@ -225,3 +229,19 @@ void version_socket_update_is_used(bNodeTree *ntree)
     link->tosock->flag |= SOCK_IN_USE;
   }
 }
+
+void version_foreach_id_local_parallel(ListBase *lb,
+                                       void (*fn)(ID *id, void *user_data),
+                                       void *user_data)
+{
+  Vector<ID *> ids;
+  LISTBASE_FOREACH (ID *, id, lb) {
+    ids.append(id);
+  }
+  /* The amount of work per ID varies a lot (e.g. mesh sizes), so don't group them. */
+  blender::threading::parallel_for(ids.index_range(), 1, [&](const IndexRange range) {
+    for (const int i : range) {
+      fn(ids[i], user_data);
+    }
+  });
+}
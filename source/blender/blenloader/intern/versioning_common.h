@@ -7,6 +7,7 @@
 #pragma once
 
 struct ARegion;
+struct ID;
 struct ListBase;
 struct Main;
 struct bNodeTree;
@@ -89,6 +90,16 @@ struct bNodeSocket *version_node_add_socket_if_not_exist(struct bNodeTree *ntree
  */
 void version_socket_update_is_used(bNodeTree *ntree);
 
+/**
+ * Run \a fn on all IDs of the list in parallel, for versioning which is local to each ID: it may
+ * only change data owned by the ID, and must not modify other IDs, #Main or global state.
+ * Global state set up by the caller for the whole loop may be read (e.g. #G_MAIN, used to find
+ * external CustomData files). Passes working across IDs must stay serial.
+ */
+void version_foreach_id_local_parallel(struct ListBase *lb,
+                                       void (*fn)(struct ID *id, void *user_data),
+                                       void *user_data);
+
 #ifdef __cplusplus
 }
 #endif
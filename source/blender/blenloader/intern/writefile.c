@@ -53,6 +53,7 @@
  * - write #TEST (#RenderInfo struct. 128x128 blend file preview is optional).
  * - write #GLOB (#FileGlobal struct) (some global vars).
  * - write #DNA1 (#SDNA struct)
+ * - write the index of data-blocks as #DATA (not for undo), see #BlendFileIndexFooter.
  * - write #USER (#UserDef struct) if filename is `~/.config/blender/X.XX/config/startup.blend`.
  */
 
@@ -88,7 +89,9 @@
 #include "BLI_link_utils.h"
 #include "BLI_linklist.h"
 #include "BLI_math_base.h"
+#include "BLI_memiter.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "MEM_guardedalloc.h" /* MEM_freeN */
 
@@ -410,6 +413,12 @@ typedef struct {
   size_t write_len;
 #endif
 
+  /**
+   * Number of bytes written so far, the offset of the next block in the file
+   * (or in #WriteData.record).
+   */
+  size_t write_offset;
+
   /** Set on unlikely case of an error (ignores further file writing). */
   bool error;
 
@@ -418,6 +427,24 @@ typedef struct {
   /** When true, write to #WriteData.current, could also call 'is_undo'. */
   bool use_memfile;
 
+  /**
+   * When set, #mywrite stores every call here instead of writing it,
+   * so an ID can be serialized from a worker thread and replayed later on,
+   * see #write_id_batch_flush.
+   */
+  BLI_memiter *record;
+
+  /** #BHead.code of the ID being written, zero until its struct is written. */
+  int id_filecode;
+  /**
+   * Offset of the preview of the ID being written, zero when it has none.
+   * Used for #BlendFileIndexEntry.preview_offset.
+   */
+  size_t id_preview_offset;
+  /** Items for the file index (NULL for undo), see #write_file_index. */
+  BLI_memiter *index_entries;
+  BLI_memiter *index_libraries;
+
   /**
    * Wrap writing, so we can use zstd or
    * other compression types later, see: G_FILE_COMPRESS
@@ -521,6 +548,18 @@ static void mywrite(WriteData *wd, const void *adr, size_t len)
     return;
   }
 
+  wd->write_offset += len;
+
+  if (wd->record != NULL) {
+    if (UNLIKELY(len > UINT_MAX)) {
+      /* Can't be recorded, merged into the main #WriteData by #write_id_batch_flush. */
+      wd->error = true;
+      return;
+    }
+    BLI_memiter_alloc_from(wd->record, (uint)len, adr);
+    return;
+  }
+
 #ifdef USE_WRITE_DATA_LEN
   wd->write_len += len;
 #endif
@@ -574,6 +613,10 @@ static WriteData *mywrite_begin(WriteWrap *ww, MemFile *compare, MemFile *curren
     BLO_memfile_write_init(&wd->mem, current, compare);
     wd->use_memfile = true;
   }
+  else {
+    wd->index_entries = BLI_memiter_create(sizeof(BlendFileIndexEntry) * 64);
+    wd->index_libraries = BLI_memiter_create(sizeof(BlendFileIndexLibrary));
+  }
 
   return wd;
 }
@@ -594,6 +637,10 @@ static bool mywrite_end(WriteData *wd)
   if (wd->use_memfile) {
     BLO_memfile_write_finalize(&wd->mem);
   }
+  else {
+    BLI_memiter_destroy(wd->index_entries);
+    BLI_memiter_destroy(wd->index_libraries);
+  }
 
   const bool err = wd->error;
   writedata_free(wd);
@@ -608,6 +655,9 @@ static bool mywrite_end(WriteData *wd)
  */
 static void mywrite_id_begin(WriteData *wd, ID *id)
 {
+  wd->id_filecode = 0;
+  wd->id_preview_offset = 0;
+
   if (wd->use_memfile) {
     wd->mem.current_id_session_uuid = id->session_uuid;
 
@@ -674,6 +724,13 @@ static void writestruct_at_address_nr(
     return;
   }
 
+  if (wd->id_filecode == 0) {
+    wd->id_filecode = filecode;
+  }
+  else if (struct_nr == SDNA_TYPE_FROM_STRUCT(PreviewImage) && wd->id_preview_offset == 0) {
+    wd->id_preview_offset = wd->write_offset;
+  }
+
   mywrite(wd, &bh, sizeof(BHead));
   mywrite(wd, data, (size_t)bh.len);
 }
@@ -754,6 +811,83 @@ static void writelist_id(WriteData *wd, int filecode, const char *structname, co
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name File Index
+ *
+ * See #BlendFileIndexFooter.
+ * \{ */
+
+/**
+ * Add the ID which data has just been written, starting at `id_offset`.
+ */
+static void write_file_index_add_id(WriteData *wd, const ID *id, const size_t id_offset)
+{
+  if (wd->index_entries == NULL || wd->id_filecode == 0) {
+    return;
+  }
+
+  BlendFileIndexEntry *entry = BLI_memiter_calloc(wd->index_entries, sizeof(*entry));
+  STRNCPY(entry->name, id->name);
+  entry->code = wd->id_filecode;
+  entry->flag = (id->asset_data != NULL) ? BLEND_FILE_INDEX_ENTRY_IS_ASSET : 0;
+  entry->offset = (uint64_t)id_offset;
+  entry->preview_offset = (uint64_t)wd->id_preview_offset;
+}
+
+static void write_file_index_add_library(WriteData *wd, const Library *library)
+{
+  if (wd->index_libraries == NULL) {
+    return;
+  }
+
+  BlendFileIndexLibrary *index_library = BLI_memiter_calloc(wd->index_libraries,
+                                                            sizeof(*index_library));
+  STRNCPY(index_library->filepath, library->filepath);
+}
+
+/**
+ * Write the index as a single #DATA block, must be followed by #ENDB.
+ */
+static void write_file_index(WriteData *wd, const size_t dna_offset)
+{
+  const int entries_num = (int)BLI_memiter_count(wd->index_entries);
+  const int libraries_num = (int)BLI_memiter_count(wd->index_libraries);
+  const size_t index_size = BLEND_FILE_INDEX_SIZE(entries_num, libraries_num);
+  if (index_size > INT_MAX) {
+    return;
+  }
+
+  char *index = MEM_mallocN(index_size, __func__);
+  char *index_iter = index;
+
+  BLI_memiter_handle iter;
+  const void *item;
+  BLI_memiter_iter_init(wd->index_entries, &iter);
+  while ((item = BLI_memiter_iter_step(&iter))) {
+    memcpy(index_iter, item, sizeof(BlendFileIndexEntry));
+    index_iter += sizeof(BlendFileIndexEntry);
+  }
+  BLI_memiter_iter_init(wd->index_libraries, &iter);
+  while ((item = BLI_memiter_iter_step(&iter))) {
+    memcpy(index_iter, item, sizeof(BlendFileIndexLibrary));
+    index_iter += sizeof(BlendFileIndexLibrary);
+  }
+
+  BlendFileIndexFooter *footer = (BlendFileIndexFooter *)index_iter;
+  memset(footer, 0, sizeof(*footer));
+  footer->dna_offset = (uint64_t)dna_offset;
+  footer->file_subversion = BLENDER_FILE_SUBVERSION;
+  footer->version = BLEND_FILE_INDEX_VERSION;
+  footer->entries_num = entries_num;
+  footer->libraries_num = libraries_num;
+  memcpy(footer->magic, BLEND_FILE_INDEX_MAGIC, sizeof(footer->magic));
+
+  writedata(wd, DATA, index_size, index);
+  MEM_freeN(index);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Typed DNA File Writing
  *
@@ -966,6 +1100,7 @@ static void write_libraries(WriteData *wd, Main *main)
       BlendWriter writer = {wd};
       writestruct(wd, ID_LI, Library, 1, main->curlib);
       BKE_id_blend_write(&writer, &main->curlib->id);
+      write_file_index_add_library(wd, main->curlib);
 
       if (main->curlib->packedfile) {
         BKE_packedfile_blend_write(&writer, main->curlib->packedfile);
@@ -1066,6 +1201,148 @@ static void write_thumb(WriteData *wd, const BlendThumbnail *thumb)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name ID Writing
+ *
+ * Running the #IDTypeInfo.blend_write callbacks is usually the most expensive part of writing,
+ * so batches of IDs are serialized on worker threads, each into its own recording #WriteData.
+ * The recorded writes are then replayed in the original order from the calling thread,
+ * so the resulting file (or #MemFile) is identical to one written from a single thread.
+ * \{ */
+
+/** Number of IDs serialized in parallel before their data is written out. */
+#define ID_BATCH_SIZE 64
+
+static bool write_use_threads = true;
+
+typedef struct WriteIDBatch {
+  ID *ids[ID_BATCH_SIZE];
+  BLI_memiter *records[ID_BATCH_SIZE];
+  /** #WriteData.id_filecode & #WriteData.id_preview_offset (relative to the ID). */
+  int filecodes[ID_BATCH_SIZE];
+  size_t preview_offsets[ID_BATCH_SIZE];
+  /** #WriteData.error of the worker, any error makes the whole write fail. */
+  bool errors[ID_BATCH_SIZE];
+  int len;
+  /** So #BLO_write_is_undo gives the same result on worker threads. */
+  bool use_memfile;
+} WriteIDBatch;
+
+/**
+ * Write a single ID and its direct data, using `id_buffer` to store a cleaned-up copy of the ID.
+ */
+static void write_id(BlendWriter *writer, ID *id, void *id_buffer, size_t idtype_struct_size)
+{
+  memcpy(id_buffer, id, idtype_struct_size);
+
+  /* Clear runtime data to reduce false detection of changed data in undo/redo context.
+   * Undo steps keep track of data that has not been read from the file yet. */
+  ((ID *)id_buffer)->tag = BLO_write_is_undo(writer) ? (id->tag & LIB_TAG_LAZY_DATA) : 0;
+  ((ID *)id_buffer)->us = 0;
+  ((ID *)id_buffer)->icon_id = 0;
+  /* Those listbase data change every time we add/remove an ID, and also often when
+   * renaming one (due to re-sorting). This avoids generating a lot of false 'is changed'
+   * detections between undo steps. */
+  ((ID *)id_buffer)->prev = NULL;
+  ((ID *)id_buffer)->next = NULL;
+  /* Those runtime pointers should never be set during writing stage, but just in case clear
+   * them too. */
+  ((ID *)id_buffer)->orig_id = NULL;
+  ((ID *)id_buffer)->newid = NULL;
+  /* Even though in theory we could be able to preserve this python instance across undo even
+   * when we need to re-read the ID into its original address, this is currently cleared in
+   * #direct_link_id_common in `readfile.c` anyway, */
+  ((ID *)id_buffer)->py_instance = NULL;
+
+  const IDTypeInfo *id_type = BKE_idtype_get_info_from_id(id);
+  if (id_type->blend_write != NULL) {
+    id_type->blend_write(writer, (ID *)id_buffer, id);
+  }
+}
+
+/**
+ * Whether the ID can be serialized from a worker thread.
+ */
+static bool write_id_use_threads(const ID *id)
+{
+  /* UI data-blocks are few and small, their writing code may also access window-manager data
+   * which is not meant to be accessed from other threads. */
+  return !ELEM(GS(id->name), ID_WM, ID_SCR, ID_WS);
+}
+
+static void write_id_batch_task(void *__restrict userdata,
+                                const int index,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  WriteIDBatch *batch = userdata;
+  ID *id = batch->ids[index];
+
+  WriteData *wd = MEM_callocN(sizeof(*wd), __func__);
+  wd->sdna = DNA_sdna_current_get();
+  wd->use_memfile = batch->use_memfile;
+  wd->record = BLI_memiter_create(MEM_CHUNK_SIZE);
+  BlendWriter writer = {wd};
+
+  const size_t idtype_struct_size = BKE_idtype_get_info_from_id(id)->struct_size;
+  void *id_buffer = MEM_mallocN(idtype_struct_size, __func__);
+  write_id(&writer, id, id_buffer, idtype_struct_size);
+  MEM_freeN(id_buffer);
+
+  batch->records[index] = wd->record;
+  batch->filecodes[index] = wd->id_filecode;
+  batch->preview_offsets[index] = wd->id_preview_offset;
+  batch->errors[index] = wd->error;
+  MEM_freeN(wd);
+}
+
+/**
+ * Serialize all IDs of the batch in parallel, then write their data in order.
+ */
+static void write_id_batch_flush(WriteData *wd, WriteIDBatch *batch)
+{
+  if (batch->len == 0) {
+    return;
+  }
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, batch->len, batch, write_id_batch_task, &settings);
+
+  for (int i = 0; i < batch->len; i++) {
+    if (batch->errors[i]) {
+      /* The recorded data of this ID is incomplete, don't report the file as written. */
+      wd->error = true;
+    }
+  }
+
+  for (int i = 0; i < batch->len; i++) {
+    ID *id = batch->ids[i];
+    mywrite_id_begin(wd, id);
+    const size_t id_offset = wd->write_offset;
+
+    BLI_memiter_handle iter;
+    BLI_memiter_iter_init(batch->records[i], &iter);
+    const void *data;
+    uint data_len;
+    while ((data = BLI_memiter_iter_step_size(&iter, &data_len))) {
+      mywrite(wd, data, data_len);
+    }
+    BLI_memiter_destroy(batch->records[i]);
+
+    wd->id_filecode = batch->filecodes[i];
+    if (batch->preview_offsets[i] != 0) {
+      wd->id_preview_offset = id_offset + batch->preview_offsets[i];
+    }
+    write_file_index_add_id(wd, id, id_offset);
+
+    mywrite_id_end(wd, id);
+  }
+  batch->len = 0;
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name File Writing (Private)
  * \{ */
@@ -1109,6 +1386,11 @@ static bool write_file_handle(Main *mainvar,
                                                  NULL :
                                                  BKE_lib_override_library_operations_store_init();
 
+  const bool use_threads = write_use_threads;
+  WriteIDBatch id_batch;
+  id_batch.len = 0;
+  id_batch.use_memfile = wd->use_memfile;
+
 #define ID_BUFFER_STATIC_SIZE 8192
   /* This outer loop allows to save first data-blocks from real mainvar,
    * then the temp ones from override process,
@@ -1146,6 +1428,14 @@ static bool write_file_handle(Main *mainvar,
           continue;
         }
 
+        if (!wd->use_memfile) {
+          /* Undo steps only keep track of the data still in the original file. */
+          BLO_lazy_data_ensure(id);
+        }
+        else if (id->tag & LIB_TAG_LAZY_DATA) {
+          wd->mem.written_memfile->has_lazy_data = true;
+        }
+
         const bool do_override = !ELEM(override_storage, NULL, bmain) &&
                                  ID_IS_OVERRIDE_LIBRARY_REAL(id);
 
@@ -1175,32 +1465,22 @@ static bool write_file_handle(Main *mainvar,
           }
         }
 
+        if (use_threads && !do_override && write_id_use_threads(id)) {
+          id_batch.ids[id_batch.len++] = id;
+          if (id_batch.len == ARRAY_SIZE(id_batch.ids)) {
+            write_id_batch_flush(wd, &id_batch);
+          }
+          continue;
+        }
+
+        /* Keep the original order of IDs. */
+        write_id_batch_flush(wd, &id_batch);
+
         mywrite_id_begin(wd, id);
+        const size_t id_offset = wd->write_offset;
 
-        memcpy(id_buffer, id, idtype_struct_size);
-
-        /* Clear runtime data to reduce false detection of changed data in undo/redo context. */
-        ((ID *)id_buffer)->tag = 0;
-        ((ID *)id_buffer)->us = 0;
-        ((ID *)id_buffer)->icon_id = 0;
-        /* Those listbase data change every time we add/remove an ID, and also often when
-         * renaming one (due to re-sorting). This avoids generating a lot of false 'is changed'
-         * detections between undo steps. */
-        ((ID *)id_buffer)->prev = NULL;
-        ((ID *)id_buffer)->next = NULL;
-        /* Those runtime pointers should never be set during writing stage, but just in case clear
-         * them too. */
-        ((ID *)id_buffer)->orig_id = NULL;
-        ((ID *)id_buffer)->newid = NULL;
-        /* Even though in theory we could be able to preserve this python instance across undo even
-         * when we need to re-read the ID into its original address, this is currently cleared in
-         * #direct_link_id_common in `readfile.c` anyway, */
-        ((ID *)id_buffer)->py_instance = NULL;
-
-        const IDTypeInfo *id_type = BKE_idtype_get_info_from_id(id);
-        if (id_type->blend_write != NULL) {
-          id_type->blend_write(&writer, (ID *)id_buffer, id);
-        }
+        write_id(&writer, id, id_buffer, idtype_struct_size);
+        write_file_index_add_id(wd, id, id_offset);
 
         if (do_override) {
           BKE_lib_override_library_operations_store_end(override_storage, id);
@@ -1209,6 +1489,8 @@ static bool write_file_handle(Main *mainvar,
         mywrite_id_end(wd, id);
       }
 
+      write_id_batch_flush(wd, &id_batch);
+
       if (id_buffer != id_buffer_static) {
         MEM_SAFE_FREE(id_buffer);
       }
@@ -1236,8 +1518,13 @@ static bool write_file_handle(Main *mainvar,
    *
    * Note that we *borrow* the pointer to 'DNAstr',
    * so writing each time uses the same address and doesn't cause unnecessary undo overhead. */
+  const size_t dna_offset = wd->write_offset;
   writedata(wd, DNA1, (size_t)wd->sdna->data_len, wd->sdna->data);
 
+  if (!wd->use_memfile) {
+    write_file_index(wd, dna_offset);
+  }
+
   /* end of file */
   memset(&bhead, 0, sizeof(BHead));
   bhead.code = ENDB;
@@ -1326,6 +1613,11 @@ bool BLO_write_file(Main *mainvar,
     BLO_main_validate_shapekeys(mainvar, reports);
   }
 
+#ifdef WIN32
+  /* Files kept open for lazy loading can't be replaced on WIN32. */
+  BLO_lazy_data_file_detach(filepath);
+#endif
+
   /* open temporary file, so we preserve the original in case we crash */
   BLI_snprintf(tempname, sizeof(tempname), "%s@", filepath);
 
@@ -1586,4 +1878,9 @@ bool BLO_write_is_undo(BlendWriter *writer)
   return writer->wd->use_memfile;
 }
 
+void BLO_write_use_threads_set(bool use_threads)
+{
+  write_use_threads = use_threads;
+}
+
 /** \} */
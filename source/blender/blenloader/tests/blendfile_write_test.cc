@@ -0,0 +1,366 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later
+ * Copyright 2022 Blender Foundation. */
+#include "blendfile_loading_base_test.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+
+#include "BLI_fileops.h"
+#include "BLI_linklist.h"
+#include "BLI_listbase.h"
+#include "BLI_path_util.h"
+#include "BLI_timeit.hh"
+#include "BLI_vector.hh"
+
+#include "BKE_appdir.h"
+#include "BKE_collection.h"
+#include "BKE_customdata.h"
+#include "BKE_icons.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DNA_ID.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLO_readfile.h"
+#include "BLO_undofile.h"
+#include "BLO_writefile.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+class BlendfileWriteTest : public BlendfileLoadingBaseTest {
+ protected:
+  void TearDown() override
+  {
+    BLO_write_use_threads_set(true);
+    BLO_read_use_file_index_set(true);
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  void memfile_write(MemFile *memfile, const bool use_threads)
+  {
+    BLO_write_use_threads_set(use_threads);
+    BLO_write_file_mem(bfile->main, nullptr, memfile, 0);
+  }
+};
+
+TEST_F(BlendfileWriteTest, ThreadedWriteMatchesSerial)
+{
+  if (!blendfile_load("modifier_stack/array_test.blend")) {
+    return;
+  }
+
+  /* Writing for undo resets the ID recalc flags, write once so they are the same for both. */
+  MemFile memfile_init = {{nullptr}};
+  memfile_write(&memfile_init, false);
+  BLO_memfile_free(&memfile_init);
+
+  MemFile memfile_serial = {{nullptr}};
+  MemFile memfile_threaded = {{nullptr}};
+  memfile_write(&memfile_serial, false);
+  memfile_write(&memfile_threaded, true);
+
+  EXPECT_EQ(memfile_serial.size, memfile_threaded.size);
+  EXPECT_EQ(BLI_listbase_count(&memfile_serial.chunks),
+            BLI_listbase_count(&memfile_threaded.chunks));
+
+  const MemFileChunk *chunk_serial = static_cast<MemFileChunk *>(memfile_serial.chunks.first);
+  const MemFileChunk *chunk_threaded = static_cast<MemFileChunk *>(memfile_threaded.chunks.first);
+  for (; chunk_serial && chunk_threaded;
+       chunk_serial = static_cast<MemFileChunk *>(chunk_serial->next),
+       chunk_threaded = static_cast<MemFileChunk *>(chunk_threaded->next)) {
+    ASSERT_EQ(chunk_serial->size, chunk_threaded->size);
+    EXPECT_EQ(chunk_serial->id_session_uuid, chunk_threaded->id_session_uuid);
+    EXPECT_EQ(memcmp(chunk_serial->buf, chunk_threaded->buf, chunk_serial->size), 0);
+  }
+
+  BLO_memfile_free(&memfile_serial);
+  BLO_memfile_free(&memfile_threaded);
+}
+
+/** Write the main database to a file and return its content. */
+static blender::Vector<char> file_write_and_read(Main *bmain,
+                                                 const char *filepath,
+                                                 const bool use_threads)
+{
+  BLO_write_use_threads_set(use_threads);
+  BlendFileWriteParams params{};
+  params.remap_mode = BLO_WRITE_PATH_REMAP_NONE;
+  EXPECT_TRUE(BLO_write_file(bmain, filepath, 0, &params, nullptr));
+
+  size_t size = 0;
+  char *data = static_cast<char *>(BLI_file_read_binary_as_mem(filepath, 0, &size));
+  blender::Vector<char> result;
+  if (data != nullptr) {
+    result.extend(blender::Span<char>(data, size));
+    MEM_freeN(data);
+  }
+  BLI_delete(filepath, false, false);
+  return result;
+}
+
+TEST_F(BlendfileWriteTest, ThreadedFileWriteMatchesSerial)
+{
+  if (!blendfile_load("modifier_stack/array_test.blend")) {
+    return;
+  }
+
+  BKE_tempdir_init("");
+  char filepath[FILE_MAX];
+  BLI_join_dirfile(
+      filepath, sizeof(filepath), BKE_tempdir_session(), "threaded_write_test.blend");
+
+  /* Add enough data-blocks for the IDs to be serialized in more than one batch. */
+  for (const int i : blender::IndexRange(200)) {
+    ID *id = static_cast<ID *>(
+        BKE_id_new(bfile->main, ID_ME, ("Mesh" + std::to_string(i)).c_str()));
+    /* Unused data-blocks aren't written to files. */
+    id_fake_user_set(id);
+  }
+
+  /* Write to the same path both times, the file path is stored in the file. */
+  const blender::Vector<char> data_serial = file_write_and_read(bfile->main, filepath, false);
+  const blender::Vector<char> data_threaded = file_write_and_read(bfile->main, filepath, true);
+
+  EXPECT_FALSE(data_serial.is_empty());
+  ASSERT_EQ(data_serial.size(), data_threaded.size());
+  EXPECT_EQ(memcmp(data_serial.data(), data_threaded.data(), data_serial.size()), 0);
+}
+
+/** Concatenate the strings of the list, sorted so the result doesn't depend on their order. */
+static std::string linklist_strings_join(LinkNode *list)
+{
+  blender::Vector<std::string> strings;
+  for (LinkNode *link = list; link; link = link->next) {
+    strings.append(static_cast<const char *>(link->link));
+  }
+  std::sort(strings.begin(), strings.end());
+  std::string result;
+  for (const std::string &str : strings) {
+    result += str + "\n";
+  }
+  BLI_linklist_freeN(list);
+  return result;
+}
+
+/** Describe the content of the file as seen through a #BlendHandle. */
+static std::string blendhandle_describe(const char *filepath)
+{
+  BlendFileReadReport reports = {nullptr};
+  BlendHandle *bh = BLO_blendhandle_from_file(filepath, &reports);
+  if (bh == nullptr) {
+    return "";
+  }
+
+  std::string result = linklist_strings_join(BLO_blendhandle_get_linkable_groups(bh));
+  int tot;
+  result += linklist_strings_join(BLO_blendhandle_get_library_paths(bh, &tot));
+  for (int i = 0; i < INDEX_ID_MAX; i++) {
+    const short idcode = BKE_idtype_idcode_from_index(i);
+    result += linklist_strings_join(BLO_blendhandle_get_datablock_names(bh, idcode, false, &tot));
+
+    LinkNode *previews = BLO_blendhandle_get_previews(bh, idcode, &tot);
+    for (LinkNode *link = previews; link; link = link->next) {
+      const PreviewImage *preview = static_cast<PreviewImage *>(link->link);
+      result += std::to_string(preview->w[ICON_SIZE_PREVIEW]) + "x" +
+                std::to_string(preview->h[ICON_SIZE_PREVIEW]) + "\n";
+    }
+    BLI_linklist_free(previews, BKE_previewimg_freefunc);
+  }
+
+  BLO_blendhandle_close(bh);
+  return result;
+}
+
+TEST_F(BlendfileWriteTest, FileIndexMatchesScan)
+{
+  if (!blendfile_load("modifier_stack/array_test.blend")) {
+    return;
+  }
+
+  BKE_tempdir_init("");
+  char filepath[FILE_MAX];
+  BLI_join_dirfile(filepath, sizeof(filepath), BKE_tempdir_session(), "file_index_test.blend");
+
+  BlendFileWriteParams params{};
+  params.remap_mode = BLO_WRITE_PATH_REMAP_NONE;
+  ASSERT_TRUE(BLO_write_file(bfile->main, filepath, 0, &params, nullptr));
+
+  BLO_read_use_file_index_set(true);
+  const std::string description_index = blendhandle_describe(filepath);
+  BLO_read_use_file_index_set(false);
+  const std::string description_scan = blendhandle_describe(filepath);
+
+  EXPECT_FALSE(description_index.empty());
+  EXPECT_EQ(description_index, description_scan);
+
+  BLI_delete(filepath, false, false);
+}
+
+/** Copy the vertex positions and loops of all meshes, by name. */
+static std::map<std::string, blender::Vector<float>> mesh_geometry_get(Main *bmain)
+{
+  std::map<std::string, blender::Vector<float>> result;
+  LISTBASE_FOREACH (const Mesh *, mesh, &bmain->meshes) {
+    blender::Vector<float> &geometry = result[mesh->id.name];
+    for (const int i : blender::IndexRange(mesh->totvert)) {
+      geometry.extend({mesh->mvert[i].co[0], mesh->mvert[i].co[1], mesh->mvert[i].co[2]});
+    }
+    for (const int i : blender::IndexRange(mesh->totloop)) {
+      geometry.extend({float(mesh->mloop[i].v), float(mesh->mloop[i].e)});
+    }
+  }
+  return result;
+}
+
+TEST_F(BlendfileWriteTest, LazyDataReadMatchesFullRead)
+{
+  if (!blendfile_load("modifier_stack/array_test.blend")) {
+    return;
+  }
+
+  BKE_tempdir_init("");
+  char filepath[FILE_MAX];
+  BLI_join_dirfile(filepath, sizeof(filepath), BKE_tempdir_session(), "lazy_data_test.blend");
+
+  /* Deferred data is only supported for files of the current version. */
+  BlendFileWriteParams params{};
+  params.remap_mode = BLO_WRITE_PATH_REMAP_NONE;
+  ASSERT_TRUE(BLO_write_file(bfile->main, filepath, 0, &params, nullptr));
+
+  BlendFileReadReport reports = {nullptr};
+  BlendFileData *bfd_full = BLO_read_from_file(filepath, BLO_READ_SKIP_NONE, &reports);
+  ASSERT_NE(bfd_full, nullptr);
+  const std::map<std::string, blender::Vector<float>> geometry_full = mesh_geometry_get(
+      bfd_full->main);
+  BLO_blendfiledata_free(bfd_full);
+  EXPECT_FALSE(geometry_full.empty());
+
+  BlendFileData *bfd_lazy = BLO_read_from_file(filepath, BLO_READ_LAZY_DATA, &reports);
+  ASSERT_NE(bfd_lazy, nullptr);
+  EXPECT_TRUE(BLO_lazy_data_is_pending());
+  LISTBASE_FOREACH (const Mesh *, mesh, &bfd_lazy->main->meshes) {
+    EXPECT_TRUE(mesh->id.tag & LIB_TAG_LAZY_DATA);
+    EXPECT_EQ(mesh->totvert, 0);
+    EXPECT_EQ(mesh->totloop, 0);
+  }
+
+  /* Read a single mesh first, the others are read by #BLO_lazy_data_ensure_all. */
+  Mesh *mesh_first = static_cast<Mesh *>(bfd_lazy->main->meshes.first);
+  ASSERT_NE(mesh_first, nullptr);
+  BLO_lazy_data_ensure(&mesh_first->id);
+  EXPECT_FALSE(mesh_first->id.tag & LIB_TAG_LAZY_DATA);
+  BLO_lazy_data_ensure_all(bfd_lazy->main);
+  EXPECT_FALSE(BLO_lazy_data_is_pending());
+
+  EXPECT_EQ(mesh_geometry_get(bfd_lazy->main), geometry_full);
+
+  BLO_blendfiledata_free(bfd_lazy);
+  BLO_lazy_data_clear();
+  BLI_delete(filepath, false, false);
+}
+
+/** Add a mesh with only vertices, placed on a line. */
+static Mesh *mesh_add_vertices(Main *bmain, const char *name, const int verts_num)
+{
+  Mesh *mesh = BKE_mesh_add(bmain, name);
+  CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, verts_num);
+  mesh->totvert = verts_num;
+  BKE_mesh_update_customdata_pointers(mesh, false);
+  for (const int i : blender::IndexRange(verts_num)) {
+    mesh->mvert[i].co[0] = float(i);
+  }
+  return mesh;
+}
+
+/**
+ * Read the file and evaluate the depsgraph of its active view layer, which is what has to happen
+ * before the viewport of a file that was just opened can be drawn.
+ * Returns the number of meshes added by the test which data was not read.
+ */
+static int read_until_interactive(const char *filepath, const int read_flags)
+{
+  BlendFileReadReport reports = {nullptr};
+  BlendFileData *bfd = BLO_read_from_file(filepath, eBLOReadSkip(read_flags), &reports);
+  if (bfd == nullptr) {
+    ADD_FAILURE() << "Unable to read " << filepath;
+    return -1;
+  }
+  Depsgraph *depsgraph = DEG_graph_new(
+      bfd->main, bfd->curscene, bfd->cur_view_layer, DAG_EVAL_VIEWPORT);
+  DEG_graph_build_from_view_layer(depsgraph);
+  BKE_scene_graph_update_tagged(depsgraph, bfd->main);
+
+  int lazy_meshes_num = 0;
+  LISTBASE_FOREACH (const Mesh *, mesh, &bfd->main->meshes) {
+    if (STRPREFIX(mesh->id.name + 2, "LazyMesh") && (mesh->id.tag & LIB_TAG_LAZY_DATA)) {
+      lazy_meshes_num++;
+    }
+  }
+
+  DEG_graph_free(depsgraph);
+  BLO_blendfiledata_free(bfd);
+  return lazy_meshes_num;
+}
+
+TEST_F(BlendfileWriteTest, LazyDataTimeToInteractive)
+{
+  if (!blendfile_load("modifier_stack/array_test.blend")) {
+    return;
+  }
+
+  BKE_tempdir_init("");
+  char filepath[FILE_MAX];
+  BLI_join_dirfile(
+      filepath, sizeof(filepath), BKE_tempdir_session(), "lazy_data_benchmark.blend");
+
+  /* A large file where most of the geometry is not visible in the active view layer, like a
+   * file containing a library of assets. Only the meshes of the visible objects have to be read
+   * before the file can be drawn. */
+  Main *bmain = bfile->main;
+  Scene *scene = bfile->curscene;
+  for (const int i : blender::IndexRange(64)) {
+    const std::string name = "LazyMesh" + std::to_string(i);
+    Mesh *mesh = mesh_add_vertices(bmain, name.c_str(), 200000);
+    if (i % 8 == 0) {
+      Object *object = BKE_object_add_only_object(bmain, OB_MESH, name.c_str());
+      object->data = mesh;
+      BKE_collection_object_add(bmain, scene->master_collection, object);
+    }
+    else {
+      id_fake_user_set(&mesh->id);
+      id_us_min(&mesh->id);
+    }
+  }
+
+  BlendFileWriteParams params{};
+  params.remap_mode = BLO_WRITE_PATH_REMAP_NONE;
+  ASSERT_TRUE(BLO_write_file(bmain, filepath, 0, &params, nullptr));
+
+  int lazy_meshes_num;
+  {
+    SCOPED_TIMER("time to interactive, full read");
+    lazy_meshes_num = read_until_interactive(filepath, BLO_READ_SKIP_NONE);
+  }
+  EXPECT_EQ(lazy_meshes_num, 0);
+  {
+    SCOPED_TIMER("time to interactive, lazy data");
+    lazy_meshes_num = read_until_interactive(filepath, BLO_READ_LAZY_DATA);
+  }
+  /* The meshes of visible objects are read by the depsgraph, the others are still pending. */
+  EXPECT_EQ(lazy_meshes_num, 56);
+
+  BLO_lazy_data_clear();
+  BLI_delete(filepath, false, false);
+}
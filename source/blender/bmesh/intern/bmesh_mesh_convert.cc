@@ -69,6 +69,8 @@
  *   These indices are also used to maintain correct indices for hook modifiers and vertex parents.
  */
 
+#include <algorithm>
+
 #include "DNA_key_types.h"
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
@@ -82,7 +84,9 @@
 #include "BLI_index_range.hh"
 #include "BLI_listbase.h"
 #include "BLI_math_vector.h"
+#include "BLI_mempool.h"
 #include "BLI_span.hh"
+#include "BLI_task.hh"
 
 #include "BKE_customdata.h"
 #include "BKE_mesh.h"
@@ -103,6 +107,7 @@ static CLG_LogRef LOG = {"bmesh.mesh.convert"};
 
 using blender::Array;
 using blender::IndexRange;
+using blender::MutableSpan;
 using blender::Span;
 
 void BM_mesh_cd_flag_ensure(BMesh *bm, Mesh *mesh, const char cd_flag)
@@ -184,6 +189,41 @@ char BM_mesh_cd_flag_from_bmesh(BMesh *bm)
   return cd_flag;
 }
 
+/**
+ * Allocates the custom-data blocks of the elements processed by one task, so that multiple
+ * threads can fill in custom-data at once. #CustomData_to_bmesh_block only copies the data into
+ * blocks that are already allocated.
+ */
+class CustomDataBlockAllocator {
+ private:
+  CustomData &data_;
+  BLI_mempool_thread thread_;
+
+ public:
+  CustomDataBlockAllocator(CustomData &data) : data_(data)
+  {
+    if (data_.pool) {
+      BLI_mempool_thread_begin(data_.pool, &thread_);
+    }
+  }
+
+  ~CustomDataBlockAllocator()
+  {
+    if (data_.pool) {
+      BLI_mempool_thread_end(&thread_);
+    }
+  }
+
+  void *alloc()
+  {
+    if (data_.totsize > 0) {
+      BLI_assert(data_.pool != nullptr);
+      return BLI_mempool_thread_alloc(&thread_);
+    }
+    return nullptr;
+  }
+};
+
 /* Static function for alloc (duplicate in modifiers_bmesh.c) */
 static BMFace *bm_face_create_from_mpoly(BMesh &bm,
                                          Span<MLoop> loops,
@@ -201,6 +241,183 @@ static BMFace *bm_face_create_from_mpoly(BMesh &bm,
   return BM_face_create(&bm, verts.data(), edges.data(), loops.size(), nullptr, BM_CREATE_SKIP_CD);
 }
 
+/**
+ * Create all elements of a new BMesh, the same as #BM_vert_create, #BM_edge_create and
+ * #BM_face_create would when called for all vertices, edges and faces in order (without
+ * custom-data). Elements are allocated in that order, so the iteration order and the disk and
+ * radial cycles match as well, but their members and cycles are filled in parallel.
+ *
+ * Element data (coordinates, flags, custom-data) is left to the caller, except for face and loop
+ * indices.
+ */
+static void bm_mesh_elems_create_parallel(BMesh &bm,
+                                          Span<MEdge> medge,
+                                          Span<MPoly> mpoly,
+                                          Span<MLoop> mloop,
+                                          MutableSpan<BMVert *> vtable,
+                                          MutableSpan<BMEdge *> etable,
+                                          MutableSpan<BMFace *> ftable)
+{
+  BLI_assert(bm.totvert == 0 && bm.totedge == 0 && bm.totface == 0);
+  const bool use_toolflags = bm.use_toolflags;
+
+  /* Allocating from the pools is cheap, but must be done in order. */
+  for (const int i : vtable.index_range()) {
+    BMVert *v = vtable[i] = static_cast<BMVert *>(BLI_mempool_alloc(bm.vpool));
+    if (use_toolflags) {
+      ((BMVert_OFlag *)v)->oflags = bm.vtoolflagpool ? static_cast<BMFlagLayer *>(
+                                                           BLI_mempool_calloc(bm.vtoolflagpool)) :
+                                                       nullptr;
+    }
+  }
+  for (const int i : etable.index_range()) {
+    BMEdge *e = etable[i] = static_cast<BMEdge *>(BLI_mempool_alloc(bm.epool));
+    if (use_toolflags) {
+      ((BMEdge_OFlag *)e)->oflags = bm.etoolflagpool ? static_cast<BMFlagLayer *>(
+                                                           BLI_mempool_calloc(bm.etoolflagpool)) :
+                                                       nullptr;
+    }
+  }
+  Array<BMLoop *> ltable(mloop.size());
+  int totloop = 0;
+  for (const int i : ftable.index_range()) {
+    BMFace *f = ftable[i] = static_cast<BMFace *>(BLI_mempool_alloc(bm.fpool));
+    if (use_toolflags) {
+      ((BMFace_OFlag *)f)->oflags = bm.ftoolflagpool ? static_cast<BMFlagLayer *>(
+                                                           BLI_mempool_calloc(bm.ftoolflagpool)) :
+                                                       nullptr;
+    }
+    for (const int j : IndexRange(mpoly[i].loopstart, mpoly[i].totloop)) {
+      ltable[j] = static_cast<BMLoop *>(BLI_mempool_alloc(bm.lpool));
+      BM_elem_index_set(ltable[j], totloop++); /* set_ok */
+    }
+  }
+
+  /* Edges and loops connected to every vertex and edge, in the order they are created. */
+  Array<int> vert_edge_offsets(vtable.size() + 1, 0);
+  Array<int> edge_loop_offsets(etable.size() + 1, 0);
+  for (const MEdge &edge : medge) {
+    vert_edge_offsets[edge.v1]++;
+    vert_edge_offsets[edge.v2]++;
+  }
+  for (const MPoly &poly : mpoly) {
+    for (const MLoop &loop : mloop.slice(poly.loopstart, poly.totloop)) {
+      edge_loop_offsets[loop.e]++;
+    }
+  }
+  int offset = 0;
+  for (int &count : vert_edge_offsets) {
+    const int count_copy = count;
+    count = offset;
+    offset += count_copy;
+  }
+  offset = 0;
+  for (int &count : edge_loop_offsets) {
+    const int count_copy = count;
+    count = offset;
+    offset += count_copy;
+  }
+  Array<int> vert_edges(medge.size() * 2);
+  Array<int> edge_loops(mloop.size());
+  {
+    Array<int> vert_edges_num(vtable.size(), 0);
+    for (const int i : medge.index_range()) {
+      const int v1 = medge[i].v1;
+      const int v2 = medge[i].v2;
+      vert_edges[vert_edge_offsets[v1] + vert_edges_num[v1]++] = i;
+      vert_edges[vert_edge_offsets[v2] + vert_edges_num[v2]++] = i;
+    }
+    Array<int> edge_loops_num(etable.size(), 0);
+    for (const MPoly &poly : mpoly) {
+      for (const int j : IndexRange(poly.loopstart, poly.totloop)) {
+        const int e = mloop[j].e;
+        edge_loops[edge_loop_offsets[e] + edge_loops_num[e]++] = j;
+      }
+    }
+  }
+
+  blender::threading::parallel_for(etable.index_range(), 1024, [&](const IndexRange range) {
+    for (const int i : range) {
+      BMEdge *e = etable[i];
+      e->head.data = nullptr;
+      e->head.htype = BM_EDGE;
+      e->head.hflag = BM_ELEM_SMOOTH | BM_ELEM_DRAW;
+      e->head.api_flag = 0;
+      e->v1 = vtable[medge[i].v1];
+      e->v2 = vtable[medge[i].v2];
+
+      /* The radial cycle is in creation order, starting at the last created loop. */
+      const Span<int> loops = edge_loops.as_span().slice(
+          edge_loop_offsets[i], edge_loop_offsets[i + 1] - edge_loop_offsets[i]);
+      e->l = loops.is_empty() ? nullptr : ltable[loops.last()];
+      for (const int j : loops.index_range()) {
+        BMLoop *l = ltable[loops[j]];
+        l->radial_next = ltable[loops[(j + 1) % loops.size()]];
+        l->radial_prev = ltable[loops[(j + loops.size() - 1) % loops.size()]];
+      }
+    }
+  });
+
+  blender::threading::parallel_for(vtable.index_range(), 1024, [&](const IndexRange range) {
+    for (const int i : range) {
+      BMVert *v = vtable[i];
+      v->head.data = nullptr;
+      v->head.htype = BM_VERT;
+      v->head.hflag = 0;
+      v->head.api_flag = 0;
+      zero_v3(v->co);
+      zero_v3(v->no);
+
+      /* The disk cycle is in creation order, starting at the first created edge. */
+      const Span<int> edges = vert_edges.as_span().slice(
+          vert_edge_offsets[i], vert_edge_offsets[i + 1] - vert_edge_offsets[i]);
+      v->e = edges.is_empty() ? nullptr : etable[edges.first()];
+      for (const int j : edges.index_range()) {
+        BMDiskLink *dl = bmesh_disk_edge_link_from_vert(etable[edges[j]], v);
+        dl->next = etable[edges[(j + 1) % edges.size()]];
+        dl->prev = etable[edges[(j + edges.size() - 1) % edges.size()]];
+      }
+    }
+  });
+
+  blender::threading::parallel_for(ftable.index_range(), 512, [&](const IndexRange range) {
+    for (const int i : range) {
+      BMFace *f = ftable[i];
+      BM_elem_index_set(f, i); /* set_ok */
+      f->head.data = nullptr;
+      f->head.htype = BM_FACE;
+      f->head.hflag = 0;
+      f->head.api_flag = 0;
+      f->len = mpoly[i].totloop;
+      f->mat_nr = 0;
+      zero_v3(f->no);
+
+      const IndexRange loops(mpoly[i].loopstart, mpoly[i].totloop);
+      f->l_first = ltable[loops.first()];
+      for (const int j : IndexRange(loops.size())) {
+        BMLoop *l = ltable[loops[j]];
+        l->head.data = nullptr;
+        l->head.htype = BM_LOOP;
+        l->head.hflag = 0;
+        l->head.api_flag = 0;
+        l->v = vtable[mloop[loops[j]].v];
+        l->e = etable[mloop[loops[j]].e];
+        l->f = f;
+        l->next = ltable[loops[(j + 1) % loops.size()]];
+        l->prev = ltable[loops[(j + loops.size() - 1) % loops.size()]];
+      }
+    }
+  });
+
+  bm.totvert = int(vtable.size());
+  bm.totedge = int(etable.size());
+  bm.totface = int(ftable.size());
+  bm.totloop = totloop;
+  bm.elem_index_dirty |= BM_VERT | BM_EDGE;
+  bm.elem_table_dirty |= BM_VERT | BM_EDGE | BM_FACE;
+  bm.spacearr_dirty |= BM_SPACEARR_DIRTY_ALL;
+}
+
 void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshParams *params)
 {
   const bool is_new = !(bm->totvert || (bm->vdata.totlayer || bm->edata.totlayer ||
@@ -356,141 +573,175 @@ void BM_mesh_bm_from_me(BMesh *bm, const Mesh *me, const struct BMeshFromMeshPar
                                            -1;
 
   Span<MVert> mvert{me->mvert, me->totvert};
+  Span<MEdge> medge{me->medge, me->totedge};
+  Span<MPoly> mpoly{me->mpoly, me->totpoly};
+  Span<MLoop> mloop{me->mloop, me->totloop};
   Array<BMVert *> vtable(me->totvert);
-  for (const int i : mvert.index_range()) {
-    BMVert *v = vtable[i] = BM_vert_create(
-        bm, keyco ? keyco[i] : mvert[i].co, nullptr, BM_CREATE_SKIP_CD);
-    BM_elem_index_set(v, i); /* set_ok */
-
-    /* Transfer flag. */
-    v->head.hflag = BM_vert_flag_from_mflag(mvert[i].flag & ~SELECT);
-
-    /* This is necessary for selection counts to work properly. */
-    if (mvert[i].flag & SELECT) {
-      BM_vert_select_set(bm, v, true);
+  Array<BMEdge *> etable(me->totedge);
+  /* Skipped faces are null. Also needed for selection. */
+  Array<BMFace *> ftable(me->totpoly);
+
+  /* Faces without corners are skipped, which isn't supported when creating elements in
+   * parallel. Merging into existing elements isn't supported either. */
+  const bool create_parallel = is_new && std::all_of(mpoly.begin(),
+                                                     mpoly.end(),
+                                                     [](const MPoly &poly) {
+                                                       return poly.totloop > 0;
+                                                     });
+  if (create_parallel) {
+    bm_mesh_elems_create_parallel(*bm, medge, mpoly, mloop, vtable, etable, ftable);
+  }
+  else {
+    for (const int i : mvert.index_range()) {
+      vtable[i] = BM_vert_create(bm, nullptr, nullptr, BM_CREATE_SKIP_CD);
     }
-
-    if (vert_normals) {
-      copy_v3_v3(v->no, vert_normals[i]);
+    for (const int i : medge.index_range()) {
+      etable[i] = BM_edge_create(
+          bm, vtable[medge[i].v1], vtable[medge[i].v2], nullptr, BM_CREATE_SKIP_CD);
     }
 
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->vdata, &bm->vdata, i, &v->head.data, true);
-
-    if (cd_vert_bweight_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(v, cd_vert_bweight_offset, (float)mvert[i].bweight / 255.0f);
-    }
+    int totloops = 0;
+    for (const int i : mpoly.index_range()) {
+      BMFace *f = ftable[i] = bm_face_create_from_mpoly(
+          *bm, mloop.slice(mpoly[i].loopstart, mpoly[i].totloop), vtable, etable);
+
+      if (UNLIKELY(f == nullptr)) {
+        printf(
+            "%s: Warning! Bad face in mesh"
+            " \"%s\" at index %d!, skipping\n",
+            __func__,
+            me->id.name + 2,
+            i);
+        continue;
+      }
 
-    /* Set shape key original index. */
-    if (cd_shape_keyindex_offset != -1) {
-      BM_ELEM_CD_SET_INT(v, cd_shape_keyindex_offset, i);
-    }
+      /* Don't use 'i' since we may have skipped the face. */
+      BM_elem_index_set(f, bm->totface - 1); /* set_ok */
 
-    /* Set shape-key data. */
-    if (tot_shape_keys) {
-      float(*co_dst)[3] = (float(*)[3])BM_ELEM_CD_GET_VOID_P(v, cd_shape_key_offset);
-      for (int j = 0; j < tot_shape_keys; j++, co_dst++) {
-        copy_v3_v3(*co_dst, shape_key_table[j][i]);
-      }
+      BMLoop *l_first = BM_FACE_FIRST_LOOP(f);
+      BMLoop *l_iter = l_first;
+      do {
+        /* Don't use the #MLoop index since we may have skipped some faces, hence some loops. */
+        BM_elem_index_set(l_iter, totloops++); /* set_ok */
+      } while ((l_iter = l_iter->next) != l_first);
     }
   }
   if (is_new) {
-    bm->elem_index_dirty &= ~BM_VERT; /* Added in order, clear dirty flag. */
+    /* Added in order, clear dirty flag. */
+    bm->elem_index_dirty &= ~(BM_VERT | BM_EDGE | BM_FACE | BM_LOOP);
   }
 
-  Span<MEdge> medge{me->medge, me->totedge};
-  Array<BMEdge *> etable(me->totedge);
-  for (const int i : medge.index_range()) {
-    BMEdge *e = etable[i] = BM_edge_create(
-        bm, vtable[medge[i].v1], vtable[medge[i].v2], nullptr, BM_CREATE_SKIP_CD);
-    BM_elem_index_set(e, i); /* set_ok */
-
-    /* Transfer flags. */
-    e->head.hflag = BM_edge_flag_from_mflag(medge[i].flag & ~SELECT);
-
-    /* This is necessary for selection counts to work properly. */
-    if (medge[i].flag & SELECT) {
-      BM_edge_select_set(bm, e, true);
-    }
-
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->edata, &bm->edata, i, &e->head.data, true);
+  /* Fill in element data and copy custom-data in parallel, the order of the custom-data blocks in
+   * their pools doesn't matter. */
+  blender::threading::parallel_for(mvert.index_range(), 1024, [&](const IndexRange range) {
+    CustomDataBlockAllocator allocator(bm->vdata);
+    for (const int i : range) {
+      BMVert *v = vtable[i];
+      BM_elem_index_set(v, i); /* set_ok */
+      copy_v3_v3(v->co, keyco ? keyco[i] : mvert[i].co);
 
-    if (cd_edge_bweight_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(e, cd_edge_bweight_offset, (float)medge[i].bweight / 255.0f);
-    }
-    if (cd_edge_crease_offset != -1) {
-      BM_ELEM_CD_SET_FLOAT(e, cd_edge_crease_offset, (float)medge[i].crease / 255.0f);
-    }
-  }
-  if (is_new) {
-    bm->elem_index_dirty &= ~BM_EDGE; /* Added in order, clear dirty flag. */
-  }
+      /* Transfer flag. */
+      v->head.hflag = BM_vert_flag_from_mflag(mvert[i].flag & ~SELECT);
 
-  Span<MPoly> mpoly{me->mpoly, me->totpoly};
-  Span<MLoop> mloop{me->mloop, me->totloop};
+      if (vert_normals) {
+        copy_v3_v3(v->no, vert_normals[i]);
+      }
 
-  /* Only needed for selection. */
+      v->head.data = allocator.alloc();
+      CustomData_to_bmesh_block(&me->vdata, &bm->vdata, i, &v->head.data, true);
 
-  Array<BMFace *> ftable;
-  if (me->mselect && me->totselect != 0) {
-    ftable.reinitialize(me->totpoly);
-  }
+      if (cd_vert_bweight_offset != -1) {
+        BM_ELEM_CD_SET_FLOAT(v, cd_vert_bweight_offset, (float)mvert[i].bweight / 255.0f);
+      }
 
-  int totloops = 0;
-  for (const int i : mpoly.index_range()) {
-    BMFace *f = bm_face_create_from_mpoly(
-        *bm, mloop.slice(mpoly[i].loopstart, mpoly[i].totloop), vtable, etable);
-    if (!ftable.is_empty()) {
-      ftable[i] = f;
-    }
+      /* Set shape key original index. */
+      if (cd_shape_keyindex_offset != -1) {
+        BM_ELEM_CD_SET_INT(v, cd_shape_keyindex_offset, i);
+      }
 
-    if (UNLIKELY(f == nullptr)) {
-      printf(
-          "%s: Warning! Bad face in mesh"
-          " \"%s\" at index %d!, skipping\n",
-          __func__,
-          me->id.name + 2,
-          i);
-      continue;
+      /* Set shape-key data. */
+      if (tot_shape_keys) {
+        float(*co_dst)[3] = (float(*)[3])BM_ELEM_CD_GET_VOID_P(v, cd_shape_key_offset);
+        for (int j = 0; j < tot_shape_keys; j++, co_dst++) {
+          copy_v3_v3(*co_dst, shape_key_table[j][i]);
+        }
+      }
     }
+  });
 
-    /* Don't use 'i' since we may have skipped the face. */
-    BM_elem_index_set(f, bm->totface - 1); /* set_ok */
+  blender::threading::parallel_for(medge.index_range(), 1024, [&](const IndexRange range) {
+    CustomDataBlockAllocator allocator(bm->edata);
+    for (const int i : range) {
+      BMEdge *e = etable[i];
+      BM_elem_index_set(e, i); /* set_ok */
 
-    /* Transfer flag. */
-    f->head.hflag = BM_face_flag_from_mflag(mpoly[i].flag & ~ME_FACE_SEL);
+      /* Transfer flags. */
+      e->head.hflag = BM_edge_flag_from_mflag(medge[i].flag & ~SELECT);
 
-    /* This is necessary for selection counts to work properly. */
-    if (mpoly[i].flag & ME_FACE_SEL) {
-      BM_face_select_set(bm, f, true);
-    }
+      e->head.data = allocator.alloc();
+      CustomData_to_bmesh_block(&me->edata, &bm->edata, i, &e->head.data, true);
 
-    f->mat_nr = mpoly[i].mat_nr;
-    if (i == me->act_face) {
-      bm->act_face = f;
+      if (cd_edge_bweight_offset != -1) {
+        BM_ELEM_CD_SET_FLOAT(e, cd_edge_bweight_offset, (float)medge[i].bweight / 255.0f);
+      }
+      if (cd_edge_crease_offset != -1) {
+        BM_ELEM_CD_SET_FLOAT(e, cd_edge_crease_offset, (float)medge[i].crease / 255.0f);
+      }
     }
+  });
+
+  blender::threading::parallel_for(mpoly.index_range(), 512, [&](const IndexRange range) {
+    CustomDataBlockAllocator loop_allocator(bm->ldata);
+    CustomDataBlockAllocator face_allocator(bm->pdata);
+    for (const int i : range) {
+      BMFace *f = ftable[i];
+      if (f == nullptr) {
+        continue;
+      }
 
-    int j = mpoly[i].loopstart;
-    BMLoop *l_first = BM_FACE_FIRST_LOOP(f);
-    BMLoop *l_iter = l_first;
-    do {
-      /* Don't use 'j' since we may have skipped some faces, hence some loops. */
-      BM_elem_index_set(l_iter, totloops++); /* set_ok */
+      /* Transfer flag. */
+      f->head.hflag = BM_face_flag_from_mflag(mpoly[i].flag & ~ME_FACE_SEL);
 
-      /* Save index of corresponding #MLoop. */
-      CustomData_to_bmesh_block(&me->ldata, &bm->ldata, j++, &l_iter->head.data, true);
-    } while ((l_iter = l_iter->next) != l_first);
+      f->mat_nr = mpoly[i].mat_nr;
+      if (i == me->act_face) {
+        bm->act_face = f;
+      }
 
-    /* Copy Custom Data */
-    CustomData_to_bmesh_block(&me->pdata, &bm->pdata, i, &f->head.data, true);
+      int j = mpoly[i].loopstart;
+      BMLoop *l_first = BM_FACE_FIRST_LOOP(f);
+      BMLoop *l_iter = l_first;
+      do {
+        /* Save index of corresponding #MLoop. */
+        l_iter->head.data = loop_allocator.alloc();
+        CustomData_to_bmesh_block(&me->ldata, &bm->ldata, j++, &l_iter->head.data, true);
+      } while ((l_iter = l_iter->next) != l_first);
+
+      /* Copy Custom Data */
+      f->head.data = face_allocator.alloc();
+      CustomData_to_bmesh_block(&me->pdata, &bm->pdata, i, &f->head.data, true);
+
+      if (params->calc_face_normal) {
+        BM_face_normal_update(f);
+      }
+    }
+  });
 
-    if (params->calc_face_normal) {
-      BM_face_normal_update(f);
+  /* This is necessary for selection counts to work properly. Selecting an element selects its
+   * vertices and edges too, so do this once all flags are set. */
+  for (const int i : mvert.index_range()) {
+    if (mvert[i].flag & SELECT) {
+      BM_vert_select_set(bm, vtable[i], true);
     }
   }
-  if (is_new) {
-    bm->elem_index_dirty &= ~(BM_FACE | BM_LOOP); /* Added in order, clear dirty flag. */
+  for (const int i : medge.index_range()) {
+    if (medge[i].flag & SELECT) {
+      BM_edge_select_set(bm, etable[i], true);
+    }
+  }
+  for (const int i : mpoly.index_range()) {
+    if ((mpoly[i].flag & ME_FACE_SEL) && ftable[i] != nullptr) {
+      BM_face_select_set(bm, ftable[i], true);
+    }
   }
 
   /* -------------------------------------------------------------------- */
@@ -880,10 +1131,7 @@ BLI_INLINE void bmesh_quick_edgedraw_flag(MEdge *med, BMEdge *e)
 
 void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMeshParams *params)
 {
-  MEdge *med;
-  BMVert *v, *eve;
-  BMEdge *e;
-  BMFace *f;
+  BMVert *eve;
   BMIter iter;
   int i, j;
 
@@ -943,91 +1191,99 @@ void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMesh
   /* This is called again, 'dotess' arg is used there. */
   BKE_mesh_update_customdata_pointers(me, false);
 
-  i = 0;
-  BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
-    copy_v3_v3(mvert->co, v->co);
+  /* Element tables are in iteration order, they are used to convert elements in parallel. */
+  BM_mesh_elem_table_ensure(bm, BM_VERT | BM_EDGE | BM_FACE);
 
-    mvert->flag = BM_vert_flag_to_mflag(v);
+  blender::threading::parallel_for(IndexRange(bm->totvert), 1024, [&](const IndexRange range) {
+    for (const int i : range) {
+      BMVert *v = bm->vtable[i];
+      MVert *mv = &mvert[i];
+      copy_v3_v3(mv->co, v->co);
 
-    BM_elem_index_set(v, i); /* set_inline */
+      mv->flag = BM_vert_flag_to_mflag(v);
 
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->vdata, &me->vdata, v->head.data, i);
+      BM_elem_index_set(v, i); /* set_inline */
 
-    if (cd_vert_bweight_offset != -1) {
-      mvert->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, cd_vert_bweight_offset);
-    }
+      /* Copy over custom-data. */
+      CustomData_from_bmesh_block(&bm->vdata, &me->vdata, v->head.data, i);
 
-    i++;
-    mvert++;
+      if (cd_vert_bweight_offset != -1) {
+        mv->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(v, cd_vert_bweight_offset);
+      }
 
-    BM_CHECK_ELEMENT(v);
-  }
+      BM_CHECK_ELEMENT(v);
+    }
+  });
   bm->elem_index_dirty &= ~BM_VERT;
 
-  med = medge;
-  i = 0;
-  BM_ITER_MESH (e, &iter, bm, BM_EDGES_OF_MESH) {
-    med->v1 = BM_elem_index_get(e->v1);
-    med->v2 = BM_elem_index_get(e->v2);
+  blender::threading::parallel_for(IndexRange(bm->totedge), 1024, [&](const IndexRange range) {
+    for (const int i : range) {
+      BMEdge *e = bm->etable[i];
+      MEdge *med = &medge[i];
+      med->v1 = BM_elem_index_get(e->v1);
+      med->v2 = BM_elem_index_get(e->v2);
 
-    med->flag = BM_edge_flag_to_mflag(e);
+      med->flag = BM_edge_flag_to_mflag(e);
 
-    BM_elem_index_set(e, i); /* set_inline */
+      BM_elem_index_set(e, i); /* set_inline */
 
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->edata, &me->edata, e->head.data, i);
+      /* Copy over custom-data. */
+      CustomData_from_bmesh_block(&bm->edata, &me->edata, e->head.data, i);
 
-    bmesh_quick_edgedraw_flag(med, e);
+      bmesh_quick_edgedraw_flag(med, e);
 
-    if (cd_edge_crease_offset != -1) {
-      med->crease = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_crease_offset);
-    }
-    if (cd_edge_bweight_offset != -1) {
-      med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_bweight_offset);
+      if (cd_edge_crease_offset != -1) {
+        med->crease = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_crease_offset);
+      }
+      if (cd_edge_bweight_offset != -1) {
+        med->bweight = BM_ELEM_CD_GET_FLOAT_AS_UCHAR(e, cd_edge_bweight_offset);
+      }
+
+      BM_CHECK_ELEMENT(e);
     }
+  });
+  bm->elem_index_dirty &= ~BM_EDGE;
 
-    i++;
-    med++;
-    BM_CHECK_ELEMENT(e);
+  /* Compute where the corners of every face start, so faces can be converted in parallel. */
+  for (const int i : IndexRange(bm->totface)) {
+    mpoly[i].loopstart = (i == 0) ? 0 : mpoly[i - 1].loopstart + mpoly[i - 1].totloop;
+    mpoly[i].totloop = bm->ftable[i]->len;
   }
-  bm->elem_index_dirty &= ~BM_EDGE;
 
-  i = 0;
-  j = 0;
-  BM_ITER_MESH (f, &iter, bm, BM_FACES_OF_MESH) {
-    BMLoop *l_iter, *l_first;
-    mpoly->loopstart = j;
-    mpoly->totloop = f->len;
-    mpoly->mat_nr = f->mat_nr;
-    mpoly->flag = BM_face_flag_to_mflag(f);
-
-    l_iter = l_first = BM_FACE_FIRST_LOOP(f);
-    do {
-      mloop->e = BM_elem_index_get(l_iter->e);
-      mloop->v = BM_elem_index_get(l_iter->v);
+  blender::threading::parallel_for(IndexRange(bm->totface), 512, [&](const IndexRange range) {
+    for (const int i : range) {
+      BMFace *f = bm->ftable[i];
+      MPoly *mp = &mpoly[i];
+      mp->mat_nr = f->mat_nr;
+      mp->flag = BM_face_flag_to_mflag(f);
+
+      int j = mp->loopstart;
+      BMLoop *l_iter, *l_first;
+      l_iter = l_first = BM_FACE_FIRST_LOOP(f);
+      do {
+        MLoop *ml = &mloop[j];
+        ml->e = BM_elem_index_get(l_iter->e);
+        ml->v = BM_elem_index_get(l_iter->v);
+
+        /* Copy over custom-data. */
+        CustomData_from_bmesh_block(&bm->ldata, &me->ldata, l_iter->head.data, j);
+
+        j++;
+        BM_CHECK_ELEMENT(l_iter);
+        BM_CHECK_ELEMENT(l_iter->e);
+        BM_CHECK_ELEMENT(l_iter->v);
+      } while ((l_iter = l_iter->next) != l_first);
+
+      if (f == bm->act_face) {
+        me->act_face = i;
+      }
 
       /* Copy over custom-data. */
-      CustomData_from_bmesh_block(&bm->ldata, &me->ldata, l_iter->head.data, j);
-
-      j++;
-      mloop++;
-      BM_CHECK_ELEMENT(l_iter);
-      BM_CHECK_ELEMENT(l_iter->e);
-      BM_CHECK_ELEMENT(l_iter->v);
-    } while ((l_iter = l_iter->next) != l_first);
+      CustomData_from_bmesh_block(&bm->pdata, &me->pdata, f->head.data, i);
 
-    if (f == bm->act_face) {
-      me->act_face = i;
+      BM_CHECK_ELEMENT(f);
     }
-
-    /* Copy over custom-data. */
-    CustomData_from_bmesh_block(&bm->pdata, &me->pdata, f->head.data, i);
-
-    i++;
-    mpoly++;
-    BM_CHECK_ELEMENT(f);
-  }
+  });
 
   /* Patch hook indices and vertex parents. */
   if (params->calc_object_remap && (ototvert > 0)) {
@@ -0,0 +1,250 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "CLG_log.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+
+#include "BLI_index_range.hh"
+#include "BLI_timeit.hh"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "bmesh.h"
+
+namespace blender::bmesh::tests {
+
+class bmesh_mesh_convert : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    CLG_init();
+    BKE_idtype_init();
+  }
+
+  static void TearDownTestSuite()
+  {
+    CLG_exit();
+  }
+};
+
+/**
+ * Create a grid of quads with a float attribute on vertices and UVs on face corners.
+ */
+static Mesh *create_grid_mesh(const int size)
+{
+  const int verts_num = (size + 1) * (size + 1);
+  const int faces_num = size * size;
+  Mesh *mesh = BKE_mesh_new_nomain(verts_num, 0, 0, faces_num * 4, faces_num);
+
+  float *weights = (float *)CustomData_add_layer_named(
+      &mesh->vdata, CD_PROP_FLOAT, CD_CALLOC, nullptr, verts_num, "weight");
+  for (const int y : IndexRange(size + 1)) {
+    for (const int x : IndexRange(size + 1)) {
+      const int i = y * (size + 1) + x;
+      mesh->mvert[i].co[0] = float(x);
+      mesh->mvert[i].co[1] = float(y);
+      weights[i] = float(i);
+    }
+  }
+
+  MLoopUV *uvs = (MLoopUV *)CustomData_add_layer(
+      &mesh->ldata, CD_MLOOPUV, CD_CALLOC, nullptr, faces_num * 4);
+  for (const int y : IndexRange(size)) {
+    for (const int x : IndexRange(size)) {
+      const int i = y * size + x;
+      const int v = y * (size + 1) + x;
+      mesh->mpoly[i].loopstart = i * 4;
+      mesh->mpoly[i].totloop = 4;
+      mesh->mloop[i * 4 + 0].v = v;
+      mesh->mloop[i * 4 + 1].v = v + 1;
+      mesh->mloop[i * 4 + 2].v = v + size + 2;
+      mesh->mloop[i * 4 + 3].v = v + size + 1;
+      for (const int j : IndexRange(4)) {
+        uvs[i * 4 + j].uv[0] = float(i);
+        uvs[i * 4 + j].uv[1] = float(j);
+      }
+    }
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+  return mesh;
+}
+
+TEST_F(bmesh_mesh_convert, FromMesh)
+{
+  Mesh *mesh = create_grid_mesh(512);
+
+  BMeshCreateParams create_params{};
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &create_params);
+  BMeshFromMeshParams convert_params{};
+  {
+    SCOPED_TIMER("BM_mesh_bm_from_me");
+    BM_mesh_bm_from_me(bm, mesh, &convert_params);
+  }
+
+  EXPECT_EQ(bm->totvert, mesh->totvert);
+  EXPECT_EQ(bm->totedge, mesh->totedge);
+  EXPECT_EQ(bm->totloop, mesh->totloop);
+  EXPECT_EQ(bm->totface, mesh->totpoly);
+
+  /* Elements and custom-data blocks are created in parallel, but have to match the order of the
+   * mesh elements. */
+  const int cd_weight_offset = CustomData_get_offset(&bm->vdata, CD_PROP_FLOAT);
+  const int cd_uv_offset = CustomData_get_offset(&bm->ldata, CD_MLOOPUV);
+  ASSERT_NE(cd_weight_offset, -1);
+  ASSERT_NE(cd_uv_offset, -1);
+
+  BMIter iter;
+  BMVert *v;
+  int i;
+  BM_ITER_MESH_INDEX (v, &iter, bm, BM_VERTS_OF_MESH, i) {
+    EXPECT_EQ(BM_ELEM_CD_GET_FLOAT(v, cd_weight_offset), float(i));
+  }
+  BMFace *f;
+  BM_ITER_MESH_INDEX (f, &iter, bm, BM_FACES_OF_MESH, i) {
+    BMLoop *l_iter = BM_FACE_FIRST_LOOP(f);
+    for (const int j : IndexRange(4)) {
+      const MLoopUV *luv = (const MLoopUV *)BM_ELEM_CD_GET_VOID_P(l_iter, cd_uv_offset);
+      EXPECT_EQ(luv->uv[0], float(i));
+      EXPECT_EQ(luv->uv[1], float(j));
+      l_iter = l_iter->next;
+    }
+  }
+
+  BM_mesh_free(bm);
+  BKE_id_free(nullptr, mesh);
+}
+
+/**
+ * Compare the order of the disk and radial cycles of two BMesh with the same elements.
+ */
+static void expect_equal_cycles(BMesh *bm_a, BMesh *bm_b)
+{
+  BM_mesh_elem_index_ensure(bm_a, BM_ALL);
+  BM_mesh_elem_index_ensure(bm_b, BM_ALL);
+  BM_mesh_elem_table_ensure(bm_a, BM_VERT | BM_EDGE);
+  BM_mesh_elem_table_ensure(bm_b, BM_VERT | BM_EDGE);
+  ASSERT_EQ(bm_a->totvert, bm_b->totvert);
+  ASSERT_EQ(bm_a->totedge, bm_b->totedge);
+
+  for (const int i : IndexRange(bm_a->totvert)) {
+    BMVert *v_a = bm_a->vtable[i];
+    BMVert *v_b = bm_b->vtable[i];
+    EXPECT_EQ(BM_elem_flag_test(v_a, BM_ELEM_SELECT), BM_elem_flag_test(v_b, BM_ELEM_SELECT));
+    ASSERT_EQ(BM_vert_edge_count(v_a), BM_vert_edge_count(v_b));
+    if (v_a->e == nullptr) {
+      continue;
+    }
+    BMEdge *e_a = v_a->e;
+    BMEdge *e_b = v_b->e;
+    do {
+      EXPECT_EQ(BM_elem_index_get(e_a), BM_elem_index_get(e_b));
+      e_a = BM_DISK_EDGE_NEXT(e_a, v_a);
+      e_b = BM_DISK_EDGE_NEXT(e_b, v_b);
+    } while (e_a != v_a->e);
+  }
+  for (const int i : IndexRange(bm_a->totedge)) {
+    BMEdge *e_a = bm_a->etable[i];
+    BMEdge *e_b = bm_b->etable[i];
+    EXPECT_EQ(BM_elem_flag_test(e_a, BM_ELEM_SELECT), BM_elem_flag_test(e_b, BM_ELEM_SELECT));
+    ASSERT_EQ(BM_edge_face_count(e_a), BM_edge_face_count(e_b));
+    if (e_a->l == nullptr) {
+      continue;
+    }
+    BMLoop *l_a = e_a->l;
+    BMLoop *l_b = e_b->l;
+    do {
+      EXPECT_EQ(BM_elem_index_get(l_a), BM_elem_index_get(l_b));
+      EXPECT_EQ(BM_elem_index_get(l_a->f), BM_elem_index_get(l_b->f));
+      l_a = l_a->radial_next;
+      l_b = l_b->radial_next;
+    } while (l_a != e_a->l);
+  }
+  EXPECT_EQ(bm_a->totvertsel, bm_b->totvertsel);
+  EXPECT_EQ(bm_a->totedgesel, bm_b->totedgesel);
+  EXPECT_EQ(bm_a->totfacesel, bm_b->totfacesel);
+}
+
+TEST_F(bmesh_mesh_convert, FromMeshMatchesSerialCreation)
+{
+  Mesh *mesh = create_grid_mesh(16);
+  for (const int i : IndexRange(0, mesh->totvert / 3)) {
+    mesh->mvert[i * 3].flag |= SELECT;
+  }
+  for (const int i : IndexRange(0, mesh->totpoly / 5)) {
+    mesh->mpoly[i * 5].flag |= ME_FACE_SEL;
+  }
+
+  BMeshCreateParams create_params{};
+  create_params.use_toolflags = true;
+  BMeshFromMeshParams convert_params{};
+
+  BMesh *bm_parallel = BM_mesh_create(&bm_mesh_allocsize_default, &create_params);
+  BM_mesh_bm_from_me(bm_parallel, mesh, &convert_params);
+
+  /* Elements are only created in parallel in a new BMesh, an existing custom-data layer makes
+   * the conversion create elements one by one. */
+  BMesh *bm_serial = BM_mesh_create(&bm_mesh_allocsize_default, &create_params);
+  BM_data_layer_add(bm_serial, &bm_serial->vdata, CD_PROP_INT32);
+  BM_mesh_bm_from_me(bm_serial, mesh, &convert_params);
+
+  expect_equal_cycles(bm_parallel, bm_serial);
+
+  BM_mesh_free(bm_parallel);
+  BM_mesh_free(bm_serial);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST_F(bmesh_mesh_convert, ToMesh)
+{
+  Mesh *mesh = create_grid_mesh(512);
+
+  BMeshCreateParams create_params{};
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &create_params);
+  BMeshFromMeshParams from_mesh_params{};
+  BM_mesh_bm_from_me(bm, mesh, &from_mesh_params);
+
+  Mesh *result = BKE_mesh_new_nomain(0, 0, 0, 0, 0);
+  BMeshToMeshParams to_mesh_params{};
+  {
+    SCOPED_TIMER("BM_mesh_bm_to_me");
+    BM_mesh_bm_to_me(nullptr, bm, result, &to_mesh_params);
+  }
+
+  ASSERT_EQ(result->totvert, mesh->totvert);
+  ASSERT_EQ(result->totedge, mesh->totedge);
+  ASSERT_EQ(result->totloop, mesh->totloop);
+  ASSERT_EQ(result->totpoly, mesh->totpoly);
+  for (const int i : IndexRange(mesh->totvert)) {
+    EXPECT_EQ(result->mvert[i].co[0], mesh->mvert[i].co[0]);
+    EXPECT_EQ(result->mvert[i].co[1], mesh->mvert[i].co[1]);
+  }
+  for (const int i : IndexRange(mesh->totedge)) {
+    EXPECT_EQ(result->medge[i].v1, mesh->medge[i].v1);
+    EXPECT_EQ(result->medge[i].v2, mesh->medge[i].v2);
+  }
+  for (const int i : IndexRange(mesh->totpoly)) {
+    EXPECT_EQ(result->mpoly[i].loopstart, mesh->mpoly[i].loopstart);
+    EXPECT_EQ(result->mpoly[i].totloop, mesh->mpoly[i].totloop);
+  }
+  const MLoopUV *uvs = (const MLoopUV *)CustomData_get_layer(&mesh->ldata, CD_MLOOPUV);
+  const MLoopUV *result_uvs = (const MLoopUV *)CustomData_get_layer(&result->ldata, CD_MLOOPUV);
+  for (const int i : IndexRange(mesh->totloop)) {
+    EXPECT_EQ(result->mloop[i].v, mesh->mloop[i].v);
+    EXPECT_EQ(result->mloop[i].e, mesh->mloop[i].e);
+    EXPECT_EQ(result_uvs[i].uv[0], uvs[i].uv[0]);
+    EXPECT_EQ(result_uvs[i].uv[1], uvs[i].uv[1]);
+  }
+
+  BM_mesh_free(bm);
+  BKE_id_free(nullptr, result);
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::bmesh::tests
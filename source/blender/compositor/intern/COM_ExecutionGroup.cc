@@ -11,6 +11,7 @@
 #include "COM_defines.h"
 
 #include "BLI_rand.hh"
+#include "BLI_task.h"
 
 #include "BLT_translation.h"
 
@@ -356,7 +357,10 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
 
     WorkScheduler::finish();
 
-    if (bTree->test_break && bTree->test_break(bTree->tbh)) {
+    /* Work packages are skipped once the job is canceled, even when the tree has no way to
+     * test for it, so stop waiting for them to be executed. */
+    if ((bTree->test_break && bTree->test_break(bTree->tbh)) ||
+        BLI_task_cancel_token_is_canceled(BLI_task_cancel_token_current())) {
       breaked = true;
     }
   }
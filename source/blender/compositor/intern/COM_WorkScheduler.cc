@@ -395,6 +395,8 @@ static void threading_model_task_start()
 {
   BLI_thread_local_create(g_thread_device);
   g_work_scheduler.task.pool = BLI_task_pool_create(nullptr, TASK_PRIORITY_HIGH);
+  /* Skip work packages once the job is canceled, execution groups stop waiting for them. */
+  BLI_task_pool_cancel_token_set(g_work_scheduler.task.pool, BLI_task_cancel_token_current());
 }
 
 static void threading_model_task_finish()
@@ -18,6 +18,8 @@
 
 #include "BKE_global.h"
 
+#include "BLO_readfile.h"
+
 #include "DNA_node_types.h"
 #include "DNA_object_types.h"
 #include "DNA_scene_types.h"
@@ -318,6 +320,16 @@ void evaluate_graph_single_threaded(DepsgraphEvalState *state)
   BLI_gsqueue_free(evaluation_queue);
 }
 
+/* Read the data of original IDs which was deferred when opening the file. This modifies the
+ * original IDs, so it is done from the evaluating thread before copy-on-write runs on worker
+ * threads. */
+void depsgraph_ensure_lazy_data(Depsgraph *graph)
+{
+  for (IDNode *id_node : graph->id_nodes) {
+    BLO_lazy_data_ensure(id_node->id_orig);
+  }
+}
+
 void depsgraph_ensure_view_layer(Depsgraph *graph)
 {
   /* We update copy-on-write scene in the following cases:
@@ -360,6 +372,7 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
 #endif
 
   graph->is_evaluating = true;
+  depsgraph_ensure_lazy_data(graph);
   depsgraph_ensure_view_layer(graph);
   /* Set up evaluation state. */
   DepsgraphEvalState state;
@@ -377,7 +390,8 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   BLI_task_pool_work_and_wait(task_pool);
   BLI_task_pool_free(task_pool);
 
-  /* After that, process all other nodes. */
+  /* After that, process all other nodes. The cancel token of a job is not used here: callers
+   * (render, bake, compositor) expect a fully evaluated depsgraph once this returns. */
   state.stage = EvaluationStage::THREADED_EVALUATION;
   task_pool = deg_evaluate_task_pool_create(&state);
   schedule_graph(&state, schedule_node_to_pool, task_pool);
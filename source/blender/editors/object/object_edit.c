@@ -38,6 +38,8 @@
 
 #include "IMB_imbuf_types.h"
 
+#include "BLO_readfile.h"
+
 #include "BKE_anim_visualization.h"
 #include "BKE_armature.h"
 #include "BKE_collection.h"
@@ -753,6 +755,9 @@ bool ED_object_editmode_enter_ex(Main *bmain, Scene *scene, Object *ob, int flag
   if (ob->type == OB_MESH) {
     ok = true;
 
+    /* The geometry may not have been read from the file yet. */
+    BLO_lazy_data_ensure(ob->data);
+
     const bool use_key_index = mesh_needs_keyindex(bmain, ob->data);
 
     EDBM_mesh_make(ob, scene->toolsettings->selectmode, use_key_index);
@@ -436,6 +436,11 @@ class FieldEvaluator : NonMovable, NonCopyable {
    * some cases, so it must live at least as long as the returned mask.
    */
   IndexMask get_evaluated_as_mask(int field_index);
+  /**
+   * Same as #get_evaluated_as_mask, but the indices are stored in a compressed form and owned by
+   * the returned mask. Uses much less memory for selections made of runs of indices.
+   */
+  SegmentedIndexMask get_evaluated_as_segmented_mask(int field_index);
 };
 
 /**
@@ -52,6 +52,9 @@ class GVArrayImpl {
   virtual void materialize(const IndexMask mask, void *dst) const;
   virtual void materialize_to_uninitialized(const IndexMask mask, void *dst) const;
 
+  virtual void materialize_chunk(IndexRange range, void *dst) const;
+  virtual void materialize_chunk_to_uninitialized(IndexRange range, void *dst) const;
+
   virtual bool try_assign_VArray(void *varray) const;
   virtual bool may_have_ownership() const;
 };
@@ -134,6 +137,19 @@ class GVArrayCommon {
   void materialize_to_uninitialized(void *dst) const;
   void materialize_to_uninitialized(const IndexMask mask, void *dst) const;
 
+  /**
+   * Copy the values in the range into `dst`, the first value of the range being written to the
+   * start of the buffer. See #VArrayImpl::materialize_chunk.
+   */
+  void materialize_chunk(IndexRange range, void *dst) const;
+  void materialize_chunk_to_uninitialized(IndexRange range, void *dst) const;
+
+  /**
+   * Get the values in the range, either as a slice of the internal span or copied into the start
+   * of `r_buffer`, which has to be at least as large as the range.
+   */
+  GSpan get_internal_span_or_chunk(IndexRange range, GMutableSpan r_buffer) const;
+
   /**
    * Returns true when the virtual array is stored as a span internally.
    */
@@ -337,6 +353,16 @@ template<typename T> class GVArrayImpl_For_VArray : public GVArrayImpl {
     varray_.materialize_to_uninitialized(mask, MutableSpan((T *)dst, mask.min_array_size()));
   }
 
+  void materialize_chunk(const IndexRange range, void *dst) const override
+  {
+    varray_.materialize_chunk(range, MutableSpan((T *)dst, range.size()));
+  }
+
+  void materialize_chunk_to_uninitialized(const IndexRange range, void *dst) const override
+  {
+    varray_.materialize_chunk_to_uninitialized(range, MutableSpan((T *)dst, range.size()));
+  }
+
   bool try_assign_VArray(void *varray) const override
   {
     *(VArray<T> *)varray = varray_;
@@ -391,6 +417,17 @@ template<typename T> class VArrayImpl_For_GVArray : public VArrayImpl<T> {
     return value;
   }
 
+  void materialize_chunk(const IndexRange range, MutableSpan<T> r_chunk) const override
+  {
+    varray_.materialize_chunk(range, r_chunk.data());
+  }
+
+  void materialize_chunk_to_uninitialized(const IndexRange range,
+                                          MutableSpan<T> r_chunk) const override
+  {
+    varray_.materialize_chunk_to_uninitialized(range, r_chunk.data());
+  }
+
   bool try_assign_GVArray(GVArray &varray) const override
   {
     varray = varray_;
@@ -480,6 +517,16 @@ template<typename T> class GVMutableArrayImpl_For_VMutableArray : public GVMutab
     varray_.materialize_to_uninitialized(mask, MutableSpan((T *)dst, mask.min_array_size()));
   }
 
+  void materialize_chunk(const IndexRange range, void *dst) const override
+  {
+    varray_.materialize_chunk(range, MutableSpan((T *)dst, range.size()));
+  }
+
+  void materialize_chunk_to_uninitialized(const IndexRange range, void *dst) const override
+  {
+    varray_.materialize_chunk_to_uninitialized(range, MutableSpan((T *)dst, range.size()));
+  }
+
   bool try_assign_VArray(void *varray) const override
   {
     *(VArray<T> *)varray = varray_;
@@ -546,6 +593,17 @@ template<typename T> class VMutableArrayImpl_For_GVMutableArray : public VMutabl
     return value;
   }
 
+  void materialize_chunk(const IndexRange range, MutableSpan<T> r_chunk) const override
+  {
+    varray_.materialize_chunk(range, r_chunk.data());
+  }
+
+  void materialize_chunk_to_uninitialized(const IndexRange range,
+                                          MutableSpan<T> r_chunk) const override
+  {
+    varray_.materialize_chunk_to_uninitialized(range, r_chunk.data());
+  }
+
   bool try_assign_GVArray(GVArray &varray) const override
   {
     varray = varray_;
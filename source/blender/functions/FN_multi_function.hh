@@ -31,6 +31,7 @@
  */
 
 #include "BLI_hash.hh"
+#include "BLI_segmented_index_mask.hh"
 
 #include "FN_multi_function_context.hh"
 #include "FN_multi_function_params.hh"
@@ -53,6 +54,11 @@ class MultiFunction {
    *   unused.
    */
   void call_auto(IndexMask mask, MFParams params, MFContext context) const;
+  /**
+   * Same as above, the function is called once for every part of the segmented mask, so that
+   * ranges of indices are processed with the fast code path for ranges.
+   */
+  void call_auto(const SegmentedIndexMask &mask, MFParams params, MFContext context) const;
   virtual void call(IndexMask mask, MFParams params, MFContext context) const = 0;
 
   virtual uint64_t hash() const
@@ -47,6 +47,21 @@ template<typename In1, typename Out1> class CustomMF_SI_SO : public MultiFunctio
   template<typename ElementFuncT> static FunctionT create_function(ElementFuncT element_fn)
   {
     return [=](IndexMask mask, const VArray<In1> &in1, MutableSpan<Out1> out1) {
+      if (mask.is_range() && !in1.is_span() && !in1.is_single()) {
+        /* Copy the input into a small buffer one chunk at a time, instead of calling a virtual
+         * method for every element. */
+        const IndexRange range = mask.as_range();
+        Array<In1, varray_chunk_size<In1>> buffer1(varray_chunk_size<In1>);
+        for (int64_t start = 0; start < range.size(); start += buffer1.size()) {
+          const IndexRange chunk = range.slice(start,
+                                               std::min(buffer1.size(), range.size() - start));
+          const Span<In1> in1_chunk = in1.get_internal_span_or_chunk(chunk, buffer1);
+          for (const int64_t i : in1_chunk.index_range()) {
+            new (static_cast<void *>(&out1[chunk[i]])) Out1(element_fn(in1_chunk[i]));
+          }
+        }
+        return;
+      }
       /* Devirtualization results in a 2-3x speedup for some simple functions. */
       devirtualize_varray(in1, [&](const auto &in1) {
         mask.foreach_index(
@@ -100,6 +115,26 @@ class CustomMF_SI_SI_SO : public MultiFunction {
                const VArray<In1> &in1,
                const VArray<In2> &in2,
                MutableSpan<Out1> out1) {
+      const bool is_devirtualizable1 = in1.is_span() || in1.is_single();
+      const bool is_devirtualizable2 = in2.is_span() || in2.is_single();
+      if (mask.is_range() && !(is_devirtualizable1 && is_devirtualizable2)) {
+        /* Inputs that are not spans are copied into small buffers one chunk at a time, instead of
+         * calling a virtual method for every element. */
+        constexpr int64_t chunk_size = std::min(varray_chunk_size<In1>, varray_chunk_size<In2>);
+        const IndexRange range = mask.as_range();
+        Array<In1, chunk_size> buffer1(chunk_size);
+        Array<In2, chunk_size> buffer2(chunk_size);
+        for (int64_t start = 0; start < range.size(); start += chunk_size) {
+          const IndexRange chunk = range.slice(start, std::min(chunk_size, range.size() - start));
+          const Span<In1> in1_chunk = in1.get_internal_span_or_chunk(chunk, buffer1);
+          const Span<In2> in2_chunk = in2.get_internal_span_or_chunk(chunk, buffer2);
+          for (const int64_t i : IndexRange(chunk.size())) {
+            new (static_cast<void *>(&out1[chunk[i]]))
+                Out1(element_fn(in1_chunk[i], in2_chunk[i]));
+          }
+        }
+        return;
+      }
       /* Devirtualization results in a 2-3x speedup for some simple functions. */
       devirtualize_varray2(in1, in2, [&](const auto &in1, const auto &in2) {
         mask.foreach_index(
@@ -803,6 +803,20 @@ IndexMask FieldEvaluator::get_evaluated_as_mask(const int field_index)
   return scope_.add_value(indices_from_selection(mask_, varray)).as_span();
 }
 
+SegmentedIndexMask FieldEvaluator::get_evaluated_as_segmented_mask(const int field_index)
+{
+  VArray<bool> varray = this->get_evaluated(field_index).typed<bool>();
+
+  if (varray.is_single()) {
+    if (varray.get_internal_single()) {
+      return SegmentedIndexMask(varray.size());
+    }
+    return {};
+  }
+
+  return SegmentedIndexMask::from_bools(mask_, varray);
+}
+
 IndexMask FieldEvaluator::get_evaluated_selection_as_mask()
 {
   BLI_assert(is_evaluated_);
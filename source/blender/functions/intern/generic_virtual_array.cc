@@ -24,6 +24,46 @@ void GVArrayImpl::materialize_to_uninitialized(const IndexMask mask, void *dst)
   }
 }
 
+void GVArrayImpl::materialize_chunk(const IndexRange range, void *dst) const
+{
+  if (this->is_span()) {
+    const GSpan span = this->get_internal_span().slice(range);
+    type_->copy_assign_n(span.data(), dst, range.size());
+  }
+  else if (this->is_single()) {
+    BUFFER_FOR_CPP_TYPE_VALUE(*type_, buffer);
+    type_->default_construct(buffer);
+    this->get_internal_single(buffer);
+    type_->fill_assign_n(buffer, dst, range.size());
+    type_->destruct(buffer);
+  }
+  else {
+    for (const int64_t i : IndexRange(range.size())) {
+      this->get(range[i], POINTER_OFFSET(dst, type_->size() * i));
+    }
+  }
+}
+
+void GVArrayImpl::materialize_chunk_to_uninitialized(const IndexRange range, void *dst) const
+{
+  if (this->is_span()) {
+    const GSpan span = this->get_internal_span().slice(range);
+    type_->copy_construct_n(span.data(), dst, range.size());
+  }
+  else if (this->is_single()) {
+    BUFFER_FOR_CPP_TYPE_VALUE(*type_, buffer);
+    type_->default_construct(buffer);
+    this->get_internal_single(buffer);
+    type_->fill_construct_n(buffer, dst, range.size());
+    type_->destruct(buffer);
+  }
+  else {
+    for (const int64_t i : IndexRange(range.size())) {
+      this->get_to_uninitialized(range[i], POINTER_OFFSET(dst, type_->size() * i));
+    }
+  }
+}
+
 void GVArrayImpl::get(const int64_t index, void *r_value) const
 {
   type_->destruct(r_value);
@@ -451,6 +491,17 @@ class GVArrayImpl_For_SlicedGVArray : public GVArrayImpl {
   {
     varray_.get_internal_single(r_value);
   }
+
+  void materialize_chunk(const IndexRange range, void *dst) const override
+  {
+    varray_.materialize_chunk(IndexRange(range.start() + offset_, range.size()), dst);
+  }
+
+  void materialize_chunk_to_uninitialized(const IndexRange range, void *dst) const override
+  {
+    varray_.materialize_chunk_to_uninitialized(
+        IndexRange(range.start() + offset_, range.size()), dst);
+  }
 };
 
 /** \} */
@@ -508,6 +559,30 @@ void GVArrayCommon::materialize_to_uninitialized(const IndexMask mask, void *dst
   impl_->materialize_to_uninitialized(mask, dst);
 }
 
+void GVArrayCommon::materialize_chunk(const IndexRange range, void *dst) const
+{
+  BLI_assert(range.one_after_last() <= impl_->size());
+  impl_->materialize_chunk(range, dst);
+}
+
+void GVArrayCommon::materialize_chunk_to_uninitialized(const IndexRange range, void *dst) const
+{
+  BLI_assert(range.one_after_last() <= impl_->size());
+  impl_->materialize_chunk_to_uninitialized(range, dst);
+}
+
+GSpan GVArrayCommon::get_internal_span_or_chunk(const IndexRange range,
+                                                const GMutableSpan r_buffer) const
+{
+  BLI_assert(range.one_after_last() <= impl_->size());
+  BLI_assert(r_buffer.type() == impl_->type());
+  if (impl_->is_span()) {
+    return impl_->get_internal_span().slice(range);
+  }
+  impl_->materialize_chunk(range, r_buffer.data());
+  return GSpan(r_buffer.type(), r_buffer.data(), range.size());
+}
+
 bool GVArrayCommon::may_have_ownership() const
 {
   return impl_->may_have_ownership();
@@ -34,13 +34,13 @@ static bool supports_threading_by_slicing_params(const MultiFunction &fn)
   return true;
 }
 
-static int64_t compute_grain_size(const ExecutionHints &hints, const IndexMask mask)
+static int64_t compute_grain_size(const ExecutionHints &hints, const int64_t mask_size)
 {
   int64_t grain_size = hints.min_grain_size;
   if (hints.uniform_execution_time) {
     const int thread_count = BLI_system_thread_count();
     /* Avoid using a small grain size even if it is not necessary. */
-    const int64_t thread_based_grain_size = mask.size() / thread_count / 4;
+    const int64_t thread_based_grain_size = mask_size / thread_count / 4;
     grain_size = std::max(grain_size, thread_based_grain_size);
   }
   if (hints.allocates_array) {
@@ -58,7 +58,7 @@ void MultiFunction::call_auto(IndexMask mask, MFParams params, MFContext context
     return;
   }
   const ExecutionHints hints = this->execution_hints();
-  const int64_t grain_size = compute_grain_size(hints, mask);
+  const int64_t grain_size = compute_grain_size(hints, mask.size());
 
   if (mask.size() <= grain_size) {
     this->call(mask, params, context);
@@ -131,6 +131,32 @@ void MultiFunction::call_auto(IndexMask mask, MFParams params, MFContext context
   });
 }
 
+void MultiFunction::call_auto(const SegmentedIndexMask &mask,
+                              MFParams params,
+                              MFContext context) const
+{
+  if (mask.is_empty()) {
+    return;
+  }
+  if (mask.is_range()) {
+    this->call_auto(mask.as_range(), params, context);
+    return;
+  }
+
+  if (!supports_threading_by_slicing_params(*this)) {
+    mask.foreach_segment_as_mask(
+        [&](const IndexMask segment_mask) { this->call(segment_mask, params, context); });
+    return;
+  }
+
+  const ExecutionHints hints = this->execution_hints();
+  const int64_t grain_size = compute_grain_size(hints, mask.size());
+  mask.foreach_segment_as_mask_parallel(grain_size, [&](const IndexMask segment_mask) {
+    /* Still handles the offsetting of large segments. */
+    this->call_auto(segment_mask, params, context);
+  });
+}
+
 std::string MultiFunction::debug_name() const
 {
   return signature_ref_->function_name;
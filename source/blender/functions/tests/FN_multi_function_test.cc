@@ -60,6 +60,34 @@ TEST(multi_function, AddFunction)
   EXPECT_EQ(output[2], 36);
 }
 
+TEST(multi_function, CallAutoSegmentedMask)
+{
+  AddFunction fn;
+
+  const int64_t size = 100000;
+  Array<int> input1(size, 1);
+  Array<int> input2(size);
+  for (const int64_t i : input2.index_range()) {
+    input2[i] = int(i);
+  }
+  Array<int> output(size, -1);
+
+  MFParamsBuilder params(fn, size);
+  params.add_readonly_single_input(input1.as_span());
+  params.add_readonly_single_input(input2.as_span());
+  params.add_uninitialized_single_output(output.as_mutable_span());
+
+  MFContextBuilder context;
+
+  const SegmentedIndexMask mask = SegmentedIndexMask::from_predicate(
+      IndexMask(size), [](const int64_t i) { return i < 50000 || i % 3 == 0; });
+  fn.call_auto(mask, params, context);
+
+  for (const int64_t i : output.index_range()) {
+    EXPECT_EQ(output[i], (i < 50000 || i % 3 == 0) ? int(i) + 1 : -1);
+  }
+}
+
 TEST(multi_function, AddPrefixFunction)
 {
   AddPrefixFunction fn;
@@ -194,6 +222,34 @@ TEST(multi_function, CustomMF_SI_SI_SO)
   EXPECT_EQ(outputs[3], 90);
 }
 
+TEST(multi_function, CustomMF_SI_SI_SO_Chunked)
+{
+  CustomMF_SI_SI_SO<int, int, int> fn("add", [](int a, int b) { return a + b; });
+
+  /* Use more elements than fit into a single chunk. */
+  const int64_t size = varray_chunk_size<int> * 2 + 10;
+  Array<int> values_b(size);
+  for (const int64_t i : values_b.index_range()) {
+    values_b[i] = int(i) * 2;
+  }
+  Array<int> outputs(size, -1);
+
+  MFParamsBuilder params(fn, size);
+  params.add_readonly_single_input(
+      VArray<int>::ForFunc(size, [](const int64_t i) { return int(i) * 3; }));
+  params.add_readonly_single_input(values_b.as_span());
+  params.add_uninitialized_single_output(outputs.as_mutable_span());
+
+  MFContextBuilder context;
+
+  fn.call(IndexRange(5, size - 5), params, context);
+
+  EXPECT_EQ(outputs[4], -1);
+  for (const int64_t i : IndexRange(5, size - 5)) {
+    EXPECT_EQ(outputs[i], i * 5);
+  }
+}
+
 TEST(multi_function, CustomMF_SI_SI_SI_SO)
 {
   CustomMF_SI_SI_SI_SO<int, std::string, bool, uint> fn{
@@ -0,0 +1,25 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+#include "BLI_math_vec_types.hh"
+#include "BLI_span.hh"
+
+/** \file
+ * \ingroup geo
+ */
+
+namespace blender::geometry {
+
+/**
+ * Eliminate points until no two of the remaining points are closer than \a minimum_distance.
+ * Points that are already eliminated in the mask are ignored. Points are visited in an order that
+ * only depends on their positions and indices, every visited point that has not been eliminated
+ * yet eliminates all points within the distance. Therefore the result is deterministic, even
+ * though independent parts of the points are processed in parallel.
+ */
+void eliminate_close_points(Span<float3> positions,
+                            float minimum_distance,
+                            MutableSpan<bool> elimination_mask);
+
+}  // namespace blender::geometry
@@ -1,6 +1,7 @@
 /* SPDX-License-Identifier: GPL-2.0-or-later */
 
 #include "BLI_index_mask.hh"
+#include "BLI_math_vec_types.hh"
 
 #pragma once
 
@@ -13,6 +14,23 @@ class PointCloudComponent;
 
 namespace blender::geometry {
 
+/**
+ * Find points that are within \a merge_distance of each other. A point that is not merged yet
+ * becomes the target of all unmerged points in range, like in
+ * #BLI_kdtree_3d_calc_duplicates_fast. A #SpatialGrid with cells as large as the merge distance is
+ * used, so the points are visited cell by cell and which point of a cluster becomes the target can
+ * differ from the KD-tree (see #SpatialGrid::calc_duplicates). When the points are spread over too
+ * large an area for such cells, the KD-tree is used instead. Either way, the result does not
+ * depend on the number of threads.
+ *
+ * \param r_merge_indices: The point every point is merged into, -1 for points that aren't
+ * changed. Has to be initialized, see #BLI_kdtree_3d_calc_duplicates_fast.
+ * \returns The number of merged points.
+ */
+int calc_merge_indices(Span<float3> positions,
+                       float merge_distance,
+                       MutableSpan<int> r_merge_indices);
+
 /**
  * Merge selected points into other selected points within the \a merge_distance. The merged
  * indices favor speed over accuracy, since the results will depend on the order of the points.
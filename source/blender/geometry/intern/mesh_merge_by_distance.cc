@@ -1,10 +1,11 @@
 /* SPDX-License-Identifier: GPL-2.0-or-later */
 
 #include "BLI_array.hh"
+#include "BLI_concurrent_map.hh"
 #include "BLI_index_mask.hh"
-#include "BLI_kdtree.h"
 #include "BLI_math_vector.h"
 #include "BLI_math_vector.hh"
+#include "BLI_task.hh"
 #include "BLI_vector.hh"
 
 #include "DNA_mesh_types.h"
@@ -14,6 +15,7 @@
 #include "BKE_mesh.h"
 
 #include "GEO_mesh_merge_by_distance.hh"
+#include "GEO_point_merge_by_distance.hh"
 
 //#define USE_WELD_DEBUG
 //#define USE_WELD_NORMALS
@@ -429,114 +431,84 @@ static Vector<WeldEdge> weld_edge_ctx_alloc(Span<MEdge> medge,
   return wedge;
 }
 
-static void weld_edge_ctx_setup(MutableSpan<WeldGroup> r_vlinks,
-                                MutableSpan<int> r_edge_dest_map,
-                                MutableSpan<WeldEdge> r_wedge,
-                                int *r_edge_kiil_len)
-{
-  /* Setup Edge Overlap. */
-  int edge_kill_len = 0;
+/** Identifies the edges that are merged, independent of the order of their vertices. */
+struct WeldEdgeKey {
+  int v_low, v_high;
 
-  MutableSpan<WeldGroup> v_links = r_vlinks;
-
-  for (WeldEdge &we : r_wedge) {
-    int dst_vert_a = we.vert_a;
-    int dst_vert_b = we.vert_b;
-
-    if (dst_vert_a == dst_vert_b) {
-      BLI_assert(we.edge_dest == OUT_OF_CONTEXT);
-      r_edge_dest_map[we.edge_orig] = ELEM_COLLAPSED;
-      we.flag = ELEM_COLLAPSED;
-      edge_kill_len++;
-      continue;
-    }
-
-    v_links[dst_vert_a].len++;
-    v_links[dst_vert_b].len++;
+  WeldEdgeKey(const int v1, const int v2) : v_low(std::min(v1, v2)), v_high(std::max(v1, v2))
+  {
   }
 
-  int link_len = 0;
-  for (WeldGroup &vl : r_vlinks) {
-    vl.ofs = link_len;
-    link_len += vl.len;
+  uint64_t hash() const
+  {
+    return get_default_hash_2(v_low, v_high);
   }
 
-  if (link_len > 0) {
-    Array<int> link_edge_buffer(link_len);
+  friend bool operator==(const WeldEdgeKey &a, const WeldEdgeKey &b)
+  {
+    return a.v_low == b.v_low && a.v_high == b.v_high;
+  }
+};
 
-    for (const int i : r_wedge.index_range()) {
-      const WeldEdge &we = r_wedge[i];
-      if (we.flag == ELEM_COLLAPSED) {
-        continue;
+static void weld_edge_ctx_setup(MutableSpan<int> r_edge_dest_map,
+                                MutableSpan<WeldEdge> r_wedge,
+                                int *r_edge_kiil_len)
+{
+  /* Setup Edge Overlap. */
+  threading::parallel_for(r_wedge.index_range(), 4096, [&](const IndexRange range) {
+    for (WeldEdge &we : r_wedge.slice(range)) {
+      if (we.vert_a == we.vert_b) {
+        BLI_assert(we.edge_dest == OUT_OF_CONTEXT);
+        r_edge_dest_map[we.edge_orig] = ELEM_COLLAPSED;
+        we.flag = ELEM_COLLAPSED;
       }
-
-      int dst_vert_a = we.vert_a;
-      int dst_vert_b = we.vert_b;
-
-      link_edge_buffer[v_links[dst_vert_a].ofs++] = i;
-      link_edge_buffer[v_links[dst_vert_b].ofs++] = i;
-    }
-
-    for (WeldGroup &vl : r_vlinks) {
-      /* Fix offset */
-      vl.ofs -= vl.len;
     }
-
-    for (const int i : r_wedge.index_range()) {
-      const WeldEdge &we = r_wedge[i];
-      if (we.edge_dest != OUT_OF_CONTEXT) {
-        /* No need to retest edges.
-         * (Already includes collapsed edges). */
-        continue;
-      }
-
-      int dst_vert_a = we.vert_a;
-      int dst_vert_b = we.vert_b;
-
-      struct WeldGroup *link_a = &v_links[dst_vert_a];
-      struct WeldGroup *link_b = &v_links[dst_vert_b];
-
-      int edges_len_a = link_a->len;
-      int edges_len_b = link_b->len;
-
-      if (edges_len_a <= 1 || edges_len_b <= 1) {
-        continue;
-      }
-
-      int *edges_ctx_a = &link_edge_buffer[link_a->ofs];
-      int *edges_ctx_b = &link_edge_buffer[link_b->ofs];
-      int edge_orig = we.edge_orig;
-
-      for (; edges_len_a--; edges_ctx_a++) {
-        int e_ctx_a = *edges_ctx_a;
-        if (e_ctx_a == i) {
-          continue;
-        }
-        while (edges_len_b && *edges_ctx_b < e_ctx_a) {
-          edges_ctx_b++;
-          edges_len_b--;
-        }
-        if (edges_len_b == 0) {
-          break;
+  });
+
+  /* Find the first edge of every group of edges that connect the same vertices after welding,
+   * all other edges of the group are merged into it. */
+  using EdgeMap = ConcurrentMap<WeldEdgeKey, int>;
+  EdgeMap first_edge_map(r_wedge.size() < 4096 ? 1 : EdgeMap::default_shards_num);
+  first_edge_map.add_parallel(
+      r_wedge.index_range(),
+      4096,
+      [&](const IndexRange range, EdgeMap::ParallelAdder &adder) {
+        for (const int i : range) {
+          const WeldEdge &we = r_wedge[i];
+          if (we.flag != ELEM_COLLAPSED) {
+            adder.add(WeldEdgeKey(we.vert_a, we.vert_b), i);
+          }
         }
-        int e_ctx_b = *edges_ctx_b;
-        if (e_ctx_a == e_ctx_b) {
-          WeldEdge *we_b = &r_wedge[e_ctx_b];
-          BLI_assert(ELEM(we_b->vert_a, dst_vert_a, dst_vert_b));
-          BLI_assert(ELEM(we_b->vert_b, dst_vert_a, dst_vert_b));
-          BLI_assert(we_b->edge_dest == OUT_OF_CONTEXT);
-          BLI_assert(we_b->edge_orig != edge_orig);
-          r_edge_dest_map[we_b->edge_orig] = edge_orig;
-          we_b->edge_dest = edge_orig;
-          edge_kill_len++;
+      },
+      [](int &first_edge, const int edge) { first_edge = std::min(first_edge, edge); });
+
+  const int edge_kill_len = threading::parallel_reduce(
+      r_wedge.index_range(),
+      4096,
+      0,
+      [&](const IndexRange range, int kill_len) {
+        for (const int i : range) {
+          WeldEdge &we = r_wedge[i];
+          if (we.flag == ELEM_COLLAPSED) {
+            kill_len++;
+            continue;
+          }
+          const int first_edge = first_edge_map.lookup(WeldEdgeKey(we.vert_a, we.vert_b));
+          if (first_edge != i) {
+            const int edge_orig = r_wedge[first_edge].edge_orig;
+            BLI_assert(we.edge_orig != edge_orig);
+            r_edge_dest_map[we.edge_orig] = edge_orig;
+            we.edge_dest = edge_orig;
+            kill_len++;
+          }
         }
-      }
-    }
+        return kill_len;
+      },
+      std::plus<int>());
 
 #ifdef USE_WELD_DEBUG
-    weld_assert_edge_kill_len(r_wedge, edge_kill_len);
+  weld_assert_edge_kill_len(r_wedge, edge_kill_len);
 #endif
-  }
 
   *r_edge_kiil_len = edge_kill_len;
 }
@@ -1208,11 +1180,12 @@ static void weld_mesh_context_create(const Mesh &mesh,
   Array<int> edge_ctx_map(medge.size());
   Vector<WeldEdge> wedge = weld_edge_ctx_alloc(medge, vert_dest_map, edge_dest_map, edge_ctx_map);
 
-  Array<WeldGroup> v_links(mvert_len, {0, 0});
-  weld_edge_ctx_setup(v_links, edge_dest_map, wedge, &r_weld_mesh->edge_kill_len);
+  weld_edge_ctx_setup(edge_dest_map, wedge, &r_weld_mesh->edge_kill_len);
 
   weld_poly_loop_ctx_alloc(mpoly, mloop, vert_dest_map, edge_dest_map, r_weld_mesh);
 
+  Array<WeldGroup> v_links(mvert_len, {0, 0});
+
   weld_poly_loop_ctx_setup(mloop,
 #ifdef USE_WELD_DEBUG
                            mpoly,
@@ -1600,18 +1573,26 @@ std::optional<Mesh *> mesh_merge_by_distance_all(const Mesh &mesh,
                                                  const IndexMask selection,
                                                  const float merge_distance)
 {
-  Array<int> vert_dest_map(mesh.totvert, OUT_OF_CONTEXT);
-
-  KDTree_3d *tree = BLI_kdtree_3d_new(selection.size());
-
-  for (const int i : selection) {
-    BLI_kdtree_3d_insert(tree, i, mesh.mvert[i].co);
-  }
+  Array<float3> selected_positions(selection.size());
+  threading::parallel_for(selection.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      selected_positions[i] = mesh.mvert[selection[i]].co;
+    }
+  });
+  Array<int> selection_dest_map(selection.size(), OUT_OF_CONTEXT);
+  const int vert_kill_len = calc_merge_indices(
+      selected_positions, merge_distance, selection_dest_map);
 
-  BLI_kdtree_3d_balance(tree);
-  const int vert_kill_len = BLI_kdtree_3d_calc_duplicates_fast(
-      tree, merge_distance, false, vert_dest_map.data());
-  BLI_kdtree_3d_free(tree);
+  /* Convert from indices into the selection to vertex indices. */
+  Array<int> vert_dest_map(mesh.totvert, OUT_OF_CONTEXT);
+  threading::parallel_for(selection.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      const int dest = selection_dest_map[i];
+      if (dest != OUT_OF_CONTEXT) {
+        vert_dest_map[selection[i]] = selection[dest];
+      }
+    }
+  });
 
   if (vert_kill_len == 0) {
     return std::nullopt;
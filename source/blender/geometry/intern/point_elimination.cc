@@ -0,0 +1,63 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "BLI_array.hh"
+#include "BLI_spatial_grid.hh"
+#include "BLI_task.hh"
+
+#include "GEO_point_elimination.hh"
+
+/**
+ * The points are sorted into a uniform grid whose cells are at least as large as the minimum
+ * distance, so that close points are always in the same or in adjacent cells. Cells whose
+ * neighborhoods don't overlap are processed in parallel.
+ */
+
+namespace blender::geometry {
+
+void eliminate_close_points(const Span<float3> positions,
+                            const float minimum_distance,
+                            MutableSpan<bool> elimination_mask)
+{
+  BLI_assert(positions.size() == elimination_mask.size());
+  if (minimum_distance <= 0.0f || positions.is_empty()) {
+    return;
+  }
+  const SpatialGrid grid(positions, minimum_distance);
+  const Span<float3> sorted_positions = grid.sorted_positions();
+  const Span<int> sorted_indices = grid.sorted_indices();
+
+  /* Copy the mask in the sorted order, so that the points in a cell are contiguous in memory. */
+  Array<bool> sorted_mask(positions.size());
+  threading::parallel_for(sorted_mask.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      sorted_mask[i] = elimination_mask[sorted_indices[i]];
+    }
+  });
+
+  const float minimum_distance_sq = minimum_distance * minimum_distance;
+  grid.foreach_cell_neighborhood(
+      [&](const IndexRange cell_points, const Span<IndexRange> neighbor_points) {
+        for (const int i : cell_points) {
+          if (sorted_mask[i]) {
+            continue;
+          }
+          const float3 position = sorted_positions[i];
+          for (const IndexRange neighbors : neighbor_points) {
+            for (const int neighbor : neighbors) {
+              if (neighbor != i && math::distance_squared(position, sorted_positions[neighbor]) <=
+                                       minimum_distance_sq) {
+                sorted_mask[neighbor] = true;
+              }
+            }
+          }
+        }
+      });
+
+  threading::parallel_for(sorted_mask.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      elimination_mask[sorted_indices[i]] = sorted_mask[i];
+    }
+  });
+}
+
+}  // namespace blender::geometry
@@ -1,6 +1,7 @@
 /* SPDX-License-Identifier: GPL-2.0-or-later */
 
 #include "BLI_kdtree.h"
+#include "BLI_spatial_grid.hh"
 #include "BLI_task.hh"
 
 #include "DNA_pointcloud_types.h"
@@ -13,6 +14,30 @@
 
 namespace blender::geometry {
 
+int calc_merge_indices(const Span<float3> positions,
+                       const float merge_distance,
+                       MutableSpan<int> r_merge_indices)
+{
+  BLI_assert(positions.size() == r_merge_indices.size());
+  /* With larger cells, clusters of points could end up in very few cells. Only the bounds are
+   * needed to find that out, so it is checked before building the grid. */
+  if (merge_distance > 0.0f &&
+      SpatialGrid::calc_cell_size(positions, merge_distance) == merge_distance) {
+    const SpatialGrid grid(positions, merge_distance);
+    return grid.calc_duplicates(merge_distance, r_merge_indices);
+  }
+
+  KDTree_3d *tree = BLI_kdtree_3d_new(positions.size());
+  for (const int i : positions.index_range()) {
+    BLI_kdtree_3d_insert(tree, i, positions[i]);
+  }
+  BLI_kdtree_3d_balance(tree);
+  const int duplicate_count = BLI_kdtree_3d_calc_duplicates_fast(
+      tree, merge_distance, false, r_merge_indices.data());
+  BLI_kdtree_3d_free(tree);
+  return duplicate_count;
+}
+
 PointCloud *point_merge_by_distance(const PointCloudComponent &src_points,
                                     const float merge_distance,
                                     const IndexMask selection)
@@ -21,21 +46,17 @@ PointCloud *point_merge_by_distance(const PointCloudComponent &src_points,
   const int src_size = src_pointcloud.totpoint;
   Span<float3> positions{reinterpret_cast<float3 *>(src_pointcloud.co), src_size};
 
-  /* Create the KD tree based on only the selected points, to speed up merge detection and
-   * balancing. */
-  KDTree_3d *tree = BLI_kdtree_3d_new(selection.size());
-  for (const int i : selection.index_range()) {
-    BLI_kdtree_3d_insert(tree, i, positions[selection[i]]);
-  }
-  BLI_kdtree_3d_balance(tree);
-
-  /* Find the duplicates in the KD tree. Because the tree only contains the selected points, the
-   * resulting indices are indices into the selection, rather than indices of the source point
-   * cloud. */
+  /* Find the duplicates in only the selected points, to speed up merge detection. The resulting
+   * indices are indices into the selection, rather than indices of the source point cloud. */
+  Array<float3> selected_positions(selection.size());
+  threading::parallel_for(selection.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      selected_positions[i] = positions[selection[i]];
+    }
+  });
   Array<int> selection_merge_indices(selection.size(), -1);
-  const int duplicate_count = BLI_kdtree_3d_calc_duplicates_fast(
-      tree, merge_distance, false, selection_merge_indices.data());
-  BLI_kdtree_3d_free(tree);
+  const int duplicate_count = calc_merge_indices(
+      selected_positions, merge_distance, selection_merge_indices);
 
   /* Create the new point cloud and add it to a temporary component for the attribute API. */
   const int dst_size = src_size - duplicate_count;
@@ -739,6 +739,13 @@ enum {
    * The data-block is a library override that needs re-sync to its linked reference.
    */
   LIB_TAG_LIB_OVERRIDE_NEED_RESYNC = 1 << 21,
+
+  /**
+   * Some data of this data-block has not been read from its file yet (see #BLO_READ_LAZY_DATA),
+   * use #BLO_lazy_data_ensure before accessing it.
+   * Kept in undo steps, so that undoing doesn't lose track of the data still in the file.
+   */
+  LIB_TAG_LAZY_DATA = 1 << 22,
 };
 
 /* Tag given ID for an update in all the dependency graphs. */
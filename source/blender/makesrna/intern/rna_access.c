@@ -38,6 +38,8 @@
 #include "BKE_node.h"
 #include "BKE_report.h"
 
+#include "BLO_readfile.h"
+
 #include "DEG_depsgraph.h"
 #include "DEG_depsgraph_build.h"
 
@@ -3627,6 +3629,18 @@ static void rna_property_collection_get_idp(CollectionPropertyIterator *iter)
   rna_pointer_inherit_id(cprop->item_type, &iter->parent, &iter->ptr);
 }
 
+/**
+ * Data of an ID which was deferred when reading its file (see #BLO_lazy_data_ensure) is only
+ * reached through collections (mesh elements and layers) and functions, so it is read when those
+ * are accessed rather than whenever a pointer to the ID is created.
+ */
+static void rna_lazy_data_ensure(const PointerRNA *ptr)
+{
+  if (ptr->owner_id != NULL) {
+    BLO_lazy_data_ensure(ptr->owner_id);
+  }
+}
+
 void RNA_property_collection_begin(PointerRNA *ptr,
                                    PropertyRNA *prop,
                                    CollectionPropertyIterator *iter)
@@ -3635,6 +3649,8 @@ void RNA_property_collection_begin(PointerRNA *ptr,
 
   BLI_assert(RNA_property_type(prop) == PROP_COLLECTION);
 
+  rna_lazy_data_ensure(ptr);
+
   memset(iter, 0, sizeof(*iter));
 
   if ((idprop = rna_idproperty_check(&prop, ptr)) || (prop->flag & PROP_IDPROPERTY)) {
@@ -3725,6 +3741,7 @@ int RNA_property_collection_length(PointerRNA *ptr, PropertyRNA *prop)
     return idprop->len;
   }
   if (cprop->length) {
+    rna_lazy_data_ensure(ptr);
     return cprop->length(ptr);
   }
   CollectionPropertyIterator iter;
@@ -4044,6 +4061,7 @@ int RNA_property_collection_lookup_int(PointerRNA *ptr,
 
   if (cprop->lookupint) {
     /* we have a callback defined, use it */
+    rna_lazy_data_ensure(ptr);
     return cprop->lookupint(ptr, key, r_ptr);
   }
   /* no callback defined, just iterate and find the nth item */
@@ -4075,6 +4093,7 @@ int RNA_property_collection_lookup_string_index(
 
   if (cprop->lookupstring) {
     /* we have a callback defined, use it */
+    rna_lazy_data_ensure(ptr);
     return cprop->lookupstring(ptr, key, r_ptr);
   }
   /* no callback defined, compare with name properties if they exist */
@@ -4140,6 +4159,7 @@ int RNA_property_collection_assign_int(PointerRNA *ptr,
 
   if (cprop->assignint) {
     /* we have a callback defined, use it */
+    rna_lazy_data_ensure(ptr);
     return cprop->assignint(ptr, key, assign_ptr);
   }
 
@@ -7324,6 +7344,7 @@ int RNA_function_call(
     bContext *C, ReportList *reports, PointerRNA *ptr, FunctionRNA *func, ParameterList *parms)
 {
   if (func->call) {
+    rna_lazy_data_ensure(ptr);
     func->call(C, reports, ptr, parms);
 
     return 0;
@@ -6436,6 +6436,13 @@ static void rna_def_userdef_experimental(BlenderRNA *brna)
   RNA_def_property_ui_text(
       prop, "Override Templates", "Enable library override template in the python API");
 
+  prop = RNA_def_property(srna, "use_lazy_data_loading", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "use_lazy_data_loading", 1);
+  RNA_def_property_ui_text(prop,
+                           "Lazy Data Loading",
+                           "Only read mesh geometry from opened files when it is first used, "
+                           "keeping the files open meanwhile");
+
   prop = RNA_def_property(srna, "use_geometry_nodes_legacy", PROP_BOOLEAN, PROP_NONE);
   RNA_def_property_boolean_sdna(prop, NULL, "use_geometry_nodes_legacy", 1);
   RNA_def_property_ui_text(
@@ -95,8 +95,9 @@ static void createFacepa(ExplodeModifierData *emd, ParticleSystemModifierData *p
   ParticleData *pa;
   KDTree_3d *tree;
   RNG *rng;
-  float center[3], co[3];
-  int *facepa = NULL, *vertpa = NULL, totvert = 0, totface = 0, totpart = 0;
+  float co[3];
+  float(*face_centers)[3];
+  int *facepa = NULL, *vertpa = NULL, *face_nearest, totvert = 0, totface = 0, totpart = 0;
   int i, p, v1, v2, v3, v4 = 0;
   const bool invert_vgroup = (emd->flag & eExplodeFlag_INVERT_VGROUP) != 0;
 
@@ -159,7 +160,10 @@ static void createFacepa(ExplodeModifierData *emd, ParticleSystemModifierData *p
   BLI_kdtree_3d_balance(tree);
 
   /* set face-particle-indexes to nearest particle to face center */
+  face_centers = MEM_malloc_arrayN(totface, sizeof(*face_centers), __func__);
+  face_nearest = MEM_malloc_arrayN(totface, sizeof(*face_nearest), __func__);
   for (i = 0, fa = mface; i < totface; i++, fa++) {
+    float *center = face_centers[i];
     add_v3_v3v3(center, mvert[fa->v1].co, mvert[fa->v2].co);
     add_v3_v3(center, mvert[fa->v3].co);
     if (fa->v4) {
@@ -169,8 +173,12 @@ static void createFacepa(ExplodeModifierData *emd, ParticleSystemModifierData *p
     else {
       mul_v3_fl(center, 1.0f / 3.0f);
     }
+  }
+  BLI_kdtree_3d_find_nearest_batch(
+      tree, (const float(*)[3])face_centers, totface, face_nearest, NULL);
 
-    p = BLI_kdtree_3d_find_nearest(tree, center, NULL);
+  for (i = 0, fa = mface; i < totface; i++, fa++) {
+    p = face_nearest[i];
 
     v1 = vertpa[fa->v1];
     v2 = vertpa[fa->v2];
@@ -200,6 +208,8 @@ static void createFacepa(ExplodeModifierData *emd, ParticleSystemModifierData *p
   if (vertpa) {
     MEM_freeN(vertpa);
   }
+  MEM_freeN(face_centers);
+  MEM_freeN(face_nearest);
   BLI_kdtree_3d_free(tree);
 
   BLI_rng_free(rng);
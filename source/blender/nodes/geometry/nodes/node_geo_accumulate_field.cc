@@ -1,5 +1,8 @@
 /* SPDX-License-Identifier: GPL-2.0-or-later */
 
+#include "BLI_prefix_sum.hh"
+#include "BLI_task.hh"
+
 #include "BKE_attribute_math.hh"
 
 #include "NOD_socket_search_link.hh"
@@ -227,38 +230,16 @@ template<typename T> class AccumulateFieldInput final : public GeometryFieldInpu
     const VArray<int> &group_indices = evaluator.get_evaluated<int>(1);
 
     Array<T> accumulations_out(domain_size);
+    const VArray_Span<T> values_span{values};
+    const bool inclusive = accumulation_mode_ == AccumulationMode::Leading;
 
     if (group_indices.is_single()) {
-      T accumulation = T();
-      if (accumulation_mode_ == AccumulationMode::Leading) {
-        for (const int i : values.index_range()) {
-          accumulation = values[i] + accumulation;
-          accumulations_out[i] = accumulation;
-        }
-      }
-      else {
-        for (const int i : values.index_range()) {
-          accumulations_out[i] = accumulation;
-          accumulation = values[i] + accumulation;
-        }
-      }
+      parallel_prefix_sum<T>(values_span, accumulations_out, inclusive);
     }
     else {
-      Map<int, T> accumulations;
-      if (accumulation_mode_ == AccumulationMode::Leading) {
-        for (const int i : values.index_range()) {
-          T &accumulation_value = accumulations.lookup_or_add_default(group_indices[i]);
-          accumulation_value += values[i];
-          accumulations_out[i] = accumulation_value;
-        }
-      }
-      else {
-        for (const int i : values.index_range()) {
-          T &accumulation_value = accumulations.lookup_or_add_default(group_indices[i]);
-          accumulations_out[i] = accumulation_value;
-          accumulation_value += values[i];
-        }
-      }
+      const VArray_Span<int> group_indices_span{group_indices};
+      parallel_grouped_prefix_sum<T>(
+          values_span, group_indices_span, accumulations_out, inclusive);
     }
 
     return component.attribute_try_adapt_domain<T>(
@@ -312,23 +293,19 @@ template<typename T> class TotalFieldInput final : public GeometryFieldInput {
     const VArray<T> &values = evaluator.get_evaluated<T>(0);
     const VArray<int> &group_indices = evaluator.get_evaluated<int>(1);
 
+    const VArray_Span<T> values_span{values};
     if (group_indices.is_single()) {
-      T accumulation = T();
-      for (const int i : values.index_range()) {
-        accumulation = values[i] + accumulation;
-      }
-      return VArray<T>::ForSingle(accumulation, domain_size);
+      return VArray<T>::ForSingle(parallel_sum<T>(values_span), domain_size);
     }
 
+    const VArray_Span<int> group_indices_span{group_indices};
+    const Map<int, T> accumulations = parallel_grouped_sum<T>(values_span, group_indices_span);
     Array<T> accumulations_out(domain_size);
-    Map<int, T> accumulations;
-    for (const int i : values.index_range()) {
-      T &value = accumulations.lookup_or_add_default(group_indices[i]);
-      value = value + values[i];
-    }
-    for (const int i : values.index_range()) {
-      accumulations_out[i] = accumulations.lookup(group_indices[i]);
-    }
+    threading::parallel_for(values.index_range(), 2048, [&](const IndexRange range) {
+      for (const int i : range) {
+        accumulations_out[i] = accumulations.lookup(group_indices_span[i]);
+      }
+    });
 
     return component.attribute_try_adapt_domain<T>(
         VArray<T>::ForContainer(std::move(accumulations_out)), source_domain_, domain);
@@ -1,12 +1,14 @@
 /* SPDX-License-Identifier: GPL-2.0-or-later */
 
 #include <algorithm>
-#include <numeric>
+#include <limits>
 
 #include "UI_interface.h"
 #include "UI_resources.h"
 
 #include "BLI_math_base_safe.h"
+#include "BLI_sort.hh"
+#include "BLI_task.hh"
 
 #include "NOD_socket_search_link.hh"
 
@@ -145,37 +147,98 @@ static void node_gather_link_searches(GatherLinkSearchOpParams &params)
   }
 }
 
-template<typename T> static T compute_sum(const Span<T> data)
-{
-  return std::accumulate(data.begin(), data.end(), T());
-}
+/**
+ * Summary statistics of a part of the data. Statistics of different parts can be merged, which
+ * allows computing them for chunks of the data in parallel.
+ */
+struct Statistics {
+  int64_t count = 0;
+  double sum = 0.0;
+  /** The sum of the squared differences from the mean. */
+  double squared_deviations = 0.0;
+  float min = std::numeric_limits<float>::max();
+  float max = std::numeric_limits<float>::lowest();
+
+  double mean() const
+  {
+    return count == 0 ? 0.0 : sum / count;
+  }
 
-static float compute_variance(const Span<float> data, const float mean)
-{
-  if (data.size() <= 1) {
-    return 0.0f;
+  /** The sample variance, which is zero when there are less than two values. */
+  double variance() const
+  {
+    return count <= 1 ? 0.0 : squared_deviations / (count - 1);
   }
 
-  float sum_of_squared_differences = std::accumulate(
-      data.begin(), data.end(), 0.0f, [mean](float accumulator, float value) {
-        float difference = mean - value;
-        return accumulator + difference * difference;
-      });
+  static Statistics merge(const Statistics &a, const Statistics &b)
+  {
+    if (a.count == 0) {
+      return b;
+    }
+    if (b.count == 0) {
+      return a;
+    }
+    /* Combine the squared deviations with the difference of the means (Chan et al.). */
+    const double delta = b.mean() - a.mean();
+    Statistics result;
+    result.count = a.count + b.count;
+    result.sum = a.sum + b.sum;
+    result.squared_deviations = a.squared_deviations + b.squared_deviations +
+                                delta * delta * double(a.count) * double(b.count) /
+                                    double(result.count);
+    result.min = std::min(a.min, b.min);
+    result.max = std::max(a.max, b.max);
+    return result;
+  }
+};
 
-  return sum_of_squared_differences / (data.size() - 1);
+/**
+ * Compute the statistics of fixed size chunks in parallel and merge them in order, so that the
+ * result does not depend on the number of threads.
+ */
+static Statistics compute_statistics(const Span<float> data)
+{
+  const int64_t chunk_size = std::max<int64_t>(4096, (data.size() + 255) / 256);
+  const int64_t chunks_num = (data.size() + chunk_size - 1) / chunk_size;
+  Array<Statistics> chunk_statistics(chunks_num);
+  threading::parallel_for(IndexRange(chunks_num), 1, [&](const IndexRange range) {
+    for (const int64_t chunk : range) {
+      const int64_t start = chunk * chunk_size;
+      const Span<float> chunk_data = data.slice(start, std::min(chunk_size, data.size() - start));
+      Statistics &statistics = chunk_statistics[chunk];
+      statistics.count = chunk_data.size();
+      for (const float value : chunk_data) {
+        statistics.sum += value;
+        statistics.min = std::min(statistics.min, value);
+        statistics.max = std::max(statistics.max, value);
+      }
+      /* The chunk is still in the cache, so a second pass is cheap and more accurate than
+       * updating the mean for every value. */
+      const double mean = statistics.mean();
+      for (const float value : chunk_data) {
+        const double difference = value - mean;
+        statistics.squared_deviations += difference * difference;
+      }
+    }
+  });
+  Statistics statistics;
+  for (const Statistics &chunk : chunk_statistics) {
+    statistics = Statistics::merge(statistics, chunk);
+  }
+  return statistics;
 }
 
-static float median_of_sorted_span(const Span<float> data)
+static float compute_median(const Span<float> data)
 {
   if (data.is_empty()) {
     return 0.0f;
   }
 
-  const float median = data[data.size() / 2];
+  const float median = parallel_nth_value(data, data.size() / 2);
 
   /* For spans of even length, the median is the average of the middle two elements. */
   if (data.size() % 2 == 0) {
-    return (median + data[data.size() / 2 - 1]) * 0.5f;
+    return (median + parallel_nth_value(data, data.size() / 2 - 1)) * 0.5f;
   }
   return median;
 }
@@ -210,9 +273,11 @@ static void node_geo_exec(GeoNodeExecParams params)
           data.resize(next_data_index + selection.size());
           MutableSpan<float> selected_data = data.as_mutable_span().slice(next_data_index,
                                                                           selection.size());
-          for (const int i : selection.index_range()) {
-            selected_data[i] = component_data[selection[i]];
-          }
+          threading::parallel_for(selection.index_range(), 4096, [&](const IndexRange range) {
+            for (const int i : range) {
+              selected_data[i] = component_data[selection[i]];
+            }
+          });
         }
       }
 
@@ -224,32 +289,28 @@ static void node_geo_exec(GeoNodeExecParams params)
       float range = 0.0f;
       float standard_deviation = 0.0f;
       float variance = 0.0f;
-      const bool sort_required = params.output_is_required("Min") ||
-                                 params.output_is_required("Max") ||
-                                 params.output_is_required("Range") ||
-                                 params.output_is_required("Median");
+      const bool min_max_required = params.output_is_required("Min") ||
+                                    params.output_is_required("Max") ||
+                                    params.output_is_required("Range");
+      const bool median_required = params.output_is_required("Median");
       const bool sum_required = params.output_is_required("Sum") ||
                                 params.output_is_required("Mean");
       const bool variance_required = params.output_is_required("Standard Deviation") ||
                                      params.output_is_required("Variance");
 
       if (data.size() != 0) {
-        if (sort_required) {
-          std::sort(data.begin(), data.end());
-          median = median_of_sorted_span(data);
-
-          min = data.first();
-          max = data.last();
+        if (min_max_required || sum_required || variance_required) {
+          const Statistics statistics = compute_statistics(data);
+          min = statistics.min;
+          max = statistics.max;
           range = max - min;
+          sum = statistics.sum;
+          mean = statistics.mean();
+          variance = statistics.variance();
+          standard_deviation = std::sqrt(variance);
         }
-        if (sum_required || variance_required) {
-          sum = compute_sum<float>(data);
-          mean = sum / data.size();
-
-          if (variance_required) {
-            variance = compute_variance(data, mean);
-            standard_deviation = std::sqrt(variance);
-          }
+        if (median_required) {
+          median = compute_median(data);
         }
       }
 
@@ -257,10 +318,12 @@ static void node_geo_exec(GeoNodeExecParams params)
         params.set_output("Sum", sum);
         params.set_output("Mean", mean);
       }
-      if (sort_required) {
+      if (min_max_required) {
         params.set_output("Min", min);
         params.set_output("Max", max);
         params.set_output("Range", range);
+      }
+      if (median_required) {
         params.set_output("Median", median);
       }
       if (variance_required) {
@@ -288,9 +351,11 @@ static void node_geo_exec(GeoNodeExecParams params)
           data.resize(data.size() + selection.size());
           MutableSpan<float3> selected_data = data.as_mutable_span().slice(next_data_index,
                                                                            selection.size());
-          for (const int i : selection.index_range()) {
-            selected_data[i] = component_data[selection[i]];
-          }
+          threading::parallel_for(selection.index_range(), 4096, [&](const IndexRange range) {
+            for (const int i : range) {
+              selected_data[i] = component_data[selection[i]];
+            }
+          });
         }
       }
 
@@ -302,56 +367,43 @@ static void node_geo_exec(GeoNodeExecParams params)
       float3 mean{0};
       float3 variance{0};
       float3 standard_deviation{0};
-      const bool sort_required = params.output_is_required("Min_001") ||
-                                 params.output_is_required("Max_001") ||
-                                 params.output_is_required("Range_001") ||
-                                 params.output_is_required("Median_001");
+      const bool min_max_required = params.output_is_required("Min_001") ||
+                                    params.output_is_required("Max_001") ||
+                                    params.output_is_required("Range_001");
+      const bool median_required = params.output_is_required("Median_001");
       const bool sum_required = params.output_is_required("Sum_001") ||
                                 params.output_is_required("Mean_001");
       const bool variance_required = params.output_is_required("Standard Deviation_001") ||
                                      params.output_is_required("Variance_001");
 
-      Array<float> data_x;
-      Array<float> data_y;
-      Array<float> data_z;
-      if (sort_required || variance_required) {
-        data_x.reinitialize(data.size());
-        data_y.reinitialize(data.size());
-        data_z.reinitialize(data.size());
-        for (const int i : data.index_range()) {
-          data_x[i] = data[i].x;
-          data_y[i] = data[i].y;
-          data_z[i] = data[i].z;
-        }
-      }
-
       if (data.size() != 0) {
-        if (sort_required) {
-          std::sort(data_x.begin(), data_x.end());
-          std::sort(data_y.begin(), data_y.end());
-          std::sort(data_z.begin(), data_z.end());
-
-          const float x_median = median_of_sorted_span(data_x);
-          const float y_median = median_of_sorted_span(data_y);
-          const float z_median = median_of_sorted_span(data_z);
-          median = float3(x_median, y_median, z_median);
-
-          min = float3(data_x.first(), data_y.first(), data_z.first());
-          max = float3(data_x.last(), data_y.last(), data_z.last());
+        Array<float> data_x(data.size());
+        Array<float> data_y(data.size());
+        Array<float> data_z(data.size());
+        threading::parallel_for(data.index_range(), 4096, [&](const IndexRange range) {
+          for (const int i : range) {
+            data_x[i] = data[i].x;
+            data_y[i] = data[i].y;
+            data_z[i] = data[i].z;
+          }
+        });
+
+        if (min_max_required || sum_required || variance_required) {
+          const Statistics x_statistics = compute_statistics(data_x);
+          const Statistics y_statistics = compute_statistics(data_y);
+          const Statistics z_statistics = compute_statistics(data_z);
+          min = float3(x_statistics.min, y_statistics.min, z_statistics.min);
+          max = float3(x_statistics.max, y_statistics.max, z_statistics.max);
           range = max - min;
+          sum = float3(x_statistics.sum, y_statistics.sum, z_statistics.sum);
+          mean = float3(x_statistics.mean(), y_statistics.mean(), z_statistics.mean());
+          variance = float3(
+              x_statistics.variance(), y_statistics.variance(), z_statistics.variance());
+          standard_deviation = float3(
+              std::sqrt(variance.x), std::sqrt(variance.y), std::sqrt(variance.z));
         }
-        if (sum_required || variance_required) {
-          sum = compute_sum(data.as_span());
-          mean = sum / data.size();
-
-          if (variance_required) {
-            const float x_variance = compute_variance(data_x, mean.x);
-            const float y_variance = compute_variance(data_y, mean.y);
-            const float z_variance = compute_variance(data_z, mean.z);
-            variance = float3(x_variance, y_variance, z_variance);
-            standard_deviation = float3(
-                std::sqrt(variance.x), std::sqrt(variance.y), std::sqrt(variance.z));
-          }
+        if (median_required) {
+          median = float3(compute_median(data_x), compute_median(data_y), compute_median(data_z));
         }
       }
 
@@ -359,10 +411,12 @@ static void node_geo_exec(GeoNodeExecParams params)
         params.set_output("Sum_001", sum);
         params.set_output("Mean_001", mean);
       }
-      if (sort_required) {
+      if (min_max_required) {
         params.set_output("Min_001", min);
         params.set_output("Max_001", max);
         params.set_output("Range_001", range);
+      }
+      if (median_required) {
         params.set_output("Median_001", median);
       }
       if (variance_required) {
@@ -2,6 +2,7 @@
 
 #include "BLI_task.hh"
 
+#include "BKE_curves.hh"
 #include "BKE_spline.hh"
 
 #include "UI_interface.h"
@@ -58,34 +59,64 @@ static void node_update(bNodeTree *ntree, bNode *node)
   nodeSetSocketAvailability(ntree, length, mode == GEO_NODE_CURVE_SAMPLE_LENGTH);
 }
 
-template<typename T> static T sample_with_lookup(const Spline::LookupResult lookup, Span<T> data)
+/**
+ * Find the evaluated segment that contains the given length, and the factor between its two
+ * evaluated points. This is the same as #Spline::lookup_evaluated_length, but works on the
+ * flat accumulated lengths of a single curve.
+ */
+static void lookup_evaluated_length(const Span<float> lengths,
+                                    const int evaluated_size,
+                                    const float length,
+                                    int &r_index,
+                                    int &r_next_index,
+                                    float &r_factor)
 {
-  return attribute_math::mix2(
-      lookup.factor, data[lookup.evaluated_index], data[lookup.next_evaluated_index]);
+  if (lengths.is_empty()) {
+    /* Curves with a single evaluated point have no length. */
+    r_index = 0;
+    r_next_index = 0;
+    r_factor = 0.0f;
+    return;
+  }
+
+  const float *offset = std::lower_bound(lengths.begin(), lengths.end(), length);
+  const int index = std::min<int>(offset - lengths.begin(), lengths.size() - 1);
+  const float previous_length = (index == 0) ? 0.0f : lengths[index - 1];
+  const float length_in_segment = length - previous_length;
+  const float segment_length = lengths[index] - previous_length;
+
+  r_index = index;
+  r_next_index = (index == evaluated_size - 1) ? 0 : index + 1;
+  r_factor = segment_length == 0.0f ? 0.0f : length_in_segment / segment_length;
 }
 
 class SampleCurveFunction : public fn::MultiFunction {
  private:
   /**
-   * The function holds a geometry set instead of a curve or a curve component in order to
-   * maintain a reference to the geometry while the field tree is being built, so that the
-   * curve is not freed before the function can execute.
+   * The geometry set is owned by the function, so that the curve component and the #Curves
+   * data-block it caches stay alive as long as the function is used.
    */
   GeometrySet geometry_set_;
+  /**
+   * The input curve converted to the flat #Curves data-block by the component, so that all curves
+   * are evaluated together and the evaluated data is shared by every call of the function.
+   */
+  const Curves *curves_id_;
   /**
    * To support factor inputs, the node adds another field operation before this one to multiply by
-   * the curve's total length. Since that must calculate the spline lengths anyway, store them to
+   * the curve's total length. Since that must calculate the curve lengths anyway, store them to
    * reuse the calculation.
    */
-  Array<float> spline_lengths_;
-  /** The last member of #spline_lengths_, extracted for convenience. */
+  Array<float> curve_lengths_;
+  /** The last member of #curve_lengths_, extracted for convenience. */
   const float total_length_;
 
  public:
-  SampleCurveFunction(GeometrySet geometry_set, Array<float> spline_lengths)
+  SampleCurveFunction(GeometrySet geometry_set, Array<float> curve_lengths)
       : geometry_set_(std::move(geometry_set)),
-        spline_lengths_(std::move(spline_lengths)),
-        total_length_(spline_lengths_.last())
+        curves_id_(geometry_set_.get_component_for_read<CurveComponent>()->get_curves_for_read()),
+        curve_lengths_(std::move(curve_lengths)),
+        total_length_(curve_lengths_.last())
   {
     static fn::MFSignature signature = create_signature();
     this->set_signature(&signature);
@@ -110,28 +141,7 @@ class SampleCurveFunction : public fn::MultiFunction {
     MutableSpan<float3> sampled_normals = params.uninitialized_single_output_if_required<float3>(
         3, "Normal");
 
-    auto return_default = [&]() {
-      if (!sampled_positions.is_empty()) {
-        sampled_positions.fill_indices(mask, {0, 0, 0});
-      }
-      if (!sampled_tangents.is_empty()) {
-        sampled_tangents.fill_indices(mask, {0, 0, 0});
-      }
-      if (!sampled_normals.is_empty()) {
-        sampled_normals.fill_indices(mask, {0, 0, 0});
-      }
-    };
-
-    if (!geometry_set_.has_curve()) {
-      return return_default();
-    }
-
-    const CurveComponent *curve_component = geometry_set_.get_component_for_read<CurveComponent>();
-    const CurveEval *curve = curve_component->get_for_read();
-    Span<SplinePtr> splines = curve->splines();
-    if (splines.is_empty()) {
-      return return_default();
-    }
+    const bke::CurvesGeometry &curves = bke::CurvesGeometry::wrap(curves_id_->geometry);
 
     const VArray<float> &lengths_varray = params.readonly_single_input<float>(0, "Length");
     const VArray_Span lengths{lengths_varray};
@@ -144,44 +154,56 @@ class SampleCurveFunction : public fn::MultiFunction {
     }
 #endif
 
-    Array<int> spline_indices(mask.min_array_size());
-    for (const int i : mask) {
-      const float *offset = std::lower_bound(
-          spline_lengths_.begin(), spline_lengths_.end(), lengths[i]);
-      const int index = offset - spline_lengths_.data() - 1;
-      spline_indices[i] = std::max(index, 0);
-    }
-
-    /* Storing lookups in an array is unnecessary but will simplify custom attribute transfer. */
-    Array<Spline::LookupResult> lookups(mask.min_array_size());
-    for (const int i : mask) {
-      const float length_in_spline = lengths[i] - spline_lengths_[spline_indices[i]];
-      lookups[i] = splines[spline_indices[i]]->lookup_evaluated_length(length_in_spline);
-    }
-
-    if (!sampled_positions.is_empty()) {
-      for (const int i : mask) {
-        const Spline::LookupResult &lookup = lookups[i];
-        const Span<float3> evaluated_positions = splines[spline_indices[i]]->evaluated_positions();
-        sampled_positions[i] = sample_with_lookup(lookup, evaluated_positions);
-      }
-    }
-
-    if (!sampled_tangents.is_empty()) {
-      for (const int i : mask) {
-        const Spline::LookupResult &lookup = lookups[i];
-        const Span<float3> evaluated_tangents = splines[spline_indices[i]]->evaluated_tangents();
-        sampled_tangents[i] = math::normalize(sample_with_lookup(lookup, evaluated_tangents));
-      }
-    }
-
-    if (!sampled_normals.is_empty()) {
-      for (const int i : mask) {
-        const Spline::LookupResult &lookup = lookups[i];
-        const Span<float3> evaluated_normals = splines[spline_indices[i]]->evaluated_normals();
-        sampled_normals[i] = math::normalize(sample_with_lookup(lookup, evaluated_normals));
+    /* Calculate the evaluated data for all curves at once before sampling from multiple
+     * threads, rather than lazily for each sample. */
+    const Span<float3> evaluated_positions = sampled_positions.is_empty() ?
+                                                 Span<float3>() :
+                                                 curves.evaluated_positions();
+    const Span<float3> evaluated_tangents = sampled_tangents.is_empty() ?
+                                                Span<float3>() :
+                                                curves.evaluated_tangents();
+    const Span<float3> evaluated_normals = sampled_normals.is_empty() ?
+                                               Span<float3>() :
+                                               curves.evaluated_normals();
+    curves.ensure_evaluated_lengths();
+    const VArray<bool> cyclic = curves.cyclic();
+
+    threading::parallel_for(mask.index_range(), 1024, [&](const IndexRange range) {
+      for (const int i : mask.slice(range)) {
+        const float *offset = std::lower_bound(
+            curve_lengths_.begin(), curve_lengths_.end(), lengths[i]);
+        const int curve_index = std::max<int>(offset - curve_lengths_.data() - 1, 0);
+
+        const IndexRange evaluated_points = curves.evaluated_range_for_curve(curve_index);
+        const Span<float> evaluated_lengths = curves.evaluated_lengths_for_curve(
+            curve_index, cyclic[curve_index]);
+
+        int index;
+        int next_index;
+        float factor;
+        lookup_evaluated_length(evaluated_lengths,
+                                evaluated_points.size(),
+                                lengths[i] - curve_lengths_[curve_index],
+                                index,
+                                next_index,
+                                factor);
+        index += evaluated_points.start();
+        next_index += evaluated_points.start();
+
+        if (!sampled_positions.is_empty()) {
+          sampled_positions[i] = math::interpolate(
+              evaluated_positions[index], evaluated_positions[next_index], factor);
+        }
+        if (!sampled_tangents.is_empty()) {
+          sampled_tangents[i] = math::normalize(math::interpolate(
+              evaluated_tangents[index], evaluated_tangents[next_index], factor));
+        }
+        if (!sampled_normals.is_empty()) {
+          sampled_normals[i] = math::normalize(math::interpolate(
+              evaluated_normals[index], evaluated_normals[next_index], factor));
+        }
       }
-    }
+    });
   }
 };
 
@@ -245,8 +267,23 @@ static void node_geo_exec(GeoNodeExecParams params)
     return;
   }
 
-  Array<float> spline_lengths = curve->accumulated_spline_lengths();
-  const float total_length = spline_lengths.last();
+  /* The conversion is cached on the component, so it only happens once for the same input. */
+  const Curves *curves_id = component->get_curves_for_read();
+  const bke::CurvesGeometry &curves = bke::CurvesGeometry::wrap(curves_id->geometry);
+
+  /* Accumulate the total length of every curve, so the curve containing each sample can be found
+   * with a binary search. */
+  curves.ensure_evaluated_lengths();
+  const VArray<bool> cyclic = curves.cyclic();
+  Array<float> curve_lengths(curves.curves_size() + 1);
+  float length = 0.0f;
+  for (const int i : curves.curves_range()) {
+    curve_lengths[i] = length;
+    length += curves.evaluated_length_total_for_curve(i, cyclic[i]);
+  }
+  curve_lengths.last() = length;
+
+  const float total_length = curve_lengths.last();
   if (total_length == 0.0f) {
     params.set_default_remaining_outputs();
     return;
@@ -255,7 +292,7 @@ static void node_geo_exec(GeoNodeExecParams params)
   Field<float> length_field = get_length_input_field(params, total_length);
 
   auto sample_fn = std::make_unique<SampleCurveFunction>(std::move(geometry_set),
-                                                         std::move(spline_lengths));
+                                                         std::move(curve_lengths));
   auto sample_op = std::make_shared<FieldOperation>(
       FieldOperation(std::move(sample_fn), {length_field}));
 
@@ -1,6 +1,5 @@
 /* SPDX-License-Identifier: GPL-2.0-or-later */
 
-#include "BLI_kdtree.h"
 #include "BLI_noise.hh"
 #include "BLI_rand.hh"
 #include "BLI_task.hh"
@@ -17,6 +16,8 @@
 #include "BKE_mesh_sample.hh"
 #include "BKE_pointcloud.h"
 
+#include "GEO_point_elimination.hh"
+
 #include "UI_interface.h"
 #include "UI_resources.h"
 
@@ -79,6 +80,11 @@ static float3 normal_to_euler_rotation(const float3 normal)
   return rotation;
 }
 
+/**
+ * The random number generator of every triangle is seeded with its index, so the points can be
+ * generated in two passes: first the number of points of every triangle is computed in parallel,
+ * then the points are written to their offsets in parallel.
+ */
 static void sample_mesh_surface(const Mesh &mesh,
                                 const float base_density,
                                 const Span<float> density_factors,
@@ -90,94 +96,74 @@ static void sample_mesh_surface(const Mesh &mesh,
   const Span<MLoopTri> looptris{BKE_mesh_runtime_looptri_ensure(&mesh),
                                 BKE_mesh_runtime_looptri_len(&mesh)};
 
-  for (const int looptri_index : looptris.index_range()) {
-    const MLoopTri &looptri = looptris[looptri_index];
-    const int v0_loop = looptri.tri[0];
-    const int v1_loop = looptri.tri[1];
-    const int v2_loop = looptri.tri[2];
-    const int v0_index = mesh.mloop[v0_loop].v;
-    const int v1_index = mesh.mloop[v1_loop].v;
-    const int v2_index = mesh.mloop[v2_loop].v;
-    const float3 v0_pos = float3(mesh.mvert[v0_index].co);
-    const float3 v1_pos = float3(mesh.mvert[v1_index].co);
-    const float3 v2_pos = float3(mesh.mvert[v2_index].co);
-
-    float looptri_density_factor = 1.0f;
-    if (!density_factors.is_empty()) {
-      const float v0_density_factor = std::max(0.0f, density_factors[v0_loop]);
-      const float v1_density_factor = std::max(0.0f, density_factors[v1_loop]);
-      const float v2_density_factor = std::max(0.0f, density_factors[v2_loop]);
-      looptri_density_factor = (v0_density_factor + v1_density_factor + v2_density_factor) / 3.0f;
+  auto looptri_positions = [&](const MLoopTri &looptri, float3 &r_v0, float3 &r_v1, float3 &r_v2) {
+    r_v0 = float3(mesh.mvert[mesh.mloop[looptri.tri[0]].v].co);
+    r_v1 = float3(mesh.mvert[mesh.mloop[looptri.tri[1]].v].co);
+    r_v2 = float3(mesh.mvert[mesh.mloop[looptri.tri[2]].v].co);
+  };
+
+  /* The number of points of every triangle, then the offset of its first point. */
+  Array<int> offsets(looptris.size() + 1);
+  threading::parallel_for(looptris.index_range(), 1024, [&](const IndexRange range) {
+    for (const int looptri_index : range) {
+      const MLoopTri &looptri = looptris[looptri_index];
+      float3 v0_pos, v1_pos, v2_pos;
+      looptri_positions(looptri, v0_pos, v1_pos, v2_pos);
+
+      float looptri_density_factor = 1.0f;
+      if (!density_factors.is_empty()) {
+        const float v0_density_factor = std::max(0.0f, density_factors[looptri.tri[0]]);
+        const float v1_density_factor = std::max(0.0f, density_factors[looptri.tri[1]]);
+        const float v2_density_factor = std::max(0.0f, density_factors[looptri.tri[2]]);
+        looptri_density_factor = (v0_density_factor + v1_density_factor + v2_density_factor) /
+                                 3.0f;
+      }
+      const float area = area_tri_v3(v0_pos, v1_pos, v2_pos);
+
+      const int looptri_seed = noise::hash(looptri_index, seed);
+      RandomNumberGenerator looptri_rng(looptri_seed);
+
+      const float points_amount_fl = area * base_density * looptri_density_factor;
+      const float add_point_probability = fractf(points_amount_fl);
+      const bool add_point = add_point_probability > looptri_rng.get_float();
+      offsets[looptri_index] = (int)points_amount_fl + (int)add_point;
     }
-    const float area = area_tri_v3(v0_pos, v1_pos, v2_pos);
-
-    const int looptri_seed = noise::hash(looptri_index, seed);
-    RandomNumberGenerator looptri_rng(looptri_seed);
-
-    const float points_amount_fl = area * base_density * looptri_density_factor;
-    const float add_point_probability = fractf(points_amount_fl);
-    const bool add_point = add_point_probability > looptri_rng.get_float();
-    const int point_amount = (int)points_amount_fl + (int)add_point;
-
-    for (int i = 0; i < point_amount; i++) {
-      const float3 bary_coord = looptri_rng.get_barycentric_coordinates();
-      float3 point_pos;
-      interp_v3_v3v3v3(point_pos, v0_pos, v1_pos, v2_pos, bary_coord);
-      r_positions.append(point_pos);
-      r_bary_coords.append(bary_coord);
-      r_looptri_indices.append(looptri_index);
-    }
-  }
-}
-
-BLI_NOINLINE static KDTree_3d *build_kdtree(Span<float3> positions)
-{
-  KDTree_3d *kdtree = BLI_kdtree_3d_new(positions.size());
-
-  int i_point = 0;
-  for (const float3 position : positions) {
-    BLI_kdtree_3d_insert(kdtree, i_point, position);
-    i_point++;
-  }
-
-  BLI_kdtree_3d_balance(kdtree);
-  return kdtree;
-}
+  });
 
-BLI_NOINLINE static void update_elimination_mask_for_close_points(
-    Span<float3> positions, const float minimum_distance, MutableSpan<bool> elimination_mask)
-{
-  if (minimum_distance <= 0.0f) {
-    return;
+  int points_num = 0;
+  for (const int looptri_index : looptris.index_range()) {
+    const int point_amount = offsets[looptri_index];
+    offsets[looptri_index] = points_num;
+    points_num += point_amount;
   }
-
-  KDTree_3d *kdtree = build_kdtree(positions);
-
-  for (const int i : positions.index_range()) {
-    if (elimination_mask[i]) {
-      continue;
+  offsets.last() = points_num;
+
+  r_positions.resize(points_num);
+  r_bary_coords.resize(points_num);
+  r_looptri_indices.resize(points_num);
+
+  threading::parallel_for(looptris.index_range(), 1024, [&](const IndexRange range) {
+    for (const int looptri_index : range) {
+      const IndexRange points(offsets[looptri_index],
+                              offsets[looptri_index + 1] - offsets[looptri_index]);
+      if (points.size() == 0) {
+        continue;
+      }
+      float3 v0_pos, v1_pos, v2_pos;
+      looptri_positions(looptris[looptri_index], v0_pos, v1_pos, v2_pos);
+
+      /* Skip the random number that decided about the last point in the first pass. */
+      RandomNumberGenerator looptri_rng(noise::hash(looptri_index, seed));
+      looptri_rng.get_float();
+
+      for (const int i : points) {
+        const float3 bary_coord = looptri_rng.get_barycentric_coordinates();
+        interp_v3_v3v3v3(r_positions[i], v0_pos, v1_pos, v2_pos, bary_coord);
+        r_bary_coords[i] = bary_coord;
+        r_looptri_indices[i] = looptri_index;
+      }
     }
-
-    struct CallbackData {
-      int index;
-      MutableSpan<bool> elimination_mask;
-    } callback_data = {i, elimination_mask};
-
-    BLI_kdtree_3d_range_search_cb(
-        kdtree,
-        positions[i],
-        minimum_distance,
-        [](void *user_data, int index, const float *UNUSED(co), float UNUSED(dist_sq)) {
-          CallbackData &callback_data = *static_cast<CallbackData *>(user_data);
-          if (index != callback_data.index) {
-            callback_data.elimination_mask[index] = true;
-          }
-          return true;
-        },
-        &callback_data);
-  }
-
-  BLI_kdtree_3d_free(kdtree);
+  });
 }
 
 BLI_NOINLINE static void update_elimination_mask_based_on_density_factors(
@@ -189,44 +175,89 @@ BLI_NOINLINE static void update_elimination_mask_based_on_density_factors(
 {
   const Span<MLoopTri> looptris{BKE_mesh_runtime_looptri_ensure(&mesh),
                                 BKE_mesh_runtime_looptri_len(&mesh)};
-  for (const int i : bary_coords.index_range()) {
-    if (elimination_mask[i]) {
-      continue;
-    }
+  threading::parallel_for(bary_coords.index_range(), 1024, [&](const IndexRange range) {
+    for (const int i : range) {
+      if (elimination_mask[i]) {
+        continue;
+      }
 
-    const MLoopTri &looptri = looptris[looptri_indices[i]];
-    const float3 bary_coord = bary_coords[i];
+      const MLoopTri &looptri = looptris[looptri_indices[i]];
+      const float3 bary_coord = bary_coords[i];
 
-    const int v0_loop = looptri.tri[0];
-    const int v1_loop = looptri.tri[1];
-    const int v2_loop = looptri.tri[2];
+      const int v0_loop = looptri.tri[0];
+      const int v1_loop = looptri.tri[1];
+      const int v2_loop = looptri.tri[2];
 
-    const float v0_density_factor = std::max(0.0f, density_factors[v0_loop]);
-    const float v1_density_factor = std::max(0.0f, density_factors[v1_loop]);
-    const float v2_density_factor = std::max(0.0f, density_factors[v2_loop]);
+      const float v0_density_factor = std::max(0.0f, density_factors[v0_loop]);
+      const float v1_density_factor = std::max(0.0f, density_factors[v1_loop]);
+      const float v2_density_factor = std::max(0.0f, density_factors[v2_loop]);
 
-    const float probablity = v0_density_factor * bary_coord.x + v1_density_factor * bary_coord.y +
-                             v2_density_factor * bary_coord.z;
+      const float probablity = v0_density_factor * bary_coord.x +
+                               v1_density_factor * bary_coord.y +
+                               v2_density_factor * bary_coord.z;
 
-    const float hash = noise::hash_float_to_float(bary_coord);
-    if (hash > probablity) {
-      elimination_mask[i] = true;
+      const float hash = noise::hash_float_to_float(bary_coord);
+      if (hash > probablity) {
+        elimination_mask[i] = true;
+      }
     }
-  }
+  });
 }
 
+/**
+ * Remove the eliminated points while keeping the order of the remaining points. The new index of
+ * every point is computed per chunk, so that the points can be moved in parallel.
+ */
 BLI_NOINLINE static void eliminate_points_based_on_mask(const Span<bool> elimination_mask,
                                                         Vector<float3> &positions,
                                                         Vector<float3> &bary_coords,
                                                         Vector<int> &looptri_indices)
 {
-  for (int i = positions.size() - 1; i >= 0; i--) {
-    if (elimination_mask[i]) {
-      positions.remove_and_reorder(i);
-      bary_coords.remove_and_reorder(i);
-      looptri_indices.remove_and_reorder(i);
+  const int64_t chunk_size = 4096;
+  const int64_t chunks_num = (positions.size() + chunk_size - 1) / chunk_size;
+  auto chunk_range = [&](const int64_t chunk) {
+    return IndexRange(chunk * chunk_size,
+                      std::min(chunk_size, positions.size() - chunk * chunk_size));
+  };
+
+  Array<int64_t> chunk_offsets(chunks_num + 1);
+  threading::parallel_for(IndexRange(chunks_num), 16, [&](const IndexRange range) {
+    for (const int64_t chunk : range) {
+      const Span<bool> chunk_mask = elimination_mask.slice(chunk_range(chunk));
+      chunk_offsets[chunk] = std::count(chunk_mask.begin(), chunk_mask.end(), false);
     }
+  });
+  int64_t kept_num = 0;
+  for (const int64_t chunk : IndexRange(chunks_num)) {
+    const int64_t chunk_kept_num = chunk_offsets[chunk];
+    chunk_offsets[chunk] = kept_num;
+    kept_num += chunk_kept_num;
   }
+  if (kept_num == positions.size()) {
+    return;
+  }
+
+  /* The points can only move to lower indices, but a chunk may overwrite points of a previous
+   * chunk that have not been moved yet, so the points are copied to new arrays. */
+  Vector<float3> new_positions(kept_num);
+  Vector<float3> new_bary_coords(kept_num);
+  Vector<int> new_looptri_indices(kept_num);
+  threading::parallel_for(IndexRange(chunks_num), 16, [&](const IndexRange range) {
+    for (const int64_t chunk : range) {
+      int64_t new_index = chunk_offsets[chunk];
+      for (const int64_t i : chunk_range(chunk)) {
+        if (!elimination_mask[i]) {
+          new_positions[new_index] = positions[i];
+          new_bary_coords[new_index] = bary_coords[i];
+          new_looptri_indices[new_index] = looptri_indices[i];
+          new_index++;
+        }
+      }
+    }
+  });
+  positions = std::move(new_positions);
+  bary_coords = std::move(new_bary_coords);
+  looptri_indices = std::move(new_looptri_indices);
 }
 
 BLI_NOINLINE static void interpolate_attribute(const Mesh &mesh,
@@ -341,31 +372,33 @@ BLI_NOINLINE static void compute_attribute_outputs(const MeshComponent &mesh_com
   const Span<MLoopTri> looptris{BKE_mesh_runtime_looptri_ensure(&mesh),
                                 BKE_mesh_runtime_looptri_len(&mesh)};
 
-  for (const int i : bary_coords.index_range()) {
-    const int looptri_index = looptri_indices[i];
-    const MLoopTri &looptri = looptris[looptri_index];
-    const float3 &bary_coord = bary_coords[i];
-
-    const int v0_index = mesh.mloop[looptri.tri[0]].v;
-    const int v1_index = mesh.mloop[looptri.tri[1]].v;
-    const int v2_index = mesh.mloop[looptri.tri[2]].v;
-    const float3 v0_pos = float3(mesh.mvert[v0_index].co);
-    const float3 v1_pos = float3(mesh.mvert[v1_index].co);
-    const float3 v2_pos = float3(mesh.mvert[v2_index].co);
-
-    ids[i] = noise::hash(noise::hash_float(bary_coord), looptri_index);
-
-    float3 normal;
-    if (!normals.is_empty() || !rotations.is_empty()) {
-      normal_tri_v3(normal, v0_pos, v1_pos, v2_pos);
-    }
-    if (!normals.is_empty()) {
-      normals[i] = normal;
+  threading::parallel_for(bary_coords.index_range(), 2048, [&](const IndexRange range) {
+    for (const int i : range) {
+      const int looptri_index = looptri_indices[i];
+      const MLoopTri &looptri = looptris[looptri_index];
+      const float3 &bary_coord = bary_coords[i];
+
+      const int v0_index = mesh.mloop[looptri.tri[0]].v;
+      const int v1_index = mesh.mloop[looptri.tri[1]].v;
+      const int v2_index = mesh.mloop[looptri.tri[2]].v;
+      const float3 v0_pos = float3(mesh.mvert[v0_index].co);
+      const float3 v1_pos = float3(mesh.mvert[v1_index].co);
+      const float3 v2_pos = float3(mesh.mvert[v2_index].co);
+
+      ids[i] = noise::hash(noise::hash_float(bary_coord), looptri_index);
+
+      float3 normal;
+      if (!normals.is_empty() || !rotations.is_empty()) {
+        normal_tri_v3(normal, v0_pos, v1_pos, v2_pos);
+      }
+      if (!normals.is_empty()) {
+        normals[i] = normal;
+      }
+      if (!rotations.is_empty()) {
+        rotations[i] = normal_to_euler_rotation(normal);
+      }
     }
-    if (!rotations.is_empty()) {
-      rotations[i] = normal_to_euler_rotation(normal);
-    }
-  }
+  });
 
   id_attribute.save();
 
@@ -422,7 +455,7 @@ static void distribute_points_poisson_disk(const MeshComponent &mesh_component,
   sample_mesh_surface(mesh, max_density, {}, seed, positions, bary_coords, looptri_indices);
 
   Array<bool> elimination_mask(positions.size(), false);
-  update_elimination_mask_for_close_points(positions, minimum_distance, elimination_mask);
+  geometry::eliminate_close_points(positions, minimum_distance, elimination_mask);
 
   const Array<float> density_factors = calc_full_density_factors_with_selection(
       mesh_component, density_factor_field, selection_field);
@@ -42,7 +42,7 @@ static void geometry_set_mesh_subdivide(GeometrySet &geometry_set, const int lev
   subdiv_settings.fvar_linear_interpolation = BKE_subdiv_fvar_interpolation_from_uv_smooth(0);
 
   /* Apply subdivision from mesh. */
-  Subdiv *subdiv = BKE_subdiv_update_from_mesh(nullptr, &subdiv_settings, mesh_in);
+  Subdiv *subdiv = BKE_subdiv_cache_acquire(&subdiv_settings, mesh_in);
 
   /* In case of bad topology, skip to input mesh. */
   if (subdiv == nullptr) {
@@ -55,7 +55,7 @@ static void geometry_set_mesh_subdivide(GeometrySet &geometry_set, const int lev
   MeshComponent &mesh_component = geometry_set.get_component_for_write<MeshComponent>();
   mesh_component.replace(mesh_out);
 
-  BKE_subdiv_free(subdiv);
+  BKE_subdiv_cache_release(subdiv);
 }
 
 static void node_geo_exec(GeoNodeExecParams params)
@@ -39,6 +39,51 @@ static void geo_proximity_init(bNodeTree *UNUSED(ntree), bNode *node)
   node->storage = node_storage;
 }
 
+/**
+ * Find the nearest element in the tree for all masked positions that is closer than the distance
+ * that was found so far, and update the distance and location. All queries are done as one batch,
+ * which sorts them spatially and processes them in parallel.
+ */
+static void find_nearest_batch(BVHTree *tree,
+                               BVHTree_NearestPointCallback callback,
+                               void *userdata,
+                               const VArray<float3> &positions,
+                               const IndexMask mask,
+                               const MutableSpan<float> r_distances,
+                               const MutableSpan<float3> r_locations)
+{
+  Array<float3> query_positions(mask.size());
+  Array<BVHTreeNearest> nearest(mask.size());
+  threading::parallel_for(mask.index_range(), 4096, [&](IndexRange range) {
+    for (const int i : range) {
+      const int index = mask[i];
+      query_positions[i] = positions[index];
+      nearest[i].index = -1;
+      nearest[i].dist_sq = r_distances[index];
+    }
+  });
+
+  BLI_bvhtree_find_nearest_batch(tree,
+                                 reinterpret_cast<const float(*)[3]>(query_positions.data()),
+                                 int(query_positions.size()),
+                                 nearest.data(),
+                                 callback,
+                                 userdata,
+                                 0);
+
+  threading::parallel_for(mask.index_range(), 4096, [&](IndexRange range) {
+    for (const int i : range) {
+      const int index = mask[i];
+      if (nearest[i].index != -1 && nearest[i].dist_sq < r_distances[index]) {
+        r_distances[index] = nearest[i].dist_sq;
+        if (!r_locations.is_empty()) {
+          r_locations[index] = nearest[i].co;
+        }
+      }
+    }
+  });
+}
+
 static bool calculate_mesh_proximity(const VArray<float3> &positions,
                                      const IndexMask mask,
                                      const Mesh &mesh,
@@ -63,27 +108,13 @@ static bool calculate_mesh_proximity(const VArray<float3> &positions,
     return false;
   }
 
-  threading::parallel_for(mask.index_range(), 512, [&](IndexRange range) {
-    BVHTreeNearest nearest;
-    copy_v3_fl(nearest.co, FLT_MAX);
-    nearest.index = -1;
-
-    for (int i : range) {
-      const int index = mask[i];
-      /* Use the distance to the last found point as upper bound to speedup the bvh lookup. */
-      nearest.dist_sq = math::distance_squared(float3(nearest.co), positions[index]);
-
-      BLI_bvhtree_find_nearest(
-          bvh_data.tree, positions[index], &nearest, bvh_data.nearest_callback, &bvh_data);
-
-      if (nearest.dist_sq < r_distances[index]) {
-        r_distances[index] = nearest.dist_sq;
-        if (!r_locations.is_empty()) {
-          r_locations[index] = nearest.co;
-        }
-      }
-    }
-  });
+  find_nearest_batch(bvh_data.tree,
+                     bvh_data.nearest_callback,
+                     &bvh_data,
+                     positions,
+                     mask,
+                     r_distances,
+                     r_locations);
 
   free_bvhtree_from_mesh(&bvh_data);
   return true;
@@ -101,29 +132,16 @@ static bool calculate_pointcloud_proximity(const VArray<float3> &positions,
     return false;
   }
 
-  threading::parallel_for(mask.index_range(), 512, [&](IndexRange range) {
-    BVHTreeNearest nearest;
-    copy_v3_fl(nearest.co, FLT_MAX);
-    nearest.index = -1;
-
-    for (int i : range) {
-      const int index = mask[i];
-      /* Use the distance to the closest point in the mesh to speedup the pointcloud bvh lookup.
-       * This is ok because we only need to find the closest point in the pointcloud if it's
-       * closer than the mesh. */
-      nearest.dist_sq = r_distances[index];
-
-      BLI_bvhtree_find_nearest(
-          bvh_data.tree, positions[index], &nearest, bvh_data.nearest_callback, &bvh_data);
-
-      if (nearest.dist_sq < r_distances[index]) {
-        r_distances[index] = nearest.dist_sq;
-        if (!r_locations.is_empty()) {
-          r_locations[index] = nearest.co;
-        }
-      }
-    }
-  });
+  /* The distance to the closest point in the mesh is used as upper bound to speedup the point
+   * cloud lookup. This is ok because the closest point in the point cloud is only needed if it is
+   * closer than the mesh. */
+  find_nearest_batch(bvh_data.tree,
+                     bvh_data.nearest_callback,
+                     &bvh_data,
+                     positions,
+                     mask,
+                     r_distances,
+                     r_locations);
 
   free_bvhtree_from_pointcloud(&bvh_data);
   return true;
@@ -111,7 +111,7 @@ static void node_geo_exec(GeoNodeExecParams params)
     Mesh *mesh_in = mesh_component.get_for_write();
 
     /* Apply subdivision to mesh. */
-    Subdiv *subdiv = BKE_subdiv_update_from_mesh(nullptr, &subdiv_settings, mesh_in);
+    Subdiv *subdiv = BKE_subdiv_cache_acquire(&subdiv_settings, mesh_in);
 
     /* In case of bad topology, skip to input mesh. */
     if (subdiv == nullptr) {
@@ -123,7 +123,7 @@ static void node_geo_exec(GeoNodeExecParams params)
 
     mesh_component.replace(mesh_out);
 
-    BKE_subdiv_free(subdiv);
+    BKE_subdiv_cache_release(subdiv);
   });
 #endif
   params.set_output("Mesh", std::move(geometry_set));
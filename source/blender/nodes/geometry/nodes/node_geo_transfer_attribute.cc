@@ -137,6 +137,35 @@ static void node_gather_link_searches(GatherLinkSearchOpParams &params)
   }
 }
 
+/**
+ * Find the nearest element in the tree for all masked positions. The queries are done as one
+ * batch, which sorts them spatially and processes them in parallel.
+ */
+static Array<BVHTreeNearest> find_nearest_batch(BVHTree *tree,
+                                                BVHTree_NearestPointCallback callback,
+                                                void *userdata,
+                                                const VArray<float3> &positions,
+                                                const IndexMask mask)
+{
+  Array<float3> query_positions(mask.size());
+  Array<BVHTreeNearest> nearest(mask.size());
+  threading::parallel_for(mask.index_range(), 4096, [&](IndexRange range) {
+    for (const int i : range) {
+      query_positions[i] = positions[mask[i]];
+      nearest[i].index = -1;
+      nearest[i].dist_sq = FLT_MAX;
+    }
+  });
+  BLI_bvhtree_find_nearest_batch(tree,
+                                 reinterpret_cast<const float(*)[3]>(query_positions.data()),
+                                 int(query_positions.size()),
+                                 nearest.data(),
+                                 callback,
+                                 userdata,
+                                 0);
+  return nearest;
+}
+
 static void get_closest_in_bvhtree(BVHTreeFromMesh &tree_data,
                                    const VArray<float3> &positions,
                                    const IndexMask mask,
@@ -148,22 +177,23 @@ static void get_closest_in_bvhtree(BVHTreeFromMesh &tree_data,
   BLI_assert(positions.size() >= r_distances_sq.size());
   BLI_assert(positions.size() >= r_positions.size());
 
-  for (const int i : mask) {
-    BVHTreeNearest nearest;
-    nearest.dist_sq = FLT_MAX;
-    const float3 position = positions[i];
-    BLI_bvhtree_find_nearest(
-        tree_data.tree, position, &nearest, tree_data.nearest_callback, &tree_data);
-    if (!r_indices.is_empty()) {
-      r_indices[i] = nearest.index;
-    }
-    if (!r_distances_sq.is_empty()) {
-      r_distances_sq[i] = nearest.dist_sq;
-    }
-    if (!r_positions.is_empty()) {
-      r_positions[i] = nearest.co;
+  const Array<BVHTreeNearest> nearest = find_nearest_batch(
+      tree_data.tree, tree_data.nearest_callback, &tree_data, positions, mask);
+
+  threading::parallel_for(mask.index_range(), 4096, [&](IndexRange range) {
+    for (const int i : range) {
+      const int index = mask[i];
+      if (!r_indices.is_empty()) {
+        r_indices[index] = nearest[i].index;
+      }
+      if (!r_distances_sq.is_empty()) {
+        r_distances_sq[index] = nearest[i].dist_sq;
+      }
+      if (!r_positions.is_empty()) {
+        r_positions[index] = nearest[i].co;
+      }
     }
-  }
+  });
 }
 
 static void get_closest_pointcloud_points(const PointCloud &pointcloud,
@@ -178,17 +208,18 @@ static void get_closest_pointcloud_points(const PointCloud &pointcloud,
   BVHTreeFromPointCloud tree_data;
   BKE_bvhtree_from_pointcloud_get(&tree_data, &pointcloud, 2);
 
-  for (const int i : mask) {
-    BVHTreeNearest nearest;
-    nearest.dist_sq = FLT_MAX;
-    const float3 position = positions[i];
-    BLI_bvhtree_find_nearest(
-        tree_data.tree, position, &nearest, tree_data.nearest_callback, &tree_data);
-    r_indices[i] = nearest.index;
-    if (!r_distances_sq.is_empty()) {
-      r_distances_sq[i] = nearest.dist_sq;
+  const Array<BVHTreeNearest> nearest = find_nearest_batch(
+      tree_data.tree, tree_data.nearest_callback, &tree_data, positions, mask);
+
+  threading::parallel_for(mask.index_range(), 4096, [&](IndexRange range) {
+    for (const int i : range) {
+      const int index = mask[i];
+      r_indices[index] = nearest[i].index;
+      if (!r_distances_sq.is_empty()) {
+        r_distances_sq[index] = nearest[i].dist_sq;
+      }
     }
-  }
+  });
 
   free_bvhtree_from_pointcloud(&tree_data);
 }
@@ -251,10 +282,12 @@ static void get_closest_mesh_polygons(const Mesh &mesh,
   const Span<MLoopTri> looptris{BKE_mesh_runtime_looptri_ensure(&mesh),
                                 BKE_mesh_runtime_looptri_len(&mesh)};
 
-  for (const int i : mask) {
-    const MLoopTri &looptri = looptris[looptri_indices[i]];
-    r_poly_indices[i] = looptri.poly;
-  }
+  threading::parallel_for(mask.index_range(), 4096, [&](IndexRange range) {
+    for (const int i : mask.slice(range)) {
+      const MLoopTri &looptri = looptris[looptri_indices[i]];
+      r_poly_indices[i] = looptri.poly;
+    }
+  });
 }
 
 /* The closest corner is defined to be the closest corner on the closest face. */
@@ -269,36 +302,38 @@ static void get_closest_mesh_corners(const Mesh &mesh,
   Array<int> poly_indices(positions.size());
   get_closest_mesh_polygons(mesh, positions, mask, poly_indices, {}, {});
 
-  for (const int i : mask) {
-    const float3 position = positions[i];
-    const int poly_index = poly_indices[i];
-    const MPoly &poly = mesh.mpoly[poly_index];
-
-    /* Find the closest vertex in the polygon. */
-    float min_distance_sq = FLT_MAX;
-    const MVert *closest_mvert;
-    int closest_loop_index = 0;
-    for (const int loop_index : IndexRange(poly.loopstart, poly.totloop)) {
-      const MLoop &loop = mesh.mloop[loop_index];
-      const int vertex_index = loop.v;
-      const MVert &mvert = mesh.mvert[vertex_index];
-      const float distance_sq = math::distance_squared(position, float3(mvert.co));
-      if (distance_sq < min_distance_sq) {
-        min_distance_sq = distance_sq;
-        closest_loop_index = loop_index;
-        closest_mvert = &mvert;
+  threading::parallel_for(mask.index_range(), 2048, [&](IndexRange range) {
+    for (const int i : mask.slice(range)) {
+      const float3 position = positions[i];
+      const int poly_index = poly_indices[i];
+      const MPoly &poly = mesh.mpoly[poly_index];
+
+      /* Find the closest vertex in the polygon. */
+      float min_distance_sq = FLT_MAX;
+      const MVert *closest_mvert;
+      int closest_loop_index = 0;
+      for (const int loop_index : IndexRange(poly.loopstart, poly.totloop)) {
+        const MLoop &loop = mesh.mloop[loop_index];
+        const int vertex_index = loop.v;
+        const MVert &mvert = mesh.mvert[vertex_index];
+        const float distance_sq = math::distance_squared(position, float3(mvert.co));
+        if (distance_sq < min_distance_sq) {
+          min_distance_sq = distance_sq;
+          closest_loop_index = loop_index;
+          closest_mvert = &mvert;
+        }
+      }
+      if (!r_corner_indices.is_empty()) {
+        r_corner_indices[i] = closest_loop_index;
+      }
+      if (!r_positions.is_empty()) {
+        r_positions[i] = closest_mvert->co;
+      }
+      if (!r_distances_sq.is_empty()) {
+        r_distances_sq[i] = min_distance_sq;
       }
     }
-    if (!r_corner_indices.is_empty()) {
-      r_corner_indices[i] = closest_loop_index;
-    }
-    if (!r_positions.is_empty()) {
-      r_positions[i] = closest_mvert->co;
-    }
-    if (!r_distances_sq.is_empty()) {
-      r_distances_sq[i] = min_distance_sq;
-    }
-  }
+  });
 }
 
 template<typename T>
@@ -310,9 +345,11 @@ void copy_with_indices(const VArray<T> &src,
   if (src.is_empty()) {
     return;
   }
-  for (const int i : mask) {
-    dst[i] = src[indices[i]];
-  }
+  threading::parallel_for(mask.index_range(), 4096, [&](IndexRange range) {
+    for (const int i : mask.slice(range)) {
+      dst[i] = src[indices[i]];
+    }
+  });
 }
 
 template<typename T>
@@ -346,14 +383,16 @@ void copy_with_indices_and_comparison(const VArray<T> &src_1,
   if (src_1.is_empty() || src_2.is_empty()) {
     return;
   }
-  for (const int i : mask) {
-    if (distances_1[i] < distances_2[i]) {
-      dst[i] = src_1[indices_1[i]];
-    }
-    else {
-      dst[i] = src_2[indices_2[i]];
+  threading::parallel_for(mask.index_range(), 4096, [&](IndexRange range) {
+    for (const int i : mask.slice(range)) {
+      if (distances_1[i] < distances_2[i]) {
+        dst[i] = src_1[indices_1[i]];
+      }
+      else {
+        dst[i] = src_2[indices_2[i]];
+      }
     }
-  }
+  });
 }
 
 static bool component_is_available(const GeometrySet &geometry,
@@ -823,6 +823,35 @@ static void file_read_reports_finalize(BlendFileReadReport *bf_reports)
             bf_reports->count.resynced_lib_overrides,
             duration_lib_override_recursive_resync_minutes,
             duration_lib_override_recursive_resync_seconds);
+  if (bf_reports->count.lazy_data_ids != 0) {
+    CLOG_INFO(&LOG,
+              0,
+              " * Deferred reading data of %d data-blocks",
+              bf_reports->count.lazy_data_ids);
+  }
+  if (bf_reports->count.mapped_data_blocks != 0) {
+    CLOG_INFO(&LOG,
+              0,
+              " * Mapped %d data-blocks without copying (%.2f MiB)",
+              bf_reports->count.mapped_data_blocks,
+              (double)bf_reports->count.mapped_data_size / (double)(1024 * 1024));
+  }
+  CLOG_INFO(&LOG,
+            0,
+            " * Peak resident memory: %.2f MiB",
+            (double)BLI_system_memory_peak_resident() / (double)(1024 * 1024));
+
+  if (G.debug & G_DEBUG_IO) {
+    printf("Blender file read phases:\n");
+    printf(" * Reading data: %.3fs\n", bf_reports->duration.read_data);
+    printf(" * Versioning: %.3fs\n", bf_reports->duration.versioning);
+    printf(" * Linking data: %.3fs\n", bf_reports->duration.lib_link);
+    printf(" * Versioning after linking: %.3fs\n",
+           bf_reports->duration.versioning_after_linking);
+    printf(" * Reading libraries and linking all data: %.3fs\n", bf_reports->duration.libraries);
+    printf(" * Applying overrides: %.3fs\n", bf_reports->duration.lib_overrides);
+    printf(" * Total: %.3fs\n", bf_reports->duration.whole);
+  }
 
   if (bf_reports->resynced_lib_overrides_libraries_count != 0) {
     for (LinkNode *node_lib = bf_reports->resynced_lib_overrides_libraries; node_lib != NULL;
@@ -909,7 +938,9 @@ bool WM_file_read(bContext *C, const char *filepath, ReportList *reports)
         /* Loading preferences when the user intended to load a regular file is a security
          * risk, because the excluded path list is also loaded. Further it's just confusing
          * if a user loads a file and various preferences change. */
-        .skip_flags = BLO_READ_SKIP_USERDEF,
+        .skip_flags = BLO_READ_SKIP_USERDEF |
+                      (USER_EXPERIMENTAL_TEST(&U, use_lazy_data_loading) ? BLO_READ_LAZY_DATA :
+                                                                           0),
     };
 
     BlendFileReadReport bf_reports = {.reports = reports,
@@ -929,6 +960,11 @@ bool WM_file_read(bContext *C, const char *filepath, ReportList *reports)
 
       BKE_blendfile_read_setup(C, bfd, &params, &bf_reports);
 
+      /* With lazy data, the previous file was already closed when keeping the new one open. */
+      if ((params.skip_flags & BLO_READ_LAZY_DATA) == 0) {
+        BLO_lazy_data_clear();
+      }
+
       if (G.f != G_f_orig) {
         const int flags_keep = G_FLAG_ALL_RUNTIME;
         G.f &= G_FLAG_ALL_READFILE;
@@ -1262,6 +1298,11 @@ void wm_homefile_read_ex(bContext *C,
     BKE_blendfile_read_make_empty(C);
   }
 
+  if (use_data) {
+    /* The startup file never defers reading data, the previous file is not needed anymore. */
+    BLO_lazy_data_clear();
+  }
+
   /* Load template preferences,
    * unlike regular preferences we only use some of the settings,
    * see: BKE_blender_userdef_set_app_template */
@@ -1925,11 +1966,12 @@ static void wm_autosave_write(Main *bmain, wmWindowManager *wm)
   /* Fast save of last undo-buffer, now with UI. */
   const bool use_memfile = (U.uiflag & USER_GLOBALUNDO) != 0;
   MemFile *memfile = use_memfile ? ED_undosys_stack_memfile_get_active(wm->undo_stack) : NULL;
-  if (memfile != NULL) {
+  /* Undo steps don't contain the data still in the original file. */
+  if (memfile != NULL && !memfile->has_lazy_data) {
     BLO_memfile_write_file(memfile, filepath);
   }
   else {
-    if (use_memfile) {
+    if (use_memfile && memfile == NULL) {
       /* This is very unlikely, alert developers of this unexpected case. */
       CLOG_WARN(&LOG, "undo-data not found for writing, fallback to regular file write!");
     }
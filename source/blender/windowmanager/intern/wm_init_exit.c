@@ -33,6 +33,7 @@
 #include "BLI_timer.h"
 #include "BLI_utildefines.h"
 
+#include "BLO_readfile.h"
 #include "BLO_undofile.h"
 #include "BLO_writefile.h"
 
@@ -448,7 +449,8 @@ void WM_exit_ex(bContext *C, const bool do_python)
 
         has_edited = ED_editors_flush_edits(bmain);
 
-        if ((has_edited &&
+        /* Undo steps don't contain the data still in the original file. */
+        if (((has_edited || undo_memfile->has_lazy_data) &&
              BLO_write_file(
                  bmain, filename, fileflags, &(const struct BlendFileWriteParams){0}, NULL)) ||
             (BLO_memfile_write_file(undo_memfile, filename))) {
@@ -546,6 +548,7 @@ void WM_exit_ex(bContext *C, const bool do_python)
 
   BKE_blender_free(); /* blender.c, does entire library and spacetypes */
                       //  BKE_material_copybuf_free();
+  BLO_lazy_data_clear();
 
   /* Free the GPU subdivision data after the database to ensure that subdivision structs used by
    * the modifiers were garbage collected. */
@@ -617,6 +620,8 @@ void WM_exit_ex(bContext *C, const bool do_python)
 
   DNA_sdna_current_free();
 
+  BLI_task_parallel_profile_print();
+
   BLI_threadapi_exit();
   BLI_task_scheduler_exit();
 
@@ -14,6 +14,7 @@
 #include "MEM_guardedalloc.h"
 
 #include "BLI_blenlib.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
@@ -112,6 +113,14 @@ struct wmJob {
   /** We use BLI_threads api, but per job only 1 thread runs */
   ListBase threads;
 
+  /**
+   * The job runs in its own arena, so that multi-threaded work of background jobs does not
+   * delay interactive work on the main thread. Jobs with #WM_JOB_PRIORITY keep a high priority.
+   */
+  TaskArena *arena;
+  /** Canceled whenever `stop` is set. */
+  TaskCancelToken *cancel_token;
+
   double start_time;
 
   /** Ticket mutex for main thread locking while some job accesses
@@ -139,6 +148,13 @@ static void wm_job_main_thread_yield(wmJob *wm_job)
   BLI_ticket_mutex_lock(wm_job->main_thread_mutex);
 }
 
+/** Signal the job to end, the job itself checks for it. */
+static void wm_job_stop(wmJob *wm_job)
+{
+  wm_job->stop = true;
+  BLI_task_cancel_token_cancel(wm_job->cancel_token);
+}
+
 /**
  * Finds if type or owner, compare for it, otherwise any matching job.
  */
@@ -192,6 +208,11 @@ wmJob *WM_jobs_get(wmWindowManager *wm,
 
     wm_job->main_thread_mutex = BLI_ticket_mutex_alloc();
     WM_job_main_thread_lock_acquire(wm_job);
+
+    wm_job->arena = BLI_task_arena_create(
+        name, 0, (flag & WM_JOB_PRIORITY) ? TASK_PRIORITY_HIGH : TASK_PRIORITY_LOW);
+    wm_job->cancel_token = BLI_task_cancel_token_create(NULL);
+    BLI_task_arena_cancel_token_set(wm_job->arena, wm_job->cancel_token);
   }
   /* else: a running job, be careful */
 
@@ -333,7 +354,7 @@ void WM_jobs_customdata_set(wmJob *wm_job, void *customdata, void (*free)(void *
 
   if (wm_job->running) {
     /* signal job to end */
-    wm_job->stop = true;
+    wm_job_stop(wm_job);
   }
 }
 
@@ -361,11 +382,18 @@ void WM_jobs_callbacks(wmJob *wm_job,
   wm_job->endjob = endjob;
 }
 
-static void *do_job_thread(void *job_v)
+static void do_job_in_arena(void *job_v)
 {
   wmJob *wm_job = job_v;
 
   wm_job->startjob(wm_job->run_customdata, &wm_job->stop, &wm_job->do_update, &wm_job->progress);
+}
+
+static void *do_job_thread(void *job_v)
+{
+  wmJob *wm_job = job_v;
+
+  BLI_task_arena_execute(wm_job->arena, do_job_in_arena, wm_job);
   wm_job->ready = true;
 
   return NULL;
@@ -407,7 +435,7 @@ static void wm_jobs_test_suspend_stop(wmWindowManager *wm, wmJob *test)
 
       /* if this job has higher priority, stop others */
       if (test->flag & WM_JOB_PRIORITY) {
-        wm_job->stop = true;
+        wm_job_stop(wm_job);
         // printf("job stopped: %s\n", wm_job->name);
       }
     }
@@ -426,7 +454,7 @@ void WM_jobs_start(wmWindowManager *wm, wmJob *wm_job)
 {
   if (wm_job->running) {
     /* signal job to end and restart */
-    wm_job->stop = true;
+    wm_job_stop(wm_job);
     // printf("job started a running job, ending... %s\n", wm_job->name);
   }
   else {
@@ -450,6 +478,7 @@ void WM_jobs_start(wmWindowManager *wm, wmJob *wm_job)
         }
 
         wm_job->stop = false;
+        BLI_task_cancel_token_reset(wm_job->cancel_token);
         wm_job->ready = false;
         wm_job->progress = 0.0;
 
@@ -481,6 +510,8 @@ static void wm_job_free(wmWindowManager *wm, wmJob *wm_job)
   BLI_remlink(&wm->jobs, wm_job);
   WM_job_main_thread_lock_release(wm_job);
   BLI_ticket_mutex_free(wm_job->main_thread_mutex);
+  BLI_task_arena_free(wm_job->arena);
+  BLI_task_cancel_token_free(wm_job->cancel_token);
   MEM_freeN(wm_job);
 }
 
@@ -491,7 +522,7 @@ static void wm_jobs_kill_job(wmWindowManager *wm, wmJob *wm_job)
 
   if (wm_job->running) {
     /* signal job to end */
-    wm_job->stop = true;
+    wm_job_stop(wm_job);
 
     WM_job_main_thread_lock_release(wm_job);
     BLI_threadpool_end(&wm_job->threads);
@@ -558,7 +589,7 @@ void WM_jobs_stop(wmWindowManager *wm, const void *owner, void *startjob)
   LISTBASE_FOREACH (wmJob *, wm_job, &wm->jobs) {
     if (wm_job->owner == owner || wm_job->startjob == startjob) {
       if (wm_job->running) {
-        wm_job->stop = true;
+        wm_job_stop(wm_job);
       }
     }
   }
@@ -311,6 +311,10 @@ int main(int argc,
         MEM_use_guarded_allocator();
         break;
       }
+      if (STREQ(argv[i], "--thread-cached-memory")) {
+        /* Keep looking for debug arguments, they take precedence. */
+        MEM_use_threadcache_allocator();
+      }
       if (STREQ(argv[i], "--")) {
         break;
       }
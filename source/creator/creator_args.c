@@ -26,6 +26,7 @@
 #  include "BLI_string.h"
 #  include "BLI_string_utf8.h"
 #  include "BLI_system.h"
+#  include "BLI_task.h"
 #  include "BLI_threads.h"
 #  include "BLI_utildefines.h"
 
@@ -578,6 +579,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_args_print_arg_doc(ba, "--debug-ghost");
   BLI_args_print_arg_doc(ba, "--debug-gpu");
   BLI_args_print_arg_doc(ba, "--debug-gpu-force-workarounds");
+  BLI_args_print_arg_doc(ba, "--debug-parallel-for");
   BLI_args_print_arg_doc(ba, "--debug-wm");
 #  ifdef WITH_XR_OPENXR
   BLI_args_print_arg_doc(ba, "--debug-xr");
@@ -600,6 +602,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_args_print_arg_doc(ba, "--app-template");
   BLI_args_print_arg_doc(ba, "--factory-startup");
   BLI_args_print_arg_doc(ba, "--enable-event-simulate");
+  BLI_args_print_arg_doc(ba, "--thread-cached-memory");
   printf("\n");
   BLI_args_print_arg_doc(ba, "--env-system-datafiles");
   BLI_args_print_arg_doc(ba, "--env-system-scripts");
@@ -737,6 +740,18 @@ static int arg_handle_abort_handler_disable(int UNUSED(argc),
   return 0;
 }
 
+static const char arg_handle_thread_cached_memory_doc[] =
+    "\n\t"
+    "Use a memory allocator which caches small blocks per thread, for faster multi-threaded\n"
+    "\tallocations (ignored when a memory debugging option is used).";
+static int arg_handle_thread_cached_memory(int UNUSED(argc),
+                                           const char **UNUSED(argv),
+                                           void *UNUSED(data))
+{
+  /* Handled in #main, the allocator has to be switched before any allocation happens. */
+  return 0;
+}
+
 static void clog_abort_on_error_callback(void *fp)
 {
   BLI_system_backtrace(fp);
@@ -1094,6 +1109,17 @@ static int arg_handle_debug_gpu_set(int UNUSED(argc),
   return 0;
 }
 
+static const char arg_handle_debug_parallel_for_set_doc[] =
+    "\n\t"
+    "Print the time spent in every multi-threaded loop when exiting.";
+static int arg_handle_debug_parallel_for_set(int UNUSED(argc),
+                                             const char **UNUSED(argv),
+                                             void *UNUSED(data))
+{
+  BLI_task_parallel_profile_enable();
+  return 0;
+}
+
 static const char arg_handle_debug_fpe_set_doc[] =
     "\n\t"
     "Enable floating-point exceptions.";
@@ -2073,6 +2099,7 @@ void main_args_setup(bContext *C, bArgs *ba)
 
   BLI_args_add(ba, NULL, "--disable-crash-handler", CB(arg_handle_crash_handler_disable), NULL);
   BLI_args_add(ba, NULL, "--disable-abort-handler", CB(arg_handle_abort_handler_disable), NULL);
+  BLI_args_add(ba, NULL, "--thread-cached-memory", CB(arg_handle_thread_cached_memory), NULL);
 
   BLI_args_add(ba, "-b", "--background", CB(arg_handle_background_mode_set), NULL);
 
@@ -2200,6 +2227,7 @@ void main_args_setup(bContext *C, bArgs *ba)
                "--debug-gpu-force-workarounds",
                CB_EX(arg_handle_debug_mode_generic_set, gpu_force_workarounds),
                (void *)G_DEBUG_GPU_FORCE_WORKAROUNDS);
+  BLI_args_add(ba, NULL, "--debug-parallel-for", CB(arg_handle_debug_parallel_for_set), NULL);
   BLI_args_add(ba, NULL, "--debug-exit-on-error", CB(arg_handle_debug_exit_on_error), NULL);
 
   BLI_args_add(ba, NULL, "--verbose", CB(arg_handle_verbosity_set), NULL);
@@ -0,0 +1,51 @@
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+
+
+def _run(dirpath):
+    import bpy
+    import glob
+    import os
+    import time
+
+    filepaths = glob.glob(os.path.join(dirpath, '*.blend'))
+
+    def list_libraries():
+        num_datablocks = 0
+        for filepath in filepaths:
+            with bpy.data.libraries.load(filepath) as (data_from, data_to):
+                for attr in dir(data_from):
+                    num_datablocks += len(getattr(data_from, attr))
+        return num_datablocks
+
+    # List once to ensure the files are cached by OS.
+    list_libraries()
+
+    start_time = time.time()
+    num_datablocks = list_libraries()
+    elapsed_time = time.time() - start_time
+
+    result = {'time': elapsed_time, 'num_datablocks': num_datablocks}
+    return result
+
+
+class BlendListTest(api.Test):
+    def __init__(self, dirpath):
+        self.dirpath = dirpath
+
+    def name(self):
+        return self.dirpath.name
+
+    def category(self):
+        return "blend_list"
+
+    def run(self, env, device_id):
+        result, _ = env.run_in_blender(_run, str(self.dirpath))
+        return result
+
+
+def generate(env):
+    # Directories of libraries, listing the data-blocks of all files as done for linking.
+    dirpaths = set(filepath.parent for filepath in env.find_blend_files('*/*'))
+    return [BlendListTest(dirpath) for dirpath in sorted(dirpaths)]